@@ -141,7 +141,9 @@ mfxStatus VideoDECODEMJPEG::Init(mfxVideoParam *par)
     bool isNeedChangeVideoParamWarning = IsNeedChangeVideoParam(&m_vFirstPar);
     m_vPar = m_vFirstPar;
 
-    m_vPar.mfx.NumThread = (mfxU16)(m_vPar.AsyncDepth ? m_vPar.AsyncDepth : m_core->GetAutoAsyncDepth());
+    // software decoding runs restart intervals of a frame on up to NumThread threads,
+    // UMC decoder limits it further by the frame height
+    m_vPar.mfx.NumThread = par->mfx.NumThread ? par->mfx.NumThread : m_core->GetAutoAsyncDepth();
     if (MFX_PLATFORM_SOFTWARE != m_platform)
         m_vPar.mfx.NumThread = 1;
 
@@ -1965,7 +1967,9 @@ mfxStatus VideoDECODEMJPEGBase_HW::FillEntryPoint(MFX_ENTRY_POINT *pEntryPoint,
     info->numDecodeTasksToCheck = MFX_PICSTRUCT_PROGRESSIVE == m_vPar.mfx.FrameInfo.PicStruct ? 1 : 2;
     info->dst = dst;
 
-    pEntryPoint->requiredNumThreads = m_vPar.mfx.NumThread;
+    // same limits as the number of UMC decoders: JPEG_MAX_THREADS, one per JPEG_MIN_LINES_PER_THREAD lines
+    pEntryPoint->requiredNumThreads = std::min<mfxU32>({ m_vPar.mfx.NumThread, UMC::JPEG_MAX_THREADS,
+        std::max<mfxU32>(1, m_vPar.mfx.FrameInfo.Height / UMC::JPEG_MIN_LINES_PER_THREAD) });
     pEntryPoint->pParam = info;
     return MFX_ERR_NONE;
 }
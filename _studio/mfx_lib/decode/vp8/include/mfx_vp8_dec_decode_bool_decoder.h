@@ -0,0 +1,212 @@
+// Copyright (c) 2017-2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _MFX_VP8_DEC_DECODE_BOOL_DECODER_H_
+#define _MFX_VP8_DEC_DECODE_BOOL_DECODER_H_
+
+// This header has no MFX/UMC dependencies on purpose: it is shared with
+// standalone tools (see tools/vp8_header_perf).
+
+#include <stdint.h>
+#include <string.h>
+
+// Boolean entropy decoder (RFC 6386, section 7) used to walk the first partition.
+//
+// The decoder keeps a 64-bit window: the top byte is compared against the split,
+// the bits below it are look-ahead that is refilled several bytes at a time.
+// Decisions and renormalization are branchless, so one refill serves ~7 bytes
+// of header syntax. Accessors report the state of the byte-wise reference
+// decoder (libvpx layout) because the driver continues decoding from it.
+class MFX_VP8_BoolDecoder
+{
+private:
+    typedef uint64_t window_t;
+
+    enum
+    {
+        WINDOW_BITS = sizeof(window_t) * 8,
+        WINDOW_BYTES = sizeof(window_t)
+    };
+
+    window_t m_value;      // top byte - current value, below - look-ahead bits
+    int32_t  m_count;      // number of valid look-ahead bits below the top byte
+    uint32_t m_range;
+    uint32_t m_pos;        // bytes loaded into the window, including zero padding past the end
+    uint8_t *m_input;
+    uint32_t m_input_size;
+
+    static uint32_t norm_shift(uint32_t range)
+    {
+        // shift that brings range in [1, 255] back to [128, 255], indexed by range >> 1
+        static const uint8_t range_normalization_shift[128] =
+        {
+          7, 6, 5, 5, 4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 3,
+          2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+          1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+          1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+          0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+        };
+
+        return range_normalization_shift[range >> 1];
+    }
+
+    void fill()
+    {
+        // bit position of the next byte to insert (its LSB)
+        int32_t shift = WINDOW_BITS - 16 - m_count;
+        if (shift < 0)
+            return;
+
+        uint32_t bytes = (uint32_t)(shift >> 3) + 1;
+
+        if (m_pos + WINDOW_BYTES <= m_input_size)
+        {
+            // bulk path: one unaligned big-endian load, drop the bytes that don't fit
+            uint8_t const *p = m_input + m_pos;
+            window_t word =
+                ((window_t)p[0] << 56) | ((window_t)p[1] << 48) |
+                ((window_t)p[2] << 40) | ((window_t)p[3] << 32) |
+                ((window_t)p[4] << 24) | ((window_t)p[5] << 16) |
+                ((window_t)p[6] <<  8) |  (window_t)p[7];
+
+            m_value |= (word >> (WINDOW_BITS - 8 - shift)) & ~(((window_t)1 << (shift & 7)) - 1);
+        }
+        else
+        {
+            // tail of the partition: the stream is padded with zeros
+            for (uint32_t i = 0; i < bytes; i++, shift -= 8)
+            {
+                uint32_t pos = m_pos + i;
+                if (pos < m_input_size)
+                    m_value |= (window_t)m_input[pos] << shift;
+            }
+        }
+
+        m_pos   += bytes;
+        m_count += bytes * 8;
+    }
+
+    int decode_bit(int probability)
+    {
+        if (m_count < 0)
+            fill();
+
+        uint32_t split    = 1 + (((m_range - 1) * probability) >> 8);
+        window_t bigsplit = (window_t)split << (WINDOW_BITS - 8);
+
+        uint32_t bit  = m_value >= bigsplit;
+        uint32_t mask = 0 - bit;
+
+        m_range  = split + ((m_range - 2 * split) & mask);
+        m_value -= bigsplit & (0 - (window_t)bit);
+
+        uint32_t shift = norm_shift(m_range);
+        m_range <<= shift;
+        m_value <<= shift;
+        m_count  -= shift;
+
+        return bit;
+    }
+
+    // number of bits shifted out of the top byte since init()
+    uint32_t consumed() const
+    {
+        return m_pos * 8 - 8 - m_count;
+    }
+
+public:
+    MFX_VP8_BoolDecoder() :
+        m_value(0),
+        m_count(0),
+        m_range(0),
+        m_pos(0),
+        m_input(0),
+        m_input_size(0)
+    {}
+
+    MFX_VP8_BoolDecoder(uint8_t *pBitStream, int32_t dataSize)
+    {
+        init(pBitStream, dataSize);
+    }
+
+    void init(uint8_t *pBitStream, int32_t dataSize)
+    {
+        m_value      = 0;
+        m_count      = -8;
+        m_range      = 255;
+        m_pos        = 0;
+        m_input      = pBitStream;
+        m_input_size = dataSize > 0 ? (uint32_t)dataSize : 0;
+
+        fill();
+    }
+
+    uint32_t decode(int bits = 1, int prob = 128)
+    {
+        uint32_t z = 0;
+        int bit;
+        for (bit = bits - 1; bit >= 0;bit--)
+        {
+            z |= (decode_bit(prob) << bit);
+        }
+        return z;
+    }
+
+    // The accessors below follow the reference decoder: 32-bit value register
+    // refilled one byte at a time, first 4 bytes loaded by init()
+
+    uint8_t * input()
+    {
+        return &m_input[pos()];
+    }
+
+    uint32_t pos() const
+    {
+        return 4 + (consumed() >> 3);
+    }
+
+    int32_t bitcount() const
+    {
+        return 8 - (consumed() & 7);
+    }
+
+    uint32_t range() const
+    {
+        return m_range;
+    }
+
+    uint32_t value() const
+    {
+        MFX_VP8_BoolDecoder tmp(*this);
+        if (tmp.m_count < 24)
+        {
+            tmp.fill();
+        }
+
+        // reference decoder has not yet loaded the low (consumed() & 7) bits
+        uint32_t value = (uint32_t)(tmp.m_value >> (WINDOW_BITS - 32));
+        return value & ~((1u << (consumed() & 7)) - 1);
+    }
+};
+
+#endif // _MFX_VP8_DEC_DECODE_BOOL_DECODER_H_
@@ -38,133 +38,7 @@
 
 #include "mfx_vp8_dec_decode_vp8_defs.h"
 #include "mfx_vp8_dec_decode_common.h"
-
-class MFX_VP8_BoolDecoder
-{
-private:
-    uint32_t m_range;
-    uint32_t m_value;
-    int32_t m_bitcount;
-    uint32_t m_pos;
-    uint8_t *m_input;
-    int32_t m_input_size;
-
-    static const int range_normalization_shift[64];
-
-    int decode_bit(int probability)
-    {
-
-        uint32_t bit = 0;
-        uint32_t split;
-        uint32_t bigsplit;
-        uint32_t count = this->m_bitcount;
-        uint32_t range = this->m_range;
-        uint32_t value = this->m_value;
-
-        split = 1 +  (((range - 1) * probability) >> 8);
-        bigsplit = (split << 24);
-
-        range = split;
-        if(value >= bigsplit)
-        {
-           range = this->m_range - split;
-           value = value - bigsplit;
-           bit = 1;
-        }
-
-        if(range >= 0x80)
-        {
-            this->m_value = value;
-            this->m_range = range;
-            return bit;
-        }
-        else
-        {
-            do
-            {
-                range += range;
-                value += value;
-
-                if (!--count)
-                {
-                    count = 8;
-                    value |= static_cast<uint32_t>(this->m_input[this->m_pos]);
-                    this->m_pos++;
-                }
-             }
-             while(range < 0x80);
-        }
-        this->m_bitcount = count;
-        this->m_value = value;
-        this->m_range = range;
-        return bit;
-
-    }
-
-public:
-    MFX_VP8_BoolDecoder() :
-        m_range(0),
-        m_value(0),
-        m_bitcount(0),
-        m_pos(0),
-        m_input(0),
-        m_input_size(0)
-    {}
-
-    MFX_VP8_BoolDecoder(uint8_t *pBitStream, int32_t dataSize)
-    {
-        init(pBitStream, dataSize);
-    }
-
-    void init(uint8_t *pBitStream, int32_t dataSize)
-    {
-        dataSize = std::min(dataSize, 2);
-        m_range = 255;
-        m_bitcount = 8;
-        m_pos = 0;
-        m_value = (pBitStream[0] << 24) + (pBitStream[1] << 16) +
-                  (pBitStream[2] << 8) + pBitStream[3];
-        m_pos += 4;
-        m_input     = pBitStream;
-        m_input_size = dataSize;
-    }
-
-    uint32_t decode(int bits = 1, int prob = 128)
-    {
-        uint32_t z = 0;
-        int bit;
-        for (bit = bits - 1; bit >= 0;bit--)
-        {
-            z |= (decode_bit(prob) << bit);
-        }
-        return z;
-    }
-
-    uint8_t * input()
-    {
-        return &m_input[m_pos];
-    }
-
-    uint32_t pos() const
-    {
-        return m_pos;
-    }
-
-    int32_t bitcount() const
-    {
-        return m_bitcount;
-    }
-
-    uint32_t range() const
-    {
-        return m_range;
-    }
-
-    uint32_t value() const
-    {
-        return m_value;
-    }
-};
+#include "mfx_vp8_dec_decode_bool_decoder.h"
 
 class VideoDECODEVP8_HW : public VideoDECODE, public MfxCriticalErrorHandler
 {
@@ -1406,15 +1406,4 @@ mfxStatus VideoDECODEVP8_HW::SetSkipMode(mfxSkipMode /*mode*/)
     return MFX_ERR_NONE;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-// MFX_VP8_BoolDecoder
-
-const int MFX_VP8_BoolDecoder::range_normalization_shift[64] =
-{
-  7, 6, 5, 5, 4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 3,
-  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
-};
-
 #endif
@@ -62,6 +62,14 @@ void MJPEGEncodeTask::Close(void)
 
     if(m_pMJPEGVideoEncoder)
     {
+        UMC::MJPEGEncoderStageTimes times;
+        m_pMJPEGVideoEncoder->GetStageTimes(&times);
+
+        MFX_LTRACE_3(MFX_TRACE_LEVEL_INTERNAL, "MJPEG SW stages, ms: ", "color convert %.1f, sub-sampling %.1f, DCT %.1f",
+                     times.colorConvert, times.downSampling, times.dct);
+        MFX_LTRACE_2(MFX_TRACE_LEVEL_INTERNAL, "MJPEG SW stages, ms: ", "fused %.1f, huffman %.1f",
+                     times.fused, times.huffman);
+
         m_pMJPEGVideoEncoder->Close();
     }
 
@@ -164,6 +172,10 @@ mfxStatus MJPEGEncodeTask::AddSource(mfxFrameSurface1* frameSurface, mfxFrameInf
         UMC::VideoData* pDataIn = encPic->m_sourceData.get();
         mfxU32 pitch = frameSurface->Data.PitchLow + ((mfxU32)frameSurface->Data.PitchHigh << 16);
 
+        // single interleaved scan of NV12 and YUY2 is encoded straight from the surface,
+        // the encoder converts the layout per MCU row together with DCT
+        bool directInput = MFX_SCANTYPE_INTERLEAVED == params.interleaved;
+
         // color image
         if(MFX_CHROMAFORMAT_YUV400 != frameSurface->Info.ChromaFormat)
         {
@@ -191,6 +203,16 @@ mfxStatus MJPEGEncodeTask::AddSource(mfxFrameSurface1* frameSurface, mfxFrameInf
                 pDataIn->SetPlanePointer(frameSurface->Data.U + (frameInfo->CropX >> 1) + (fieldOffset >> 1), 2);
                 pDataIn->SetPlanePitch((pitch >> 1) * numFields, 2);
             }
+            else if(frameSurface->Info.FourCC == MFX_FOURCC_YUY2 &&
+                    MFX_CHROMAFORMAT_YUV422H == frameSurface->Info.ChromaFormat && directInput)
+            {
+                fieldOffset = pitch * isBottom;
+                pDataIn->Init(alignedWidth, alignedHeight, UMC::YUY2, 8);
+                pDataIn->SetImageSize(width, height);
+
+                pDataIn->SetPlanePointer(frameSurface->Data.Y + ((frameInfo->CropX >> 1) << 2) + fieldOffset, 0);
+                pDataIn->SetPlanePitch(pitch * numFields, 0);
+            }
             else if(frameSurface->Info.FourCC == MFX_FOURCC_YUY2)
             {
                 std::unique_ptr<UMC::VideoData> cvt(new UMC::VideoData());
@@ -259,7 +281,9 @@ mfxStatus MJPEGEncodeTask::AddSource(mfxFrameSurface1* frameSurface, mfxFrameInf
                 return MFX_ERR_UNSUPPORTED;
             }
 
-            if(pDataIn->GetColorFormat() == UMC::NV12 || pDataIn->GetColorFormat() == UMC::YV12)
+            UMC::ColorFormat srcFormat = encPic->m_sourceData->GetColorFormat();
+
+            if((srcFormat == UMC::NV12 && !directInput) || srcFormat == UMC::YV12)
             {
                 std::unique_ptr<UMC::VideoData> cvt(new UMC::VideoData());
 
@@ -277,11 +301,11 @@ mfxStatus MJPEGEncodeTask::AddSource(mfxFrameSurface1* frameSurface, mfxFrameInf
                 encPic->m_sourceData.reset(cvt.release());
                 encPic->m_release_source_data = true;
             }
-            else if (pDataIn->GetColorFormat() == UMC::RGB32 && useAuxInput)
+            else if ((srcFormat == UMC::RGB32 || srcFormat == UMC::NV12 || srcFormat == UMC::YUY2) && useAuxInput)
             {
                 std::unique_ptr<UMC::VideoData> cvt(new UMC::VideoData());
 
-                cvt->Init(alignedWidth, alignedHeight, UMC::RGB32);
+                cvt->Init(alignedWidth, alignedHeight, srcFormat);
                 cvt->SetImageSize(width, height);
                 sts = cvt->Alloc();
                 if(sts != UMC::UMC_OK)
@@ -689,6 +713,65 @@ mfxStatus MFXVideoENCODEMJPEG::MJPEGENCODECompleteProc(void *pState, void *pPara
     return MFX_ERR_NONE;
 }
 
+// MCU size of the interleaved scan
+static void GetMcuSize(mfxU16 chromaFormat, mfxU32 & mcuWidth, mfxU32 & mcuHeight)
+{
+    switch(chromaFormat)
+    {
+        case MFX_CHROMAFORMAT_YUV422H:
+            mcuWidth  = 16;
+            mcuHeight = 8;
+            break;
+        case MFX_CHROMAFORMAT_YUV422V:
+            mcuWidth  = 8;
+            mcuHeight = 16;
+            break;
+        case MFX_CHROMAFORMAT_YUV420:
+            mcuWidth = mcuHeight = 16;
+            break;
+        case MFX_CHROMAFORMAT_YUV444:
+        case MFX_CHROMAFORMAT_YUV400:
+        default:
+            mcuWidth = mcuHeight = 8;
+            break;
+    }
+}
+
+// number of UMC encoders: NumThread, but no more than MCU rows in the picture
+static mfxU32 GetNumEncodeThreads(mfxVideoParam const & par)
+{
+    mfxU32 mcuWidth, mcuHeight;
+    GetMcuSize(par.mfx.FrameInfo.ChromaFormat, mcuWidth, mcuHeight);
+
+    mfxU32 numMcuRows = (par.mfx.FrameInfo.Height + mcuHeight - 1) / mcuHeight;
+
+    return std::max<mfxU32>(1, std::min<mfxU32>({ par.mfx.NumThread, UMC::JPEG_ENC_MAX_THREADS, numMcuRows }));
+}
+
+// resolves MFX_JPEG_RESTART_INTERVAL_AUTO to JPEG_ENC_PIECES_PER_THREAD pieces per encoder,
+// whole MCU rows where the picture allows
+static mfxU16 GetRestartInterval(mfxVideoParam const & par, mfxU32 numThreads)
+{
+    if (par.mfx.RestartInterval != MFX_JPEG_RESTART_INTERVAL_AUTO)
+        return par.mfx.RestartInterval;
+
+    if (numThreads < 2)
+        return 0;
+
+    mfxU32 mcuWidth, mcuHeight;
+    GetMcuSize(par.mfx.FrameInfo.ChromaFormat, mcuWidth, mcuHeight);
+
+    mfxU32 numxMCU = (par.mfx.FrameInfo.Width  + mcuWidth  - 1) / mcuWidth;
+    mfxU32 numyMCU = (par.mfx.FrameInfo.Height + mcuHeight - 1) / mcuHeight;
+    mfxU32 pieces  = numThreads * UMC::JPEG_ENC_PIECES_PER_THREAD;
+
+    mfxU32 interval = (numxMCU * numyMCU + pieces - 1) / pieces;
+    if (interval > numxMCU)
+        interval = (interval + numxMCU - 1) / numxMCU * numxMCU;
+
+    return (mfxU16)std::min<mfxU32>(interval, MFX_JPEG_RESTART_INTERVAL_AUTO - 1);
+}
+
 // check for known ExtBuffers, returns error code. or -1 if found unknown
 // zero mfxExtBuffer* are OK
 static mfxStatus CheckExtBuffers(mfxExtBuffer** ebuffers, mfxU32 nbuffers)
@@ -1035,6 +1118,8 @@ mfxStatus MFXVideoENCODEMJPEG::Query(mfxVideoParam *in, mfxVideoParam *out)
             out->mfx.Quality = in->mfx.Quality;
         }
 
+        out->mfx.RestartInterval = in->mfx.RestartInterval;
+
         switch (in->mfx.FrameInfo.PicStruct)
         {
             case MFX_PICSTRUCT_UNKNOWN:
@@ -1296,6 +1381,12 @@ mfxStatus MFXVideoENCODEMJPEG::Init(mfxVideoParam *par_in)
     m_vFirstParam = *par;
     m_vParam = m_vFirstParam;
 
+    if (!m_vParam.mfx.NumThread)
+        m_vParam.mfx.NumThread = (mfxU16)std::max(std::thread::hardware_concurrency(), 1u);
+
+    mfxU32 numThreads = GetNumEncodeThreads(m_vParam);
+    m_vParam.mfx.RestartInterval = GetRestartInterval(m_vParam, numThreads);
+
     mfxU32 DoubleBytesPerPx = 0;
     switch(m_vParam.mfx.FrameInfo.FourCC)
     {
@@ -1316,7 +1407,7 @@ mfxStatus MFXVideoENCODEMJPEG::Init(mfxVideoParam *par_in)
 
     m_pUmcVideoParams->profile               = m_vParam.mfx.CodecProfile;
     m_pUmcVideoParams->quality               = m_vParam.mfx.Quality;
-    m_pUmcVideoParams->numThreads            = UMC::JPEG_ENC_MAX_THREADS;
+    m_pUmcVideoParams->numThreads            = numThreads;
     m_pUmcVideoParams->chroma_format         = m_vParam.mfx.FrameInfo.ChromaFormat;
     m_pUmcVideoParams->info.clip_info.width  = m_vParam.mfx.FrameInfo.Width;
     m_pUmcVideoParams->info.clip_info.height = m_vParam.mfx.FrameInfo.Height;
@@ -1458,6 +1549,12 @@ mfxStatus MFXVideoENCODEMJPEG::Reset(mfxVideoParam *par)
 
     m_vParam.mfx = par->mfx;
 
+    if (!m_vParam.mfx.NumThread)
+        m_vParam.mfx.NumThread = (mfxU16)std::max(std::thread::hardware_concurrency(), 1u);
+
+    mfxU32 numThreads = GetNumEncodeThreads(m_vParam);
+    m_vParam.mfx.RestartInterval = GetRestartInterval(m_vParam, numThreads);
+
     m_vParam.IOPattern = par->IOPattern;
     m_vParam.Protected = 0;
     
@@ -1484,7 +1581,7 @@ mfxStatus MFXVideoENCODEMJPEG::Reset(mfxVideoParam *par)
 
     m_pUmcVideoParams->profile               = m_vParam.mfx.CodecProfile;
     m_pUmcVideoParams->quality               = m_vParam.mfx.Quality;
-    m_pUmcVideoParams->numThreads            = UMC::JPEG_ENC_MAX_THREADS;
+    m_pUmcVideoParams->numThreads            = numThreads;
     m_pUmcVideoParams->chroma_format         = m_vParam.mfx.FrameInfo.ChromaFormat;
     m_pUmcVideoParams->info.clip_info.width  = m_vParam.mfx.FrameInfo.Width;
     m_pUmcVideoParams->info.clip_info.height = m_vParam.mfx.FrameInfo.Height;
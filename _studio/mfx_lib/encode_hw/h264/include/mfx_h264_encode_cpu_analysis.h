@@ -0,0 +1,106 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <vector>
+
+#include "mfx_h264_encode_cpu_pool.h"
+
+namespace MfxHwH264Encode
+{
+
+// Software replacement of the genx_histogram kernels (CmContext::RunHistogram/QueryHistogram)
+// and of the RaCa complexity of ASC used by CalculateFrameCmplx.
+//
+// Histogram() gives the same bins as HistogramSLMFrame/HistogramSLMFields: the kernels
+// count 32x8 blocks of the grid maxH x maxV starting from block (offX, offY), see
+// CmContext::RunHistogram, so with a crop offset the grid may go past the crop or the
+// surface; reads past the surface are clamped to the edge as reads of a CM surface.
+// The field kernel counts even columns of the frame into bins [0...255] and odd columns
+// into [256...511], the same is done here for CalcPredWeightTable to see the same values.
+//
+// RaCa() gives the value of Calc_RaCa_pic_C of ASC: integer Rs/Cs of 4x4 blocks are
+// summed over rows of blocks in parallel, so the result doesn't depend on the threads.
+class CpuFrameAnalysis
+{
+public:
+    enum
+    {
+        HIST_BINS    = 256,
+        HIST_BLOCK_W = 32,
+        HIST_BLOCK_H = 8,
+        RACA_BLOCK   = 4
+    };
+
+    // Rs/Cs of 'numBlocks' 4x4 blocks from 'src' to the right, as calc_RACA_4x4_C of ASC.
+    // Reads 5 rows and 4 * numBlocks + 1 columns. C and Intel AVX2 versions.
+    static void RaCaRow_C(const mfxU8 * src, mfxI32 pitch, mfxI32 numBlocks, mfxI32 & rs, mfxI32 & cs);
+    static void RaCaRow_AVX2(const mfxU8 * src, mfxI32 pitch, mfxI32 numBlocks, mfxI32 & rs, mfxI32 & cs);
+
+    struct Kernels
+    {
+        void (*RaCaRow)(const mfxU8 *, mfxI32, mfxI32, mfxI32 &, mfxI32 &);
+    };
+
+    static Kernels const & GetKernels();
+
+    CpuFrameAnalysis();
+    ~CpuFrameAnalysis();
+
+    // numThreads = 0 - one per core
+    void Setup(mfxU32 numThreads = 0);
+    void Close();
+
+    // Counterpart of CmContext::RunHistogram + QueryHistogram for luma of 'surfWidth' x 'surfHeight'
+    // and crop (width, height, offsetX, offsetY). 'hist' gets 256 bins, 512 if 'fields'.
+    void Histogram(
+        const mfxU8 * luma,
+        mfxI32        pitch,
+        mfxU32        surfWidth,
+        mfxU32        surfHeight,
+        mfxU32        width,
+        mfxU32        height,
+        mfxU32        offsetX,
+        mfxU32        offsetY,
+        bool          fields,
+        mfxU32 *      hist);
+
+    // Calc_RaCa_pic of ASC, 'luma' is the top-left pixel of the crop; 0 for pictures of 8 pixels or less
+    mfxF64 RaCa(
+        const mfxU8 * luma,
+        mfxI32        pitch,
+        mfxI32        width,
+        mfxI32        height);
+
+protected:
+    mfxU32 GetNumBands(mfxU32 rows) const;
+
+    CpuThreadPool       m_pool;
+    std::vector<mfxU32> m_bandHist;     // bins of each band of the last Histogram()
+    std::vector<mfxI32> m_bandRaCa;     // Rs, Cs of each band of the last RaCa()
+};
+
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
@@ -0,0 +1,145 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <vector>
+#include <functional>
+
+#include "mfx_h264_encode_cpu_pool.h"
+
+namespace MfxHwH264Encode
+{
+class DdiTask;
+class MfxVideoParam;
+struct VmeData;
+
+// Software replacement of the genx_simple_me lookahead kernels (CmContext::RunVme/QueryVme).
+//
+// Frames are downscaled to calcParam.widthLa x heightLa and kept in slots, one per
+// VmeData entry of the encoder, so references are found the same way the GPU path
+// finds m_cmRawLa of the forward/backward tasks. Estimate() fills VmeData with
+// 16x16 intra/inter costs, distortion, motion vectors and coefficient statistics
+// consumed by LookAheadBrc2 and AnalyzeVmeData. MB rows are processed in parallel.
+class CpuLookahead
+{
+public:
+    CpuLookahead();
+    ~CpuLookahead();
+
+    // One slot per element of vmeStorage, task.m_vmeData selects the slot in Run()
+    void Setup(
+        MfxVideoParam const &        video,
+        std::vector<VmeData> const & vmeStorage);
+
+    // width/height - full resolution, scaleFactor - 1, 2 or 4, numThreads = 0 - one per core
+    void Setup(
+        mfxU32 width,
+        mfxU32 height,
+        mfxU32 scaleFactor,
+        mfxU32 numSlots,
+        mfxU32 numThreads = 0);
+
+    void Close();
+
+    mfxU32 GetWidthLa()  const { return m_widthLa; }
+    mfxU32 GetHeightLa() const { return m_heightLa; }
+
+    // Encoder entry point, counterpart of CmContext::RunVme + QueryVme. The first call
+    // downscales task's input surface and starts the estimation on the workers, the calls
+    // return MFX_TASK_BUSY until task.m_vmeData is filled. Frames are run one at a time.
+    mfxStatus Run(
+        VideoCORE &           core,
+        MfxVideoParam const & video,
+        DdiTask const &       task);
+
+    // Signaled when the estimation started by Run() is done, -1 - none
+    int GetCompletionHandle() const { return m_pool.GetCompletionHandle(); }
+
+    // Downscales full resolution luma into 'slot'
+    void Downscale(
+        mfxU32         slot,
+        mfxU8 const *  luma,
+        mfxU32         pitch);
+
+    // Estimates costs of the picture in 'slot' against the pictures in slotL0/slotL1
+    // (-1 - no reference). biWeight is the L1 weight of bi-prediction in 1/64 units.
+    void Estimate(
+        mfxU32         slot,
+        mfxU32         frameType,
+        mfxI32         slotL0,
+        mfxI32         slotL1,
+        mfxU32         biWeight,
+        VmeData &      vme);
+
+    // MB-tree propagation of 'cur' into its references, parallel version of
+    // the per-frame step of AnalyzeVmeData. Motion vectors must come from Estimate().
+    void Propagate(
+        VmeData const & cur,
+        VmeData *       l0,
+        VmeData *       l1);
+
+protected:
+    struct Plane
+    {
+        std::vector<mfxU8> buf;
+        mfxU8 *            y;      // top-left pixel, surrounded by PAD replicated pixels
+        std::vector<mfxU8> buf2;
+        mfxU8 *            y2;     // 2x downscaled copy for the coarse search
+    };
+
+    void EstimateRow(
+        mfxU32         row,
+        Plane const &  cur,
+        Plane const *  l0,
+        Plane const *  l1,
+        mfxU32         frameType,
+        mfxU32         biWeight,
+        VmeData &      vme);
+
+    std::function<void(mfxU32)> GetEstimateJob(
+        mfxU32         slot,
+        mfxU32         frameType,
+        mfxI32         slotL0,
+        mfxI32         slotL1,
+        mfxU32         biWeight,
+        VmeData &      vme);
+
+    mfxI32 GetSlot(VmeData const * vme) const;
+
+    mfxU32              m_width;
+    mfxU32              m_height;
+    mfxU32              m_scale;
+    mfxU32              m_widthLa;
+    mfxU32              m_heightLa;
+    mfxI32              m_pitch;
+    mfxI32              m_pitch2;
+    std::vector<Plane>  m_planes;
+    VmeData const *     m_vmeBase;
+    VmeData *           m_running;  // estimated by the workers
+    CpuThreadPool       m_pool;
+};
+
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
@@ -0,0 +1,87 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace MfxHwH264Encode
+{
+
+// Worker threads of the CPU fallbacks of the CM kernels (CpuLookahead, CpuFrameAnalysis).
+// ParallelFor() runs job(0)...job(count - 1) on the workers and the calling thread
+// and returns when all items are done. Submit() starts them on the workers only and
+// returns at once, the completion handle is signaled when they are done, so a task
+// of the scheduler can return MFX_TASK_BUSY and wait for the handle instead of
+// holding its thread. Jobs of one pool are run one at a time.
+class CpuThreadPool
+{
+public:
+    CpuThreadPool();
+    ~CpuThreadPool();
+
+    // numThreads counts the calling thread, 0 - one per core
+    void Start(mfxU32 numThreads);
+    void Stop();
+
+    mfxU32 GetNumThreads() const { return mfxU32(m_workers.size()) + 1; }
+
+    void ParallelFor(mfxU32 count, std::function<void(mfxU32)> const & job);
+
+    // Without workers the items are run before the return
+    void Submit(mfxU32 count, std::function<void(mfxU32)> job);
+
+    // Whether the items of the last Submit() are done, Wait() blocks until they are
+    bool IsDone();
+    void Wait();
+
+    // eventfd readable from the end of a submitted job to the next Submit(), -1 if there is none
+    int GetCompletionHandle() const { return m_event; }
+
+protected:
+    void WorkerLoop();
+    void RunJob();
+    void SignalCompletion();
+
+    std::vector<std::thread>             m_workers;
+    std::mutex                           m_mutex;
+    std::condition_variable              m_wake;
+    std::condition_variable              m_done;
+    std::function<void(mfxU32)> const *  m_job;
+    std::function<void(mfxU32)>          m_submitted;
+    mfxU32                               m_jobSize;
+    mfxU32                               m_jobNext;
+    mfxU32                               m_jobPending;
+    mfxU32                               m_generation;
+    bool                                 m_async;
+    bool                                 m_stop;
+    int                                  m_event;
+};
+
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
@@ -33,6 +33,7 @@
 #include "mfx_h264_enc_common_hw.h"
 #include "mfx_ext_buffers.h"
 #include "mfx_h264_encode_interface.h"
+#include "mfx_task.h"
 #include "mfx_h264_encode_cm.h"
 #include "vm_time.h"
 #include "asc.h"
@@ -355,6 +356,10 @@ namespace MfxHwH264Encode
         mfxStatus AllocFrames(
             VideoCORE *            core,
             mfxFrameAllocRequest & req);
+
+        // system memory buffers without CM, mids are the buffers
+        mfxStatus AllocSysBuffers(
+            mfxFrameAllocRequest & req);
         mfxStatus UpdateResourcePointers(
             mfxU32                 idxScd,
             void *                 memY,
@@ -1777,6 +1782,8 @@ namespace MfxHwH264Encode
     };
 
     class CmContext;
+    class CpuLookahead;
+    class CpuFrameAnalysis;
 
     struct VmeData
     {
@@ -2006,6 +2013,14 @@ namespace MfxHwH264Encode
         mfxStatus AsyncRoutine(
             mfxBitstream * bs);
 
+        // STG_BIT_WAIT_ENCODE stage, MFX_TASK_BUSY until the device is done
+        mfxStatus WaitEncode(
+            mfxBitstream * bs);
+
+        // continuation of AsyncRoutine suspended in WaitEncode
+        mfxStatus ResumeWaitEncode(
+            mfxBitstream * bs);
+
         void OnNewFrame();
         void SubmitScd();
         void OnScdQueried();
@@ -2032,6 +2047,22 @@ namespace MfxHwH264Encode
             mfxU32 threadNumber,
             mfxU32 callNumber);
 
+        static mfxStatus WaitEncodeRoutineHelper(
+            void * state,
+            void * param,
+            mfxU32 threadNumber,
+            mfxU32 callNumber);
+
+        mfxStatus CallAsyncRoutine(
+            mfxStatus (ImplementationAvc::*routine)(mfxBitstream *),
+            void * param);
+
+        // make the scheduler continue the busy task at the routine,
+        // wait for the device here if it can't
+        void Suspend(
+            void *         param,
+            mfxTaskRoutine routine);
+
         void RunPreMe(
             MfxVideoParam const & video,
             DdiTask const &       task);
@@ -2042,6 +2073,9 @@ namespace MfxHwH264Encode
         mfxStatus QueryLookahead(
             DdiTask & task);
 
+        mfxStatus RunCpuHistogram(
+            DdiTask & task);
+
         mfxStatus QueryStatus(
             DdiTask & task,
             mfxU32    ffid);
@@ -2094,6 +2128,10 @@ namespace MfxHwH264Encode
         mfxU32              m_stagesToGo;
         mfxU32              m_bDeferredFrame;
 
+        bool                m_bWaitingEncode;   // AsyncRoutine is suspended in WaitEncode
+        bool                m_bWaitingLa;       // AsyncRoutine is suspended in QueryLookahead of CPU lookahead
+        int                 m_completionHandle; // of the device or the lookahead workers busy with the task, -1 - none
+
         mfxU32      m_fieldCounter;
         mfxStatus   m_1stFieldStatus;
         mfxU32      m_frameOrder;
@@ -2152,6 +2190,9 @@ namespace MfxHwH264Encode
         // bitrate reset for SNB
 
         std::unique_ptr<CmContext>    m_cmCtx;
+        std::unique_ptr<CpuLookahead> m_cpuLa;
+        std::unique_ptr<CpuFrameAnalysis> m_cpuAnalysis;
+        bool                        m_useCpuHist;
         std::vector<VmeData>        m_vmeDataStorage;
         std::vector<VmeData *>      m_tmpVmeData;
 
@@ -2657,11 +2698,13 @@ namespace MfxHwH264Encode
         mfxMemId    mid,
         bool        external = false);
 
+    // cpuLa != 0 - MB rows of every frame are propagated on CpuLookahead threads
     void AnalyzeVmeData(
-        DdiTaskIter begin,
-        DdiTaskIter end,
-        mfxU32      width,
-        mfxU32      height);
+        DdiTaskIter    begin,
+        DdiTaskIter    end,
+        mfxU32         width,
+        mfxU32         height,
+        CpuLookahead * cpuLa = 0);
 
     void CalcPredWeightTable(
         DdiTask & task,
@@ -2720,5 +2763,40 @@ namespace MfxHwH264Encode
     }
 }; // namespace MfxHwH264Encode
 
+// Rate estimation and cost propagation of the lookahead (mfx_h264_encode_hw_utils.cpp,
+// mfx_h264_encode_hw_utils_new.cpp), shared with CpuLookahead, FEI LA and tools/la_brc_perf
+namespace MfxHwH264EncodeHW
+{
+    extern mfxF64 const QSTEP[52];
+    mfxF64 const        INTRA_QSTEP_COEFF = 2.0;
+
+    // lowest qp at which an inter MB is skipped, 52 - never
+    mfxU8 GetSkippedQp(MfxHwH264Encode::MbData const & mb);
+
+    void EstimateRatePerQp(
+        std::vector<MfxHwH264Encode::MbData> const & mb,
+        mfxF64                                       laMultiplier,
+        mfxU32                                       numMb,
+        mfxF64                                       estRate[52]);
+
+    void DivideCost(
+        std::vector<MfxHwH264Encode::MbData> & mb,
+        mfxI32                                 width,
+        mfxI32                                 height,
+        mfxU32                                 cost,
+        mfxI32                                 x,
+        mfxI32                                 y);
+
+    // propagates costs of MB rows [rowBegin, rowEnd) of 'cur' to its references
+    void PropagateRows(
+        MfxHwH264Encode::VmeData const & cur,
+        MfxHwH264Encode::VmeData *       l0,
+        MfxHwH264Encode::VmeData *       l1,
+        mfxI32                           w,
+        mfxI32                           h,
+        mfxI32                           rowBegin,
+        mfxI32                           rowEnd);
+};
+
 #endif // _MFX_H264_ENCODE_HW_UTILS_H_
 #endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
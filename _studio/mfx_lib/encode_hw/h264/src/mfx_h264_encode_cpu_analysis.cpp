@@ -0,0 +1,211 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <math.h>
+#include <algorithm>
+
+#include "mfx_h264_encode_cpu_analysis.h"
+#include "asc_common_impl.h"
+
+#define H264_CPU_DISP_INIT_C(func)           (func ## _C)
+#define H264_CPU_DISP_INIT_AVX2(func)        (func ## _AVX2)
+#define H264_CPU_DISP_INIT_AVX2_C(func)      (m_AVX2_available ? H264_CPU_DISP_INIT_AVX2(func) : H264_CPU_DISP_INIT_C(func))
+
+using namespace MfxHwH264Encode;
+
+namespace
+{
+    const mfxU32 BANDS_PER_THREAD = 4;
+
+    void CountRow(const mfxU8 * row, mfxU32 begin, mfxU32 end, mfxU32 * hist)
+    {
+        for (mfxU32 x = begin; x < end; x++)
+            hist[row[x]]++;
+    }
+
+    void CountRowFields(const mfxU8 * row, mfxU32 begin, mfxU32 end, mfxU32 * hist)
+    {
+        for (mfxU32 x = begin; x < end; x++)
+            hist[row[x] + ((x & 1) << 8)]++;
+    }
+};
+
+static mfxI32 CpuFeature_AVX2()
+{
+    return((__builtin_cpu_supports("avx2")));
+}
+
+CpuFrameAnalysis::Kernels const & CpuFrameAnalysis::GetKernels()
+{
+    static const int m_AVX2_available = CpuFeature_AVX2();
+
+    static const Kernels kernels =
+    {
+        H264_CPU_DISP_INIT_AVX2_C(RaCaRow)
+    };
+
+    return kernels;
+}
+
+void CpuFrameAnalysis::RaCaRow_C(const mfxU8 * src, mfxI32 pitch, mfxI32 numBlocks, mfxI32 & rs, mfxI32 & cs)
+{
+    for (mfxI32 i = 0; i < numBlocks; i++)
+        calc_RACA_4x4_C(const_cast<mfxU8 *>(src) + i * RACA_BLOCK, pitch, &rs, &cs);
+}
+
+CpuFrameAnalysis::CpuFrameAnalysis()
+{
+}
+
+CpuFrameAnalysis::~CpuFrameAnalysis()
+{
+    Close();
+}
+
+void CpuFrameAnalysis::Setup(mfxU32 numThreads)
+{
+    Close();
+    m_pool.Start(numThreads);
+}
+
+void CpuFrameAnalysis::Close()
+{
+    m_pool.Stop();
+    m_bandHist.clear();
+    m_bandRaCa.clear();
+}
+
+mfxU32 CpuFrameAnalysis::GetNumBands(mfxU32 rows) const
+{
+    return std::max<mfxU32>(std::min(rows, m_pool.GetNumThreads() * BANDS_PER_THREAD), 1);
+}
+
+void CpuFrameAnalysis::Histogram(
+    const mfxU8 * luma,
+    mfxI32        pitch,
+    mfxU32        surfWidth,
+    mfxU32        surfHeight,
+    mfxU32        width,
+    mfxU32        height,
+    mfxU32        offsetX,
+    mfxU32        offsetY,
+    bool          fields,
+    mfxU32 *      hist)
+{
+    const mfxU32 numBins = fields ? 2 * HIST_BINS : HIST_BINS;
+    std::fill(hist, hist + numBins, 0);
+
+    // block grid of CmContext::RunHistogram
+    const mfxU32 maxH = (width + offsetX) / HIST_BLOCK_W;
+    const mfxU32 maxV = (height + offsetY) / HIST_BLOCK_H;
+    const mfxU32 offX = (offsetX + HIST_BLOCK_W - 1) / HIST_BLOCK_W;
+    const mfxU32 offY = (offsetY + HIST_BLOCK_H - 1) / HIST_BLOCK_H;
+
+    if (!maxH || !maxV || !surfWidth || !surfHeight)
+        return;
+
+    // columns [x0, xIn) are inside the surface, [xIn, x1) read the last column
+    const mfxU32 x0  = offX * HIST_BLOCK_W;
+    const mfxU32 x1  = (offX + maxH) * HIST_BLOCK_W;
+    const mfxU32 xIn = std::min(std::max(surfWidth, x0), x1);
+
+    const mfxU32 numBands = GetNumBands(maxV);
+    m_bandHist.assign(size_t(numBands) * numBins, 0);
+
+    m_pool.ParallelFor(numBands, [&](mfxU32 band)
+    {
+        mfxU32 * bandHist = m_bandHist.data() + size_t(band) * numBins;
+        const mfxU32 firstRow = (offY + band * maxV / numBands) * HIST_BLOCK_H;
+        const mfxU32 lastRow  = (offY + (band + 1) * maxV / numBands) * HIST_BLOCK_H;
+
+        for (mfxU32 y = firstRow; y < lastRow; y++)
+        {
+            const mfxU8 * row  = luma + size_t(std::min(y, surfHeight - 1)) * pitch;
+            const mfxU8   edge = row[surfWidth - 1];
+
+            if (fields)
+            {
+                CountRowFields(row, x0, xIn, bandHist);
+                // columns of the grid alternate between the fields
+                bandHist[edge]             += (x1 - xIn + 1 - (xIn & 1)) / 2;
+                bandHist[edge + HIST_BINS] += (x1 - xIn + (xIn & 1)) / 2;
+            }
+            else
+            {
+                CountRow(row, x0, xIn, bandHist);
+                bandHist[edge] += x1 - xIn;
+            }
+        }
+    });
+
+    for (mfxU32 band = 0; band < numBands; band++)
+        for (mfxU32 i = 0; i < numBins; i++)
+            hist[i] += m_bandHist[size_t(band) * numBins + i];
+}
+
+mfxF64 CpuFrameAnalysis::RaCa(
+    const mfxU8 * luma,
+    mfxI32        pitch,
+    mfxI32        width,
+    mfxI32        height)
+{
+    mfxI32 w4 = (width - 8) >> 2;
+    mfxI32 h4 = (height - 8) >> 2;
+
+    if (w4 <= 0 || h4 <= 0)
+        return 0;
+
+    // blocks at 4, 8, ... below width - 4 and height - 4 as in Calc_RaCa_pic_C
+    const mfxI32 numBlocks = (width - 8 + RACA_BLOCK - 1) / RACA_BLOCK;
+    const mfxU32 numRows   = mfxU32(height - 8 + RACA_BLOCK - 1) / RACA_BLOCK;
+    const mfxU32 numBands  = GetNumBands(numRows);
+
+    Kernels const & kernels = GetKernels();
+    m_bandRaCa.assign(2 * numBands, 0);
+
+    m_pool.ParallelFor(numBands, [&](mfxU32 band)
+    {
+        mfxI32 rs = 0, cs = 0;
+
+        for (mfxU32 row = band * numRows / numBands; row < (band + 1) * numRows / numBands; row++)
+            kernels.RaCaRow(luma + (row + 1) * RACA_BLOCK * pitch + RACA_BLOCK, pitch, numBlocks, rs, cs);
+
+        m_bandRaCa[2 * band + 0] = rs;
+        m_bandRaCa[2 * band + 1] = cs;
+    });
+
+    mfxI32 Rs = 0, Cs = 0;
+    for (mfxU32 band = 0; band < numBands; band++)
+    {
+        Rs += m_bandRaCa[2 * band + 0];
+        Cs += m_bandRaCa[2 * band + 1];
+    }
+
+    mfxF64 d1 = 1.0 / (mfxF64)(w4*h4);
+    mfxF64 drs = (mfxF64)Rs * d1;
+    mfxF64 dcs = (mfxF64)Cs * d1;
+
+    return sqrt(drs * drs + dcs * dcs);
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
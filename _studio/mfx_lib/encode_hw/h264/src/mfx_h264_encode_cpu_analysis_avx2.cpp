@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This file is compiled with -mavx2, functions are selected at run time by mfx_h264_encode_cpu_analysis.cpp
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <immintrin.h>
+
+#include "mfx_h264_encode_cpu_analysis.h"
+
+using namespace MfxHwH264Encode;
+
+static inline __m256i AbsDiff(__m256i a, __m256i b)
+{
+    return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+}
+
+// 8 blocks per iteration, sums of 4 bytes of a row are the dwords of the blocks
+void CpuFrameAnalysis::RaCaRow_AVX2(const mfxU8 * src, mfxI32 pitch, mfxI32 numBlocks, mfxI32 & rs, mfxI32 & cs)
+{
+    const __m256i ones8  = _mm256_set1_epi8(1);
+    const __m256i ones16 = _mm256_set1_epi16(1);
+
+    __m256i accRs = _mm256_setzero_si256();
+    __m256i accCs = _mm256_setzero_si256();
+    mfxI32 i = 0;
+
+    for (; i + 8 <= numBlocks; i += 8, src += 8 * RACA_BLOCK)
+    {
+        __m256i blockRs = _mm256_setzero_si256();
+        __m256i blockCs = _mm256_setzero_si256();
+        __m256i cur     = _mm256_loadu_si256((const __m256i *)src);
+
+        for (mfxI32 k = 0; k < RACA_BLOCK; k++)
+        {
+            const __m256i right = _mm256_loadu_si256((const __m256i *)(src + k * pitch + 1));
+            const __m256i below = _mm256_loadu_si256((const __m256i *)(src + (k + 1) * pitch));
+
+            blockCs = _mm256_add_epi32(blockCs, _mm256_madd_epi16(_mm256_maddubs_epi16(AbsDiff(cur, right), ones8), ones16));
+            blockRs = _mm256_add_epi32(blockRs, _mm256_madd_epi16(_mm256_maddubs_epi16(AbsDiff(cur, below), ones8), ones16));
+            cur = below;
+        }
+
+        // Rs >> 4, Cs >> 4 of each block
+        accRs = _mm256_add_epi32(accRs, _mm256_srli_epi32(blockRs, 4));
+        accCs = _mm256_add_epi32(accCs, _mm256_srli_epi32(blockCs, 4));
+    }
+
+    // dwords 0...3 - Rs, 4...7 - Cs
+    __m128i sum = _mm_hadd_epi32(
+        _mm_add_epi32(_mm256_castsi256_si128(accRs), _mm256_extracti128_si256(accRs, 1)),
+        _mm_add_epi32(_mm256_castsi256_si128(accCs), _mm256_extracti128_si256(accCs, 1)));
+    sum = _mm_hadd_epi32(sum, sum);
+
+    rs += _mm_cvtsi128_si32(sum);
+    cs += _mm_extract_epi32(sum, 1);
+
+    _mm256_zeroupper();
+
+    if (i < numBlocks)
+        RaCaRow_C(src, pitch, numBlocks - i, rs, cs);
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
@@ -0,0 +1,733 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <algorithm>
+#include <assert.h>
+#include <emmintrin.h>
+
+#include "mfx_h264_encode_cpu_la.h"
+#include "mfx_h264_encode_hw_utils.h"
+
+using namespace MfxHwH264Encode;
+
+using namespace MfxHwH264EncodeHW;
+
+namespace
+{
+    const mfxI32 PAD          = 32;  // replicated border around downscaled luma
+    const mfxI32 PAD2         = 16;  // same for the half resolution copy used by the coarse search
+    const mfxI32 SEARCH_RANGE = 8;   // exhaustive 8x8 search at half resolution, +-16 pixels at LA resolution
+    const mfxI32 MAX_MV       = 24;  // after refinement, blocks must stay inside PAD
+    const mfxU32 MAX_REFINE   = 16;
+
+    // MB row y propagates into rows [y - MV_ROWS, y + MV_ROWS + 1] of the reference,
+    // bands of PROPAGATION_BAND rows with a band in between never touch the same MB
+    const mfxI32 MV_ROWS          = (MAX_MV + 15) / 16;
+    const mfxI32 PROPAGATION_BAND = 2 * MV_ROWS + 2;
+
+    // cost of one bit in SATD units, approximates lambda at QP 26 used by CmContext::RunVme
+    const mfxU32 LAMBDA           = 4;
+    const mfxU32 INTRA_16x16_BITS = 4;
+    const mfxU32 INTER_16x16_BITS = 2;
+    const mfxU32 BI_16x16_BITS    = 4;
+
+    mfxU32 MvBits(mfxI32 d) // quarter-pel mvd, se(v)
+    {
+        return ExpGolombCodeLength(d > 0 ? 2 * d - 1 : -2 * d);
+    }
+
+    mfxU32 MvCost(mfxI32 dx, mfxI32 dy, mfxI16Pair pred) // dx, dy - integer pels
+    {
+        return LAMBDA * (MvBits(4 * dx - pred.x) + MvBits(4 * dy - pred.y));
+    }
+
+    mfxU32 Sad16x16(mfxU8 const * a, mfxU8 const * b, mfxI32 pitch)
+    {
+        __m128i s0 = _mm_setzero_si128();
+        __m128i s1 = _mm_setzero_si128();
+
+        for (mfxI32 y = 0; y < 16; y += 2)
+        {
+            s0 = _mm_add_epi64(s0, _mm_sad_epu8(
+                _mm_loadu_si128((__m128i const *)(a + (y + 0) * pitch)),
+                _mm_loadu_si128((__m128i const *)(b + (y + 0) * pitch))));
+            s1 = _mm_add_epi64(s1, _mm_sad_epu8(
+                _mm_loadu_si128((__m128i const *)(a + (y + 1) * pitch)),
+                _mm_loadu_si128((__m128i const *)(b + (y + 1) * pitch))));
+        }
+
+        s0 = _mm_add_epi64(s0, s1);
+        return mfxU32(_mm_cvtsi128_si32(s0) + _mm_cvtsi128_si32(_mm_srli_si128(s0, 8)));
+    }
+
+    mfxU32 Sad8x8(mfxU8 const * a, mfxU8 const * b, mfxI32 pitch)
+    {
+        __m128i s = _mm_setzero_si128();
+
+        for (mfxI32 y = 0; y < 8; y += 2)
+        {
+            __m128i ra = _mm_unpacklo_epi64(
+                _mm_loadl_epi64((__m128i const *)(a + (y + 0) * pitch)),
+                _mm_loadl_epi64((__m128i const *)(a + (y + 1) * pitch)));
+            __m128i rb = _mm_unpacklo_epi64(
+                _mm_loadl_epi64((__m128i const *)(b + (y + 0) * pitch)),
+                _mm_loadl_epi64((__m128i const *)(b + (y + 1) * pitch)));
+            s = _mm_add_epi64(s, _mm_sad_epu8(ra, rb));
+        }
+
+        return mfxU32(_mm_cvtsi128_si32(s) + _mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+    }
+
+    // SATD of 8x8 residual (sum of abs Hadamard coefficients / 4) and statistics of
+    // coefficients in orthonormal scale (|h| / 8) used by GetSkippedQp()
+    mfxU32 Satd8x8(mfxI16 const * diff, mfxU16 & coeffSum, mfxU8 & coeffCnt)
+    {
+        mfxI32 t[64];
+
+        for (mfxI32 i = 0; i < 8; i++)
+        {
+            mfxI16 const * d = diff + i * 16;
+            mfxI32 a0 = d[0] + d[4], a4 = d[0] - d[4];
+            mfxI32 a1 = d[1] + d[5], a5 = d[1] - d[5];
+            mfxI32 a2 = d[2] + d[6], a6 = d[2] - d[6];
+            mfxI32 a3 = d[3] + d[7], a7 = d[3] - d[7];
+            mfxI32 b0 = a0 + a2, b2 = a0 - a2, b1 = a1 + a3, b3 = a1 - a3;
+            mfxI32 b4 = a4 + a6, b6 = a4 - a6, b5 = a5 + a7, b7 = a5 - a7;
+            mfxI32 * r = t + i * 8;
+            r[0] = b0 + b1; r[1] = b0 - b1; r[2] = b2 + b3; r[3] = b2 - b3;
+            r[4] = b4 + b5; r[5] = b4 - b5; r[6] = b6 + b7; r[7] = b6 - b7;
+        }
+
+        mfxU32 sum = 0;
+        mfxU32 csum = 0;
+        mfxU32 cnt = 0;
+
+        for (mfxI32 i = 0; i < 8; i++)
+        {
+            mfxI32 const * c = t + i;
+            mfxI32 a0 = c[0] + c[32], a4 = c[0] - c[32];
+            mfxI32 a1 = c[8] + c[40], a5 = c[8] - c[40];
+            mfxI32 a2 = c[16] + c[48], a6 = c[16] - c[48];
+            mfxI32 a3 = c[24] + c[56], a7 = c[24] - c[56];
+            mfxI32 b0 = a0 + a2, b2 = a0 - a2, b1 = a1 + a3, b3 = a1 - a3;
+            mfxI32 b4 = a4 + a6, b6 = a4 - a6, b5 = a5 + a7, b7 = a5 - a7;
+            mfxI32 h[8] = { b0 + b1, b0 - b1, b2 + b3, b2 - b3, b4 + b5, b4 - b5, b6 + b7, b6 - b7 };
+
+            for (mfxI32 j = 0; j < 8; j++)
+            {
+                mfxU32 v = mfxU32(abs(h[j]));
+                sum += v;
+                if (v >= 8)
+                {
+                    csum += v >> 3;
+                    cnt++;
+                }
+            }
+        }
+
+        coeffSum = mfxU16(std::min<mfxU32>(csum, 0xffff));
+        coeffCnt = mfxU8(cnt);
+        return (sum + 2) >> 2;
+    }
+
+    mfxU32 Satd16x16(
+        mfxU8 const * src,
+        mfxI32        srcPitch,
+        mfxU8 const * pred,
+        mfxI32        predPitch,
+        mfxU16        (&coeffSum)[4],
+        mfxU8         (&coeffCnt)[4])
+    {
+        mfxI16 diff[16 * 16];
+        for (mfxI32 y = 0; y < 16; y++)
+            for (mfxI32 x = 0; x < 16; x++)
+                diff[y * 16 + x] = mfxI16(src[y * srcPitch + x] - pred[y * predPitch + x]);
+
+        return Satd8x8(diff + 0,       coeffSum[0], coeffCnt[0])
+             + Satd8x8(diff + 8,       coeffSum[1], coeffCnt[1])
+             + Satd8x8(diff + 8 * 16,  coeffSum[2], coeffCnt[2])
+             + Satd8x8(diff + 8 * 17,  coeffSum[3], coeffCnt[3]);
+    }
+
+    struct SearchResult
+    {
+        mfxI32 dx;
+        mfxI32 dy;
+        mfxU32 cost;
+    };
+
+    // Integer-pel search: exhaustive 8x8 search at half resolution (co-located 16x16 block
+    // downscaled), then 16x16 +-2/+-1 diamond refinement from the best of the coarse vector,
+    // the predictor and zero vector
+    SearchResult Search(
+        mfxU8 const * src,
+        mfxU8 const * ref,  // co-located block in the reference
+        mfxI32        pitch,
+        mfxU8 const * src2, // same at half resolution
+        mfxU8 const * ref2,
+        mfxI32        pitch2,
+        mfxI16Pair    pred) // quarter-pel
+    {
+        mfxI32 cdx = 0;
+        mfxI32 cdy = 0;
+        mfxU32 coarse = mfxU32(-1);
+
+        for (mfxI32 dy = -SEARCH_RANGE; dy <= SEARCH_RANGE; dy++)
+        {
+            for (mfxI32 dx = -SEARCH_RANGE; dx <= SEARCH_RANGE; dx++)
+            {
+                mfxU32 cost = Sad8x8(src2, ref2 + dy * pitch2 + dx, pitch2) + (MvCost(2 * dx, 2 * dy, pred) >> 2);
+                if (cost < coarse)
+                {
+                    coarse = cost;
+                    cdx = dx;
+                    cdy = dy;
+                }
+            }
+        }
+
+        SearchResult best = { 0, 0, Sad16x16(src, ref, pitch) + MvCost(0, 0, pred) };
+
+        auto check = [&](mfxI32 dx, mfxI32 dy)
+        {
+            dx = mfx::clamp(dx, -MAX_MV, MAX_MV);
+            dy = mfx::clamp(dy, -MAX_MV, MAX_MV);
+            mfxU32 cost = Sad16x16(src, ref + dy * pitch + dx, pitch) + MvCost(dx, dy, pred);
+            if (cost < best.cost)
+            {
+                best.dx   = dx;
+                best.dy   = dy;
+                best.cost = cost;
+                return true;
+            }
+            return false;
+        };
+
+        check(2 * cdx, 2 * cdy);
+        check((pred.x + 2) >> 2, (pred.y + 2) >> 2);
+
+        for (mfxI32 step = 2; step > 0; step >>= 1)
+        {
+            for (mfxU32 i = 0; i < MAX_REFINE; i++)
+            {
+                mfxI32 cx = best.dx;
+                mfxI32 cy = best.dy;
+                bool improved = false;
+                improved |= check(cx - step, cy);
+                improved |= check(cx + step, cy);
+                improved |= check(cx, cy - step);
+                improved |= check(cx, cy + step);
+                if (!improved)
+                    break;
+            }
+        }
+
+        return best;
+    }
+
+    // 16x16 DC/vertical/horizontal prediction from source pixels of neighbour MBs
+    mfxU32 EstimateIntra(
+        mfxU8 const * src,
+        mfxI32        pitch,
+        bool          top,
+        bool          left,
+        mfxU16        (&coeffSum)[4],
+        mfxU8         (&coeffCnt)[4])
+    {
+        mfxU8 pred[16 * 16];
+        mfxU32 dc = 0;
+
+        if (top)
+            for (mfxI32 x = 0; x < 16; x++)
+                dc += src[x - pitch];
+        if (left)
+            for (mfxI32 y = 0; y < 16; y++)
+                dc += src[y * pitch - 1];
+
+        dc = (top && left) ? (dc + 16) >> 5 : (top || left) ? (dc + 8) >> 4 : 128;
+        memset(pred, mfxU8(dc), sizeof(pred));
+
+        mfxU32 best = Satd16x16(src, pitch, pred, 16, coeffSum, coeffCnt);
+
+        mfxU16 sum[4];
+        mfxU8  cnt[4];
+
+        if (top)
+        {
+            for (mfxI32 y = 0; y < 16; y++)
+                memcpy(pred + y * 16, src - pitch, 16);
+
+            mfxU32 satd = Satd16x16(src, pitch, pred, 16, sum, cnt);
+            if (satd < best)
+            {
+                best = satd;
+                Copy(coeffSum, sum);
+                Copy(coeffCnt, cnt);
+            }
+        }
+
+        if (left)
+        {
+            for (mfxI32 y = 0; y < 16; y++)
+                memset(pred + y * 16, src[y * pitch - 1], 16);
+
+            mfxU32 satd = Satd16x16(src, pitch, pred, 16, sum, cnt);
+            if (satd < best)
+            {
+                best = satd;
+                Copy(coeffSum, sum);
+                Copy(coeffCnt, cnt);
+            }
+        }
+
+        return best;
+    }
+
+    void PadPlane(mfxU8 * y, mfxI32 pitch, mfxU32 width, mfxU32 height, mfxI32 pad)
+    {
+        for (mfxU32 i = 0; i < height; i++)
+        {
+            mfxU8 * row = y + i * pitch;
+            memset(row - pad, row[0], pad);
+            memset(row + width, row[width - 1], pad);
+        }
+
+        mfxU8 * first = y - pad;
+        mfxU8 * last  = y - pad + (height - 1) * pitch;
+        for (mfxI32 i = 1; i <= pad; i++)
+        {
+            memcpy(first - i * pitch, first, pitch);
+            memcpy(last  + i * pitch, last,  pitch);
+        }
+    }
+
+    void SumCosts(VmeData & vme)
+    {
+        vme.intraCost = 0;
+        vme.interCost = 0;
+
+        for (size_t i = 0; i < vme.mb.size(); i++)
+        {
+            vme.intraCost += vme.mb[i].intraCost;
+            vme.interCost += vme.mb[i].interCost;
+        }
+    }
+}
+
+CpuLookahead::CpuLookahead()
+    : m_width(0)
+    , m_height(0)
+    , m_scale(1)
+    , m_widthLa(0)
+    , m_heightLa(0)
+    , m_pitch(0)
+    , m_pitch2(0)
+    , m_vmeBase(0)
+    , m_running(0)
+{
+}
+
+CpuLookahead::~CpuLookahead()
+{
+    Close();
+}
+
+void CpuLookahead::Setup(
+    MfxVideoParam const &        video,
+    std::vector<VmeData> const & vmeStorage)
+{
+    mfxExtCodingOption2 const & extOpt2 = GetExtBufferRef(video);
+
+    Setup(video.mfx.FrameInfo.Width, video.mfx.FrameInfo.Height,
+        LaDSenumToFactor(extOpt2.LookAheadDS), mfxU32(vmeStorage.size()), video.mfx.NumThread);
+
+    m_vmeBase = vmeStorage.empty() ? 0 : &vmeStorage[0];
+}
+
+void CpuLookahead::Setup(
+    mfxU32 width,
+    mfxU32 height,
+    mfxU32 scaleFactor,
+    mfxU32 numSlots,
+    mfxU32 numThreads)
+{
+    Close();
+
+    m_width    = width;
+    m_height   = height;
+    m_scale    = std::max<mfxU32>(scaleFactor, 1);
+    m_widthLa  = mfx::align2_value(width  / m_scale, 16);
+    m_heightLa = mfx::align2_value(height / m_scale, 16);
+    m_pitch    = mfxI32(m_widthLa + 2 * PAD);
+    m_pitch2   = mfxI32(m_widthLa / 2 + 2 * PAD2);
+
+    m_planes.resize(numSlots);
+    for (Plane & plane : m_planes)
+    {
+        plane.buf.assign(size_t(m_pitch) * (m_heightLa + 2 * PAD), 0);
+        plane.y = plane.buf.data() + PAD * m_pitch + PAD;
+        plane.buf2.assign(size_t(m_pitch2) * (m_heightLa / 2 + 2 * PAD2), 0);
+        plane.y2 = plane.buf2.data() + PAD2 * m_pitch2 + PAD2;
+    }
+
+    if (!numThreads)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    numThreads = std::min(numThreads, m_heightLa / 16);
+
+    m_pool.Start(numThreads);
+}
+
+void CpuLookahead::Close()
+{
+    m_pool.Stop();
+    m_planes.clear();
+    m_vmeBase = 0;
+    m_running = 0;
+}
+
+mfxI32 CpuLookahead::GetSlot(VmeData const * vme) const
+{
+    if (!vme || !m_vmeBase || vme < m_vmeBase || vme >= m_vmeBase + m_planes.size())
+        return -1;
+
+    return mfxI32(vme - m_vmeBase);
+}
+
+mfxStatus CpuLookahead::Run(
+    VideoCORE &           core,
+    MfxVideoParam const & video,
+    DdiTask const &       task)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "CpuLookahead::Run");
+
+    mfxI32 slot = GetSlot(task.m_vmeData);
+    MFX_CHECK(slot >= 0, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    // frame of the encoder reset before it was queried
+    if (m_running && m_running != task.m_vmeData)
+    {
+        m_pool.Wait();
+        m_running = 0;
+    }
+
+    if (!m_running)
+    {
+        mfxExtOpaqueSurfaceAlloc const & extOpaq = GetExtBufferRef(video);
+        mfxExtPpsHeader const &          extPps  = GetExtBufferRef(video);
+
+        mfxFrameSurface1 * surface = task.m_yuv;
+        bool external = true;
+
+        if (video.IOPattern == MFX_IOPATTERN_IN_OPAQUE_MEMORY)
+        {
+            surface = core.GetNativeSurface(task.m_yuv);
+            MFX_CHECK(surface, MFX_ERR_UNDEFINED_BEHAVIOR);
+            external = !!(extOpaq.In.Type & MFX_MEMTYPE_SYSTEM_MEMORY);
+        }
+        MFX_CHECK_NULL_PTR1(surface);
+
+        {
+            mfxFrameData data = surface->Data;
+            FrameLocker lock(&core, data, external);
+            MFX_CHECK(data.Y, MFX_ERR_LOCK_MEMORY);
+
+            Downscale(mfxU32(slot), data.Y, data.Pitch);
+
+            mfxStatus sts = lock.Unlock();
+            MFX_CHECK_STS(sts);
+        }
+
+        mfxI32 slotL0 = task.m_fwdRef ? GetSlot(task.m_fwdRef->m_vmeData) : -1;
+        mfxI32 slotL1 = task.m_bwdRef ? GetSlot(task.m_bwdRef->m_vmeData) : -1;
+        mfxU32 biWeight = extPps.weightedBipredIdc == 2 ? CalcBiWeight(task, 0, 0) : 32;
+
+        m_running = task.m_vmeData;
+        m_pool.Submit(m_heightLa / 16,
+            GetEstimateJob(mfxU32(slot), task.m_type[task.m_fid[0]], slotL0, slotL1, biWeight, *m_running));
+    }
+
+    // without workers the job is done in Submit()
+    if (!m_pool.IsDone())
+        return MFX_TASK_BUSY;
+
+    SumCosts(*m_running);
+    m_running = 0;
+
+    return MFX_ERR_NONE;
+}
+
+void CpuLookahead::Downscale(
+    mfxU32         slot,
+    mfxU8 const *  luma,
+    mfxU32         pitch)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "CpuLookahead::Downscale");
+    assert(slot < m_planes.size());
+
+    Plane & plane = m_planes[slot];
+    mfxU32 const f     = m_scale;
+    mfxU32 const shift = f == 4 ? 4 : f == 2 ? 2 : 0;
+
+    // pixels past the source picture (alignment of widthLa/heightLa) repeat the last column/row
+    m_pool.ParallelFor(m_heightLa, [&](mfxU32 y)
+    {
+        mfxU8 * dst = plane.y + y * m_pitch;
+
+        if (f == 1)
+        {
+            memcpy(dst, luma + std::min(y, m_height - 1) * pitch, std::min(m_width, m_widthLa));
+            for (mfxU32 x = m_width; x < m_widthLa; x++)
+                dst[x] = dst[m_width - 1];
+        }
+        else
+        {
+            for (mfxU32 x = 0; x < m_widthLa; x++)
+            {
+                mfxU32 sum = 0;
+                for (mfxU32 ky = 0; ky < f; ky++)
+                {
+                    mfxU8 const * row = luma + std::min(y * f + ky, m_height - 1) * pitch;
+                    for (mfxU32 kx = 0; kx < f; kx++)
+                        sum += row[std::min(x * f + kx, m_width - 1)];
+                }
+                dst[x] = mfxU8((sum + (f * f >> 1)) >> shift);
+            }
+        }
+    });
+
+    PadPlane(plane.y, m_pitch, m_widthLa, m_heightLa, PAD);
+
+    m_pool.ParallelFor(m_heightLa / 2, [&](mfxU32 y)
+    {
+        mfxU8 const * src = plane.y + 2 * y * m_pitch;
+        mfxU8 *       dst = plane.y2 + y * m_pitch2;
+
+        for (mfxU32 x = 0; x < m_widthLa / 2; x++)
+            dst[x] = mfxU8((src[2 * x] + src[2 * x + 1] + src[2 * x + m_pitch] + src[2 * x + 1 + m_pitch] + 2) >> 2);
+    });
+
+    PadPlane(plane.y2, m_pitch2, m_widthLa / 2, m_heightLa / 2, PAD2);
+}
+
+void CpuLookahead::Estimate(
+    mfxU32         slot,
+    mfxU32         frameType,
+    mfxI32         slotL0,
+    mfxI32         slotL1,
+    mfxU32         biWeight,
+    VmeData &      vme)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "CpuLookahead::Estimate");
+
+    m_pool.ParallelFor(m_heightLa / 16, GetEstimateJob(slot, frameType, slotL0, slotL1, biWeight, vme));
+
+    SumCosts(vme);
+}
+
+// Estimation of one MB row, the planes are kept by the slots until the job is done
+std::function<void(mfxU32)> CpuLookahead::GetEstimateJob(
+    mfxU32         slot,
+    mfxU32         frameType,
+    mfxI32         slotL0,
+    mfxI32         slotL1,
+    mfxU32         biWeight,
+    VmeData &      vme)
+{
+    assert(slot < m_planes.size());
+    assert(vme.mb.size() == (m_widthLa / 16) * (m_heightLa / 16));
+
+    Plane const * cur = &m_planes[slot];
+    Plane const * l0  = (slotL0 >= 0 && !(frameType & MFX_FRAMETYPE_I)) ? &m_planes[slotL0] : 0;
+    Plane const * l1  = (slotL1 >= 0 && (frameType & MFX_FRAMETYPE_B))  ? &m_planes[slotL1] : 0;
+    VmeData *     out = &vme;
+
+    return [this, cur, l0, l1, frameType, biWeight, out](mfxU32 row)
+    {
+        EstimateRow(row, *cur, l0, l1, frameType, biWeight, *out);
+    };
+}
+
+void CpuLookahead::Propagate(
+    VmeData const & cur,
+    VmeData *       l0,
+    VmeData *       l1)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "CpuLookahead::Propagate");
+
+    mfxI32 const w = mfxI32(m_widthLa / 16);
+    mfxI32 const h = mfxI32(m_heightLa / 16);
+    mfxU32 const numBands = mfxU32((h + PROPAGATION_BAND - 1) / PROPAGATION_BAND);
+
+    // even bands, then odd bands: integer sums give the same result as the serial order
+    for (mfxU32 parity = 0; parity < 2; parity++)
+    {
+        m_pool.ParallelFor((numBands + 1 - parity) / 2, [&](mfxU32 i)
+        {
+            mfxI32 band = mfxI32(2 * i + parity);
+            PropagateRows(cur, l0, l1, w, h, band * PROPAGATION_BAND, std::min(h, (band + 1) * PROPAGATION_BAND));
+        });
+    }
+}
+
+void CpuLookahead::EstimateRow(
+    mfxU32         row,
+    Plane const &  cur,
+    Plane const *  l0,
+    Plane const *  l1,
+    mfxU32         frameType,
+    mfxU32         biWeight,
+    VmeData &      vme)
+{
+    mfxU32 const w  = m_widthLa / 16;
+    mfxI32 const y  = mfxI32(row * 16);
+    mfxI32 const y2 = y / 2;
+    mfxU32 const w1 = biWeight;
+    mfxU32 const w0 = 64 - biWeight;
+
+    // cost centers: vectors found for the left MB
+    mfxI16Pair pred0 = {};
+    mfxI16Pair pred1 = {};
+
+    for (mfxU32 col = 0; col < w; col++)
+    {
+        mfxI32 const x = mfxI32(col * 16);
+        mfxU8 const * src  = cur.y + y * m_pitch + x;
+        mfxU8 const * src2 = cur.y2 + y2 * m_pitch2 + x / 2;
+
+        MbData & mb = vme.mb[row * w + col];
+        Zero(mb);
+
+        mfxU16 sum[4];
+        mfxU8  cnt[4];
+
+        mfxU32 satdIntra = EstimateIntra(src, m_pitch, y > 0, x > 0, mb.lumaCoeffSum, mb.lumaCoeffCnt);
+        mfxU32 bestCost  = satdIntra + LAMBDA * INTRA_16x16_BITS;
+        mfxU32 bestDist  = satdIntra;
+
+        mb.intraCost   = bestCost;
+        mb.intraMbFlag = 1;
+        mb.mbType      = MBTYPE_I_16x16_000;
+        mb.w1          = mfxU8(w1);
+        mb.w0          = mfxU8(w0);
+
+        SearchResult r0 = {};
+        SearchResult r1 = {};
+        mfxU8 const * ref0 = 0;
+        mfxU8 const * ref1 = 0;
+
+        if (l0)
+        {
+            r0   = Search(src, l0->y + y * m_pitch + x, m_pitch, src2, l0->y2 + y2 * m_pitch2 + x / 2, m_pitch2, pred0);
+            ref0 = l0->y + (y + r0.dy) * m_pitch + x + r0.dx;
+
+            mfxU32 satd = Satd16x16(src, m_pitch, ref0, m_pitch, sum, cnt);
+            mfxU32 cost = satd + LAMBDA * INTER_16x16_BITS + MvCost(r0.dx, r0.dy, pred0);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestDist = satd;
+                mb.intraMbFlag = 0;
+                mb.mbType      = MBTYPE_BP_L0_16x16;
+                Copy(mb.lumaCoeffSum, sum);
+                Copy(mb.lumaCoeffCnt, cnt);
+            }
+        }
+
+        if (l1)
+        {
+            r1   = Search(src, l1->y + y * m_pitch + x, m_pitch, src2, l1->y2 + y2 * m_pitch2 + x / 2, m_pitch2, pred1);
+            ref1 = l1->y + (y + r1.dy) * m_pitch + x + r1.dx;
+
+            mfxU32 satd = Satd16x16(src, m_pitch, ref1, m_pitch, sum, cnt);
+            mfxU32 cost = satd + LAMBDA * INTER_16x16_BITS + MvCost(r1.dx, r1.dy, pred1);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestDist = satd;
+                mb.intraMbFlag = 0;
+                mb.mbType      = MBTYPE_B_L1_16x16;
+                Copy(mb.lumaCoeffSum, sum);
+                Copy(mb.lumaCoeffCnt, cnt);
+            }
+        }
+
+        if (ref0 && ref1)
+        {
+            mfxU8 bi[16 * 16];
+            for (mfxI32 j = 0; j < 16; j++)
+                for (mfxI32 i = 0; i < 16; i++)
+                    bi[j * 16 + i] = mfxU8((ref0[j * m_pitch + i] * w0 + ref1[j * m_pitch + i] * w1 + 32) >> 6);
+
+            mfxU32 satd = Satd16x16(src, m_pitch, bi, 16, sum, cnt);
+            mfxU32 cost = satd + LAMBDA * BI_16x16_BITS + MvCost(r0.dx, r0.dy, pred0) + MvCost(r1.dx, r1.dy, pred1);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestDist = satd;
+                mb.intraMbFlag = 0;
+                mb.mbType      = MBTYPE_B_Bi_16x16;
+                Copy(mb.lumaCoeffSum, sum);
+                Copy(mb.lumaCoeffCnt, cnt);
+            }
+        }
+
+        mb.interCost = bestCost;
+        mb.dist      = mfxU16(std::min<mfxU32>(bestDist, 0xffff));
+
+        if (!mb.intraMbFlag)
+        {
+            bool l0used = mb.mbType != MBTYPE_B_L1_16x16;
+            bool l1used = mb.mbType != MBTYPE_BP_L0_16x16;
+
+            mb.costCenter0 = pred0;
+            mb.costCenter1 = pred1;
+            if (l0used)
+            {
+                mb.mv[0].x = mfxI16(4 * r0.dx);
+                mb.mv[0].y = mfxI16(4 * r0.dy);
+            }
+            if (l1used)
+            {
+                mb.mv[1].x = mfxI16(4 * r1.dx);
+                mb.mv[1].y = mfxI16(4 * r1.dy);
+            }
+
+            mb.skipMbFlag = (!l0used || (mb.mv[0].x == pred0.x && mb.mv[0].y == pred0.y))
+                && (!l1used || (mb.mv[1].x == pred1.x && mb.mv[1].y == pred1.y))
+                && !(mb.lumaCoeffCnt[0] | mb.lumaCoeffCnt[1] | mb.lumaCoeffCnt[2] | mb.lumaCoeffCnt[3]);
+        }
+
+        if (l0)
+        {
+            pred0.x = mfxI16(4 * r0.dx);
+            pred0.y = mfxI16(4 * r0.dy);
+        }
+        if (l1)
+        {
+            pred1.x = mfxI16(4 * r1.dx);
+            pred1.y = mfxI16(4 * r1.dy);
+        }
+    }
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
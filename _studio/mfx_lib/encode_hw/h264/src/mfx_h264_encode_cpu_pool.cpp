@@ -0,0 +1,209 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+#ifdef MFX_ENABLE_H264_VIDEO_ENCODE_HW
+
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "mfx_h264_encode_cpu_pool.h"
+
+using namespace MfxHwH264Encode;
+
+CpuThreadPool::CpuThreadPool()
+    : m_job(0)
+    , m_jobSize(0)
+    , m_jobNext(0)
+    , m_jobPending(0)
+    , m_generation(0)
+    , m_async(false)
+    , m_stop(false)
+    , m_event(-1)
+{
+}
+
+CpuThreadPool::~CpuThreadPool()
+{
+    Stop();
+
+    if (m_event >= 0)
+        close(m_event);
+}
+
+void CpuThreadPool::Start(mfxU32 numThreads)
+{
+    Stop();
+
+    if (!numThreads)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (m_event < 0)
+        m_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    m_stop = false;
+    for (mfxU32 i = 1; i < numThreads; i++)
+        m_workers.emplace_back(&CpuThreadPool::WorkerLoop, this);
+}
+
+void CpuThreadPool::Stop()
+{
+    // workers leaving on m_stop wouldn't take the rest of a submitted job
+    if (!m_workers.empty())
+        Wait();
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread & worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+}
+
+void CpuThreadPool::ParallelFor(mfxU32 count, std::function<void(mfxU32)> const & job)
+{
+    if (m_workers.empty())
+    {
+        for (mfxU32 i = 0; i < count; i++)
+            job(i);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_jobPending == 0; });
+
+        m_job        = &job;
+        m_jobSize    = count;
+        m_jobNext    = 0;
+        m_jobPending = count;
+        m_async      = false;
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    RunJob();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_jobPending == 0; });
+    m_job = 0;
+}
+
+void CpuThreadPool::Submit(mfxU32 count, std::function<void(mfxU32)> job)
+{
+    Wait();
+
+    // the handle stays readable until the next job, a reset of a clear one fails with EAGAIN
+    if (m_event >= 0)
+    {
+        eventfd_t value;
+        eventfd_read(m_event, &value);
+    }
+
+    if (m_workers.empty() || !count)
+    {
+        for (mfxU32 i = 0; i < count; i++)
+            job(i);
+
+        SignalCompletion();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_submitted  = std::move(job);
+        m_job        = &m_submitted;
+        m_jobSize    = count;
+        m_jobNext    = 0;
+        m_jobPending = count;
+        m_async      = true;
+        m_generation++;
+    }
+    m_wake.notify_all();
+}
+
+bool CpuThreadPool::IsDone()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_jobPending == 0;
+}
+
+void CpuThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_jobPending == 0; });
+}
+
+void CpuThreadPool::SignalCompletion()
+{
+    if (m_event >= 0)
+        eventfd_write(m_event, 1);
+}
+
+void CpuThreadPool::RunJob()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // items are taken under the lock, so a late worker can't pick up an item of a finished job
+    while (m_job && m_jobNext < m_jobSize)
+    {
+        std::function<void(mfxU32)> const & job = *m_job;
+        mfxU32 item = m_jobNext++;
+
+        lock.unlock();
+        job(item);
+        lock.lock();
+
+        if (--m_jobPending == 0)
+        {
+            m_done.notify_all();
+
+            if (m_async)
+                SignalCompletion();
+        }
+    }
+}
+
+void CpuThreadPool::WorkerLoop()
+{
+    mfxU32 generation = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+
+            if (m_stop)
+                return;
+
+            generation = m_generation;
+        }
+
+        RunJob();
+    }
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW
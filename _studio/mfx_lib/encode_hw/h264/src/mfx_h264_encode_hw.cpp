@@ -38,9 +38,13 @@
 
 #include "mfx_h264_encode_cm.h"
 #include "mfx_h264_encode_cm_defs.h"
+#include "mfx_h264_encode_cpu_la.h"
+#include "mfx_h264_encode_cpu_analysis.h"
 
 #include "vm_time.h"
 
+#include <poll.h>
+
 
 using namespace MfxHwH264Encode;
 
@@ -170,6 +174,21 @@ namespace MfxHwH264EncodeHW
         }
         return oldest;
     }
+
+    // sleeps until the device signals the handle of the busy task, the device
+    // is queried again on timeout. the device without the handle is spun on.
+    void WaitForCompletion(int handle)
+    {
+        if (handle < 0)
+        {
+            vm_time_sleep(0);
+            return;
+        }
+
+        const int WAIT_COMPLETION_TIMEOUT_MS = 100;
+        pollfd pfd = { handle, POLLIN, 0 };
+        poll(&pfd, 1, WAIT_COMPLETION_TIMEOUT_MS);
+    }
 }
 using namespace MfxHwH264EncodeHW;
 
@@ -651,6 +670,9 @@ ImplementationAvc::ImplementationAvc(VideoCORE * core)
 , m_sliceDivider()
 , m_stagesToGo(0)
 , m_bDeferredFrame(0)
+, m_bWaitingEncode(false)
+, m_bWaitingLa(false)
+, m_completionHandle(-1)
 , m_fieldCounter(0)
 , m_1stFieldStatus(MFX_ERR_NONE)
 , m_frameOrder(0)
@@ -674,6 +696,7 @@ ImplementationAvc::ImplementationAvc(VideoCORE * core)
 , m_useWAForHighBitrates(false)
 , m_isENCPAK(false)
 , m_resetBRC(false)
+, m_useCpuHist(false)
 , m_LowDelayPyramidLayer(0)
 , m_LtrQp(0)
 , m_LtrOrder(-1)
@@ -705,7 +728,8 @@ void ImplementationAvc::DestroyDanglingCmResources()
         mfxExtCodingOption2 * extOpt2 = GetExtBuffer(m_video);
         for (DdiTaskIter i = m_lookaheadStarted.begin(), e = m_lookaheadStarted.end(); i != e; ++i)
         {
-            m_cmCtx->DestroyEvent(i->m_event);
+            if (m_cmCtx)
+                m_cmCtx->DestroyEvent(i->m_event);
             if (extOpt2 && (extOpt2->MaxSliceSize == 0))
             {
                 int ffid = i->m_fid[0];
@@ -1041,15 +1065,32 @@ mfxStatus ImplementationAvc::Init(mfxVideoParam * par)
     sts = m_bit.Alloc(m_core, request,false);
     MFX_CHECK_STS(sts);
 
-    if (   IsOn(extOpt3.FadeDetection)
-        || bIntRateControlLA(m_video.mfx.RateControlMethod))
+    mfxExtCodingOptionDDI const & extDdi = GetExtBufferRef(m_video);
+
+    // lookahead runs on CPU when forced by SwLookahead or when CM is unavailable and SwLookahead isn't off,
+    // histograms of fade detection - the same with SwFrameAnalysis
+    bool useCpuLa = bIntRateControlLA(m_video.mfx.RateControlMethod) && IsOn(extDdi.SwLookahead);
+    m_useCpuHist  = IsOn(extOpt3.FadeDetection) && IsOn(extDdi.SwFrameAnalysis);
+
+    if (   (IsOn(extOpt3.FadeDetection) && !m_useCpuHist)
+        || (bIntRateControlLA(m_video.mfx.RateControlMethod) && !useCpuLa))
     {
         m_cmDevice.Reset(TryCreateCmDevicePtr(m_core));
         if (m_cmDevice == NULL)
-            return MFX_ERR_UNSUPPORTED;
-        m_cmCtx.reset(new CmContext(m_video, m_cmDevice, m_core));
+        {
+            if (   (IsOn(extOpt3.FadeDetection) && IsOff(extDdi.SwFrameAnalysis))
+                || (bIntRateControlLA(m_video.mfx.RateControlMethod) && IsOff(extDdi.SwLookahead)))
+                return MFX_ERR_UNSUPPORTED;
+            useCpuLa     = bIntRateControlLA(m_video.mfx.RateControlMethod);
+            m_useCpuHist = IsOn(extOpt3.FadeDetection);
+        }
+        else
+            m_cmCtx.reset(new CmContext(m_video, m_cmDevice, m_core));
     }
 
+    if (IsOn(extOpt3.FadeDetection) && !IsOff(extDdi.SwFrameAnalysis) && !(m_cmCtx.get() && m_cmCtx->isHistogramSupported()))
+        m_useCpuHist = true;
+
     if (bIntRateControlLA(m_video.mfx.RateControlMethod))
     {
         request.Info.Width  = m_video.calcParam.widthLa;
@@ -1063,7 +1104,15 @@ mfxStatus ImplementationAvc::Init(mfxVideoParam * par)
         for (size_t i = 0; i < m_vmeDataStorage.size(); i++)
             m_vmeDataStorage[i].mb.resize(numMb);
         m_tmpVmeData.reserve(extOpt2.LookAheadDepth);
+    }
 
+    if (useCpuLa)
+    {
+        m_cpuLa.reset(new CpuLookahead);
+        m_cpuLa->Setup(m_video, m_vmeDataStorage);
+    }
+    else if (bIntRateControlLA(m_video.mfx.RateControlMethod))
+    {
         if (extOpt2.LookAheadDS > MFX_LOOKAHEAD_DS_OFF)
         {
             request.Info.FourCC = MFX_FOURCC_NV12;
@@ -1093,18 +1142,27 @@ mfxStatus ImplementationAvc::Init(mfxVideoParam * par)
         MFX_CHECK_STS(sts);
     }
 
-    if (IsOn(extOpt3.FadeDetection) && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
+    if (IsOn(extOpt3.FadeDetection) && (m_useCpuHist || (m_cmCtx.get() && m_cmCtx->isHistogramSupported())))
     {
         request.Info.Width  = 256 * 2 * sizeof(uint);
         request.Info.Height = 1;
         request.Info.FourCC = MFX_FOURCC_P8;
-        request.Type        = MFX_MEMTYPE_D3D_INT;
+        request.Type        = m_useCpuHist ? MFX_MEMTYPE_SYS_INT : MFX_MEMTYPE_D3D_INT;
         request.NumFrameMin = mfxU16(m_video.mfx.NumRefFrame + m_video.AsyncDepth);
 
-        sts = m_histogram.AllocCmBuffersUp(m_cmDevice, request);
+        sts = m_useCpuHist
+            ? m_histogram.AllocSysBuffers(request)
+            : m_histogram.AllocCmBuffersUp(m_cmDevice, request);
         MFX_CHECK_STS(sts);
     }
 
+    // also computes RaCa of ext BRC when ASC works on system memory
+    if (m_useCpuHist || (IsExtBrcSceneChangeSupported(m_video) && !IsCmNeededForSCD(m_video)))
+    {
+        m_cpuAnalysis.reset(new CpuFrameAnalysis);
+        m_cpuAnalysis->Setup(m_video.mfx.NumThread);
+    }
+
     if (IsExtBrcSceneChangeSupported(m_video))
     {
         request.Info.FourCC = MFX_FOURCC_P8;
@@ -1156,6 +1214,9 @@ mfxStatus ImplementationAvc::Init(mfxVideoParam * par)
     m_stagesToGo     = AsyncRoutineEmulator::STG_BIT_CALL_EMULATOR;
     m_bDeferredFrame = 0;
     m_failedStatus   = MFX_ERR_NONE;
+    m_bWaitingEncode   = false;
+    m_bWaitingLa       = false;
+    m_completionHandle = -1;
     m_baseLayerOrder = 0;
     m_frameOrderIdrInDisplayOrder = 0;
     m_frameOrderIntraInDisplayOrder = 0;
@@ -1355,7 +1416,7 @@ mfxStatus ImplementationAvc::ProcessAndCheckNewParameters(
 #endif
 
 
-    if (IsOn(extOpt3New.FadeDetection) && !(m_cmCtx.get() && m_cmCtx->isHistogramSupported()))
+    if (IsOn(extOpt3New.FadeDetection) && !m_useCpuHist && !(m_cmCtx.get() && m_cmCtx->isHistogramSupported()))
         return MFX_ERR_INCOMPATIBLE_VIDEO_PARAM;
 
     if (bIntRateControlLA(m_video.mfx.RateControlMethod) )
@@ -1442,6 +1503,9 @@ mfxStatus ImplementationAvc::Reset(mfxVideoParam *par)
     m_fieldCounter   = 0;
     m_stagesToGo     = AsyncRoutineEmulator::STG_BIT_CALL_EMULATOR;
     m_bDeferredFrame = 0;
+    m_bWaitingEncode   = false;
+    m_bWaitingLa       = false;
+    m_completionHandle = -1;
 
     mfxExtEncoderResetOption const & extResetOpt = GetExtBufferRef(newPar);
 
@@ -1542,6 +1606,9 @@ mfxStatus ImplementationAvc::Reset(mfxVideoParam *par)
     }
     m_video = newPar;
 
+    if (m_cpuLa && (m_cpuLa->GetWidthLa() != m_video.calcParam.widthLa || m_cpuLa->GetHeightLa() != m_video.calcParam.heightLa))
+        m_cpuLa->Setup(m_video, m_vmeDataStorage);
+
     if (m_enabledSwBrc)
     {
         if (isIdrRequired)
@@ -2143,7 +2210,9 @@ mfxStatus ImplementationAvc::CalculateFrameCmplx(DdiTask const &task, mfxU32 &ra
         pitch = Data.Pitch;
         ptr = Data.Y + Info.CropX + Info.CropY * pitch;
 
-        if (ptr)
+        if (ptr && m_cpuAnalysis)
+            raca = m_cpuAnalysis->RaCa(ptr, pitch, w, h);
+        else if (ptr)
             MFX_SAFE_CALL(amtScd.calc_RaCa_pic(ptr, w, h, Data.Pitch, raca));
     }
 
@@ -2441,7 +2510,13 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
         sts = CopyRawSurfaceToVideoMemory(*m_core, m_video, *task);
         if (sts != MFX_ERR_NONE)
             return Error(sts);
-        if (bIntRateControlLA(m_video.mfx.RateControlMethod))
+        if (bIntRateControlLA(m_video.mfx.RateControlMethod) && m_cpuLa)
+        {
+            task->m_vmeData = FindUnusedVmeData(m_vmeDataStorage);
+            if (!task->m_vmeData)
+                return Error(MFX_ERR_UNDEFINED_BEHAVIOR);
+        }
+        else if (bIntRateControlLA(m_video.mfx.RateControlMethod))
         {
             mfxHDLPair cmMb = AcquireResourceUp(m_mb);
             task->m_cmMb    = (CmBufferUP *)cmMb.first;
@@ -2454,8 +2529,9 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
             task->m_cmRaw = CreateSurface(m_cmDevice, task->m_handleRaw, m_currentVaType);
         }
 
-        if (IsOn(extOpt3.FadeDetection) && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
+        if (IsOn(extOpt3.FadeDetection) && (m_useCpuHist || (m_cmCtx.get() && m_cmCtx->isHistogramSupported())))
         {
+            // CPU histograms are in system memory, m_cmHist is the buffer then
             mfxHDLPair cmHist = AcquireResourceUp(m_histogram);
             task->m_cmHist = (CmBufferUP *)cmHist.first;
             task->m_cmHistSys = (mfxU32 *)cmHist.second;
@@ -2465,7 +2541,8 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
 
             memset(task->m_cmHistSys, 0, sizeof(uint)* 512);
 
-            task->m_cmRawForHist = CreateSurface(m_cmDevice, task->m_handleRaw, m_currentVaType);
+            if (!m_useCpuHist)
+                task->m_cmRawForHist = CreateSurface(m_cmDevice, task->m_handleRaw, m_currentVaType);
         }
 
         task->m_isENCPAK = m_isENCPAK;
@@ -2515,10 +2592,11 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
                 fwd = &m_lastTask;
             }
 
-            task->m_cmRefs = CreateVmeSurfaceG75(m_cmDevice, task->m_cmRaw,
-                fwd ? &fwd->m_cmRaw : 0, bwd ? &bwd->m_cmRaw : 0, !!fwd, !!bwd);
+            if (!m_cpuLa)
+                task->m_cmRefs = CreateVmeSurfaceG75(m_cmDevice, task->m_cmRaw,
+                    fwd ? &fwd->m_cmRaw : 0, bwd ? &bwd->m_cmRaw : 0, !!fwd, !!bwd);
 
-            if (extOpt2.LookAheadDS > MFX_LOOKAHEAD_DS_OFF)
+            if (!m_cpuLa && extOpt2.LookAheadDS > MFX_LOOKAHEAD_DS_OFF)
                 task->m_cmRefsLa = CreateVmeSurfaceG75(m_cmDevice, task->m_cmRawLa,
                     fwd ? &fwd->m_cmRawLa : 0, bwd ? &bwd->m_cmRawLa : 0, !!fwd, !!bwd);
 
@@ -2563,6 +2641,8 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
         if (bIntRateControlLA(m_video.mfx.RateControlMethod))
             sts = QueryLookahead(m_lookaheadStarted.front());
 
+        // the lookahead workers estimate the frame, the task continues at WAIT_LA
+        m_bWaitingLa = (sts == MFX_TASK_BUSY);
         if(sts != MFX_ERR_NONE)
             return sts;
 
@@ -2573,7 +2653,8 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
     if (m_stagesToGo & AsyncRoutineEmulator::STG_BIT_START_HIST)
     {
         MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "Avc::STG_BIT_START_HIST");
-        if (IsOn(extOpt3.FadeDetection) && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
+        // CPU histogram is done in STG_BIT_WAIT_HIST
+        if (IsOn(extOpt3.FadeDetection) && !m_useCpuHist && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
         {
             DdiTask & task = m_histRun.front();
 
@@ -2590,7 +2671,9 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
         MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "Avc::STG_BIT_WAIT_HIST");
         DdiTask & task = m_histWait.front();
         mfxStatus sts = MFX_ERR_NONE;
-        if (IsOn(extOpt3.FadeDetection) && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
+        if (IsOn(extOpt3.FadeDetection) && m_useCpuHist)
+            sts = RunCpuHistogram(task);
+        else if (IsOn(extOpt3.FadeDetection) && m_cmCtx.get() && m_cmCtx->isHistogramSupported())
             sts = m_cmCtx->QueryHistogram(task.m_event);
 
         if(sts != MFX_ERR_NONE)
@@ -2605,7 +2688,7 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
             DdiTaskIter beg = end;
             std::advance(beg, -extDdi.LookAheadDependency);
 
-            AnalyzeVmeData(beg, end, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
+            AnalyzeVmeData(beg, end, m_video.calcParam.widthLa, m_video.calcParam.heightLa, m_cpuLa.get());
         }
     }
 
@@ -2858,288 +2941,327 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
 
     if (m_stagesToGo & AsyncRoutineEmulator::STG_BIT_WAIT_ENCODE)
     {
-        MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "Avc::WAIT_ENCODE");
+        mfxStatus sts = WaitEncode(bs);
+        // the device is not done yet, the task continues at WaitEncode
+        m_bWaitingEncode = (sts == MFX_TASK_BUSY);
+        if (sts != MFX_ERR_NONE)
+            return sts;
+    }
+
+    /* FEI Field processing mode: second (last) field processing */
+    if ( ((AsyncRoutineEmulator::STG_BIT_RESTART*2) == m_stagesToGo ) &&
+         IsOn(extFeiParams->SingleFieldProcessing) && (1 == m_fieldCounter) )
+    {
         DdiTaskIter task = FindFrameToWaitEncode(m_encoding.begin(), m_encoding.end());
-        mfxU8*      pBuff[2] ={0,0};
-        Hrd hrd = m_hrd;
+        mfxU32 f = 1; // coding second field
+        PrepareSeiMessageBuffer(m_video, *task, task->m_fid[f], m_sei);
 
-        mfxStatus sts = MFX_ERR_NONE;
-        if (m_enabledSwBrc)
+        mfxStatus sts = m_ddi->Execute(task->m_handleRaw, *task, task->m_fid[f], m_sei);
+        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+
+        task->m_bsDataLength[0] = task->m_bsDataLength[1] = 0;
+
+        sts = QueryStatus(*task, task->m_fid[f]);
+        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+
+        if ((NULL == task->m_bs) && (bs != NULL))
+            task->m_bs = bs;
+
+        sts = UpdateBitstream(*task, task->m_fid[f]);
+        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+
+        m_fieldCounter = 0;
+        m_stagesToGo = stagesToGo;
+        OnEncodingQueried(task);
+    } // if (( (AsyncRoutineEmulator::STG_BIT_RESTART*2) == m_stagesToGo ) &&
+
+
+    if (m_stagesToGo & AsyncRoutineEmulator::STG_BIT_RESTART)
+    {
+        m_stagesToGo = AsyncRoutineEmulator::STG_BIT_CALL_EMULATOR;
+        return MFX_TASK_BUSY;
+    }
+
+    return MFX_TASK_DONE;
+}
+
+
+mfxStatus ImplementationAvc::WaitEncode(mfxBitstream * bs)
+{
+    mfxExtCodingOption     const & extOpt  = GetExtBufferRef(m_video);
+    mfxExtCodingOption2    const & extOpt2 = GetExtBufferRef(m_video);
+
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "Avc::WAIT_ENCODE");
+    DdiTaskIter task = FindFrameToWaitEncode(m_encoding.begin(), m_encoding.end());
+    mfxU8*      pBuff[2] ={0,0};
+    Hrd hrd = m_hrd;
+
+    mfxStatus sts = MFX_ERR_NONE;
+    if (m_enabledSwBrc)
+    {
+        for (;; ++task->m_repack)
         {
-            for (;; ++task->m_repack)
+            mfxU32 bsDataLength = 0;
+            for (mfxU32 f = 0; f <= task->m_fieldPicFlag; f++)
             {
-                mfxU32 bsDataLength = 0;
-                for (mfxU32 f = 0; f <= task->m_fieldPicFlag; f++)
-                {
-                    if ((sts = QueryStatus(*task, task->m_fid[f])) != MFX_ERR_NONE)
-                        return sts;
-                    bsDataLength += task->m_bsDataLength[task->m_fid[f]];
-                }
-                //printf("Real frameSize %d, repack %d\n", bsDataLength, task->m_repack);
-                bool bRecoding = false;
-                if (extOpt2.MaxSliceSize)
-                {
-                    mfxU32   bsSizeAvail = mfxU32(m_tmpBsBuf.size());
-                    mfxU8    *pBS = &m_tmpBsBuf[0];
+                if ((sts = QueryStatus(*task, task->m_fid[f])) != MFX_ERR_NONE)
+                    return sts;
+                bsDataLength += task->m_bsDataLength[task->m_fid[f]];
+            }
+            //printf("Real frameSize %d, repack %d\n", bsDataLength, task->m_repack);
+            bool bRecoding = false;
+            if (extOpt2.MaxSliceSize)
+            {
+                mfxU32   bsSizeAvail = mfxU32(m_tmpBsBuf.size());
+                mfxU8    *pBS = &m_tmpBsBuf[0];
 
 
-                    for (mfxU32 f = 0; f <= 0 /*task->m_fieldPicFlag */; f++)
-                    {
-                        if ((sts = CopyBitstream(*m_core, m_video,*task, task->m_fid[f], pBS, bsSizeAvail)) != MFX_ERR_NONE)
-                            return Error(sts);
+                for (mfxU32 f = 0; f <= 0 /*task->m_fieldPicFlag */; f++)
+                {
+                    if ((sts = CopyBitstream(*m_core, m_video,*task, task->m_fid[f], pBS, bsSizeAvail)) != MFX_ERR_NONE)
+                        return Error(sts);
 
-                        sts = UpdateSliceInfo(pBS, pBS + task->m_bsDataLength[task->m_fid[f]], extOpt2.MaxSliceSize, *task, bRecoding);
-                        if (sts != MFX_ERR_NONE)
-                            return Error(sts);
+                    sts = UpdateSliceInfo(pBS, pBS + task->m_bsDataLength[task->m_fid[f]], extOpt2.MaxSliceSize, *task, bRecoding);
+                    if (sts != MFX_ERR_NONE)
+                        return Error(sts);
 
-                        if (bRecoding)
-                        {
-                           if (task->m_repack == 0)
+                    if (bRecoding)
+                    {
+                       if (task->m_repack == 0)
+                       {
+                           sts = CorrectSliceInfo(*task, 70, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
+                           if (sts != MFX_ERR_NONE && sts != MFX_ERR_UNDEFINED_BEHAVIOR)
+                                return Error(sts);
+                           if (sts == MFX_ERR_UNDEFINED_BEHAVIOR)
+                               task->m_repack = 1;
+                       }
+                       if (task->m_repack > 0)
+                       {
+                           if (task->m_repack > 5 && task->m_SliceInfo.size() > 255)
                            {
-                               sts = CorrectSliceInfo(*task, 70, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
-                               if (sts != MFX_ERR_NONE && sts != MFX_ERR_UNDEFINED_BEHAVIOR)
-                                    return Error(sts);
-                               if (sts == MFX_ERR_UNDEFINED_BEHAVIOR)
-                                   task->m_repack = 1;
+                              sts = CorrectSliceInfo(*task, 70, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
+                              if (sts != MFX_ERR_NONE && sts != MFX_ERR_UNDEFINED_BEHAVIOR)
+                                  return Error(sts);
                            }
-                           if (task->m_repack > 0)
+                           else
                            {
-                               if (task->m_repack > 5 && task->m_SliceInfo.size() > 255)
-                               {
-                                  sts = CorrectSliceInfo(*task, 70, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
-                                  if (sts != MFX_ERR_NONE && sts != MFX_ERR_UNDEFINED_BEHAVIOR)
-                                      return Error(sts);
-                               }
-                               else
-                               {
-                                   size_t old_slice_size = task->m_SliceInfo.size();
-                                   sts = CorrectSliceInfoForsed(*task, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
-                                   if (sts != MFX_ERR_NONE)
-                                        return Error(sts);
-                                   if (old_slice_size == task->m_SliceInfo.size() && task->m_repack <4)
-                                       task->m_repack = 4;
-                               }
+                               size_t old_slice_size = task->m_SliceInfo.size();
+                               sts = CorrectSliceInfoForsed(*task, m_video.calcParam.widthLa, m_video.calcParam.heightLa);
+                               if (sts != MFX_ERR_NONE)
+                                    return Error(sts);
+                               if (old_slice_size == task->m_SliceInfo.size() && task->m_repack <4)
+                                   task->m_repack = 4;
                            }
-                           if (task->m_repack >=4)
+                       }
+                       if (task->m_repack >=4)
+                       {
+                           if (task->m_cqpValue[0] < 51)
                            {
-                               if (task->m_cqpValue[0] < 51)
-                               {
-                                    task->m_cqpValue[0] = task->m_cqpValue[0] + 1 + (mfxU8)(task->m_repack - 4);
-                                    if (task->m_cqpValue[0] > 51)
-                                        task->m_cqpValue[0] = 51;
-                                    task->m_cqpValue[1] = task->m_cqpValue[0];
-                               }
-                               else if ( task->m_SliceInfo.size() > 255)
-                                   return MFX_ERR_UNDEFINED_BEHAVIOR;
+                                task->m_cqpValue[0] = task->m_cqpValue[0] + 1 + (mfxU8)(task->m_repack - 4);
+                                if (task->m_cqpValue[0] > 51)
+                                    task->m_cqpValue[0] = 51;
+                                task->m_cqpValue[1] = task->m_cqpValue[0];
                            }
-                        }
-
-                        pBuff[f] = pBS;
-                        pBS += task->m_bsDataLength[task->m_fid[f]];
-                        bsSizeAvail -= task->m_bsDataLength[task->m_fid[f]];
+                           else if ( task->m_SliceInfo.size() > 255)
+                               return MFX_ERR_UNDEFINED_BEHAVIOR;
+                       }
                     }
-                } // extOpt2->MaxSliceSize
-                if (!bRecoding && (bsDataLength > (bs->MaxLength - bs->DataOffset - bs->DataLength)))
-                {
-                        if (task->m_cqpValue[0] ==  51)
-                            return Error(MFX_ERR_UNDEFINED_BEHAVIOR);
-                        task->m_cqpValue[0]= task->m_cqpValue[0] + 1;
-                        task->m_cqpValue[1]= task->m_cqpValue[0];
-                        // printf("Recoding 0: frame %d, qp %d\n", task->m_frameOrder, task->m_cqpValue[0]);
-                        bRecoding = true;
+
+                    pBuff[f] = pBS;
+                    pBS += task->m_bsDataLength[task->m_fid[f]];
+                    bsSizeAvail -= task->m_bsDataLength[task->m_fid[f]];
                 }
-                if (!bRecoding)
+            } // extOpt2->MaxSliceSize
+            if (!bRecoding && (bsDataLength > (bs->MaxLength - bs->DataOffset - bs->DataLength)))
+            {
+                    if (task->m_cqpValue[0] ==  51)
+                        return Error(MFX_ERR_UNDEFINED_BEHAVIOR);
+                    task->m_cqpValue[0]= task->m_cqpValue[0] + 1;
+                    task->m_cqpValue[1]= task->m_cqpValue[0];
+                    // printf("Recoding 0: frame %d, qp %d\n", task->m_frameOrder, task->m_cqpValue[0]);
+                    bRecoding = true;
+            }
+            if (!bRecoding)
+            {
+                task->m_brcFrameParams.CodedFrameSize = bsDataLength;
+                mfxU32 res = m_brc.Report(task->m_brcFrameParams, 0, GetMaxFrameSize(*task, m_video, hrd), task->m_brcFrameCtrl);
+                MFX_CHECK((mfxI32)res != UMC::BRC_ERROR, MFX_ERR_UNDEFINED_BEHAVIOR);
+                if ((res != 0) && (!extOpt2.MaxSliceSize))
                 {
-                    task->m_brcFrameParams.CodedFrameSize = bsDataLength;
-                    mfxU32 res = m_brc.Report(task->m_brcFrameParams, 0, GetMaxFrameSize(*task, m_video, hrd), task->m_brcFrameCtrl);
-                    MFX_CHECK((mfxI32)res != UMC::BRC_ERROR, MFX_ERR_UNDEFINED_BEHAVIOR);
-                    if ((res != 0) && (!extOpt2.MaxSliceSize))
+                    if (task->m_panicMode)
                     {
-                        if (task->m_panicMode)
-                        {
-                            return MFX_ERR_UNDEFINED_BEHAVIOR;
-                        }
-                        task->m_brcFrameParams.NumRecode++;
-                        if ((task->m_cqpValue[0] ==  51 || (res & UMC::BRC_NOT_ENOUGH_BUFFER)) && (res & UMC::BRC_ERR_BIG_FRAME ))
-                        {
-                            task->m_panicMode = 1;
-                            task->m_repack = 100;
-                            sts = CodeAsSkipFrame(*m_core,m_video,*task, m_rawSkip);
-                            if (sts != MFX_ERR_NONE)
-                               return Error(sts);
-                            bRecoding = true;
-                        }
-                        else if (((res & UMC::BRC_NOT_ENOUGH_BUFFER) || (task->m_repack >2))&& (res & UMC::BRC_ERR_SMALL_FRAME ))
-                        {
-                            task->m_minFrameSize = (mfxU32) ((m_brc.GetMinFrameSize() + 7) >> 3 );
+                        return MFX_ERR_UNDEFINED_BEHAVIOR;
+                    }
+                    task->m_brcFrameParams.NumRecode++;
+                    if ((task->m_cqpValue[0] ==  51 || (res & UMC::BRC_NOT_ENOUGH_BUFFER)) && (res & UMC::BRC_ERR_BIG_FRAME ))
+                    {
+                        task->m_panicMode = 1;
+                        task->m_repack = 100;
+                        sts = CodeAsSkipFrame(*m_core,m_video,*task, m_rawSkip);
+                        if (sts != MFX_ERR_NONE)
+                           return Error(sts);
+                        bRecoding = true;
+                    }
+                    else if (((res & UMC::BRC_NOT_ENOUGH_BUFFER) || (task->m_repack >2))&& (res & UMC::BRC_ERR_SMALL_FRAME ))
+                    {
+                        task->m_minFrameSize = (mfxU32) ((m_brc.GetMinFrameSize() + 7) >> 3 );
 
-                            task->m_brcFrameParams.CodedFrameSize = task->m_minFrameSize;
-                            m_brc.Report(task->m_brcFrameParams, 0, hrd.GetMaxFrameSize((task->m_type[task->m_fid[0]] & MFX_FRAMETYPE_IDR)), task->m_brcFrameCtrl);
-                            bRecoding = false; //Padding is in update bitstream
-                        }
-                        else
-                        {
-                            m_brc.GetQpForRecode(task->m_brcFrameParams, task->m_brcFrameCtrl);
-                            UpdateBRCParams(*task);
-                            bRecoding = true;
-                        }
+                        task->m_brcFrameParams.CodedFrameSize = task->m_minFrameSize;
+                        m_brc.Report(task->m_brcFrameParams, 0, hrd.GetMaxFrameSize((task->m_type[task->m_fid[0]] & MFX_FRAMETYPE_IDR)), task->m_brcFrameCtrl);
+                        bRecoding = false; //Padding is in update bitstream
+                    }
+                    else
+                    {
+                        m_brc.GetQpForRecode(task->m_brcFrameParams, task->m_brcFrameCtrl);
+                        UpdateBRCParams(*task);
+                        bRecoding = true;
                     }
                 }
-                if (bRecoding)
-                {
+            }
+            if (bRecoding)
+            {
 
-                    DdiTaskIter curTask = task;
-                    DdiTaskIter nextTask;
+                DdiTaskIter curTask = task;
+                DdiTaskIter nextTask;
 
-                    // wait for next tasks
-                    while ((nextTask = FindFrameToWaitEncodeNext(m_encoding.begin(), m_encoding.end(), curTask)) != curTask)
+                // wait for next tasks
+                while ((nextTask = FindFrameToWaitEncodeNext(m_encoding.begin(), m_encoding.end(), curTask)) != curTask)
+                {
+                    for (mfxU32 f = 0; f <= nextTask->m_fieldPicFlag; f++)
                     {
-                        for (mfxU32 f = 0; f <= nextTask->m_fieldPicFlag; f++)
-                        {
-                            while ((sts = QueryStatus(*nextTask, nextTask->m_fid[f])) == MFX_TASK_BUSY)
-                            {
-                                vm_time_sleep(0);
-                            }
-                            if (sts != MFX_ERR_NONE)
-                                return sts;
-                        }
-                        if (!extOpt2.MaxSliceSize)
+                        // the repack needs all the frames in flight, the thread waits for them here
+                        while ((sts = QueryStatus(*nextTask, nextTask->m_fid[f])) == MFX_TASK_BUSY)
                         {
-                            m_brc.GetQpForRecode(nextTask->m_brcFrameParams, nextTask->m_brcFrameCtrl);
-                            UpdateBRCParams(*nextTask);
-                            bRecoding = true;
+                            WaitForCompletion(m_completionHandle);
+                            m_completionHandle = -1;
                         }
-                        curTask = nextTask;
+                        if (sts != MFX_ERR_NONE)
+                            return sts;
                     }
-                    // restart  encoded task
-                    nextTask = curTask = task;
-                    do
+                    if (!extOpt2.MaxSliceSize)
                     {
-                        if (m_enabledSwBrc && (m_video.mfx.RateControlMethod == MFX_RATECONTROL_CBR || m_video.mfx.RateControlMethod == MFX_RATECONTROL_VBR)) {
-                            if (nextTask->m_longTermFrameIdx != NO_INDEX_U8 && nextTask->m_LtrOrder == m_LtrOrder) {
-                                m_LtrQp = nextTask->m_cqpValue[0];
-                            }
-                            if (nextTask->m_type[0] & MFX_FRAMETYPE_REF) {
-                                m_RefQp = nextTask->m_cqpValue[0];
-                                m_RefOrder = nextTask->m_frameOrder;
-                            }
+                        m_brc.GetQpForRecode(nextTask->m_brcFrameParams, nextTask->m_brcFrameCtrl);
+                        UpdateBRCParams(*nextTask);
+                        bRecoding = true;
+                    }
+                    curTask = nextTask;
+                }
+                // restart  encoded task
+                nextTask = curTask = task;
+                do
+                {
+                    if (m_enabledSwBrc && (m_video.mfx.RateControlMethod == MFX_RATECONTROL_CBR || m_video.mfx.RateControlMethod == MFX_RATECONTROL_VBR)) {
+                        if (nextTask->m_longTermFrameIdx != NO_INDEX_U8 && nextTask->m_LtrOrder == m_LtrOrder) {
+                            m_LtrQp = nextTask->m_cqpValue[0];
                         }
-                        curTask = nextTask;
-                        curTask->m_bsDataLength[0] = curTask->m_bsDataLength[1] = 0;
+                        if (nextTask->m_type[0] & MFX_FRAMETYPE_REF) {
+                            m_RefQp = nextTask->m_cqpValue[0];
+                            m_RefOrder = nextTask->m_frameOrder;
+                        }
+                    }
+                    curTask = nextTask;
+                    curTask->m_bsDataLength[0] = curTask->m_bsDataLength[1] = 0;
 
-                        for (mfxU32 f = 0; f <= curTask->m_fieldPicFlag; f++)
+                    for (mfxU32 f = 0; f <= curTask->m_fieldPicFlag; f++)
+                    {
+                        PrepareSeiMessageBuffer(m_video, *curTask, curTask->m_fid[f], m_sei);
+                        while ((sts =  m_ddi->Execute(curTask->m_handleRaw, *curTask, curTask->m_fid[f], m_sei)) == MFX_TASK_BUSY)
                         {
-                            PrepareSeiMessageBuffer(m_video, *curTask, curTask->m_fid[f], m_sei);
-                            while ((sts =  m_ddi->Execute(curTask->m_handleRaw, *curTask, curTask->m_fid[f], m_sei)) == MFX_TASK_BUSY)
-                            {
-                                vm_time_sleep(0);
-                            }
-                            if ( sts != MFX_ERR_NONE)
-                                return Error(sts);
+                            vm_time_sleep(0);
                         }
-                    } while ((nextTask = FindFrameToWaitEncodeNext(m_encoding.begin(), m_encoding.end(), curTask)) != curTask) ;
-
-                    continue;
-                }
-
-
-                break;
-            }
-            task->m_bs = bs;
-            for (mfxU32 f = 0; f <= task->m_fieldPicFlag; f++)
-            {
-                //printf("Update bitstream: %d, len %d\n",task->m_encOrder, task->m_bsDataLength[task->m_fid[f]]);
+                        if ( sts != MFX_ERR_NONE)
+                            return Error(sts);
+                    }
+                } while ((nextTask = FindFrameToWaitEncodeNext(m_encoding.begin(), m_encoding.end(), curTask)) != curTask) ;
 
-                if ((sts = UpdateBitstream(*task, task->m_fid[f])) != MFX_ERR_NONE)
-                    return Error(sts);
-            }
-            m_NumSlices = (mfxU32)task->m_SliceInfo.size();
-            if (extOpt2.MaxSliceSize && task->m_repack < 4)
-            {
-                mfxF32 w_avg = 0;
-                for (size_t t = 0; t < task->m_SliceInfo.size(); t ++ )
-                    w_avg = w_avg + task->m_SliceInfo[t].weight;
-                w_avg = w_avg/m_NumSlices;
-                if (w_avg < 70.0f)
-                    m_NumSlices =  (mfxU32)w_avg* m_NumSlices / 70;
+                continue;
             }
-            OnEncodingQueried(task);
-        }
-        else if (IsOff(extOpt.FieldOutput))
-        {
-            mfxU32 f = 0;
-            mfxU32 f_start = 0;
-            mfxU32 f_end = task->m_fieldPicFlag;
 
-            /* Query results if NO FEI Field processing mode (this is legacy encoding) */
-            if (!task->m_singleFieldMode)
-            {
-                for (f = f_start; f <= f_end; f++)
-                {
-                    if ((sts = QueryStatus(*task, task->m_fid[f])) != MFX_ERR_NONE)
-                        return sts;
-                }
-                task->m_bs = bs;
-                for (f = f_start; f <= f_end; f++)
-                {
 
-                    if ((sts = UpdateBitstream(*task, task->m_fid[f])) != MFX_ERR_NONE)
-                        return Error(sts);
-                }
-
-                OnEncodingQueried(task);
-            } // if (!task->m_singleFieldMode)
+            break;
         }
-        else
+        task->m_bs = bs;
+        for (mfxU32 f = 0; f <= task->m_fieldPicFlag; f++)
         {
-            std::pair<mfxBitstream *, mfxU32> * pair = reinterpret_cast<std::pair<mfxBitstream *, mfxU32> *>(bs);
-            assert(pair->second < 2);
-            task->m_bs = pair->first;
-            mfxU32 fid = task->m_fid[pair->second & 1];
+            //printf("Update bitstream: %d, len %d\n",task->m_encOrder, task->m_bsDataLength[task->m_fid[f]]);
 
-            if ((sts = QueryStatus(*task, fid)) != MFX_ERR_NONE)
-                return sts;
-            if ((sts = UpdateBitstream(*task, fid)) != MFX_ERR_NONE)
+            if ((sts = UpdateBitstream(*task, task->m_fid[f])) != MFX_ERR_NONE)
                 return Error(sts);
+        }
+        m_NumSlices = (mfxU32)task->m_SliceInfo.size();
+        if (extOpt2.MaxSliceSize && task->m_repack < 4)
+        {
+            mfxF32 w_avg = 0;
+            for (size_t t = 0; t < task->m_SliceInfo.size(); t ++ )
+                w_avg = w_avg + task->m_SliceInfo[t].weight;
+            w_avg = w_avg/m_NumSlices;
+            if (w_avg < 70.0f)
+                m_NumSlices =  (mfxU32)w_avg* m_NumSlices / 70;
+        }
+        OnEncodingQueried(task);
+    }
+    else if (IsOff(extOpt.FieldOutput))
+    {
+        mfxU32 f = 0;
+        mfxU32 f_start = 0;
+        mfxU32 f_end = task->m_fieldPicFlag;
 
-            if (task->m_fieldCounter == 2)
+        /* Query results if NO FEI Field processing mode (this is legacy encoding) */
+        if (!task->m_singleFieldMode)
+        {
+            for (f = f_start; f <= f_end; f++)
             {
-                OnEncodingQueried(task);
-                UMC::AutomaticUMCMutex guard(m_listMutex);
-                m_listOfPairsForFieldOutputMode.pop_front();
-                m_listOfPairsForFieldOutputMode.pop_front();
+                if ((sts = QueryStatus(*task, task->m_fid[f])) != MFX_ERR_NONE)
+                    return sts;
             }
-        }
+            task->m_bs = bs;
+            for (f = f_start; f <= f_end; f++)
+            {
 
-    }
+                if ((sts = UpdateBitstream(*task, task->m_fid[f])) != MFX_ERR_NONE)
+                    return Error(sts);
+            }
 
-    /* FEI Field processing mode: second (last) field processing */
-    if ( ((AsyncRoutineEmulator::STG_BIT_RESTART*2) == m_stagesToGo ) &&
-         IsOn(extFeiParams->SingleFieldProcessing) && (1 == m_fieldCounter) )
+            OnEncodingQueried(task);
+        } // if (!task->m_singleFieldMode)
+    }
+    else
     {
-        DdiTaskIter task = FindFrameToWaitEncode(m_encoding.begin(), m_encoding.end());
-        mfxU32 f = 1; // coding second field
-        PrepareSeiMessageBuffer(m_video, *task, task->m_fid[f], m_sei);
-
-        mfxStatus sts = m_ddi->Execute(task->m_handleRaw, *task, task->m_fid[f], m_sei);
-        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+        std::pair<mfxBitstream *, mfxU32> * pair = reinterpret_cast<std::pair<mfxBitstream *, mfxU32> *>(bs);
+        assert(pair->second < 2);
+        task->m_bs = pair->first;
+        mfxU32 fid = task->m_fid[pair->second & 1];
 
-        task->m_bsDataLength[0] = task->m_bsDataLength[1] = 0;
+        if ((sts = QueryStatus(*task, fid)) != MFX_ERR_NONE)
+            return sts;
+        if ((sts = UpdateBitstream(*task, fid)) != MFX_ERR_NONE)
+            return Error(sts);
 
-        sts = QueryStatus(*task, task->m_fid[f]);
-        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+        if (task->m_fieldCounter == 2)
+        {
+            OnEncodingQueried(task);
+            UMC::AutomaticUMCMutex guard(m_listMutex);
+            m_listOfPairsForFieldOutputMode.pop_front();
+            m_listOfPairsForFieldOutputMode.pop_front();
+        }
+    }
 
-        if ((NULL == task->m_bs) && (bs != NULL))
-            task->m_bs = bs;
+    return MFX_ERR_NONE;
+}
 
-        sts = UpdateBitstream(*task, task->m_fid[f]);
-        MFX_CHECK(sts == MFX_ERR_NONE, Error(sts));
+mfxStatus ImplementationAvc::ResumeWaitEncode(mfxBitstream * bs)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "ImplementationAvc::ResumeWaitEncode");
 
-        m_fieldCounter = 0;
-        m_stagesToGo = stagesToGo;
-        OnEncodingQueried(task);
-    } // if (( (AsyncRoutineEmulator::STG_BIT_RESTART*2) == m_stagesToGo ) &&
+    // the frame is queried already
+    if ((m_stagesToGo & AsyncRoutineEmulator::STG_BIT_WAIT_ENCODE) == 0)
+        return MFX_TASK_DONE;
 
+    // the stages before are done, only the frame being encoded is waited for
+    mfxStatus sts = WaitEncode(bs);
+    m_bWaitingEncode = (sts == MFX_TASK_BUSY);
+    if (sts != MFX_ERR_NONE)
+        return sts;
 
     if (m_stagesToGo & AsyncRoutineEmulator::STG_BIT_RESTART)
     {
@@ -3150,31 +3272,81 @@ mfxStatus ImplementationAvc::AsyncRoutine(mfxBitstream * bs)
     return MFX_TASK_DONE;
 }
 
-
-mfxStatus ImplementationAvc::AsyncRoutineHelper(void * state, void * param, mfxU32, mfxU32)
+mfxStatus ImplementationAvc::CallAsyncRoutine(
+    mfxStatus (ImplementationAvc::*routine)(mfxBitstream *),
+    void * param)
 {
-    ImplementationAvc & impl = *(ImplementationAvc *)state;
-
-    if (impl.m_failedStatus != MFX_ERR_NONE)
-        return impl.m_failedStatus;
+    if (m_failedStatus != MFX_ERR_NONE)
+        return m_failedStatus;
 
     mfxStatus sts = MFX_ERR_NONE;
     try
     {
-        sts = impl.AsyncRoutine((mfxBitstream *)param);
+        sts = (this->*routine)((mfxBitstream *)param);
         //printf("encoder sts = %d\n",sts);
         if (sts != MFX_TASK_BUSY && sts != MFX_TASK_DONE)
-            impl.m_failedStatus = sts;
+            m_failedStatus = sts;
     }
     catch (...)
     {
-        impl.m_failedStatus = MFX_ERR_DEVICE_FAILED;
+        m_failedStatus = MFX_ERR_DEVICE_FAILED;
         sts = MFX_ERR_DEVICE_FAILED;
     }
 
     return sts;
 }
 
+void ImplementationAvc::Suspend(
+    void *         param,
+    mfxTaskRoutine routine)
+{
+    // the device signals the handle when the frame is encoded, the lookahead
+    // workers when the frame is estimated, the task is not called until then
+    int fd = (routine == WaitEncodeRoutineHelper || m_bWaitingLa) ? m_completionHandle : -1;
+
+    m_bWaitingEncode   = false;
+    m_bWaitingLa       = false;
+    m_completionHandle = -1;
+
+    // the scheduler of the session is changed by joining sessions.
+    // without the continuation the task is re-queued as MFX_TASK_BUSY, it is
+    // re-entered at the routine it was added with and queries the device again
+    MFXIScheduler * scheduler = QueryCoreInterface<MFXIScheduler>(m_core, MFXICORE_SCHEDULER_GUID);
+    MFXIScheduler3 * scheduler3 = scheduler ? (MFXIScheduler3 *)scheduler->QueryInterface(MFXIScheduler3_GUID) : 0;
+    if (scheduler3)
+    {
+        scheduler3->SetContinuation(this, param, routine, fd);
+        scheduler3->Release();
+    }
+}
+
+mfxStatus ImplementationAvc::AsyncRoutineHelper(void * state, void * param, mfxU32, mfxU32)
+{
+    ImplementationAvc & impl = *(ImplementationAvc *)state;
+
+    mfxStatus sts = impl.CallAsyncRoutine(&ImplementationAvc::AsyncRoutine, param);
+
+    // other stages are restarted from the emulator
+    if (sts == MFX_TASK_BUSY && impl.m_bWaitingEncode)
+        impl.Suspend(param, WaitEncodeRoutineHelper);
+    else if (sts == MFX_TASK_BUSY && impl.m_bWaitingLa)
+        impl.Suspend(param, AsyncRoutineHelper);
+
+    return sts;
+}
+
+mfxStatus ImplementationAvc::WaitEncodeRoutineHelper(void * state, void * param, mfxU32, mfxU32)
+{
+    ImplementationAvc & impl = *(ImplementationAvc *)state;
+
+    mfxStatus sts = impl.CallAsyncRoutine(&ImplementationAvc::ResumeWaitEncode, param);
+
+    if (sts == MFX_TASK_BUSY)
+        impl.Suspend(param, impl.m_bWaitingEncode ? WaitEncodeRoutineHelper : AsyncRoutineHelper);
+
+    return sts;
+}
+
 
 mfxStatus ImplementationAvc::EncodeFrameCheck(
     mfxEncodeCtrl *           ctrl,
@@ -3366,16 +3538,59 @@ void ImplementationAvc::SubmitLookahead(
     task.m_vmeData->encOrder = task.m_encOrder;
     task.m_vmeData->used     = true;
 
-    task.m_event = m_cmCtx->RunVme(task, 26);
+    // CPU lookahead does all the work in QueryLookahead
+    if (!m_cpuLa)
+        task.m_event = m_cmCtx->RunVme(task, 26);
 }
 
 
 mfxStatus ImplementationAvc::QueryLookahead(
     DdiTask & task)
 {
+    if (m_cpuLa)
+    {
+        mfxStatus sts = m_cpuLa->Run(*m_core, m_video, task);
+        if (sts == MFX_TASK_BUSY)
+            m_completionHandle = m_cpuLa->GetCompletionHandle();
+        return sts;
+    }
+
     return m_cmCtx->QueryVme(task, task.m_event);
 }
 
+// counterpart of CmContext::RunHistogram + QueryHistogram, fills task.m_cmHistSys
+mfxStatus ImplementationAvc::RunCpuHistogram(
+    DdiTask & task)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "ImplementationAvc::RunCpuHistogram");
+    MFX_CHECK(m_cpuAnalysis && task.m_cmHistSys, MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    mfxExtOpaqueSurfaceAlloc const & extOpaq = GetExtBufferRef(m_video);
+
+    mfxFrameSurface1 * surface = task.m_yuv;
+    bool external = true;
+
+    if (m_video.IOPattern == MFX_IOPATTERN_IN_OPAQUE_MEMORY)
+    {
+        surface = m_core->GetNativeSurface(task.m_yuv);
+        MFX_CHECK(surface, MFX_ERR_UNDEFINED_BEHAVIOR);
+        external = !!(extOpaq.In.Type & MFX_MEMTYPE_SYSTEM_MEMORY);
+    }
+    MFX_CHECK_NULL_PTR1(surface);
+
+    mfxFrameData data = surface->Data;
+    FrameLocker lock(m_core, data, external);
+    MFX_CHECK(data.Y, MFX_ERR_LOCK_MEMORY);
+
+    m_cpuAnalysis->Histogram(data.Y, data.Pitch,
+        surface->Info.Width, surface->Info.Height,
+        m_video.mfx.FrameInfo.CropW, m_video.mfx.FrameInfo.CropH,
+        m_video.mfx.FrameInfo.CropX, m_video.mfx.FrameInfo.CropY,
+        !!task.m_fieldPicFlag, (mfxU32 *)task.m_cmHistSys);
+
+    return lock.Unlock();
+}
+
 
 mfxStatus ImplementationAvc::QueryStatus(
     DdiTask & task,
@@ -3390,7 +3605,10 @@ mfxStatus ImplementationAvc::QueryStatus(
         MFX_TRACE_3("m_ddi->QueryStatus", "Task[field=%d feedback=%d] sts=%d \n", fid, task.m_statusReportNumber[fid], sts);
 
         if (sts == MFX_WRN_DEVICE_BUSY)
+        {
+            m_completionHandle = m_ddi->GetCompletionHandle(task, fid);
             return MFX_TASK_BUSY;
+        }
 
         if (sts != MFX_ERR_NONE)
             return Error(sts);
@@ -1103,7 +1103,7 @@ mfxU32 UmcBrc::GetMinFrameSize()
 }
 
 
-namespace
+namespace MfxHwH264EncodeHW
 {
     mfxF64 const QSTEP[52] = {
          0.630,  0.707,  0.794,  0.891,  1.000,   1.122,   1.260,   1.414,   1.587,   1.782,   2.000,   2.245,   2.520,
@@ -1130,7 +1130,6 @@ namespace
 
 namespace MfxHwH264EncodeHW
 {
-    mfxF64 const INTRA_QSTEP_COEFF  = 2.0;
     mfxI32 const MAX_QP_CHANGE      = 2;
     mfxF64 const LOG2_64            = 3.0;
     mfxF64 const MIN_EST_RATE       = 0.3;
@@ -1172,6 +1171,49 @@ namespace MfxHwH264EncodeHW
 
         return QStep2QpCeil(qskip);
     }
+
+    struct InvQStep
+    {
+        InvQStep()
+        {
+            for (mfxU32 qp = 0; qp < 52; qp++)
+            {
+                inter[qp] = 1.0 / QSTEP[qp];
+                intra[qp] = 1.0 / (QSTEP[qp] * INTRA_QSTEP_COEFF);
+            }
+        }
+
+        mfxF64 inter[52];
+        mfxF64 intra[52];
+    };
+
+    InvQStep const INV_QSTEP;
+
+    // estRate[qp] = laMultiplier / numMb * (sum of intra dist / (QSTEP[qp] * INTRA_QSTEP_COEFF)
+    //                                       + sum of dist / QSTEP[qp] over inter MBs not skipped at qp)
+    // Distortions are summed as integers per skip QP, so the per-QP part is a suffix sum
+    void EstimateRatePerQp(std::vector<MbData> const & mb, mfxF64 laMultiplier, mfxU32 numMb, mfxF64 estRate[52])
+    {
+        mfxU64 intraDist = 0;
+        mfxU64 interDist[53] = {}; // by GetSkippedQp(), 52 - never skipped
+
+        for (size_t i = 0; i < mb.size(); i++)
+        {
+            if (mb[i].intraMbFlag)
+                intraDist += mb[i].dist;
+            else
+                interDist[GetSkippedQp(mb[i])] += mb[i].dist;
+        }
+
+        mfxF64 const scale = laMultiplier / numMb;
+        mfxU64 notSkipped = 0;
+
+        for (mfxI32 qp = 51; qp >= 0; qp--)
+        {
+            notSkipped += interDist[qp + 1];
+            estRate[qp] = scale * (mfxF64(intraDist) * INV_QSTEP.intra[qp] + mfxF64(notSkipped) * INV_QSTEP.inter[qp]);
+        }
+    }
 }
 using namespace MfxHwH264EncodeHW;
 inline void SetMinMaxQP(mfxExtCodingOption2 const &  extOpt2, mfxU8  QPMin[], mfxU8  QPMax[])
@@ -1835,24 +1877,9 @@ void LookAheadBrc2::PreEnc(const BRCFrameParams& par, std::vector<VmeData *> con
         newData.intraCost = vmeData[i]->intraCost;
         newData.propCost  = vmeData[i]->propCost;
         newData.bframe    = vmeData[i]->pocL1 != mfxU32(-1);
-        for (size_t j = 0; j < vmeData[i]->mb.size(); j++)
-        {
-            mfxF64 LaMultiplier = m_LaScaleFactor * m_LaScaleFactor;
-            MbData const & mb = vmeData[i]->mb[j];
-            if (mb.intraMbFlag)
-            {
-                for (mfxU32 qp = 0; qp < 52; qp++)
-                    newData.estRate[qp] += LaMultiplier * mb.dist / (QSTEP[qp] * INTRA_QSTEP_COEFF);
-            }
-            else
-            {
-                mfxU32 skipQp = GetSkippedQp(mb);
-                for (mfxU32 qp = 0; qp < skipQp; qp++)
-                    newData.estRate[qp] += LaMultiplier * mb.dist / (QSTEP[qp]);
-            }
-        }
-        for (mfxU32 qp = 0; qp < 52; qp++)
-            newData.estRate[qp] /= m_totNumMb;
+
+        mfxF64 LaMultiplier = m_LaScaleFactor * m_LaScaleFactor;
+        EstimateRatePerQp(vmeData[i]->mb, LaMultiplier, m_totNumMb, newData.estRate);
         m_laData.push_back(newData);
     }
     assert(m_laData.size() <= m_lookAhead + m_AsyncDepth);
@@ -2840,6 +2867,19 @@ MfxFrameAllocResponse::~MfxFrameAllocResponse()
             }
         }
     }
+
+    if (!m_core && !m_cmDevice)
+    {
+        // AllocSysBuffers
+        for (size_t i = 0; i < m_sysmems.size(); i++)
+        {
+            if (m_sysmems[i])
+            {
+                CM_ALIGNED_FREE(m_sysmems[i]);
+                m_sysmems[i] = 0;
+            }
+        }
+    }
 }
 
 void MfxFrameAllocResponse::DestroyBuffer(CmDevice * device, void * p)
@@ -3032,6 +3072,35 @@ mfxStatus MfxFrameAllocResponse::AllocFrames(
     m_cmDestroy = 0;
     return MFX_ERR_NONE;
 }
+
+mfxStatus MfxFrameAllocResponse::AllocSysBuffers(
+    mfxFrameAllocRequest & req)
+{
+    if (m_core || m_cmDevice || !m_sysmems.empty())
+        return Error(MFX_ERR_MEMORY_ALLOC);
+
+    req.NumFrameSuggested = req.NumFrameMin;
+    mfxU32 size = req.Info.Width * req.Info.Height;
+
+    m_mids.resize(req.NumFrameMin, 0);
+    m_locked.resize(req.NumFrameMin, 0);
+    m_sysmems.resize(req.NumFrameMin, 0);
+
+    for (int i = 0; i < req.NumFrameMin; i++)
+    {
+        m_sysmems[i] = CM_ALIGNED_MALLOC(size, 0x1000);
+        if (!m_sysmems[i])
+            return Error(MFX_ERR_MEMORY_ALLOC);
+        m_mids[i] = m_sysmems[i];
+    }
+
+    NumFrameActual = req.NumFrameMin;
+    mids = &m_mids[0];
+
+    m_cmDestroy = 0;
+    return MFX_ERR_NONE;
+}
+
 mfxStatus MfxFrameAllocResponse::UpdateResourcePointers(mfxU32 idxScd, void * memY, void * gpuSurf)
 {
     if (m_mids.size() < idxScd || m_sysmems.size() < idxScd)
@@ -25,6 +25,7 @@
 
 
 #include "mfx_h264_encode_hw_utils.h"
+#include "mfx_h264_encode_cpu_la.h"
 
 using namespace MfxHwH264Encode;
 
@@ -2614,39 +2615,13 @@ namespace MfxHwH264EncodeHW
         if (mbx + 1 < width && mby + 1 < height && mbx + 1 >= 0 && mby + 1 >= 0)
             mb[width * (mby + 1) + mbx + 1].propCost += mfxU32(cost * (     xx) * (     yy) / 256);
     }
-};
-using namespace MfxHwH264EncodeHW;
-
-
-void MfxHwH264Encode::AnalyzeVmeData(DdiTaskIter begin, DdiTaskIter end, mfxU32 width, mfxU32 height)
-{
-    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "AnalyzeVmeData");
 
-    mfxI32 w = width  >> 4;
-    mfxI32 h = height >> 4;
-
-    for (DdiTaskIter task = begin; task != end; task++)
+    // propagates costs of MB rows [rowBegin, rowEnd) of 'cur' to its references
+    void PropagateRows(VmeData const & cur, VmeData * l0, VmeData * l1, mfxI32 w, mfxI32 h, mfxI32 rowBegin, mfxI32 rowEnd)
     {
-        task->m_vmeData->propCost = 0;
-        for (size_t i = 0; i < task->m_vmeData->mb.size(); i++)
-            task->m_vmeData->mb[i].propCost = 0;
-    }
-
-    DdiTaskIter task = end;
-    for (--task; task != begin; --task)
-    {
-        VmeData * cur = task->m_vmeData;
-        VmeData * l0  = 0;
-        VmeData * l1  = 0;
-
-        if (task->m_fwdRef && task->m_fwdRef->m_encOrder >= begin->m_encOrder)
-            l0 = task->m_fwdRef->m_vmeData;
-        if (task->m_bwdRef && task->m_bwdRef->m_encOrder >= begin->m_encOrder)
-            l1 = task->m_bwdRef->m_vmeData;
-
-        for (mfxI32 y = 0; y < h; y++)
+        for (mfxI32 y = rowBegin; y < rowEnd; y++)
         {
-            MbData const * mb = &cur->mb[y * w];
+            MbData const * mb = &cur.mb[y * w];
             for (mfxI32 x = 0; x < w; x++, mb++)
             {
                 if (!mb->intraMbFlag)
@@ -2687,6 +2662,41 @@ void MfxHwH264Encode::AnalyzeVmeData(DdiTaskIter begin, DdiTaskIter end, mfxU32
                 }
             }
         }
+    }
+};
+using namespace MfxHwH264EncodeHW;
+
+
+void MfxHwH264Encode::AnalyzeVmeData(DdiTaskIter begin, DdiTaskIter end, mfxU32 width, mfxU32 height, CpuLookahead * cpuLa)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "AnalyzeVmeData");
+
+    mfxI32 w = width  >> 4;
+    mfxI32 h = height >> 4;
+
+    for (DdiTaskIter task = begin; task != end; task++)
+    {
+        task->m_vmeData->propCost = 0;
+        for (size_t i = 0; i < task->m_vmeData->mb.size(); i++)
+            task->m_vmeData->mb[i].propCost = 0;
+    }
+
+    DdiTaskIter task = end;
+    for (--task; task != begin; --task)
+    {
+        VmeData * cur = task->m_vmeData;
+        VmeData * l0  = 0;
+        VmeData * l1  = 0;
+
+        if (task->m_fwdRef && task->m_fwdRef->m_encOrder >= begin->m_encOrder)
+            l0 = task->m_fwdRef->m_vmeData;
+        if (task->m_bwdRef && task->m_bwdRef->m_encOrder >= begin->m_encOrder)
+            l1 = task->m_bwdRef->m_vmeData;
+
+        if (cpuLa)
+            cpuLa->Propagate(*cur, l0, l1);
+        else
+            PropagateRows(*cur, l0, l1, w, h, 0, h);
 
         cur->propCost = 0;
         for (size_t i = 0; i < cur->mb.size(); i++)
@@ -67,6 +67,10 @@ DriverEncoder* CreatePlatformH265Encoder(VideoCORE* core, ENCODER_TYPE type)
 {
     (void)type;
 
+    // the null device has no stub of the HEVC encoder, the codec is unsupported
+    if (QueryCoreInterface<NullDeviceParam>(core, MFXINULLDEVICE_GUID))
+        return nullptr;
+
     if (core)
     {
         switch(core->GetVAType())
@@ -25,6 +25,7 @@
 #include "hevcehw_base.h"
 #include "mfx_h265_encode_hw.h"
 #include "mfx_h265_fei_encode_hw.h"
+#include "libmfx_core_interface.h"
 
 namespace HEVCEHW
 {
@@ -134,6 +135,14 @@ namespace HEVCEHW
 namespace HEVCEHW
 {
 
+// The null device (see libmfx_core_null.h) has no stub of the encoder DDI
+static bool IsSupported(
+    eMFXHWType HW
+    , VideoCORE& core)
+{
+    return (HW >= MFX_HW_SCL) && !QueryCoreInterface<NullDeviceParam>(&core, MFXINULLDEVICE_GUID);
+}
+
 static ImplBase* CreateSpecific(
     eMFXHWType HW
     , VideoCORE& core
@@ -156,7 +165,7 @@ VideoENCODE* Create(
 {
     auto hw = core.GetHWType();
 
-    if (hw < MFX_HW_SCL)
+    if (!IsSupported(hw, core))
     {
         status = MFX_ERR_UNSUPPORTED;
         return nullptr;
@@ -182,7 +191,7 @@ mfxStatus QueryIOSurf(
 
     auto hw = core->GetHWType();
 
-    if (hw < MFX_HW_SCL)
+    if (!IsSupported(hw, *core))
         return MFX_ERR_UNSUPPORTED;
 
     mfxStatus sts = MFX_ERR_NONE;
@@ -207,7 +216,7 @@ mfxStatus Query(
 
     auto hw = core->GetHWType();
 
-    if (hw < MFX_HW_SCL)
+    if (!IsSupported(hw, *core))
         return MFX_ERR_UNSUPPORTED;
 
     mfxStatus sts = MFX_ERR_NONE;
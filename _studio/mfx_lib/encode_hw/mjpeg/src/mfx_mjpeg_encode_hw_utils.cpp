@@ -316,7 +316,8 @@ mfxStatus ExecuteBuffers::Init(mfxVideoParam const *par, mfxEncodeCtrl const * c
     m_pps.num_scan = 1;
     m_scan_list.resize(1);
     memset(&m_scan_list[0], 0, sizeof(m_scan_list[0]));
-    m_scan_list[0].restart_interval = par->mfx.RestartInterval;
+    // single piece is encoded by HW, there is nothing to balance
+    m_scan_list[0].restart_interval = par->mfx.RestartInterval == MFX_JPEG_RESTART_INTERVAL_AUTO ? 0 : par->mfx.RestartInterval;
     m_scan_list[0].num_components = m_pps.num_components;
     m_scan_list[0].components[0].component_selector = 1;
     m_scan_list[0].components[1].component_selector = 2;
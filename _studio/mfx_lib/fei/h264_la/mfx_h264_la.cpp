@@ -976,11 +976,6 @@ mfxStatus VideoENC_LA::RunFrameVmeENCCheck(
     return sts;
 }
 
-namespace MfxHwH264EncodeHW
-{
-    mfxU8 GetSkippedQp(MfxHwH264Encode::MbData const & mb);
-    void DivideCost(std::vector<MfxHwH264Encode::MbData> & mb, mfxI32 width, mfxI32 height, mfxU32 cost, mfxI32 x, mfxI32 y);
-};
 using namespace MfxHwH264EncodeHW;
 
 MfxHwH264Encode::VmeData * FindUnusedVmeData(std::vector<MfxHwH264Encode::VmeData> & vmeData)
@@ -219,6 +219,24 @@ struct spatialNoiseAnalysis
         SCpp;
 };
 
+// models of noise estimation shared by CMC and CpuMctf
+mfxU16 CalcNoiseStrength(
+    double NSC,
+    double NSAD
+);
+mfxU8 CalcSTC(
+    mfxF64 SCpp2,
+    mfxF64 sadpp
+);
+mfxU8 CalcSpatialClass(
+    mfxF64 SCpp2
+);
+mfxU32 CalcQpClass(
+    mfxU8  sc,
+    mfxF64 frame_sad,
+    mfxF64 bpp
+);
+
 struct MeControlSmall // sizeof=96
 {
     VmeSearchPath searchPath;
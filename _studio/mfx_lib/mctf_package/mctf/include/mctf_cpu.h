@@ -0,0 +1,168 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include "mctf_common.h"
+
+// CPU implementation of MCTF, works without CM device.
+//
+// It takes the same IntMctfParams as CMC and keeps the same queue: frames of the
+// output size are filled by the caller (MCTF_GetEmptySurface) and put to the queue
+// (MCTF_PUT_FRAME), MCTF_GET_FRAME returns the filtering of the frame due for output
+// once the future references are queued (one frame delay for 2 references,
+// two frames for 4 references), or of the frames left at the end of stream.
+//
+// Filtering of a frame is a Job done in stages, regions of a stage may be run by
+// different threads but a stage starts when all regions of the previous one are done:
+//   STAGE_ME       - motion estimation of 8x8 luma blocks to every reference and
+//                    statistics of 16x16 blocks for the noise analysis;
+//   STAGE_ANALYSIS - references of another scene are dropped, filter strength is
+//                    estimated from the noise in automatic mode;
+//   STAGE_MERGE    - luma blocks are merged with motion compensated blocks weighted by
+//                    similarity (kernels of genx_mc), chroma is denoised spatially;
+//   STAGE_DENOISE  - spatial denoising of the merged frame if deblocking is on.
+// Only NV12 is supported, as by CMC.
+class CpuMctf
+{
+public:
+    enum
+    {
+        MAX_REFS          = 4,
+        BLOCK_SIZE        = 8,
+        REGION_BLOCK_ROWS = 4       // two rows of 16x16 blocks of noise analysis
+    };
+
+    enum Stage
+    {
+        STAGE_ME,
+        STAGE_ANALYSIS,
+        STAGE_MERGE,
+        STAGE_DENOISE,
+        NUM_STAGES
+    };
+
+    struct Frame
+    {
+        std::vector<mfxU8>  buffer;
+        mfxFrameData        data;       // NV12 of the frame size
+        mfxU16              crop[4];    // X, Y, W, H
+        mfxU64              timeStamp;
+        mfxU32              frameOrder;
+        IntMctfParams       control;    // run-time controls passed with the frame
+    };
+
+    struct Job
+    {
+        std::shared_ptr<const Frame>        cur;
+        std::shared_ptr<const Frame>        refs[MAX_REFS];     // previous, next, second previous, second next,
+                                                                // empty if there is no such frame for the mode
+        bool                                useRef[MAX_REFS];   // reference is present and of the same scene
+        mfxU16                              numReferences;      // NUOR of the temporal mode
+        bool                                overlap;
+        bool                                deblocking;
+        bool                                subPel;
+        bool                                autoStrength;
+        bool                                bitrateAdaptation;
+        mfxF64                              bpp;
+        mfxU16                              strength;           // [0...20]
+        mfxU32                              blocksW;            // 8x8 luma blocks of the crop
+        mfxU32                              blocksH;
+        std::vector<mfxI16Pair>             mv[MAX_REFS];       // quarter-pel
+        std::vector<mfxU32>                 sad[MAX_REFS];
+        std::vector<spatialNoiseAnalysis>   noise;              // 16x16 blocks, automatic mode
+        std::shared_ptr<Frame>              merged;             // output of STAGE_MERGE if deblocking is on
+    };
+
+    // Kernels of 8x8 luma blocks, C and Intel AVX2 versions.
+    // InterpolateBlock8x8 reads 9x9 samples if fx or fy is not 0, 'pred' and 'dst' of the others are 8x8 with pitch 8.
+    static mfxU32 SAD8x8_C(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * ref, mfxI32 refPitch);
+    static void   InterpolateBlock8x8_C(const mfxU8 * ref, mfxI32 pitch, mfxU32 fx, mfxU32 fy, mfxU8 * dst);
+    static void   MergeBlock8x8_C(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * const * pred, const mfxI32 * weight,
+                                  mfxU32 num, mfxI32 srcWeight, mfxU8 * dst);
+
+    static mfxU32 SAD8x8_AVX2(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * ref, mfxI32 refPitch);
+    static void   InterpolateBlock8x8_AVX2(const mfxU8 * ref, mfxI32 pitch, mfxU32 fx, mfxU32 fy, mfxU8 * dst);
+    static void   MergeBlock8x8_AVX2(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * const * pred, const mfxI32 * weight,
+                                     mfxU32 num, mfxI32 srcWeight, mfxU8 * dst);
+
+    struct Kernels
+    {
+        mfxU32 (*SAD8x8)(const mfxU8 *, mfxI32, const mfxU8 *, mfxI32);
+        void   (*InterpolateBlock8x8)(const mfxU8 *, mfxI32, mfxU32, mfxU32, mfxU8 *);
+        void   (*MergeBlock8x8)(const mfxU8 *, mfxI32, const mfxU8 * const *, const mfxI32 *, mfxU32, mfxI32, mfxU8 *);
+    };
+
+    static Kernels const & GetKernels();
+
+    CpuMctf();
+
+    mfxStatus MCTF_INIT(
+        const mfxFrameInfo  & FrameInfo,
+        const IntMctfParams * pMctfParam
+    );
+    void MCTF_CLOSE();
+
+    mfxU16 MCTF_GetReferenceNumber() const { return m_numReferences; }
+    mfxU32 MCTF_GetQueueDepth() const { return m_numPast + m_delay + 1; }
+
+    // returns a frame which is not used by the queue or jobs, to be filled by the caller
+    std::shared_ptr<Frame> MCTF_GetEmptySurface();
+
+    // submits a filled frame with crop of 'info' & run-time controls (NULL for the init ones)
+    mfxStatus MCTF_PUT_FRAME(
+        IntMctfParams                * pMctfControl,
+        std::shared_ptr<Frame> const & frame,
+        const mfxFrameInfo           & info,
+        mfxU64                         timeStamp,
+        mfxU32                         frameOrder
+    );
+
+    // returns the job of the frame due for output; at the end of stream the frames
+    // left in the queue are returned; MFX_ERR_MORE_DATA if there is no such frame
+    mfxStatus MCTF_GET_FRAME(
+        std::shared_ptr<Job> & job,
+        bool                   endOfStream
+    );
+
+    static mfxU32 GetNumRegions(Job const & job, mfxU32 stage);
+
+    // runs region of the stage, frame data of the job and 'out' must be filled / locked;
+    // 'out' is written by the last stage of the job
+    static void Run(Job & job, mfxU32 stage, mfxU32 region, mfxFrameData & out);
+
+protected:
+    mfxU16                                m_numReferences;
+    mfxU32                                m_numPast;      // references before the frame
+    mfxU32                                m_delay;        // references after the frame
+    IntMctfParams                         m_InitRTParams;
+    bool                                  m_bAutoMode;
+    bool                                  m_bitrateAdaptation;
+    mfxU16                                m_width;
+    mfxU16                                m_height;
+    std::vector<std::shared_ptr<Frame> >  m_pool;
+    std::deque<std::shared_ptr<Frame> >   m_queue;        // frames from m_first in display order
+    mfxU32                                m_first;
+    mfxU32                                m_numPut;
+    mfxU32                                m_numOut;
+};
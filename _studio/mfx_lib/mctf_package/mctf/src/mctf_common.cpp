@@ -1898,23 +1898,27 @@ mfxU8 CalcSTC(mfxF64 SCpp2, mfxF64 sadpp)
 }
 
 
-void CMC::GetSpatioTemporalComplexityFrame(mfxU8 currentFrame)
+mfxU8 CalcSpatialClass(mfxF64 SCpp2)
 {
-    mfxU8
-        i;
-    mfxF64
-        SCpp2 = QfIn[currentFrame].frame_sc;
     static mfxF32
         lmt_sc2[10] = { 16.0, 81.0, 225.0, 529.0, 1024.0, 1764.0, 2809.0, 4225.0, 6084.0, (mfxF32)INT_MAX }; // lower limit of SFM(Rs,Cs) range for spatial classification
 
-    for (i = 0; i < 10; i++)
+    for (mfxU8 i = 0; i < 10; i++)
     {
         if (SCpp2 < lmt_sc2[i])
-        {
-            QfIn[currentFrame].sc = i;
-            break;
-        }
+            return i;
     }
+    return 0;
+}
+
+void CMC::GetSpatioTemporalComplexityFrame(mfxU8 currentFrame)
+{
+    mfxU8
+        i;
+    mfxF64
+        SCpp2 = QfIn[currentFrame].frame_sc;
+
+    QfIn[currentFrame].sc = CalcSpatialClass(SCpp2);
     QfIn[currentFrame].tc = 0;
     QfIn[currentFrame].stc = 0;
     mfxF64
@@ -1932,13 +1936,15 @@ void CMC::GetSpatioTemporalComplexityFrame(mfxU8 currentFrame)
     QfIn[currentFrame].stc = CalcSTC(SCpp2, sadpp);
 }
 
-mfxU32 CMC::computeQpClassFromBitRate(
-    mfxU8 currentFrame
+mfxU32 CalcQpClass(
+    mfxU8  sc,
+    mfxF64 frame_sad,
+    mfxF64 bpp
 )
 {
     mfxF64
-        scL = log10(QfIn[currentFrame].sc),
-        sadL = log10(QfIn[currentFrame].frame_sad);
+        scL = log10(sc),
+        sadL = log10(frame_sad);
     mfxF64
         d0 = sadL * scL,
         A, B = -0.75;
@@ -1960,6 +1966,13 @@ mfxU32 CMC::computeQpClassFromBitRate(
     return QCL;
 }
 
+mfxU32 CMC::computeQpClassFromBitRate(
+    mfxU8 currentFrame
+)
+{
+    return CalcQpClass(QfIn[currentFrame].sc, QfIn[currentFrame].frame_sad, bpp);
+}
+
 
 void CMC::noise_estimator() 
 {
@@ -0,0 +1,1151 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mctf_cpu.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define MCTF_CPU_DISP_INIT_C(func)           (func ## _C)
+#define MCTF_CPU_DISP_INIT_AVX2(func)        (func ## _AVX2)
+#define MCTF_CPU_DISP_INIT_AVX2_C(func)      (m_AVX2_available ? MCTF_CPU_DISP_INIT_AVX2(func) : MCTF_CPU_DISP_INIT_C(func))
+
+namespace
+{
+    enum
+    {
+        FRAME_ALIGNMENT     = 64,
+        SEARCH_RANGE        = 32,       // integer pixels around the zero vector
+        SCENE_CHANGE_SAD    = 12,       // mean SAD per pixel of the matches in a frame of another scene
+
+        // constants of genx_blend_mc.h
+        MERGE_LIMIT         = 256,
+        WEIGHT_MULTIPLIER   = 8,
+        SELECTION_THRESHOLD = 8388608,
+        DISTANCE_TH         = 8,
+        MAX_SAD2            = 83968,
+
+        NOISE_TH            = 281       // limit of variance and SCpp of the blocks of noise, see CMC::noise_estimator
+    };
+
+    // Block of the crop; blocks of the last column and row are moved inside the crop,
+    // their first skipX columns / skipY rows belong to the previous blocks and aren't written
+    struct BlockPos
+    {
+        mfxI32 x;
+        mfxI32 y;
+        mfxU32 skipX;
+        mfxU32 skipY;
+    };
+}
+
+static mfxI32 CpuFeature_AVX2()
+{
+    return((__builtin_cpu_supports("avx2")));
+}
+
+CpuMctf::Kernels const & CpuMctf::GetKernels()
+{
+    static const int m_AVX2_available = CpuFeature_AVX2();
+
+    static const Kernels kernels =
+    {
+        MCTF_CPU_DISP_INIT_AVX2_C(SAD8x8),
+        MCTF_CPU_DISP_INIT_AVX2_C(InterpolateBlock8x8),
+        MCTF_CPU_DISP_INIT_AVX2_C(MergeBlock8x8)
+    };
+
+    return kernels;
+}
+
+mfxU32 CpuMctf::SAD8x8_C(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * ref, mfxI32 refPitch)
+{
+    mfxU32 sad = 0;
+
+    for (mfxU32 y = 0; y < BLOCK_SIZE; y++, src += srcPitch, ref += refPitch)
+        for (mfxU32 x = 0; x < BLOCK_SIZE; x++)
+            sad += abs(src[x] - ref[x]);
+
+    return sad;
+}
+
+// bilinear interpolation of quarter-pel position
+void CpuMctf::InterpolateBlock8x8_C(const mfxU8 * ref, mfxI32 pitch, mfxU32 fx, mfxU32 fy, mfxU8 * dst)
+{
+    if (!fx && !fy)
+    {
+        for (mfxU32 y = 0; y < BLOCK_SIZE; y++)
+            memcpy(dst + y * BLOCK_SIZE, ref + y * pitch, BLOCK_SIZE);
+        return;
+    }
+
+    const mfxI32 w00 = (4 - fx) * (4 - fy);
+    const mfxI32 w01 = fx * (4 - fy);
+    const mfxI32 w10 = (4 - fx) * fy;
+    const mfxI32 w11 = fx * fy;
+
+    for (mfxU32 y = 0; y < BLOCK_SIZE; y++, ref += pitch, dst += BLOCK_SIZE)
+        for (mfxU32 x = 0; x < BLOCK_SIZE; x++)
+            dst[x] = (mfxU8)((w00 * ref[x] + w01 * ref[x + 1] + w10 * ref[x + pitch] + w11 * ref[x + pitch + 1] + 8) >> 4);
+}
+
+// mergeBlocksRef / mergeBlocks2Ref of genx_blend_mc.h for any number of predictions
+void CpuMctf::MergeBlock8x8_C(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * const * pred, const mfxI32 * weight,
+                              mfxU32 num, mfxI32 srcWeight, mfxU8 * dst)
+{
+    for (mfxU32 y = 0; y < BLOCK_SIZE; y++, src += srcPitch)
+    {
+        for (mfxU32 x = 0; x < BLOCK_SIZE; x++)
+        {
+            const mfxU32 i = y * BLOCK_SIZE + x;
+            mfxI32 acc = src[x] * srcWeight + (MERGE_LIMIT >> 1);
+
+            for (mfxU32 k = 0; k < num; k++)
+                acc += pred[k][i] * weight[k];
+
+            dst[i] = (mfxU8)(acc >> WEIGHT_MULTIPLIER);
+        }
+    }
+}
+
+static inline mfxI32 Clip3(mfxI32 min, mfxI32 max, mfxI32 x)
+{
+    return x < min ? min : (x > max ? max : x);
+}
+
+static inline mfxI32 GetPitch(mfxFrameData const & data)
+{
+    return (mfxI32)(data.PitchLow + ((mfxU32)data.PitchHigh << 16));
+}
+
+static BlockPos GetBlockPos(CpuMctf::Frame const & frame, mfxU32 bx, mfxU32 by, mfxU32 size)
+{
+    const mfxU32 x = bx * size;
+    const mfxU32 y = by * size;
+    const mfxU32 cx = std::min<mfxU32>(x, frame.crop[2] - size);
+    const mfxU32 cy = std::min<mfxU32>(y, frame.crop[3] - size);
+
+    BlockPos pos;
+    pos.x     = frame.crop[0] + cx;
+    pos.y     = frame.crop[1] + cy;
+    pos.skipX = x - cx;
+    pos.skipY = y - cy;
+    return pos;
+}
+
+// luma window [x, x + w) x [y, y + h), coordinates are clamped to the crop
+static void LoadLuma(CpuMctf::Frame const & frame, mfxI32 x, mfxI32 y, mfxU32 w, mfxU32 h, mfxU8 * dst)
+{
+    const mfxI32 pitch  = GetPitch(frame.data);
+    const mfxI32 left   = frame.crop[0];
+    const mfxI32 right  = frame.crop[0] + frame.crop[2] - 1;
+    const mfxI32 top    = frame.crop[1];
+    const mfxI32 bottom = frame.crop[1] + frame.crop[3] - 1;
+
+    for (mfxU32 i = 0; i < h; i++, dst += w)
+    {
+        const mfxU8 * row = frame.data.Y + Clip3(top, bottom, y + (mfxI32)i) * pitch;
+
+        if (x >= left && x + (mfxI32)w - 1 <= right)
+            memcpy(dst, row + x, w);
+        else
+            for (mfxU32 j = 0; j < w; j++)
+                dst[j] = row[Clip3(left, right, x + (mfxI32)j)];
+    }
+}
+
+// window of interleaved chroma, bytes [x, x + w) of rows [y, y + h), samples are clamped to the crop
+static void LoadChroma(CpuMctf::Frame const & frame, mfxI32 x, mfxI32 y, mfxU32 w, mfxU32 h, mfxU8 * dst)
+{
+    const mfxI32 pitch  = GetPitch(frame.data);
+    const mfxI32 left   = frame.crop[0] / 2;
+    const mfxI32 right  = (frame.crop[0] + frame.crop[2]) / 2 - 1;
+    const mfxI32 top    = frame.crop[1] / 2;
+    const mfxI32 bottom = (frame.crop[1] + frame.crop[3]) / 2 - 1;
+
+    for (mfxU32 i = 0; i < h; i++, dst += w)
+    {
+        const mfxU8 * row = frame.data.UV + Clip3(top, bottom, y + (mfxI32)i) * pitch;
+
+        if (x >= 2 * left && x + (mfxI32)w - 1 <= 2 * right + 1)
+            memcpy(dst, row + x, w);
+        else
+            for (mfxU32 j = 0; j < w; j++)
+            {
+                const mfxI32 b = x + (mfxI32)j;
+                dst[j] = row[2 * Clip3(left, right, b >> 1) + (b & 1)];
+            }
+    }
+}
+
+// writes 8x8 luma and 4x8 chroma bytes of the block
+static void StoreBlock(mfxFrameData & out, BlockPos const & pos, const mfxU8 * luma, const mfxU8 * chroma)
+{
+    const mfxI32 pitch = GetPitch(out);
+    const mfxU32 width = CpuMctf::BLOCK_SIZE - pos.skipX;
+
+    for (mfxU32 y = pos.skipY; y < CpuMctf::BLOCK_SIZE; y++)
+        memcpy(out.Y + (pos.y + y) * pitch + pos.x + pos.skipX, luma + y * CpuMctf::BLOCK_SIZE + pos.skipX, width);
+
+    for (mfxU32 y = pos.skipY / 2; y < CpuMctf::BLOCK_SIZE / 2; y++)
+        memcpy(out.UV + (pos.y / 2 + y) * pitch + pos.x + pos.skipX, chroma + y * CpuMctf::BLOCK_SIZE + pos.skipX, width);
+}
+
+// DispersionCalculator of genx_sd_common.h and the filter coefficients of 2x2 luma samples,
+// 'win' is 12x12 window of the block at (2, 2)
+static void CalcDenoiseCoefs(const mfxU8 * win, mfxF32 st, mfxF32 * k0, mfxF32 * k1, mfxF32 * k2)
+{
+    for (mfxU32 i = 0; i < 4; i++)
+    {
+        for (mfxU32 j = 0; j < 4; j++)
+        {
+            mfxU32 mean = 0;
+            for (mfxU32 r = 0; r < 4; r++)
+                for (mfxU32 c = 0; c < 4; c++)
+                    mean += win[(2 + 2 * i + r) * 12 + 2 + 2 * j + c];
+            mean >>= 4;
+
+            mfxU32 disp = 0;
+            for (mfxU32 r = 0; r < 4; r++)
+                for (mfxU32 c = 0; c < 4; c++)
+                {
+                    const mfxI32 d = win[(2 * i + r) * 12 + 2 * j + c] - (mfxI32)mean;
+                    disp += d * d;
+                }
+            disp >>= 4;
+
+            const mfxF32 h1 = expf(-(disp / st));
+            const mfxF32 h2 = expf(-(2.0f * disp / st));
+            const mfxF32 hh = 1.0f + 4.0f * (h1 + h2);
+
+            k0[i * 4 + j] = 1.0f / hh;
+            k1[i * 4 + j] = h1 / hh;
+            k2[i * 4 + j] = h2 / hh;
+        }
+    }
+}
+
+static void DenoiseLuma(const mfxU8 * win, const mfxF32 * k0, const mfxF32 * k1, const mfxF32 * k2, mfxU8 * out)
+{
+    for (mfxU32 y = 0; y < CpuMctf::BLOCK_SIZE; y++)
+    {
+        const mfxU8 * p = win + (2 + y) * 12 + 2;
+
+        for (mfxU32 x = 0; x < CpuMctf::BLOCK_SIZE; x++, p++)
+        {
+            const mfxU32 k = (y / 2) * 4 + x / 2;
+            const mfxF32 v = p[0] * k0[k]
+                + (p[-1] + p[1] + p[-12] + p[12]) * k1[k]
+                + (p[-13] + p[-11] + p[11] + p[13]) * k2[k] + 0.5f;
+
+            out[y * CpuMctf::BLOCK_SIZE + x] = (mfxU8)std::min(v, 255.0f);
+        }
+    }
+}
+
+// 'scm' is 6x12 bytes of interleaved chroma of the block at (1, 2)
+static void DenoiseChroma(const mfxU8 * scm, const mfxF32 * k0, const mfxF32 * k1, const mfxF32 * k2, mfxU8 * out)
+{
+    for (mfxU32 y = 0; y < CpuMctf::BLOCK_SIZE / 2; y++)
+    {
+        const mfxU8 * p = scm + (1 + y) * 12 + 2;
+
+        for (mfxU32 x = 0; x < CpuMctf::BLOCK_SIZE; x++, p++)
+        {
+            const mfxU32 k = y * 4 + x / 2;
+            const mfxF32 v = p[0] * k0[k]
+                + (p[-2] + p[2] + p[-12] + p[12]) * k1[k]
+                + (p[-14] + p[-10] + p[10] + p[14]) * k2[k] + 0.5f;
+
+            out[y * CpuMctf::BLOCK_SIZE + x] = (mfxU8)std::min(v, 255.0f);
+        }
+    }
+}
+
+// SpatialDenoiser_8x8_NV12 of genx_sd.cpp
+static void SpatialDenoiseBlock(CpuMctf::Frame const & src, BlockPos const & pos, mfxF32 st, mfxU8 * luma, mfxU8 * chroma)
+{
+    mfxU8 win[12 * 12], scm[6 * 12];
+    mfxF32 k0[16], k1[16], k2[16];
+
+    LoadLuma(src, pos.x - 2, pos.y - 2, 12, 12, win);
+    LoadChroma(src, pos.x - 2, pos.y / 2 - 1, 12, 6, scm);
+
+    CalcDenoiseCoefs(win, st, k0, k1, k2);
+    DenoiseLuma(win, k0, k1, k2, luma);
+    DenoiseChroma(scm, k0, k1, k2, chroma);
+}
+
+// Genx_RsCs_aprox_8x8Block of genx_blend_mc.h
+static void CalcRsCs(const mfxU8 * block, mfxI32 pitch, mfxF32 * rscs)
+{
+    mfxU32 rs = 0, cs = 0;
+
+    for (mfxI32 r = 2; r < 6; r++)
+    {
+        for (mfxI32 c = 2; c < 6; c++)
+        {
+            const mfxI32 dr = block[r * pitch + c] - block[(r + 1) * pitch + c];
+            const mfxI32 dc = block[r * pitch + c] - block[r * pitch + c + 1];
+            rs += dr * dr;
+            cs += dc * dc;
+        }
+    }
+
+    rscs[0] = sqrtf((mfxF32)(rs >> 4));
+    rscs[1] = sqrtf((mfxF32)(cs >> 4));
+}
+
+// SimIdx_8x8p of genx_blend_mc.h
+static mfxI32 CalcSimilarity(mfxU32 sad, mfxI32 th, mfxI32 size, mfxF32 dRs, mfxF32 dCs)
+{
+    const mfxI32 val = (mfxI32)(sad * sad);
+    const mfxI32 thEff = (mfxI32)((th * th) / (sqrtf(size + dRs * dRs + dCs * dCs) / 16.0f + 1.0f));
+
+    if (thEff <= val || val > MAX_SAD2)
+        return 0;
+
+    const mfxI32 sub = thEff - val;
+    const mfxI32 sum = thEff + val;
+
+    return sub < SELECTION_THRESHOLD ? (sub << WEIGHT_MULTIPLIER) / sum : sub / (sum >> WEIGHT_MULTIPLIER);
+}
+
+// Keeps the 8x8 block at (x, y) displaced by 'mv' inside the crop, fractional
+// positions need 9x9 samples and are rounded down if there are no such samples
+static mfxI16Pair ClampMv(CpuMctf::Frame const & frame, mfxI32 x, mfxI32 y, mfxI16Pair mv)
+{
+    const mfxI32 minX = 4 * (frame.crop[0] - x);
+    const mfxI32 maxX = 4 * (frame.crop[0] + frame.crop[2] - CpuMctf::BLOCK_SIZE - x);
+    const mfxI32 minY = 4 * (frame.crop[1] - y);
+    const mfxI32 maxY = 4 * (frame.crop[1] + frame.crop[3] - CpuMctf::BLOCK_SIZE - y);
+
+    mv.x = (mfxI16)Clip3(minX, maxX, mv.x);
+    mv.y = (mfxI16)Clip3(minY, maxY, mv.y);
+
+    if (((mv.x | mv.y) & 3) && (mv.x >= maxX || mv.y >= maxY))
+    {
+        mv.x = (mfxI16)(mv.x & ~3);
+        mv.y = (mfxI16)(mv.y & ~3);
+    }
+
+    return mv;
+}
+
+static void PredictBlock(CpuMctf::Kernels const & kernels, CpuMctf::Frame const & ref, mfxI32 x, mfxI32 y, mfxI16Pair mv, mfxU8 * dst)
+{
+    const mfxI32 pitch = GetPitch(ref.data);
+    const mfxU8 * p = ref.data.Y + (y + (mv.y >> 2)) * pitch + x + (mv.x >> 2);
+
+    kernels.InterpolateBlock8x8(p, pitch, mv.x & 3, mv.y & 3, dst);
+}
+
+static inline mfxU32 MvCost(mfxU32 sad, mfxI16Pair mv)
+{
+    return sad + ((abs(mv.x) + abs(mv.y)) >> 2);
+}
+
+// Block matching of the luma blocks of the rows: the best of zero, left and upper vectors
+// is refined by diamond search in integer pixels, then by half and quarter pixels
+static void EstimateMotion(CpuMctf::Job & job, mfxU32 refIdx, mfxU32 firstRow, mfxU32 lastRow)
+{
+    CpuMctf::Kernels const & kernels = CpuMctf::GetKernels();
+    CpuMctf::Frame const & cur = *job.cur;
+    CpuMctf::Frame const & ref = *job.refs[refIdx];
+    const mfxI32 pitch    = GetPitch(cur.data);
+    const mfxI32 refPitch = GetPitch(ref.data);
+
+    mfxI16Pair * mvs  = job.mv[refIdx].data();
+    mfxU32 *     sads = job.sad[refIdx].data();
+
+    mfxU8 pred[CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+
+    for (mfxU32 by = firstRow; by < lastRow; by++)
+    {
+        for (mfxU32 bx = 0; bx < job.blocksW; bx++)
+        {
+            const BlockPos pos = GetBlockPos(cur, bx, by, CpuMctf::BLOCK_SIZE);
+            const mfxU8 * src = cur.data.Y + pos.y * pitch + pos.x;
+            const mfxU32 idx = by * job.blocksW + bx;
+
+            // integer range
+            const mfxI32 minX = std::max<mfxI32>(-SEARCH_RANGE, cur.crop[0] - pos.x);
+            const mfxI32 maxX = std::min<mfxI32>(SEARCH_RANGE, cur.crop[0] + cur.crop[2] - CpuMctf::BLOCK_SIZE - pos.x);
+            const mfxI32 minY = std::max<mfxI32>(-SEARCH_RANGE, cur.crop[1] - pos.y);
+            const mfxI32 maxY = std::min<mfxI32>(SEARCH_RANGE, cur.crop[1] + cur.crop[3] - CpuMctf::BLOCK_SIZE - pos.y);
+
+            mfxI16Pair cand[3] = {};
+            mfxU32 numCand = 1;
+            if (bx > 0)
+                cand[numCand++] = mvs[idx - 1];
+            if (by > firstRow)
+                cand[numCand++] = mvs[idx - job.blocksW];
+
+            mfxI16Pair best = {};
+            mfxU32 bestSad = 0, bestCost = 0xffffffff;
+
+            for (mfxU32 i = 0; i < numCand; i++)
+            {
+                mfxI16Pair mv;
+                mv.x = (mfxI16)(4 * Clip3(minX, maxX, (cand[i].x + 2) >> 2));
+                mv.y = (mfxI16)(4 * Clip3(minY, maxY, (cand[i].y + 2) >> 2));
+
+                const mfxU32 sad = kernels.SAD8x8(src, pitch, ref.data.Y + (pos.y + mv.y / 4) * refPitch + pos.x + mv.x / 4, refPitch);
+                if (MvCost(sad, mv) < bestCost)
+                {
+                    best = mv;
+                    bestSad = sad;
+                    bestCost = MvCost(sad, mv);
+                }
+            }
+
+            static const mfxI32 dirs[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+            for (mfxI32 step = 8; step > 0; )
+            {
+                bool moved = false;
+
+                for (mfxU32 d = 0; d < 4; d++)
+                {
+                    const mfxI32 dx = best.x / 4 + dirs[d][0] * step;
+                    const mfxI32 dy = best.y / 4 + dirs[d][1] * step;
+                    if (dx < minX || dx > maxX || dy < minY || dy > maxY)
+                        continue;
+
+                    mfxI16Pair mv;
+                    mv.x = (mfxI16)(4 * dx);
+                    mv.y = (mfxI16)(4 * dy);
+
+                    const mfxU32 sad = kernels.SAD8x8(src, pitch, ref.data.Y + (pos.y + dy) * refPitch + pos.x + dx, refPitch);
+                    if (MvCost(sad, mv) < bestCost)
+                    {
+                        best = mv;
+                        bestSad = sad;
+                        bestCost = MvCost(sad, mv);
+                        moved = true;
+                    }
+                }
+
+                if (!moved)
+                    step >>= 1;
+            }
+
+            if (job.subPel)
+            {
+                for (mfxI32 d = 2; d > 0; d >>= 1)
+                {
+                    const mfxI16Pair center = best;
+
+                    for (mfxI32 dy = -d; dy <= d; dy += d)
+                    {
+                        for (mfxI32 dx = -d; dx <= d; dx += d)
+                        {
+                            mfxI16Pair mv;
+                            mv.x = (mfxI16)(center.x + dx);
+                            mv.y = (mfxI16)(center.y + dy);
+
+                            const mfxI16Pair clamped = ClampMv(ref, pos.x, pos.y, mv);
+                            if ((!dx && !dy) || clamped.x != mv.x || clamped.y != mv.y)
+                                continue;
+
+                            PredictBlock(kernels, ref, pos.x, pos.y, mv, pred);
+                            const mfxU32 sad = kernels.SAD8x8(src, pitch, pred, CpuMctf::BLOCK_SIZE);
+                            if (MvCost(sad, mv) < bestCost)
+                            {
+                                best = mv;
+                                bestSad = sad;
+                                bestCost = MvCost(sad, mv);
+                            }
+                        }
+                    }
+                }
+            }
+
+            mvs[idx]  = best;
+            sads[idx] = bestSad;
+        }
+    }
+}
+
+// MC_VAR_SC_CALC of genx_mc.cpp for the 16x16 blocks of the rows
+static void AnalyzeSpatialNoise(CpuMctf::Job & job, mfxU32 firstRow, mfxU32 lastRow)
+{
+    CpuMctf::Frame const & cur = *job.cur;
+    const mfxU32 width16 = DIVUP(cur.crop[2], 16);
+
+    mfxU8 win[17 * 17];
+
+    for (mfxU32 by = firstRow; by < lastRow; by++)
+    {
+        for (mfxU32 bx = 0; bx < width16; bx++)
+        {
+            const BlockPos pos = GetBlockPos(cur, bx, by, 16);
+            LoadLuma(cur, pos.x - 1, pos.y - 1, 17, 17, win);
+
+            mfxF32 rsFull = 0.0f, csFull = 0.0f;
+            mfxU32 sum = 0, square = 0;
+
+            for (mfxU32 i = 0; i < 4; i++)
+            {
+                for (mfxU32 j = 0; j < 4; j++)
+                {
+                    mfxU32 rs = 0, cs = 0;
+
+                    for (mfxU32 r = 4 * i; r < 4 * i + 4; r++)
+                    {
+                        for (mfxU32 c = 4 * j; c < 4 * j + 4; c++)
+                        {
+                            const mfxI32 pix = win[(r + 1) * 17 + c + 1];
+                            const mfxI32 dr  = win[r * 17 + c + 1] - pix;
+                            const mfxI32 dc  = win[(r + 1) * 17 + c] - pix;
+                            rs += dr * dr;
+                            cs += dc * dc;
+                            sum += pix;
+                            square += pix * pix;
+                        }
+                    }
+
+                    rsFull += (mfxF32)std::min<mfxU32>(rs >> 4, 0xffff);
+                    csFull += (mfxF32)std::min<mfxU32>(cs >> 4, 0xffff);
+                }
+            }
+
+            const mfxF32 average = sum / 256.0f;
+
+            spatialNoiseAnalysis & noise = job.noise[by * width16 + bx];
+            noise.var  = square / 256.0f - average * average;
+            noise.SCpp = (rsFull + csFull) / 16.0f;
+        }
+    }
+}
+
+// CMC::noise_estimator with the distortions of ME to the reference
+static mfxU16 EstimateFilterStrength(CpuMctf::Job const & job, mfxU32 refIdx)
+{
+    const mfxU32 width16  = DIVUP(job.cur->crop[2], 16);
+    const mfxU32 height16 = DIVUP(job.cur->crop[3], 16);
+
+    if (width16 < 3 || height16 < 3)
+        return CMC::DEFAULT_FILTER_STRENGTH;
+
+    std::vector<mfxU32> const & sad = job.sad[refIdx];
+    mfxF64 frame_sc = 0.0, frame_sad = 0.0, noise_sc = 0.0, noise_sad = 0.0;
+    mfxU32 count = 0;
+
+    for (mfxU32 row = 1; row < height16 - 1; row++)
+    {
+        const mfxU32 y0 = std::min(2 * row, job.blocksH - 1) * job.blocksW;
+        const mfxU32 y1 = std::min(2 * row + 1, job.blocksH - 1) * job.blocksW;
+
+        for (mfxU32 col = 1; col < width16 - 1; col++)
+        {
+            const mfxU32 x0 = std::min(2 * col, job.blocksW - 1);
+            const mfxU32 x1 = std::min(2 * col + 1, job.blocksW - 1);
+
+            const mfxF32 var  = job.noise[row * width16 + col].var;
+            const mfxF32 SCpp = job.noise[row * width16 + col].SCpp;
+            // division by 256 is done in integers as by CMC
+            const mfxF32 SADpp = (mfxF32)((sad[y0 + x0] + sad[y0 + x1] + sad[y1 + x0] + sad[y1 + x1]) / 256);
+
+            frame_sc  += SCpp;
+            frame_sad += SADpp;
+
+            if (var < NOISE_TH && SCpp < NOISE_TH && SCpp > 1.0 && (SADpp * SADpp) <= SCpp)
+            {
+                count++;
+                noise_sc  += SCpp;
+                noise_sad += SADpp;
+            }
+        }
+    }
+
+    frame_sc  /= ((height16 - 2) * (width16 - 2));
+    frame_sad /= ((height16 - 2) * (width16 - 2));
+    if (count)
+    {
+        noise_sc  /= count;
+        noise_sad /= count;
+    }
+
+    mfxU16 strength = CalcNoiseStrength(noise_sc, noise_sad);
+
+    if (job.bitrateAdaptation)
+    {
+        const mfxU8  sc  = CalcSpatialClass(frame_sc);
+        const mfxU8  stc = CalcSTC(frame_sc, frame_sad);
+        const mfxU32 QLC = CalcQpClass(sc, frame_sad, job.bpp);
+
+        mfxI32 fsModVal;
+        if (QLC == 0)
+            fsModVal = stc > 0.35 ? -2 : -1;
+        else if (QLC == 1)
+            fsModVal = 0;
+        else if (QLC == 2)
+            fsModVal = 1;
+        else
+            fsModVal = 2;
+
+        const mfxI32 limit = strength > 14 ? 13 : 20;
+        strength = (mfxU16)Clip3(0, limit, strength + fsModVal);
+    }
+
+    return strength;
+}
+
+// Prediction of the block by the reference, with overlap it is the average of the predictions
+// by vectors of the block and of the neighbours; 'size' is the motion measure of SimIdx_8x8p
+static void PredictByRef(CpuMctf::Job const & job, mfxU32 refIdx, mfxU32 bx, mfxU32 by, BlockPos const & pos, mfxU8 * pred, mfxI32 & size)
+{
+    CpuMctf::Kernels const & kernels = CpuMctf::GetKernels();
+    CpuMctf::Frame const & ref = *job.refs[refIdx];
+    const mfxI16Pair * mvs = job.mv[refIdx].data();
+    const mfxU32 idx = by * job.blocksW + bx;
+
+    // vectors of 2x2 blocks as MV_Neighborhood_read
+    size = 0;
+    for (mfxU32 dy = 0; dy < 2; dy++)
+    {
+        for (mfxU32 dx = 0; dx < 2; dx++)
+        {
+            const mfxI16Pair mv = mvs[std::min(by + dy, job.blocksH - 1) * job.blocksW + std::min(bx + dx, job.blocksW - 1)];
+            size += (mv.x * mv.x) / 16 + (mv.y * mv.y) / 16;
+        }
+    }
+
+    PredictBlock(kernels, ref, pos.x, pos.y, mvs[idx], pred);
+    if (!job.overlap)
+        return;
+
+    mfxU16 sum[CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+    mfxU8 tmp[CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+    mfxU32 num = 1;
+
+    for (mfxU32 i = 0; i < CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE; i++)
+        sum[i] = pred[i];
+
+    const mfxI32 neighbours[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    for (mfxU32 n = 0; n < 4; n++)
+    {
+        const mfxI32 nx = (mfxI32)bx + neighbours[n][0];
+        const mfxI32 ny = (mfxI32)by + neighbours[n][1];
+        if (nx < 0 || ny < 0 || nx >= (mfxI32)job.blocksW || ny >= (mfxI32)job.blocksH)
+            continue;
+
+        PredictBlock(kernels, ref, pos.x, pos.y, ClampMv(ref, pos.x, pos.y, mvs[ny * job.blocksW + nx]), tmp);
+        for (mfxU32 i = 0; i < CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE; i++)
+            sum[i] = (mfxU16)(sum[i] + tmp[i]);
+        num++;
+    }
+
+    for (mfxU32 i = 0; i < CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE; i++)
+        pred[i] = (mfxU8)((sum[i] + num / 2) / num);
+}
+
+// Merge of the source block with a pair of references as McP16_4MV_2SURF_WITH_CHR,
+// with one reference it is McP16_4MV_1SURF_WITH_CHR; 'win' is 12x12 window of the block at (2, 2)
+static void MergePair(const mfxU8 * win, const mfxF32 * rscs, mfxI32 th,
+                      const mfxU8 * pred1, mfxI32 size1, bool use1,
+                      const mfxU8 * pred2, mfxI32 size2, bool use2, mfxU8 * dst)
+{
+    CpuMctf::Kernels const & kernels = CpuMctf::GetKernels();
+    const mfxU8 * src = win + 2 * 12 + 2;
+
+    const mfxI32 dif1 = use1, dif2 = use2;
+    const mfxI32 dift = !dif1 + !dif2;
+    mfxI32 size = size1 * dif1 + size2 * dif2;
+    if (dif1 + dif2)
+        size /= (dif1 + dif2);
+
+    const mfxU8 * preds[2];
+    mfxI32 sizes[2], sim[2], weights[2];
+    mfxU32 num = 0;
+    mfxU8 median[CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+
+    if (size >= DISTANCE_TH || dift)
+    {
+        if (use1)
+        {
+            preds[num] = pred1;
+            sizes[num++] = size1;
+        }
+        if (use2)
+        {
+            preds[num] = pred2;
+            sizes[num++] = size2;
+        }
+    }
+    else
+    {
+        for (mfxU32 y = 0; y < CpuMctf::BLOCK_SIZE; y++)
+        {
+            for (mfxU32 x = 0; x < CpuMctf::BLOCK_SIZE; x++)
+            {
+                const mfxU32 i = y * CpuMctf::BLOCK_SIZE + x;
+                const mfxU8 s = src[y * 12 + x];
+                median[i] = std::min(std::max(std::min(pred1[i], pred2[i]), s), std::max(pred1[i], pred2[i]));
+            }
+        }
+
+        preds[num] = median;
+        sizes[num++] = size;
+    }
+
+    mfxI32 norm = MERGE_LIMIT + 1;
+    for (mfxU32 k = 0; k < num; k++)
+    {
+        mfxF32 rscsRef[2];
+        CalcRsCs(preds[k], CpuMctf::BLOCK_SIZE, rscsRef);
+
+        const mfxU32 sad = kernels.SAD8x8(src, 12, preds[k], CpuMctf::BLOCK_SIZE);
+        sim[k] = CalcSimilarity(sad, th, sizes[k], rscs[0] - rscsRef[0], rscs[1] - rscsRef[1]);
+        norm += sim[k];
+    }
+
+    mfxI32 srcWeight = MERGE_LIMIT;
+    for (mfxU32 k = 0; k < num; k++)
+    {
+        weights[k] = sim[k] * MERGE_LIMIT / norm;
+        srcWeight -= weights[k];
+    }
+
+    kernels.MergeBlock8x8(src, 12, preds, weights, num, srcWeight, dst);
+}
+
+// Temporal filtering of the block, chroma is denoised with the dispersion of merged luma
+static void FilterBlock(CpuMctf::Job const & job, mfxU32 bx, mfxU32 by, BlockPos const & pos, mfxU8 * luma, mfxU8 * chroma)
+{
+    CpuMctf::Frame const & cur = *job.cur;
+    const mfxI32 th  = job.strength * 50;
+    const mfxI32 sTh = std::min(job.strength + CHROMABASE, MAXCHROMA);
+
+    mfxU8 win[12 * 12];
+    LoadLuma(cur, pos.x - 2, pos.y - 2, 12, 12, win);
+
+    if (th <= 0)
+    {
+        for (mfxU32 y = 0; y < CpuMctf::BLOCK_SIZE; y++)
+            memcpy(luma + y * CpuMctf::BLOCK_SIZE, win + (2 + y) * 12 + 2, CpuMctf::BLOCK_SIZE);
+        LoadChroma(cur, pos.x, pos.y / 2, CpuMctf::BLOCK_SIZE, CpuMctf::BLOCK_SIZE / 2, chroma);
+        return;
+    }
+
+    mfxF32 rscs[2];
+    CalcRsCs(win + 2 * 12 + 2, 12, rscs);
+
+    mfxU8 pred[CpuMctf::MAX_REFS][CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+    mfxI32 size[CpuMctf::MAX_REFS] = {};
+    for (mfxU32 i = 0; i < CpuMctf::MAX_REFS; i++)
+        if (job.useRef[i])
+            PredictByRef(job, i, bx, by, pos, pred[i], size[i]);
+
+    // pairs of the closest and of the second references are merged separately
+    // and averaged as by MC_MERGE4
+    MergePair(win, rscs, th, pred[0], size[0], job.useRef[0], pred[1], size[1], job.useRef[1], luma);
+
+    if (job.numReferences == FOUR_REFERENCES)
+    {
+        mfxU8 second[CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE];
+        MergePair(win, rscs, th, pred[2], size[2], job.useRef[2], pred[3], size[3], job.useRef[3], second);
+
+        for (mfxU32 i = 0; i < CpuMctf::BLOCK_SIZE * CpuMctf::BLOCK_SIZE; i++)
+            luma[i] = (mfxU8)((luma[i] + second[i] + 1) >> 1);
+    }
+
+    // SpatialDenoiser_8x8_NV12_Chroma
+    for (mfxU32 y = 0; y < CpuMctf::BLOCK_SIZE; y++)
+        memcpy(win + (2 + y) * 12 + 2, luma + y * CpuMctf::BLOCK_SIZE, CpuMctf::BLOCK_SIZE);
+
+    mfxU8 scm[6 * 12];
+    mfxF32 k0[16], k1[16], k2[16];
+    LoadChroma(cur, pos.x - 2, pos.y / 2 - 1, 12, 6, scm);
+    CalcDenoiseCoefs(win, sTh / 10.0f, k0, k1, k2);
+    DenoiseChroma(scm, k0, k1, k2, chroma);
+}
+
+// CMC::MCTF_CheckRTParams
+static bool IsRTParamsValid(IntMctfParams const & control)
+{
+#ifdef MFX_ENABLE_MCTF_EXT
+    // check BPP for max value. the threshold must be adjusted for higher bit-depths
+    if (control.BitsPerPixelx100k > CMC::DEFAULT_BPP)
+        return false;
+#endif
+    return control.FilterStrength > 0 && control.FilterStrength <= 20;
+}
+
+CpuMctf::CpuMctf()
+    : m_numReferences(NO_REFERENCES)
+    , m_numPast(0)
+    , m_delay(0)
+    , m_InitRTParams()
+    , m_bAutoMode(false)
+    , m_bitrateAdaptation(false)
+    , m_width(0)
+    , m_height(0)
+    , m_first(0)
+    , m_numPut(0)
+    , m_numOut(0)
+{
+}
+
+mfxStatus CpuMctf::MCTF_INIT(
+    const mfxFrameInfo  & FrameInfo,
+    const IntMctfParams * pMctfParam
+)
+{
+    IntMctfParams MctfParam{};
+    CMC::QueryDefaultParams(&MctfParam);
+
+    // if no MctfParams are passed, to use default
+    if (!pMctfParam)
+        pMctfParam = &MctfParam;
+
+    IntMctfParams localMctfParam = *pMctfParam;
+
+    MFX_CHECK(FrameInfo.FourCC == MFX_FOURCC_NV12, MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(FrameInfo.CropW >= 16 && FrameInfo.CropH >= 16, MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(!(FrameInfo.CropX & 1) && !(FrameInfo.CropY & 1) && !(FrameInfo.CropW & 1) && !(FrameInfo.CropH & 1), MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(FrameInfo.CropX + FrameInfo.CropW <= FrameInfo.Width && FrameInfo.CropY + FrameInfo.CropH <= FrameInfo.Height, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    if (MFX_CODINGOPTION_ON != localMctfParam.Deblocking &&
+        MFX_CODINGOPTION_OFF != localMctfParam.Deblocking &&
+        MFX_CODINGOPTION_UNKNOWN != localMctfParam.Deblocking)
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    if (MFX_CODINGOPTION_ON != localMctfParam.Overlap &&
+        MFX_CODINGOPTION_OFF != localMctfParam.Overlap &&
+        MFX_CODINGOPTION_UNKNOWN != localMctfParam.Overlap)
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    if (MCTF_TEMPORAL_MODE_SPATIAL == localMctfParam.TemporalMode)
+    {
+        localMctfParam.Overlap = MFX_CODINGOPTION_OFF;
+        localMctfParam.Deblocking = MFX_CODINGOPTION_OFF;
+        localMctfParam.subPelPrecision = MFX_MVPRECISION_INTEGER >> 1;
+    }
+
+    // values of SetupMeControl and of mfxExtVppMctf::MVPrecision are accepted
+    if (MFX_MVPRECISION_INTEGER >> 1 != localMctfParam.subPelPrecision &&
+        MFX_MVPRECISION_INTEGER != localMctfParam.subPelPrecision &&
+        MFX_MVPRECISION_QUARTERPEL >> 1 != localMctfParam.subPelPrecision &&
+        MFX_MVPRECISION_QUARTERPEL != localMctfParam.subPelPrecision)
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    MFX_CHECK(localMctfParam.FilterStrength <= 20, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    switch (localMctfParam.TemporalMode)
+    {
+    case MCTF_TEMPORAL_MODE_4REF:
+        m_numReferences = FOUR_REFERENCES;
+        m_numPast = 2;
+        m_delay = 2;
+        break;
+    case MCTF_TEMPORAL_MODE_2REF:
+        m_numReferences = TWO_REFERENCES;
+        m_numPast = 1;
+        m_delay = 1;
+        break;
+    case MCTF_TEMPORAL_MODE_1REF:
+        m_numReferences = ONE_REFERENCE;
+        m_numPast = 1;
+        m_delay = 0;
+        break;
+    case MCTF_TEMPORAL_MODE_SPATIAL:
+        m_numReferences = NO_REFERENCES;
+        m_numPast = 0;
+        m_delay = 0;
+        break;
+    default:
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+    }
+
+    m_bitrateAdaptation = localMctfParam.BitsPerPixelx100k != 0;
+    m_bAutoMode = m_bitrateAdaptation || !localMctfParam.FilterStrength;
+    m_InitRTParams = localMctfParam;
+    m_width = FrameInfo.Width;
+    m_height = FrameInfo.Height;
+
+    m_pool.clear();
+    m_queue.clear();
+    m_first = 0;
+    m_numPut = 0;
+    m_numOut = 0;
+
+    return MFX_ERR_NONE;
+}
+
+void CpuMctf::MCTF_CLOSE()
+{
+    m_queue.clear();
+    m_pool.clear();
+    m_first = 0;
+    m_numPut = 0;
+    m_numOut = 0;
+}
+
+std::shared_ptr<CpuMctf::Frame> CpuMctf::MCTF_GetEmptySurface()
+{
+    for (size_t i = 0; i < m_pool.size(); i++)
+        if (m_pool[i].use_count() == 1)
+            return m_pool[i];
+
+    const mfxU32 pitch = (m_width + FRAME_ALIGNMENT - 1) & ~(FRAME_ALIGNMENT - 1);
+    const mfxU32 height = (m_height + 1) & ~1;
+
+    std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+    frame->buffer.resize(pitch * height * 3 / 2);
+
+    memset(&frame->data, 0, sizeof(frame->data));
+    frame->data.Y         = frame->buffer.data();
+    frame->data.UV        = frame->data.Y + pitch * height;
+    frame->data.PitchLow  = (mfxU16)(pitch & 0xffff);
+    frame->data.PitchHigh = (mfxU16)(pitch >> 16);
+    memset(frame->crop, 0, sizeof(frame->crop));
+    frame->timeStamp  = 0;
+    frame->frameOrder = 0;
+    frame->control    = m_InitRTParams;
+
+    m_pool.push_back(frame);
+    return frame;
+}
+
+mfxStatus CpuMctf::MCTF_PUT_FRAME(
+    IntMctfParams                * pMctfControl,
+    std::shared_ptr<Frame> const & frame,
+    const mfxFrameInfo           & info,
+    mfxU64                         timeStamp,
+    mfxU32                         frameOrder
+)
+{
+    MFX_CHECK(frame, MFX_ERR_NULL_PTR);
+    MFX_CHECK(info.CropW >= 16 && info.CropH >= 16, MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(!(info.CropX & 1) && !(info.CropY & 1) && !(info.CropW & 1) && !(info.CropH & 1), MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(info.CropX + info.CropW <= m_width && info.CropY + info.CropH <= m_height, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    frame->crop[0]    = info.CropX;
+    frame->crop[1]    = info.CropY;
+    frame->crop[2]    = info.CropW;
+    frame->crop[3]    = info.CropH;
+    frame->timeStamp  = timeStamp;
+    frame->frameOrder = frameOrder;
+
+    // run-time parameters as CMC::MCTF_UpdateRTParams
+    if (pMctfControl && IsRTParamsValid(*pMctfControl))
+        frame->control = *pMctfControl;
+    else
+        frame->control = m_InitRTParams;
+
+    m_queue.push_back(frame);
+    m_numPut++;
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CpuMctf::MCTF_GET_FRAME(
+    std::shared_ptr<Job> & job,
+    bool                   endOfStream
+)
+{
+    job.reset();
+
+    if (m_numOut >= m_numPut || (!endOfStream && m_numPut <= m_numOut + m_delay))
+        return MFX_ERR_MORE_DATA;
+
+    std::shared_ptr<Job> task = std::make_shared<Job>();
+    Frame const & cur = *m_queue[m_numOut - m_first];
+    task->cur = m_queue[m_numOut - m_first];
+
+    static const mfxI32 offsets[MAX_REFS] = { -1, 1, -2, 2 };
+    for (mfxU32 i = 0; i < MAX_REFS; i++)
+    {
+        const mfxI32 offset = offsets[i];
+        const mfxI64 idx = (mfxI64)m_numOut + offset;
+        const bool inMode = offset < 0 ? (mfxU32)-offset <= m_numPast : (mfxU32)offset <= m_delay;
+
+        task->useRef[i] = false;
+        if (!inMode || idx < m_first || idx >= m_numPut)
+            continue;
+
+        std::shared_ptr<Frame> const & ref = m_queue[(size_t)(idx - m_first)];
+        if (memcmp(ref->crop, cur.crop, sizeof(cur.crop)))
+            continue;
+
+        task->refs[i] = ref;
+        task->useRef[i] = true;
+    }
+
+    IntMctfParams const & control = cur.control;
+
+    task->numReferences     = m_numReferences;
+    task->overlap           = MFX_CODINGOPTION_ON == m_InitRTParams.Overlap;
+    task->subPel            = MFX_MVPRECISION_QUARTERPEL == m_InitRTParams.subPelPrecision ||
+                              MFX_MVPRECISION_QUARTERPEL >> 1 == m_InitRTParams.subPelPrecision;
+    // deblocking only if ME is used
+    task->deblocking        = MFX_CODINGOPTION_ON == control.Deblocking && NO_REFERENCES != m_numReferences;
+    task->autoStrength      = m_bAutoMode;
+    task->bitrateAdaptation = m_bitrateAdaptation;
+    task->bpp               = control.BitsPerPixelx100k * 1.0 / MCTF_BITRATE_MULTIPLIER;
+    task->strength          = m_bAutoMode ? CMC::DEFAULT_FILTER_STRENGTH : control.FilterStrength;
+    task->blocksW           = DIVUP(cur.crop[2], BLOCK_SIZE);
+    task->blocksH           = DIVUP(cur.crop[3], BLOCK_SIZE);
+
+    for (mfxU32 i = 0; i < MAX_REFS; i++)
+    {
+        if (!task->refs[i])
+            continue;
+        task->mv[i].resize(task->blocksW * task->blocksH);
+        task->sad[i].resize(task->blocksW * task->blocksH);
+    }
+
+    if (task->autoStrength)
+        task->noise.resize(DIVUP(cur.crop[2], 16) * DIVUP(cur.crop[3], 16));
+
+    if (task->deblocking)
+    {
+        task->merged = MCTF_GetEmptySurface();
+        memcpy(task->merged->crop, cur.crop, sizeof(cur.crop));
+        task->merged->timeStamp  = cur.timeStamp;
+        task->merged->frameOrder = cur.frameOrder;
+    }
+
+    m_numOut++;
+
+    // frames before the past references of the next output aren't needed
+    while (!m_queue.empty() && m_first + m_numPast < m_numOut)
+    {
+        m_queue.pop_front();
+        m_first++;
+    }
+
+    job = task;
+    return MFX_ERR_NONE;
+}
+
+mfxU32 CpuMctf::GetNumRegions(Job const & job, mfxU32 stage)
+{
+    const mfxU32 rows = DIVUP(job.blocksH, REGION_BLOCK_ROWS);
+
+    switch (stage)
+    {
+    case STAGE_ME:
+        for (mfxU32 i = 0; i < MAX_REFS; i++)
+            if (job.refs[i])
+                return rows;
+        return 0;
+    case STAGE_ANALYSIS:
+        return 1;
+    case STAGE_MERGE:
+        return rows;
+    case STAGE_DENOISE:
+        return job.deblocking ? rows : 0;
+    default:
+        return 0;
+    }
+}
+
+void CpuMctf::Run(Job & job, mfxU32 stage, mfxU32 region, mfxFrameData & out)
+{
+    const mfxU32 firstRow = region * REGION_BLOCK_ROWS;
+    const mfxU32 lastRow  = std::min(firstRow + REGION_BLOCK_ROWS, job.blocksH);
+    const mfxF32 sTh      = (mfxF32)std::min(job.strength + CHROMABASE, MAXCHROMA);
+
+    mfxU8 luma[BLOCK_SIZE * BLOCK_SIZE];
+    mfxU8 chroma[BLOCK_SIZE * BLOCK_SIZE / 2];
+
+    switch (stage)
+    {
+    case STAGE_ME:
+        for (mfxU32 i = 0; i < MAX_REFS; i++)
+            if (job.refs[i])
+                EstimateMotion(job, i, firstRow, lastRow);
+
+        if (job.autoStrength)
+            AnalyzeSpatialNoise(job, firstRow / 2, DIVUP(lastRow, 2));
+        break;
+
+    case STAGE_ANALYSIS:
+    {
+        // references of another scene are not used
+        for (mfxU32 i = 0; i < MAX_REFS; i++)
+        {
+            if (!job.refs[i])
+                continue;
+
+            mfxU64 sad = 0;
+            for (size_t k = 0; k < job.sad[i].size(); k++)
+                sad += job.sad[i][k];
+
+            job.useRef[i] = sad <= (mfxU64)SCENE_CHANGE_SAD * BLOCK_SIZE * BLOCK_SIZE * job.blocksW * job.blocksH;
+        }
+
+        if (job.autoStrength)
+        {
+            job.strength = CMC::DEFAULT_FILTER_STRENGTH;
+            for (mfxU32 i = 0; i < MAX_REFS; i++)
+            {
+                if (job.useRef[i])
+                {
+                    job.strength = EstimateFilterStrength(job, i);
+                    break;
+                }
+            }
+        }
+        break;
+    }
+
+    case STAGE_MERGE:
+    {
+        mfxFrameData & dst = job.deblocking ? job.merged->data : out;
+
+        for (mfxU32 by = firstRow; by < lastRow; by++)
+        {
+            for (mfxU32 bx = 0; bx < job.blocksW; bx++)
+            {
+                const BlockPos pos = GetBlockPos(*job.cur, bx, by, BLOCK_SIZE);
+
+                if (NO_REFERENCES == job.numReferences)
+                    SpatialDenoiseBlock(*job.cur, pos, sTh, luma, chroma);
+                else
+                    FilterBlock(job, bx, by, pos, luma, chroma);
+
+                StoreBlock(dst, pos, luma, chroma);
+            }
+        }
+        break;
+    }
+
+    case STAGE_DENOISE:
+        for (mfxU32 by = firstRow; by < lastRow; by++)
+        {
+            for (mfxU32 bx = 0; bx < job.blocksW; bx++)
+            {
+                const BlockPos pos = GetBlockPos(*job.merged, bx, by, BLOCK_SIZE);
+                SpatialDenoiseBlock(*job.merged, pos, sTh, luma, chroma);
+                StoreBlock(out, pos, luma, chroma);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This file is compiled with -mavx2, functions are selected at run time by mctf_cpu.cpp
+
+#include "mctf_cpu.h"
+
+#include <immintrin.h>
+
+// two rows of 8 samples as 16 words
+static inline __m256i LoadRows(const mfxU8 * p, mfxI32 pitch)
+{
+    const __m128i r = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p), _mm_loadl_epi64((const __m128i *)(p + pitch)));
+    return _mm256_cvtepu8_epi16(r);
+}
+
+// four rows of 8 samples, a row per 64-bit lane
+static inline __m256i Load4Rows(const mfxU8 * p, mfxI32 pitch)
+{
+    const __m128i r01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p), _mm_loadl_epi64((const __m128i *)(p + pitch)));
+    const __m128i r23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(p + 2 * pitch)), _mm_loadl_epi64((const __m128i *)(p + 3 * pitch)));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(r01), r23, 1);
+}
+
+// 16 words of two rows are written as 8 bytes per row with pitch 8
+static inline void StoreRows(__m256i v, mfxU8 * dst)
+{
+    const __m256i b = _mm256_packus_epi16(v, v);
+    _mm_storel_epi64((__m128i *)dst, _mm256_castsi256_si128(b));
+    _mm_storel_epi64((__m128i *)(dst + CpuMctf::BLOCK_SIZE), _mm256_extracti128_si256(b, 1));
+}
+
+mfxU32 CpuMctf::SAD8x8_AVX2(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * ref, mfxI32 refPitch)
+{
+    __m256i sad = _mm256_sad_epu8(Load4Rows(src, srcPitch), Load4Rows(ref, refPitch));
+    sad = _mm256_add_epi64(sad, _mm256_sad_epu8(Load4Rows(src + 4 * srcPitch, srcPitch), Load4Rows(ref + 4 * refPitch, refPitch)));
+
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sad), _mm256_extracti128_si256(sad, 1));
+    const mfxU32 res = (mfxU32)(_mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 2));
+
+    _mm256_zeroupper();
+    return res;
+}
+
+// two rows per iteration, products of the 4 samples fit in words
+void CpuMctf::InterpolateBlock8x8_AVX2(const mfxU8 * ref, mfxI32 pitch, mfxU32 fx, mfxU32 fy, mfxU8 * dst)
+{
+    if (!fx && !fy)
+    {
+        for (mfxU32 y = 0; y < BLOCK_SIZE; y += 2, ref += 2 * pitch, dst += 2 * BLOCK_SIZE)
+        {
+            _mm_storel_epi64((__m128i *)dst, _mm_loadl_epi64((const __m128i *)ref));
+            _mm_storel_epi64((__m128i *)(dst + BLOCK_SIZE), _mm_loadl_epi64((const __m128i *)(ref + pitch)));
+        }
+        return;
+    }
+
+    const __m256i w00 = _mm256_set1_epi16((mfxI16)((4 - fx) * (4 - fy)));
+    const __m256i w01 = _mm256_set1_epi16((mfxI16)(fx * (4 - fy)));
+    const __m256i w10 = _mm256_set1_epi16((mfxI16)((4 - fx) * fy));
+    const __m256i w11 = _mm256_set1_epi16((mfxI16)(fx * fy));
+    const __m256i rnd = _mm256_set1_epi16(8);
+
+    for (mfxU32 y = 0; y < BLOCK_SIZE; y += 2, ref += 2 * pitch, dst += 2 * BLOCK_SIZE)
+    {
+        __m256i acc = _mm256_add_epi16(rnd, _mm256_mullo_epi16(LoadRows(ref, pitch), w00));
+        acc = _mm256_add_epi16(acc, _mm256_mullo_epi16(LoadRows(ref + 1, pitch), w01));
+        acc = _mm256_add_epi16(acc, _mm256_mullo_epi16(LoadRows(ref + pitch, pitch), w10));
+        acc = _mm256_add_epi16(acc, _mm256_mullo_epi16(LoadRows(ref + pitch + 1, pitch), w11));
+
+        StoreRows(_mm256_srli_epi16(acc, 4), dst);
+    }
+
+    _mm256_zeroupper();
+}
+
+// two rows per iteration, source and predictions are taken by pairs to use madd
+void CpuMctf::MergeBlock8x8_AVX2(const mfxU8 * src, mfxI32 srcPitch, const mfxU8 * const * pred, const mfxI32 * weight,
+                                 mfxU32 num, mfxI32 srcWeight, mfxU8 * dst)
+{
+    const __m256i rnd = _mm256_set1_epi32(128);
+
+    for (mfxU32 y = 0; y < BLOCK_SIZE; y += 2, src += 2 * srcPitch)
+    {
+        const mfxU32 offset = y * BLOCK_SIZE;
+
+        __m256i lo = rnd;
+        __m256i hi = rnd;
+
+        // term 0 is the source, term k + 1 is prediction k
+        for (mfxU32 k = 0; k <= num; k += 2)
+        {
+            const __m256i a  = k == 0 ? LoadRows(src, srcPitch) : LoadRows(pred[k - 1] + offset, BLOCK_SIZE);
+            const mfxI32  wa = k == 0 ? srcWeight : weight[k - 1];
+            const __m256i b  = k < num ? LoadRows(pred[k] + offset, BLOCK_SIZE) : _mm256_setzero_si256();
+            const mfxI32  wb = k < num ? weight[k] : 0;
+
+            const __m256i w = _mm256_set1_epi32((wb << 16) | (wa & 0xffff));
+
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+        }
+
+        StoreRows(_mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8)), dst + offset);
+    }
+
+    _mm256_zeroupper();
+}
@@ -36,6 +36,11 @@
 #include <umc_event.h>
 
 #include <vector>
+#include <array>
+#include <atomic>
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 #include "mfx_common.h"
 
@@ -52,11 +57,24 @@ enum
     MFX_TIME_STAT_PARTS         = 4
 };
 
+enum
+{
+    // every power of 2 of the task latency histogram
+    // is divided into the following number of bins (log2)
+    MFX_LATENCY_STAT_SUBBINS_LOG2   = 2,
+    // number of bins to cover the whole range of mfxU32
+    MFX_LATENCY_STAT_BINS           = (33 - MFX_LATENCY_STAT_SUBBINS_LOG2) << MFX_LATENCY_STAT_SUBBINS_LOG2
+};
+
 enum
 {
     MFX_INVALID_THREAD_ID       = -1
 };
 
+// deadline of the scheduler having no unfinished task with the deadline
+const
+mfxU64 MFX_NO_DEADLINE = (mfxU64) -1;
+
 enum
 {
     MFX_THREAD_TIME_TO_WAIT     = 1000
@@ -81,6 +99,18 @@ struct MFX_DEPENDENCY_ITEM
 
 } MFX_DEPENDENCY_ITEM;
 
+typedef
+struct MFX_TASKS_LATENCY
+{
+    // Number of completed tasks
+    mfxU32 numCompleted;
+    // The longest latency (timer ticks)
+    mfxU32 maxLatency;
+    // Histogram of latencies in timer ticks, the bin width grows with the latency
+    mfxU32 bins[MFX_LATENCY_STAT_BINS];
+
+} MFX_TASKS_LATENCY;
+
 typedef
 struct MFX_THREADS_TIME
 {
@@ -90,6 +120,12 @@ struct MFX_THREADS_TIME
     // Overall working time for every priority
     mfxU64 time[MFX_PRIORITY_NUMBER];
 
+    // Working time of every thread
+    mfxU64 threadTime[MFX_SCHEDULER_MAX_THREADS];
+
+    // Latency of the tasks completed, for every type of tasks
+    MFX_TASKS_LATENCY latency[MFX_TYPE_NUMBER];
+
 } MFX_THREAD_TIME;
 
 typedef
@@ -124,12 +160,18 @@ enum eWakeUpReason
 };
 
 
-class mfxSchedulerCore : public MFXIScheduler2
+class alignas(MFX_SCHEDULER_CACHE_LINE) mfxSchedulerCore : public MFXIScheduler3
 {
 public:
     // Default constructor
     mfxSchedulerCore(void);
 
+    // The object is allocated aligned to the cache line
+    static
+    void *operator new(size_t size);
+    static
+    void operator delete(void *p);
+
     //
     // MFXIScheduler interface
     //
@@ -149,6 +191,16 @@ public:
     virtual
     mfxStatus Synchronize(mfxSyncPoint syncPoint, mfxU32 timeToWait);
 
+    // Add several tasks in one transaction.
+    virtual
+    mfxStatus AddTasks(const MFX_TASK *pTasks, mfxU32 numTasks,
+                       mfxSyncPoint *pSyncPoints, mfxU32 *pNumAdded);
+
+    // Wait until all or any of the tasks is done.
+    virtual
+    mfxStatus SynchronizeMultiple(const mfxSyncPoint *pSyncPoints, mfxU32 numSyncPoints,
+                                  bool waitAll, mfxU32 timeToWait, mfxU32 *pIndex);
+
     // Wait until specified dependency become resolved
     virtual
     mfxStatus WaitForDependencyResolved(const void *pDependency);
@@ -161,6 +213,19 @@ public:
     virtual
     mfxStatus ResetWaitingStatus(const void *pOwner);
 
+    // Make the running task wait for the completion handle
+    virtual
+    mfxStatus RegisterCompletion(const void *pOwner, const void *pParam, int fd);
+
+    // Signal the completion the task waits for
+    virtual
+    mfxStatus SignalCompletion(const void *pOwner, const void *pParam);
+
+    // Make the running task continue at the routine on its next call
+    virtual
+    mfxStatus SetContinuation(const void *pState, const void *pParam,
+                              mfxTaskRoutine pRoutine, int fd);
+
     // Check the current status of the scheduler.
     virtual
     mfxStatus GetState(void);
@@ -177,6 +242,10 @@ public:
     virtual
     mfxStatus AdjustPerformance(const mfxSchedulerMessage message);
 
+    // Get the live statistic of the scheduler
+    virtual
+    mfxStatus GetStat(MFX_SCHEDULER_STAT *pStat);
+
     // Add a new task to the scheduler with extended source info.
     virtual
     mfxStatus AddTask(const MFX_TASK &task, mfxSyncPoint *pSyncPoint,
@@ -213,6 +282,9 @@ public:
     // Notification to the scheduler that task got resolved dependencies
     void OnDependencyResolved(MFX_SCHEDULER_TASK *pTask);
 
+    // Wake up threads waiting for the task to be done
+    void OnTaskDone(MFX_SCHEDULER_TASK *pTask);
+
     // WA for SINGLE THREAD MODE
     virtual
     mfxStatus GetTimeout(mfxU32 & maxTimeToRun);
@@ -248,6 +320,19 @@ protected:
         mfxU32 num_regular_threads = (mfxU32)-1);
     // Allocate the empty task
     mfxStatus AllocateEmptyTask(void);
+    // Allocate the next slab of task objects, put them into the 'free' queue
+    mfxStatus AllocateTaskSlab(void);
+    // Get the type of the task, hardware or software
+    static
+    int GetTaskType(const MFX_SCHEDULER_TASK *pTask);
+    // Get the queue holding the task
+    MFX_SCHEDULER_TASK_QUEUE &GetTaskQueue(MFX_SCHEDULER_TASK *pTask);
+    // Put the task into the queue, count threads to wake up for it
+    mfxStatus EnqueueTask(const MFX_TASK &task, mfxSyncPoint *pSyncPoint,
+                          const char *pFileName, int lineNumber,
+                          mfxU32 &numDedicatedThreads, mfxU32 &numRegularThreads);
+    // Check whether the job of the handle is over, get its status
+    bool IsJobDone(mfxTaskHandle handle, mfxStatus &jobRes);
     // Get the index in the occupancy table. The functions searches through
     // the table and return the index of the element tracking the same pState
     // as the task have.
@@ -265,6 +350,18 @@ protected:
     // Get time statistic for the moment
     void GetTimeStat(mfxU64 timeSpent[MFX_PRIORITY_NUMBER],
                      mfxU64 totalTimeSpent[MFX_PRIORITY_NUMBER]);
+    // Get the current item of the time statistic, advance to the next item
+    // if the current one is out of time.
+    MFX_THREADS_TIME &GetCurrentTimeStat(void);
+    // Account the latency of the task being completed
+    void UpdateLatencyStat(MFX_SCHEDULER_TASK *pTask, mfxU64 timeDone);
+    // Fill the time part of the live statistic: load and latencies
+    void GetTimeStat(MFX_SCHEDULER_STAT &stat);
+
+    // Get the ready task having the earliest deadline, NULL if none is ready
+    MFX_SCHEDULER_TASK *GetEarliestDeadlineTask(const mfxU32 threadNum);
+    // Publish the earliest deadline of unfinished tasks for the shared pool
+    void UpdatePoolDeadline(void);
 
     // Check if the thread can continue the previous task.
     mfxStatus CanContinuePreviousTask(MFX_CALL_INFO &callInfo,
@@ -307,6 +404,9 @@ protected:
     // Sets scheduling for the specified thread
     bool SetScheduling(std::thread& handle);
 
+    // Resolve the requested NUMA node and its CPUs
+    void SelectNumaNode(void);
+
     // Assign socket affinity for every thread
     void SetThreadsAffinityToSockets(void);
 
@@ -322,7 +422,7 @@ protected:
         {
             for (int type = MFX_TYPE_HARDWARE; type <= MFX_TYPE_SOFTWARE; type += 1)
             {
-                task = m_pTasks[priority][type];
+                task = m_taskQueues[priority][type].pHead;
 
                 // run over the tasks with particular priority
                 while (task)
@@ -350,21 +450,19 @@ protected:
     MFX_SCHEDULER_PARAM2 m_param;
     // Reference counters
     mfxU32 m_refCounter;
-    // Current time stamp
-    mfxU64 m_currentTimeStamp;
     // Time wait period for 'waiting' tasks
     const
     mfxU64 m_timeWaitPeriod;
-    // HW 'buffer done' event counter
-    volatile
-    mfxU64 m_hwEventCounter;
     // Frequency for vm_tick to get msec
     vm_tick m_vmtick_msec_frequency;
-
-    // Working time statistic array
-    MFX_THREADS_TIME m_workingTime[MFX_TIME_STAT_PARTS];
-    // Current time statistic index
-    mfxU32 m_timeIdx;
+    // Latency budget of tasks in timer ticks, 0 if tasks have no deadline
+    mfxU64 m_deadlineBudget;
+    // NUMA node the threads are placed on, -1 if they are not placed
+    mfxI32 m_numaNode;
+#if defined(__linux__)
+    // CPUs of the node allowed for the process
+    cpu_set_t m_numaCpus;
+#endif
 
     //
     // THREADING STUFF
@@ -388,6 +486,8 @@ protected:
 
     // Event to wait free task objects
     UMC::Semaphore m_freeTasks;
+    // Batches take their task objects one batch at a time
+    std::mutex m_freeTasksGuard;
     // Some task was done in HW
     vm_event m_hwTaskDone;
     // Handle to the wakeup thread
@@ -397,14 +497,82 @@ protected:
     void ThreadProc(MFX_SCHEDULER_THREAD_CONTEXT *pContext);
     void WakeupThreadProc();
 
+    //
+    // COMPLETION STUFF
+    //
+
+    // Pollable completion handle registered by a task
+    struct MFX_SCHEDULER_COMPLETION
+    {
+        int fd;
+        MFX_SCHEDULER_TASK *pTask;
+    };
+
+    // Look up the unfinished task of specified owner and parameters
+    MFX_SCHEDULER_TASK *FindWorkingTask(const void *pOwner, const void *pParam);
+    // Look up the unfinished task of specified entry point state and parameters
+    MFX_SCHEDULER_TASK *FindWorkingEntryPoint(const void *pState, const void *pParam);
+    // Make the task wait for the completion handle, -1 - for SignalCompletion
+    mfxStatus AddCompletion(MFX_SCHEDULER_TASK *pTask, int fd);
+    // The completion of the task is signaled, make the task ready to run
+    void OnCompletion(MFX_SCHEDULER_TASK *pTask);
+    // Forget the completion registered by the task
+    void RemoveCompletion(MFX_SCHEDULER_TASK *pTask);
+
+    // Start the thread polling completion handles, if it is not started yet
+    mfxStatus StartCompletionThread(void);
+    // Stop and terminate the completion thread
+    void StopCompletionThread(void);
+    void CompletionThreadProc(void);
+
+    // Pollable handles of waiting tasks
+    std::vector<MFX_SCHEDULER_COMPLETION> m_completions;
+    // Number of tasks waiting for a completion
+    mfxU32 m_numWaitingCompletions;
+    // Incremented on every signaled completion
+    mfxU64 m_completionCounter;
+    // Single thread mode sleeps on it while tasks wait for the device
+    std::condition_variable m_completionDone;
+    // Number of threads waiting for several tasks
+    mfxU32 m_numMultipleWaiters;
+    // Signaled on every done task, if there are threads waiting for several tasks
+    std::condition_variable m_taskDone;
+    // eventfd to interrupt the polling of the completion thread
+    int m_completionEvent;
+    bool m_bQuitCompletionThread;
+    std::thread m_completionThread;
+
+    //
+    // SHARED POOL STUFF
+    //
+
+    friend class mfxSchedulerPool;
+
+    // Run one task call by a thread of the shared pool,
+    // returns false if there is no task ready to run.
+    bool RunPoolTask(void);
+
+    // Priority of the last added task, it defines the share of the pool
+    std::atomic<int> m_poolPriority;
+    // Earliest deadline of unfinished tasks, the pool serves the schedulers
+    // with the latency budget by it. Updated in the protected section,
+    // read by the pool without the lock.
+    std::atomic<mfxU64> m_poolDeadline;
+    // A pool thread is running a dedicated task,
+    // other threads may not take the role of thread 0.
+    bool m_bPoolDedicatedBusy;
+
     //
     // TASKING STUFF
     //
 
-    // Guard for task queues
+    // Guard for task queues. The lock and the data it protects start
+    // a cache line, which is not shared with the data accessed without the lock.
+    alignas(MFX_SCHEDULER_CACHE_LINE)
     std::mutex m_guard;
-    // array of task queues
-    MFX_SCHEDULER_TASK *m_pTasks[MFX_PRIORITY_NUMBER][MFX_TYPE_NUMBER];
+    // array of task queues. Done tasks leave the queues at once,
+    // so the threads looking for work walk over live tasks only.
+    MFX_SCHEDULER_TASK_QUEUE m_taskQueues[MFX_PRIORITY_NUMBER][MFX_TYPE_NUMBER];
     // Number of assigned tasks for each kind of tasks
     mfxU32 m_numAssignedTasks[MFX_PRIORITY_NUMBER];
     // Queue of failed tasks
@@ -413,13 +581,27 @@ protected:
     mfxU32 m_DedicatedThreadsToWakeUp;
     // Number of tasks for non-dedicated threads
     mfxU32 m_RegularThreadsToWakeUp;
+    // Current time stamp
+    mfxU64 m_currentTimeStamp;
+    // Working time statistic array
+    MFX_THREADS_TIME m_workingTime[MFX_TIME_STAT_PARTS];
+    // Current time statistic index
+    mfxU32 m_timeIdx;
+    // The latency of tasks is measured. It is turned on by the first GetStat call,
+    // so the schedulers, which are never inspected, don't read the timer for every task.
+    bool m_bLatencyStat;
 
     // these members are used only from the main thread,
     // so synchronization is not necessary to access them.
 
-    // Table to get a task by handle value
-    std::vector<MFX_SCHEDULER_TASK *> m_ppTaskLookUpTable;
-    // Queue of available tasks
+    // Table to get a task by handle value. Entries are set once, when task
+    // objects are allocated, Synchronize reads the table without the lock.
+    alignas(MFX_SCHEDULER_CACHE_LINE)
+    std::array<std::atomic<MFX_SCHEDULER_TASK *>, MFX_MAX_NUMBER_TASK> m_ppTaskLookUpTable;
+    // Slabs of task objects, MFX_TASK_SLAB_SIZE tasks each
+    std::vector<void *> m_taskSlabs;
+    // Queue of available tasks. The last freed task is reused first,
+    // it is likely to be in the cache.
     MFX_SCHEDULER_TASK *m_pFreeTasks;
 
     //
@@ -446,6 +628,12 @@ protected:
 
     mfxU32 m_timer_hw_event;
 
+    // HW 'buffer done' event counter. The wake up thread increments it
+    // without the lock, so it has its own cache line.
+    alignas(MFX_SCHEDULER_CACHE_LINE)
+    volatile
+    mfxU64 m_hwEventCounter;
+
 
 private:
     // declare a assignment operator to avoid warnings
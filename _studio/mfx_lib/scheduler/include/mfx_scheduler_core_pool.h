@@ -0,0 +1,121 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MFX_SCHEDULER_CORE_POOL_H
+#define __MFX_SCHEDULER_CORE_POOL_H
+
+#include <mfxdefs.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// forward declaration of the served class
+class mfxSchedulerCore;
+
+// Process-wide pool of working threads shared by the schedulers initialized
+// with MFX_SCHEDULER_SHARED_POOL. The pool has one thread per logical CPU
+// regardless of the number of sessions, threads are started when the first
+// scheduler registers and stopped when the last one leaves.
+//
+// Schedulers are served in weighted round robin: every scheduler gets credits
+// by the priority of its tasks (MFXSetPriority), a credit is spent per task call,
+// credits are refilled when all schedulers having work have spent them.
+// A scheduler is never entered by more threads than its numberOfThreads.
+//
+// Schedulers having the latency budget are served before the others, the one
+// with the earliest deadline of unfinished tasks goes first. A best effort
+// scheduler is not starved by them: the one which has not been served for
+// MFX_POOL_STARVATION_PERIOD goes first.
+class mfxSchedulerPool
+{
+public:
+    static mfxSchedulerPool & Instance(void);
+
+    // Number of threads the pool runs
+    mfxU32 GetNumThreads(void) const { return m_numThreads; }
+
+    // Start serving the scheduler
+    void Register(mfxSchedulerCore *pCore);
+    // Stop serving the scheduler, returns when no pool thread works for it
+    void Unregister(mfxSchedulerCore *pCore);
+
+    // The scheduler got more work, wake up to 'numThreads' sleeping threads
+    void Notify(mfxU32 numThreads);
+
+protected:
+    struct Client
+    {
+        mfxSchedulerCore *pCore;
+        mfxU32 credit;      // task calls left in the current round
+        mfxU32 active;      // pool threads working for the scheduler
+        mfxU64 idleStamp;   // m_stamp when the scheduler had nothing to run
+        mfxU64 timeServed;  // timer ticks when the scheduler was picked last time
+    };
+
+    mfxSchedulerPool(void);
+    ~mfxSchedulerPool(void);
+
+    // Task calls given to the scheduler per round
+    static mfxU32 GetWeight(const mfxSchedulerCore *pCore);
+
+    void Start(void);
+    void Stop(std::unique_lock<std::mutex>& guard);
+
+    // Pick the next client to serve, NULL if none has work to try.
+    // Must be called in the protected section.
+    Client *Pick(void);
+    // Pick the client by the weight of its priority
+    Client *PickByWeight(void);
+    // Pick the starving best effort client, or the client
+    // with the earliest deadline, NULL if there is no such client.
+    Client *PickByDeadline(const mfxU64 now);
+
+    void ThreadProc(const mfxU32 threadNum);
+
+    mfxU32 m_numThreads;
+
+    // Guard for the clients and the threads
+    std::mutex m_guard;
+    std::condition_variable m_workAdded;
+    std::condition_variable m_clientIdle;
+
+    std::vector<std::thread> m_threads;
+    std::vector<Client *> m_clients;
+    // next client of the round robin
+    size_t m_cursor;
+    // number of clients having the latency budget
+    mfxU32 m_numDeadlineClients;
+    // best effort clients are picked at least once per the period, timer ticks
+    const
+    mfxU64 m_starvationPeriod;
+    // incremented on every notification and every completed call,
+    // a thread sleeps only if nothing has changed since it looked for work
+    mfxU64 m_stamp;
+    mfxU32 m_numWaiting;
+    bool m_bQuit;
+
+private:
+    mfxSchedulerPool(const mfxSchedulerPool &);
+    mfxSchedulerPool & operator = (const mfxSchedulerPool &);
+};
+
+#endif // #ifndef __MFX_SCHEDULER_CORE_POOL_H
@@ -27,11 +27,19 @@
 #include <mfx_task.h>
 #include <mfx_scheduler_core_handle.h>
 
-#include <condition_variable>
+#include <atomic>
 
 // forward declaration of used types
 struct MFX_SCHEDULER_TASK;
 
+enum
+{
+    // data written by different threads is kept in different cache lines
+    MFX_SCHEDULER_CACHE_LINE = 64,
+    // number of task objects allocated at once
+    MFX_TASK_SLAB_SIZE = 64
+};
+
 
 class mfxSchedulerCore;
 struct MFX_THREAD_ASSIGNMENT
@@ -57,7 +65,10 @@ struct MFX_THREAD_ASSIGNMENT
 
 };
 
-struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
+// Task objects are allocated in slabs (see AllocateTaskSlab) and never
+// share a cache line. The fields inspected by threads looking for work go
+// first, right after the dependency links of the base class.
+struct alignas(MFX_SCHEDULER_CACHE_LINE) MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
 {
     // The constructor is disabled for precise resource control.
     // Declare a class what can create instances of tasks.
@@ -76,20 +87,24 @@ struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
     // Release all allocated resources and decrement reference counters
     void ReleaseResources(void);
 
-    // Ordinal task number. It doesn't grow during task lifetime.
-    // This ID is used to access task tracking tables and lists.
-    const
-    mfxU32 taskID;
-    // Job number. It is set to a new value, which is steadly growing, everytime
-    // when task is assigned for a new piece of job. Sometimes jobID is accessed
-    // without synchronization, so it is required not to cache it.
-    volatile
-    mfxU32 jobID;
+    // Copy jobID and opRes into the lock-free job state.
+    // It is called under the scheduler's lock.
+    void PublishJobState(void);
+    // Publish the final state of the job and wake up the threads waiting for it
+    void NotifyJobDone(void);
+    // Check the job without any lock. Returns true if the job is over,
+    // jobRes is set to the job status (MFX_WRN_IN_EXECUTION otherwise).
+    bool IsJobDone(mfxU32 jobNum, mfxStatus &jobRes) const;
+    // Wait until the job is over or the time is out (MFX_WRN_IN_EXECUTION)
+    mfxStatus WaitForJob(mfxU32 jobNum, mfxU32 timeToWait);
+
+    // Pointers to the next and the previous task in the queue.
+    // The 'free' and the 'failed' queues use the next pointer only.
+    MFX_SCHEDULER_TASK *pNext;
+    MFX_SCHEDULER_TASK *pPrev;
 
     // task state variables
 
-    // Waiting 'until task is done' object
-    std::condition_variable done;
     // Final status of the current job
     volatile
     mfxStatus opRes;
@@ -97,16 +112,24 @@ struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
     // opRes variable, when the task is done and the last thread leaves the task.
     volatile
     mfxStatus curStatus;
+    // Ordinal task number. It doesn't grow during task lifetime.
+    // This ID is used to access task tracking tables and lists.
+    const
+    mfxU32 taskID;
+    // Job number. It is set to a new value, which is steadly growing, everytime
+    // when task is assigned for a new piece of job. Sometimes jobID is accessed
+    // without synchronization, so it is required not to cache it.
+    volatile
+    mfxU32 jobID;
 
     // make all task's parameters as a separate object
     // to make initialization easier.
     struct
     {
 
-        // task describing parameters
+        // task describing parameters, the fields checked
+        // by every thread looking for work go first
 
-        // Task's parameters
-        MFX_TASK task;
         // Pointer to the thread occupancy table's entity
         MFX_THREAD_ASSIGNMENT *pThreadAssignment;
         // Current occupancy of the task (number of threads entered inside)
@@ -118,8 +141,13 @@ struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
 
         // task timing parameters
         bool bWaiting;                                              // (bool) task needs some waiting
+        bool bWaitingCompletion;                                    // (bool) task waits for the registered completion
         struct
         {
+            // Time stamp of adding the task to the scheduler
+            mfxU64 timeAdded;
+            // Time stamp the task is to be done by, if the scheduler has the latency budget
+            mfxU64 deadline;
             // Time in msec of the last 'entering' to the task
             mfxU64 timeLastEnter;
             // Time stamp of the last call issued
@@ -134,12 +162,8 @@ struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
             mfxU64 hwCounterLastEnter;
         } timing;
 
-        // source file info
-        struct
-        {
-            const char *pFileName;                                      // (const char *) source file name, where task was spawn
-            int lineNumber;                                             // (int) source source file line number, where task was spawn
-        } sourceInfo;
+        // Task's parameters
+        MFX_TASK task;
 
         // dependencies members
         struct
@@ -148,14 +172,31 @@ struct MFX_SCHEDULER_TASK : public mfxDependencyItem<MFX_TASK_NUM_DEPENDENCIES>
             mfxU32 dstIdx[MFX_TASK_NUM_DEPENDENCIES];
         } dependencies;
 
-    } param;
+        // source file info
+        struct
+        {
+            const char *pFileName;                                      // (const char *) source file name, where task was spawn
+            int lineNumber;                                             // (int) source source file line number, where task was spawn
+        } sourceInfo;
 
-    // Pointer to the next task
-    MFX_SCHEDULER_TASK *pNext;
+    } param;
 
     // bad practice to get cross links, but this is how our scheduler designed 
     mfxSchedulerCore *m_pSchedulerCore;
 
+    // Job number and the final status of the job packed together, so
+    // Synchronize doesn't need the scheduler's lock to read them. The handle
+    // table is never shrunk, a handle of a reused task has the other job
+    // number and it is reported as completed. The fields are written by
+    // the thread completing the job and polled by waiting threads,
+    // they occupy a separate cache line.
+    alignas(MFX_SCHEDULER_CACHE_LINE)
+    std::atomic<mfxU64> jobState;
+    // Futex word to wait 'until task is done'. It grows with every job done.
+    std::atomic<mfxU32> doneCounter;
+    // Number of threads sleeping on the futex
+    std::atomic<mfxU32> numWaiters;
+
 protected:
     // Destructor is protected to avoid deletion the object by occasion.
     virtual
@@ -171,6 +212,53 @@ private:
     MFX_SCHEDULER_TASK & operator = (MFX_SCHEDULER_TASK &);
 };
 
+// Intrusive queue of tasks. Tasks are added to the tail
+// and removed from any place of the queue in constant time.
+struct MFX_SCHEDULER_TASK_QUEUE
+{
+    MFX_SCHEDULER_TASK *pHead;
+    MFX_SCHEDULER_TASK *pTail;
+
+    inline
+    void PushBack(MFX_SCHEDULER_TASK *pTask)
+    {
+        pTask->pNext = NULL;
+        pTask->pPrev = pTail;
+        if (pTail)
+        {
+            pTail->pNext = pTask;
+        }
+        else
+        {
+            pHead = pTask;
+        }
+        pTail = pTask;
+    }
+
+    inline
+    void Remove(MFX_SCHEDULER_TASK *pTask)
+    {
+        if (pTask->pPrev)
+        {
+            pTask->pPrev->pNext = pTask->pNext;
+        }
+        else
+        {
+            pHead = pTask->pNext;
+        }
+        if (pTask->pNext)
+        {
+            pTask->pNext->pPrev = pTask->pPrev;
+        }
+        else
+        {
+            pTail = pTask->pPrev;
+        }
+        pTask->pNext = NULL;
+        pTask->pPrev = NULL;
+    }
+};
+
 // Get the number of task allocated
 mfxU32 GetNumTaskAllocated(void);
 
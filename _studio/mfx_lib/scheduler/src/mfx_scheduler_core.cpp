@@ -22,18 +22,40 @@
 
 #include <mfx_scheduler_core_task.h>
 #include <mfx_scheduler_core_handle.h>
+#include <mfx_scheduler_core_pool.h>
 #include <mfx_trace.h>
+#include <libmfx_core_interface.h>
 
 #include <vm_time.h>
 #include <vm_sys_info.h>
 #include <algorithm>
+#include <new>
+#include <stdlib.h>
 
 
+void *mfxSchedulerCore::operator new(size_t size)
+{
+    void *p = nullptr;
+
+    if (posix_memalign(&p, MFX_SCHEDULER_CACHE_LINE, size))
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+
+} // void *mfxSchedulerCore::operator new(size_t size)
+
+void mfxSchedulerCore::operator delete(void *p)
+{
+    free(p);
+
+} // void mfxSchedulerCore::operator delete(void *p)
+
 mfxSchedulerCore::mfxSchedulerCore(void)
-    :  m_currentTimeStamp(0)
     // since on Linux we have blocking synchronization which means an absence of polling,
     // there is no need to use 'waiting' time period.
-    , m_timeWaitPeriod(0)
+    : m_timeWaitPeriod(0)
     , m_hwWakeUpThread()
     , m_DedicatedThreadsToWakeUp(0)
     , m_RegularThreadsToWakeUp(0)
@@ -41,17 +63,20 @@ mfxSchedulerCore::mfxSchedulerCore(void)
     memset(&m_param, 0, sizeof(m_param));
     m_refCounter = 1;
 
+    m_currentTimeStamp = 0;
     memset(m_workingTime, 0, sizeof(m_workingTime));
     m_timeIdx = 0;
+    m_bLatencyStat = false;
 
     m_bQuit = false;
 
     m_pThreadCtx = NULL;
     m_vmtick_msec_frequency = vm_time_get_frequency()/1000;
+    m_deadlineBudget = 0;
     vm_event_set_invalid(&m_hwTaskDone);
 
     // reset task variables
-    memset(m_pTasks, 0, sizeof(m_pTasks));
+    memset(m_taskQueues, 0, sizeof(m_taskQueues));
     memset(m_numAssignedTasks, 0, sizeof(m_numAssignedTasks));
     m_pFailedTasks = NULL;
 
@@ -71,7 +96,26 @@ mfxSchedulerCore::mfxSchedulerCore(void)
 
     m_timer_hw_event = MFX_THREAD_TIME_TO_WAIT;
 
+    m_poolPriority = MFX_PRIORITY_NORMAL;
+    m_poolDeadline = MFX_NO_DEADLINE;
+    m_bPoolDedicatedBusy = false;
+
+    m_numaNode = -1;
+#if defined(__linux__)
+    CPU_ZERO(&m_numaCpus);
+#endif
+
+    m_numWaitingCompletions = 0;
+    m_completionCounter = 0;
+    m_completionEvent = -1;
+    m_bQuitCompletionThread = false;
 
+    m_numMultipleWaiters = 0;
+
+    for (auto & it : m_ppTaskLookUpTable)
+    {
+        it = nullptr;
+    }
 
 } // mfxSchedulerCore::mfxSchedulerCore(void)
 
@@ -95,13 +139,105 @@ bool mfxSchedulerCore::SetScheduling(std::thread& handle)
     return true;
 }
 
+// declare the static section of the file
+namespace
+{
+
+// the next node for MFX_NUMA_NODE_AUTO sessions
+std::atomic<mfxU32> NumaNextNode(0);
+
+} // namespace
+
+void mfxSchedulerCore::SelectNumaNode(void)
+{
+    m_numaNode = -1;
+
+#if defined(__linux__)
+    const mfxU32 numNodes = vm_sys_info_get_numa_node_num();
+    const mfxU32 numCpus = std::min<mfxU32>(vm_sys_info_get_cpu_num(), CPU_SETSIZE);
+    cpu_set_t allowed;
+    mfxU32 node;
+
+    CPU_ZERO(&m_numaCpus);
+
+    if (MFX_NUMA_NODE_ANY == m_param.numaNode)
+    {
+        return;
+    }
+    if (MFX_NUMA_NODE_AUTO == m_param.numaNode)
+    {
+        // there is nothing to balance on a single node
+        if (numNodes < 2)
+        {
+            return;
+        }
+        node = (NumaNextNode++) % numNodes;
+    }
+    else
+    {
+        node = m_param.numaNode - 1;
+    }
+
+    // CPUs of the node the process is allowed to run on
+    if (sched_getaffinity(0, sizeof(allowed), &allowed))
+    {
+        return;
+    }
+    for (mfxU32 cpu = 0; cpu < numCpus; cpu += 1)
+    {
+        if (CPU_ISSET(cpu, &allowed) && (vm_sys_info_get_numa_node_of_cpu(cpu) == node))
+        {
+            CPU_SET(cpu, &m_numaCpus);
+        }
+    }
+
+    if (CPU_COUNT(&m_numaCpus))
+    {
+        m_numaNode = (mfxI32) node;
+    }
+#endif // #if defined(__linux__)
+
+} // void mfxSchedulerCore::SelectNumaNode(void)
+
 void mfxSchedulerCore::SetThreadsAffinityToSockets(void)
 {
-}
+    if ((0 > m_numaNode) || (NULL == m_pThreadCtx))
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    for (mfxU32 i = 0; i < m_param.numberOfThreads; i += 1)
+    {
+        if (m_pThreadCtx[i].threadHandle.joinable())
+        {
+            pthread_setaffinity_np(m_pThreadCtx[i].threadHandle.native_handle(), sizeof(m_numaCpus), &m_numaCpus);
+        }
+    }
+#endif
+
+    // system memory of the session is allocated on the same node
+    if (m_param.pCore)
+    {
+        mfxI32 *pNode = (mfxI32 *) m_param.pCore->QueryCoreInterface(MFXICORE_NUMA_NODE_GUID);
+        if (pNode)
+        {
+            *pNode = m_numaNode;
+        }
+    }
+
+} // void mfxSchedulerCore::SetThreadsAffinityToSockets(void)
 
 void mfxSchedulerCore::Close(void)
 {
     StopWakeUpThread();
+    StopCompletionThread();
+
+    // leave the shared pool, no pool thread works for the scheduler after that
+    if (MFX_SCHEDULER_SHARED_POOL == m_param.flags)
+    {
+        mfxSchedulerPool::Instance().Unregister(this);
+    }
 
     // stop threads
     if (m_pThreadCtx)
@@ -138,24 +274,35 @@ void mfxSchedulerCore::Close(void)
         }
     );
 
-    // delete task objects
+    // destroy task objects and release their slabs
     for (auto & it : m_ppTaskLookUpTable)
     {
-        delete it;
-        it = nullptr;
+        MFX_SCHEDULER_TASK *pTask = it.exchange(nullptr);
+
+        if (pTask)
+        {
+            pTask->~MFX_SCHEDULER_TASK();
+        }
+    }
+    for (auto pSlab : m_taskSlabs)
+    {
+        free(pSlab);
     }
+    m_taskSlabs.clear();
 
 
     memset(&m_param, 0, sizeof(m_param));
 
     memset(m_workingTime, 0, sizeof(m_workingTime));
     m_timeIdx = 0;
+    m_bLatencyStat = false;
 
     // reset variables
     m_bQuit = false;
     m_pThreadCtx = NULL;
+    m_deadlineBudget = 0;
     // reset task variables
-    memset(m_pTasks, 0, sizeof(m_pTasks));
+    memset(m_taskQueues, 0, sizeof(m_taskQueues));
     memset(m_numAssignedTasks, 0, sizeof(m_numAssignedTasks));
     m_pFailedTasks = NULL;
 
@@ -170,6 +317,19 @@ void mfxSchedulerCore::Close(void)
     // reset task counters
     m_taskCounter = 0;
     m_jobCounter = 0;
+
+    m_poolPriority = MFX_PRIORITY_NORMAL;
+    m_poolDeadline = MFX_NO_DEADLINE;
+    m_bPoolDedicatedBusy = false;
+
+    m_numaNode = -1;
+#if defined(__linux__)
+    CPU_ZERO(&m_numaCpus);
+#endif
+
+    m_completions.clear();
+    m_numWaitingCompletions = 0;
+    m_completionCounter = 0;
 }
 
 void mfxSchedulerCore::WakeUpThreads(mfxU32 num_dedicated_threads, mfxU32 num_regular_threads)
@@ -177,6 +337,13 @@ void mfxSchedulerCore::WakeUpThreads(mfxU32 num_dedicated_threads, mfxU32 num_re
     if (m_param.flags == MFX_SINGLE_THREAD)
         return;
 
+    if (m_param.flags == MFX_SCHEDULER_SHARED_POOL) {
+        // the scheduler can't be entered by more than numberOfThreads threads
+        const mfxU64 num_threads = (mfxU64)num_dedicated_threads + num_regular_threads;
+        mfxSchedulerPool::Instance().Notify((mfxU32)std::min<mfxU64>(num_threads, m_param.numberOfThreads));
+        return;
+    }
+
     MFX_SCHEDULER_THREAD_CONTEXT* thctx;
 
     if (num_dedicated_threads) {
@@ -226,28 +393,14 @@ mfxStatus mfxSchedulerCore::AllocateEmptyTask(void)
     // Clean up task queues
     ScrubCompletedTasks();
 
-    // allocate one new task
+    // allocate new tasks
     if (nullptr == m_pFreeTasks)
     {
-
-
-        // the maximum allowed number of tasks is reached
-        if (MFX_MAX_NUMBER_TASK <= m_taskCounter)
-        {
-            return MFX_WRN_DEVICE_BUSY;
-        }
-
-        // allocate one more task
-        try
+        mfxStatus mfxRes = AllocateTaskSlab();
+        if (MFX_ERR_NONE != mfxRes)
         {
-            m_pFreeTasks = new MFX_SCHEDULER_TASK(m_taskCounter++, this);
+            return mfxRes;
         }
-        catch(...)
-        {
-            return MFX_WRN_DEVICE_BUSY;
-        }
-        // register the task in the look up table
-        m_ppTaskLookUpTable[m_pFreeTasks->taskID] = m_pFreeTasks;
     }
     memset(&(m_pFreeTasks->param), 0, sizeof(m_pFreeTasks->param));
     // increment job number. This number must grow evenly.
@@ -264,6 +417,69 @@ mfxStatus mfxSchedulerCore::AllocateEmptyTask(void)
 
 } // mfxStatus mfxSchedulerCore::AllocateEmptyTask(void)
 
+mfxStatus mfxSchedulerCore::AllocateTaskSlab(void)
+{
+    MFX_SCHEDULER_TASK *pTasks;
+    void *pSlab = nullptr;
+    mfxU32 i;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    // the maximum allowed number of tasks is reached
+    if (MFX_MAX_NUMBER_TASK <= m_taskCounter)
+    {
+        return MFX_WRN_DEVICE_BUSY;
+    }
+
+    // tasks of a slab are contiguous in memory and
+    // every task starts a new cache line
+    if (posix_memalign(&pSlab, MFX_SCHEDULER_CACHE_LINE,
+                       sizeof(MFX_SCHEDULER_TASK) * MFX_TASK_SLAB_SIZE))
+    {
+        return MFX_WRN_DEVICE_BUSY;
+    }
+    try
+    {
+        m_taskSlabs.push_back(pSlab);
+    }
+    catch(...)
+    {
+        free(pSlab);
+        return MFX_WRN_DEVICE_BUSY;
+    }
+
+    // construct the tasks, register them in the look up table
+    // and put into the 'free' queue in order of their numbers
+    pTasks = (MFX_SCHEDULER_TASK *) pSlab;
+    for (i = MFX_TASK_SLAB_SIZE; i > 0; i -= 1)
+    {
+        MFX_SCHEDULER_TASK *pTask = new (pTasks + i - 1) MFX_SCHEDULER_TASK(m_taskCounter + i - 1, this);
+
+        m_ppTaskLookUpTable[pTask->taskID] = pTask;
+        pTask->pNext = m_pFreeTasks;
+        m_pFreeTasks = pTask;
+    }
+    m_taskCounter += MFX_TASK_SLAB_SIZE;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::AllocateTaskSlab(void)
+
+int mfxSchedulerCore::GetTaskType(const MFX_SCHEDULER_TASK *pTask)
+{
+    return (pTask->param.task.threadingPolicy & MFX_TASK_DEDICATED) ? (MFX_TYPE_HARDWARE) : (MFX_TYPE_SOFTWARE);
+
+} // int mfxSchedulerCore::GetTaskType(const MFX_SCHEDULER_TASK *pTask)
+
+MFX_SCHEDULER_TASK_QUEUE &mfxSchedulerCore::GetTaskQueue(MFX_SCHEDULER_TASK *pTask)
+{
+    return m_taskQueues[pTask->param.task.priority][GetTaskType(pTask)];
+
+} // MFX_SCHEDULER_TASK_QUEUE &mfxSchedulerCore::GetTaskQueue(MFX_SCHEDULER_TASK *pTask)
+
 mfxStatus mfxSchedulerCore::GetOccupancyTableIndex(mfxU32 &idx,
                                                    const MFX_TASK *pTask)
 {
@@ -356,7 +572,8 @@ void mfxSchedulerCore::ScrubCompletedTasks(bool bComprehensive)
 
         for (type = MFX_TYPE_HARDWARE; type <= MFX_TYPE_SOFTWARE; type += 1)
         {
-            MFX_SCHEDULER_TASK **ppCur;
+            MFX_SCHEDULER_TASK_QUEUE &queue = m_taskQueues[priority][type];
+            MFX_SCHEDULER_TASK *pTask;
 
             // if there is an empty task, immediately return
             if ((false == bComprehensive) &&
@@ -365,39 +582,28 @@ void mfxSchedulerCore::ScrubCompletedTasks(bool bComprehensive)
                 return;
             }
 
-            ppCur = m_pTasks[priority] + type;
-            while (*ppCur)
+            pTask = queue.pHead;
+            while (pTask)
             {
+                MFX_SCHEDULER_TASK *pNext = pTask->pNext;
+
                 // move task completed to the 'free' queue.
-                if (MFX_ERR_NONE == (*ppCur)->opRes)
+                if (MFX_ERR_NONE == pTask->opRes)
                 {
-                    MFX_SCHEDULER_TASK *pTemp;
-
-                    // cut the task from the queue
-                    pTemp = *ppCur;
-                    *ppCur = pTemp->pNext;
-                    // add it to the 'free' queue
-                    pTemp->pNext = m_pFreeTasks;
-                    m_pFreeTasks = pTemp;
+                    queue.Remove(pTask);
+                    pTask->pNext = m_pFreeTasks;
+                    m_pFreeTasks = pTask;
                 }
                 // move task failed to the 'failed' queue.
-                else if ((MFX_ERR_NONE != (*ppCur)->opRes) &&
-                         (MFX_WRN_IN_EXECUTION != (*ppCur)->opRes))
+                else if (MFX_WRN_IN_EXECUTION != pTask->opRes)
                 {
-                    MFX_SCHEDULER_TASK *pTemp;
-
-                    // cut the task from the queue
-                    pTemp = *ppCur;
-                    *ppCur = pTemp->pNext;
-                    // add it to the 'failed' queue
-                    pTemp->pNext = m_pFailedTasks;
-                    m_pFailedTasks = pTemp;
-                }
-                else
-                {
-                    // set the next task
-                    ppCur = &((*ppCur)->pNext);
+                    queue.Remove(pTask);
+                    pTask->pNext = m_pFailedTasks;
+                    m_pFailedTasks = pTask;
                 }
+
+                // set the next task
+                pTask = pNext;
             }
         }
     }
@@ -522,7 +728,7 @@ void mfxSchedulerCore::RegisterTaskDependencies(MFX_SCHEDULER_TASK  *pTask)
         // save the status
         m_pFreeTasks->curStatus = taskRes;
         m_pFreeTasks->opRes = taskRes;
-        m_pFreeTasks->done.notify_all();
+        OnTaskDone(m_pFreeTasks);
     }
 
 } // void mfxSchedulerCore::RegisterTaskDependencies(MFX_SCHEDULER_TASK  *pTask)
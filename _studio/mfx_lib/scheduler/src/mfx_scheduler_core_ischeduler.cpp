@@ -22,6 +22,7 @@
 
 #include <mfx_scheduler_core_task.h>
 #include <mfx_scheduler_core_handle.h>
+#include <mfx_scheduler_core_pool.h>
 
 #include <vm_time.h>
 #include <vm_sys_info.h>
@@ -30,6 +31,11 @@
 #include <functional>
 #include <cassert>
 #include <list>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
 
 enum
 {
@@ -37,6 +43,39 @@ enum
     MFX_TIME_TO_WAIT            = 5
 };
 
+// declare the static section of the file
+namespace
+{
+
+// The shared pool is requested for sessions of the process, which don't
+// choose the pool themselves, by the environment variable
+// MFX_SCHEDULER_SHARED_POOL=1.
+bool IsSharedPoolRequested(void)
+{
+    const char *pValue = getenv("MFX_SCHEDULER_SHARED_POOL");
+
+    return (pValue) && (0 != atoi(pValue));
+}
+
+// The NUMA node is requested for all sessions of the process
+// by the environment variable MFX_SCHEDULER_NUMA_NODE=auto|<node>.
+mfxU32 GetRequestedNumaNode(void)
+{
+    const char *pValue = getenv("MFX_SCHEDULER_NUMA_NODE");
+
+    if ((NULL == pValue) || (0 == *pValue))
+    {
+        return MFX_NUMA_NODE_ANY;
+    }
+    if (0 == strcmp(pValue, "auto"))
+    {
+        return MFX_NUMA_NODE_AUTO;
+    }
+    return (mfxU32) atoi(pValue) + 1;
+}
+
+} // namespace
+
 mfxStatus mfxSchedulerCore::Initialize(const MFX_SCHEDULER_PARAM *pParam)
 {
     MFX_SCHEDULER_PARAM2 param2;
@@ -67,9 +106,8 @@ mfxStatus mfxSchedulerCore::Initialize2(const MFX_SCHEDULER_PARAM2 *pParam)
     {
         m_param = *pParam;
     }
-
-    // clean up the task look up table
-    m_ppTaskLookUpTable.resize(MFX_MAX_NUMBER_TASK, nullptr);
+    // convert the latency budget of tasks to timer ticks
+    m_deadlineBudget = (mfxU64) m_param.latencyBudget * m_vmtick_msec_frequency / 1000;
 
     // allocate the dependency table
     m_pDependencyTable.resize(MFX_MAX_NUMBER_TASK * 2, MFX_DEPENDENCY_ITEM());
@@ -79,7 +117,70 @@ mfxStatus mfxSchedulerCore::Initialize2(const MFX_SCHEDULER_PARAM2 *pParam)
     // larger table is not required.
     m_occupancyTable.resize(MFX_MAX_NUMBER_TASK, MFX_THREAD_ASSIGNMENT());
 
-    if (MFX_SINGLE_THREAD != m_param.flags)
+    if (MFX_SCHEDULER_DEFAULT == m_param.flags)
+    {
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        // the session's choice of the pool takes precedence
+        // over the environment variable
+        if ((MFX_CODINGOPTION_ON == m_param.params.SharedPool) ||
+            ((MFX_CODINGOPTION_OFF != m_param.params.SharedPool) && IsSharedPoolRequested()))
+#else
+        if (IsSharedPoolRequested())
+#endif
+        {
+            m_param.flags = MFX_SCHEDULER_SHARED_POOL;
+        }
+    }
+
+    if ((MFX_SCHEDULER_SHARED_POOL == m_param.flags) &&
+        m_param.numberOfThreads && (1 == m_param.params.NumThread))
+    {
+        // a single pool thread could dead lock the session,
+        // so it gets a private pool of the minimal size instead
+        m_param.flags = MFX_SCHEDULER_DEFAULT;
+        m_param.params.NumThread = 2;
+    }
+
+    if (MFX_SCHEDULER_SHARED_POOL == m_param.flags)
+    {
+        const mfxU32 poolThreads = mfxSchedulerPool::Instance().GetNumThreads();
+
+        if (m_param.numberOfThreads && m_param.params.NumThread) {
+            // user-overwritten number of threads limits
+            // the number of pool threads working for the session
+            m_param.numberOfThreads = m_param.params.NumThread;
+        }
+        else if (m_param.numberOfThreads) {
+            m_param.numberOfThreads = poolThreads;
+        }
+        if (!m_param.numberOfThreads) {
+            return MFX_ERR_UNSUPPORTED;
+        }
+        if (m_param.numberOfThreads == 1) {
+            // we need at least 2 threads to avoid dead locks
+            return MFX_ERR_UNSUPPORTED;
+        }
+        m_param.numberOfThreads = std::min(m_param.numberOfThreads, poolThreads);
+
+        try
+        {
+            // allocate 'free task' event
+            umcRes = m_freeTasks.Init(MFX_MAX_NUMBER_TASK, MFX_MAX_NUMBER_TASK);
+            if (UMC::UMC_OK != umcRes)
+            {
+                return MFX_ERR_UNKNOWN;
+            }
+
+            // threads are not created, the pool threads serve the scheduler.
+            // Scheduling parameters of the session are not applied to them.
+            mfxSchedulerPool::Instance().Register(this);
+        }
+        catch (...)
+        {
+            return MFX_ERR_MEMORY_ALLOC;
+        }
+    }
+    else if (MFX_SINGLE_THREAD != m_param.flags)
     {
         if (m_param.numberOfThreads && m_param.params.NumThread) {
             // use user-overwritten number of threads
@@ -93,6 +194,17 @@ mfxStatus mfxSchedulerCore::Initialize2(const MFX_SCHEDULER_PARAM2 *pParam)
             return MFX_ERR_UNSUPPORTED;
         }
 
+        if (MFX_NUMA_NODE_ANY == m_param.numaNode) {
+            m_param.numaNode = GetRequestedNumaNode();
+        }
+        SelectNumaNode();
+#if defined(__linux__)
+        if ((0 <= m_numaNode) && !m_param.params.NumThread) {
+            // threads of the session are kept on CPUs of the node
+            m_param.numberOfThreads = std::max<mfxU32>(
+                std::min<mfxU32>(m_param.numberOfThreads, CPU_COUNT(&m_numaCpus)), 2);
+        }
+#endif
 
         try
         {
@@ -171,13 +283,16 @@ mfxStatus mfxSchedulerCore::Synchronize(mfxSyncPoint syncPoint, mfxU32 timeToWai
 
 mfxStatus mfxSchedulerCore::Synchronize(mfxTaskHandle handle, mfxU32 timeToWait)
 {
+    mfxStatus jobRes;
+
     // check error(s)
     if (0 == m_param.numberOfThreads)
     {
         return MFX_ERR_NOT_INITIALIZED;
     }
 
-    // look up the task
+    // look up the task. The lock is not required,
+    // task objects live until the scheduler is closed.
     MFX_SCHEDULER_TASK *pTask = m_ppTaskLookUpTable.at(handle.taskID);
 
     if (nullptr == pTask)
@@ -185,6 +300,12 @@ mfxStatus mfxSchedulerCore::Synchronize(mfxTaskHandle handle, mfxU32 timeToWait)
         return MFX_ERR_NULL_PTR;
     }
 
+    // the job is over already, don't touch the scheduler
+    if (pTask->IsJobDone(handle.jobID, jobRes))
+    {
+        return jobRes;
+    }
+
     if (MFX_SINGLE_THREAD == m_param.flags)
     {
         //let really run task to
@@ -194,13 +315,23 @@ mfxStatus mfxSchedulerCore::Synchronize(mfxTaskHandle handle, mfxU32 timeToWait)
         mfxStatus task_sts = MFX_ERR_NONE;
         mfxU64 start = GetHighPerformanceCounter();
         mfxU64 frequency = vm_time_get_frequency();
-        while (MFX_WRN_IN_EXECUTION == pTask->opRes)
+        while (!pTask->IsJobDone(handle.jobID, jobRes))
         {
             std::unique_lock<std::mutex> guard(m_guard);
             task_sts = GetTask(call, previousTaskHandle, 0);
 
             if (task_sts != MFX_ERR_NONE)
+            {
+                // tasks wait for the device, sleep until a completion is signaled
+                if (m_numWaitingCompletions)
+                {
+                    const mfxU64 completionCounter = m_completionCounter;
+
+                    m_completionDone.wait_for(guard, std::chrono::milliseconds(15),
+                        [this, completionCounter] { return completionCounter != m_completionCounter; });
+                }
                 continue;
+            }
 
             guard.unlock();
 
@@ -234,58 +365,207 @@ mfxStatus mfxSchedulerCore::Synchronize(mfxTaskHandle handle, mfxU32 timeToWait)
                 }
             }
         }
-        //
-        // inspect the task
-        //
+        // the job status is MFX_WRN_IN_EXECUTION, if the time is out
+        pTask->IsJobDone(handle.jobID, jobRes);
 
-        // the handle is outdated,
-        // the previous task job is over and completed with successful status
-        // NOTE: it make sense to read task result and job ID the following order.
-        if ((MFX_ERR_NONE == pTask->opRes) ||
-            (pTask->jobID != handle.jobID))
+        return jobRes;
+    }
+    else
+    {
+        MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_PRIVATE, "Scheduler::Wait");
+        MFX_LTRACE_1(MFX_TRACE_LEVEL_SCHED, "^Depends^on", "%d", pTask->param.task.nParentId);
+        MFX_LTRACE_I(MFX_TRACE_LEVEL_SCHED, timeToWait);
+
+        // sleep on the task's futex, the scheduler's lock is not taken
+        return pTask->WaitForJob(handle.jobID, timeToWait);
+    }
+}
+
+mfxStatus mfxSchedulerCore::AddTasks(const MFX_TASK *pTasks, mfxU32 numTasks,
+                                     mfxSyncPoint *pSyncPoints, mfxU32 *pNumAdded)
+{
+    mfxStatus mfxRes = MFX_ERR_NONE;
+    mfxU32 i;
+
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+    if ((NULL == pTasks) ||
+        (NULL == pSyncPoints) ||
+        (NULL == pNumAdded))
+    {
+        return MFX_ERR_NULL_PTR;
+    }
+    *pNumAdded = 0;
+    if (MFX_MAX_NUMBER_TASK < numTasks)
+    {
+        return MFX_ERR_UNSUPPORTED;
+    }
+    for (i = 0; i < numTasks; i += 1)
+    {
+        if (NULL == pTasks[i].entryPoint.pRoutine)
         {
-            return MFX_ERR_NONE;
+            return MFX_ERR_NULL_PTR;
         }
+    }
+
+    // make sure that there is enough free task objects. Take them for the
+    // whole batch at once, so two batches never hold a part of the objects
+    // each while waiting for the rest.
+    {
+        std::lock_guard<std::mutex> guard(m_freeTasksGuard);
 
-        // wait the result on the event
-        if (MFX_WRN_IN_EXECUTION == pTask->opRes)
+        for (i = 0; i < numTasks; i += 1)
         {
-            return MFX_WRN_IN_EXECUTION;
+            m_freeTasks.Wait();
         }
+    }
 
-        // check error status
-        if ((MFX_ERR_NONE != pTask->opRes) &&
-            (pTask->jobID == handle.jobID))
+    // enter protected section
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+        mfxU32 num_hw_threads = 0, num_sw_threads = 0;
+
+        for (i = 0; i < numTasks; i += 1)
         {
-            return pTask->opRes;
+#ifdef MFX_TRACE_ENABLE
+            MFX_LTRACE_1(MFX_TRACE_LEVEL_SCHED, "^Enqueue^", "%d", pTasks[i].nTaskId);
+#endif
+            mfxRes = EnqueueTask(pTasks[i], pSyncPoints + i, NULL, 0,
+                                 num_hw_threads, num_sw_threads);
+            if (MFX_ERR_NONE != mfxRes)
+            {
+                break;
+            }
         }
+        *pNumAdded = i;
 
-        // in all other cases task is complete
-        return MFX_ERR_NONE;
+        // wake up working threads for all ready tasks at once
+        if (num_hw_threads || num_sw_threads) {
+            WakeUpThreads(num_hw_threads, num_sw_threads);
+        }
+
+        // leave the protected section
     }
-    else
+
+    // return free task objects, which are not taken
+    if (*pNumAdded < numTasks)
     {
-        std::unique_lock<std::mutex> guard(m_guard);
+        m_freeTasks.Signal(numTasks - *pNumAdded);
+    }
 
-        MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_PRIVATE, "Scheduler::Wait");
-        MFX_LTRACE_1(MFX_TRACE_LEVEL_SCHED, "^Depends^on", "%d", pTask->param.task.nParentId);
-        MFX_LTRACE_I(MFX_TRACE_LEVEL_SCHED, timeToWait);
+    return mfxRes;
 
-        pTask->done.wait_for(guard, std::chrono::milliseconds(timeToWait), [pTask, handle] {
-           return (pTask->jobID != handle.jobID) || (MFX_WRN_IN_EXECUTION != pTask->opRes);
-        });
+} // mfxStatus mfxSchedulerCore::AddTasks(...)
 
-        if (pTask->jobID == handle.jobID) {
-            return pTask->opRes;
-        } else {
-            /* Notes:
-             *  - task executes next job already, we _lost_ task status and can only assume that
-             *  everything was OK or FAILED, we will assume that task succeeded
-             */
-            return MFX_ERR_NONE;
+mfxStatus mfxSchedulerCore::SynchronizeMultiple(const mfxSyncPoint *pSyncPoints, mfxU32 numSyncPoints,
+                                                bool waitAll, mfxU32 timeToWait, mfxU32 *pIndex)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeToWait);
+    std::vector<mfxTaskHandle> handles(numSyncPoints);
+    mfxU32 numPending = 0;
+    mfxU32 i;
+
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+    if ((NULL == pSyncPoints) ||
+        (!waitAll && (NULL == pIndex)))
+    {
+        return MFX_ERR_NULL_PTR;
+    }
+
+    // cast the pointers to handles
+    for (i = 0; i < numSyncPoints; i += 1)
+    {
+        handles[i].handle = (size_t) pSyncPoints[i];
+        numPending += (pSyncPoints[i]) ? (1) : (0);
+    }
+    if (0 == numPending)
+    {
+        return (waitAll) ? (MFX_ERR_NONE) : (MFX_ERR_NOT_FOUND);
+    }
+
+    if (MFX_SINGLE_THREAD == m_param.flags)
+    {
+        // tasks are run by the waiting thread in the order of their submission,
+        // so the first task, which is not done, is the first one to complete
+        for (i = 0; i < numSyncPoints; i += 1)
+        {
+            if (NULL == pSyncPoints[i])
+            {
+                continue;
+            }
+
+            const auto timeLeft = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            mfxStatus mfxRes = Synchronize(handles[i], (mfxU32) std::max<long long>(timeLeft, 0));
+
+            if (!waitAll || (MFX_ERR_NONE != mfxRes))
+            {
+                if (pIndex)
+                {
+                    *pIndex = i;
+                }
+                return mfxRes;
+            }
         }
+
+        return MFX_ERR_NONE;
     }
-}
+
+    std::unique_lock<std::mutex> guard(m_guard);
+    mfxStatus jobRes = MFX_WRN_IN_EXECUTION;
+    mfxU32 index = 0;
+
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_PRIVATE, "Scheduler::WaitMultiple");
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_SCHED, numPending);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_SCHED, timeToWait);
+
+    // find the done task, or the failed one, when all tasks are waited for
+    auto isDone = [&]() {
+        mfxU32 numDone = 0;
+
+        for (mfxU32 j = 0; j < numSyncPoints; j += 1)
+        {
+            mfxStatus res;
+
+            if (pSyncPoints[j] && IsJobDone(handles[j], res))
+            {
+                numDone += 1;
+                if (!waitAll || (MFX_ERR_NONE != res))
+                {
+                    index = j;
+                    jobRes = res;
+                    return true;
+                }
+            }
+        }
+        if (numDone == numPending)
+        {
+            jobRes = MFX_ERR_NONE;
+            return true;
+        }
+
+        return false;
+    };
+
+    m_numMultipleWaiters += 1;
+    m_taskDone.wait_until(guard, deadline, isDone);
+    m_numMultipleWaiters -= 1;
+
+    if (pIndex)
+    {
+        *pIndex = index;
+    }
+
+    return jobRes;
+
+} // mfxStatus mfxSchedulerCore::SynchronizeMultiple(...)
 
 mfxStatus mfxSchedulerCore::GetTimeout(mfxU32& maxTimeToRun)
 {
@@ -418,6 +698,91 @@ mfxStatus mfxSchedulerCore::ResetWaitingStatus(const void *pOwner)
 
 } // mfxStatus mfxSchedulerCore::ResetWaitingStatus(const void *pOwner)
 
+mfxStatus mfxSchedulerCore::RegisterCompletion(const void *pOwner, const void *pParam, int fd)
+{
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    MFX_SCHEDULER_TASK *pTask = FindWorkingTask(pOwner, pParam);
+    if (NULL == pTask)
+    {
+        return MFX_ERR_NOT_FOUND;
+    }
+
+    return AddCompletion(pTask, fd);
+
+} // mfxStatus mfxSchedulerCore::RegisterCompletion(const void *pOwner, const void *pParam, int fd)
+
+mfxStatus mfxSchedulerCore::SignalCompletion(const void *pOwner, const void *pParam)
+{
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    MFX_SCHEDULER_TASK *pTask = FindWorkingTask(pOwner, pParam);
+    if (NULL == pTask)
+    {
+        return MFX_ERR_NOT_FOUND;
+    }
+
+    OnCompletion(pTask);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::SignalCompletion(const void *pOwner, const void *pParam)
+
+mfxStatus mfxSchedulerCore::SetContinuation(const void *pState, const void *pParam,
+                                            mfxTaskRoutine pRoutine, int fd)
+{
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+    if (NULL == pRoutine)
+    {
+        return MFX_ERR_NULL_PTR;
+    }
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    MFX_SCHEDULER_TASK *pTask = FindWorkingEntryPoint(pState, pParam);
+    if (NULL == pTask)
+    {
+        return MFX_ERR_NOT_FOUND;
+    }
+    // other threads may be inside the routine being replaced
+    if (1 != pTask->param.task.entryPoint.requiredNumThreads)
+    {
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    if (0 <= fd)
+    {
+        mfxStatus mfxRes = AddCompletion(pTask, fd);
+        if (MFX_ERR_NONE != mfxRes)
+        {
+            return mfxRes;
+        }
+    }
+
+    // the next call reads the routine after taking the task under the guard,
+    // the calling thread is the only one executing the task.
+    pTask->param.task.entryPoint.pRoutine = pRoutine;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::SetContinuation(const void *pState, const void *pParam,
+
 mfxStatus mfxSchedulerCore::GetState(void)
 {
     // check error(s)
@@ -514,6 +879,66 @@ mfxStatus mfxSchedulerCore::AdjustPerformance(const mfxSchedulerMessage message)
 
 } // mfxStatus mfxSchedulerCore::AdjustPerformance(const mfxSchedulerMessage message)
 
+mfxStatus mfxSchedulerCore::GetStat(MFX_SCHEDULER_STAT *pStat)
+{
+    // check error(s)
+    if (0 == m_param.numberOfThreads)
+    {
+        return MFX_ERR_NOT_INITIALIZED;
+    }
+    if (NULL == pStat)
+    {
+        return MFX_ERR_NULL_PTR;
+    }
+
+    memset(pStat, 0, sizeof(MFX_SCHEDULER_STAT));
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    // start measuring the latency of the next tasks
+    m_bLatencyStat = true;
+
+    // count the tasks in the queues by their state
+    ForEachTask(
+        [pStat](MFX_SCHEDULER_TASK *pTask)
+        {
+            // failed tasks are about to leave the queues
+            if (MFX_TASK_NEED_CONTINUE != pTask->curStatus)
+            {
+                return;
+            }
+
+            MFX_SCHEDULER_TASK_STAT &taskStat = pStat->task[GetTaskType(pTask)];
+
+            taskStat.numQueued += 1;
+            if (pTask->param.occupancy)
+            {
+                taskStat.numRunning += 1;
+            }
+            else if ((pTask->param.bWaiting) || (pTask->param.bWaitingCompletion))
+            {
+                taskStat.numWaiting += 1;
+            }
+            else if (false == pTask->IsDependenciesResolved())
+            {
+                taskStat.numBlocked += 1;
+            }
+            else
+            {
+                taskStat.numReady += 1;
+            }
+        }
+    );
+
+    // the shared pool and the single thread mode have no threads of their own
+    pStat->numberOfThreads = (m_pThreadCtx) ? (m_param.numberOfThreads) : (0);
+
+    GetTimeStat(*pStat);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::GetStat(MFX_SCHEDULER_STAT *pStat)
+
 
 mfxStatus mfxSchedulerCore::AddTask(const MFX_TASK &task, mfxSyncPoint *pSyncPoint,
                                     const char *pFileName, int lineNumber)
@@ -540,126 +965,147 @@ mfxStatus mfxSchedulerCore::AddTask(const MFX_TASK &task, mfxSyncPoint *pSyncPoi
     // enter protected section
     {
         std::lock_guard<std::mutex> guard(m_guard);
+        mfxU32 num_hw_threads = 0, num_sw_threads = 0;
         mfxStatus mfxRes;
-        MFX_SCHEDULER_TASK *pTask, **ppTemp;
-        mfxTaskHandle handle;
-        MFX_THREAD_ASSIGNMENT *pAssignment = nullptr;
-        mfxU32 occupancyIdx;
-        int type;
-
-        // Make sure that there is an empty task object
 
-        mfxRes = AllocateEmptyTask();
-        if (MFX_ERR_NONE != mfxRes)
-        {
-            // better to return error instead of WRN  (two-tasks per component scheme)
-            return MFX_ERR_MEMORY_ALLOC;
-        }
-
-        // initialize the task
-        m_pFreeTasks->ResetDependency();
-        mfxRes = m_pFreeTasks->Reset();
+        mfxRes = EnqueueTask(task, pSyncPoint, pFileName, lineNumber,
+                             num_hw_threads, num_sw_threads);
         if (MFX_ERR_NONE != mfxRes)
         {
             return mfxRes;
         }
-        m_pFreeTasks->param.task = task;
-        mfxRes = GetOccupancyTableIndex(occupancyIdx, &task);
-        if (MFX_ERR_NONE != mfxRes)
-        {
-            return mfxRes;
-        }
-        if (m_occupancyTable.size() <= occupancyIdx)
-        {
-            return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+        // wake up working threads if task has resolved dependencies
+        if (num_hw_threads || num_sw_threads) {
+            WakeUpThreads(num_hw_threads, num_sw_threads);
         }
-        pAssignment = &(m_occupancyTable[occupancyIdx]);
 
-        // update the thread assignment parameters
-        if (MFX_TASK_INTRA & task.threadingPolicy)
-        {
-            // last entries in the dependency arrays must be empty
-            if ((m_pFreeTasks->param.task.pSrc[MFX_TASK_NUM_DEPENDENCIES - 1]) ||
-                (m_pFreeTasks->param.task.pDst[MFX_TASK_NUM_DEPENDENCIES - 1]))
-            {
-                return MFX_ERR_INVALID_VIDEO_PARAM;
-            }
+        // leave the protected section
+    }
+
+    return MFX_ERR_NONE;
+
+}
+
+mfxStatus mfxSchedulerCore::EnqueueTask(const MFX_TASK &task, mfxSyncPoint *pSyncPoint,
+                                        const char *pFileName, int lineNumber,
+                                        mfxU32 &numDedicatedThreads, mfxU32 &numRegularThreads)
+{
+    mfxStatus mfxRes;
+    MFX_SCHEDULER_TASK *pTask;
+    mfxTaskHandle handle;
+    MFX_THREAD_ASSIGNMENT *pAssignment = nullptr;
+    mfxU32 occupancyIdx;
 
-            // fill INTRA task dependencies
-            m_pFreeTasks->param.task.pSrc[MFX_TASK_NUM_DEPENDENCIES - 1] = pAssignment->pLastTask;
-            m_pFreeTasks->param.task.pDst[MFX_TASK_NUM_DEPENDENCIES - 1] = m_pFreeTasks;
-            // update the last intra task pointer
-            pAssignment->pLastTask = m_pFreeTasks;
-        }
-        // do not save the pointer to thread assigment instance
-        // until all checking have been done
-        m_pFreeTasks->param.pThreadAssignment = pAssignment;
-        pAssignment->m_numRefs += 1;
-
-        // saturate the number of available threads
-        uint32_t numThreads = m_pFreeTasks->param.task.entryPoint.requiredNumThreads;
-        numThreads = (0 == numThreads) ? m_param.numberOfThreads : numThreads;
-
-        numThreads = std::min<uint32_t>({m_param.numberOfThreads, numThreads, sizeof(pAssignment->threadMask) * 8});
-        m_pFreeTasks->param.task.entryPoint.requiredNumThreads = numThreads;
-
-        // set the advanced task's info
-        m_pFreeTasks->param.sourceInfo.pFileName = pFileName;
-        m_pFreeTasks->param.sourceInfo.lineNumber = lineNumber;
-        // set the sync point for the task
-        handle.handle = 0;
-        handle.taskID = m_pFreeTasks->taskID;
-        handle.jobID = m_pFreeTasks->jobID;
-        *pSyncPoint = (mfxSyncPoint) handle.handle;
-
-        // Register task dependencies
-        RegisterTaskDependencies(m_pFreeTasks);
-
-
-        //
-        // move task to the corresponding task
-        //
-
-        // remove the task from the 'free' queue
-        pTask = m_pFreeTasks;
-        m_pFreeTasks = m_pFreeTasks->pNext;
-        pTask->pNext = NULL;
-
-        // find the end of the corresponding queue
-        type = (task.threadingPolicy & MFX_TASK_DEDICATED) ? (MFX_TYPE_HARDWARE) : (MFX_TYPE_SOFTWARE);
-        ppTemp = m_pTasks[task.priority] + type;
-        while (*ppTemp)
+    // Make sure that there is an empty task object
+
+    mfxRes = AllocateEmptyTask();
+    if (MFX_ERR_NONE != mfxRes)
+    {
+        // better to return error instead of WRN  (two-tasks per component scheme)
+        return MFX_ERR_MEMORY_ALLOC;
+    }
+
+    // initialize the task
+    m_pFreeTasks->ResetDependency();
+    mfxRes = m_pFreeTasks->Reset();
+    if (MFX_ERR_NONE != mfxRes)
+    {
+        return mfxRes;
+    }
+    m_pFreeTasks->param.task = task;
+    // the share of the shared pool follows the session priority
+    m_poolPriority = task.priority;
+    mfxRes = GetOccupancyTableIndex(occupancyIdx, &task);
+    if (MFX_ERR_NONE != mfxRes)
+    {
+        return mfxRes;
+    }
+    if (m_occupancyTable.size() <= occupancyIdx)
+    {
+        return MFX_ERR_UNDEFINED_BEHAVIOR;
+    }
+    pAssignment = &(m_occupancyTable[occupancyIdx]);
+
+    // update the thread assignment parameters
+    if (MFX_TASK_INTRA & task.threadingPolicy)
+    {
+        // last entries in the dependency arrays must be empty
+        if ((m_pFreeTasks->param.task.pSrc[MFX_TASK_NUM_DEPENDENCIES - 1]) ||
+            (m_pFreeTasks->param.task.pDst[MFX_TASK_NUM_DEPENDENCIES - 1]))
         {
-            ppTemp = &((*ppTemp)->pNext);
+            return MFX_ERR_INVALID_VIDEO_PARAM;
         }
 
-        // add the task to the end of the corresponding queue
-        *ppTemp = pTask;
+        // fill INTRA task dependencies
+        m_pFreeTasks->param.task.pSrc[MFX_TASK_NUM_DEPENDENCIES - 1] = pAssignment->pLastTask;
+        m_pFreeTasks->param.task.pDst[MFX_TASK_NUM_DEPENDENCIES - 1] = m_pFreeTasks;
+        // update the last intra task pointer
+        pAssignment->pLastTask = m_pFreeTasks;
+    }
+    // do not save the pointer to thread assigment instance
+    // until all checking have been done
+    m_pFreeTasks->param.pThreadAssignment = pAssignment;
+    pAssignment->m_numRefs += 1;
 
-        // reset all 'waiting' tasks to prevent freezing
-        // so called 'permanent' tasks.
-        ResetWaitingTasks(pTask->param.task.pOwner);
+    // saturate the number of available threads
+    uint32_t numThreads = m_pFreeTasks->param.task.entryPoint.requiredNumThreads;
+    numThreads = (0 == numThreads) ? m_param.numberOfThreads : numThreads;
 
-        mfxU32 num_hw_threads = 0, num_sw_threads = 0;
+    numThreads = std::min<uint32_t>({m_param.numberOfThreads, numThreads, sizeof(pAssignment->threadMask) * 8});
+    m_pFreeTasks->param.task.entryPoint.requiredNumThreads = numThreads;
 
-        // increment the number of available tasks
+    // the latency of the task is measured from this moment,
+    // the deadline is counted from it as well.
+    if (m_bLatencyStat || m_deadlineBudget)
+    {
+        const mfxU64 timeAdded = GetHighPerformanceCounter();
+
+        m_pFreeTasks->param.timing.timeAdded = (m_bLatencyStat) ? (timeAdded) : (0);
+        m_pFreeTasks->param.timing.deadline = timeAdded + m_deadlineBudget;
+    }
+    // set the advanced task's info
+    m_pFreeTasks->param.sourceInfo.pFileName = pFileName;
+    m_pFreeTasks->param.sourceInfo.lineNumber = lineNumber;
+    // set the sync point for the task
+    handle.handle = 0;
+    handle.taskID = m_pFreeTasks->taskID;
+    handle.jobID = m_pFreeTasks->jobID;
+    *pSyncPoint = (mfxSyncPoint) handle.handle;
+
+    // Register task dependencies
+    RegisterTaskDependencies(m_pFreeTasks);
+
+
+    //
+    // move task to the corresponding task
+    //
+
+    // remove the task from the 'free' queue
+    pTask = m_pFreeTasks;
+    m_pFreeTasks = m_pFreeTasks->pNext;
+
+    // add the task to the end of the corresponding queue
+    GetTaskQueue(pTask).PushBack(pTask);
+    UpdatePoolDeadline();
+
+    // reset all 'waiting' tasks to prevent freezing
+    // so called 'permanent' tasks.
+    ResetWaitingTasks(pTask->param.task.pOwner);
+
+    // increment the number of available tasks,
+    // working threads are woken up if task has resolved dependencies
+    if (IsReadyToRun(pTask)) {
         if (MFX_TASK_DEDICATED & task.threadingPolicy) {
-            num_hw_threads = numThreads;
+            numDedicatedThreads += numThreads;
         } else {
-            num_sw_threads = numThreads;
+            numRegularThreads += numThreads;
         }
-
-        // wake up working threads if task has resolved dependencies
-        if (IsReadyToRun(pTask)) {
-            WakeUpThreads(num_hw_threads, num_sw_threads);
-        }
-
-        // leave the protected section
     }
 
     return MFX_ERR_NONE;
 
-}
+} // mfxStatus mfxSchedulerCore::EnqueueTask(...)
 
 mfxStatus mfxSchedulerCore::DoWork()
 {
@@ -41,6 +41,14 @@ void *mfxSchedulerCore::QueryInterface(const MFX_GUID &guid)
         return (MFXIScheduler2 *) this;
     }
 
+    if (MFXIScheduler3_GUID == guid)
+    {
+        // increment reference counter
+        vm_interlocked_inc32(&m_refCounter);
+
+        return (MFXIScheduler3 *) this;
+    }
+
     // it is unsupported interface
     return NULL;
 
@@ -89,4 +97,13 @@ template<> MFXIScheduler2*  CreateInterfaceInstance<MFXIScheduler2>(const MFX_GU
 
     return NULL;
 
-} //template<> MFXIScheduler*  CreateInterfaceInstance<MFXIScheduler>()
\ No newline at end of file
+} //template<> MFXIScheduler*  CreateInterfaceInstance<MFXIScheduler>()
+
+template<> MFXIScheduler3*  CreateInterfaceInstance<MFXIScheduler3>(const MFX_GUID &guid)
+{
+    if (MFXIScheduler3_GUID == guid)
+        return (MFXIScheduler3*)(new mfxSchedulerCore);
+
+    return NULL;
+
+} //template<> MFXIScheduler3*  CreateInterfaceInstance<MFXIScheduler3>()
@@ -0,0 +1,409 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <mfx_scheduler_core_pool.h>
+#include <mfx_scheduler_core.h>
+
+#include <mfx_trace.h>
+#include <vm_sys_info.h>
+#include <vm_time.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+// declare the static section of the file
+namespace
+{
+
+enum
+{
+    // a best effort scheduler waits for schedulers having the latency budget
+    // not longer than the following period of time (in msec).
+    MFX_POOL_STARVATION_PERIOD = 50
+};
+
+// task calls given to a scheduler per round, by the priority of its tasks
+const
+mfxU32 PoolPriorityWeight[MFX_PRIORITY_NUMBER] =
+{
+    // MFX_PRIORITY_LOW
+    1,
+    // MFX_PRIORITY_NORMAL
+    2,
+    // MFX_PRIORITY_HIGH
+    4
+};
+
+} // namespace
+
+mfxU32 mfxSchedulerPool::GetWeight(const mfxSchedulerCore *pCore)
+{
+    const int priority = pCore->m_poolPriority;
+
+    return ((MFX_PRIORITY_LOW <= priority) && (MFX_PRIORITY_HIGH >= priority)) ?
+        (PoolPriorityWeight[priority]) :
+        (PoolPriorityWeight[MFX_PRIORITY_NORMAL]);
+
+} // mfxU32 mfxSchedulerPool::GetWeight(const mfxSchedulerCore *pCore)
+
+mfxSchedulerPool & mfxSchedulerPool::Instance(void)
+{
+    static mfxSchedulerPool pool;
+
+    return pool;
+
+} // mfxSchedulerPool & mfxSchedulerPool::Instance(void)
+
+mfxSchedulerPool::mfxSchedulerPool(void)
+    : m_numThreads(std::max<mfxU32>(vm_sys_info_get_cpu_num(), 2))
+    , m_cursor(0)
+    , m_numDeadlineClients(0)
+    , m_starvationPeriod((mfxU64) vm_time_get_frequency() * MFX_POOL_STARVATION_PERIOD / 1000)
+    , m_stamp(0)
+    , m_numWaiting(0)
+    , m_bQuit(false)
+{
+} // mfxSchedulerPool::mfxSchedulerPool(void)
+
+mfxSchedulerPool::~mfxSchedulerPool(void)
+{
+    std::unique_lock<std::mutex> guard(m_guard);
+
+    // schedulers are not released, there is nobody to serve
+    Stop(guard);
+
+    for (auto pClient : m_clients)
+    {
+        delete pClient;
+    }
+    m_clients.clear();
+
+} // mfxSchedulerPool::~mfxSchedulerPool(void)
+
+void mfxSchedulerPool::Start(void)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    m_threads.reserve(m_numThreads);
+    while (m_threads.size() < m_numThreads)
+    {
+        m_threads.emplace_back(&mfxSchedulerPool::ThreadProc, this, (mfxU32) m_threads.size());
+    }
+
+} // void mfxSchedulerPool::Start(void)
+
+void mfxSchedulerPool::Stop(std::unique_lock<std::mutex>& guard)
+{
+    std::vector<std::thread> threads;
+
+    if (m_threads.empty())
+    {
+        return;
+    }
+
+    // set the 'quit' flag for threads
+    m_bQuit = true;
+    m_workAdded.notify_all();
+    threads.swap(m_threads);
+
+    // temporarily leave the protected code section
+    guard.unlock();
+    for (auto & thread : threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    guard.lock();
+
+    // let the waiting Register proceed
+    m_bQuit = false;
+    m_clientIdle.notify_all();
+
+} // void mfxSchedulerPool::Stop(std::unique_lock<std::mutex>& guard)
+
+void mfxSchedulerPool::Register(mfxSchedulerCore *pCore)
+{
+    std::unique_lock<std::mutex> guard(m_guard);
+    Client *pClient = new Client();
+
+    pClient->pCore = pCore;
+    pClient->credit = GetWeight(pCore);
+    pClient->active = 0;
+    pClient->idleStamp = (mfxU64) -1;
+    pClient->timeServed = vm_time_get_tick();
+
+    // wait the threads stopped by the last Unregister
+    m_clientIdle.wait(guard, [this] { return !m_bQuit; });
+
+    try
+    {
+        m_clients.push_back(pClient);
+        Start();
+    }
+    catch (...)
+    {
+        m_clients.erase(std::remove(m_clients.begin(), m_clients.end(), pClient), m_clients.end());
+        delete pClient;
+        throw;
+    }
+
+    m_numDeadlineClients += (pCore->m_deadlineBudget) ? (1) : (0);
+
+} // void mfxSchedulerPool::Register(mfxSchedulerCore *pCore)
+
+void mfxSchedulerPool::Unregister(mfxSchedulerCore *pCore)
+{
+    std::unique_lock<std::mutex> guard(m_guard);
+
+    auto it = std::find_if(m_clients.begin(), m_clients.end(),
+        [pCore](const Client *pClient) { return pClient->pCore == pCore; });
+    if (m_clients.end() == it)
+    {
+        return;
+    }
+
+    Client *pClient = *it;
+
+    // the client can't be picked any more,
+    // wait for threads which are working for it.
+    m_clients.erase(it);
+    m_cursor = 0;
+    m_numDeadlineClients -= (pCore->m_deadlineBudget) ? (1) : (0);
+    m_clientIdle.wait(guard, [pClient] { return 0 == pClient->active; });
+    delete pClient;
+
+    if (m_clients.empty())
+    {
+        Stop(guard);
+    }
+
+} // void mfxSchedulerPool::Unregister(mfxSchedulerCore *pCore)
+
+void mfxSchedulerPool::Notify(mfxU32 numThreads)
+{
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    m_stamp += 1;
+
+    if (numThreads >= m_numWaiting)
+    {
+        m_workAdded.notify_all();
+    }
+    else
+    {
+        while (numThreads--)
+        {
+            m_workAdded.notify_one();
+        }
+    }
+
+} // void mfxSchedulerPool::Notify(mfxU32 numThreads)
+
+mfxSchedulerPool::Client *mfxSchedulerPool::Pick(void)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    // the timer is not read, until there are schedulers with the latency budget
+    if (0 == m_numDeadlineClients)
+    {
+        return PickByWeight();
+    }
+
+    const mfxU64 now = vm_time_get_tick();
+    Client *pClient = PickByDeadline(now);
+
+    if (NULL == pClient)
+    {
+        pClient = PickByWeight();
+    }
+    if (pClient)
+    {
+        pClient->timeServed = now;
+    }
+
+    return pClient;
+
+} // mfxSchedulerPool::Client *mfxSchedulerPool::Pick(void)
+
+mfxSchedulerPool::Client *mfxSchedulerPool::PickByDeadline(const mfxU64 now)
+{
+    const size_t numClients = m_clients.size();
+    Client *pEarliest = NULL;
+    Client *pStarving = NULL;
+    mfxU64 earliest = MFX_NO_DEADLINE;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    for (size_t i = 0; i < numClients; i += 1)
+    {
+        Client *pClient = m_clients[(m_cursor + i) % numClients];
+
+        if ((m_stamp == pClient->idleStamp) ||
+            (pClient->pCore->m_param.numberOfThreads <= pClient->active))
+        {
+            continue;
+        }
+
+        if (pClient->pCore->m_deadlineBudget)
+        {
+            // the deadline is updated by the scheduler under its own lock,
+            // the value may be a bit outdated, it is alright.
+            const mfxU64 deadline = pClient->pCore->m_poolDeadline;
+
+            if (deadline < earliest)
+            {
+                earliest = deadline;
+                pEarliest = pClient;
+            }
+        }
+        else if ((now - pClient->timeServed >= m_starvationPeriod) &&
+                 ((NULL == pStarving) || (pClient->timeServed < pStarving->timeServed)))
+        {
+            pStarving = pClient;
+        }
+    }
+
+    return (pStarving) ? (pStarving) : (pEarliest);
+
+} // mfxSchedulerPool::Client *mfxSchedulerPool::PickByDeadline(const mfxU64 now)
+
+mfxSchedulerPool::Client *mfxSchedulerPool::PickByWeight(void)
+{
+    const size_t numClients = m_clients.size();
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    // on the first run clients having credits are examined,
+    // if there are clients to try but all of them spent their credits,
+    // credits are refilled and clients are examined again.
+    for (mfxU32 run = 0; run < 2; run += 1)
+    {
+        bool bSpent = false;
+
+        for (size_t i = 0; i < numClients; i += 1)
+        {
+            const size_t idx = (m_cursor + i) % numClients;
+            Client *pClient = m_clients[idx];
+
+            // nothing to run since the last look,
+            // or the scheduler is already served by enough threads
+            if ((m_stamp == pClient->idleStamp) ||
+                (pClient->pCore->m_param.numberOfThreads <= pClient->active))
+            {
+                continue;
+            }
+
+            if (0 == pClient->credit)
+            {
+                bSpent = true;
+                continue;
+            }
+
+            pClient->credit -= 1;
+            m_cursor = (idx + 1) % numClients;
+
+            return pClient;
+        }
+
+        if (false == bSpent)
+        {
+            break;
+        }
+
+        // start the next round
+        for (auto pClient : m_clients)
+        {
+            pClient->credit = GetWeight(pClient->pCore);
+        }
+    }
+
+    return NULL;
+
+} // mfxSchedulerPool::Client *mfxSchedulerPool::PickByWeight(void)
+
+void mfxSchedulerPool::ThreadProc(const mfxU32 threadNum)
+{
+    std::unique_lock<std::mutex> guard(m_guard);
+
+    {
+        char thread_name[30] = {};
+        snprintf(thread_name, sizeof(thread_name)-1, "ThreadName=MSDKPOOL#%d", threadNum);
+        MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_SCHED, thread_name);
+    }
+
+    // main working cycle for threads
+    while (false == m_bQuit)
+    {
+        const mfxU64 stamp = m_stamp;
+        Client *pClient = Pick();
+
+        if (pClient)
+        {
+            pClient->active += 1;
+
+            guard.unlock();
+            const bool bDone = pClient->pCore->RunPoolTask();
+            guard.lock();
+
+            pClient->active -= 1;
+
+            if (bDone)
+            {
+                // the scheduler state has been changed by the call
+                m_stamp += 1;
+            }
+            else
+            {
+                // return the unused credit
+                pClient->credit += 1;
+                if (stamp == m_stamp)
+                {
+                    pClient->idleStamp = m_stamp;
+                }
+            }
+
+            if (0 == pClient->active)
+            {
+                m_clientIdle.notify_all();
+            }
+        }
+        else
+        {
+            // there is no any task.
+            // sleep for a while until something is changed.
+            m_numWaiting += 1;
+            m_workAdded.wait(guard, [this, stamp] { return m_bQuit || (stamp != m_stamp); });
+            m_numWaiting -= 1;
+        }
+    }
+
+} // void mfxSchedulerPool::ThreadProc(const mfxU32 threadNum)
@@ -23,12 +23,43 @@
 
 
 #include <memory.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <chrono>
+
+namespace
+{
+
+// sleep while the word holds the value. Spurious wake ups are possible.
+inline
+void FutexWait(std::atomic<mfxU32> *pWord, mfxU32 value, const struct timespec *pTimeout)
+{
+    syscall(SYS_futex, pWord, FUTEX_WAIT_PRIVATE, value, pTimeout, NULL, 0);
+}
+
+inline
+void FutexWakeAll(std::atomic<mfxU32> *pWord)
+{
+    syscall(SYS_futex, pWord, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+} // namespace
 
 MFX_SCHEDULER_TASK::MFX_SCHEDULER_TASK(mfxU32 taskID, mfxSchedulerCore *pSchedulerCore) :
+    pNext(NULL),
+    pPrev(NULL),
+    opRes(MFX_ERR_NONE),
+    curStatus(MFX_TASK_DONE),
     taskID(taskID),
     jobID(0),
-    pNext(NULL),
-    m_pSchedulerCore(pSchedulerCore)
+    m_pSchedulerCore(pSchedulerCore),
+    jobState(0),
+    doneCounter(0),
+    numWaiters(0)
 {
     // reset task parameters
     memset(&param, 0, sizeof(param));
@@ -44,6 +75,9 @@ mfxStatus MFX_SCHEDULER_TASK::Reset(void)
     opRes = MFX_WRN_IN_EXECUTION;
     curStatus = MFX_TASK_WORKING;
 
+    // the new job number is already assigned
+    PublishJobState();
+
     return MFX_ERR_NONE;
 
 } // mfxStatus MFX_SCHEDULER_TASK::Reset(void)
@@ -69,7 +103,7 @@ void MFX_SCHEDULER_TASK::OnDependencyResolved(mfxStatus result)
 
         // need to update dependency table for all tasks dependent from failed 
         m_pSchedulerCore->ResolveDependencyTable(this);
-        done.notify_all();
+        m_pSchedulerCore->OnTaskDone(this);
 
         // release the current task resources
         ReleaseResources();
@@ -121,3 +155,75 @@ void MFX_SCHEDULER_TASK::ReleaseResources(void)
     param.pThreadAssignment = NULL;
 
 } // void MFX_SCHEDULER_TASK::ReleaseResources(void)
+
+void MFX_SCHEDULER_TASK::PublishJobState(void)
+{
+    jobState = ((mfxU64) jobID << 32) | (mfxU32) opRes;
+
+} // void MFX_SCHEDULER_TASK::PublishJobState(void)
+
+void MFX_SCHEDULER_TASK::NotifyJobDone(void)
+{
+    PublishJobState();
+
+    // the counter is changed before checking the waiters, a thread going
+    // to sleep after the check sees the other futex value and doesn't sleep
+    doneCounter += 1;
+    if (numWaiters)
+    {
+        FutexWakeAll(&doneCounter);
+    }
+
+} // void MFX_SCHEDULER_TASK::NotifyJobDone(void)
+
+bool MFX_SCHEDULER_TASK::IsJobDone(mfxU32 jobNum, mfxStatus &jobRes) const
+{
+    const mfxU64 state = jobState;
+
+    // the task executes the next job already, we _lost_ the job status
+    // and can only assume that the job succeeded
+    if ((mfxU32) (state >> 32) != jobNum)
+    {
+        jobRes = MFX_ERR_NONE;
+        return true;
+    }
+
+    jobRes = (mfxStatus) (mfxI32) (mfxU32) state;
+    return (MFX_WRN_IN_EXECUTION != jobRes);
+
+} // bool MFX_SCHEDULER_TASK::IsJobDone(mfxU32 jobNum, mfxStatus &jobRes) const
+
+mfxStatus MFX_SCHEDULER_TASK::WaitForJob(mfxU32 jobNum, mfxU32 timeToWait)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeToWait);
+    mfxStatus jobRes = MFX_WRN_IN_EXECUTION;
+
+    numWaiters += 1;
+    for (;;)
+    {
+        // read the counter before the state, so a completion
+        // between the reads makes the futex wait to return at once
+        const mfxU32 counter = doneCounter;
+
+        if (IsJobDone(jobNum, jobRes))
+        {
+            break;
+        }
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+        {
+            break;
+        }
+
+        struct timespec timeout = {};
+        timeout.tv_sec = (time_t) (remaining / 1000000000);
+        timeout.tv_nsec = (long) (remaining % 1000000000);
+        FutexWait(&doneCounter, counter, &timeout);
+    }
+    numWaiters -= 1;
+
+    return jobRes;
+
+} // mfxStatus MFX_SCHEDULER_TASK::WaitForJob(mfxU32 jobNum, mfxU32 timeToWait)
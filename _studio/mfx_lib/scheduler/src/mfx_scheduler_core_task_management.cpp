@@ -24,6 +24,11 @@
 
 #include <vm_time.h>
 
+#include <algorithm>
+#include <climits>
+
+#include <sys/eventfd.h>
+
 // declare the static section of the file
 namespace
 {
@@ -50,6 +55,65 @@ enum
     MFX_WAIT_TIME_MS            = 1
 };
 
+enum
+{
+    // number of bins within every power of 2 of the latency histogram
+    MFX_LATENCY_STAT_SUBBINS    = 1 << MFX_LATENCY_STAT_SUBBINS_LOG2
+};
+
+// Get the bin of the latency histogram (in timer ticks). Small values have a bin each,
+// larger ones share the bin with values, which differ in less than
+// 1 / MFX_LATENCY_STAT_SUBBINS of the value.
+inline
+mfxU32 GetLatencyBin(mfxU32 latency)
+{
+    if (MFX_LATENCY_STAT_SUBBINS > latency)
+    {
+        return latency;
+    }
+
+    // position of the most significant bit
+    const mfxU32 msb = 31 - __builtin_clz(latency);
+    const mfxU32 shift = msb - MFX_LATENCY_STAT_SUBBINS_LOG2;
+
+    return ((shift + 1) << MFX_LATENCY_STAT_SUBBINS_LOG2) +
+           ((latency >> shift) & (MFX_LATENCY_STAT_SUBBINS - 1));
+
+} // mfxU32 GetLatencyBin(mfxU32 latency)
+
+// Get the largest latency of the bin
+inline
+mfxU32 GetLatencyBinValue(mfxU32 bin)
+{
+    if (MFX_LATENCY_STAT_SUBBINS > bin)
+    {
+        return bin;
+    }
+
+    const mfxU32 shift = (bin >> MFX_LATENCY_STAT_SUBBINS_LOG2) - 1;
+    const mfxU64 base = MFX_LATENCY_STAT_SUBBINS + (bin & (MFX_LATENCY_STAT_SUBBINS - 1));
+
+    return (mfxU32) (((base + 1) << shift) - 1);
+
+} // mfxU32 GetLatencyBinValue(mfxU32 bin)
+
+// Get the latency, which the given percent of tasks did not exceed
+mfxU32 GetLatencyPercentile(const MFX_TASKS_LATENCY &latency, mfxU32 percent)
+{
+    // the number of tasks within the percentile, rounded up
+    const mfxU64 rank = ((mfxU64) latency.numCompleted * percent + 99) / 100;
+    mfxU64 count = 0;
+    mfxU32 bin;
+
+    for (bin = 0; (bin < MFX_LATENCY_STAT_BINS) && (count < rank); bin += 1)
+    {
+        count += latency.bins[bin];
+    }
+
+    return (bin) ? (std::min(GetLatencyBinValue(bin - 1), latency.maxLatency)) : (0);
+
+} // mfxU32 GetLatencyPercentile(const MFX_TASKS_LATENCY &latency, mfxU32 percent)
+
 } // namespace
 
 int mfxSchedulerCore::GetTaskPriority(mfxTaskHandle task)
@@ -104,6 +168,117 @@ void mfxSchedulerCore::GetTimeStat(mfxU64 timeSpent[MFX_PRIORITY_NUMBER],
 
 } // void mfxSchedulerCore::GetTimeStat(mfxU64 totalTimeSpent[MFX_PRIORITY_NUMBER],
 
+MFX_THREADS_TIME &mfxSchedulerCore::GetCurrentTimeStat(void)
+{
+    const mfxU32 curTime = GetLowResCurrentTime();
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    if (m_workingTime[m_timeIdx].startTime + MFX_TIME_STAT_PERIOD / MFX_TIME_STAT_PARTS <
+        curTime)
+    {
+        // advance the working time index. The current entry is out of time.
+        m_timeIdx = (m_timeIdx + 1) % MFX_TIME_STAT_PARTS;
+        memset(m_workingTime + m_timeIdx, 0, sizeof(m_workingTime[m_timeIdx]));
+        m_workingTime[m_timeIdx].startTime = curTime;
+    }
+
+    return m_workingTime[m_timeIdx];
+
+} // MFX_THREADS_TIME &mfxSchedulerCore::GetCurrentTimeStat(void)
+
+void mfxSchedulerCore::UpdateLatencyStat(MFX_SCHEDULER_TASK *pTask, mfxU64 timeDone)
+{
+    MFX_TASKS_LATENCY &latency = m_workingTime[m_timeIdx].latency[GetTaskType(pTask)];
+    // the timer may go backward, when the system time is adjusted
+    const mfxU64 ticks = (timeDone > pTask->param.timing.timeAdded) ? (timeDone - pTask->param.timing.timeAdded) : (0);
+    const mfxU32 time = (mfxU32) std::min<mfxU64>(ticks, UINT_MAX);
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    latency.numCompleted += 1;
+    latency.maxLatency = std::max(latency.maxLatency, time);
+    latency.bins[GetLatencyBin(time)] += 1;
+
+} // void mfxSchedulerCore::UpdateLatencyStat(MFX_SCHEDULER_TASK *pTask, mfxU64 timeDone)
+
+void mfxSchedulerCore::GetTimeStat(MFX_SCHEDULER_STAT &stat)
+{
+    auto TicksToUsec = [this](mfxU32 ticks) -> mfxU32
+    {
+        return (mfxU32) std::min<mfxU64>((mfxU64) ticks * 1000 / m_vmtick_msec_frequency, UINT_MAX);
+    };
+    const mfxU32 curTime = GetLowResCurrentTime();
+    mfxU64 threadTime[MFX_SCHEDULER_MAX_THREADS] = {};
+    mfxU64 totalTime = 0;
+    MFX_TASKS_LATENCY latency[MFX_TYPE_NUMBER];
+    mfxU32 i, type;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    memset(latency, 0, sizeof(latency));
+    stat.period = 0;
+
+    // sum up the items, which are not out of time
+    for (i = 0; i < MFX_TIME_STAT_PARTS; i += 1)
+    {
+        const MFX_THREADS_TIME &item = m_workingTime[i];
+        const mfxU32 age = curTime - (mfxU32) item.startTime;
+
+        if (MFX_TIME_STAT_PERIOD < age)
+        {
+            continue;
+        }
+        stat.period = std::max(stat.period, age);
+
+        for (mfxU32 thread = 0; thread < MFX_SCHEDULER_MAX_THREADS; thread += 1)
+        {
+            threadTime[thread] += item.threadTime[thread];
+            totalTime += item.threadTime[thread];
+        }
+        for (type = 0; type < MFX_TYPE_NUMBER; type += 1)
+        {
+            latency[type].numCompleted += item.latency[type].numCompleted;
+            latency[type].maxLatency = std::max(latency[type].maxLatency, item.latency[type].maxLatency);
+            for (mfxU32 bin = 0; bin < MFX_LATENCY_STAT_BINS; bin += 1)
+            {
+                latency[type].bins[bin] += item.latency[type].bins[bin];
+            }
+        }
+    }
+
+    // busy time is measured in 1/100 of percent of the period
+    const mfxU64 period = std::max<mfxU64>(stat.period, 1) * m_vmtick_msec_frequency;
+
+    stat.load = (mfxU32) (totalTime * 10000 / period);
+    for (i = 0; i < stat.numberOfThreads; i += 1)
+    {
+        // the call is accounted at its end, it may start before the period
+        stat.threadBusy[i] = (mfxU32) std::min<mfxU64>(threadTime[i] * 10000 / period, 10000);
+    }
+
+    for (type = 0; type < MFX_TYPE_NUMBER; type += 1)
+    {
+        MFX_SCHEDULER_TASK_STAT &taskStat = stat.task[type];
+
+        taskStat.numCompleted = latency[type].numCompleted;
+        taskStat.latency50 = TicksToUsec(GetLatencyPercentile(latency[type], 50));
+        taskStat.latency90 = TicksToUsec(GetLatencyPercentile(latency[type], 90));
+        taskStat.latency99 = TicksToUsec(GetLatencyPercentile(latency[type], 99));
+        taskStat.latencyMax = TicksToUsec(latency[type].maxLatency);
+    }
+
+} // void mfxSchedulerCore::GetTimeStat(MFX_SCHEDULER_STAT &stat)
+
 enum
 {
     // on the first run when the scheduler tries to get a task,
@@ -127,6 +302,20 @@ mfxStatus mfxSchedulerCore::GetTask(MFX_CALL_INFO &callInfo,
     // get the current time stamp
     m_currentTimeStamp = GetHighPerformanceCounter();
 
+    // tasks having the deadline are run earliest deadline first,
+    // the priority of tasks is not taken into account.
+    if (m_deadlineBudget)
+    {
+        MFX_SCHEDULER_TASK *pTask = GetEarliestDeadlineTask(threadNum);
+
+        if (pTask)
+        {
+            return WrapUpTask(callInfo, pTask, threadNum);
+        }
+
+        return MFX_ERR_NOT_FOUND;
+    }
+
     // get time spent statistic
     GetTimeStat(timeSpent, totalTimeSpent);
 
@@ -163,7 +352,7 @@ mfxStatus mfxSchedulerCore::GetTask(MFX_CALL_INFO &callInfo,
                      type <= MFX_TYPE_SOFTWARE;
                      type += 1)
                 {
-                    MFX_SCHEDULER_TASK *pTask = m_pTasks[priority][type];
+                    MFX_SCHEDULER_TASK *pTask = m_taskQueues[priority][type].pHead;
 
                     // try to continue the previous task
                     if (prevTaskPriority == priority)
@@ -207,6 +396,95 @@ mfxStatus mfxSchedulerCore::GetTask(MFX_CALL_INFO &callInfo,
 
 } // mfxStatus mfxSchedulerCore::GetTask(MFX_CALL_INFO &callInfo,
 
+MFX_SCHEDULER_TASK *mfxSchedulerCore::GetEarliestDeadlineTask(const mfxU32 threadNum)
+{
+    MFX_SCHEDULER_TASK *pEarliest = nullptr;
+    int priority;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    // all tasks have the same budget and queues keep the order of adding,
+    // so the first ready task of a queue is the earliest one in the queue.
+    for (priority = MFX_PRIORITY_HIGH;
+         priority >= MFX_PRIORITY_LOW;
+         priority -= 1)
+    {
+        int type;
+
+        for (type = (threadNum) ? (MFX_TYPE_SOFTWARE) : (MFX_TYPE_HARDWARE);
+             type <= MFX_TYPE_SOFTWARE;
+             type += 1)
+        {
+            MFX_SCHEDULER_TASK *pTask = m_taskQueues[priority][type].pHead;
+
+            // tasks later than the found one are not examined
+            while ((pTask) &&
+                   ((nullptr == pEarliest) ||
+                    (pTask->param.timing.deadline < pEarliest->param.timing.deadline)))
+            {
+                if ((IsReadyToRun(pTask)) &&
+                    ((0 == threadNum) ||
+                     (0 == (MFX_TASK_DEDICATED & pTask->param.pThreadAssignment->threadingPolicy))))
+                {
+                    pEarliest = pTask;
+                    break;
+                }
+
+                // get the next task
+                pTask = pTask->pNext;
+            }
+        }
+    }
+
+    return pEarliest;
+
+} // MFX_SCHEDULER_TASK *mfxSchedulerCore::GetEarliestDeadlineTask(const mfxU32 threadNum)
+
+void mfxSchedulerCore::UpdatePoolDeadline(void)
+{
+    mfxU64 deadline = MFX_NO_DEADLINE;
+    int priority;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    if ((MFX_SCHEDULER_SHARED_POOL != m_param.flags) || (0 == m_deadlineBudget))
+    {
+        return;
+    }
+
+    for (priority = MFX_PRIORITY_HIGH;
+         priority >= MFX_PRIORITY_LOW;
+         priority -= 1)
+    {
+        int type;
+
+        for (type = MFX_TYPE_HARDWARE; type <= MFX_TYPE_SOFTWARE; type += 1)
+        {
+            MFX_SCHEDULER_TASK *pTask = m_taskQueues[priority][type].pHead;
+
+            // skip failed tasks, which wait for the scrubbing
+            while ((pTask) && (MFX_TASK_NEED_CONTINUE != pTask->curStatus))
+            {
+                pTask = pTask->pNext;
+            }
+
+            if ((pTask) && (pTask->param.timing.deadline < deadline))
+            {
+                deadline = pTask->param.timing.deadline;
+            }
+        }
+    }
+
+    m_poolDeadline = deadline;
+
+} // void mfxSchedulerCore::UpdatePoolDeadline(void)
+
 mfxStatus mfxSchedulerCore::CanContinuePreviousTask(MFX_CALL_INFO &callInfo,
                                                     mfxTaskHandle previousTask,
                                                     const mfxU32 threadNum)
@@ -285,6 +563,10 @@ bool mfxSchedulerCore::IsReadyToRun(MFX_SCHEDULER_TASK *pTask)
     if (MFX_INVALID_THREAD_NUMBER == GetFreeThreadNumber(*(pTask->param.pThreadAssignment), pTask)) {
         return false;
     }
+    // or task waits for the device to signal the completion
+    if (pTask->param.bWaitingCompletion) {
+        return false;
+    }
     // or task is still waiting
     if (pTask->param.bWaiting) {
         // prevent entering more than 1 thread in 'waiting' task,
@@ -387,6 +669,144 @@ void mfxSchedulerCore::ResetWaitingTasks(const void *pOwner)
     );
 } // void mfxSchedulerCore::ResetWaitingTasks(const void *pOwner)
 
+MFX_SCHEDULER_TASK *mfxSchedulerCore::FindWorkingTask(const void *pOwner, const void *pParam)
+{
+    MFX_SCHEDULER_TASK *pFound = NULL;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    ForEachTaskWhile(
+        [pOwner, pParam, &pFound](MFX_SCHEDULER_TASK* task)
+        {
+            if ((task->param.task.pOwner == pOwner) &&
+                (task->param.task.entryPoint.pParam == pParam) &&
+                (MFX_TASK_NEED_CONTINUE == task->curStatus))
+            {
+                pFound = task;
+            }
+            return (NULL == pFound);
+        }
+    );
+
+    return pFound;
+
+} // MFX_SCHEDULER_TASK *mfxSchedulerCore::FindWorkingTask(const void *pOwner, const void *pParam)
+
+MFX_SCHEDULER_TASK *mfxSchedulerCore::FindWorkingEntryPoint(const void *pState, const void *pParam)
+{
+    MFX_SCHEDULER_TASK *pFound = NULL;
+
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    ForEachTaskWhile(
+        [pState, pParam, &pFound](MFX_SCHEDULER_TASK* task)
+        {
+            if ((task->param.task.entryPoint.pState == pState) &&
+                (task->param.task.entryPoint.pParam == pParam) &&
+                (MFX_TASK_NEED_CONTINUE == task->curStatus))
+            {
+                pFound = task;
+            }
+            return (NULL == pFound);
+        }
+    );
+
+    return pFound;
+
+} // MFX_SCHEDULER_TASK *mfxSchedulerCore::FindWorkingEntryPoint(const void *pState, const void *pParam)
+
+mfxStatus mfxSchedulerCore::AddCompletion(MFX_SCHEDULER_TASK *pTask, int fd)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    // the task is registered again, the previous handle is replaced
+    RemoveCompletion(pTask);
+
+    if (0 <= fd)
+    {
+        mfxStatus mfxRes = StartCompletionThread();
+        if (MFX_ERR_NONE != mfxRes)
+        {
+            return mfxRes;
+        }
+
+        MFX_SCHEDULER_COMPLETION completion = {fd, pTask};
+
+        m_completions.push_back(completion);
+
+        // let the completion thread poll the new handle
+        eventfd_write(m_completionEvent, 1);
+    }
+
+    pTask->param.bWaitingCompletion = true;
+    m_numWaitingCompletions += 1;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::AddCompletion(MFX_SCHEDULER_TASK *pTask, int fd)
+
+void mfxSchedulerCore::OnCompletion(MFX_SCHEDULER_TASK *pTask)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    RemoveCompletion(pTask);
+
+    // the device is done, don't let the current call result
+    // make the task 'waiting' again.
+    pTask->param.bWaiting = false;
+    pTask->param.timing.timeLastCallProcessed = pTask->param.timing.timeLastCallIssued + 1;
+
+    m_completionCounter += 1;
+    m_completionDone.notify_all();
+
+    // wake up a single thread able to run the task
+    if (IsReadyToRun(pTask))
+    {
+        if (MFX_TASK_DEDICATED & pTask->param.task.threadingPolicy)
+        {
+            WakeUpThreads(1, 0);
+        }
+        else
+        {
+            WakeUpThreads(0, 1);
+        }
+    }
+
+} // void mfxSchedulerCore::OnCompletion(MFX_SCHEDULER_TASK *pTask)
+
+void mfxSchedulerCore::RemoveCompletion(MFX_SCHEDULER_TASK *pTask)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    if (false == pTask->param.bWaitingCompletion)
+    {
+        return;
+    }
+
+    pTask->param.bWaitingCompletion = false;
+    m_numWaitingCompletions -= 1;
+
+    m_completions.erase(std::remove_if(m_completions.begin(), m_completions.end(),
+        [pTask](const MFX_SCHEDULER_COMPLETION &completion) { return completion.pTask == pTask; }),
+        m_completions.end());
+
+} // void mfxSchedulerCore::RemoveCompletion(MFX_SCHEDULER_TASK *pTask)
+
 void mfxSchedulerCore::OnDependencyResolved(MFX_SCHEDULER_TASK *pTask)
 {
     if (IsReadyToRun(pTask)) {
@@ -398,11 +818,35 @@ void mfxSchedulerCore::OnDependencyResolved(MFX_SCHEDULER_TASK *pTask)
     }
 }
 
+void mfxSchedulerCore::OnTaskDone(MFX_SCHEDULER_TASK *pTask)
+{
+    pTask->NotifyJobDone();
+
+    if (m_numMultipleWaiters)
+    {
+        m_taskDone.notify_all();
+    }
+
+} // void mfxSchedulerCore::OnTaskDone(MFX_SCHEDULER_TASK *pTask)
+
+bool mfxSchedulerCore::IsJobDone(mfxTaskHandle handle, mfxStatus &jobRes)
+{
+    MFX_SCHEDULER_TASK *pTask = m_ppTaskLookUpTable.at(handle.taskID);
+
+    if (nullptr == pTask)
+    {
+        jobRes = MFX_ERR_NULL_PTR;
+        return true;
+    }
+
+    return pTask->IsJobDone(handle.jobID, jobRes);
+
+} // bool mfxSchedulerCore::IsJobDone(mfxTaskHandle handle, mfxStatus &jobRes)
+
 void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
                                          const mfxU32 threadNum)
 {
     (void)pCallInfo;
-    (void)threadNum;
 
     MFX_SCHEDULER_TASK *pTask = nullptr;
     pTask = m_ppTaskLookUpTable.at(pCallInfo->taskHandle.taskID);
@@ -415,21 +859,13 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
 
     bool taskReleased = false;
     mfxU32 nTraceTaskId = 0;
-    mfxU32 curTime;
 
     MFX_THREAD_ASSIGNMENT &occupancyInfo = *(pTask->param.pThreadAssignment);
 
     // update working time
-    curTime = GetLowResCurrentTime();
-    if (m_workingTime[m_timeIdx].startTime + MFX_TIME_STAT_PERIOD / MFX_TIME_STAT_PARTS <
-        curTime)
-    {
-        // advance the working time index. The current entry is out of time.
-        m_timeIdx = (m_timeIdx + 1) % MFX_TIME_STAT_PARTS;
-        memset(m_workingTime + m_timeIdx, 0, sizeof(m_workingTime[m_timeIdx]));
-        m_workingTime[m_timeIdx].startTime = curTime;
-    }
-    m_workingTime[m_timeIdx].time[pTask->param.task.priority] += pCallInfo->timeSpend;
+    MFX_THREADS_TIME &timeStat = GetCurrentTimeStat();
+    timeStat.time[pTask->param.task.priority] += pCallInfo->timeSpend;
+    timeStat.threadTime[threadNum % MFX_SCHEDULER_MAX_THREADS] += pCallInfo->timeSpend;
 
     // update the scheduler
     m_numAssignedTasks[pTask->param.task.priority] -= 1;
@@ -457,6 +893,11 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
     {
         pTask->param.timing.timeLastCallProcessed = pCallInfo->timeStamp;
     }
+    // the task doesn't wait for the registered completion
+    if (MFX_TASK_BUSY != pCallInfo->res)
+    {
+        RemoveCompletion(pTask);
+    }
     // update the status of the current job
     if (isFailed(pCallInfo->res))
     {
@@ -531,7 +972,7 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
             // save the status
             pTask->opRes = pTask->curStatus;
 
-            pTask->done.notify_all();
+            OnTaskDone(pTask);
 
             // update dependencies produced from the dependency table
             //for (i = 0; i < MFX_TASK_NUM_DEPENDENCIES; i += 1)
@@ -561,7 +1002,14 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
             // save the status
             pTask->opRes = MFX_ERR_NONE;
 
-            pTask->done.notify_all();
+            // the end of the last call is taken as the completion time,
+            // it saves reading the timer for every task.
+            if (pTask->param.timing.timeAdded)
+            {
+                UpdateLatencyStat(pTask, pCallInfo->timeStamp + pCallInfo->timeSpend);
+            }
+
+            OnTaskDone(pTask);
 
             // remove dependencies produced from the dependency table
             for (i = 0; i < MFX_TASK_NUM_DEPENDENCIES; i += 1)
@@ -579,9 +1027,15 @@ void mfxSchedulerCore::MarkTaskCompleted(const MFX_CALL_INFO *pCallInfo,
             // release all allocated resources
             pTask->ReleaseResources();
 
-            // task object becomes free
+            // task object becomes free, it leaves the queue at once
+            GetTaskQueue(pTask).Remove(pTask);
+            pTask->pNext = m_pFreeTasks;
+            m_pFreeTasks = pTask;
             taskReleased = true;
         }
+
+        // the task does not hold the deadline of the scheduler any more
+        UpdatePoolDeadline();
     }
 
 
@@ -25,6 +25,12 @@
 #include <stdio.h>
 #include <vm_time.h>
 
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 
 mfxStatus mfxSchedulerCore::StartWakeUpThread(void)
 {
@@ -48,6 +54,62 @@ mfxStatus mfxSchedulerCore::StopWakeUpThread(void)
 
 } // mfxStatus mfxSchedulerCore::StopWakeUpThread(void)
 
+mfxStatus mfxSchedulerCore::StartCompletionThread(void)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    if (m_completionThread.joinable())
+    {
+        return MFX_ERR_NONE;
+    }
+
+    m_completionEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (0 > m_completionEvent)
+    {
+        return MFX_ERR_UNKNOWN;
+    }
+
+    try
+    {
+        m_bQuitCompletionThread = false;
+        m_completionThread = std::thread([this]() { CompletionThreadProc(); });
+    }
+    catch (...)
+    {
+        close(m_completionEvent);
+        m_completionEvent = -1;
+        return MFX_ERR_MEMORY_ALLOC;
+    }
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus mfxSchedulerCore::StartCompletionThread(void)
+
+void mfxSchedulerCore::StopCompletionThread(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        if (false == m_completionThread.joinable())
+        {
+            return;
+        }
+
+        // set the 'quit' flag for the thread and interrupt the polling
+        m_bQuitCompletionThread = true;
+        eventfd_write(m_completionEvent, 1);
+    }
+
+    m_completionThread.join();
+
+    close(m_completionEvent);
+    m_completionEvent = -1;
+
+} // void mfxSchedulerCore::StopCompletionThread(void)
+
 void mfxSchedulerCore::ThreadProc(MFX_SCHEDULER_THREAD_CONTEXT *pContext)
 {
     std::unique_lock<std::mutex> guard(m_guard);
@@ -112,6 +174,49 @@ void mfxSchedulerCore::ThreadProc(MFX_SCHEDULER_THREAD_CONTEXT *pContext)
     }
 }
 
+bool mfxSchedulerCore::RunPoolTask(void)
+{
+    std::unique_lock<std::mutex> guard(m_guard);
+    MFX_CALL_INFO call = {};
+    const mfxTaskHandle previousTaskHandle = {};
+    mfxStatus mfxRes;
+
+    // any pool thread may play the role of the dedicated thread 0,
+    // but dedicated tasks are run by one thread at a time.
+    const mfxU32 threadNum = (m_bPoolDedicatedBusy) ? (1) : (0);
+
+    mfxRes = GetTask(call, previousTaskHandle, threadNum);
+    if (MFX_ERR_NONE != mfxRes)
+    {
+        return false;
+    }
+
+    const bool bDedicated = (0 != (MFX_TASK_DEDICATED & call.pTask->threadingPolicy));
+    if (bDedicated)
+    {
+        m_bPoolDedicatedBusy = true;
+    }
+
+    guard.unlock();
+    {
+        // perform asynchronous operation
+        call_pRoutine(call);
+    }
+    guard.lock();
+
+    if (bDedicated)
+    {
+        m_bPoolDedicatedBusy = false;
+    }
+
+    // mark the task completed,
+    // set the sync point into the high state if any.
+    MarkTaskCompleted(&call, threadNum);
+
+    return true;
+
+} // bool mfxSchedulerCore::RunPoolTask(void)
+
 void mfxSchedulerCore::WakeupThreadProc()
 {
     {
@@ -142,3 +247,81 @@ void mfxSchedulerCore::WakeupThreadProc()
         }
     }
 }
+
+void mfxSchedulerCore::CompletionThreadProc(void)
+{
+    std::vector<MFX_SCHEDULER_COMPLETION> completions;
+    std::vector<pollfd> fds;
+
+    {
+        const char thread_name[30] = "ThreadName=MSDKCMPL#0";
+        (void)thread_name;
+        MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_SCHED, thread_name);
+    }
+
+    // main working cycle for the thread
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_guard);
+
+            if (m_bQuitCompletionThread)
+            {
+                break;
+            }
+            // take a copy, handles may be added or removed while polling
+            completions = m_completions;
+        }
+
+        // the first entry is the event interrupting the polling
+        fds.resize(completions.size() + 1);
+        fds[0].fd = m_completionEvent;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        for (size_t i = 0; i < completions.size(); i += 1)
+        {
+            fds[i + 1].fd = completions[i].fd;
+            fds[i + 1].events = POLLIN;
+            fds[i + 1].revents = 0;
+        }
+
+        if (0 > poll(fds.data(), fds.size(), -1))
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[0].revents)
+        {
+            eventfd_t value;
+            eventfd_read(m_completionEvent, &value);
+        }
+
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        for (size_t i = 0; i < completions.size(); i += 1)
+        {
+            // any event is taken as signaled, so a broken handle
+            // lets the task get the error on its own.
+            if (0 == fds[i + 1].revents)
+            {
+                continue;
+            }
+
+            // the handle might be removed after the copy was taken
+            const MFX_SCHEDULER_COMPLETION &completion = completions[i];
+            auto it = std::find_if(m_completions.begin(), m_completions.end(),
+                [&completion](const MFX_SCHEDULER_COMPLETION &registered)
+                { return (registered.fd == completion.fd) && (registered.pTask == completion.pTask); });
+
+            if (m_completions.end() != it)
+            {
+                OnCompletion(completion.pTask);
+            }
+        }
+    }
+
+} // void mfxSchedulerCore::CompletionThreadProc(void)
@@ -167,6 +167,13 @@ namespace MfxHwH264Encode
         virtual
         mfxStatus SetEncCtrlCaps(
             ENCODE_ENC_CTRL_CAPS const & /*caps*/) { return MFX_ERR_UNSUPPORTED; };
+
+        // pollable handle signaled when the task queried with MFX_WRN_DEVICE_BUSY
+        // is done, valid until QueryStatus reports it done, -1 - the device has none
+        virtual
+        int GetCompletionHandle(
+            DdiTask const & /*task*/,
+            mfxU32          /*fieldId*/) { return -1; };
     };
 
     DriverEncoder* CreatePlatformH264Encoder( VideoCORE* core ); 
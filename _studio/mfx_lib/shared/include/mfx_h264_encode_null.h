@@ -0,0 +1,147 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MFX_H264_ENCODE_NULL__H
+#define __MFX_H264_ENCODE_NULL__H
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_H264_VIDEO_ENCODE_HW) && defined (MFX_VA_LINUX)
+
+#include "umc_mutex.h"
+
+#include "mfx_h264_encode_interface.h"
+#include "mfx_h264_encode_hw_utils.h"
+
+#include <chrono>
+
+namespace MfxHwH264Encode
+{
+    // Encoder of the null device (see libmfx_core_null.h). Nothing is encoded,
+    // a task is reported completed the device latency after its submission
+    // with a canned bitstream (access unit delimiter and filler data)
+    // of the size the rate control targets. Until then the task is busy,
+    // the timer of the task is its completion handle.
+    class NullEncoder : public DriverEncoder
+    {
+    public:
+        NullEncoder();
+
+        virtual
+        ~NullEncoder();
+
+        virtual
+        mfxStatus CreateAuxilliaryDevice(
+            VideoCORE* core,
+            GUID       guid,
+            mfxU32     width,
+            mfxU32     height,
+            bool       isTemporal = false) override;
+
+        virtual
+        mfxStatus CreateAccelerationService(
+            MfxVideoParam const & par) override;
+
+        virtual
+        mfxStatus Reset(
+            MfxVideoParam const & par) override;
+
+        virtual
+        mfxStatus Register(
+            mfxFrameAllocResponse& response,
+            D3DDDIFORMAT type) override;
+
+        virtual
+        mfxStatus Execute(
+            mfxHDLPair      pair,
+            DdiTask const & task,
+            mfxU32          fieldId,
+            PreAllocatedVector const & sei) override;
+
+        virtual
+        mfxStatus QueryCompBufferInfo(
+            D3DDDIFORMAT           type,
+            mfxFrameAllocRequest& request) override;
+
+        virtual
+        mfxStatus QueryEncodeCaps(
+            MFX_ENCODE_CAPS& caps) override;
+
+        virtual
+        mfxStatus QueryMbPerSec(
+            mfxVideoParam const & par,
+            mfxU32              (&mbPerSec)[16]) override;
+
+        virtual
+        mfxStatus QueryStatus(
+            DdiTask & task,
+            mfxU32    fieldId) override;
+
+        virtual
+        int GetCompletionHandle(
+            DdiTask const & task,
+            mfxU32          fieldId) override;
+
+        virtual
+        mfxStatus Destroy() override;
+
+        void ForceCodingFunction (mfxU16 /*codingFunction*/) override
+        {
+            // no need in it on the null device
+        }
+
+        virtual
+        mfxStatus QueryHWGUID(
+            VideoCORE * core,
+            GUID        guid,
+            bool        isTemporal) override;
+
+    private:
+        NullEncoder(const NullEncoder&);
+        NullEncoder& operator=(const NullEncoder&);
+
+        // size of the canned bitstream of a field or a frame
+        static mfxU32 GetCodedSize(MfxVideoParam const & par);
+
+        struct Feedback
+        {
+            mfxU32 number;
+            mfxU32 idxBs;
+            std::chrono::steady_clock::time_point due;
+            // timerfd expiring at the due time, -1 - no latency
+            int    fd;
+        };
+
+        VideoCORE*                m_core;
+        MFX_ENCODE_CAPS           m_caps;
+        std::chrono::microseconds m_latency;
+        mfxU32                    m_width;
+        mfxU32                    m_height;
+        mfxU32                    m_codedSize;
+
+        std::vector<mfxMemId>     m_bsQueue;
+        std::vector<Feedback>     m_feedbackCache;
+        UMC::Mutex                m_guard;
+    };
+
+}; // namespace
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW && MFX_VA_LINUX
+#endif // __MFX_H264_ENCODE_NULL__H
@@ -24,6 +24,7 @@
 #include <mfxvideo.h>
 #include <mfx_interface.h>
 #include <mfxvideo++int.h>
+#include <mfx_task.h>
 
 #include <memory.h>
 
@@ -37,11 +38,19 @@ static const
 MFX_GUID MFXIScheduler2_GUID =
 { 0xdc775b1c, 0x951d, 0x421f, { 0xbf, 0xd8, 0xca, 0x56, 0x2d, 0x95, 0xa4, 0x18 } };
 
+// {5A3E1F0C-7B2D-4C61-9E84-0D6F2B93C1A7}
+static const
+MFX_GUID MFXIScheduler3_GUID =
+{ 0x5a3e1f0c, 0x7b2d, 0x4c61, { 0x9e, 0x84, 0x0d, 0x6f, 0x2b, 0x93, 0xc1, 0xa7 } };
+
 enum mfxSchedulerFlags
 {
     // default behaviour policy
     MFX_SCHEDULER_DEFAULT = 0,
-    MFX_SINGLE_THREAD = 1
+    MFX_SINGLE_THREAD = 1,
+    // tasks are executed by the process-wide pool of threads,
+    // which is shared with other schedulers of the same mode
+    MFX_SCHEDULER_SHARED_POOL = 2
 };
 
 enum mfxSchedulerMessage
@@ -68,6 +77,54 @@ struct MFX_SCHEDULER_PARAM
 
 #pragma pack()
 
+enum
+{
+    // the maximum number of threads of a scheduler (see MFX_SCHEDULER_TASK::param.threadMask)
+    MFX_SCHEDULER_MAX_THREADS = 64,
+    // number of task types the statistic is gathered for, hardware and software
+    MFX_SCHEDULER_STAT_TASK_TYPES = 2
+};
+
+// Statistic of the tasks of one type
+struct MFX_SCHEDULER_TASK_STAT
+{
+    // Number of tasks added and not completed yet
+    mfxU32 numQueued;
+    // Number of tasks ready to run, no thread executes them
+    mfxU32 numReady;
+    // Number of tasks executed by threads
+    mfxU32 numRunning;
+    // Number of tasks waiting for the device
+    mfxU32 numWaiting;
+    // Number of tasks waiting for other tasks (unresolved dependencies)
+    mfxU32 numBlocked;
+    // Number of tasks completed within the statistic period
+    mfxU32 numCompleted;
+    // Percentiles of the time from AddTask to the task completion (usec)
+    mfxU32 latency50;
+    mfxU32 latency90;
+    mfxU32 latency99;
+    mfxU32 latencyMax;
+};
+
+// Live statistic of the scheduler. Queue counters are taken at the moment,
+// the time statistic is gathered within the last couple of seconds.
+struct MFX_SCHEDULER_STAT
+{
+    // Period of time the statistic is gathered within (msec)
+    mfxU32 period;
+    // Overall time spent by the threads in tasks in 1/100 of percent of the period,
+    // 10000 is one busy thread.
+    mfxU32 load;
+    // Number of threads owned by the scheduler. It is zero in the single thread
+    // mode and in the shared pool mode, there are no threads of its own.
+    mfxU32 numberOfThreads;
+    // Busy time of every thread in 1/100 of percent of the period
+    mfxU32 threadBusy[MFX_SCHEDULER_MAX_THREADS];
+    // Statistic of hardware and software tasks (MFX_TYPE_HARDWARE, MFX_TYPE_SOFTWARE)
+    MFX_SCHEDULER_TASK_STAT task[MFX_SCHEDULER_STAT_TASK_TYPES];
+};
+
 // Forward declaration of used classes
 struct MFX_TASK;
 //class VideoCORE;
@@ -123,10 +180,25 @@ public:
 
 };
 
+enum
+{
+    // threads and memory are not placed, the default
+    MFX_NUMA_NODE_ANY = 0,
+    // the scheduler picks the node, sessions are spread over nodes
+    MFX_NUMA_NODE_AUTO = 0xffffffff
+    // node N is requested as N + 1
+};
+
 struct MFX_SCHEDULER_PARAM2: public MFX_SCHEDULER_PARAM
 {
     // user-adjustable extended parameters
     mfxExtThreadsParam params;
+    // NUMA node for working threads and system memory of the session
+    mfxU32 numaNode;
+    // latency budget of tasks in usec. The deadline of a task is the time
+    // it is added plus the budget, tasks are run earliest deadline first.
+    // 0 - the best effort scheduling by the priority of tasks, the default.
+    mfxU32 latencyBudget;
 };
 
 class MFXIScheduler2 : public MFXIScheduler
@@ -142,4 +214,54 @@ public:
     mfxStatus GetTimeout(mfxU32 & maxTimeToRun) = 0;
 };
 
+// MFXIScheduler3 interface.
+// The interface extends MFXIScheduler2 with batched submission, completion
+// handles and statistic. It is a separate interface to keep the vtables
+// of MFXIScheduler and MFXIScheduler2 unchanged.
+
+class MFXIScheduler3 : public MFXIScheduler2
+{
+public:
+    // Add several tasks in one transaction. Tasks are registered in the given
+    // order, so they may depend on the earlier ones. If a task fails to be added,
+    // the tasks before it stay in the scheduler, their number is returned in pNumAdded.
+    virtual
+    mfxStatus AddTasks(const MFX_TASK *pTasks, mfxU32 numTasks,
+                       mfxSyncPoint *pSyncPoints, mfxU32 *pNumAdded) = 0;
+
+    // Wait until all (waitAll) or any of the tasks is done. NULL sync points
+    // are skipped. The index of the done task or the failed one is returned
+    // in pIndex, which is optional when all tasks are waited for.
+    virtual
+    mfxStatus SynchronizeMultiple(const mfxSyncPoint *pSyncPoints, mfxU32 numSyncPoints,
+                                  bool waitAll, mfxU32 timeToWait, mfxU32 *pIndex) = 0;
+
+    // Make the running task of specified owner and parameters wait for
+    // the completion handle. The task returning MFX_TASK_BUSY is not called
+    // again until the handle is signaled. 'fd' is a pollable handle (eventfd,
+    // sync file), it is only polled and must be valid until the task is called.
+    // -1 means the completion is signaled by SignalCompletion.
+    virtual
+    mfxStatus RegisterCompletion(const void *pOwner, const void *pParam, int fd) = 0;
+
+    // Signal the completion which the task of specified owner and parameters waits for
+    virtual
+    mfxStatus SignalCompletion(const void *pOwner, const void *pParam) = 0;
+
+    // Make the running task of specified entry point state and parameters
+    // continue at 'pRoutine' instead of being re-entered at the beginning.
+    // The task routine calls it before returning MFX_TASK_BUSY, the next call
+    // of the task goes to the continuation. 'fd' is the completion handle
+    // the task waits for as in RegisterCompletion, -1 - no wait. The task must
+    // be executed by a single thread at a time (requiredNumThreads is 1).
+    virtual
+    mfxStatus SetContinuation(const void *pState, const void *pParam,
+                              mfxTaskRoutine pRoutine, int fd) = 0;
+
+    // Get the live statistic of the scheduler. It is cheap enough
+    // to be polled a few times per second.
+    virtual
+    mfxStatus GetStat(MFX_SCHEDULER_STAT *pStat) = 0;
+};
+
 #endif // __MFX_INTERFACE_SCHEDULER_H
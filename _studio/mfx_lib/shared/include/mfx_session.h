@@ -160,6 +160,18 @@ struct _mfxSession
         return (NULL == m_pSchedulerAllocated);
     }
 
+    // Get the extended interface of the scheduler being used.
+    // The reference is held by m_pScheduler, NULL if it is not supported.
+    inline
+    MFXIScheduler3 *GetScheduler3(void)
+    {
+        MFXIScheduler3 *pScheduler = (MFXIScheduler3 *) m_pScheduler->QueryInterface(MFXIScheduler3_GUID);
+
+        if (pScheduler)
+            pScheduler->Release();
+        return pScheduler;
+    }
+
     template<class T>
     T* Create(mfxVideoParam& par);
 
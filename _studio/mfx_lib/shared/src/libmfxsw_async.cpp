@@ -22,6 +22,9 @@
 #include <mfx_session.h>
 #include <mfx_trace.h>
 #include <mfx_utils.h>
+#include <mfx_task.h>
+
+#include <algorithm>
 
 mfxStatus MFXVideoCORE_SyncOperation(mfxSession session, mfxSyncPoint syncp, mfxU32 wait)
 {
@@ -45,3 +48,89 @@ mfxStatus MFXVideoCORE_SyncOperation(mfxSession session, mfxSyncPoint syncp, mfx
 
     return mfxRes;
 }
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+mfxStatus MFXVideoCORE_SyncOperations(mfxSession session, mfxSyncPoint *syncp, mfxU32 num_syncp, mfxU16 mode, mfxU32 wait, mfxU32 *index)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_API, "MFX_SyncOperations");
+    mfxStatus mfxRes;
+
+    MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
+    MFX_CHECK(syncp, MFX_ERR_NULL_PTR);
+    MFX_CHECK(MFX_SYNC_ALL == mode || MFX_SYNC_ANY == mode, MFX_ERR_INVALID_VIDEO_PARAM);
+    MFX_CHECK(MFX_SYNC_ALL == mode || index, MFX_ERR_NULL_PTR);
+
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, num_syncp);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, mode);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, wait);
+
+    MFXIScheduler3 *pScheduler = session->GetScheduler3();
+    MFX_CHECK(pScheduler, MFX_ERR_UNSUPPORTED);
+
+    try {
+        // call the function
+        mfxRes = pScheduler->SynchronizeMultiple(syncp, num_syncp, MFX_SYNC_ALL == mode, wait, index);
+    } catch(...) {
+        // set the default error value
+        mfxRes = MFX_ERR_ABORTED;
+    }
+
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, mfxRes);
+
+    return mfxRes;
+}
+
+mfxStatus MFXVideoCORE_GetSchedulerStat(mfxSession session, mfxSchedulerStat *stat)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_API, "MFX_GetSchedulerStat");
+    MFX_SCHEDULER_STAT schedulerStat;
+    mfxStatus mfxRes;
+
+    MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
+    MFX_CHECK(stat, MFX_ERR_NULL_PTR);
+
+    MFXIScheduler3 *pScheduler = session->GetScheduler3();
+    MFX_CHECK(pScheduler, MFX_ERR_UNSUPPORTED);
+
+    try {
+        // call the function
+        mfxRes = pScheduler->GetStat(&schedulerStat);
+    } catch(...) {
+        // set the default error value
+        mfxRes = MFX_ERR_ABORTED;
+    }
+    MFX_CHECK_STS(mfxRes);
+
+    *stat = {};
+    stat->Period = schedulerStat.period;
+    stat->Load = schedulerStat.load;
+    stat->NumThread = (mfxU16) std::min<mfxU32>(schedulerStat.numberOfThreads, MFX_SCHEDULER_MAX_THREADS);
+    for (mfxU16 i = 0; i < stat->NumThread; i++)
+    {
+        stat->ThreadBusy[i] = (mfxU16) schedulerStat.threadBusy[i];
+    }
+
+    static_assert((int) MFX_SCHEDULER_TASK_HARDWARE == (int) MFX_TYPE_HARDWARE &&
+                  (int) MFX_SCHEDULER_TASK_SOFTWARE == (int) MFX_TYPE_SOFTWARE,
+                  "task types of the API and the scheduler differ");
+    for (mfxU32 type = 0; type < MFX_SCHEDULER_STAT_TASK_TYPES; type++)
+    {
+        const MFX_SCHEDULER_TASK_STAT &taskStat = schedulerStat.task[type];
+
+        stat->Task[type].NumQueued    = taskStat.numQueued;
+        stat->Task[type].NumReady     = taskStat.numReady;
+        stat->Task[type].NumRunning   = taskStat.numRunning;
+        stat->Task[type].NumWaiting   = taskStat.numWaiting;
+        stat->Task[type].NumBlocked   = taskStat.numBlocked;
+        stat->Task[type].NumCompleted = taskStat.numCompleted;
+        stat->Task[type].LatencyP50   = taskStat.latency50;
+        stat->Task[type].LatencyP90   = taskStat.latency90;
+        stat->Task[type].LatencyP99   = taskStat.latency99;
+        stat->Task[type].LatencyMax   = taskStat.latencyMax;
+    }
+
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, stat->Load);
+
+    return MFX_ERR_NONE;
+}
+#endif // #if (MFX_VERSION >= MFX_VERSION_NEXT)
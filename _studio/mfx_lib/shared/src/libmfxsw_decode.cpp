@@ -20,6 +20,9 @@
 
 #include <mfxvideo.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <mfx_session.h>
 #include <mfx_tools.h>
 #include <mfx_common.h>
@@ -73,6 +76,12 @@
 #include "mfx_user_plugin.h"
 #endif
 
+// the null accelerator is verified with the AVC decoder only
+static inline bool is_null_device_supported(mfxU32 codec_id, VideoCORE* core)
+{
+    return !IsNullDevice(core) || (MFX_CODEC_AVC == codec_id);
+}
+
 template<>
 VideoDECODE* _mfxSession::Create<VideoDECODE>(mfxVideoParam& par)
 {
@@ -163,6 +172,8 @@ mfxStatus MFXVideoDECODE_Query(mfxSession session, mfxVideoParam *in, mfxVideoPa
     }
 #endif
 
+    MFX_CHECK(is_null_device_supported(out->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
+
     MFX_AUTO_LTRACE_FUNC(MFX_TRACE_LEVEL_API);
     MFX_LTRACE_BUFFER(MFX_TRACE_LEVEL_API, in);
 
@@ -257,6 +268,7 @@ mfxStatus MFXVideoDECODE_QueryIOSurf(mfxSession session, mfxVideoParam *par, mfx
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
     MFX_CHECK(request, MFX_ERR_NULL_PTR);
+    MFX_CHECK(is_null_device_supported(par->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     MFX_AUTO_LTRACE_FUNC(MFX_TRACE_LEVEL_API);
     MFX_LTRACE_BUFFER(MFX_TRACE_LEVEL_API, par);
@@ -443,6 +455,7 @@ mfxStatus MFXVideoDECODE_Init(mfxSession session, mfxVideoParam *par)
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
+    MFX_CHECK(is_null_device_supported(par->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     try
     {
@@ -502,6 +515,41 @@ mfxStatus MFXVideoDECODE_Close(mfxSession session)
     return mfxRes;
 }
 
+// Fill the task of the frame accepted by DecodeFrameCheck
+static
+mfxStatus PrepareDecodeTask(mfxSession session, mfxFrameSurface1 *surface_out, MFX_TASK &task)
+{
+    task.pOwner = session->m_pDECODE.get();
+    task.priority = session->m_priority;
+    task.threadingPolicy = session->m_pDECODE->GetThreadingPolicy();
+    // fill dependencies
+    task.pSrc[0] = surface_out;
+    task.pDst[0] = surface_out;
+    // this is wa to remove external task dependency for HEVC SW decode plugin.
+    // need only because SW HEVC decode is pseudo
+    {
+        mfxPlugin plugin;
+        mfxPluginParam par;
+        if (session->m_plgDec.get())
+        {
+            session->m_plgDec.get()->GetPlugin(plugin);
+            MFX_CHECK_STS(plugin.GetPluginParam(plugin.pthis, &par));
+            if (MFX_PLUGINID_HEVCD_SW == par.PluginUID)
+            {
+                task.pDst[0] = 0;
+            }
+        }
+    }
+
+#ifdef MFX_TRACE_ENABLE
+    task.nParentId = MFX_AUTO_TRACE_GETID();
+    task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_DECODE;
+#endif
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus PrepareDecodeTask(mfxSession session, mfxFrameSurface1 *surface_out, MFX_TASK &task)
+
 mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs, mfxFrameSurface1 *surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp)
 {
     mfxStatus mfxRes;
@@ -540,32 +588,7 @@ mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs,
         {
             mfxStatus mfxAddRes;
 
-            task.pOwner = session->m_pDECODE.get();
-            task.priority = session->m_priority;
-            task.threadingPolicy = session->m_pDECODE->GetThreadingPolicy();
-            // fill dependencies
-            task.pSrc[0] = *surface_out;
-            task.pDst[0] = *surface_out;
-            // this is wa to remove external task dependency for HEVC SW decode plugin.
-            // need only because SW HEVC decode is pseudo
-            {
-                mfxPlugin plugin;
-                mfxPluginParam par;
-                if (session->m_plgDec.get())
-                {
-                    session->m_plgDec.get()->GetPlugin(plugin);
-                    MFX_CHECK_STS(plugin.GetPluginParam(plugin.pthis, &par));
-                    if (MFX_PLUGINID_HEVCD_SW == par.PluginUID)
-                    {
-                        task.pDst[0] = 0;
-                    }
-                }
-            }
-
-#ifdef MFX_TRACE_ENABLE
-            task.nParentId = MFX_AUTO_TRACE_GETID();
-            task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_DECODE;
-#endif
+            MFX_CHECK_STS(PrepareDecodeTask(session, *surface_out, task));
 
             // register input and call the task
             mfxAddRes = session->m_pScheduler->AddTask(task, &syncPoint);
@@ -607,6 +630,116 @@ mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs,
 
 } // mfxStatus MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs, mfxFrameSurface1 *surface_work, mfxFrameSurface1 **surface_dec, mfxFrameSurface1 **surface_disp, mfxSyncPoint *syncp)
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+mfxStatus MFXVideoDECODE_DecodeFramesAsync(mfxSession session, mfxBitstream *bs, mfxU32 num_frames, mfxFrameSurface1 **surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp, mfxU32 *num_output)
+{
+    mfxStatus mfxRes = MFX_ERR_NONE;
+
+#ifdef MFX_TRACE_ENABLE
+    MFX_AUTO_LTRACE_WITHID(MFX_TRACE_LEVEL_API, "MFX_DecodeFramesAsync");
+    MFX_LTRACE_BUFFER(MFX_TRACE_LEVEL_API, bs);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, num_frames);
+#endif
+
+    MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
+    MFX_CHECK(session->m_pScheduler, MFX_ERR_NOT_INITIALIZED);
+    MFX_CHECK(session->m_pDECODE.get(), MFX_ERR_NOT_INITIALIZED);
+    MFX_CHECK_NULL_PTR3(surface_work, surface_out, syncp);
+    MFX_CHECK_NULL_PTR1(num_output);
+
+    *num_output = 0;
+
+    try
+    {
+        MFXIScheduler3 *pScheduler = session->GetScheduler3();
+        MFX_CHECK(pScheduler, MFX_ERR_UNSUPPORTED);
+
+        mfxU32 numOutput = 0, i;
+
+        // Wait for the bit stream
+        mfxRes = session->m_pScheduler->WaitForDependencyResolved(bs);
+        MFX_CHECK_STS(mfxRes);
+
+        // reset the sync points
+        std::fill(syncp, syncp + num_frames, (mfxSyncPoint) NULL);
+        std::fill(surface_out, surface_out + num_frames, (mfxFrameSurface1 *) NULL);
+
+        // every call takes the next work surface. The frame's task is added
+        // right after its check, so the decoder never keeps the state of
+        // a frame, which is not submitted.
+        for (i = 0; i < num_frames; i += 1)
+        {
+            mfxFrameSurface1 *out = NULL;
+            mfxSyncPoint syncPoint = NULL;
+            MFX_TASK task;
+
+            memset(&task, 0, sizeof(MFX_TASK));
+            mfxRes = session->m_pDECODE->DecodeFrameCheck(bs, surface_work[i], &out, &task.entryPoint);
+            if (MFX_ERR_MORE_SURFACE == mfxRes)
+            {
+                continue;
+            }
+            if ((mfxRes < 0) && (MFX_ERR_MORE_DATA_SUBMIT_TASK != static_cast<int>(mfxRes)))
+            {
+                break;
+            }
+
+            // source data is OK, go forward
+            if (task.entryPoint.pRoutine)
+            {
+                mfxU32 numAdded = 0;
+
+                // the tasks of the frames before are added, the error is returned
+                mfxStatus mfxAddRes = PrepareDecodeTask(session, out, task);
+                if (MFX_ERR_NONE == mfxAddRes)
+                {
+                    // register input and call the task
+                    mfxAddRes = pScheduler->AddTasks(&task, 1, &syncPoint, &numAdded);
+                }
+                if (MFX_ERR_NONE != mfxAddRes)
+                {
+                    mfxRes = mfxAddRes;
+                    break;
+                }
+            }
+
+            if (MFX_ERR_MORE_DATA_SUBMIT_TASK == static_cast<int>(mfxRes))
+            {
+                mfxRes = MFX_WRN_DEVICE_BUSY;
+            }
+
+            // the frame is output
+            if ((task.entryPoint.pRoutine) &&
+                (MFX_ERR_NONE == mfxRes || (mfxRes == MFX_WRN_VIDEO_PARAM_CHANGED && out != NULL)))
+            {
+                surface_out[numOutput] = out;
+                syncp[numOutput] = syncPoint;
+                numOutput += 1;
+            }
+
+            // warnings are returned to the application at once
+            if (MFX_ERR_NONE != mfxRes)
+            {
+                break;
+            }
+        }
+        *num_output = numOutput;
+    }
+    // handle error(s)
+    catch(...)
+    {
+        // set the default error value
+        mfxRes = MFX_ERR_UNKNOWN;
+    }
+
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, *num_output);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, mfxRes);
+
+    return mfxRes;
+
+} // mfxStatus MFXVideoDECODE_DecodeFramesAsync(...)
+#endif // #if (MFX_VERSION >= MFX_VERSION_NEXT)
+
 //
 // THE OTHER DECODE FUNCTIONS HAVE IMPLICIT IMPLEMENTATION
 //
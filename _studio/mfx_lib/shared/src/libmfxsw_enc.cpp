@@ -89,6 +89,8 @@ mfxStatus MFXVideoENC_Query(mfxSession session, mfxVideoParam *in, mfxVideoParam
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(out, MFX_ERR_NULL_PTR);
+    // the null device has no stubs of LA, PreENC and ENC
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     mfxStatus mfxRes = MFX_ERR_UNSUPPORTED;
     try
@@ -143,6 +145,7 @@ mfxStatus MFXVideoENC_QueryIOSurf(mfxSession session, mfxVideoParam *par, mfxFra
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
     MFX_CHECK(request, MFX_ERR_NULL_PTR);
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     mfxStatus mfxRes = MFX_ERR_UNSUPPORTED;
     try
@@ -197,6 +200,7 @@ mfxStatus MFXVideoENC_Init(mfxSession session, mfxVideoParam *par)
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     try
     {
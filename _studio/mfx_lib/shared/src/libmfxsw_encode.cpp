@@ -20,8 +20,10 @@
 
 #include <mfxvideo.h>
 
+#include <algorithm>
 #include <functional>
 #include <map>
+#include <vector>
 
 #include <mfx_session.h>
 #include <mfx_tools.h>
@@ -529,6 +531,18 @@ static inline bool is_sw_fallback_supported(mfxU32 codec_id, VideoCORE* core)
     return handler->second.fallback.ctor != nullptr;
 }
 
+// the null device has the stub DDI of the AVC encoder only, FEI is not stubbed
+static inline bool is_null_device_supported(mfxU32 codec_id, VideoCORE* core)
+{
+    if (!IsNullDevice(core))
+        return true;
+
+    bool fei;
+    std::tie(std::ignore, fei) = check_fei(core);
+
+    return (MFX_CODEC_AVC == codec_id) && !fei;
+}
+
 template<>
 VideoENCODE* _mfxSession::Create<VideoENCODE>(mfxVideoParam& par)
 {
@@ -583,6 +597,8 @@ mfxStatus MFXVideoENCODE_Query(mfxSession session, mfxVideoParam *in, mfxVideoPa
 
 #endif
 
+    MFX_CHECK(is_null_device_supported(out->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
+
     mfxStatus mfxRes;
     MFX_AUTO_LTRACE_FUNC(MFX_TRACE_LEVEL_API);
     MFX_LTRACE_BUFFER(MFX_TRACE_LEVEL_API, in);
@@ -672,6 +688,7 @@ mfxStatus MFXVideoENCODE_QueryIOSurf(mfxSession session, mfxVideoParam *par, mfx
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
     MFX_CHECK(request, MFX_ERR_NULL_PTR);
+    MFX_CHECK(is_null_device_supported(par->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     mfxStatus mfxRes;
     MFX_AUTO_LTRACE_FUNC(MFX_TRACE_LEVEL_API);
@@ -744,6 +761,7 @@ mfxStatus MFXVideoENCODE_Init(mfxSession session, mfxVideoParam *par)
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
+    MFX_CHECK(is_null_device_supported(par->mfx.CodecId, session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     try
     {
@@ -839,6 +857,133 @@ enum
     MFX_NUM_ENTRY_POINTS = 2
 };
 
+// Check whether EncodeFrameCheck status requires to submit the frame's task(s)
+static
+bool IsEncodeTaskRequired(mfxStatus mfxRes)
+{
+    return (MFX_ERR_NONE == mfxRes) ||
+           (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == mfxRes) ||
+           (MFX_WRN_OUT_OF_RANGE == mfxRes) ||
+           // WHAT IS IT??? IT SHOULD BE REMOVED
+           ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ||
+           (MFX_ERR_MORE_BITSTREAM == mfxRes);
+
+} // bool IsEncodeTaskRequired(mfxStatus mfxRes)
+
+// Fill the task(s) of the frame accepted by EncodeFrameCheck.
+// The tasks must be added to the scheduler in the order, the sync point
+// of the frame is the sync point of the last task.
+static
+mfxU32 PrepareEncodeTasks(mfxSession session,
+                          mfxStatus mfxRes,
+                          mfxEncodeCtrl *ctrl,
+                          mfxFrameSurface1 *surface,
+                          mfxBitstream *bs,
+                          mfxFrameSurface1 *reordered_surface,
+                          const mfxEncodeInternalParams &internal_params,
+                          const MFX_ENTRY_POINT (&entryPoints)[MFX_NUM_ENTRY_POINTS],
+                          mfxU32 numEntryPoints,
+                          MFX_TASK (&tasks)[MFX_NUM_ENTRY_POINTS])
+{
+    memset(&tasks, 0, sizeof(tasks));
+
+    // prepare the obsolete kind of task.
+    // it is obsolete and must be removed.
+    if (NULL == entryPoints[0].pRoutine)
+    {
+        MFX_TASK &task = tasks[0];
+
+        // BEGIN OF OBSOLETE PART
+        task.bObsoleteTask = true;
+        task.obsolete_params.encode.internal_params = internal_params;
+        // fill task info
+        task.pOwner = session->m_pENCODE.get();
+        task.entryPoint.pRoutine = &MFXVideoENCODELegacyRoutine;
+        task.entryPoint.pState = session->m_pENCODE.get();
+        task.entryPoint.requiredNumThreads = 1;
+
+        // fill legacy parameters
+        task.obsolete_params.encode.ctrl = ctrl;
+        task.obsolete_params.encode.surface = reordered_surface;
+        task.obsolete_params.encode.bs = bs;
+        // END OF OBSOLETE PART
+
+        task.priority = session->m_priority;
+        task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
+        // fill dependencies
+        task.pSrc[0] = surface;
+        task.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0: bs;
+
+        task.pSrc[1] = bs;
+        task.pSrc[2] = ctrl ? ctrl->ExtParam : 0;
+
+#ifdef MFX_TRACE_ENABLE
+        task.nParentId = MFX_AUTO_TRACE_GETID();
+        task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
+#endif // MFX_TRACE_ENABLE
+
+        return 1;
+    }
+    else if (1 == numEntryPoints)
+    {
+        MFX_TASK &task = tasks[0];
+
+        task.pOwner = session->m_pENCODE.get();
+        task.entryPoint = entryPoints[0];
+        task.priority = session->m_priority;
+        task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
+        // fill dependencies
+        task.pSrc[0] = surface;
+        task.pSrc[1] =  bs;
+        task.pSrc[2] = ctrl ? ctrl->ExtParam : 0;
+        task.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0 : bs;
+
+
+#ifdef MFX_TRACE_ENABLE
+        task.nParentId = MFX_AUTO_TRACE_GETID();
+        task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
+#endif
+
+        return 1;
+    }
+    else
+    {
+        MFX_TASK &task = tasks[0];
+
+        task.pOwner = session->m_pENCODE.get();
+        task.entryPoint = entryPoints[0];
+        task.priority = session->m_priority;
+        task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
+        // fill dependencies
+        task.pSrc[0] = surface;
+        task.pSrc[1] = ctrl ? ctrl->ExtParam : 0;
+        task.pDst[0] = entryPoints[0].pParam;
+
+#ifdef MFX_TRACE_ENABLE
+        task.nParentId = MFX_AUTO_TRACE_GETID();
+        task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
+#endif
+
+        MFX_TASK &task2 = tasks[1];
+
+        task2.pOwner = session->m_pENCODE.get();
+        task2.entryPoint = entryPoints[1];
+        task2.priority = session->m_priority;
+        task2.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
+        // fill dependencies
+        task2.pSrc[0] = entryPoints[0].pParam;
+        task2.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0: bs;
+
+#ifdef MFX_TRACE_ENABLE
+        task2.nParentId = MFX_AUTO_TRACE_GETID();
+        task2.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE2;
+#endif
+
+        return 2;
+    }
+
+} // mfxU32 PrepareEncodeTasks(...)
+
 mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl *ctrl, mfxFrameSurface1 *surface, mfxBitstream *bs, mfxSyncPoint *syncp)
 {
     mfxStatus mfxRes;
@@ -868,111 +1013,17 @@ mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl *ctr
                                                       entryPoints,
                                                       numEntryPoints);
         // source data is OK, go forward
-        if ((MFX_ERR_NONE == mfxRes) ||
-            (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == mfxRes) ||
-            (MFX_WRN_OUT_OF_RANGE == mfxRes) ||
-            // WHAT IS IT??? IT SHOULD BE REMOVED
-            ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ||
-            (MFX_ERR_MORE_BITSTREAM == mfxRes))
-        {
-            // prepare the obsolete kind of task.
-            // it is obsolete and must be removed.
-            if (NULL == entryPoints[0].pRoutine)
-            {
-                MFX_TASK task;
-
-                memset(&task, 0, sizeof(task));
-                // BEGIN OF OBSOLETE PART
-                task.bObsoleteTask = true;
-                task.obsolete_params.encode.internal_params = internal_params;
-                // fill task info
-                task.pOwner = session->m_pENCODE.get();
-                task.entryPoint.pRoutine = &MFXVideoENCODELegacyRoutine;
-                task.entryPoint.pState = session->m_pENCODE.get();
-                task.entryPoint.requiredNumThreads = 1;
-
-                // fill legacy parameters
-                task.obsolete_params.encode.ctrl = ctrl;
-                task.obsolete_params.encode.surface = reordered_surface;
-                task.obsolete_params.encode.bs = bs;
-                // END OF OBSOLETE PART
-
-                task.priority = session->m_priority;
-                task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
-                // fill dependencies
-                task.pSrc[0] = surface;
-                task.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0: bs;
-
-                task.pSrc[1] = bs;
-                task.pSrc[2] = ctrl ? ctrl->ExtParam : 0;
-
-#ifdef MFX_TRACE_ENABLE
-                task.nParentId = MFX_AUTO_TRACE_GETID();
-                task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
-#endif // MFX_TRACE_ENABLE
+        if (IsEncodeTaskRequired(mfxRes))
+        {
+            MFX_TASK tasks[MFX_NUM_ENTRY_POINTS];
+            mfxU32 numTasks = PrepareEncodeTasks(session, mfxRes, ctrl, surface, bs,
+                                                 reordered_surface, internal_params,
+                                                 entryPoints, numEntryPoints, tasks);
 
-                // register input and call the task
-                MFX_CHECK_STS(session->m_pScheduler->AddTask(task, &syncPoint));
-            }
-            else if (1 == numEntryPoints)
+            for (mfxU32 i = 0; i < numTasks; i += 1)
             {
-                MFX_TASK task;
-
-                memset(&task, 0, sizeof(task));
-                task.pOwner = session->m_pENCODE.get();
-                task.entryPoint = entryPoints[0];
-                task.priority = session->m_priority;
-                task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
-                // fill dependencies
-                task.pSrc[0] = surface;
-                task.pSrc[1] =  bs;
-                task.pSrc[2] = ctrl ? ctrl->ExtParam : 0;
-                task.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0 : bs;
-
-
-#ifdef MFX_TRACE_ENABLE
-                task.nParentId = MFX_AUTO_TRACE_GETID();
-                task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
-#endif
                 // register input and call the task
-                MFX_CHECK_STS(session->m_pScheduler->AddTask(task, &syncPoint));
-            }
-            else
-            {
-                MFX_TASK task;
-
-                memset(&task, 0, sizeof(task));
-                task.pOwner = session->m_pENCODE.get();
-                task.entryPoint = entryPoints[0];
-                task.priority = session->m_priority;
-                task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
-                // fill dependencies
-                task.pSrc[0] = surface;
-                task.pSrc[1] = ctrl ? ctrl->ExtParam : 0;
-                task.pDst[0] = entryPoints[0].pParam;
-
-#ifdef MFX_TRACE_ENABLE
-                task.nParentId = MFX_AUTO_TRACE_GETID();
-                task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE;
-#endif
-                // register input and call the task
-                MFX_CHECK_STS(session->m_pScheduler->AddTask(task, &syncPoint));
-
-                memset(&task, 0, sizeof(task));
-                task.pOwner = session->m_pENCODE.get();
-                task.entryPoint = entryPoints[1];
-                task.priority = session->m_priority;
-                task.threadingPolicy = session->m_pENCODE->GetThreadingPolicy();
-                // fill dependencies
-                task.pSrc[0] = entryPoints[0].pParam;
-                task.pDst[0] = ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes) ? 0: bs;
-
-#ifdef MFX_TRACE_ENABLE
-                task.nParentId = MFX_AUTO_TRACE_GETID();
-                task.nTaskId = MFX::CreateUniqId() + MFX_TRACE_ID_ENCODE2;
-#endif
-                // register input and call the task
-                MFX_CHECK_STS(session->m_pScheduler->AddTask(task, &syncPoint));
+                MFX_CHECK_STS(session->m_pScheduler->AddTask(tasks[i], &syncPoint));
             }
 
             // IT SHOULD BE REMOVED
@@ -1003,6 +1054,110 @@ mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl *ctr
 
 } // mfxStatus MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxFrameSurface1 *surface, mfxBitstream *bs, mfxSyncPoint *syncp)
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+mfxStatus MFXVideoENCODE_EncodeFramesAsync(mfxSession session, mfxU32 num_frames, mfxEncodeCtrl **ctrl, mfxFrameSurface1 **surface, mfxBitstream **bs, mfxSyncPoint *syncp, mfxU32 *num_submitted)
+{
+    mfxStatus mfxRes = MFX_ERR_NONE;
+
+    MFX_AUTO_LTRACE_WITHID(MFX_TRACE_LEVEL_API, "MFX_EncodeFramesAsync");
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, num_frames);
+
+    MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
+    MFX_CHECK(session->m_pENCODE.get(), MFX_ERR_NOT_INITIALIZED);
+    MFX_CHECK(surface && bs && syncp && num_submitted, MFX_ERR_NULL_PTR);
+
+    *num_submitted = 0;
+    std::fill(syncp, syncp + num_frames, (mfxSyncPoint) NULL);
+
+    try
+    {
+        MFXIScheduler3 *pScheduler = session->GetScheduler3();
+        MFX_CHECK(pScheduler, MFX_ERR_UNSUPPORTED);
+
+        // the first warning of the frames is returned, unless an error happens
+        mfxStatus mfxWrn = MFX_ERR_NONE;
+        mfxU32 numFrames;
+
+        // a frame's tasks are added right after its check, so the encoder
+        // never keeps the state of a frame, which is not submitted
+        for (numFrames = 0; numFrames < num_frames; numFrames += 1)
+        {
+            mfxEncodeCtrl *frame_ctrl = (ctrl) ? (ctrl[numFrames]) : (NULL);
+            mfxFrameSurface1 *reordered_surface = NULL;
+            mfxEncodeInternalParams internal_params;
+            MFX_ENTRY_POINT entryPoints[MFX_NUM_ENTRY_POINTS];
+            mfxU32 numEntryPoints = MFX_NUM_ENTRY_POINTS;
+
+            memset(&entryPoints, 0, sizeof(entryPoints));
+            mfxRes = session->m_pENCODE->EncodeFrameCheck(frame_ctrl,
+                                                          surface[numFrames],
+                                                          bs[numFrames],
+                                                          &reordered_surface,
+                                                          &internal_params,
+                                                          entryPoints,
+                                                          numEntryPoints);
+            if ((MFX_ERR_NONE < mfxRes) && (MFX_ERR_NONE == mfxWrn))
+            {
+                mfxWrn = mfxRes;
+            }
+
+            if (IsEncodeTaskRequired(mfxRes))
+            {
+                MFX_TASK tasks[MFX_NUM_ENTRY_POINTS];
+                mfxSyncPoint taskSyncPoints[MFX_NUM_ENTRY_POINTS] = {};
+                mfxU32 numTasks = PrepareEncodeTasks(session, mfxRes, frame_ctrl, surface[numFrames], bs[numFrames],
+                                                     reordered_surface, internal_params,
+                                                     entryPoints, numEntryPoints, tasks);
+                mfxU32 numAdded = 0;
+
+                // register input and call the tasks
+                mfxStatus mfxAddRes = pScheduler->AddTasks(tasks, numTasks, taskSyncPoints, &numAdded);
+                if (MFX_ERR_NONE != mfxAddRes)
+                {
+                    mfxRes = mfxAddRes;
+                    break;
+                }
+
+                // IT SHOULD BE REMOVED
+                if ((mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK == mfxRes)
+                {
+                    mfxRes = MFX_ERR_MORE_DATA;
+                }
+                else
+                {
+                    syncp[numFrames] = taskSyncPoints[numTasks - 1];
+                }
+            }
+            // the frame is not taken, the status is returned
+            else if ((MFX_ERR_MORE_DATA != mfxRes) || (NULL == surface[numFrames]))
+            {
+                break;
+            }
+            // otherwise the frame is buffered by the encoder
+        }
+        *num_submitted = numFrames;
+
+        // errors are more important than warnings of the frames before
+        if ((MFX_ERR_NONE != mfxWrn) &&
+            ((MFX_ERR_NONE <= mfxRes) || (MFX_ERR_MORE_DATA == mfxRes)))
+        {
+            mfxRes = mfxWrn;
+        }
+    }
+    // handle error(s)
+    catch(...)
+    {
+        // set the default error value
+        mfxRes = MFX_ERR_UNKNOWN;
+    }
+
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, *num_submitted);
+    MFX_LTRACE_I(MFX_TRACE_LEVEL_API, mfxRes);
+    return mfxRes;
+
+} // mfxStatus MFXVideoENCODE_EncodeFramesAsync(...)
+#endif // #if (MFX_VERSION >= MFX_VERSION_NEXT)
+
 //
 // THE OTHER ENCODE FUNCTIONS HAVE IMPLICIT IMPLEMENTATION
 //
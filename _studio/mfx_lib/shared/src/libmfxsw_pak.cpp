@@ -71,6 +71,8 @@ mfxStatus MFXVideoPAK_Query(mfxSession session, mfxVideoParam *in, mfxVideoParam
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(out, MFX_ERR_NULL_PTR);
+    // the null device has no stubs of PAK
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     mfxStatus mfxRes;
     try
@@ -104,6 +106,7 @@ mfxStatus MFXVideoPAK_QueryIOSurf(mfxSession session, mfxVideoParam *par, mfxFra
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
     MFX_CHECK(request, MFX_ERR_NULL_PTR);
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     mfxStatus mfxRes;
     try
@@ -139,6 +142,7 @@ mfxStatus MFXVideoPAK_Init(mfxSession session, mfxVideoParam *par)
 
     MFX_CHECK(session, MFX_ERR_INVALID_HANDLE);
     MFX_CHECK(par, MFX_ERR_NULL_PTR);
+    MFX_CHECK(!IsNullDevice(session->m_pCORE.get()), MFX_ERR_UNSUPPORTED);
 
     try
     {
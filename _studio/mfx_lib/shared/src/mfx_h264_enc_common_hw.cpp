@@ -3208,6 +3208,8 @@ mfxStatus MfxHwH264Encode::CheckVideoParamQueryLike(
     if (!CheckTriStateOption(extDdi->RefRaw))                   changed = true;
     if (!CheckTriStateOption(extDdi->DirectSpatialMvPredFlag))  changed = true;
     if (!CheckTriStateOption(extDdi->Hme))                      changed = true;
+    if (!CheckTriStateOption(extDdi->SwLookahead))              changed = true;
+    if (!CheckTriStateOption(extDdi->SwFrameAnalysis))          changed = true;
     if (!CheckTriStateOption(extOpt2->BitrateLimit))            changed = true;
     if (!CheckTriStateOption(extOpt2->MBBRC))                   changed = true;
     //if (!CheckTriStateOption(extOpt2->ExtBRC))                  changed = true;
@@ -25,11 +25,10 @@
 #if defined (MFX_ENABLE_H264_VIDEO_ENCODE_HW)
 
 #include "mfx_h264_encode_interface.h"
-#ifdef MFX_ENABLE_MFE
 #include "libmfx_core_interface.h"
-#endif
 #if defined (MFX_VA_LINUX)
     #include "mfx_h264_encode_vaapi.h"
+    #include "mfx_h264_encode_null.h"
 
 #endif
 
@@ -43,10 +42,12 @@ DriverEncoder* MfxHwH264Encode::CreatePlatformH264Encoder( VideoCORE* core )
 {
     //MFX_CHECK_NULL_PTR1( core );
     assert( core );
-    (void)core;
 
 #if defined (MFX_VA_LINUX)
 
+    if (QueryCoreInterface<NullDeviceParam>(core, MFXINULLDEVICE_GUID))
+        return new NullEncoder;
+
     return new VAAPIEncoder;//( core );
 
 #endif
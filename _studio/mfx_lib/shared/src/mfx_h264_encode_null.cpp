@@ -0,0 +1,304 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_H264_VIDEO_ENCODE_HW) && defined (MFX_VA_LINUX)
+
+#include "mfx_h264_encode_null.h"
+#include "libmfx_core_interface.h"
+
+#include <algorithm>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace MfxHwH264Encode;
+
+namespace
+{
+    // access unit delimiter, primary_pic_type = 7 (any slice types)
+    const mfxU8 NullAud[] = { 0x00, 0x00, 0x00, 0x01, 0x09, 0xf0 };
+    // filler data NAL unit header
+    const mfxU8 NullFiller[] = { 0x00, 0x00, 0x00, 0x01, 0x0c };
+
+    const mfxU32 NullMinCodedSize = sizeof(NullAud) + sizeof(NullFiller) + 1;
+}
+
+NullEncoder::NullEncoder()
+    : m_core(NULL)
+    , m_caps()
+    , m_latency(0)
+    , m_width(0)
+    , m_height(0)
+    , m_codedSize(NullMinCodedSize)
+{
+} // NullEncoder::NullEncoder()
+
+NullEncoder::~NullEncoder()
+{
+    Destroy();
+
+} // NullEncoder::~NullEncoder()
+
+mfxU32 NullEncoder::GetCodedSize(MfxVideoParam const & par)
+{
+    const mfxFrameInfo & fi = par.mfx.FrameInfo;
+    mfxU32 size = fi.Width * fi.Height / 16;
+
+    // the size of the average frame at the target bitrate
+    if (par.mfx.RateControlMethod != MFX_RATECONTROL_CQP &&
+        par.calcParam.targetKbps && fi.FrameRateExtN && fi.FrameRateExtD)
+    {
+        size = (mfxU32) ((mfxU64) par.calcParam.targetKbps * 125 * fi.FrameRateExtD / fi.FrameRateExtN);
+    }
+
+    return std::max(size, NullMinCodedSize);
+
+} // mfxU32 NullEncoder::GetCodedSize(MfxVideoParam const & par)
+
+mfxStatus NullEncoder::CreateAuxilliaryDevice(
+    VideoCORE* core,
+    GUID /*guid*/,
+    mfxU32 width,
+    mfxU32 height,
+    bool /*isTemporal*/)
+{
+    MFX_CHECK_NULL_PTR1(core);
+
+    NullDeviceParam *pNullDevice = QueryCoreInterface<NullDeviceParam>(core, MFXINULLDEVICE_GUID);
+    MFX_CHECK(pNullDevice, MFX_ERR_DEVICE_FAILED);
+
+    m_core    = core;
+    m_latency = std::chrono::microseconds(pNullDevice->latency);
+    m_width   = width;
+    m_height  = height;
+
+    // capabilities of the VA-API encoder on the recent platforms
+    m_caps = {};
+    m_caps.CQPSupport = 1;
+    m_caps.CBRSupport = 1;
+    m_caps.VBRSupport = 1;
+    m_caps.ddi_caps.BRCReset                = 1;
+    m_caps.ddi_caps.HeaderInsertion         = 0;
+    m_caps.ddi_caps.UserMaxFrameSizeSupport = 1;
+    m_caps.ddi_caps.MBBRCSupport            = 1;
+    m_caps.ddi_caps.MbQpDataSupport         = 1;
+    m_caps.ddi_caps.SkipFrame               = 1;
+    m_caps.ddi_caps.LumaWeightedPred        = 1;
+    m_caps.ddi_caps.ChromaWeightedPred      = 1;
+    m_caps.ddi_caps.MaxNum_WeightedPredL0   = 4;
+    m_caps.ddi_caps.MaxNum_WeightedPredL1   = 2;
+    m_caps.ddi_caps.Color420Only            = 1;
+    m_caps.ddi_caps.MaxPicWidth             = 4096;
+    m_caps.ddi_caps.MaxPicHeight            = 4096;
+    m_caps.ddi_caps.SliceStructure          = 4;
+    m_caps.ddi_caps.MaxNum_Reference        = 3;
+    m_caps.ddi_caps.MaxNum_Reference1       = 1;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::CreateAuxilliaryDevice(...)
+
+mfxStatus NullEncoder::CreateAccelerationService(MfxVideoParam const & par)
+{
+    m_codedSize = std::min(GetCodedSize(par), m_width * m_height);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::CreateAccelerationService(MfxVideoParam const & par)
+
+mfxStatus NullEncoder::Reset(MfxVideoParam const & par)
+{
+    return CreateAccelerationService(par);
+
+} // mfxStatus NullEncoder::Reset(MfxVideoParam const & par)
+
+mfxStatus NullEncoder::QueryCompBufferInfo(D3DDDIFORMAT /*type*/, mfxFrameAllocRequest& request)
+{
+    // request linear buffer
+    request.Info.FourCC = MFX_FOURCC_P8;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::QueryCompBufferInfo(D3DDDIFORMAT type, mfxFrameAllocRequest& request)
+
+mfxStatus NullEncoder::QueryEncodeCaps(MFX_ENCODE_CAPS& caps)
+{
+    caps = m_caps;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::QueryEncodeCaps(MFX_ENCODE_CAPS& caps)
+
+mfxStatus NullEncoder::QueryMbPerSec(mfxVideoParam const & /*par*/, mfxU32 (&mbPerSec)[16])
+{
+    // 4096x2176 at 120 fps for every target usage
+    std::fill(std::begin(mbPerSec), std::end(mbPerSec), 256 * 136 * 120);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::QueryMbPerSec(...)
+
+mfxStatus NullEncoder::QueryHWGUID(VideoCORE * /*core*/, GUID /*guid*/, bool /*isTemporal*/)
+{
+    return MFX_ERR_UNSUPPORTED;
+
+} // mfxStatus NullEncoder::QueryHWGUID(...)
+
+mfxStatus NullEncoder::Register(mfxFrameAllocResponse& response, D3DDDIFORMAT type)
+{
+    // only bitstreams are written by the null device
+    if (D3DDDIFMT_INTELENCODE_BITSTREAMDATA == type)
+    {
+        MFX_CHECK(response.mids, MFX_ERR_NULL_PTR);
+
+        m_bsQueue.assign(response.mids, response.mids + response.NumFrameActual);
+    }
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::Register(mfxFrameAllocResponse& response, D3DDDIFORMAT type)
+
+mfxStatus NullEncoder::Execute(
+    mfxHDLPair /*pair*/,
+    DdiTask const & task,
+    mfxU32 fieldId,
+    PreAllocatedVector const & /*sei*/)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "NullEncoder::Execute");
+
+    MFX_CHECK(task.m_idxBs[fieldId] < m_bsQueue.size(), MFX_ERR_UNDEFINED_BEHAVIOR);
+
+    Feedback feedback;
+    feedback.number = task.m_statusReportNumber[fieldId];
+    feedback.idxBs  = task.m_idxBs[fieldId];
+    feedback.due    = std::chrono::steady_clock::now() + m_latency;
+    feedback.fd     = -1;
+
+    // the task waits for the timer instead of blocking a thread
+    if (m_latency.count())
+    {
+        feedback.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        MFX_CHECK(0 <= feedback.fd, MFX_ERR_DEVICE_FAILED);
+
+        itimerspec timer = {};
+        timer.it_value.tv_sec  = m_latency.count() / 1000000;
+        timer.it_value.tv_nsec = m_latency.count() % 1000000 * 1000;
+        if (timerfd_settime(feedback.fd, 0, &timer, NULL))
+        {
+            close(feedback.fd);
+            MFX_RETURN(MFX_ERR_DEVICE_FAILED);
+        }
+    }
+
+    UMC::AutomaticUMCMutex guard(m_guard);
+    m_feedbackCache.push_back(feedback);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::Execute(...)
+
+mfxStatus NullEncoder::QueryStatus(
+    DdiTask & task,
+    mfxU32    fieldId)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "NullEncoder::QueryStatus");
+    Feedback feedback;
+
+    {
+        UMC::AutomaticUMCMutex guard(m_guard);
+
+        auto it = std::find_if(m_feedbackCache.begin(), m_feedbackCache.end(),
+            [&task, fieldId](const Feedback & fb) { return fb.number == task.m_statusReportNumber[fieldId]; });
+        if (m_feedbackCache.end() == it)
+        {
+            return MFX_ERR_UNKNOWN;
+        }
+
+        if (std::chrono::steady_clock::now() < it->due)
+        {
+            return MFX_WRN_DEVICE_BUSY;
+        }
+
+        feedback = *it;
+        m_feedbackCache.erase(it);
+    }
+
+    if (0 <= feedback.fd)
+    {
+        close(feedback.fd);
+    }
+
+    mfxFrameData bitstream = {};
+    mfxStatus sts = m_core->LockFrame(m_bsQueue[feedback.idxBs], &bitstream);
+    MFX_CHECK_STS(sts);
+    MFX_CHECK(bitstream.Y, MFX_ERR_LOCK_MEMORY);
+
+    mfxU8 *p = bitstream.Y;
+    p = std::copy(std::begin(NullAud), std::end(NullAud), p);
+    p = std::copy(std::begin(NullFiller), std::end(NullFiller), p);
+    p = std::fill_n(p, m_codedSize - NullMinCodedSize, 0xff);
+    // rbsp_trailing_bits
+    *p = 0x80;
+
+    sts = m_core->UnlockFrame(m_bsQueue[feedback.idxBs], &bitstream);
+    MFX_CHECK_STS(sts);
+
+    task.m_bsDataLength[fieldId] = m_codedSize;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::QueryStatus(...)
+
+int NullEncoder::GetCompletionHandle(
+    DdiTask const & task,
+    mfxU32          fieldId)
+{
+    UMC::AutomaticUMCMutex guard(m_guard);
+
+    auto it = std::find_if(m_feedbackCache.begin(), m_feedbackCache.end(),
+        [&task, fieldId](const Feedback & fb) { return fb.number == task.m_statusReportNumber[fieldId]; });
+
+    return (m_feedbackCache.end() != it) ? it->fd : -1;
+
+} // int NullEncoder::GetCompletionHandle(...)
+
+mfxStatus NullEncoder::Destroy()
+{
+    UMC::AutomaticUMCMutex guard(m_guard);
+
+    for (auto & feedback : m_feedbackCache)
+    {
+        if (0 <= feedback.fd)
+        {
+            close(feedback.fd);
+        }
+    }
+
+    m_bsQueue.clear();
+    m_feedbackCache.clear();
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullEncoder::Destroy()
+
+#endif // MFX_ENABLE_H264_VIDEO_ENCODE_HW && MFX_VA_LINUX
+/* EOF */
@@ -883,6 +883,9 @@ mfxStatus _mfxSession_1_10::InitEx(mfxInitParam& par)
         schedParam.pCore = m_pCORE.get();
         if (par.NumExtParam) {
             schedParam.params = *((mfxExtThreadsParam*)par.ExtParam[0]);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+            schedParam.latencyBudget = schedParam.params.LatencyBudget;
+#endif
         }
         mfxRes = pScheduler2->Initialize2(&schedParam);
 
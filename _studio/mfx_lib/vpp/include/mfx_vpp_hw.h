@@ -46,6 +46,7 @@
 
 #ifdef MFX_ENABLE_MCTF
 #include "mctf_common.h"
+#include "mctf_cpu.h"
 #include "cpu_detect.h"
 #include <list>
 #endif
@@ -936,6 +937,9 @@ namespace MfxHwVideoProcessing
 
         // this is to return a surface out of MCTF
         static mfxStatus QueryFromMctf(void *pState, void *pParam, bool bMctfReadyToReturn, bool bEoF = false);
+
+        // filters the output surface of the finished task on CPU
+        mfxStatus RunCpuMctf(DdiTask* pTask);
 #endif
 
         mfxU16 m_asyncDepth;
@@ -988,6 +992,11 @@ namespace MfxHwVideoProcessing
         // additional functionallity which is not required for MCTF
         std::map<void *, CmSurface2D *> m_MCTFtableCmRelations2;
         std::map<CmSurface2D *, SurfaceIndex *> m_MCTFtableCmIndex2;
+
+        // MCTF on CPU, used instead of m_pMCTFilter if there is no CM device
+        std::unique_ptr<CpuMctf> m_pCpuMctf;
+        // Init/Reset parameters of m_pCpuMctf, base of run-time controls
+        IntMctfParams m_CpuMctfParams;
 #endif
 
         CmCopyWrapper *m_pCmCopy;
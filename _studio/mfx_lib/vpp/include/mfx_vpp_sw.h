@@ -28,6 +28,9 @@
 #define __MFX_VPP_SW_H
 
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
 
 #include "mfxvideo++int.h"
 
@@ -41,6 +44,12 @@
 /* ******************************************************************** */
 
 #include "mfx_vpp_hw.h"
+#include "mfx_vpp_sw_scale.h"
+#include "mfx_vpp_sw_composite.h"
+
+#ifdef MFX_ENABLE_MCTF
+#include "mctf_cpu.h"
+#endif
 
 class VideoVPPBase
 {
@@ -141,10 +150,99 @@ public:
     mfxStatus PassThrough(mfxFrameInfo* In, mfxFrameInfo* Out, mfxU32 taskIndex);
 };
 
+// CPU implementation of resize/crop, color conversion (NV12, YV12, YUY2, P010, RGB4),
+// deinterlacing, composition and MCTF for system memory. Used when there is no video processing device.
+// Every frame is one scheduler task, output rows are split into regions
+// processed by all threads of the scheduler.
+// With MCTF the input is scaled to a frame of the MCTF queue and the task filters
+// the frame due for output, the output is delayed by the future references of the mode.
+class VideoVPP_SW : public VideoVPPBase
+{
+public:
+    static mfxStatus Query(VideoCORE *core, mfxVideoParam *par);
+    static mfxStatus QueryCaps(MfxHwVideoProcessing::mfxVppCaps& caps);
+    static mfxStatus CheckParams(mfxVideoParam *par);
+
+    // Deinterlacing of the pipeline, DI_NONE if there is none
+    static MfxSwVideoProcessing::DeinterlaceMethod GetDeinterlaceMethod(mfxVideoParam *par, bool *refFrame, bool *mode30i60p);
+
+    VideoVPP_SW(VideoCORE *core, mfxStatus* sts);
+
+    virtual mfxStatus InternalInit(mfxVideoParam *par);
+    virtual mfxStatus Close(void);
+    virtual mfxStatus Reset(mfxVideoParam *par);
+
+    virtual mfxStatus VppFrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, mfxExtVppAuxData *aux,
+                                    MFX_ENTRY_POINT pEntryPoints[], mfxU32 &numEntryPoints);
+
+    virtual mfxStatus RunFrameVPP(mfxFrameSurface1* in, mfxFrameSurface1* out, mfxExtVppAuxData *aux);
+
+protected:
+    struct SwFrame
+    {
+        mfxFrameSurface1 *    surface;
+        mfxFrameData          data;       // locked copy of surface data
+        bool                  locked;
+    };
+
+    struct SwTask
+    {
+        bool                  busy;
+        std::vector<SwFrame>  in;         // one per stream of composition
+        SwFrame               out;
+        std::vector<const mfxFrameData *> inData;
+        SwFrame               ref;        // previous input for motion adaptive deinterlacing
+        MfxSwVideoProcessing::Field field;
+        bool                  deinterlace;
+        mfxU64                timeStamp;
+        std::shared_ptr<const MfxSwVideoProcessing::Geometry>    geometry;
+        std::shared_ptr<const MfxSwVideoProcessing::Composition> composition;
+        std::atomic<mfxU32>   nextRegion;
+#ifdef MFX_ENABLE_MCTF
+        std::shared_ptr<CpuMctf::Frame> mctfIn;     // scaled input put to the MCTF queue, empty at the end of stream
+        std::shared_ptr<CpuMctf::Job>   mctfJob;    // filtering of the output frame, empty while the queue is filled
+        std::vector<mfxU32>   stageEnd;   // accumulated regions of scaling and of the MCTF stages
+        std::atomic<mfxU32>   doneRegions;
+#endif
+    };
+
+    static mfxStatus TaskRoutine(void *pState, void *pParam, mfxU32 threadNumber, mfxU32 callNumber);
+    static mfxStatus TaskComplete(void *pState, void *pParam, mfxStatus taskRes);
+
+    mfxStatus InitScaler(mfxVideoParam *par);
+#ifdef MFX_ENABLE_MCTF
+    mfxStatus InitMctf(mfxVideoParam *par);
+    static mfxStatus RunStages(SwTask & task);
+#endif
+    mfxStatus AcquireFrame(mfxFrameSurface1 *surface, SwFrame & frame);
+    void      ReleaseFrame(SwFrame & frame);
+    void      ReleaseTask(SwTask & task);
+    void      ReleasePending();
+    void      SetPrevious(mfxFrameSurface1 *surface);
+
+    MfxSwVideoProcessing::FrameScaler      m_scaler;
+    MfxSwVideoProcessing::FrameCompositor  m_compositor;
+    bool                                   m_bComposite;
+    std::vector<SwFrame>                   m_pending;  // streams of the next composition received so far
+    MfxSwVideoProcessing::DeinterlaceMethod m_deinterlace;
+    bool                                   m_bRefFrame;   // motion adaptive deinterlacing uses the previous input
+    bool                                   m_b30i60p;     // every field is output, input is sent twice
+    mfxFrameSurface1 *                     m_prev;        // previous input, referenced
+    mfxFrameSurface1 *                     m_firstField;  // input whose first field was output by the previous call
+#ifdef MFX_ENABLE_MCTF
+    std::unique_ptr<CpuMctf>               m_mctf;        // NULL if MCTF is off
+    IntMctfParams                          m_mctfParams;  // Init/Reset parameters, base of run-time controls
+#endif
+    std::unique_ptr<SwTask[]>              m_tasks;
+    mfxU32                                 m_numTasks;
+    std::mutex                             m_guard;
+};
+
 
 mfxStatus RunFrameVPPRoutine(void *pState, void *pParam, mfxU32 threadNumber, mfxU32 callNumber);
 mfxStatus CompleteFrameVPPRoutine(void *pState, void *pParam, mfxStatus taskRes);
 
+VideoVPPBase* CreateVideoVPP_SW(VideoCORE *core, mfxStatus *mfxSts);
 VideoVPPBase* CreateAndInitVPPImpl(mfxVideoParam *par, VideoCORE *core, mfxStatus *mfxSts);
 
 #endif // __MFX_VPP_SW_H
@@ -0,0 +1,94 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#ifndef __MFX_VPP_SW_COMPOSITE_H
+#define __MFX_VPP_SW_COMPOSITE_H
+
+#include <vector>
+#include <memory>
+
+#include "mfx_vpp_sw_scale.h"
+
+// Software composition of mfxExtVPPComposite streams used by VideoVPP_SW.
+//
+// The output crop is composed in stripes of rows: every stripe is filled with
+// the background color in Q14 buffers, the inputs crossing the stripe are scaled
+// into their rectangles by RowScaler and blended in stream order, then the stripe
+// is stored. Stripes are small enough for the buffers to stay in L2 cache and are
+// processed by the threads of the task independently.
+namespace MfxSwVideoProcessing
+{
+    // Input stream scaled into its rectangle of the output frame
+    struct Layer
+    {
+        std::shared_ptr<const Geometry> geometry;
+        Geometry::Channel               alpha;          // A of RGB4 input resampled to luma of the rectangle
+        mfxU16                          dst[4];         // X, Y, W, H
+        mfxI32                          globalAlpha;    // Q14, SCALE_ONE if disabled
+        bool                            pixelAlpha;     // RGB4 input with PixelAlphaEnable
+        bool                            lumaKey;        // YUV input with LumaKeyEnable
+        mfxI32                          lumaKeyMin;     // Q14
+        mfxI32                          lumaKeyMax;
+        bool                            opaque;         // input replaces the background
+    };
+
+    struct Composition
+    {
+        Geometry                                     canvas;         // output format and crop, no channels
+        mfxI16                                       background[3];  // Q14 of Y, U, V or R, G, B
+        std::vector<std::shared_ptr<const Layer> >   layers;         // bottom to top
+    };
+
+    class FrameCompositor
+    {
+    public:
+        FrameCompositor();
+
+        // Checks streams against the output frame, number of streams is limited by MAX_NUM_OF_VPP_COMPOSITE_STREAMS
+        static mfxStatus CheckParams(mfxExtVPPComposite const & composite, mfxFrameInfo const & out);
+
+        void Init(ScaleMethod method, bool bt709, bool fullRange, mfxExtVPPComposite const & composite);
+
+        mfxU32 GetNumStreams() const { return (mfxU32)m_streams.size(); }
+
+        // Returns processing of GetNumStreams() inputs, previous result is reused while frame infos don't change
+        std::shared_ptr<const Composition> GetComposition(mfxFrameInfo const * const * in, mfxFrameInfo const & out);
+
+        // Composes output rows of stripe 'region' of composition.canvas.numRegions, frame data must be locked
+        static void Run(Composition const & composition, mfxFrameData const * const * in, mfxFrameData & out, mfxU32 region);
+
+    protected:
+        std::shared_ptr<const Layer> GetLayer(mfxU32 index, mfxFrameInfo const & in, mfxFrameInfo const & out);
+
+        ScaleMethod                                  m_method;
+        std::vector<mfxVPPCompInputStream>           m_streams;
+        mfxU16                                       m_background[3];
+        std::vector<FrameScaler>                     m_scalers;      // one per stream
+        std::vector<std::shared_ptr<const Layer> >   m_layers;
+        std::shared_ptr<const Composition>           m_last;
+    };
+}
+
+#endif // __MFX_VPP_SW_COMPOSITE_H
+#endif // MFX_ENABLE_VPP
@@ -0,0 +1,247 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#ifndef __MFX_VPP_SW_SCALE_H
+#define __MFX_VPP_SW_SCALE_H
+
+#include <vector>
+#include <memory>
+
+// Software scaling and color conversion used by VideoVPP_SW.
+//
+// Every component of the output frame is produced by a separable filter:
+// source rows are converted to 16-bit samples in Q14 (fraction of the sample
+// range), filtered horizontally into a ring of rows and then vertically.
+// Chroma resampling between 4:2:0, 4:2:2 and 4:4:4 is a part of the scaling,
+// RGB <-> YCbCr matrices are applied when source rows are loaded (RGB input)
+// or when output rows are stored (RGB output).
+// Deinterlacing is a part of row loading too: rows of the dropped field are
+// interpolated from the kept field and, for motion adaptive mode, from the previous frame.
+namespace MfxSwVideoProcessing
+{
+    enum
+    {
+        SCALE_BITS = 14,
+        SCALE_ONE  = 1 << SCALE_BITS,
+        SCALE_MAX  = SCALE_ONE - 1
+    };
+
+    enum ScaleMethod
+    {
+        SCALE_NEAREST,
+        SCALE_BILINEAR,
+        SCALE_BICUBIC,
+        SCALE_LANCZOS
+    };
+
+    enum DeinterlaceMethod
+    {
+        DI_NONE,
+        DI_BOB,         // average of the rows above and below
+        DI_ADVANCED     // edge directed interpolation limited by the motion to the previous frame
+    };
+
+    // Resampling filter of one direction: output i is the sum of 'taps' source samples
+    // starting at offset[i] with coefficients summing to SCALE_ONE.
+    // Horizontal filters have taps aligned to 4 and store coefficients in blocks
+    // of 8 outputs x 4 taps (see FilterRowH_C), vertical filters store taps of every output in a row.
+    struct Filter
+    {
+        mfxU32              srcSize;
+        mfxU32              dstSize;
+        mfxU32              taps;
+        bool                identity;
+        std::vector<mfxI32> offset;
+        std::vector<mfxI16> coef;
+    };
+
+    void BuildFilter(Filter & filter, mfxU32 srcSize, mfxU32 dstSize, ScaleMethod method, bool horizontal);
+
+    // Row kernels, C and Intel AVX2 versions.
+    // FilterRowH reads up to offset[] + taps samples of src and writes width aligned to 8 samples,
+    // FilterRowV writes width aligned to 16 samples clipped to [0, SCALE_MAX].
+    void FilterRowH_C(const mfxI16 * src, mfxI16 * dst, mfxU32 width, const mfxI32 * offset, const mfxI16 * coef, mfxU32 taps);
+    void FilterRowV_C(const mfxI16 * const * src, mfxI16 * dst, mfxU32 width, const mfxI16 * coef, mfxU32 taps);
+    void LoadRow8_C(const mfxU8 * src, mfxI16 * dst, mfxU32 width);
+    void StoreRow8_C(const mfxI16 * src, mfxU8 * dst, mfxU32 width);
+
+    void FilterRowH_AVX2(const mfxI16 * src, mfxI16 * dst, mfxU32 width, const mfxI32 * offset, const mfxI16 * coef, mfxU32 taps);
+    void FilterRowV_AVX2(const mfxI16 * const * src, mfxI16 * dst, mfxU32 width, const mfxI16 * coef, mfxU32 taps);
+    void LoadRow8_AVX2(const mfxU8 * src, mfxI16 * dst, mfxU32 width);
+    void StoreRow8_AVX2(const mfxI16 * src, mfxU8 * dst, mfxU32 width);
+
+    // dst += (src - dst) * alpha, alpha is Q14 in [0, SCALE_ONE]
+    void BlendRow_C(const mfxI16 * src, const mfxI16 * alpha, mfxI16 * dst, mfxU32 width);
+    void BlendRow_AVX2(const mfxI16 * src, const mfxI16 * alpha, mfxI16 * dst, mfxU32 width);
+
+    // Missing row of a field, rows of the field above and below are readable at [-1, width].
+    // InterpolateRowELA picks the direction of the smallest difference among (-1, +1), (0, 0) and (+1, -1).
+    // InterpolateRowMA limits it to the temporal prediction +/- motion: 'cur' is the row of the other
+    // field of the frame, 'ref', 'refAbove' and 'refBelow' are rows of the previous frame.
+    void InterpolateRowELA_C(const mfxI16 * above, const mfxI16 * below, mfxI16 * dst, mfxU32 width);
+    void InterpolateRowMA_C(const mfxI16 * above, const mfxI16 * below, const mfxI16 * cur,
+                            const mfxI16 * ref, const mfxI16 * refAbove, const mfxI16 * refBelow,
+                            mfxI16 * dst, mfxU32 width, bool first);
+
+    void InterpolateRowELA_AVX2(const mfxI16 * above, const mfxI16 * below, mfxI16 * dst, mfxU32 width);
+    void InterpolateRowMA_AVX2(const mfxI16 * above, const mfxI16 * below, const mfxI16 * cur,
+                               const mfxI16 * ref, const mfxI16 * refAbove, const mfxI16 * refBelow,
+                               mfxI16 * dst, mfxU32 width, bool first);
+
+    // versions selected for the CPU
+    struct Kernels
+    {
+        void (*FilterRowH)(const mfxI16 *, mfxI16 *, mfxU32, const mfxI32 *, const mfxI16 *, mfxU32);
+        void (*FilterRowV)(const mfxI16 * const *, mfxI16 *, mfxU32, const mfxI16 *, mfxU32);
+        void (*LoadRow8)(const mfxU8 *, mfxI16 *, mfxU32);
+        void (*StoreRow8)(const mfxI16 *, mfxU8 *, mfxU32);
+        void (*BlendRow)(const mfxI16 *, const mfxI16 *, mfxI16 *, mfxU32);
+        void (*InterpolateRowELA)(const mfxI16 *, const mfxI16 *, mfxI16 *, mfxU32);
+        void (*InterpolateRowMA)(const mfxI16 *, const mfxI16 *, const mfxI16 *, const mfxI16 *, const mfxI16 *, const mfxI16 *, mfxI16 *, mfxU32, bool);
+    };
+
+    Kernels const & GetKernels();
+
+    // Q14 matrix of RGB -> YCbCr (rows Y, Cb, Cr, columns R, G, B) or
+    // YCbCr -> RGB (rows R, G, B, columns Y, Cb, Cr), offsets are in Q14 sample units
+    struct ColorMatrix
+    {
+        mfxI32 m[3][3];
+        mfxI32 offset[3];
+    };
+
+    void GetColorMatrix(ColorMatrix & matrix, bool toYUV, bool bt709, bool fullRange);
+
+    // Processing of one pair of input/output crop rectangles, shared by the tasks in flight
+    struct Geometry
+    {
+        struct Channel
+        {
+            mfxU32  src;        // input component: Y, U, V or B, G, R, A; Y, U, V of RGB input are computed
+            mfxU32  dst;        // output component
+            Filter  h;
+            Filter  v;
+        };
+
+        mfxU32               inFourCC;
+        mfxU32               outFourCC;
+        mfxU16               inShift;
+        mfxU16               outShift;
+        mfxU16               inCrop[4];     // X, Y, W, H
+        mfxU16               outCrop[4];
+        bool                 rgbIn;         // YCbCr channels are computed from RGB input
+        bool                 rgbOut;        // YCbCr channels are converted to RGB output
+        ColorMatrix          matrix;
+        DeinterlaceMethod    deinterlace;   // applied to the frames processed with a Field
+        mfxU32               numRegions;
+        std::vector<Channel> channels;
+    };
+
+    // One component of a frame inside the crop rectangle, samples of a row are 'step' elements apart
+    struct Plane
+    {
+        mfxU8 *         ptr;
+        mfxI32          pitch;
+        mfxU32          step;
+        mfxU32          width;
+        mfxU32          height;
+        mfxI32          field;      // parity of rows kept by deinterlacing, -1 if all rows are read
+        bool            first;      // kept field is the first one in time
+        const mfxU8 *   ref;        // same plane of the previous frame, NULL if there is none
+    };
+
+    // Field of interlaced input which is turned into the output frame
+    struct Field
+    {
+        mfxU32                  parity;     // 0 - top, 1 - bottom
+        bool                    first;
+        mfxFrameData const *    ref;        // previous input frame of the same layout or NULL
+    };
+
+    bool  Is16Bit(mfxU32 fourcc);
+    void  GetComponentRect(mfxU32 fourcc, const mfxU16 crop[4], mfxU32 comp, mfxU32 rect[4]);
+    Plane GetPlane(mfxFrameData const & data, mfxU32 fourcc, const mfxU16 crop[4], mfxU32 comp);
+
+    // Writes Q14 samples to output row of the plane in geometry.outFourCC format
+    void  StoreRow(Geometry const & geometry, Plane const & plane, mfxU32 row, const mfxI16 * src);
+
+    // Buffers of one RowScaler, may be reused by the next one
+    struct RowScratch
+    {
+        std::vector<mfxI16>          load;
+        std::vector<mfxI16>          ring;
+        std::vector<mfxI32>          ringRow;
+        std::vector<const mfxI16 *>  rows;
+        std::vector<mfxI16>          out;
+        std::vector<mfxI16>          field;     // rows around an interpolated one
+    };
+
+    // Produces output rows of one channel in increasing order, keeps horizontally
+    // filtered source rows in a ring of v.taps rows
+    class RowScaler
+    {
+    public:
+        RowScaler(Geometry const & geometry, Geometry::Channel const & channel, Plane const * planes, RowScratch & scratch);
+
+        // Returns channel.h.dstSize samples of output row y
+        const mfxI16 * GetRow(mfxU32 y);
+
+    protected:
+        void Fill(mfxU32 row, mfxI16 * dst);
+
+        Geometry const &             m_geo;
+        Geometry::Channel const &    m_channel;
+        Plane const *                m_planes;
+        Kernels const &              m_kernels;
+        mfxU32                       m_rowSize;
+        RowScratch &                 m_scratch;
+    };
+
+    class FrameScaler
+    {
+    public:
+        FrameScaler();
+
+        static bool IsFormatSupported(mfxU32 fourcc);
+
+        void Init(ScaleMethod method, bool bt709, bool fullRange, DeinterlaceMethod deinterlace = DI_NONE);
+
+        // Returns processing of in/out crops, previous result is reused while crops don't change
+        std::shared_ptr<const Geometry> GetGeometry(mfxFrameInfo const & in, mfxFrameInfo const & out);
+
+        // Produces output rows of part 'region' of geometry.numRegions, frame data must be locked.
+        // Input is deinterlaced by geometry.deinterlace if 'field' is set.
+        static void Run(Geometry const & geometry, mfxFrameData const & in, mfxFrameData & out, mfxU32 region, Field const * field = 0);
+
+    protected:
+        ScaleMethod                      m_method;
+        bool                             m_bt709;
+        bool                             m_fullRange;
+        DeinterlaceMethod                m_deinterlace;
+        std::shared_ptr<const Geometry>  m_last;
+    };
+}
+
+#endif // __MFX_VPP_SW_SCALE_H
+#endif // MFX_ENABLE_VPP
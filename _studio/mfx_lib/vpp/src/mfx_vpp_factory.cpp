@@ -24,32 +24,46 @@
 
 #if defined (MFX_ENABLE_VPP) 
 #include "mfx_vpp_interface.h"
+#include "mfx_vpp_sw.h"
 
  
 #if defined (MFX_VA_LINUX)
     #include "mfx_vpp_vaapi.h"
+    #include "mfx_vpp_null.h"
+    #include "libmfx_core_interface.h"
 
 #endif
 
 using namespace MfxHwVideoProcessing;
 
 // platform switcher
-DriverVideoProcessing* MfxHwVideoProcessing::CreateVideoProcessing(VideoCORE* /*core*/)
+DriverVideoProcessing* MfxHwVideoProcessing::CreateVideoProcessing(VideoCORE* core)
 {
     //MFX_CHECK_NULL_PTR1( core );
     //assert( core );
     
 #if defined (MFX_VA_LINUX)
 
+    if (QueryCoreInterface<NullDeviceParam>(core, MFXINULLDEVICE_GUID))
+        return new NullVideoProcessing;
+
     return new VAAPIVideoProcessing;
 
 #else
     
+    (void)core;
     return NULL;
 
 #endif
 } // mfxStatus CreateVideoProcessing( VideoCORE* core )
 
+// implementation used when CreateVideoProcessing() gives no device
+VideoVPPBase* CreateVideoVPP_SW(VideoCORE* core, mfxStatus* sts)
+{
+    return new VideoVPP_SW(core, sts);
+
+} // VideoVPPBase* CreateVideoVPP_SW(VideoCORE* core, mfxStatus* sts)
+
 
 mfxStatus VPPHWResMng::CreateDevice(VideoCORE * core){
     MFX_CHECK_NULL_PTR1(core);
@@ -1851,6 +1851,8 @@ VideoVPPHW::VideoVPPHW(IOMode mode, VideoCORE *core)
 ,m_MctfIsFlushing(false)
 ,m_bMctfAllocatedMemory(false)
 ,m_pMctfCmDevice(nullptr)
+,m_pCpuMctf()
+,m_CpuMctfParams()
 #endif
 
 // cm devices
@@ -2360,12 +2362,10 @@ mfxStatus  VideoVPPHW::Init(
     {
         if (m_executeParams.bEnableMctf)
         {
+            // w/o CM device (e.g. the null device) InitMCTF falls back to MCTF on CPU
             m_pMctfCmDevice = m_pCmDevice;
             if (!m_pMctfCmDevice)
-            {
                 m_pMctfCmDevice = QueryCoreInterface<CmDevice>(m_pCore, MFXICORECM_GUID);
-                MFX_CHECK(m_pMctfCmDevice, MFX_ERR_UNDEFINED_BEHAVIOR);
-            }
 
             // create "Default" MCTF settings.
             IntMctfParams MctfConfig;
@@ -2388,10 +2388,13 @@ mfxStatus  VideoVPPHW::Init(
             MctfAPIControl = MctfAPIControl ? MctfAPIControl : &MctfAPIDefault;
             CMC::FillParamControl(&MctfConfig, MctfAPIControl);
 
-            m_pMCTFilter = std::make_shared<CMC>();
-            if (m_pMCTFilter)
-                sts = InitMCTF(par->vpp.Out, MctfConfig);
+            if (m_pMctfCmDevice)
+                m_pMCTFilter = std::make_shared<CMC>();
+            sts = InitMCTF(par->vpp.Out, MctfConfig);
             MFX_CHECK_STS(sts);
+            // MCTF on CPU runs with less references than requested
+            if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == sts && !bIsFilterSkipped)
+                return sts;
         }
     }
 #endif
@@ -2403,6 +2406,34 @@ mfxStatus  VideoVPPHW::Init(
 mfxStatus VideoVPPHW::InitMCTF(const mfxFrameInfo& info, const IntMctfParams& MctfConfig)
 {
     mfxStatus sts = MFX_ERR_NONE;
+
+    m_pCpuMctf.reset();
+
+    // there is no CM device: output of the driver is filtered on CPU, see RunCpuMctf
+    if (!m_pMctfCmDevice)
+    {
+        // delayed output needs the MCTF queue of video surfaces which is handled
+        // by CMC only, so the CPU filter works w/o delay with a past reference
+        // and the application is warned about the changed mode
+        IntMctfParams CpuConfig = MctfConfig;
+        if (MCTF_TEMPORAL_MODE_2REF == CpuConfig.TemporalMode || MCTF_TEMPORAL_MODE_4REF == CpuConfig.TemporalMode)
+        {
+            CpuConfig.TemporalMode = MCTF_TEMPORAL_MODE_1REF;
+            sts = MFX_WRN_INCOMPATIBLE_VIDEO_PARAM;
+        }
+
+        m_pCpuMctf.reset(new CpuMctf);
+        mfxStatus stsInit = m_pCpuMctf->MCTF_INIT(info, &CpuConfig);
+        if (MFX_ERR_NONE != stsInit)
+        {
+            m_pCpuMctf.reset();
+            MFX_RETURN(stsInit);
+        }
+
+        m_CpuMctfParams = CpuConfig;
+        return sts;
+    }
+
     if (m_pMCTFilter)
     {
         sts = m_pMCTFilter->MCTF_INIT(m_pCore, m_pMctfCmDevice, info, &MctfConfig);
@@ -2874,12 +2905,16 @@ mfxStatus VideoVPPHW::Reset(mfxVideoParam *par)
             MctfAPIControl = MctfAPIControl ? MctfAPIControl : &MctfAPIDefault;
             CMC::FillParamControl(&MctfConfig, MctfAPIControl);
 
-            m_pMCTFilter = std::make_shared<CMC>();
-
-            if (m_pMCTFilter)
-                sts = InitMCTF(par->vpp.Out, MctfConfig);
+            if (m_pMctfCmDevice)
+                m_pMCTFilter = std::make_shared<CMC>();
+            sts = InitMCTF(par->vpp.Out, MctfConfig);
             MFX_CHECK_STS(sts);
+            // MCTF on CPU runs with less references than requested
+            if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == sts && !bIsFilterSkipped)
+                return sts;
         }
+        else
+            m_pCpuMctf.reset();
     }
 #endif
 
@@ -2942,6 +2977,12 @@ mfxStatus VideoVPPHW::Close()
         m_pMCTFilter.reset();
         ClearCmSurfaces2D();
     }
+
+    if (m_pCpuMctf)
+    {
+        m_pCpuMctf->MCTF_CLOSE();
+        m_pCpuMctf.reset();
+    }
     /*
     if (m_pMctfCmDevice)
     {
@@ -4534,6 +4575,13 @@ mfxStatus VideoVPPHW::QueryTaskRoutine(void *pState, void *pParam, mfxU32 thread
 #ifdef MFX_ENABLE_MCTF
     }
 
+    // under the guard, the CPU filter takes the frames in order of the tasks
+    if (pHwVpp->m_pCpuMctf)
+    {
+        sts = pHwVpp->RunCpuMctf(pTask);
+        MFX_CHECK_STS(sts);
+    }
+
     if (pTask->bMCTF && pHwVpp->m_pMCTFilter)
     {
         guard.Unlock();
@@ -4714,6 +4762,81 @@ mfxStatus VideoVPPHW::QueryFromMctf(void *pState, void *pParam, bool bMctfReadyT
     */
     return sts;
 }
+
+mfxStatus VideoVPPHW::RunCpuMctf(DdiTask* pTask)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "HW_VPP: MCTF on CPU");
+    mfxStatus sts = MFX_ERR_NONE;
+
+    // the output is complete here: copy from an internal buffer of system surface
+    // was done by PostWorkOutSurface
+    mfxFrameSurface1* pOut = pTask->outputForApp.pSurf;
+    if (!pOut)
+        return MFX_ERR_NONE;
+
+    // run-time control of the input changes the parameters of Init/Reset
+    IntMctfParams control = m_CpuMctfParams;
+    mfxExtVppMctf* MctfControl = pTask->input.pSurf
+        ? reinterpret_cast<mfxExtVppMctf *>(GetExtendedBuffer(pTask->input.pSurf->Data.ExtParam, pTask->input.pSurf->Data.NumExtParam, MFX_EXTBUFF_VPP_MCTF))
+        : nullptr;
+    if (MctfControl)
+        CMC::FillParamControl(&control, MctfControl);
+
+    mfxFrameData outData = pOut->Data;
+    bool bLocked = false;
+    if (!outData.Y)
+    {
+        sts = m_pCore->LockExternalFrame(outData.MemId, &outData);
+        MFX_CHECK_STS(sts);
+        bLocked = true;
+    }
+
+    // the frame is copied to the queue as it is a reference of the next one
+    std::shared_ptr<CpuMctf::Frame> frame = m_pCpuMctf->MCTF_GetEmptySurface();
+
+    mfxFrameSurface1 src = {};
+    src.Info = pOut->Info;
+    src.Data = outData;
+    src.Data.MemId = 0;
+
+    mfxFrameSurface1 dst = {};
+    dst.Info = m_params.vpp.Out;
+    dst.Data = frame->data;
+
+    sts = m_pCore->DoFastCopyWrapper(
+        &dst,
+        MFX_MEMTYPE_INTERNAL_FRAME | MFX_MEMTYPE_SYSTEM_MEMORY,
+        &src,
+        MFX_MEMTYPE_INTERNAL_FRAME | MFX_MEMTYPE_SYSTEM_MEMORY);
+
+    if (MFX_ERR_NONE == sts)
+        sts = m_pCpuMctf->MCTF_PUT_FRAME(MctfControl ? &control : nullptr, frame, pOut->Info, pOut->Data.TimeStamp, pOut->Data.FrameOrder);
+
+    // there is no delay, the job of the frame is ready
+    std::shared_ptr<CpuMctf::Job> job;
+    if (MFX_ERR_NONE == sts)
+        sts = m_pCpuMctf->MCTF_GET_FRAME(job, false);
+
+    if (MFX_ERR_NONE == sts)
+    {
+        for (mfxU32 stage = 0; stage < CpuMctf::NUM_STAGES; stage++)
+        {
+            const mfxU32 numRegions = CpuMctf::GetNumRegions(*job, stage);
+            for (mfxU32 region = 0; region < numRegions; region++)
+                CpuMctf::Run(*job, stage, region, outData);
+        }
+    }
+
+    if (bLocked)
+    {
+        mfxStatus stsUnlock = m_pCore->UnlockExternalFrame(pOut->Data.MemId, &outData);
+        if (MFX_ERR_NONE == sts)
+            sts = stsUnlock;
+    }
+
+    MFX_CHECK_STS(sts);
+    return MFX_ERR_NONE;
+}
 #endif
 
 mfxStatus ValidateParams(mfxVideoParam *par, mfxVppCaps *caps, VideoCORE *core, bool bCorrectionEnable)
@@ -0,0 +1,503 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#include <string.h>
+#include <algorithm>
+
+#include "mfx_vpp_defs.h"
+#include "mfx_vpp_sw_composite.h"
+
+namespace MfxSwVideoProcessing
+{
+
+enum
+{
+    COMP_Y = 0,
+    COMP_A = 3,
+
+    // output luma rows composed by one call of Run(), even, so 4:2:0 chroma rows of stripes don't overlap
+    STRIPE_HEIGHT = 64
+};
+
+static inline mfxI32 Clip3(mfxI32 min, mfxI32 max, mfxI32 x)
+{
+    return x < min ? min : (x > max ? max : x);
+}
+
+static mfxU32 ShiftX(mfxU32 fourcc, mfxU32 comp)
+{
+    return (COMP_Y != comp && MFX_FOURCC_RGB4 != fourcc) ? 1 : 0;
+}
+
+static mfxU32 ShiftY(mfxU32 fourcc, mfxU32 comp)
+{
+    return (ShiftX(fourcc, comp) && MFX_FOURCC_YUY2 != fourcc) ? 1 : 0;
+}
+
+/* ******************************************************************** */
+/*                          FrameCompositor                             */
+/* ******************************************************************** */
+
+FrameCompositor::FrameCompositor()
+    : m_method(SCALE_BICUBIC)
+    , m_streams()
+    , m_scalers()
+    , m_layers()
+    , m_last()
+{
+    memset(m_background, 0, sizeof(m_background));
+}
+
+mfxStatus FrameCompositor::CheckParams(mfxExtVPPComposite const & composite, mfxFrameInfo const & out)
+{
+    MFX_CHECK(composite.NumInputStream > 0 && composite.NumInputStream <= MAX_NUM_OF_VPP_COMPOSITE_STREAMS, MFX_ERR_UNSUPPORTED);
+    MFX_CHECK_NULL_PTR1(composite.InputStream);
+
+    for (mfxU32 i = 0; i < composite.NumInputStream; i++)
+    {
+        mfxVPPCompInputStream const & stream = composite.InputStream[i];
+
+        MFX_CHECK(stream.DstW && stream.DstH, MFX_ERR_INVALID_VIDEO_PARAM);
+
+        // sub-stream is out of range
+        MFX_CHECK((mfxU64)stream.DstX + stream.DstW <= out.Width,  MFX_ERR_INVALID_VIDEO_PARAM);
+        MFX_CHECK((mfxU64)stream.DstY + stream.DstH <= out.Height, MFX_ERR_INVALID_VIDEO_PARAM);
+    }
+
+    return MFX_ERR_NONE;
+}
+
+void FrameCompositor::Init(ScaleMethod method, bool bt709, bool fullRange, mfxExtVPPComposite const & composite)
+{
+    m_method = method;
+    m_streams.assign(composite.InputStream, composite.InputStream + composite.NumInputStream);
+
+    // R, G, B share storage with Y, U, V
+    m_background[0] = composite.Y;
+    m_background[1] = composite.U;
+    m_background[2] = composite.V;
+
+    m_scalers.assign(m_streams.size(), FrameScaler());
+    for (size_t i = 0; i < m_scalers.size(); i++)
+        m_scalers[i].Init(method, bt709, fullRange);
+
+    m_layers.assign(m_streams.size(), std::shared_ptr<const Layer>());
+    m_last.reset();
+}
+
+std::shared_ptr<const Layer> FrameCompositor::GetLayer(mfxU32 index, mfxFrameInfo const & in, mfxFrameInfo const & out)
+{
+    mfxVPPCompInputStream const & stream = m_streams[index];
+
+    // input is scaled into its rectangle of the output
+    mfxFrameInfo rect = out;
+    rect.CropX = (mfxU16)stream.DstX;
+    rect.CropY = (mfxU16)stream.DstY;
+    rect.CropW = (mfxU16)stream.DstW;
+    rect.CropH = (mfxU16)stream.DstH;
+
+    std::shared_ptr<const Geometry> geometry = m_scalers[index].GetGeometry(in, rect);
+
+    if (m_layers[index] && m_layers[index]->geometry == geometry)
+        return m_layers[index];
+
+    std::shared_ptr<Layer> layer = std::make_shared<Layer>();
+    const bool rgbIn = MFX_FOURCC_RGB4 == in.FourCC;
+    const mfxU32 keyShift = SCALE_BITS - (Is16Bit(in.FourCC) ? 10 : 8);
+
+    layer->geometry    = geometry;
+    layer->dst[0]      = rect.CropX;
+    layer->dst[1]      = rect.CropY;
+    layer->dst[2]      = rect.CropW;
+    layer->dst[3]      = rect.CropH;
+    layer->globalAlpha = stream.GlobalAlphaEnable ? (std::min<mfxI32>(stream.GlobalAlpha, 255) * SCALE_ONE + 127) / 255 : SCALE_ONE;
+    // YUV formats supported here have no alpha, luma key is defined for YUV only
+    layer->pixelAlpha  = rgbIn && stream.PixelAlphaEnable;
+    layer->lumaKey     = !rgbIn && stream.LumaKeyEnable;
+    layer->lumaKeyMin  = (mfxI32)stream.LumaKeyMin << keyShift;
+    layer->lumaKeyMax  = (mfxI32)stream.LumaKeyMax << keyShift;
+    layer->opaque      = !layer->pixelAlpha && !layer->lumaKey && SCALE_ONE == layer->globalAlpha;
+
+    layer->alpha.src = COMP_A;
+    layer->alpha.dst = COMP_A;
+
+    if (layer->pixelAlpha)
+    {
+        BuildFilter(layer->alpha.h, in.CropW, rect.CropW, m_method, true);
+        BuildFilter(layer->alpha.v, in.CropH, rect.CropH, m_method, false);
+    }
+
+    m_layers[index] = layer;
+
+    return m_layers[index];
+}
+
+std::shared_ptr<const Composition> FrameCompositor::GetComposition(mfxFrameInfo const * const * in, mfxFrameInfo const & out)
+{
+    const mfxU16 outCrop[4] = { out.CropX, out.CropY, out.CropW, out.CropH };
+    const mfxU16 outShift   = (Is16Bit(out.FourCC) && out.Shift) ? 6 : 0;
+
+    bool reuse = m_last &&
+        m_last->canvas.outFourCC == out.FourCC && m_last->canvas.outShift == outShift &&
+        std::equal(outCrop, outCrop + 4, m_last->canvas.outCrop);
+
+    std::vector<std::shared_ptr<const Layer> > layers(m_streams.size());
+
+    for (mfxU32 i = 0; i < m_streams.size(); i++)
+    {
+        layers[i] = GetLayer(i, *in[i], out);
+        reuse = reuse && layers[i] == m_last->layers[i];
+    }
+
+    if (reuse)
+        return m_last;
+
+    std::shared_ptr<Composition> composition = std::make_shared<Composition>();
+    Geometry & canvas = composition->canvas;
+
+    canvas.inFourCC   = out.FourCC;
+    canvas.outFourCC  = out.FourCC;
+    canvas.inShift    = outShift;
+    canvas.outShift   = outShift;
+    std::copy(outCrop, outCrop + 4, canvas.inCrop);
+    std::copy(outCrop, outCrop + 4, canvas.outCrop);
+    canvas.numRegions = (out.CropH + STRIPE_HEIGHT - 1) / STRIPE_HEIGHT;
+
+    // background is given in sample bits of the output
+    const mfxU32 shift = SCALE_BITS - (Is16Bit(out.FourCC) ? 10 : 8);
+    for (mfxU32 c = 0; c < 3; c++)
+        composition->background[c] = (mfxI16)std::min<mfxI32>((mfxI32)m_background[c] << shift, SCALE_MAX);
+
+    composition->layers.swap(layers);
+
+    m_last = composition;
+
+    return m_last;
+}
+
+/* ******************************************************************** */
+/*                            stripe blending                           */
+/* ******************************************************************** */
+
+// Q14 canvas of one stripe and buffers of its composition
+struct Stripe
+{
+    mfxU32               rect[3][4];     // components of the output crop in frame coordinates
+    mfxU32               top[3];         // rows of the stripe
+    mfxU32               bottom[3];
+    std::vector<mfxI16>  rows[3];
+    std::vector<mfxI16>  mask;           // opacity of the current layer at luma grid
+    std::vector<mfxI16>  alpha;          // opacity of the row being blended
+    std::vector<mfxI16>  rgb[3];
+    RowScratch           scratch[4];
+};
+
+// Part of a layer component inside the stripe
+struct Span
+{
+    mfxU32  y0, y1;      // frame rows
+    mfxU32  x0, x1;      // frame columns
+};
+
+static bool Intersect(Stripe const & stripe, mfxU32 comp, const mfxU32 rect[4], Span & span)
+{
+    span.y0 = std::max(rect[1], stripe.top[comp]);
+    span.y1 = std::min(rect[1] + rect[3], stripe.bottom[comp]);
+    span.x0 = std::max(rect[0], stripe.rect[comp][0]);
+    span.x1 = std::min(rect[0] + rect[2], stripe.rect[comp][0] + stripe.rect[comp][2]);
+
+    return span.y0 < span.y1 && span.x0 < span.x1;
+}
+
+static void InitStripe(Composition const & composition, mfxU32 region, Stripe & stripe)
+{
+    Geometry const & canvas = composition.canvas;
+
+    for (mfxU32 c = 0; c < 3; c++)
+    {
+        GetComponentRect(canvas.outFourCC, canvas.outCrop, c, stripe.rect[c]);
+
+        const mfxU32 sy = ShiftY(canvas.outFourCC, c);
+        const mfxU32 y0 = canvas.outCrop[1] + region * STRIPE_HEIGHT;
+
+        // the last stripe takes the rows rounded outwards
+        stripe.top[c]    = y0 >> sy;
+        stripe.bottom[c] = (region + 1 == canvas.numRegions) ? stripe.rect[c][1] + stripe.rect[c][3] : (y0 + STRIPE_HEIGHT) >> sy;
+
+        stripe.rows[c].assign((stripe.bottom[c] - stripe.top[c]) * stripe.rect[c][2], composition.background[c]);
+    }
+}
+
+static mfxI16 * GetStripeRow(Stripe & stripe, mfxU32 comp, mfxU32 y, mfxU32 x)
+{
+    return &stripe.rows[comp][(y - stripe.top[comp]) * stripe.rect[comp][2] + x - stripe.rect[comp][0]];
+}
+
+static void GetPlanes(Geometry const & geo, mfxFrameData const & in, Plane planes[4])
+{
+    for (mfxU32 c = 0; c < 4; c++)
+        planes[c] = (c < 3 || MFX_FOURCC_RGB4 == geo.inFourCC) ? GetPlane(in, geo.inFourCC, geo.inCrop, c) : Plane();
+}
+
+// Opacity of layer samples, 'luma' is used by luma key, 'alpha' is A of the input in Q14
+static void BuildMask(Layer const & layer, const mfxI16 * luma, const mfxI16 * alpha, mfxI16 * mask, mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+    {
+        mfxI32 a = layer.globalAlpha;
+
+        if (alpha)
+        {
+            // 255 << 6 is opaque
+            const mfxI32 pixel = std::min<mfxI32>((alpha[x] * 256 + 127) / 255, SCALE_ONE);
+            a = (a * pixel + (1 << (SCALE_BITS - 1))) >> SCALE_BITS;
+        }
+
+        if (layer.lumaKey && luma[x] >= layer.lumaKeyMin && luma[x] <= layer.lumaKeyMax)
+            a = 0;
+
+        mask[x] = (mfxI16)a;
+    }
+}
+
+static void ConvertRowRGB(ColorMatrix const & matrix, const mfxI16 * y, const mfxI16 * u, const mfxI16 * v, mfxI16 * const rgb[3], mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+    {
+        const mfxI32 Y  = y[x] - matrix.offset[0];
+        const mfxI32 Cb = u[x] - matrix.offset[1];
+        const mfxI32 Cr = v[x] - matrix.offset[2];
+
+        for (mfxU32 k = 0; k < 3; k++)
+        {
+            const mfxI32 s = matrix.m[k][0] * Y + matrix.m[k][1] * Cb + matrix.m[k][2] * Cr;
+            rgb[k][x] = (mfxI16)Clip3(0, SCALE_MAX, (s + (1 << (SCALE_BITS - 1))) >> SCALE_BITS);
+        }
+    }
+}
+
+// YUV output: luma rows build the opacity mask, chroma takes the average of co-sited luma opacity
+static void ComposeLayerYUV(Layer const & layer, mfxFrameData const & in, Stripe & stripe)
+{
+    Geometry const & geo = *layer.geometry;
+    Kernels const & kernels = GetKernels();
+
+    mfxU32 luma[4];
+    Span span;
+
+    GetComponentRect(geo.outFourCC, layer.dst, COMP_Y, luma);
+
+    // mask must cover chroma of the stripe, so invisible luma skips the layer
+    if (!Intersect(stripe, COMP_Y, luma, span))
+        return;
+
+    Plane src[4];
+    GetPlanes(geo, in, src);
+
+    const mfxU32 maskY0 = span.y0;
+    const mfxU32 maskY1 = span.y1;
+
+    {
+        RowScaler scaler(geo, geo.channels[COMP_Y], src, stripe.scratch[0]);
+        RowScaler alpha(geo, layer.alpha, src, stripe.scratch[1]);
+
+        if (!layer.opaque)
+            stripe.mask.resize((maskY1 - maskY0) * luma[2]);
+
+        for (mfxU32 y = span.y0; y < span.y1; y++)
+        {
+            const mfxI16 * row = scaler.GetRow(y - luma[1]);
+            mfxI16 * dst = GetStripeRow(stripe, COMP_Y, y, span.x0);
+
+            if (layer.opaque)
+            {
+                memcpy(dst, row + span.x0 - luma[0], (span.x1 - span.x0) * sizeof(mfxI16));
+                continue;
+            }
+
+            mfxI16 * mask = &stripe.mask[(y - maskY0) * luma[2]];
+            BuildMask(layer, row, layer.pixelAlpha ? alpha.GetRow(y - luma[1]) : 0, mask, luma[2]);
+
+            kernels.BlendRow(row + span.x0 - luma[0], mask + span.x0 - luma[0], dst, span.x1 - span.x0);
+        }
+    }
+
+    for (mfxU32 c = 1; c < 3; c++)
+    {
+        mfxU32 rect[4];
+        GetComponentRect(geo.outFourCC, layer.dst, c, rect);
+
+        if (!Intersect(stripe, c, rect, span))
+            continue;
+
+        const mfxU32 sx = ShiftX(geo.outFourCC, c);
+        const mfxU32 sy = ShiftY(geo.outFourCC, c);
+        const mfxU32 n  = span.x1 - span.x0;
+
+        RowScaler scaler(geo, geo.channels[c], src, stripe.scratch[0]);
+
+        stripe.alpha.resize(n);
+
+        for (mfxU32 y = span.y0; y < span.y1; y++)
+        {
+            const mfxI16 * row = scaler.GetRow(y - rect[1]) + span.x0 - rect[0];
+            mfxI16 * dst = GetStripeRow(stripe, c, y, span.x0);
+
+            if (layer.opaque)
+            {
+                memcpy(dst, row, n * sizeof(mfxI16));
+                continue;
+            }
+
+            // luma rows and columns of the chroma sample, clamped to the mask
+            const mfxU32 r0 = Clip3(maskY0, maskY1 - 1, y << sy) - maskY0;
+            const mfxU32 r1 = Clip3(maskY0, maskY1 - 1, (y << sy) + sy) - maskY0;
+            const mfxI16 * m0 = &stripe.mask[r0 * luma[2]];
+            const mfxI16 * m1 = &stripe.mask[r1 * luma[2]];
+
+            for (mfxU32 i = 0; i < n; i++)
+            {
+                const mfxI32 x  = (mfxI32)((span.x0 + i) << sx) - (mfxI32)luma[0];
+                const mfxU32 c0 = Clip3(0, luma[2] - 1, x);
+                const mfxU32 c1 = Clip3(0, luma[2] - 1, x + (mfxI32)sx);
+
+                stripe.alpha[i] = (mfxI16)((m0[c0] + m0[c1] + m1[c0] + m1[c1] + 2) >> 2);
+            }
+
+            kernels.BlendRow(row, &stripe.alpha[0], dst, n);
+        }
+    }
+}
+
+// RGB output: YUV inputs are converted to RGB before blending
+static void ComposeLayerRGB(Layer const & layer, mfxFrameData const & in, Stripe & stripe)
+{
+    Geometry const & geo = *layer.geometry;
+    Kernels const & kernels = GetKernels();
+
+    mfxU32 rect[4];
+    Span span;
+
+    GetComponentRect(geo.outFourCC, layer.dst, COMP_Y, rect);
+
+    if (!Intersect(stripe, COMP_Y, rect, span))
+        return;
+
+    Plane src[4];
+    GetPlanes(geo, in, src);
+
+    const mfxU32 offset = span.x0 - rect[0];
+    const mfxU32 n      = span.x1 - span.x0;
+
+    RowScaler scaler0(geo, geo.channels[0], src, stripe.scratch[0]);
+    RowScaler scaler1(geo, geo.channels[1], src, stripe.scratch[1]);
+    RowScaler scaler2(geo, geo.channels[2], src, stripe.scratch[2]);
+    RowScaler alpha(geo, layer.alpha, src, stripe.scratch[3]);
+
+    mfxI16 * rgb[3];
+    for (mfxU32 k = 0; k < 3; k++)
+    {
+        stripe.rgb[k].resize(n);
+        rgb[k] = &stripe.rgb[k][0];
+    }
+
+    stripe.alpha.resize(n);
+
+    for (mfxU32 y = span.y0; y < span.y1; y++)
+    {
+        const mfxU32 row = y - rect[1];
+        const mfxI16 * comp[3] =
+        {
+            scaler0.GetRow(row) + offset,
+            scaler1.GetRow(row) + offset,
+            scaler2.GetRow(row) + offset
+        };
+
+        if (!layer.opaque)
+            BuildMask(layer, comp[COMP_Y], layer.pixelAlpha ? alpha.GetRow(row) + offset : 0, &stripe.alpha[0], n);
+
+        if (geo.rgbOut)
+        {
+            ConvertRowRGB(geo.matrix, comp[0], comp[1], comp[2], rgb, n);
+            std::copy(rgb, rgb + 3, comp);
+        }
+
+        for (mfxU32 k = 0; k < 3; k++)
+        {
+            mfxI16 * dst = GetStripeRow(stripe, k, y, span.x0);
+
+            if (layer.opaque)
+                memcpy(dst, comp[k], n * sizeof(mfxI16));
+            else
+                kernels.BlendRow(comp[k], &stripe.alpha[0], dst, n);
+        }
+    }
+}
+
+static void StoreStripe(Geometry const & canvas, Stripe const & stripe, mfxFrameData & out)
+{
+    for (mfxU32 c = 0; c < 3; c++)
+    {
+        const Plane plane = GetPlane(out, canvas.outFourCC, canvas.outCrop, c);
+        const mfxU32 width = stripe.rect[c][2];
+
+        for (mfxU32 y = stripe.top[c]; y < stripe.bottom[c]; y++)
+            StoreRow(canvas, plane, y - stripe.rect[c][1], &stripe.rows[c][(y - stripe.top[c]) * width]);
+    }
+
+    if (MFX_FOURCC_RGB4 == canvas.outFourCC)
+    {
+        const Plane plane = GetPlane(out, canvas.outFourCC, canvas.outCrop, COMP_A);
+
+        for (mfxU32 y = stripe.top[COMP_Y]; y < stripe.bottom[COMP_Y]; y++)
+        {
+            mfxU8 * a = plane.ptr + (y - stripe.rect[COMP_Y][1]) * plane.pitch;
+
+            for (mfxU32 x = 0; x < plane.width; x++)
+                a[4 * x] = 255;
+        }
+    }
+}
+
+void FrameCompositor::Run(Composition const & composition, mfxFrameData const * const * in, mfxFrameData & out, mfxU32 region)
+{
+    const bool rgbOut = MFX_FOURCC_RGB4 == composition.canvas.outFourCC;
+
+    Stripe stripe;
+    InitStripe(composition, region, stripe);
+
+    for (size_t i = 0; i < composition.layers.size(); i++)
+    {
+        if (rgbOut)
+            ComposeLayerRGB(*composition.layers[i], *in[i], stripe);
+        else
+            ComposeLayerYUV(*composition.layers[i], *in[i], stripe);
+    }
+
+    StoreStripe(composition.canvas, stripe, out);
+}
+
+} // namespace MfxSwVideoProcessing
+
+#endif // MFX_ENABLE_VPP
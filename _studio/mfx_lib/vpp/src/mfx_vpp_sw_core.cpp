@@ -54,20 +54,54 @@ VideoVPPBase* CreateAndInitVPPImpl(mfxVideoParam *par, VideoCORE *core, mfxStatu
         if (*mfxSts < MFX_ERR_NONE)
         {
             delete vpp;
-            return 0;
-        }
 
-        if(MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == *mfxSts ||
+            // parameters are rejected by the device, CPU fallback is only for the case w/o device
+            MfxHwVideoProcessing::mfxVppCaps caps;
+            if (MFX_ERR_NONE == VideoVPPHW::QueryCaps(core, caps))
+            {
+                return 0;
+            }
+
+            vpp = 0;
+            bHWInitFailed = true;
+        }
+        else if(MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == *mfxSts ||
             MFX_WRN_FILTER_SKIPPED == *mfxSts ||
             MFX_WRN_PARTIAL_ACCELERATION == *mfxSts ||
             MFX_ERR_NONE == *mfxSts)
         {
             return vpp;
         }
+        else
+        {
+            delete vpp;
+            vpp = 0;
+            bHWInitFailed = true;
+        }
+    }
+
+    if (bHWInitFailed || MFX_PLATFORM_HARDWARE != core->GetPlatformType())
+    {
+        vpp = CreateVideoVPP_SW(core, mfxSts);
+        if (*mfxSts != MFX_ERR_NONE)
+        {
+            delete vpp;
+            return 0;
+        }
+
+        *mfxSts = vpp->Init(par);
+        if (*mfxSts < MFX_ERR_NONE)
+        {
+            delete vpp;
+            return 0;
+        }
+
+        if (MFX_ERR_NONE == *mfxSts)
+        {
+            *mfxSts = MFX_WRN_PARTIAL_ACCELERATION;
+        }
 
-        delete vpp;
-        vpp = 0;
-        bHWInitFailed = true;
+        return vpp;
     }
 
     *mfxSts = MFX_ERR_UNSUPPORTED;
@@ -421,7 +455,34 @@ mfxStatus VideoVPPBase::QueryIOSurf(VideoCORE* core, mfxVideoParam *par, mfxFram
 
         mfxSts = CheckIOPattern_AndSetIOMemTypes(par->IOPattern, &(request[VPP_IN].Type), &(request[VPP_OUT].Type), bSWLib);
         MFX_CHECK_STS(mfxSts);
-        return (bSWLib)? MFX_ERR_UNSUPPORTED : MFX_ERR_NONE;
+
+        if (bSWLib)
+        {
+            // CPU fallback works w/o device only
+            MfxHwVideoProcessing::mfxVppCaps caps;
+            MFX_CHECK(MFX_ERR_NONE != VideoVPPHW::QueryCaps(core, caps), MFX_ERR_UNSUPPORTED);
+            MFX_CHECK(MFX_ERR_NONE == VideoVPP_SW::CheckParams(par), MFX_ERR_UNSUPPORTED);
+
+            // motion adaptive deinterlacing holds the previous input
+            bool refFrame = false;
+            if (MfxSwVideoProcessing::DI_NONE != VideoVPP_SW::GetDeinterlaceMethod(par, &refFrame, 0) && refFrame)
+            {
+                request[VPP_IN].NumFrameMin       += 1;
+                request[VPP_IN].NumFrameSuggested += 1;
+            }
+
+            // every stream of composition holds an input surface until the output is done
+            mfxExtVPPComposite * composite = reinterpret_cast<mfxExtVPPComposite *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_COMPOSITE));
+            if (composite)
+            {
+                request[VPP_IN].NumFrameMin       = std::max<mfxU16>(request[VPP_IN].NumFrameMin,       composite->NumInputStream * vppAsyncDepth);
+                request[VPP_IN].NumFrameSuggested = std::max<mfxU16>(request[VPP_IN].NumFrameSuggested, composite->NumInputStream * vppAsyncDepth);
+            }
+
+            return MFX_WRN_PARTIAL_ACCELERATION;
+        }
+
+        return MFX_ERR_NONE;
     }
     return MFX_ERR_NONE;
 
@@ -562,11 +623,13 @@ mfxStatus VideoVPPBase::QueryCaps(VideoCORE * core, MfxHwVideoProcessing::mfxVpp
         caps.uDeinterlacing      = 1; // "1" means general deinterlacing is supported
         caps.uVideoSignalInfo    = 1; // "1" means general VSI is supported
 
-        if (sts >= MFX_ERR_NONE)
+        if (MFX_ERR_NONE == sts)
            return sts;
     }
 
-    return MFX_ERR_UNSUPPORTED;
+    // no device, capabilities of CPU implementation
+    caps = MfxHwVideoProcessing::mfxVppCaps();
+    return VideoVPP_SW::QueryCaps(caps);
 } // mfxStatus VideoVPPBase::QueryCaps((VideoCORE * core, MfxHwVideoProcessing::mfxVppCaps& caps)
 
 
@@ -1140,21 +1203,17 @@ mfxStatus VideoVPPBase::Query(VideoCORE * core, mfxVideoParam *in, mfxVideoParam
             {
                 return mfxSts;
             }
-            else
-            {
-                // doesn't support sw fallback now so return MFX_ERR_UNSUPPORTED
-                // will return MFX_WRN_PARTIAL_ACCELERATION after enabling sw fallback
-                hwQuerySts = MFX_ERR_UNSUPPORTED;
-            }
-        }
-        else
-        {
-            MFX_RETURN(MFX_ERR_UNSUPPORTED);
+
+            // CPU fallback works w/o device only
+            MfxHwVideoProcessing::mfxVppCaps caps;
+            MFX_CHECK(MFX_ERR_NONE != VideoVPPHW::QueryCaps(core, caps), MFX_ERR_UNSUPPORTED);
         }
 
-        MFX_CHECK_STS(hwQuerySts);
+        // no device, check CPU implementation
+        mfxStatus swQuerySts = VideoVPP_SW::Query(core, out);
+        MFX_CHECK(swQuerySts >= MFX_ERR_NONE, MFX_ERR_UNSUPPORTED);
 
-        return mfxSts;
+        return (MFX_ERR_NONE != mfxSts) ? mfxSts : swQuerySts;
     }//else
 } // mfxStatus VideoVPPBase::Query(VideoCORE *core, mfxVideoParam *in, mfxVideoParam *out)
 
@@ -1321,6 +1380,7 @@ mfxStatus VideoVPP_HW::InternalInit(mfxVideoParam *par)
     CommonCORE* pCommonCore = NULL;
 
     bool bIsFilterSkipped  = false;
+    bool bIsParamChanged   = false;
     bool isFieldProcessing = IsFilterFound(&m_pipelineList[0], (mfxU32)m_pipelineList.size(), MFX_EXTBUFF_VPP_FIELD_PROCESSING)
                           || IsFilterFound(&m_pipelineList[0], (mfxU32)m_pipelineList.size(), MFX_EXTBUFF_VPP_FIELD_WEAVING)
                           || IsFilterFound(&m_pipelineList[0], (mfxU32)m_pipelineList.size(), MFX_EXTBUFF_VPP_FIELD_SPLITTING);
@@ -1340,12 +1400,17 @@ mfxStatus VideoVPP_HW::InternalInit(mfxVideoParam *par)
 
         m_pHWVPP.get()->SetCmDevice(device);
     }
-    sts = m_pHWVPP.get()->Init(par); // OK or ERR only
+    sts = m_pHWVPP.get()->Init(par);
     if (MFX_WRN_FILTER_SKIPPED == sts)
     {
         bIsFilterSkipped = true;
         sts = MFX_ERR_NONE;
     }
+    if (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == sts) // e.g. the mode of MCTF on CPU
+    {
+        bIsParamChanged = true;
+        sts = MFX_ERR_NONE;
+    }
     if (MFX_WRN_PARTIAL_ACCELERATION == sts) // doesn't support sw fallback
     {
         sts = MFX_ERR_INVALID_VIDEO_PARAM;
@@ -1357,7 +1422,9 @@ mfxStatus VideoVPP_HW::InternalInit(mfxVideoParam *par)
     MFX_CHECK_STS( sts );
 
 
-    return (bIsFilterSkipped) ? MFX_WRN_FILTER_SKIPPED : MFX_ERR_NONE;
+    if (bIsFilterSkipped)
+        return MFX_WRN_FILTER_SKIPPED;
+    return (bIsParamChanged) ? MFX_WRN_INCOMPATIBLE_VIDEO_PARAM : MFX_ERR_NONE;
 }
 
 mfxStatus VideoVPP_HW::Reset(mfxVideoParam *par)
@@ -1369,10 +1436,12 @@ mfxStatus VideoVPP_HW::Reset(mfxVideoParam *par)
 
 
     MFX_CHECK_STS(sts);
+    // e.g. the mode of MCTF on CPU
+    mfxStatus sts_wrn = (MFX_WRN_INCOMPATIBLE_VIDEO_PARAM == sts) ? sts : MFX_ERR_NONE;
 
     bool bCorrectionEnable = false;
     sts = CheckPlatformLimitations(m_core, *par, bCorrectionEnable);
-    return sts;
+    return (MFX_ERR_NONE == sts) ? sts_wrn : sts;
 }
 
 mfxStatus VideoVPP_HW::Close(void)
@@ -1463,5 +1532,791 @@ mfxStatus VideoVPP_HW::RunFrameVPP(mfxFrameSurface1* , mfxFrameSurface1* , mfxEx
 }
 
 
+/* ******************************************************************** */
+/*                 CPU implementation (no device)                       */
+/* ******************************************************************** */
+
+using namespace MfxSwVideoProcessing;
+
+static bool IsProgressive(mfxU16 picStruct)
+{
+    return MFX_PICSTRUCT_PROGRESSIVE == picStruct || MFX_PICSTRUCT_UNKNOWN == picStruct;
+}
+
+// frame of two fields, progressive frames may be marked with field order too
+static bool IsInterlaced(mfxU16 picStruct)
+{
+    return !(picStruct & MFX_PICSTRUCT_PROGRESSIVE) && (picStruct & (MFX_PICSTRUCT_FIELD_TFF | MFX_PICSTRUCT_FIELD_BFF));
+}
+
+// interlaced input is deinterlaced to progressive output only, single fields are not supported
+static bool IsPicStructSupported(mfxU16 inPicStruct, mfxU16 outPicStruct)
+{
+    if (MFX_PICSTRUCT_FIELD_TFF == inPicStruct || MFX_PICSTRUCT_FIELD_BFF == inPicStruct)
+        return MFX_PICSTRUCT_PROGRESSIVE == outPicStruct;
+
+    return IsProgressive(inPicStruct) && IsProgressive(outPicStruct);
+}
+
+static mfxStatus CheckSwPipeline(mfxVideoParam *par)
+{
+    std::vector<mfxU32> pipelineList;
+    mfxStatus sts = GetPipelineList(par, pipelineList, true);
+    MFX_CHECK_STS(sts);
+
+    for (size_t i = 0; i < pipelineList.size(); i++)
+    {
+        switch (pipelineList[i])
+        {
+        case MFX_EXTBUFF_VPP_CSC:
+        case MFX_EXTBUFF_VPP_CSC_OUT_RGB4:
+        case MFX_EXTBUFF_VPP_RESIZE:
+        case MFX_EXTBUFF_VPP_RSHIFT_IN:
+        case MFX_EXTBUFF_VPP_LSHIFT_OUT:
+        case MFX_EXTBUFF_VPP_SCALING:
+        case MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO:
+        case MFX_EXTBUFF_VPP_DI:
+        case MFX_EXTBUFF_VPP_DI_30i60p:
+            break;
+        case MFX_EXTBUFF_VPP_DEINTERLACING:
+        {
+            mfxExtVPPDeinterlacing * di = reinterpret_cast<mfxExtVPPDeinterlacing *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_DEINTERLACING));
+            MFX_CHECK(!di || MFX_DEINTERLACING_FIELD_WEAVING != di->Mode, MFX_ERR_UNSUPPORTED);
+            break;
+        }
+        case MFX_EXTBUFF_VPP_COMPOSITE:
+        {
+            // composition enabled by DOUSE has no stream rectangles
+            mfxExtVPPComposite * composite = reinterpret_cast<mfxExtVPPComposite *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_COMPOSITE));
+            MFX_CHECK(composite, MFX_ERR_UNSUPPORTED);
+
+            sts = FrameCompositor::CheckParams(*composite, par->vpp.Out);
+            MFX_CHECK_STS(sts);
+
+            // streams are composed as progressive frames, one output per composition
+            MFX_CHECK(IsProgressive(par->vpp.In.PicStruct), MFX_ERR_UNSUPPORTED);
+            MFX_CHECK(!IsFilterFound(&pipelineList[0], (mfxU32)pipelineList.size(), MFX_EXTBUFF_VPP_DI_30i60p), MFX_ERR_UNSUPPORTED);
+            break;
+        }
+#ifdef MFX_ENABLE_MCTF
+        case MFX_EXTBUFF_VPP_MCTF:
+            // frames of the output are filtered, NV12 only as by CMC; every input gives one output
+            MFX_CHECK(!par->vpp.Out.FourCC || MFX_FOURCC_NV12 == par->vpp.Out.FourCC, MFX_ERR_UNSUPPORTED);
+            MFX_CHECK(!IsFilterFound(&pipelineList[0], (mfxU32)pipelineList.size(), MFX_EXTBUFF_VPP_COMPOSITE), MFX_ERR_UNSUPPORTED);
+            MFX_CHECK(!IsFilterFound(&pipelineList[0], (mfxU32)pipelineList.size(), MFX_EXTBUFF_VPP_DI_30i60p), MFX_ERR_UNSUPPORTED);
+            break;
+#endif
+        default:
+            return MFX_ERR_UNSUPPORTED;
+        }
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus VideoVPP_SW::CheckParams(mfxVideoParam *par)
+{
+    MFX_CHECK_NULL_PTR1(par);
+
+    // frames are accessed by CPU
+    MFX_CHECK(par->IOPattern == (MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY), MFX_ERR_UNSUPPORTED);
+
+    MFX_CHECK(FrameScaler::IsFormatSupported(par->vpp.In.FourCC),  MFX_ERR_UNSUPPORTED);
+    MFX_CHECK(FrameScaler::IsFormatSupported(par->vpp.Out.FourCC), MFX_ERR_UNSUPPORTED);
+
+    MFX_CHECK(IsPicStructSupported(par->vpp.In.PicStruct, par->vpp.Out.PicStruct), MFX_ERR_UNSUPPORTED);
+
+    return CheckSwPipeline(par);
+}
+
+DeinterlaceMethod VideoVPP_SW::GetDeinterlaceMethod(mfxVideoParam *par, bool *refFrame, bool *mode30i60p)
+{
+    std::vector<mfxU32> pipelineList;
+    mfxStatus sts = GetPipelineList(par, pipelineList, true);
+
+    const mfxU32 * list = pipelineList.empty() ? 0 : &pipelineList[0];
+    const mfxU32   len  = (mfxU32)pipelineList.size();
+
+    const bool b30i60p = MFX_ERR_NONE == sts && IsFilterFound(list, len, MFX_EXTBUFF_VPP_DI_30i60p);
+
+    if (refFrame)
+        *refFrame = false;
+    if (mode30i60p)
+        *mode30i60p = b30i60p;
+
+    if (MFX_ERR_NONE != sts ||
+        !(b30i60p || IsFilterFound(list, len, MFX_EXTBUFF_VPP_DI) || IsFilterFound(list, len, MFX_EXTBUFF_VPP_DEINTERLACING)))
+    {
+        return DI_NONE;
+    }
+
+    // advanced mode by default as HW selects ADI when driver supports it
+    mfxExtVPPDeinterlacing * di = reinterpret_cast<mfxExtVPPDeinterlacing *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_DEINTERLACING));
+    if (di && MFX_DEINTERLACING_BOB == di->Mode)
+        return DI_BOB;
+
+    if (refFrame)
+        *refFrame = !(di && MFX_DEINTERLACING_ADVANCED_NOREF == di->Mode);
+
+    return DI_ADVANCED;
+}
+
+mfxStatus VideoVPP_SW::Query(VideoCORE *, mfxVideoParam *par)
+{
+    MFX_CHECK_NULL_PTR1(par);
+
+    mfxStatus sts = MFX_ERR_NONE;
+
+    if (par->IOPattern && par->IOPattern != (MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY))
+    {
+        par->IOPattern = 0;
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    if (par->vpp.In.FourCC && !FrameScaler::IsFormatSupported(par->vpp.In.FourCC))
+    {
+        par->vpp.In.FourCC = 0;
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    if (par->vpp.Out.FourCC && !FrameScaler::IsFormatSupported(par->vpp.Out.FourCC))
+    {
+        par->vpp.Out.FourCC = 0;
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    if (!IsProgressive(par->vpp.In.PicStruct) && !IsInterlaced(par->vpp.In.PicStruct))
+    {
+        par->vpp.In.PicStruct = 0;
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    if (!IsPicStructSupported(par->vpp.In.PicStruct, par->vpp.Out.PicStruct))
+    {
+        par->vpp.Out.PicStruct = 0;
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    if (MFX_ERR_NONE != CheckSwPipeline(par))
+    {
+        sts = MFX_ERR_UNSUPPORTED;
+    }
+
+    return (MFX_ERR_NONE == sts) ? MFX_WRN_PARTIAL_ACCELERATION : sts;
+
+} // mfxStatus VideoVPP_SW::Query(VideoCORE *, mfxVideoParam *par)
+
+mfxStatus VideoVPP_SW::QueryCaps(MfxHwVideoProcessing::mfxVppCaps& caps)
+{
+    const mfxU32 formats[] = { MFX_FOURCC_NV12, MFX_FOURCC_YV12, MFX_FOURCC_YUY2, MFX_FOURCC_P010, MFX_FOURCC_RGB4 };
+
+    for (mfxU32 i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        caps.mFormatSupport[formats[i]] = MFX_FORMAT_SUPPORT_INPUT | MFX_FORMAT_SUPPORT_OUTPUT;
+    }
+
+    caps.uScaling         = 1;
+    caps.uVideoSignalInfo = 1;
+    caps.uDeinterlacing   = 1;
+    caps.uSimpleDI        = 1;
+    caps.uAdvancedDI      = 1;
+#ifdef MFX_ENABLE_MCTF
+    caps.uMCTF            = 1;
+#endif
+
+    return MFX_WRN_PARTIAL_ACCELERATION;
+
+} // mfxStatus VideoVPP_SW::QueryCaps(MfxHwVideoProcessing::mfxVppCaps& caps)
+
+VideoVPP_SW::VideoVPP_SW(VideoCORE *core, mfxStatus* sts)
+    : VideoVPPBase(core, sts)
+    , m_scaler()
+    , m_compositor()
+    , m_bComposite(false)
+    , m_pending()
+    , m_deinterlace(DI_NONE)
+    , m_bRefFrame(false)
+    , m_b30i60p(false)
+    , m_prev(0)
+    , m_firstField(0)
+#ifdef MFX_ENABLE_MCTF
+    , m_mctf()
+    , m_mctfParams()
+#endif
+    , m_tasks()
+    , m_numTasks(0)
+    , m_guard()
+{
+}
+
+mfxStatus VideoVPP_SW::InternalInit(mfxVideoParam *par)
+{
+    mfxStatus sts = CheckParams(par);
+    MFX_CHECK(MFX_ERR_NONE == sts, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    sts = InitScaler(par);
+    MFX_CHECK_STS(sts);
+
+#ifdef MFX_ENABLE_MCTF
+    sts = InitMctf(par);
+    MFX_CHECK_STS(sts);
+#endif
+
+    // one task per frame in flight
+    m_numTasks = par->AsyncDepth ? par->AsyncDepth : m_core->GetAutoAsyncDepth();
+    m_tasks.reset(new SwTask[m_numTasks]);
+
+    for (mfxU32 i = 0; i < m_numTasks; i++)
+    {
+        m_tasks[i].busy       = false;
+        m_tasks[i].nextRegion = 0;
+#ifdef MFX_ENABLE_MCTF
+        m_tasks[i].doneRegions = 0;
+#endif
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus VideoVPP_SW::InitScaler(mfxVideoParam *par)
+{
+    ScaleMethod method = SCALE_BICUBIC;
+
+    mfxExtVPPScaling * scaling = reinterpret_cast<mfxExtVPPScaling *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_SCALING));
+    if (scaling)
+    {
+        if (MFX_SCALING_MODE_LOWPOWER == scaling->ScalingMode)
+            method = SCALE_BILINEAR;
+        else if (MFX_SCALING_MODE_QUALITY == scaling->ScalingMode)
+            method = SCALE_LANCZOS;
+
+#if (MFX_VERSION >= 1033)
+        switch (scaling->InterpolationMethod)
+        {
+        case MFX_INTERPOLATION_NEAREST_NEIGHBOR:
+            method = SCALE_NEAREST;
+            break;
+        case MFX_INTERPOLATION_BILINEAR:
+            method = SCALE_BILINEAR;
+            break;
+        case MFX_INTERPOLATION_ADVANCED:
+            method = SCALE_LANCZOS;
+            break;
+        default:
+            break;
+        }
+#endif
+    }
+
+    // matrix of YUV side of conversion, BT.601 limited range by default
+    bool bt709     = false;
+    bool fullRange = false;
+
+    mfxExtVPPVideoSignalInfo * vsi = reinterpret_cast<mfxExtVPPVideoSignalInfo *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_VIDEO_SIGNAL_INFO));
+    if (vsi)
+    {
+        const bool rgbIn = MFX_FOURCC_RGB4 == par->vpp.In.FourCC;
+
+        bt709     = MFX_TRANSFERMATRIX_BT709 == (rgbIn ? vsi->Out.TransferMatrix : vsi->In.TransferMatrix);
+        fullRange = MFX_NOMINALRANGE_0_255   == (rgbIn ? vsi->Out.NominalRange   : vsi->In.NominalRange);
+    }
+
+    m_deinterlace = GetDeinterlaceMethod(par, &m_bRefFrame, &m_b30i60p);
+
+    m_scaler.Init(method, bt709, fullRange, m_deinterlace);
+
+    // fields of the previous parameters are not used
+    SetPrevious(0);
+    m_firstField = 0;
+
+    mfxExtVPPComposite * composite = reinterpret_cast<mfxExtVPPComposite *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_COMPOSITE));
+    m_bComposite = (0 != composite);
+
+    // streams received for the previous parameters are dropped
+    ReleasePending();
+
+    if (m_bComposite)
+        m_compositor.Init(method, bt709, fullRange, *composite);
+
+    return MFX_ERR_NONE;
+}
+
+#ifdef MFX_ENABLE_MCTF
+// parameters are taken as by VideoVPPHW::Init, frames queued for the previous parameters are dropped
+mfxStatus VideoVPP_SW::InitMctf(mfxVideoParam *par)
+{
+    std::vector<mfxU32> pipelineList;
+    mfxStatus sts = GetPipelineList(par, pipelineList, true);
+    MFX_CHECK_STS(sts);
+
+    if (m_mctf)
+    {
+        m_mctf->MCTF_CLOSE();
+        m_mctf.reset();
+    }
+
+    if (!IsFilterFound(pipelineList.empty() ? 0 : &pipelineList[0], (mfxU32)pipelineList.size(), MFX_EXTBUFF_VPP_MCTF))
+        return MFX_ERR_NONE;
+
+    CMC::QueryDefaultParams(&m_mctfParams);
+
+    mfxExtVppMctf defaultControl;
+    CMC::QueryDefaultParams(&defaultControl);
+
+    mfxExtVppMctf * control = reinterpret_cast<mfxExtVppMctf *>(GetExtendedBuffer(par->ExtParam, par->NumExtParam, MFX_EXTBUFF_VPP_MCTF));
+    CMC::FillParamControl(&m_mctfParams, control ? control : &defaultControl);
+
+    m_mctf.reset(new CpuMctf);
+    sts = m_mctf->MCTF_INIT(par->vpp.Out, &m_mctfParams);
+    if (MFX_ERR_NONE != sts)
+    {
+        m_mctf.reset();
+        MFX_RETURN(sts);
+    }
+
+    return MFX_ERR_NONE;
+}
+#endif
+
+mfxStatus VideoVPP_SW::Reset(mfxVideoParam *par)
+{
+    mfxStatus sts = VideoVPPBase::Reset(par);
+    MFX_CHECK_STS(sts);
+
+    sts = CheckParams(par);
+    MFX_CHECK(MFX_ERR_NONE == sts, MFX_ERR_INVALID_VIDEO_PARAM);
+
+    sts = InitScaler(par);
+    MFX_CHECK_STS(sts);
+
+#ifdef MFX_ENABLE_MCTF
+    sts = InitMctf(par);
+    MFX_CHECK_STS(sts);
+#endif
+
+    bool bCorrectionEnable = false;
+    sts = CheckPlatformLimitations(m_core, *par, bCorrectionEnable);
+    return sts;
+}
+
+mfxStatus VideoVPP_SW::Close(void)
+{
+    mfxStatus sts = VideoVPPBase::Close();
+    ReleasePending();
+    SetPrevious(0);
+    m_firstField = 0;
+#ifdef MFX_ENABLE_MCTF
+    if (m_mctf)
+    {
+        m_mctf->MCTF_CLOSE();
+        m_mctf.reset();
+    }
+#endif
+    m_tasks.reset();
+    m_numTasks = 0;
+    return sts;
+
+} // mfxStatus VideoVPP_SW::Close(void)
+
+mfxStatus VideoVPP_SW::VppFrameCheck(mfxFrameSurface1 *in, mfxFrameSurface1 *out, mfxExtVppAuxData *aux,
+                                     MFX_ENTRY_POINT pEntryPoints[], mfxU32 &numEntryPoints)
+{
+    mfxStatus sts = VideoVPPBase::VppFrameCheck(in, out, aux, pEntryPoints, numEntryPoints);
+    MFX_CHECK_STS(sts);
+
+    // frames are delayed by MCTF only, incomplete composition is not processed
+    bool delayed = false;
+#ifdef MFX_ENABLE_MCTF
+    delayed = !!m_mctf;
+#endif
+    if (NULL == in && !delayed)
+    {
+        return MFX_ERR_MORE_DATA;
+    }
+
+    // streams of composition come one per call, output is produced for the last one
+    if (m_bComposite && m_pending.size() + 1 < m_compositor.GetNumStreams())
+    {
+        SwFrame frame;
+        sts = AcquireFrame(in, frame);
+        MFX_CHECK_STS(sts);
+
+        m_pending.push_back(frame);
+        return MFX_ERR_MORE_DATA;
+    }
+
+    SwTask * task = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        for (mfxU32 i = 0; i < m_numTasks && !task; i++)
+        {
+            if (!m_tasks[i].busy)
+                task = &m_tasks[i];
+        }
+
+        if (!task)
+        {
+            return MFX_WRN_DEVICE_BUSY;
+        }
+
+        task->busy = true;
+    }
+
+    task->in.swap(m_pending);
+    task->out = SwFrame();
+    task->ref = SwFrame();
+    task->deinterlace = false;
+    task->timeStamp = in ? in->Data.TimeStamp : MFX_TIME_STAMP_INVALID;
+    task->nextRegion = 0;
+
+    if (in)
+    {
+        task->in.push_back(SwFrame());
+        sts = AcquireFrame(in, task->in.back());
+        if (MFX_ERR_NONE != sts)
+        {
+            ReleaseTask(*task);
+            MFX_RETURN(sts);
+        }
+    }
+
+    bool output = true;
+
+#ifdef MFX_ENABLE_MCTF
+    if (m_mctf)
+    {
+        if (in)
+        {
+            // run-time control of the frame changes the parameters of Init/Reset
+            IntMctfParams control = m_mctfParams;
+            mfxExtVppMctf * mctfControl = reinterpret_cast<mfxExtVppMctf *>(GetExtendedBuffer(in->Data.ExtParam, in->Data.NumExtParam, MFX_EXTBUFF_VPP_MCTF));
+            if (mctfControl)
+                CMC::FillParamControl(&control, mctfControl);
+
+            task->mctfIn = m_mctf->MCTF_GetEmptySurface();
+            sts = m_mctf->MCTF_PUT_FRAME(mctfControl ? &control : NULL, task->mctfIn, out->Info, in->Data.TimeStamp, in->Data.FrameOrder);
+            if (MFX_ERR_NONE != sts)
+            {
+                ReleaseTask(*task);
+                MFX_RETURN(sts);
+            }
+        }
+
+        sts = m_mctf->MCTF_GET_FRAME(task->mctfJob, NULL == in);
+        if (MFX_ERR_MORE_DATA == sts && NULL == in)
+        {
+            ReleaseTask(*task);
+            return MFX_ERR_MORE_DATA;
+        }
+
+        output = !!task->mctfJob;
+        if (output)
+            task->timeStamp = task->mctfJob->cur->timeStamp;
+    }
+#endif
+
+    if (output)
+    {
+        sts = AcquireFrame(out, task->out);
+        if (MFX_ERR_NONE != sts)
+        {
+            ReleaseTask(*task);
+            MFX_RETURN(sts);
+        }
+    }
+
+    mfxU32 numRegions = 0;
+
+    if (m_bComposite)
+    {
+        std::vector<const mfxFrameInfo *> info(task->in.size());
+
+        task->inData.resize(task->in.size());
+        for (size_t i = 0; i < task->in.size(); i++)
+        {
+            info[i]         = &task->in[i].surface->Info;
+            task->inData[i] = &task->in[i].data;
+        }
+
+        task->composition = m_compositor.GetComposition(&info[0], out->Info);
+        numRegions = task->composition->canvas.numRegions;
+    }
+    else if (in)
+    {
+        task->geometry = m_scaler.GetGeometry(in->Info, out->Info);
+        numRegions = task->geometry->numRegions;
+    }
+
+    // 30i60p: the first call outputs the first field, the second call with the same input outputs the other one
+    const bool secondField = m_b30i60p && in == m_firstField;
+    const mfxU16 picStruct = (!in || MFX_PICSTRUCT_UNKNOWN == in->Info.PicStruct) ? m_errPrtctState.In.PicStruct : in->Info.PicStruct;
+
+    if (in && DI_NONE != m_deinterlace && IsInterlaced(picStruct))
+    {
+        const mfxU32 firstParity = (picStruct & MFX_PICSTRUCT_FIELD_BFF) ? 1 : 0;
+
+        task->deinterlace  = true;
+        task->field.parity = secondField ? 1 - firstParity : firstParity;
+        task->field.first  = !secondField;
+        task->field.ref    = 0;
+
+        if (m_bRefFrame && m_prev &&
+            m_prev->Info.FourCC == in->Info.FourCC &&
+            m_prev->Info.CropX  == in->Info.CropX && m_prev->Info.CropY == in->Info.CropY &&
+            m_prev->Info.CropW  == in->Info.CropW && m_prev->Info.CropH == in->Info.CropH)
+        {
+            sts = AcquireFrame(m_prev, task->ref);
+            if (MFX_ERR_NONE != sts)
+            {
+                ReleaseTask(*task);
+                MFX_RETURN(sts);
+            }
+
+            task->field.ref = &task->ref.data;
+        }
+    }
+
+    if (secondField && MFX_TIME_STAMP_INVALID != task->timeStamp && m_errPrtctState.Out.FrameRateExtN)
+    {
+        task->timeStamp += (mfxU64)MFX_TIME_STAMP_FREQUENCY * m_errPrtctState.Out.FrameRateExtD / m_errPrtctState.Out.FrameRateExtN;
+    }
+
+#ifdef MFX_ENABLE_MCTF
+    if (m_mctf)
+    {
+        // scaling of the input goes first, the output frame may use it as the future reference
+        task->stageEnd.assign(1, numRegions);
+        for (mfxU32 stage = 0; stage < CpuMctf::NUM_STAGES; stage++)
+        {
+            const mfxU32 stageRegions = task->mctfJob ? CpuMctf::GetNumRegions(*task->mctfJob, stage) : 0;
+            task->stageEnd.push_back(task->stageEnd.back() + stageRegions);
+            numRegions = std::max(numRegions, stageRegions);
+        }
+        task->doneRegions = 0;
+    }
+#endif
+
+    pEntryPoints[0].pRoutine           = &VideoVPP_SW::TaskRoutine;
+    pEntryPoints[0].pCompleteProc      = &VideoVPP_SW::TaskComplete;
+    pEntryPoints[0].pState             = this;
+    pEntryPoints[0].pParam             = task;
+    pEntryPoints[0].requiredNumThreads = std::max<mfxU32>(1, std::min<mfxU32>(m_core->GetNumWorkingThreads(), numRegions));
+    pEntryPoints[0].pRoutineName       = (char *)"VPP SW";
+    numEntryPoints = 1;
+
+    if (output)
+    {
+        out->Info.PicStruct     = MFX_PICSTRUCT_PROGRESSIVE;
+        out->Info.FrameRateExtN = m_errPrtctState.Out.FrameRateExtN;
+        out->Info.FrameRateExtD = m_errPrtctState.Out.FrameRateExtD;
+
+        // primary stream of composition gives frame properties
+        if (!task->in.empty())
+        {
+            mfxFrameSurface1 * primary = task->in[0].surface;
+
+            out->Info.AspectRatioH = primary->Info.AspectRatioH;
+            out->Info.AspectRatioW = primary->Info.AspectRatioW;
+        }
+    }
+
+    if (m_b30i60p && !secondField)
+    {
+        m_firstField = in;
+        return MFX_ERR_MORE_SURFACE;
+    }
+
+    m_firstField = 0;
+
+    // input is done, it becomes the reference of the next one
+    if (m_bRefFrame && in)
+        SetPrevious(in);
+
+    // input is queued by MCTF, there is no output until the future references come
+    if (!output)
+        return (mfxStatus)MFX_ERR_MORE_DATA_SUBMIT_TASK;
+
+    return MFX_ERR_NONE;
+}
+
+// called by every thread of the task, takes regions until all are done
+mfxStatus VideoVPP_SW::TaskRoutine(void *, void *pParam, mfxU32, mfxU32)
+{
+    MFX_CHECK_NULL_PTR1(pParam);
+
+    SwTask & task = *(SwTask *)pParam;
+
+#ifdef MFX_ENABLE_MCTF
+    if (!task.stageEnd.empty())
+    {
+        return RunStages(task);
+    }
+#endif
+
+    if (task.composition)
+    {
+        Composition const & composition = *task.composition;
+
+        for (mfxU32 region = task.nextRegion++; region < composition.canvas.numRegions; region = task.nextRegion++)
+        {
+            FrameCompositor::Run(composition, &task.inData[0], task.out.data, region);
+        }
+
+        return MFX_TASK_DONE;
+    }
+
+    Geometry const & geometry = *task.geometry;
+
+    for (mfxU32 region = task.nextRegion++; region < geometry.numRegions; region = task.nextRegion++)
+    {
+        FrameScaler::Run(geometry, task.in[0].data, task.out.data, region, task.deinterlace ? &task.field : 0);
+    }
+
+    return MFX_TASK_DONE;
+}
+
+#ifdef MFX_ENABLE_MCTF
+// regions of all stages are numbered in order and taken one by one,
+// a region isn't taken until the regions of the previous stages are done:
+// the thread leaves with MFX_TASK_BUSY and the scheduler calls it again,
+// the thread which completes a stage returns MFX_TASK_WORKING to wake the waiting ones
+mfxStatus VideoVPP_SW::RunStages(SwTask & task)
+{
+    const mfxU32 numRegions = task.stageEnd.back();
+    mfxU32 stage = 0;
+
+    for (;;)
+    {
+        mfxU32 index = task.nextRegion;
+        if (index >= numRegions)
+            return MFX_TASK_DONE;
+
+        while (index >= task.stageEnd[stage])
+            stage++;
+
+        const mfxU32 stageBegin = stage ? task.stageEnd[stage - 1] : 0;
+        if (task.doneRegions < stageBegin)
+            return MFX_TASK_BUSY;
+
+        if (!task.nextRegion.compare_exchange_weak(index, index + 1))
+            continue;
+
+        if (0 == stage)
+            FrameScaler::Run(*task.geometry, task.in[0].data, task.mctfIn->data, index, task.deinterlace ? &task.field : 0);
+        else
+            CpuMctf::Run(*task.mctfJob, stage - 1, index - stageBegin, task.out.data);
+
+        if (++task.doneRegions == task.stageEnd[stage] && index + 1 < numRegions)
+            return MFX_TASK_WORKING;
+    }
+}
+#endif
+
+mfxStatus VideoVPP_SW::TaskComplete(void *pState, void *pParam, mfxStatus taskRes)
+{
+    MFX_CHECK_NULL_PTR2(pState, pParam);
+
+    VideoVPP_SW & vpp = *(VideoVPP_SW *)pState;
+    SwTask & task = *(SwTask *)pParam;
+
+    // task w/o output only puts the input to the MCTF queue
+    if (MFX_ERR_NONE == taskRes && task.out.surface)
+    {
+        task.out.surface->Data.TimeStamp = task.timeStamp;
+    }
+
+    vpp.ReleaseTask(task);
+
+    return MFX_ERR_NONE;
+}
+
+// takes reference to the surface and locks it if data pointers are not set
+mfxStatus VideoVPP_SW::AcquireFrame(mfxFrameSurface1 *surface, SwFrame & frame)
+{
+    frame.surface = surface;
+    frame.data    = surface->Data;
+    frame.locked  = false;
+
+    m_core->IncreaseReference(&surface->Data);
+
+    if (!frame.data.Y && !frame.data.U && !frame.data.V && !frame.data.A)
+    {
+        mfxStatus sts = m_core->LockExternalFrame(frame.data.MemId, &frame.data);
+        if (MFX_ERR_NONE != sts)
+        {
+            m_core->DecreaseReference(&surface->Data);
+            frame.surface = 0;
+            MFX_RETURN(sts);
+        }
+
+        frame.locked = true;
+    }
+
+    return MFX_ERR_NONE;
+}
+
+void VideoVPP_SW::ReleaseFrame(SwFrame & frame)
+{
+    if (!frame.surface)
+        return;
+
+    if (frame.locked)
+        m_core->UnlockExternalFrame(frame.data.MemId, &frame.data);
+
+    m_core->DecreaseReference(&frame.surface->Data);
+
+    frame.surface = 0;
+    frame.locked  = false;
+}
+
+void VideoVPP_SW::ReleaseTask(SwTask & task)
+{
+    for (size_t i = 0; i < task.in.size(); i++)
+        ReleaseFrame(task.in[i]);
+
+    ReleaseFrame(task.out);
+    ReleaseFrame(task.ref);
+
+    task.in.clear();
+    task.inData.clear();
+    task.geometry.reset();
+    task.composition.reset();
+#ifdef MFX_ENABLE_MCTF
+    task.mctfIn.reset();
+    task.mctfJob.reset();
+    task.stageEnd.clear();
+#endif
+
+    std::lock_guard<std::mutex> guard(m_guard);
+    task.busy = false;
+}
+
+void VideoVPP_SW::ReleasePending()
+{
+    for (size_t i = 0; i < m_pending.size(); i++)
+        ReleaseFrame(m_pending[i]);
+
+    m_pending.clear();
+}
+
+// keeps reference to the surface until the next input replaces it
+void VideoVPP_SW::SetPrevious(mfxFrameSurface1 *surface)
+{
+    if (surface)
+        m_core->IncreaseReference(&surface->Data);
+
+    if (m_prev)
+        m_core->DecreaseReference(&m_prev->Data);
+
+    m_prev = surface;
+}
+
+mfxStatus VideoVPP_SW::RunFrameVPP(mfxFrameSurface1* , mfxFrameSurface1* , mfxExtVppAuxData *)
+{
+    return MFX_ERR_NONE;
+}
+
+
 #endif // MFX_ENABLE_VPP
 /* EOF */
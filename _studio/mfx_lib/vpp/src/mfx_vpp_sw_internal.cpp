@@ -384,14 +384,8 @@ mfxStatus ExtendedQuery(VideoCORE * core, mfxU32 filterName, mfxExtBuffer* pHint
     }
     else if( MFX_EXTBUFF_VPP_COMPOSITE == filterName )
     {
-        if ((NULL != core) && (MFX_PLATFORM_SOFTWARE == core->GetPlatformType()))
-        {
-            sts = MFX_ERR_UNSUPPORTED;
-        }
-        else
-        {
-            sts = MFX_ERR_NONE;
-        }
+        // composition is done by CPU when there is no device
+        sts = MFX_ERR_NONE;
     }
     else if( MFX_EXTBUFF_VPP_FIELD_PROCESSING == filterName )
     {
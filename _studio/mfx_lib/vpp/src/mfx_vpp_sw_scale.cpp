@@ -0,0 +1,820 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "mfx_vpp_sw_scale.h"
+
+#define VPP_SW_CPU_DISP_INIT_C(func)           (func ## _C)
+#define VPP_SW_CPU_DISP_INIT_AVX2(func)        (func ## _AVX2)
+#define VPP_SW_CPU_DISP_INIT_AVX2_C(func)      (m_AVX2_available ? VPP_SW_CPU_DISP_INIT_AVX2(func) : VPP_SW_CPU_DISP_INIT_C(func))
+
+namespace MfxSwVideoProcessing
+{
+
+enum
+{
+    COMP_Y = 0,
+    COMP_U = 1,
+    COMP_V = 2,
+
+    COMP_R = 0,
+    COMP_G = 1,
+    COMP_B = 2,
+    COMP_A = 3,
+
+    // output rows of the largest component processed by one call of Run()
+    REGION_HEIGHT = 64
+};
+
+static mfxI32 CpuFeature_AVX2()
+{
+    return((__builtin_cpu_supports("avx2")));
+}
+
+Kernels const & GetKernels()
+{
+    static const int m_AVX2_available = CpuFeature_AVX2();
+
+    static const Kernels kernels =
+    {
+        VPP_SW_CPU_DISP_INIT_AVX2_C(FilterRowH),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(FilterRowV),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(LoadRow8),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(StoreRow8),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(BlendRow),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(InterpolateRowELA),
+        VPP_SW_CPU_DISP_INIT_AVX2_C(InterpolateRowMA)
+    };
+
+    return kernels;
+}
+
+static inline mfxI32 Clip3(mfxI32 min, mfxI32 max, mfxI32 x)
+{
+    return x < min ? min : (x > max ? max : x);
+}
+
+static inline mfxU32 Align(mfxU32 x, mfxU32 align)
+{
+    return (x + align - 1) & ~(align - 1);
+}
+
+/* ******************************************************************** */
+/*                         filter construction                          */
+/* ******************************************************************** */
+
+static double GetSupport(ScaleMethod method)
+{
+    switch (method)
+    {
+    case SCALE_BILINEAR: return 1.0;
+    case SCALE_BICUBIC:  return 2.0;
+    case SCALE_LANCZOS:  return 3.0;
+    default:             return 0.5;
+    }
+}
+
+static double Kernel(ScaleMethod method, double x)
+{
+    const double pi = 3.14159265358979323846;
+
+    x = fabs(x);
+
+    switch (method)
+    {
+    case SCALE_BILINEAR:
+        return x < 1.0 ? 1.0 - x : 0.0;
+
+    case SCALE_BICUBIC:
+        // Catmull-Rom, a = -0.5
+        if (x < 1.0)
+            return (1.5 * x - 2.5) * x * x + 1.0;
+        if (x < 2.0)
+            return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        return 0.0;
+
+    case SCALE_LANCZOS:
+        if (x < 1e-8)
+            return 1.0;
+        if (x < 3.0)
+            return 3.0 * sin(pi * x) * sin(pi * x / 3.0) / (pi * pi * x * x);
+        return 0.0;
+
+    default:
+        return 1.0;
+    }
+}
+
+void BuildFilter(Filter & filter, mfxU32 srcSize, mfxU32 dstSize, ScaleMethod method, bool horizontal)
+{
+    const double scale  = double(srcSize) / dstSize;
+    // kernel is stretched on downscaling to low-pass the source
+    const double stretch = std::max(1.0, scale);
+
+    mfxU32 taps = (SCALE_NEAREST == method) ? 1 : 2 * (mfxU32)ceil(GetSupport(method) * stretch);
+
+    filter.srcSize  = srcSize;
+    filter.dstSize  = dstSize;
+    filter.identity = (srcSize == dstSize);
+    filter.taps     = horizontal ? Align(taps, 4) : taps;
+
+    const mfxU32 numOutputs = horizontal ? Align(dstSize, 8) : dstSize;
+
+    filter.offset.assign(numOutputs, 0);
+    filter.coef.assign(numOutputs * filter.taps, 0);
+
+    std::vector<double> weight(taps);
+    std::vector<double> folded(taps);
+    std::vector<mfxI32> q(taps);
+
+    for (mfxU32 i = 0; i < dstSize; i++)
+    {
+        // sample centers of source and destination are aligned
+        const double center = (i + 0.5) * scale - 0.5;
+        mfxI32 start;
+
+        if (SCALE_NEAREST == method)
+        {
+            start = Clip3(0, srcSize - 1, (mfxI32)floor(center + 0.5));
+            weight[0] = 1.0;
+        }
+        else
+        {
+            start = (mfxI32)floor(center) - (mfxI32)taps / 2 + 1;
+
+            double sum = 0.0;
+            for (mfxU32 k = 0; k < taps; k++)
+            {
+                weight[k] = Kernel(method, (start + (mfxI32)k - center) / stretch);
+                sum += weight[k];
+            }
+            for (mfxU32 k = 0; k < taps; k++)
+                weight[k] /= sum;
+        }
+
+        // taps outside of the source are folded onto the edge samples
+        const mfxI32 first = Clip3(0, std::max<mfxI32>(0, (mfxI32)srcSize - (mfxI32)taps), start);
+
+        std::fill(folded.begin(), folded.end(), 0.0);
+        for (mfxU32 k = 0; k < taps; k++)
+            folded[Clip3(0, srcSize - 1, start + (mfxI32)k) - first] += weight[k];
+
+        // quantization error goes to the largest coefficient to keep the sum exact
+        mfxI32 total = 0;
+        mfxU32 largest = 0;
+        for (mfxU32 k = 0; k < taps; k++)
+        {
+            q[k] = (mfxI32)floor(folded[k] * SCALE_ONE + 0.5);
+            total += q[k];
+            if (folded[k] > folded[largest])
+                largest = k;
+        }
+        q[largest] += SCALE_ONE - total;
+
+        filter.offset[i] = first;
+
+        for (mfxU32 k = 0; k < taps; k++)
+        {
+            if (horizontal)
+                filter.coef[(i >> 3) * 8 * filter.taps + (k >> 2) * 32 + (i & 7) * 4 + (k & 3)] = (mfxI16)q[k];
+            else
+                filter.coef[i * filter.taps + k] = (mfxI16)q[k];
+        }
+    }
+
+    // SIMD tail reads the last source position with zero coefficients
+    for (mfxU32 i = dstSize; i < numOutputs; i++)
+        filter.offset[i] = filter.offset[dstSize - 1];
+}
+
+/* ******************************************************************** */
+/*                              row kernels                             */
+/* ******************************************************************** */
+
+void FilterRowH_C(const mfxI16 * src, mfxI16 * dst, mfxU32 width, const mfxI32 * offset, const mfxI16 * coef, mfxU32 taps)
+{
+    for (mfxU32 x = 0; x < width; x++)
+    {
+        const mfxI16 * s = src + offset[x];
+        const mfxI16 * c = coef + (x >> 3) * 8 * taps + (x & 7) * 4;
+        mfxI32 sum = 0;
+
+        for (mfxU32 k = 0; k < taps; k += 4, c += 32)
+            sum += c[0] * s[k] + c[1] * s[k + 1] + c[2] * s[k + 2] + c[3] * s[k + 3];
+
+        dst[x] = (mfxI16)Clip3(-32768, 32767, (sum + (1 << (SCALE_BITS - 1))) >> SCALE_BITS);
+    }
+}
+
+void FilterRowV_C(const mfxI16 * const * src, mfxI16 * dst, mfxU32 width, const mfxI16 * coef, mfxU32 taps)
+{
+    for (mfxU32 x = 0; x < width; x++)
+    {
+        mfxI32 sum = 0;
+
+        for (mfxU32 k = 0; k < taps; k++)
+            sum += coef[k] * src[k][x];
+
+        dst[x] = (mfxI16)Clip3(0, SCALE_MAX, (sum + (1 << (SCALE_BITS - 1))) >> SCALE_BITS);
+    }
+}
+
+void LoadRow8_C(const mfxU8 * src, mfxI16 * dst, mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+        dst[x] = (mfxI16)(src[x] << (SCALE_BITS - 8));
+}
+
+void StoreRow8_C(const mfxI16 * src, mfxU8 * dst, mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+        dst[x] = (mfxU8)Clip3(0, 255, (src[x] + (1 << (SCALE_BITS - 9))) >> (SCALE_BITS - 8));
+}
+
+void BlendRow_C(const mfxI16 * src, const mfxI16 * alpha, mfxI16 * dst, mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+        dst[x] = (mfxI16)(dst[x] + (((src[x] - dst[x]) * alpha[x] + (1 << (SCALE_BITS - 1))) >> SCALE_BITS));
+}
+
+static inline mfxI32 Avg(mfxI32 a, mfxI32 b)
+{
+    return (a + b + 1) >> 1;
+}
+
+// direction of the smallest difference at a[0], b[0], vertical one wins ties (as DeinterlacingEdgeDetect of UMC)
+static inline mfxI32 InterpolateELA(const mfxI16 * a, const mfxI16 * b)
+{
+    const mfxI32 d1 = abs(a[-1] - b[1]);
+    const mfxI32 d2 = abs(a[1] - b[-1]);
+    const mfxI32 d3 = abs(a[0] - b[0]);
+
+    if (d1 < d2)
+        return d1 < d3 ? Avg(a[-1], b[1]) : Avg(a[0], b[0]);
+    else
+        return d2 < d3 ? Avg(a[1], b[-1]) : Avg(a[0], b[0]);
+}
+
+void InterpolateRowELA_C(const mfxI16 * above, const mfxI16 * below, mfxI16 * dst, mfxU32 width)
+{
+    for (mfxU32 x = 0; x < width; x++)
+        dst[x] = (mfxI16)InterpolateELA(above + x, below + x);
+}
+
+// Temporal prediction is the average of the rows of the other parity before and after the
+// kept field (only the earlier one for the second field). Static areas take it, moving areas
+// take the spatial prediction, the difference of the frames bounds how far the result may go from it.
+void InterpolateRowMA_C(const mfxI16 * above, const mfxI16 * below, const mfxI16 * cur,
+                        const mfxI16 * ref, const mfxI16 * refAbove, const mfxI16 * refBelow,
+                        mfxI16 * dst, mfxU32 width, bool first)
+{
+    for (mfxU32 x = 0; x < width; x++)
+    {
+        const mfxI32 spatial  = InterpolateELA(above + x, below + x);
+        const mfxI32 temporal = first ? Avg(cur[x], ref[x]) : cur[x];
+        const mfxI32 motion   = std::max(abs(cur[x] - ref[x]) >> 1, (abs(above[x] - refAbove[x]) + abs(below[x] - refBelow[x])) >> 1);
+
+        dst[x] = (mfxI16)Clip3(temporal - motion, temporal + motion, spatial);
+    }
+}
+
+/* ******************************************************************** */
+/*                           color conversion                           */
+/* ******************************************************************** */
+
+void GetColorMatrix(ColorMatrix & matrix, bool toYUV, bool bt709, bool fullRange)
+{
+    const double kr = bt709 ? 0.2126 : 0.299;
+    const double kb = bt709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+
+    // luma and chroma excursions relative to full range RGB
+    const double ys = fullRange ? 1.0 : 219.0 / 255.0;
+    const double cs = fullRange ? 1.0 : 224.0 / 255.0;
+
+    double m[3][3];
+
+    if (toYUV)
+    {
+        m[0][0] = ys * kr;                      m[0][1] = ys * kg;                      m[0][2] = ys * kb;
+        m[1][0] = -cs * kr / (2 * (1 - kb));    m[1][1] = -cs * kg / (2 * (1 - kb));    m[1][2] = cs * 0.5;
+        m[2][0] = cs * 0.5;                     m[2][1] = -cs * kg / (2 * (1 - kr));    m[2][2] = -cs * kb / (2 * (1 - kr));
+    }
+    else
+    {
+        m[0][0] = 1 / ys;   m[0][1] = 0.0;                              m[0][2] = 2 * (1 - kr) / cs;
+        m[1][0] = 1 / ys;   m[1][1] = -2 * kb * (1 - kb) / (kg * cs);   m[1][2] = -2 * kr * (1 - kr) / (kg * cs);
+        m[2][0] = 1 / ys;   m[2][1] = 2 * (1 - kb) / cs;                m[2][2] = 0.0;
+    }
+
+    for (mfxU32 i = 0; i < 3; i++)
+        for (mfxU32 j = 0; j < 3; j++)
+            matrix.m[i][j] = (mfxI32)floor(m[i][j] * SCALE_ONE + 0.5);
+
+    // 16 and 128 of 8-bit range
+    matrix.offset[0] = fullRange ? 0 : 16 << (SCALE_BITS - 8);
+    matrix.offset[1] = 128 << (SCALE_BITS - 8);
+    matrix.offset[2] = 128 << (SCALE_BITS - 8);
+}
+
+/* ******************************************************************** */
+/*                             frame layout                             */
+/* ******************************************************************** */
+
+bool FrameScaler::IsFormatSupported(mfxU32 fourcc)
+{
+    switch (fourcc)
+    {
+    case MFX_FOURCC_NV12:
+    case MFX_FOURCC_YV12:
+    case MFX_FOURCC_YUY2:
+    case MFX_FOURCC_P010:
+    case MFX_FOURCC_RGB4:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Is16Bit(mfxU32 fourcc)
+{
+    return MFX_FOURCC_P010 == fourcc;
+}
+
+// Crop rectangle of a component, chroma is rounded outwards
+void GetComponentRect(mfxU32 fourcc, const mfxU16 crop[4], mfxU32 comp, mfxU32 rect[4])
+{
+    mfxU32 sx = 0, sy = 0;
+
+    if (COMP_Y != comp && MFX_FOURCC_RGB4 != fourcc)
+    {
+        sx = 1;
+        sy = (MFX_FOURCC_YUY2 == fourcc) ? 0 : 1;
+    }
+
+    const mfxU32 x0 = crop[0] >> sx;
+    const mfxU32 y0 = crop[1] >> sy;
+    const mfxU32 x1 = (crop[0] + crop[2] + (1 << sx) - 1) >> sx;
+    const mfxU32 y1 = (crop[1] + crop[3] + (1 << sy) - 1) >> sy;
+
+    rect[0] = x0;
+    rect[1] = y0;
+    rect[2] = x1 - x0;
+    rect[3] = y1 - y0;
+}
+
+Plane GetPlane(mfxFrameData const & data, mfxU32 fourcc, const mfxU16 crop[4], mfxU32 comp)
+{
+    Plane plane = {};
+    mfxU8 * base = 0;
+
+    plane.pitch = (mfxI32)(data.PitchLow + ((mfxU32)data.PitchHigh << 16));
+    plane.step  = 1;
+    plane.field = -1;
+
+    switch (fourcc)
+    {
+    case MFX_FOURCC_NV12:
+        base = (COMP_Y == comp) ? data.Y : data.UV + comp - COMP_U;
+        plane.step = (COMP_Y == comp) ? 1 : 2;
+        break;
+
+    case MFX_FOURCC_P010:
+        base = (COMP_Y == comp) ? (mfxU8 *)data.Y16 : (mfxU8 *)(data.U16 + comp - COMP_U);
+        plane.step = (COMP_Y == comp) ? 1 : 2;
+        break;
+
+    case MFX_FOURCC_YV12:
+        // planes are addressed by pointers, so I420 layout works the same way
+        base = (COMP_Y == comp) ? data.Y : (COMP_U == comp ? data.U : data.V);
+        plane.pitch = (COMP_Y == comp) ? plane.pitch : plane.pitch / 2;
+        break;
+
+    case MFX_FOURCC_YUY2:
+        base = data.Y + (COMP_Y == comp ? 0 : (COMP_U == comp ? 1 : 3));
+        plane.step = (COMP_Y == comp) ? 2 : 4;
+        break;
+
+    case MFX_FOURCC_RGB4:
+        base = (COMP_R == comp) ? data.R : (COMP_G == comp ? data.G : (COMP_B == comp ? data.B : data.A));
+        plane.step = 4;
+        break;
+
+    default:
+        break;
+    }
+
+    mfxU32 rect[4];
+    GetComponentRect(fourcc, crop, comp, rect);
+
+    const mfxU32 elemSize = Is16Bit(fourcc) ? 2 : 1;
+
+    plane.ptr    = base ? base + rect[1] * plane.pitch + rect[0] * plane.step * elemSize : 0;
+    plane.width  = rect[2];
+    plane.height = rect[3];
+
+    return plane;
+}
+
+/* ******************************************************************** */
+/*                          row load and store                          */
+/* ******************************************************************** */
+
+// Converts 'width' samples of row of 'comp' (of the previous frame if 'ref') to Q14 samples
+static void LoadSourceRow(Geometry const & geo, Plane const * planes, mfxU32 comp, mfxU32 row, bool ref, mfxI16 * dst)
+{
+    // alpha of RGB input is loaded as is
+    if (geo.rgbIn && COMP_A != comp)
+    {
+        const mfxU32 width = planes[COMP_R].width;
+        const mfxU8 * r = (ref ? planes[COMP_R].ref : planes[COMP_R].ptr) + row * planes[COMP_R].pitch;
+        const mfxU8 * g = (ref ? planes[COMP_G].ref : planes[COMP_G].ptr) + row * planes[COMP_G].pitch;
+        const mfxU8 * b = (ref ? planes[COMP_B].ref : planes[COMP_B].ptr) + row * planes[COMP_B].pitch;
+        const mfxI32 * m = geo.matrix.m[comp];
+        const mfxI32 offset = geo.matrix.offset[comp];
+
+        // Q14 coefficients x 8-bit samples -> Q14 samples
+        for (mfxU32 x = 0; x < width; x++)
+            dst[x] = (mfxI16)Clip3(0, SCALE_MAX, ((m[0] * r[4 * x] + m[1] * g[4 * x] + m[2] * b[4 * x] + 128) >> 8) + offset);
+    }
+    else if (Is16Bit(geo.inFourCC))
+    {
+        Plane const & plane = planes[comp];
+        const mfxU16 * src = (const mfxU16 *)((ref ? plane.ref : plane.ptr) + row * plane.pitch);
+
+        for (mfxU32 x = 0; x < plane.width; x++)
+            dst[x] = (mfxI16)(std::min(src[x * plane.step] >> geo.inShift, 1023) << (SCALE_BITS - 10));
+    }
+    else
+    {
+        Plane const & plane = planes[comp];
+        const mfxU8 * src = (ref ? plane.ref : plane.ptr) + row * plane.pitch;
+
+        if (1 == plane.step)
+        {
+            GetKernels().LoadRow8(src, dst, plane.width);
+        }
+        else
+        {
+            for (mfxU32 x = 0; x < plane.width; x++)
+                dst[x] = (mfxI16)(src[x * plane.step] << (SCALE_BITS - 8));
+        }
+    }
+}
+
+// Interpolates row of the field dropped by deinterlacing, 'plane' keeps the other field
+static void InterpolateRow(Geometry const & geo, Plane const * planes, Plane const & plane, mfxU32 comp, mfxU32 row, RowScratch & scratch, mfxI16 * dst)
+{
+    enum { ABOVE, BELOW, CUR, REF, REF_ABOVE, REF_BELOW, NUM_ROWS };
+
+    const mfxU32 width  = plane.width;
+    const mfxU32 stride = Align(width + 2, 16);
+    const mfxU32 above  = row ? row - 1 : row + 1;
+    const mfxU32 below  = (row + 1 < plane.height) ? row + 1 : row - 1;
+    const bool   motion = DI_ADVANCED == geo.deinterlace && plane.ref;
+
+    scratch.field.resize(stride * NUM_ROWS);
+
+    // rows start at sample 1, edges are replicated for the diagonal directions
+    mfxI16 * rows[NUM_ROWS];
+    const mfxU32 rowIndex[NUM_ROWS] = { above, below, row, row, above, below };
+
+    for (mfxU32 i = 0; i < (motion ? (mfxU32)NUM_ROWS : (mfxU32)CUR); i++)
+    {
+        rows[i] = &scratch.field[i * stride] + 1;
+
+        LoadSourceRow(geo, planes, comp, rowIndex[i], i >= REF, rows[i]);
+        rows[i][-1]    = rows[i][0];
+        rows[i][width] = rows[i][width - 1];
+    }
+
+    if (DI_BOB == geo.deinterlace)
+    {
+        for (mfxU32 x = 0; x < width; x++)
+            dst[x] = (mfxI16)Avg(rows[ABOVE][x], rows[BELOW][x]);
+    }
+    else if (!motion)
+    {
+        GetKernels().InterpolateRowELA(rows[ABOVE], rows[BELOW], dst, width);
+    }
+    else
+    {
+        GetKernels().InterpolateRowMA(rows[ABOVE], rows[BELOW], rows[CUR], rows[REF], rows[REF_ABOVE], rows[REF_BELOW], dst, width, plane.first);
+    }
+}
+
+// Converts row of 'comp' to Q14 samples, 'pad' samples after the end replicate the last one
+static void LoadRow(Geometry const & geo, Plane const * planes, mfxU32 comp, mfxU32 row, mfxU32 pad, RowScratch & scratch, mfxI16 * dst)
+{
+    Plane const & plane = planes[(geo.rgbIn && COMP_A != comp) ? (mfxU32)COMP_R : comp];
+    const mfxU32 width = plane.width;
+
+    if (plane.field >= 0 && (mfxI32)(row & 1) != plane.field && plane.height > 1)
+        InterpolateRow(geo, planes, plane, comp, row, scratch, dst);
+    else
+        LoadSourceRow(geo, planes, comp, row, false, dst);
+
+    std::fill(dst + width, dst + width + pad, dst[width - 1]);
+}
+
+void StoreRow(Geometry const & geo, Plane const & plane, mfxU32 row, const mfxI16 * src)
+{
+    if (Is16Bit(geo.outFourCC))
+    {
+        mfxU16 * dst = (mfxU16 *)(plane.ptr + row * plane.pitch);
+
+        for (mfxU32 x = 0; x < plane.width; x++)
+            dst[x * plane.step] = (mfxU16)(Clip3(0, 1023, (src[x] + (1 << (SCALE_BITS - 11))) >> (SCALE_BITS - 10)) << geo.outShift);
+    }
+    else
+    {
+        mfxU8 * dst = plane.ptr + row * plane.pitch;
+
+        if (1 == plane.step)
+        {
+            GetKernels().StoreRow8(src, dst, plane.width);
+        }
+        else
+        {
+            for (mfxU32 x = 0; x < plane.width; x++)
+                dst[x * plane.step] = (mfxU8)Clip3(0, 255, (src[x] + (1 << (SCALE_BITS - 9))) >> (SCALE_BITS - 8));
+        }
+    }
+}
+
+static void StoreRowRGB(Geometry const & geo, Plane const * planes, mfxU32 row, const mfxI16 * y, const mfxI16 * u, const mfxI16 * v)
+{
+    mfxU8 * r = planes[COMP_R].ptr + row * planes[COMP_R].pitch;
+    mfxU8 * g = planes[COMP_G].ptr + row * planes[COMP_G].pitch;
+    mfxU8 * b = planes[COMP_B].ptr + row * planes[COMP_B].pitch;
+    mfxU8 * a = planes[COMP_A].ptr + row * planes[COMP_A].pitch;
+
+    const mfxI32 (*m)[3] = geo.matrix.m;
+    const mfxI32 * offset = geo.matrix.offset;
+
+    // Q14 coefficients x Q14 samples -> 8-bit samples
+    const mfxI32 shift = 2 * SCALE_BITS - 8;
+    const mfxI32 round = 1 << (shift - 1);
+
+    for (mfxU32 x = 0; x < planes[COMP_R].width; x++)
+    {
+        const mfxI32 Y  = y[x] - offset[0];
+        const mfxI32 Cb = u[x] - offset[1];
+        const mfxI32 Cr = v[x] - offset[2];
+
+        r[4 * x] = (mfxU8)Clip3(0, 255, (m[0][0] * Y + m[0][1] * Cb + m[0][2] * Cr + round) >> shift);
+        g[4 * x] = (mfxU8)Clip3(0, 255, (m[1][0] * Y + m[1][1] * Cb + m[1][2] * Cr + round) >> shift);
+        b[4 * x] = (mfxU8)Clip3(0, 255, (m[2][0] * Y + m[2][1] * Cb + m[2][2] * Cr + round) >> shift);
+        a[4 * x] = 255;
+    }
+}
+
+/* ******************************************************************** */
+/*                            channel scaling                           */
+/* ******************************************************************** */
+
+RowScaler::RowScaler(Geometry const & geo, Geometry::Channel const & channel, Plane const * planes, RowScratch & scratch)
+    : m_geo(geo)
+    , m_channel(channel)
+    , m_planes(planes)
+    , m_kernels(GetKernels())
+    , m_rowSize(Align(std::max(channel.h.dstSize, channel.h.srcSize), 16) + channel.h.taps + 16)
+    , m_scratch(scratch)
+{
+    // capacity is kept, so the buffers are allocated once per scratch
+    m_scratch.load.resize(m_rowSize);
+    m_scratch.ring.resize(m_rowSize * channel.v.taps);
+    m_scratch.ringRow.assign(channel.v.taps, -1);
+    m_scratch.rows.resize(channel.v.taps);
+    m_scratch.out.resize(m_rowSize);
+}
+
+const mfxI16 * RowScaler::GetRow(mfxU32 y)
+{
+    Filter const & v = m_channel.v;
+    mfxI16 * ring = &m_scratch.ring[0];
+
+    if (v.identity)
+    {
+        Fill(y, ring);
+        return ring;
+    }
+
+    for (mfxU32 k = 0; k < v.taps; k++)
+    {
+        const mfxI32 row  = std::min<mfxI32>(v.offset[y] + (mfxI32)k, v.srcSize - 1);
+        const mfxU32 slot = row % v.taps;
+
+        if (m_scratch.ringRow[slot] != row)
+        {
+            Fill(row, ring + slot * m_rowSize);
+            m_scratch.ringRow[slot] = row;
+        }
+
+        m_scratch.rows[k] = ring + slot * m_rowSize;
+    }
+
+    m_kernels.FilterRowV(&m_scratch.rows[0], &m_scratch.out[0], m_channel.h.dstSize, &v.coef[y * v.taps], v.taps);
+
+    return &m_scratch.out[0];
+}
+
+void RowScaler::Fill(mfxU32 row, mfxI16 * dst)
+{
+    Filter const & h = m_channel.h;
+
+    if (h.identity)
+    {
+        LoadRow(m_geo, m_planes, m_channel.src, row, 0, m_scratch, dst);
+    }
+    else
+    {
+        LoadRow(m_geo, m_planes, m_channel.src, row, h.taps, m_scratch, &m_scratch.load[0]);
+        m_kernels.FilterRowH(&m_scratch.load[0], dst, h.dstSize, &h.offset[0], &h.coef[0], h.taps);
+    }
+}
+
+/* ******************************************************************** */
+/*                             FrameScaler                              */
+/* ******************************************************************** */
+
+FrameScaler::FrameScaler()
+    : m_method(SCALE_BICUBIC)
+    , m_bt709(false)
+    , m_fullRange(false)
+    , m_deinterlace(DI_NONE)
+    , m_last()
+{
+}
+
+void FrameScaler::Init(ScaleMethod method, bool bt709, bool fullRange, DeinterlaceMethod deinterlace)
+{
+    m_method      = method;
+    m_bt709       = bt709;
+    m_fullRange   = fullRange;
+    m_deinterlace = deinterlace;
+    m_last.reset();
+}
+
+std::shared_ptr<const Geometry> FrameScaler::GetGeometry(mfxFrameInfo const & in, mfxFrameInfo const & out)
+{
+    const mfxU16 inCrop[4]  = { in.CropX,  in.CropY,  in.CropW,  in.CropH };
+    const mfxU16 outCrop[4] = { out.CropX, out.CropY, out.CropW, out.CropH };
+
+    if (m_last &&
+        m_last->inFourCC  == in.FourCC  && m_last->inShift  == in.Shift &&
+        m_last->outFourCC == out.FourCC && m_last->outShift == out.Shift &&
+        std::equal(inCrop, inCrop + 4, m_last->inCrop) &&
+        std::equal(outCrop, outCrop + 4, m_last->outCrop))
+    {
+        return m_last;
+    }
+
+    std::shared_ptr<Geometry> geo = std::make_shared<Geometry>();
+
+    geo->inFourCC  = in.FourCC;
+    geo->outFourCC = out.FourCC;
+    // P010 with Shift = 1 keeps 10-bit samples in the most significant bits
+    geo->inShift   = (Is16Bit(in.FourCC)  && in.Shift)  ? 6 : 0;
+    geo->outShift  = (Is16Bit(out.FourCC) && out.Shift) ? 6 : 0;
+    std::copy(inCrop, inCrop + 4, geo->inCrop);
+    std::copy(outCrop, outCrop + 4, geo->outCrop);
+
+    const bool inRGB  = MFX_FOURCC_RGB4 == in.FourCC;
+    const bool outRGB = MFX_FOURCC_RGB4 == out.FourCC;
+
+    geo->rgbIn  = inRGB && !outRGB;
+    geo->rgbOut = outRGB && !inRGB;
+
+    if (geo->rgbIn || geo->rgbOut)
+        GetColorMatrix(geo->matrix, geo->rgbIn, m_bt709, m_fullRange);
+    else
+        memset(&geo->matrix, 0, sizeof(geo->matrix));
+
+    geo->deinterlace = m_deinterlace;
+
+    const mfxU32 numChannels = (inRGB && outRGB) ? 4 : 3;
+    geo->channels.resize(numChannels);
+
+    mfxU32 maxHeight = 1;
+
+    for (mfxU32 c = 0; c < numChannels; c++)
+    {
+        Geometry::Channel & channel = geo->channels[c];
+        mfxU32 srcRect[4], dstRect[4];
+
+        GetComponentRect(in.FourCC,  inCrop,  c, srcRect);
+        GetComponentRect(out.FourCC, outCrop, c, dstRect);
+
+        channel.src = c;
+        channel.dst = c;
+
+        BuildFilter(channel.h, srcRect[2], dstRect[2], m_method, true);
+        BuildFilter(channel.v, srcRect[3], dstRect[3], m_method, false);
+
+        maxHeight = std::max(maxHeight, dstRect[3]);
+    }
+
+    geo->numRegions = (maxHeight + REGION_HEIGHT - 1) / REGION_HEIGHT;
+
+    m_last = geo;
+
+    return m_last;
+}
+
+// Parity is of the frame rows, plane rows start at the crop
+static void SetField(Geometry const & geo, Field const & field, mfxU32 comp, Plane & plane)
+{
+    mfxU32 rect[4];
+    GetComponentRect(geo.inFourCC, geo.inCrop, comp, rect);
+
+    plane.field = (mfxI32)((field.parity ^ rect[1]) & 1);
+    plane.first = field.first;
+    plane.ref   = field.ref ? GetPlane(*field.ref, geo.inFourCC, geo.inCrop, comp).ptr : 0;
+}
+
+void FrameScaler::Run(Geometry const & geo, mfxFrameData const & in, mfxFrameData & out, mfxU32 region, Field const * field)
+{
+    const mfxU32 numComps = (MFX_FOURCC_RGB4 == geo.inFourCC || MFX_FOURCC_RGB4 == geo.outFourCC) ? 4 : 3;
+
+    Plane src[4], dst[4];
+
+    for (mfxU32 c = 0; c < 4; c++)
+    {
+        src[c] = (c < numComps && (c < 3 || MFX_FOURCC_RGB4 == geo.inFourCC))  ? GetPlane(in,  geo.inFourCC,  geo.inCrop,  c) : Plane();
+        dst[c] = (c < numComps && (c < 3 || MFX_FOURCC_RGB4 == geo.outFourCC)) ? GetPlane(out, geo.outFourCC, geo.outCrop, c) : Plane();
+
+        if (field && DI_NONE != geo.deinterlace && src[c].ptr)
+            SetField(geo, *field, c, src[c]);
+    }
+
+    if (geo.rgbOut)
+    {
+        const mfxU32 height = geo.channels[COMP_Y].v.dstSize;
+        const mfxU32 y0 = height * region / geo.numRegions;
+        const mfxU32 y1 = height * (region + 1) / geo.numRegions;
+
+        RowScratch scratch[3];
+        RowScaler y(geo, geo.channels[COMP_Y], src, scratch[0]);
+        RowScaler u(geo, geo.channels[COMP_U], src, scratch[1]);
+        RowScaler v(geo, geo.channels[COMP_V], src, scratch[2]);
+
+        for (mfxU32 row = y0; row < y1; row++)
+        {
+            const mfxI16 * rowY = y.GetRow(row);
+            const mfxI16 * rowU = u.GetRow(row);
+            const mfxI16 * rowV = v.GetRow(row);
+
+            StoreRowRGB(geo, dst, row, rowY, rowU, rowV);
+        }
+
+        return;
+    }
+
+    RowScratch scratch;
+
+    for (mfxU32 c = 0; c < geo.channels.size(); c++)
+    {
+        Geometry::Channel const & channel = geo.channels[c];
+
+        const mfxU32 height = channel.v.dstSize;
+        const mfxU32 y0 = height * region / geo.numRegions;
+        const mfxU32 y1 = height * (region + 1) / geo.numRegions;
+
+        if (y0 == y1)
+            continue;
+
+        RowScaler scaler(geo, channel, src, scratch);
+
+        for (mfxU32 row = y0; row < y1; row++)
+            StoreRow(geo, dst[channel.dst], row, scaler.GetRow(row));
+    }
+}
+
+} // namespace MfxSwVideoProcessing
+
+#endif // MFX_ENABLE_VPP
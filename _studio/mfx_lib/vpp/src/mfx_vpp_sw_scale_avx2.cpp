@@ -0,0 +1,267 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This file is compiled with -mavx2, functions are selected at run time by mfx_vpp_sw_scale.cpp
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+
+#include <string.h>
+#include <immintrin.h>
+
+#include "mfx_vpp_sw_scale.h"
+
+namespace MfxSwVideoProcessing
+{
+
+static inline long long Load4(const mfxI16 * p)
+{
+    long long v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 8 outputs per iteration: 4 taps of 4 outputs are multiplied by one madd,
+// the pairs of partial sums are added by hadd and reordered by permute
+void FilterRowH_AVX2(const mfxI16 * src, mfxI16 * dst, mfxU32 width, const mfxI32 * offset, const mfxI16 * coef, mfxU32 taps)
+{
+    const __m256i rnd  = _mm256_set1_epi32(1 << (SCALE_BITS - 1));
+    const __m256i perm = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+
+    for (mfxU32 x = 0; x < width; x += 8, offset += 8, coef += 8 * taps)
+    {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+
+        for (mfxU32 k = 0; k < taps; k += 4)
+        {
+            const mfxI16 * s = src + k;
+
+            __m256i s0 = _mm256_set_epi64x(Load4(s + offset[3]), Load4(s + offset[2]), Load4(s + offset[1]), Load4(s + offset[0]));
+            __m256i s1 = _mm256_set_epi64x(Load4(s + offset[7]), Load4(s + offset[6]), Load4(s + offset[5]), Load4(s + offset[4]));
+
+            const __m256i * c = (const __m256i *)(coef + 8 * k);
+
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(s0, _mm256_loadu_si256(c)));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(s1, _mm256_loadu_si256(c + 1)));
+        }
+
+        // lanes are [0 1 4 5] [2 3 6 7]
+        __m256i sum = _mm256_hadd_epi32(acc0, acc1);
+        sum = _mm256_srai_epi32(_mm256_add_epi32(sum, rnd), SCALE_BITS);
+        sum = _mm256_permutevar8x32_epi32(sum, perm);
+
+        __m128i res = _mm_packs_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        _mm_storeu_si128((__m128i *)(dst + x), res);
+    }
+
+    _mm256_zeroupper();
+}
+
+// 16 outputs per iteration, rows are interleaved by pairs to use madd
+void FilterRowV_AVX2(const mfxI16 * const * src, mfxI16 * dst, mfxU32 width, const mfxI16 * coef, mfxU32 taps)
+{
+    const __m256i rnd  = _mm256_set1_epi32(1 << (SCALE_BITS - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max  = _mm256_set1_epi16(SCALE_MAX);
+
+    for (mfxU32 x = 0; x < width; x += 16)
+    {
+        __m256i lo = _mm256_setzero_si256();
+        __m256i hi = _mm256_setzero_si256();
+        mfxU32 k = 0;
+
+        for (; k + 1 < taps; k += 2)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(src[k] + x));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(src[k + 1] + x));
+            __m256i c = _mm256_set1_epi32((mfxI32)((mfxU32)(mfxU16)coef[k] | ((mfxU32)(mfxU16)coef[k + 1] << 16)));
+
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), c));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), c));
+        }
+
+        if (k < taps)
+        {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(src[k] + x));
+            __m256i c = _mm256_set1_epi32((mfxI32)(mfxU32)(mfxU16)coef[k]);
+
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, zero), c));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, zero), c));
+        }
+
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, rnd), SCALE_BITS);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, rnd), SCALE_BITS);
+
+        __m256i res = _mm256_packs_epi32(lo, hi);
+        res = _mm256_min_epi16(_mm256_max_epi16(res, zero), max);
+
+        _mm256_storeu_si256((__m256i *)(dst + x), res);
+    }
+
+    _mm256_zeroupper();
+}
+
+void LoadRow8_AVX2(const mfxU8 * src, mfxI16 * dst, mfxU32 width)
+{
+    mfxU32 x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + x)));
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_slli_epi16(v, SCALE_BITS - 8));
+    }
+
+    _mm256_zeroupper();
+
+    for (; x < width; x++)
+        dst[x] = (mfxI16)(src[x] << (SCALE_BITS - 8));
+}
+
+void StoreRow8_AVX2(const mfxI16 * src, mfxU8 * dst, mfxU32 width)
+{
+    const __m256i rnd = _mm256_set1_epi16(1 << (SCALE_BITS - 9));
+    mfxU32 x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + x));
+        v = _mm256_srai_epi16(_mm256_adds_epi16(v, rnd), SCALE_BITS - 8);
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm256_castsi256_si128(v));
+    }
+
+    _mm256_zeroupper();
+
+    for (; x < width; x++)
+    {
+        mfxI32 v = (src[x] + (1 << (SCALE_BITS - 9))) >> (SCALE_BITS - 8);
+        dst[x] = (mfxU8)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+}
+
+// dst * (SCALE_ONE - alpha) + src * alpha by one madd of (dst, src) pairs, equal to the C version
+// for any 16-bit samples: rows scaled only horizontally overshoot [0, SCALE_MAX], so src - dst may not fit
+void BlendRow_AVX2(const mfxI16 * src, const mfxI16 * alpha, mfxI16 * dst, mfxU32 width)
+{
+    const __m256i rnd = _mm256_set1_epi32(1 << (SCALE_BITS - 1));
+    const __m256i one = _mm256_set1_epi16(SCALE_ONE);
+    mfxU32 x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + x));
+        __m256i a = _mm256_loadu_si256((const __m256i *)(alpha + x));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + x));
+        __m256i b = _mm256_sub_epi16(one, a);
+
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(d, s), _mm256_unpacklo_epi16(b, a));
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(d, s), _mm256_unpackhi_epi16(b, a));
+
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, rnd), SCALE_BITS);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, rnd), SCALE_BITS);
+
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_packs_epi32(lo, hi));
+    }
+
+    _mm256_zeroupper();
+
+    for (; x < width; x++)
+        dst[x] = (mfxI16)(dst[x] + (((src[x] - dst[x]) * alpha[x] + (1 << (SCALE_BITS - 1))) >> SCALE_BITS));
+}
+
+// Q14 samples are non-negative, so avg_epu16 gives the rounded average
+static inline __m256i InterpolateELA(const mfxI16 * a, const mfxI16 * b)
+{
+    __m256i al = _mm256_loadu_si256((const __m256i *)(a - 1));
+    __m256i ac = _mm256_loadu_si256((const __m256i *)(a));
+    __m256i ar = _mm256_loadu_si256((const __m256i *)(a + 1));
+    __m256i bl = _mm256_loadu_si256((const __m256i *)(b - 1));
+    __m256i bc = _mm256_loadu_si256((const __m256i *)(b));
+    __m256i br = _mm256_loadu_si256((const __m256i *)(b + 1));
+
+    __m256i d1 = _mm256_abs_epi16(_mm256_sub_epi16(al, br));
+    __m256i d2 = _mm256_abs_epi16(_mm256_sub_epi16(ar, bl));
+    __m256i d3 = _mm256_abs_epi16(_mm256_sub_epi16(ac, bc));
+
+    // d1 < d2 && d1 < d3 -> direction 1, d1 >= d2 && d2 < d3 -> direction 2, vertical otherwise
+    __m256i lt12 = _mm256_cmpgt_epi16(d2, d1);
+    __m256i use1 = _mm256_and_si256(lt12, _mm256_cmpgt_epi16(d3, d1));
+    __m256i use2 = _mm256_andnot_si256(lt12, _mm256_cmpgt_epi16(d3, d2));
+
+    __m256i res = _mm256_avg_epu16(ac, bc);
+    res = _mm256_blendv_epi8(res, _mm256_avg_epu16(al, br), use1);
+    res = _mm256_blendv_epi8(res, _mm256_avg_epu16(ar, bl), use2);
+
+    return res;
+}
+
+void InterpolateRowELA_AVX2(const mfxI16 * above, const mfxI16 * below, mfxI16 * dst, mfxU32 width)
+{
+    mfxU32 x = 0;
+
+    for (; x + 16 <= width; x += 16)
+        _mm256_storeu_si256((__m256i *)(dst + x), InterpolateELA(above + x, below + x));
+
+    _mm256_zeroupper();
+
+    if (x < width)
+        InterpolateRowELA_C(above + x, below + x, dst + x, width - x);
+}
+
+void InterpolateRowMA_AVX2(const mfxI16 * above, const mfxI16 * below, const mfxI16 * cur,
+                           const mfxI16 * ref, const mfxI16 * refAbove, const mfxI16 * refBelow,
+                           mfxI16 * dst, mfxU32 width, bool first)
+{
+    mfxU32 x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i spatial = InterpolateELA(above + x, below + x);
+
+        __m256i c  = _mm256_loadu_si256((const __m256i *)(cur + x));
+        __m256i r  = _mm256_loadu_si256((const __m256i *)(ref + x));
+        __m256i a  = _mm256_loadu_si256((const __m256i *)(above + x));
+        __m256i b  = _mm256_loadu_si256((const __m256i *)(below + x));
+        __m256i ra = _mm256_loadu_si256((const __m256i *)(refAbove + x));
+        __m256i rb = _mm256_loadu_si256((const __m256i *)(refBelow + x));
+
+        __m256i temporal = first ? _mm256_avg_epu16(c, r) : c;
+
+        __m256i m0 = _mm256_srli_epi16(_mm256_abs_epi16(_mm256_sub_epi16(c, r)), 1);
+        __m256i m1 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_abs_epi16(_mm256_sub_epi16(a, ra)), _mm256_abs_epi16(_mm256_sub_epi16(b, rb))), 1);
+        __m256i motion = _mm256_max_epi16(m0, m1);
+
+        __m256i res = _mm256_max_epi16(spatial, _mm256_sub_epi16(temporal, motion));
+        res = _mm256_min_epi16(res, _mm256_add_epi16(temporal, motion));
+
+        _mm256_storeu_si256((__m256i *)(dst + x), res);
+    }
+
+    _mm256_zeroupper();
+
+    if (x < width)
+        InterpolateRowMA_C(above + x, below + x, cur + x, ref + x, refAbove + x, refBelow + x, dst + x, width - x, first);
+}
+
+} // namespace MfxSwVideoProcessing
+
+#endif // MFX_ENABLE_VPP
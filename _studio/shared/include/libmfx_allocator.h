@@ -60,6 +60,8 @@ public:
     mfxWideBufferAllocator(void);
     ~mfxWideBufferAllocator(void);
     mfxBufferAllocator bufferAllocator;
+    // NUMA node to allocate buffers on, -1 for any
+    mfxI32 numaNode;
 };
 
 class mfxBaseWideFrameAllocator
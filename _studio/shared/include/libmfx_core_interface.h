@@ -111,6 +111,29 @@ static const MFX_GUID MFXICORE_GT_CONFIG_GUID =
 static const MFX_GUID MFXIFEIEnabled_GUID =
 { 0x7df28d19, 0x889a, 0x45c1,{ 0xaa, 0x5, 0xa4, 0xf7, 0xef, 0xae, 0x95, 0x28 } };
 
+// NUMA node of system memory allocated by the default allocator (mfxI32, -1 for any)
+// {3C5B2C51-6E0B-4F4B-9F25-8A7C1B1E2D47}
+static const MFX_GUID MFXICORE_NUMA_NODE_GUID =
+{ 0x3c5b2c51, 0x6e0b, 0x4f4b,{ 0x9f, 0x25, 0x8a, 0x7c, 0x1b, 0x1e, 0x2d, 0x47 } };
+
+// Scheduler of the session (MFXIScheduler), task routines register
+// completion handles of the device with its MFXIScheduler3 interface
+// {8E1A5F27-0B3D-4C59-A6E2-51D7C4B9F0A3}
+static const MFX_GUID MFXICORE_SCHEDULER_GUID =
+{ 0x8e1a5f27, 0x0b3d, 0x4c59,{ 0xa6, 0xe2, 0x51, 0xd7, 0xc4, 0xb9, 0xf0, 0xa3 } };
+
+// Null device (NullDeviceParam), answered only by the core working without a driver,
+// components create stub DDI instead of the VA-API ones
+// {5D2B7E90-3C41-4A8F-8E6B-0F9A2C7D4B15}
+static const MFX_GUID MFXINULLDEVICE_GUID =
+{ 0x5d2b7e90, 0x3c41, 0x4a8f,{ 0x8e, 0x6b, 0x0f, 0x9a, 0x2c, 0x7d, 0x4b, 0x15 } };
+
+struct NullDeviceParam
+{
+    // microseconds from the submission of a task to its completion
+    mfxU32 latency;
+};
+
 // Try to obtain required interface
 // Declare a template to query an interface
 template <class T> inline
@@ -132,6 +155,14 @@ T *QueryCoreInterface(VideoCORE* pUnk, const MFX_GUID &guid = T::getGuid())
 
 } // T *QueryCoreInterface(MFXIUnknown *pUnk, const MFX_GUID &guid)
 
+// The core is the null device. It has the stub DDI of the AVC encoder, the null
+// accelerator for the AVC decoder and the stub of VPP, the session rejects
+// other components with MFX_ERR_UNSUPPORTED.
+inline bool IsNullDevice(VideoCORE* pCore)
+{
+    return NULL != QueryCoreInterface<NullDeviceParam>(pCore, MFXINULLDEVICE_GUID);
+}
+
 class EncodeHWCaps
 {
 public:
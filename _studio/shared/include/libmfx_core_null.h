@@ -0,0 +1,91 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_VA_LINUX)
+
+#ifndef __LIBMFX_CORE_NULL_H__
+#define __LIBMFX_CORE_NULL_H__
+
+#include <memory>
+#include "libmfx_core.h"
+#include "libmfx_core_interface.h"
+
+#if defined (MFX_ENABLE_VPP)
+#include "mfx_vpp_interface.h"
+#endif
+
+namespace UMC
+{
+    class NullVideoAccelerator;
+};
+
+// Hardware core working without a driver, it is used for all sessions of
+// the process when the environment variable MFX_NULL_DEVICE=1 is set.
+// Video memory is taken from the system memory, components answered by
+// MFXINULLDEVICE_GUID create stub DDI which complete every submission
+// MFX_NULL_DEVICE_LATENCY microseconds later (0 by default). So the CPU
+// overhead of the library can be measured on machines without GPU.
+// Only the AVC encoder, the AVC decoder and VPP are covered, the session
+// rejects other components with MFX_ERR_UNSUPPORTED (see IsNullDevice).
+class NullVideoCORE : public CommonCORE
+{
+public:
+    friend class FactoryCORE;
+
+    // The null device is requested by the environment
+    static bool IsRequested(void);
+
+    virtual ~NullVideoCORE();
+
+    virtual void          GetVA(mfxHDL* phdl, mfxU16 type);
+    virtual mfxStatus     CreateVA(mfxVideoParam * param, mfxFrameAllocRequest *request, mfxFrameAllocResponse *response, UMC::FrameAllocator *allocator);
+
+    virtual eMFXPlatform  GetPlatformType() {return  MFX_PLATFORM_HARDWARE;}
+    virtual eMFXHWType    GetHWType() { return m_HWType; }
+    virtual eMFXVAType    GetVAType() const {return MFX_HW_VAAPI; };
+    virtual void*         QueryCoreInterface(const MFX_GUID &guid);
+
+#if defined (MFX_ENABLE_VPP)
+    virtual void  GetVideoProcessing(mfxHDL* phdl)
+    {
+        *phdl = &m_vpp_hw_resmng;
+    };
+#endif
+    virtual mfxStatus CreateVideoProcessing(mfxVideoParam * param);
+
+protected:
+    NullVideoCORE(const mfxU32 numThreadsAvailable, const mfxSession session = NULL);
+    virtual void           Close();
+    virtual mfxStatus      DefaultAllocFrames(mfxFrameAllocRequest *request, mfxFrameAllocResponse *response);
+
+    NullDeviceParam                             m_nullDevice;
+    eMFXHWType                                  m_HWType;
+    eMFXGTConfig                                m_GTConfig;
+    std::unique_ptr<UMC::NullVideoAccelerator>  m_pVA;
+#if defined (MFX_ENABLE_VPP)
+    VPPHWResMng                                 m_vpp_hw_resmng;
+#endif
+};
+
+#endif // __LIBMFX_CORE_NULL_H__
+#endif // MFX_VA_LINUX
+/* EOF */
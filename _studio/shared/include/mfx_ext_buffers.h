@@ -69,7 +69,7 @@ typedef struct {
 
     mfxU16 EarlySkip;       // 0=default (let driver choose), 1=enabled, 2=disabled
     mfxU16 LaScaleFactor;   // 0=default (let msdk choose), 1=1x, 2=2x, 4=4x; Deprecated for legacy H264 encoder, for legacy use mfxExtCodingOption2::LookAheadDS instead
-    mfxU16 reserved1;       //
+    mfxU16 SwFrameAnalysis; // tri-state, on - CPU histograms for FadeDetection, unknown - CPU histograms if CM is unavailable
     mfxU16 reserved2;       //
     mfxU16 StrengthN;       // strength=StrengthN/100.0
     mfxU16 FractionalQP;    // 0=disabled (default), 1=enabled
@@ -90,7 +90,7 @@ typedef struct {
     mfxU16 RegressionWindow;        //
     mfxU16 LookAheadDependency;     // LookAheadDependency < LookAhead
     mfxU16 Hme;                     // tri-state
-    mfxU16 reserved4;               //
+    mfxU16 SwLookahead;             // tri-state, on - CPU lookahead for LA BRC, unknown - CPU lookahead if CM is unavailable
     mfxU16 WriteIVFHeaders;         // tri-state
     mfxU16 RefreshFrameContext;
     mfxU16 ChangeFrameContextIdxForTS;
@@ -0,0 +1,89 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+#if defined (MFX_VA_LINUX)
+
+#ifndef __MFX_VPP_NULL
+#define __MFX_VPP_NULL
+
+#include "umc_mutex.h"
+#include "mfx_vpp_interface.h"
+
+#include <chrono>
+#include <vector>
+
+namespace MfxHwVideoProcessing
+{
+    // Video processing of the null device (see libmfx_core_null.h).
+    // Surfaces are not touched, a task is reported completed
+    // the device latency after its submission.
+    class NullVideoProcessing : public DriverVideoProcessing
+    {
+    public:
+
+        NullVideoProcessing();
+
+        virtual ~NullVideoProcessing();
+
+        virtual mfxStatus CreateDevice(VideoCORE * core, mfxVideoParam *pParams, bool isTemporal = false);
+
+        virtual mfxStatus ReconfigDevice(mfxU32 /*indx*/) { return MFX_ERR_NONE; }
+
+        virtual mfxStatus DestroyDevice( void );
+
+        virtual mfxStatus Register(mfxHDLPair* /*pSurfaces*/,
+                                   mfxU32 /*num*/,
+                                   BOOL /*bRegister*/) { return MFX_ERR_NONE; }
+
+        virtual mfxStatus QueryTaskStatus(mfxU32 taskIndex);
+
+        virtual mfxStatus QueryCapabilities( mfxVppCaps& caps );
+
+        virtual mfxStatus QueryVariance(
+            mfxU32 /* frameIndex */,
+            std::vector<mfxU32> & /*variance*/) { return MFX_ERR_UNSUPPORTED; }
+
+        virtual mfxStatus Execute(mfxExecuteParams *pParams);
+
+    private:
+
+        struct Feedback
+        {
+            mfxU32 number;
+            std::chrono::steady_clock::time_point due;
+        };
+
+        VideoCORE*                m_core;
+        std::chrono::microseconds m_latency;
+
+        std::vector<Feedback>     m_feedbackCache;
+        UMC::Mutex                m_guard;
+    };
+
+}; // namespace
+
+#endif //__MFX_VPP_NULL
+#endif // MFX_VA_LINUX
+#endif // MFX_ENABLE_VPP
+/* EOF */
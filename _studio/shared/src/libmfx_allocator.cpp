@@ -33,6 +33,35 @@
 
 #define DEFAULT_ALIGNMENT_SIZE 64
 
+#if defined(LINUX32)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+// Allocate the buffer with preferred placement on the NUMA node.
+// The policy is set before the pages are touched, so they are taken from the node,
+// the buffer is released by free() as a regular one.
+static mfxU8 *AllocOnNode(size_t size, mfxI32 node)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    unsigned long nodeMask[4] = {};
+    void *ptr = NULL;
+
+    if ((node < 0) || ((size_t)node >= sizeof(nodeMask) * 8))
+        return NULL;
+
+    if (posix_memalign(&ptr, page, size))
+        return NULL;
+
+    nodeMask[node / (sizeof(nodeMask[0]) * 8)] |= 1ul << (node % (sizeof(nodeMask[0]) * 8));
+
+    // the node is a preference, it is not an error if the kernel doesn't support it
+    syscall(SYS_mbind, ptr, (size + page - 1) & ~(page - 1), MPOL_PREFERRED, nodeMask, sizeof(nodeMask) * 8, 0);
+
+    return (mfxU8 *)ptr;
+}
+#endif // defined(LINUX32)
+
 // Implementation of Internal allocators
 mfxStatus mfxDefaultAllocator::AllocBuffer(mfxHDL pthis, mfxU32 nbytes, mfxU16 type, mfxHDL *mid)
 {
@@ -41,7 +70,14 @@ mfxStatus mfxDefaultAllocator::AllocBuffer(mfxHDL pthis, mfxU32 nbytes, mfxU16 t
     if(!mid)
         return MFX_ERR_NULL_PTR;
     mfxU32 header_size = ALIGN32(sizeof(BufferStruct));
-    mfxU8 *buffer_ptr=(mfxU8 *)malloc(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE);
+    mfxU8 *buffer_ptr = NULL;
+
+#if defined(LINUX32)
+    if (((mfxWideBufferAllocator*)pthis)->numaNode >= 0)
+        buffer_ptr = AllocOnNode(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE, ((mfxWideBufferAllocator*)pthis)->numaNode);
+#endif
+    if (!buffer_ptr)
+        buffer_ptr = (mfxU8 *)malloc(header_size + nbytes + DEFAULT_ALIGNMENT_SIZE);
 
     if (!buffer_ptr)
         return MFX_ERR_MEMORY_ALLOC;
@@ -512,6 +548,8 @@ mfxWideBufferAllocator::mfxWideBufferAllocator()
     bufferAllocator.Free = &mfxDefaultAllocator::FreeBuffer;
 
     bufferAllocator.pthis = 0;
+
+    numaNode = -1;
 }
 
 mfxWideBufferAllocator::~mfxWideBufferAllocator()
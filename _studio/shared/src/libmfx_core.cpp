@@ -1831,6 +1831,16 @@ void* CommonCORE::QueryCoreInterface(const MFX_GUID &guid)
         return &m_API_1_19;
     }
 
+    if (MFXICORE_NUMA_NODE_GUID == guid)
+    {
+        return &m_bufferAllocator.numaNode;
+    }
+
+    if (MFXICORE_SCHEDULER_GUID == guid)
+    {
+        return (m_session) ? m_session->m_pScheduler : NULL;
+    }
+
     return NULL;
 }
 
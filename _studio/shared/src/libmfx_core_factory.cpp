@@ -24,6 +24,7 @@
 
 #if defined(MFX_VA_LINUX)
 #include <libmfx_core_vaapi.h>
+#include <libmfx_core_null.h>
 #endif
 
 
@@ -39,6 +40,8 @@ VideoCORE* FactoryCORE::CreateCORE(eMFXVAType va_type,
         return new CommonCORE(numThreadsAvailable, session);
 #if defined(MFX_VA_LINUX)
     case MFX_HW_VAAPI:
+        if (NullVideoCORE::IsRequested())
+            return new NullVideoCORE(numThreadsAvailable, session);
         return new VAAPIVideoCORE(adapterNum, numThreadsAvailable, session);
 #endif
     default:
@@ -0,0 +1,178 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "mfx_common.h"
+
+#if defined (MFX_VA_LINUX)
+
+#include "umc_va_null.h"
+
+#include "libmfx_core_null.h"
+#include "libmfx_core_hw.h"
+#include "mfx_session.h"
+
+#include <stdlib.h>
+
+using namespace UMC;
+
+bool NullVideoCORE::IsRequested(void)
+{
+    const char *pValue = getenv("MFX_NULL_DEVICE");
+
+    return (pValue) && (0 != atoi(pValue));
+
+} // bool NullVideoCORE::IsRequested(void)
+
+NullVideoCORE::NullVideoCORE(
+    const mfxU32 numThreadsAvailable,
+    const mfxSession session)
+    : CommonCORE(numThreadsAvailable, session)
+    , m_HWType(MFX_HW_TGL_LP)
+    , m_GTConfig(MFX_GT_UNKNOWN)
+{
+    const char *pValue = getenv("MFX_NULL_DEVICE_LATENCY");
+
+    m_nullDevice.latency = (pValue) ? (mfxU32) atoi(pValue) : 0;
+
+} // NullVideoCORE::NullVideoCORE(...)
+
+NullVideoCORE::~NullVideoCORE()
+{
+    Close();
+
+} // NullVideoCORE::~NullVideoCORE()
+
+void NullVideoCORE::Close()
+{
+    m_pVA.reset();
+} // void NullVideoCORE::Close()
+
+void NullVideoCORE::GetVA(mfxHDL* phdl, mfxU16 type)
+{
+    (type & MFX_MEMTYPE_FROM_DECODE)?(*phdl = m_pVA.get()):(*phdl = 0);
+} // void NullVideoCORE::GetVA(mfxHDL* phdl, mfxU16 type)
+
+mfxStatus
+NullVideoCORE::DefaultAllocFrames(
+    mfxFrameAllocRequest* request,
+    mfxFrameAllocResponse* response)
+{
+    mfxStatus sts = MFX_ERR_NONE;
+
+    if (!(request->Type & MFX_MEMTYPE_DXVA2_DECODER_TARGET) &&
+        !(request->Type & MFX_MEMTYPE_DXVA2_PROCESSOR_TARGET))
+    {
+        return CommonCORE::DefaultAllocFrames(request, response);
+    }
+
+    // video memory of the null device is the system memory.
+    // as for the real device, decoder frames are allocated at once
+    // and VPP, ENC, PAK can request frames for several times.
+    mfxBaseWideFrameAllocator* pAlloc = GetAllocatorByReq(request->Type);
+    if (pAlloc && (request->Type & MFX_MEMTYPE_FROM_DECODE))
+        return MFX_ERR_MEMORY_ALLOC;
+
+    m_pcAlloc.reset(new mfxWideSWFrameAllocator(request->Type));
+    pAlloc = m_pcAlloc.get();
+
+    pAlloc->frameAllocator.pthis = pAlloc;
+    pAlloc->wbufferAllocator.bufferAllocator = m_bufferAllocator.bufferAllocator;
+    sts = (*pAlloc->frameAllocator.Alloc)(pAlloc->frameAllocator.pthis, request, response);
+    MFX_CHECK_STS(sts);
+    sts = RegisterMids(response, request->Type, true, pAlloc);
+    MFX_CHECK_STS(sts);
+
+    ++m_NumAllocators;
+    m_pcAlloc.release();
+
+    return sts;
+
+} // mfxStatus NullVideoCORE::DefaultAllocFrames(...)
+
+mfxStatus
+NullVideoCORE::CreateVA(
+    mfxVideoParam* param,
+    mfxFrameAllocRequest* request,
+    mfxFrameAllocResponse* response,
+    UMC::FrameAllocator *allocator)
+{
+    if (!(request->Type & MFX_MEMTYPE_FROM_DECODE) ||
+        !(request->Type & MFX_MEMTYPE_DXVA2_DECODER_TARGET))
+        return MFX_ERR_NONE;
+
+    auto const profile = ChooseProfile(param, GetHWType());
+    MFX_CHECK(profile != UMC::UNKNOWN, MFX_ERR_UNSUPPORTED);
+
+    VideoAcceleratorParams params;
+    params.m_iNumberSurfaces = response->NumFrameActual;
+    params.m_allocator = allocator;
+
+    m_pVA.reset(new NullVideoAccelerator(std::chrono::microseconds(m_nullDevice.latency)));
+    m_pVA->m_Platform = UMC::VA_LINUX;
+    m_pVA->m_Profile = (VideoAccelerationProfile)profile;
+    m_pVA->m_HWPlatform = m_HWType;
+
+    Status st = m_pVA->Init(&params);
+    MFX_CHECK(UMC_OK == st, MFX_ERR_UNSUPPORTED);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullVideoCORE::CreateVA(...)
+
+mfxStatus NullVideoCORE::CreateVideoProcessing(mfxVideoParam * param)
+{
+    (void)param;
+
+    mfxStatus sts = MFX_ERR_NONE;
+#if defined (MFX_ENABLE_VPP)
+    if (!m_vpp_hw_resmng.GetDevice()){
+        sts = m_vpp_hw_resmng.CreateDevice(this);
+    }
+#else
+    sts = MFX_ERR_UNSUPPORTED;
+#endif
+    return sts;
+} // mfxStatus NullVideoCORE::CreateVideoProcessing(mfxVideoParam * param)
+
+void* NullVideoCORE::QueryCoreInterface(const MFX_GUID &guid)
+{
+    if (MFXINULLDEVICE_GUID == guid)
+    {
+        return &m_nullDevice;
+    }
+    else if (MFXICORE_GT_CONFIG_GUID == guid)
+    {
+        return &m_GTConfig;
+    }
+    else if (MFXIHWCAPS_GUID == guid)
+    {
+        return &m_encode_caps;
+    }
+    else if (MFXIHWMBPROCRATE_GUID == guid)
+    {
+        return &m_encode_mbprocrate;
+    }
+
+    return CommonCORE::QueryCoreInterface(guid);
+
+} // void* NullVideoCORE::QueryCoreInterface(const MFX_GUID &guid)
+
+#endif // MFX_VA_LINUX
+/* EOF */
@@ -1505,6 +1505,14 @@ void* VAAPIVideoCORE::QueryCoreInterface(const MFX_GUID &guid)
     {
         return &m_bHEVCFEIEnabled;
     }
+    else if (MFXICORE_NUMA_NODE_GUID == guid)
+    {
+        return &m_bufferAllocator.numaNode;
+    }
+    else if (MFXICORE_SCHEDULER_GUID == guid)
+    {
+        return (m_session) ? m_session->m_pScheduler : NULL;
+    }
     else
     {
         return NULL;
@@ -73,6 +73,10 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxInitParam              ,80   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtThreadsParam        ,132  )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxPlatform               ,32   )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxSchedulerTaskStat      ,64   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxSchedulerStat          ,332  )
+#endif
     #elif defined(LINUX32)
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtBuffer              ,8    )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxVersion                ,4    )
@@ -80,6 +84,10 @@
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxInitParam              ,68   )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxExtThreadsParam        ,132  )
         MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxPlatform               ,32   )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxSchedulerTaskStat      ,64   )
+        MSDK_STATIC_ASSERT_STRUCT_SIZE(mfxSchedulerStat          ,332  )
+#endif
     #endif
 #endif //defined (__MFXCOMMON_H__)
 
@@ -771,6 +779,10 @@
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,NumThread                     ,8    )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,SchedulingType                ,12   )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,Priority                      ,16   )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,LatencyBudget                 ,20   )
+        MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,SharedPool                    ,24   )
+#endif
 
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxPlatform                        ,CodeName                      ,0    )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxPlatform                        ,DeviceId                      ,2    )
@@ -809,6 +821,10 @@
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,NumThread                     ,8    )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,SchedulingType                ,12   )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,Priority                      ,16   )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+        MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,LatencyBudget                 ,20   )
+        MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxExtThreadsParam                 ,SharedPool                    ,24   )
+#endif
 
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxPlatform                        ,CodeName                      ,0    )
         MSDK_STATIC_ASSERT_STRUCT_OFFSET(mfxPlatform                        ,DeviceId                      ,2    )
@@ -0,0 +1,152 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "mfx_common.h"
+
+#if defined (MFX_ENABLE_VPP)
+#if defined (MFX_VA_LINUX)
+
+#include "mfx_vpp_null.h"
+#include "libmfx_core_interface.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace MfxHwVideoProcessing;
+
+NullVideoProcessing::NullVideoProcessing()
+    : m_core(NULL)
+    , m_latency(0)
+{
+} // NullVideoProcessing::NullVideoProcessing()
+
+
+NullVideoProcessing::~NullVideoProcessing()
+{
+    DestroyDevice();
+
+} // NullVideoProcessing::~NullVideoProcessing()
+
+
+mfxStatus NullVideoProcessing::CreateDevice(VideoCORE * core, mfxVideoParam* /*pParams*/, bool /*isTemporal*/)
+{
+    MFX_CHECK_NULL_PTR1( core );
+
+    NullDeviceParam *pNullDevice = QueryCoreInterface<NullDeviceParam>(core, MFXINULLDEVICE_GUID);
+    MFX_CHECK(pNullDevice, MFX_ERR_DEVICE_FAILED);
+
+    m_core    = core;
+    m_latency = std::chrono::microseconds(pNullDevice->latency);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullVideoProcessing::CreateDevice(VideoCORE * core, mfxVideoParam* pParams, bool isTemporal)
+
+
+mfxStatus NullVideoProcessing::DestroyDevice(void)
+{
+    UMC::AutomaticUMCMutex guard(m_guard);
+
+    m_feedbackCache.clear();
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullVideoProcessing::DestroyDevice(void)
+
+
+mfxStatus NullVideoProcessing::QueryCapabilities(mfxVppCaps& caps)
+{
+    // filters and formats of the VA-API video processing on the recent platforms
+    caps.uDenoiseFilter = 1;
+    caps.uDetailFilter  = 1;
+    caps.uProcampFilter = 1;
+    caps.uSimpleDI      = 1;
+    caps.uAdvancedDI    = 1;
+#ifdef MFX_ENABLE_VPP_ROTATION
+    caps.uRotation      = 1;
+#endif
+    caps.uMirroring     = 1;
+
+    caps.uMaxWidth  = 4096;
+    caps.uMaxHeight = 4096;
+
+    caps.uFieldWeavingControl = 1;
+
+    for (auto fourcc : g_TABLE_SUPPORTED_FOURCC)
+    {
+        caps.mFormatSupport[fourcc] |= MFX_FORMAT_SUPPORT_INPUT | MFX_FORMAT_SUPPORT_OUTPUT;
+    }
+
+    caps.uScaling      = 1;
+    caps.uChromaSiting = 1;
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullVideoProcessing::QueryCapabilities(mfxVppCaps& caps)
+
+
+mfxStatus NullVideoProcessing::Execute(mfxExecuteParams *pParams)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "NullVideoProcessing::Execute");
+
+    MFX_CHECK_NULL_PTR1( pParams );
+    MFX_CHECK_NULL_PTR1( pParams->pRefSurfaces );
+
+    Feedback feedback;
+    feedback.number = pParams->statusReportID;
+    feedback.due    = std::chrono::steady_clock::now() + m_latency;
+
+    UMC::AutomaticUMCMutex guard(m_guard);
+    m_feedbackCache.push_back(feedback);
+
+    return MFX_ERR_NONE;
+
+} // mfxStatus NullVideoProcessing::Execute(mfxExecuteParams *pParams)
+
+
+mfxStatus NullVideoProcessing::QueryTaskStatus(mfxU32 taskIndex)
+{
+    Feedback feedback;
+
+    {
+        UMC::AutomaticUMCMutex guard(m_guard);
+
+        auto it = std::find_if(m_feedbackCache.begin(), m_feedbackCache.end(),
+            [taskIndex](const Feedback & fb) { return fb.number == taskIndex; });
+        if (m_feedbackCache.end() == it)
+        {
+            return MFX_ERR_UNKNOWN;
+        }
+
+        feedback = *it;
+        m_feedbackCache.erase(it);
+    }
+
+    // the real device blocks vaSyncSurface the same way
+    std::this_thread::sleep_until(feedback.due);
+
+    return MFX_TASK_DONE;
+
+} // mfxStatus NullVideoProcessing::QueryTaskStatus(mfxU32 taskIndex)
+
+#endif // #if defined (MFX_VA_LINUX)
+#endif // #if defined (MFX_ENABLE_VPP)
+/* EOF */
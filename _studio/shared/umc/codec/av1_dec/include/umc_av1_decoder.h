@@ -87,6 +87,30 @@ namespace UMC_AV1_DECODER
         }
     };
 
+    // Encoders repeat sequence_header_obu() in every temporal unit (or at least every key frame).
+    // Keeps raw bytes of the last parsed one, so identical copies are not parsed again.
+    struct SequenceHeaderCache
+    {
+        uint64_t             hash = 0;
+        std::vector<uint8_t> raw;
+    };
+
+    // Result of AV1Decoder::ScanFrames, one entry per frame_header_obu()/frame_obu()
+    struct FrameScanInfo
+    {
+        size_t     offset;                 // offset of frame (header) OBU from the start of the buffer
+        size_t     size;                   // size of frame header and tile group OBUs of this frame
+        FRAME_TYPE frame_type;
+        uint32_t   show_frame;
+        uint32_t   showable_frame;
+        uint32_t   show_existing_frame;
+        uint32_t   frame_to_show_map_idx;
+        uint32_t   width;                  // upscaled width
+        uint32_t   height;
+        uint32_t   temporal_id;
+        uint32_t   spatial_id;
+    };
+
     class AV1Decoder
         : public UMC::VideoDecoder
     {
@@ -100,6 +124,11 @@ namespace UMC_AV1_DECODER
 
         static UMC::Status DecodeHeader(UMC::MediaData*, UMC_AV1_DECODER::AV1DecoderParams&);
 
+        // Walks all OBUs in the buffer and parses only sequence and uncompressed frame headers.
+        // Tile data is skipped, data pointer of [in] is not moved.
+        // Returns UMC_ERR_NOT_ENOUGH_DATA if the buffer ends with incomplete OBU.
+        static UMC::Status ScanFrames(UMC::MediaData* in, std::vector<FrameScanInfo>& frames);
+
         /* UMC::BaseCodec interface */
         UMC::Status Init(UMC::BaseCodecParams*) override;
         UMC::Status GetFrame(UMC::MediaData* in, UMC::MediaData* out) override;
@@ -160,6 +189,7 @@ namespace UMC_AV1_DECODER
         UMC::FrameAllocator*            allocator;
 
         std::unique_ptr<SequenceHeader> sequence_header;
+        SequenceHeaderCache             sequence_header_cache;
         DPBType                         dpb;     // store of decoded frames
 
         uint32_t                        counter;
@@ -33,6 +33,19 @@ namespace UMC_AV1_DECODER
 {
     inline uint32_t CeilLog2(uint32_t x) { uint32_t l = 0; while (x > (1U << l)) l++; return l; }
 
+    // 64-bit FNV-1a, used as a key for repeated header OBUs
+    inline uint64_t CalcHash(uint8_t const* data, size_t size)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= data[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
     // we stop using UMC_VP9_DECODER namespace starting from Rev 0.25.2
     // because after switch to AV1-specific segmentation stuff there are only few definitions we need to re-use from VP9
     void SetSegData(SegmentationParams & seg, uint8_t segmentId, SEG_LVL_FEATURES featureId, int32_t seg_data);
@@ -80,6 +80,26 @@ namespace UMC_AV1_DECODER
             return MFX_LEVEL_UNKNOWN;
     }
 
+    // Parses sequence header OBU unless it is a byte-exact copy of the last parsed one.
+    // Returns true if [sh] was updated.
+    static bool UpdateSequenceHeader(SequenceHeaderCache& cache, AV1Bitstream& bs, uint8_t const* obu, size_t size, SequenceHeader& sh)
+    {
+        const uint64_t hash = CalcHash(obu, size);
+        if (hash == cache.hash && cache.raw.size() == size &&
+            std::equal(cache.raw.begin(), cache.raw.end(), obu))
+            return false;
+
+        cache.raw.clear(); // stays invalid if parsing throws
+
+        sh = SequenceHeader{};
+        bs.ReadSequenceHeader(sh);
+
+        cache.hash = hash;
+        cache.raw.assign(obu, obu + size);
+
+        return true;
+    }
+
     UMC::Status AV1Decoder::DecodeHeader(UMC::MediaData* in, UMC_AV1_DECODER::AV1DecoderParams& par)
     {
         if (!in)
@@ -119,6 +139,121 @@ namespace UMC_AV1_DECODER
         return UMC::UMC_ERR_NOT_ENOUGH_DATA;
     }
 
+    UMC::Status AV1Decoder::ScanFrames(UMC::MediaData* in, std::vector<FrameScanInfo>& frames)
+    {
+        if (!in)
+            return UMC::UMC_ERR_NULL_PTR;
+
+        SequenceHeaderCache cache;
+        SequenceHeader sh = {};
+        bool gotSequenceHeader = false;
+
+        // shadow DPB: frames hold only headers required to parse next ones, no surfaces are attached
+        std::vector<std::unique_ptr<AV1DecoderFrame>> slots(NUM_REF_FRAMES);
+        DPBType dpb(NUM_REF_FRAMES);
+        for (uint8_t i = 0; i < NUM_REF_FRAMES; i++)
+        {
+            slots[i].reset(new AV1DecoderFrame{});
+            dpb[i] = slots[i].get();
+        }
+
+        FrameHeader fh = {};
+        uint32_t prevFrameId = 0;
+        bool frameInProgress = false;
+        size_t offset = 0;
+
+        UMC::MediaData tmp = *in;
+
+        try
+        {
+            while (tmp.GetDataSize() >= MINIMAL_DATA_SIZE)
+            {
+                const auto src = reinterpret_cast<uint8_t*>(tmp.GetDataPointer());
+                AV1Bitstream bs(src, uint32_t(tmp.GetDataSize()));
+
+                OBUInfo obuInfo;
+                bs.ReadOBUInfo(obuInfo);
+
+                if (tmp.GetDataSize() < obuInfo.size)
+                    return UMC::UMC_ERR_NOT_ENOUGH_DATA;
+
+                switch (obuInfo.header.obu_type)
+                {
+                case OBU_SEQUENCE_HEADER:
+                    UpdateSequenceHeader(cache, bs, src, obuInfo.size, sh);
+                    gotSequenceHeader = true;
+                    break;
+                case OBU_FRAME_HEADER:
+                case OBU_FRAME:
+                {
+                    if (!gotSequenceHeader)
+                        break; // bypass frame header if there is no active seq header
+
+                    fh = FrameHeader{};
+                    bs.ReadUncompressedHeader(fh, sh, dpb, obuInfo.header, prevFrameId);
+
+                    FrameScanInfo info = {};
+                    info.offset                = offset;
+                    info.size                  = obuInfo.size;
+                    info.frame_type            = fh.frame_type;
+                    info.show_frame            = fh.show_frame;
+                    info.showable_frame        = fh.showable_frame;
+                    info.show_existing_frame   = fh.show_existing_frame;
+                    info.frame_to_show_map_idx = fh.frame_to_show_map_idx;
+                    info.width                 = fh.UpscaledWidth;
+                    info.height                = fh.FrameHeight;
+                    info.temporal_id           = obuInfo.header.temporal_id;
+                    info.spatial_id            = obuInfo.header.spatial_id;
+
+                    FrameHeader const* refresh = &fh;
+                    if (fh.show_existing_frame)
+                    {
+                        FrameHeader const& shown = dpb[fh.frame_to_show_map_idx]->GetFrameHeader();
+                        info.frame_type = shown.frame_type;
+                        info.width      = shown.UpscaledWidth;
+
+                        // showing of existing key frame refreshes DPB, see StartFrame
+                        refresh = shown.frame_type == KEY_FRAME ? &shown : nullptr;
+                    }
+
+                    if (refresh)
+                    {
+                        FrameHeader const src_fh = *refresh;
+                        for (uint8_t i = 0; i < NUM_REF_FRAMES; i++)
+                        {
+                            if ((src_fh.refresh_frame_flags >> i) & 1)
+                            {
+                                slots[i]->Reset(&src_fh);
+                                slots[i]->SetRefValid(true);
+                            }
+                        }
+                    }
+
+                    frames.push_back(info);
+                    frameInProgress = !fh.show_existing_frame;
+                    break;
+                }
+                case OBU_REDUNDANT_FRAME_HEADER:
+                case OBU_TILE_GROUP:
+                    if (frameInProgress)
+                        frames.back().size += obuInfo.size;
+                    break;
+                default:
+                    break;
+                }
+
+                offset += obuInfo.size;
+                tmp.MoveDataPointer(static_cast<int32_t>(obuInfo.size));
+            }
+        }
+        catch (av1_exception const& e)
+        {
+            return e.GetStatus();
+        }
+
+        return UMC::UMC_OK;
+    }
+
     UMC::Status AV1Decoder::Init(UMC::BaseCodecParams* vp)
     {
         if (!vp)
@@ -457,8 +592,7 @@ namespace UMC_AV1_DECODER
                 case OBU_SEQUENCE_HEADER:
                     if (!sequence_header.get())
                         sequence_header.reset(new SequenceHeader);
-                    *sequence_header = SequenceHeader{};
-                    bs.ReadSequenceHeader(*sequence_header);
+                    UpdateSequenceHeader(sequence_header_cache, bs, src, obuInfo.size, *sequence_header);
                     break;
                 case OBU_FRAME_HEADER:
                 case OBU_REDUNDANT_FRAME_HEADER:
@@ -152,6 +152,11 @@ public:
   JERRCODE ColorConvert(uint32_t rowCMU, uint32_t colMCU, uint32_t maxMCU);
   JERRCODE UpSampling(uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU);
 
+  // YUY2 destination is set as pixel order YCbCr 4:2:2
+  bool     IsDstYUY2(void) const;
+  // chroma of 4:2:2 and 4:2:0 images goes to YUY2 without horizontal upsampling
+  bool     IsYUY2HalfWidth(const CJPEGColorComponent* comp) const;
+
   JERRCODE FindNextImage();
   JERRCODE ParseData();
   virtual JERRCODE ParseJPEGBitStream(JOPERATION op);
@@ -48,11 +48,6 @@ namespace UMC
 {
 
 
-enum
-{
-    JPEG_MAX_THREADS = 4
-};
-
 class MJPEGVideoDecoderMFX : public MJPEGVideoDecoderBaseMFX
 {
 public:
@@ -38,6 +38,13 @@
 namespace UMC
 {
 
+enum
+{
+    JPEG_MAX_THREADS = 64,
+    // there is no use in more decoders than MCU rows (restart intervals rarely split a row)
+    JPEG_MIN_LINES_PER_THREAD = 16
+};
+
 typedef struct
 {
     ChromaType colorFormat;
@@ -1419,6 +1419,19 @@ uint32_t JPEG_BPP[JC_MAX] =
 #define iGv  0x00006b2f
 #define iBv  0x000014d1
 
+bool CJPEGDecoder::IsDstYUY2(void) const
+{
+  return JD_PIXEL == m_dst.order && JC_YCBCR == m_dst.color && JS_422H == m_dst.sampling;
+} // CJPEGDecoder::IsDstYUY2()
+
+
+bool CJPEGDecoder::IsYUY2HalfWidth(const CJPEGColorComponent* comp) const
+{
+  return IsDstYUY2() && JC_YCBCR == m_jpeg_color && 1 == m_dd_factor &&
+         comp->m_h_factor == 2 && (comp->m_v_factor == 1 || comp->m_v_factor == 2);
+} // CJPEGDecoder::IsYUY2HalfWidth()
+
+
 JERRCODE CJPEGDecoder::ColorConvert(uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU)
 {
   int       cc_h;
@@ -1518,6 +1531,80 @@ JERRCODE CJPEGDecoder::ColorConvert(uint32_t rowMCU, uint32_t colMCU, uint32_t m
           }
       }
   }
+  else if((JC_YCBCR == m_jpeg_color || JC_GRAY == m_jpeg_color) && IsDstYUY2())
+  {
+      int     srcStep;
+      uint8_t*  pSrc8u;
+      int     dstStep;
+      uint8_t*  pDst8u;
+      int     halfWidth = (roi.width + 1) >> 1;
+
+      dstStep = m_dst.lineStep[0];
+
+      pDst8u = m_dst.p.Data8u[0] +
+          rowMCU * m_curr_scan->mcuHeight * m_curr_scan->min_v_factor * dstStep / m_dd_factor +
+          colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor * 2;
+
+      for(int n = m_curr_scan->first_comp; n < m_curr_scan->first_comp + m_curr_scan->ncomps; n++)
+      {
+          CJPEGColorComponent* curr_comp = &m_ccomp[n];
+
+          if(n == 0)
+          {
+              srcStep = curr_comp->m_cc_step;
+              pSrc8u  = curr_comp->GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor;
+
+              for(int i=0; i<roi.height; i++)
+                  for(int j=0; j<roi.width; j++)
+                  {
+                      pDst8u[i*dstStep + j*2] = pSrc8u[i*srcStep + j];
+                  }
+
+              if(JC_GRAY == m_jpeg_color)
+              {
+                  for(int i=0; i<roi.height; i++)
+                      for(int j=0; j<halfWidth; j++)
+                      {
+                          pDst8u[i*dstStep + j*4 + 1] = 0x80;
+                          pDst8u[i*dstStep + j*4 + 3] = 0x80;
+                      }
+              }
+          }
+          else if(IsYUY2HalfWidth(curr_comp))
+          {
+              // 4:2:2 - block samples, 4:2:0 - interpolated by UpSampling() vertically only
+              if(curr_comp->m_v_factor == 1)
+              {
+                  srcStep = curr_comp->m_ss_step;
+                  pSrc8u  = curr_comp->GetSSBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor / 2;
+              }
+              else
+              {
+                  srcStep = curr_comp->m_cc_step;
+                  pSrc8u  = curr_comp->GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor / 2;
+              }
+
+              for(int i=0; i<roi.height; i++)
+                  for(int j=0; j<halfWidth; j++)
+                  {
+                      pDst8u[i*dstStep + j*4 + n*2 - 1] = pSrc8u[i*srcStep + j];
+                  }
+          }
+          else
+          {
+              // full resolution chroma, average of two samples
+              srcStep = curr_comp->m_cc_step;
+              pSrc8u  = curr_comp->GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor;
+
+              for(int i=0; i<roi.height; i++)
+                  for(int j=0; j<halfWidth; j++)
+                  {
+                      pDst8u[i*dstStep + j*4 + n*2 - 1] =
+                          (uint8_t)((pSrc8u[i*srcStep + j*2] + pSrc8u[i*srcStep + j*2 + 1] + 1) >> 1);
+                  }
+          }
+      }
+  }
   else if(JC_YCBCR == m_jpeg_color && JC_YCBCR == m_dst.color && JS_444 == m_dst.sampling && m_jpeg_ncomp != m_curr_scan->ncomps)
   {
       int     srcStep[3];
@@ -1667,6 +1754,47 @@ JERRCODE CJPEGDecoder::ColorConvert(uint32_t rowMCU, uint32_t colMCU, uint32_t m
               pDst8u[1][i*dstStep[1] + (j<<1)+1] = (uint8_t)(( iBu*r0 - iGv*g0 - iBv*b0 + 0x2000000) >> 18);
           }
       }
+      else if (JC_RGB == m_jpeg_color && IsDstYUY2())
+      {
+          int     srcStep;
+          uint8_t*  pSrc8u[3];
+          int     dstStep;
+          uint8_t*  pDst8u;
+          int     r0,r1, g0,g1, b0,b1;
+
+          srcStep = m_ccomp[0].m_cc_step;
+
+          pSrc8u[0] = m_ccomp[0].GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth;
+          pSrc8u[1] = m_ccomp[1].GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth;
+          pSrc8u[2] = m_ccomp[2].GetCCBufferPtr<uint8_t> (0) + colMCU * m_curr_scan->mcuWidth;
+
+          dstStep = m_dst.lineStep[0];
+
+          pDst8u = m_dst.p.Data8u[0] +
+              rowMCU * m_curr_scan->mcuHeight * m_curr_scan->min_v_factor * dstStep / m_dd_factor +
+              colMCU * m_curr_scan->mcuWidth * m_curr_scan->min_h_factor * 2;
+
+          for(int i=0; i<roi.height; i++)
+              for(int j=0; j<(roi.width + 1) >> 1; j++)
+          {
+              r0 = pSrc8u[0][i*srcStep + (j<<1)  ];
+              g0 = pSrc8u[1][i*srcStep + (j<<1)  ];
+              b0 = pSrc8u[2][i*srcStep + (j<<1)  ];
+              r1 = pSrc8u[0][i*srcStep + (j<<1)+1];
+              g1 = pSrc8u[1][i*srcStep + (j<<1)+1];
+              b1 = pSrc8u[2][i*srcStep + (j<<1)+1];
+
+              pDst8u[i*dstStep + (j<<2)  ] = (uint8_t)(( iRY*r0 + iGY*g0 + iBY*b0 + 0x008000) >> 16);
+              pDst8u[i*dstStep + (j<<2)+2] = (uint8_t)(( iRY*r1 + iGY*g1 + iBY*b1 + 0x008000) >> 16);
+
+              r0 = r0+r1;
+              g0 = g0+g1;
+              b0 = b0+b1;
+
+              pDst8u[i*dstStep + (j<<2)+1] = (uint8_t)((-iRu*r0 - iGu*g0 + iBu*b0 + 0x1000000) >> 17);
+              pDst8u[i*dstStep + (j<<2)+3] = (uint8_t)(( iBu*r0 - iGv*g0 - iBv*b0 + 0x1000000) >> 17);
+          }
+      }
       else if (JC_YCBCR == m_jpeg_color && JC_BGRA == m_dst.color)
       {
           int     srcStep;
@@ -1717,6 +1845,46 @@ JERRCODE CJPEGDecoder::UpSampling(uint32_t rowMCU, uint32_t colMCU, uint32_t max
         curr_comp       = &m_ccomp[k];
         need_upsampling = curr_comp->m_need_upsampling;
 
+        // YUY2 destination takes 4:2:2 chroma from the SS buffer as is,
+        // 4:2:0 chroma is interpolated vertically only, see ColorConvert()
+        if(IsYUY2HalfWidth(curr_comp) && need_upsampling)
+        {
+          if(curr_comp->m_v_factor == 2)
+          {
+            int      srcStep;
+            int      dstStep;
+            int      ssRows;
+            uint8_t* pSrc;
+            uint8_t* pDst;
+            uint32_t srcWidth;
+
+            srcWidth = (maxMCU - colMCU) * 8 * curr_comp->m_scan_hsampling;
+            srcStep  = curr_comp->m_ss_step;
+            dstStep  = curr_comp->m_cc_step;
+            ssRows   = m_mcuHeight >> 1;
+
+            pSrc = curr_comp->GetSSBufferPtr<uint8_t> (0) + 8 * colMCU * curr_comp->m_scan_hsampling;
+            pDst = curr_comp->GetCCBufferPtr<uint8_t> (0) + 8 * colMCU * curr_comp->m_scan_hsampling;
+
+            for(i = 0; i < ssRows; i++)
+            {
+              const uint8_t* p0 = pSrc + i * srcStep;
+              const uint8_t* pU = (i > 0)          ? p0 - srcStep : p0;
+              const uint8_t* pD = (i < ssRows - 1) ? p0 + srcStep : p0;
+              uint8_t*       d0 = pDst + 2 * i * dstStep;
+              uint8_t*       d1 = d0 + dstStep;
+
+              for(n = 0; n < (int)srcWidth; n++)
+              {
+                d0[n] = (uint8_t)((3 * p0[n] + pU[n] + 2) >> 2);
+                d1[n] = (uint8_t)((3 * p0[n] + pD[n] + 1) >> 2);
+              }
+            }
+          }
+
+          continue;
+        }
+
         // sampling 444
         // nothing to do for 444
 
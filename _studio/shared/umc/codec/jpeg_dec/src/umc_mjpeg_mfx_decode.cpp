@@ -22,6 +22,7 @@
 #if defined (MFX_ENABLE_MJPEG_VIDEO_DECODE) && defined(MFX_ENABLE_SW_FALLBACK)
 #include <string.h>
 #include <assert.h>
+#include <algorithm>
 #include "umc_video_data.h"
 #include "umc_mjpeg_mfx_decode.h"
 #include "membuffin.h"
@@ -100,6 +101,11 @@ Status MJPEGVideoDecoderMFX::Init(BaseCodecParams* lpInit)
     {
         numThreads = m_DecoderParams.numThreads;
     }
+    if (m_DecoderParams.info.clip_info.height)
+    {
+        numThreads = std::min<uint32_t>(numThreads,
+            std::max<uint32_t>(1, m_DecoderParams.info.clip_info.height / JPEG_MIN_LINES_PER_THREAD));
+    }
     m_dec.resize(numThreads);
     for (i = 0; i < numThreads; i += 1)
     {
@@ -433,8 +439,16 @@ Status MJPEGVideoDecoderMFX::AllocateFrame()
     else if((JC_YCBCR == m_color || JC_GRAY == m_color) &&
             YUY2 == m_DecoderParams.info.color_format)
     {
-        frm = NV12;
-        m_needPostProcessing = true;
+        // rotation is implemented for NV12 and RGB32 frames only
+        if(!m_rotation)
+        {
+            frm = YUY2;
+        }
+        else
+        {
+            frm = NV12;
+            m_needPostProcessing = true;
+        }
     }
     else if(JC_RGB == m_color &&
             NV12 == m_DecoderParams.info.color_format)
@@ -456,7 +470,11 @@ Status MJPEGVideoDecoderMFX::AllocateFrame()
             YUY2 == m_DecoderParams.info.color_format)
     {
         // single scan
-        if(m_dec[0]->m_jpeg_ncomp == m_dec[0]->m_scans[0].ncomps)
+        if(m_dec[0]->m_jpeg_ncomp == m_dec[0]->m_scans[0].ncomps && !m_rotation)
+        {
+            frm = YUY2;
+        }
+        else if(m_dec[0]->m_jpeg_ncomp == m_dec[0]->m_scans[0].ncomps)
         {
             frm = NV12;
             m_needPostProcessing = true;
@@ -500,7 +518,7 @@ Status MJPEGVideoDecoderMFX::AllocateFrame()
     }
     else
     {
-        if (RGB32 == m_internalFrame.GetColorFormat())
+        if (RGB32 == m_internalFrame.GetColorFormat() || YUY2 == m_internalFrame.GetColorFormat())
         {
             m_internalFrame.SetPlanePointer(frmData->GetPlaneMemoryInfo(0)->m_planePtr, 0);
             m_internalFrame.SetPlanePitch(frmData->GetPlaneMemoryInfo(0)->m_pitch, 0);
@@ -1052,6 +1070,22 @@ Status MJPEGVideoDecoderMFX::DecodePiece(const mfxU32 fieldNum,
 
         jerr = m_dec[threadNum]->SetDestination(pDst, dstStep, dimension, m_frameChannels, JC_BGRA, JS_444);
     }
+    else if (YUY2 == m_internalFrame.GetColorFormat())
+    {
+        dstStep = (int32_t)m_internalFrame.GetPlanePitch(0);
+        pDst = (uint8_t*)m_internalFrame.GetPlanePointer(0);
+        if (m_interleaved)
+        {
+            if (fieldNum & 1)//!m_firstField)
+                pDst += dstStep;
+            dstStep *= 2;
+
+            dimension.height /= 2;
+        }
+
+        // pixel order YCbCr 4:2:2 is written as Y0 U Y1 V
+        jerr = m_dec[threadNum]->SetDestination(pDst, dstStep, dimension, m_frameChannels, JC_YCBCR, JS_422H);
+    }
     else if (YUV444 == m_internalFrame.GetColorFormat())
     {
         pDstPlane[0] = (uint8_t*)m_internalFrame.GetPlanePointer(0);
@@ -36,6 +36,7 @@
 #include "enchtbl.h"
 #include "colorcomp.h"
 #include "bitstreamout.h"
+#include "vm_time.h"
 
 
 class CBaseStreamOutput;
@@ -52,6 +53,22 @@ typedef struct _JPEG_SCAN
 } JPEG_SCAN;
 
 
+// Stages of the baseline pipeline, time spent in each is returned by
+// CJPEGEncoder::GetStageTicks()
+typedef enum _JPEG_ENC_STAGE
+{
+  JES_COLOR_CONVERT = 0, // ColorConvert() or ProcessBuffer()
+  JES_DOWN_SAMPLING = 1, // DownSampling()
+  JES_DCT           = 2, // TransformMCURowBL()
+  JES_FUSED         = 3, // TransformMCURowFused(), all of the above per MCU
+  JES_HUFFMAN       = 4, // EncodeHuffmanMCURowBL()
+
+  // Number of timed stages
+  JES_MAX
+
+} JES;
+
+
 class CJPEGEncoder
 {
 public:
@@ -163,6 +180,10 @@ public:
   bool     IsACTableInited();
   bool     IsDCTableInited();
 
+  // Accumulated time of baseline encoding stages in vm_time_get_tick() units
+  void     GetStageTicks(vm_tick ticks[JES_MAX]) const;
+  void     ResetStageTicks(void);
+
 protected:
   IMAGE      m_src;
 
@@ -234,6 +255,8 @@ protected:
   CJPEGEncoderHuffmanTable   m_actbl[MAX_HUFF_TABLES];
   CJPEGEncoderHuffmanState   m_state;
 
+  vm_tick                    m_stageTicks[JES_MAX];
+
   JERRCODE Init(void);
   JERRCODE Clean(void);
   JERRCODE ColorConvert(uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU/*int nMCURow, int thread_id = 0*/);
@@ -282,6 +305,11 @@ protected:
 
   JERRCODE TransformMCURowBL(int16_t* pMCUBuf, uint32_t colMCU, uint32_t maxMCU/*int16_t* pMCUBuf, int thread_id = 0*/);
 
+  // Color conversion, sub-sampling and DCT of a few MCUs at a time while they are in L1,
+  // replaces ColorConvert/ProcessBuffer + DownSampling + TransformMCURowBL
+  bool     IsFusedPipeline(void);
+  JERRCODE TransformMCURowFused(int16_t* pMCUBuf, uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU);
+
   JERRCODE ProcessBuffer(uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU);//(int nMCURow, int thread_id = 0);
   JERRCODE EncodeScanProgressive_P(void);
 
@@ -46,12 +46,24 @@ namespace UMC
 enum
 {
     JPEG_ENC_MAX_THREADS_HW = 1,
-    JPEG_ENC_MAX_THREADS = 4
+    JPEG_ENC_MAX_THREADS = 64
 };
 
 enum
 {
-    JPEG_ENC_DEFAULT_NUM_PIECES = JPEG_ENC_MAX_THREADS
+    // automatic restart interval gives each thread a few pieces, so threads
+    // finishing early pick up the rest instead of waiting for the slowest one
+    JPEG_ENC_PIECES_PER_THREAD = 2
+};
+
+// Time spent in the encoder pipeline stages by all threads, milliseconds
+struct MJPEGEncoderStageTimes
+{
+    double colorConvert;
+    double downSampling;
+    double dct;
+    double fused;       // color conversion, sub-sampling and DCT done per group of MCUs
+    double huffman;
 };
 
 
@@ -177,6 +189,9 @@ public:
     // Get the number of encoders allocated
     uint32_t NumEncodersAllocated(void);
 
+    // Get time spent in the encoding stages since Init()
+    void GetStageTimes(MJPEGEncoderStageTimes* times);
+
     //
     uint32_t NumPicsCollected(void);
 
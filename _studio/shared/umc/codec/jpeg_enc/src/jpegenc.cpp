@@ -105,6 +105,7 @@ CJPEGEncoder::CJPEGEncoder(void) : m_src()
   m_BitStreamOutT = NULL;
   m_lastDC = NULL;
 
+  ResetStageTicks();
 
   return;
 } // ctor
@@ -365,7 +366,11 @@ JERRCODE CJPEGEncoder::SetParams(
   int      width, height;
   JERRCODE jerr = JPEG_OK;
 
-  if(JD_PLANE == m_src.order)
+  // NV12 source is consumed by TransformMCURowFused() only
+  if(JC_NV12 == m_src.color && (JPEG_BASELINE != mode || JC_YCBCR != color || JS_420 != sampling))
+    return JPEG_ERR_PARAMS;
+
+  if(JD_PLANE == m_src.order && JC_NV12 != m_src.color)
   {
     if(m_src.precision <= 8)
     {
@@ -1022,6 +1027,20 @@ bool CJPEGEncoder::IsDCTableInited()
 } // CJPEGEncoder::IsDCTableInited()
 
 
+void CJPEGEncoder::GetStageTicks(vm_tick ticks[JES_MAX]) const
+{
+  for(int i = 0; i < JES_MAX; i++)
+    ticks[i] = m_stageTicks[i];
+} // CJPEGEncoder::GetStageTicks()
+
+
+void CJPEGEncoder::ResetStageTicks(void)
+{
+  for(int i = 0; i < JES_MAX; i++)
+    m_stageTicks[i] = 0;
+} // CJPEGEncoder::ResetStageTicks()
+
+
 JERRCODE CJPEGEncoder::WriteSOI(void)
 {
   JERRCODE jerr;
@@ -2501,6 +2520,33 @@ JERRCODE CJPEGEncoder::ColorConvert(uint32_t rowMCU, uint32_t colMCU, uint32_t m
     }
   }
 
+  // BGRA to YCbCr
+  if(m_src.color == JC_BGRA && m_jpeg_color == JC_YCBCR)
+  {
+    int    dstStep;
+    uint8_t* pDst8u[3];
+
+    if(m_src.precision > 8)
+    {
+      return JPEG_ERR_INTERNAL;
+    }
+
+    dstStep = m_ccomp[0].m_cc_step;
+    convert = 1;
+
+    pDst8u[0] = m_ccomp[0].GetCCBufferPtr(0/*thread_id*/);
+    pDst8u[1] = m_ccomp[1].GetCCBufferPtr(0/*thread_id*/);
+    pDst8u[2] = m_ccomp[2].GetCCBufferPtr(0/*thread_id*/);
+
+    status = mfxiBGRToYCbCr_JPEG_8u_C4P3R(pSrc8u,srcStep,pDst8u,dstStep,roi);
+
+    if(ippStsNoErr != status)
+    {
+      LOG1("IPP Error: mfxiBGRToYCbCr_JPEG_8u_C4P3R() failed - ",status);
+      return JPEG_ERR_INTERNAL;
+    }
+  }
+
   // YCbCr to YCbCr (422 sampling)
   if(m_src.color == JC_YCBCR && m_jpeg_color == JC_YCBCR &&
      m_src.sampling == JS_422H && m_jpeg_sampling == JS_422H)
@@ -2694,7 +2740,7 @@ JERRCODE CJPEGEncoder::DownSampling(uint32_t rowMCU, uint32_t colMCU, uint32_t m
       {
         for(i = 0; i < m_mcuHeight; i++)
         {
-          int srcWidth = (maxMCU - colMCU) * 8 * curr_comp->m_hsampling;
+          int srcWidth = (maxMCU - colMCU) * 8 * m_ccomp[0].m_hsampling;
 
           status = mfxiSampleDownRowH2V1_Box_JPEG_8u_C1(pSrc, srcWidth, pDst);
           if(ippStsNoErr != status)
@@ -2718,7 +2764,7 @@ JERRCODE CJPEGEncoder::DownSampling(uint32_t rowMCU, uint32_t colMCU, uint32_t m
       uint8_t* pDst;
 
       srcStep = curr_comp->m_cc_step;
-      srcWidth = (maxMCU - colMCU) * 8 * curr_comp->m_hsampling;
+      srcWidth = (maxMCU - colMCU) * 8 * m_ccomp[0].m_hsampling;
 
       pSrc = curr_comp->GetCCBufferPtr(0/*thread_id*/);
       pDst = curr_comp->GetSSBufferPtr(0/*thread_id*/);
@@ -2904,6 +2950,260 @@ JERRCODE CJPEGEncoder::TransformMCURowBL(int16_t* pMCUBuf, uint32_t colMCU, uint
 } // CJPEGEncoder::TransformMCURowBL()
 
 
+// MCUs processed at once by TransformMCURowFused(): planes of 4 MCUs of
+// up to 16x16 pixels take 3 KB and stay in L1 from color conversion to DCT
+#define FUSED_NUM_MCU    4
+#define FUSED_PLANE_SIZE (FUSED_NUM_MCU * 16 * 16)
+
+// Fills plane outside of the visible width x height area by edge replication
+static void ExpandPlane(uint8_t* p, int step, int width, int height, int planeWidth, int planeHeight)
+{
+  int i;
+
+  if(width < planeWidth)
+  {
+    for(i = 0; i < height; i++)
+    {
+      memset(p + i * step + width, p[i * step + width - 1], planeWidth - width);
+    }
+  }
+
+  for(i = height; i < planeHeight; i++)
+  {
+    MFX_INTERNAL_CPY(p + i * step, p + (height - 1) * step, planeWidth);
+  }
+} // ExpandPlane()
+
+
+bool CJPEGEncoder::IsFusedPipeline(void)
+{
+  if(JPEG_BASELINE != m_jpeg_mode || m_src.precision > 8 || m_num_scans != 1 || m_jpeg_ncomp != 3)
+    return false;
+
+  if(m_jpeg_sampling != JS_444 && m_jpeg_sampling != JS_422H && m_jpeg_sampling != JS_420)
+    return false;
+
+  // NV12: Y plane and interleaved UV plane
+  if(m_src.color == JC_NV12)
+    return m_jpeg_color == JC_YCBCR && m_jpeg_sampling == JS_420;
+
+  if(JD_PIXEL != m_src.order)
+    return false;
+
+  // YUY2
+  if(m_src.color == JC_YCBCR && m_src.sampling == JS_422H)
+    return m_jpeg_color == JC_YCBCR && m_jpeg_sampling == JS_422H;
+
+  // RGB4
+  if(m_src.color == JC_BGRA && m_jpeg_color == JC_RGB)
+    return m_jpeg_sampling == JS_444;
+
+  if((m_src.color == JC_BGRA || m_src.color == JC_RGBA) && m_jpeg_color == JC_YCBCR)
+    return true;
+
+  return false;
+} // CJPEGEncoder::IsFusedPipeline()
+
+
+JERRCODE CJPEGEncoder::TransformMCURowFused(int16_t* pMCUBuf, uint32_t rowMCU, uint32_t colMCU, uint32_t maxMCU)
+{
+  int c, i, j;
+  int vs;
+  int hs;
+  int status;
+  uint8_t  cc[3][FUSED_PLANE_SIZE];  // full resolution planes
+  uint8_t  ss[3][FUSED_PLANE_SIZE];  // sub-sampled chroma of RGB sources
+  uint8_t* pcc[3] = { cc[0], cc[1], cc[2] };
+  uint8_t* plane[3];
+  int      step[3];
+  uint16_t* qtbl;
+  CJPEGColorComponent* curr_comp;
+
+  const int mcuWidth  = m_curr_scan.mcuWidth;
+  const int mcuHeight = m_curr_scan.mcuHeight;
+  const int y         = rowMCU * mcuHeight;
+  const int height    = std::min(mcuHeight, m_src.height - y);
+
+  for(uint32_t mcu = colMCU; mcu < maxMCU; mcu += FUSED_NUM_MCU)
+  {
+    const int numMCU     = std::min((int)(maxMCU - mcu), FUSED_NUM_MCU);
+    const int planeWidth = numMCU * mcuWidth;
+    const int x          = mcu * mcuWidth;
+    const int width      = std::min(planeWidth, m_src.width - x);
+
+    for(c = 0; c < 3; c++)
+    {
+      plane[c] = cc[c];
+      step[c]  = planeWidth / m_ccomp[c].m_h_factor;
+    }
+
+    if(m_src.color == JC_NV12)
+    {
+      const uint8_t* srcY  = m_src.p.Data8u[0] + y * m_src.lineStep[0] + x;
+      const uint8_t* srcUV = m_src.p.Data8u[1] + (y >> 1) * m_src.lineStep[1] + x;
+      const int      cw    = (width + 1) >> 1;
+      const int      ch    = (height + 1) >> 1;
+
+      for(i = 0; i < height; i++)
+      {
+        MFX_INTERNAL_CPY(cc[0] + i * step[0], srcY + i * m_src.lineStep[0], width);
+      }
+
+      for(i = 0; i < ch; i++)
+      {
+        const uint8_t* uv = srcUV + i * m_src.lineStep[1];
+        uint8_t*       u  = cc[1] + i * step[1];
+        uint8_t*       v  = cc[2] + i * step[2];
+
+        for(j = 0; j < cw; j++)
+        {
+          u[j] = uv[2 * j + 0];
+          v[j] = uv[2 * j + 1];
+        }
+      }
+
+      ExpandPlane(cc[0], step[0], width, height, step[0], mcuHeight);
+      ExpandPlane(cc[1], step[1], cw, ch, step[1], mcuHeight >> 1);
+      ExpandPlane(cc[2], step[2], cw, ch, step[2], mcuHeight >> 1);
+    }
+    else if(m_src.color == JC_YCBCR)
+    {
+      const uint8_t* src = m_src.p.Data8u[0] + y * m_src.lineStep[0] + 2 * x;
+      const int      cw  = (width + 1) >> 1;
+
+      for(i = 0; i < height; i++)
+      {
+        const uint8_t* yuy2 = src + i * m_src.lineStep[0];
+        uint8_t*       py   = cc[0] + i * step[0];
+        uint8_t*       u    = cc[1] + i * step[1];
+        uint8_t*       v    = cc[2] + i * step[2];
+
+        for(j = 0; j < cw; j++)
+        {
+          py[2 * j + 0] = yuy2[4 * j + 0];
+          u[j]          = yuy2[4 * j + 1];
+          py[2 * j + 1] = yuy2[4 * j + 2];
+          v[j]          = yuy2[4 * j + 3];
+        }
+      }
+
+      ExpandPlane(cc[0], step[0], width, height, step[0], mcuHeight);
+      ExpandPlane(cc[1], step[1], cw, height, step[1], mcuHeight);
+      ExpandPlane(cc[2], step[2], cw, height, step[2], mcuHeight);
+    }
+    else if(m_jpeg_color == JC_RGB)
+    {
+      const uint8_t* src = m_src.p.Data8u[0] + y * m_src.lineStep[0] + 4 * x;
+
+      for(i = 0; i < height; i++)
+      {
+        const uint8_t* bgra = src + i * m_src.lineStep[0];
+        uint8_t*       r    = cc[0] + i * step[0];
+        uint8_t*       g    = cc[1] + i * step[1];
+        uint8_t*       b    = cc[2] + i * step[2];
+
+        for(j = 0; j < width; j++)
+        {
+          r[j] = bgra[4 * j + 2];
+          g[j] = bgra[4 * j + 1];
+          b[j] = bgra[4 * j + 0];
+        }
+      }
+
+      for(c = 0; c < 3; c++)
+      {
+        ExpandPlane(cc[c], step[c], width, height, step[c], mcuHeight);
+      }
+    }
+    else
+    {
+      const uint8_t* src = m_src.p.Data8u[0] + y * m_src.lineStep[0] + 4 * x;
+      mfxSize        roi;
+
+      // the converters need 2 pixels at least, the surface is padded to the MCU size
+      roi.width  = std::max(width, 2);
+      roi.height = height;
+
+      if(m_src.color == JC_BGRA)
+        status = mfxiBGRToYCbCr_JPEG_8u_C4P3R(src, m_src.lineStep[0], pcc, planeWidth, roi);
+      else
+        status = mfxiRGBToYCbCr_JPEG_8u_C4P3R(src, m_src.lineStep[0], pcc, planeWidth, roi);
+
+      if(ippStsNoErr != status)
+      {
+        LOG1("IPP Error: mfxiRGBToYCbCr_JPEG_8u_C4P3R() failed - ",status);
+        return JPEG_ERR_INTERNAL;
+      }
+
+      for(c = 0; c < 3; c++)
+      {
+        ExpandPlane(cc[c], planeWidth, width, height, planeWidth, mcuHeight);
+      }
+
+      for(c = 1; c < 3; c++)
+      {
+        curr_comp = &m_ccomp[c];
+
+        if(curr_comp->m_h_factor == 1 && curr_comp->m_v_factor == 1)
+        {
+          continue;
+        }
+
+        plane[c] = ss[c];
+
+        for(i = 0; i < mcuHeight; i += curr_comp->m_v_factor)
+        {
+          uint8_t* p1  = cc[c] + i * planeWidth;
+          uint8_t* dst = ss[c] + (i / curr_comp->m_v_factor) * step[c];
+
+          if(curr_comp->m_v_factor == 2)
+            status = mfxiSampleDownRowH2V2_Box_JPEG_8u_C1(p1, p1 + planeWidth, planeWidth, dst);
+          else
+            status = mfxiSampleDownRowH2V1_Box_JPEG_8u_C1(p1, planeWidth, dst);
+
+          if(ippStsNoErr != status)
+          {
+            LOG0("Error: mfxiSampleDownRow_Box_JPEG_8u_C1() failed!");
+            return JPEG_ERR_INTERNAL;
+          }
+        }
+      }
+    }
+
+    for(i = 0; i < numMCU; i++)
+    {
+      for(c = 0; c < 3; c++)
+      {
+        curr_comp = &m_ccomp[c];
+
+        qtbl = m_qntbl[curr_comp->m_q_selector];
+
+        for(vs = 0; vs < mcuHeight / (8 * curr_comp->m_v_factor); vs++)
+        {
+          for(hs = 0; hs < mcuWidth / (8 * curr_comp->m_h_factor); hs++)
+          {
+            const uint8_t* src = plane[c] +
+                                 i * mcuWidth / curr_comp->m_h_factor +
+                                 8 * vs * step[c] + 8 * hs;
+
+            status = mfxiDCTQuantFwd8x8LS_JPEG_8u16s_C1R(src, step[c], pMCUBuf, qtbl);
+            if(ippStsNoErr != status)
+            {
+              LOG0("Error: mfxiDCTQuantFwd8x8LS_JPEG_8u16s_C1R() failed!");
+              return JPEG_ERR_INTERNAL;
+            }
+
+            pMCUBuf += DCTSIZE2;
+          } // for hs
+        } // for vs
+      } // for components
+    } // for numMCU
+  } // for mcu
+
+  return JPEG_OK;
+} // CJPEGEncoder::TransformMCURowFused()
+
+
 JERRCODE CJPEGEncoder::TransformMCURowEX(
   int16_t* pMCUBuf,
   int     thread_id)
@@ -3425,6 +3725,7 @@ JERRCODE CJPEGEncoder::GenerateHuffmanTablesEX(void)
   CJPEGColorComponent*   curr_comp;
   JERRCODE  jerr;
   int status;
+  bool      fused = IsFusedPipeline();
 
   //m_next_restart_num = 0;
   //m_restarts_to_go   = m_jpeg_restart_interval;
@@ -3441,32 +3742,41 @@ JERRCODE CJPEGEncoder::GenerateHuffmanTablesEX(void)
   for(i = 0; i < m_numyMCU; i++)
   {
     pMCUBuf = m_block_buffer + i * m_numxMCU * m_nblock * DCTSIZE2;
-    if(JD_PIXEL == m_src.order)
-    {
-      jerr = ColorConvert(i, 0, m_numxMCU);
-      if(JPEG_OK != jerr)
-        return jerr;
-      jerr = DownSampling(i, 0, m_numxMCU);
-      if(JPEG_OK != jerr)
-        return jerr;
-    }
-    else // m_src.order == JD_PLANE
+    if(fused)
     {
-      jerr = ProcessBuffer(i, 0, m_numxMCU);
+      jerr = TransformMCURowFused(pMCUBuf, i, 0, m_numxMCU);
       if(JPEG_OK != jerr)
         return jerr;
     }
-
-    if(JPEG_BASELINE == m_jpeg_mode)
-    {
-      jerr = TransformMCURowBL(pMCUBuf, 0, m_numxMCU);
-    }
     else
     {
-      if(m_jpeg_precision > 8)
-        jerr = TransformMCURowEX(pMCUBuf, 0);
-      else
+      if(JD_PIXEL == m_src.order)
+      {
+        jerr = ColorConvert(i, 0, m_numxMCU);
+        if(JPEG_OK != jerr)
+          return jerr;
+        jerr = DownSampling(i, 0, m_numxMCU);
+        if(JPEG_OK != jerr)
+          return jerr;
+      }
+      else // m_src.order == JD_PLANE
+      {
+        jerr = ProcessBuffer(i, 0, m_numxMCU);
+        if(JPEG_OK != jerr)
+          return jerr;
+      }
+
+      if(JPEG_BASELINE == m_jpeg_mode)
+      {
         jerr = TransformMCURowBL(pMCUBuf, 0, m_numxMCU);
+      }
+      else
+      {
+        if(m_jpeg_precision > 8)
+          jerr = TransformMCURowEX(pMCUBuf, 0);
+        else
+          jerr = TransformMCURowBL(pMCUBuf, 0, m_numxMCU);
+      }
     }
 
     if(JPEG_OK != jerr)
@@ -3984,6 +4294,7 @@ JERRCODE CJPEGEncoder::EncodeScanBaseline(void)
     uint32_t  rowMCU, colMCU, maxMCU;
     int     thread_id = 0;
     int16_t* pMCUBuf   = 0;  // the pointer to Buffer for a current thread.
+    bool    fused     = IsFusedPipeline();
 
 
     pMCUBuf = m_block_buffer + thread_id * m_curr_scan.numxMCU * m_nblock * DCTSIZE2;
@@ -4000,33 +4311,67 @@ JERRCODE CJPEGEncoder::EncodeScanBaseline(void)
 
       if(rowMCU < (uint32_t)m_curr_scan.numyMCU)
       {
-        if(m_src.color == m_jpeg_color && JD_PLANE == m_src.order)
+        vm_tick t0 = vm_time_get_tick();
+        vm_tick t1;
+
+        if(fused)
         {
-          jerr = ProcessBuffer(rowMCU, colMCU, maxMCU);
+          jerr = TransformMCURowFused(pMCUBuf, rowMCU, colMCU, maxMCU);
           if(JPEG_OK != jerr)
           {
               return jerr;
           }
+
+          t1 = vm_time_get_tick();
+          m_stageTicks[JES_FUSED] += t1 - t0;
+          t0 = t1;
         }
         else
         {
-          jerr = ColorConvert(rowMCU, colMCU, maxMCU);
-          if(JPEG_OK != jerr)
+          if(m_src.color == m_jpeg_color && JD_PLANE == m_src.order)
           {
-              return jerr;
+            jerr = ProcessBuffer(rowMCU, colMCU, maxMCU);
+            if(JPEG_OK != jerr)
+            {
+                return jerr;
+            }
+
+            t1 = vm_time_get_tick();
+            m_stageTicks[JES_COLOR_CONVERT] += t1 - t0;
+            t0 = t1;
           }
+          else
+          {
+            jerr = ColorConvert(rowMCU, colMCU, maxMCU);
+            if(JPEG_OK != jerr)
+            {
+                return jerr;
+            }
+
+            t1 = vm_time_get_tick();
+            m_stageTicks[JES_COLOR_CONVERT] += t1 - t0;
+            t0 = t1;
 
-          jerr = DownSampling(rowMCU, colMCU, maxMCU);
+            jerr = DownSampling(rowMCU, colMCU, maxMCU);
+            if(JPEG_OK != jerr)
+            {
+                return jerr;
+            }
+
+            t1 = vm_time_get_tick();
+            m_stageTicks[JES_DOWN_SAMPLING] += t1 - t0;
+            t0 = t1;
+          }
+
+          jerr = TransformMCURowBL(pMCUBuf, colMCU, maxMCU);
           if(JPEG_OK != jerr)
           {
               return jerr;
           }
-        }
 
-        jerr = TransformMCURowBL(pMCUBuf, colMCU, maxMCU);
-        if(JPEG_OK != jerr)
-        {
-            return jerr;
+          t1 = vm_time_get_tick();
+          m_stageTicks[JES_DCT] += t1 - t0;
+          t0 = t1;
         }
 
         jerr = EncodeHuffmanMCURowBL(pMCUBuf, colMCU, maxMCU);
@@ -4034,6 +4379,8 @@ JERRCODE CJPEGEncoder::EncodeScanBaseline(void)
         {
             return jerr;
         }
+
+        m_stageTicks[JES_HUFFMAN] += vm_time_get_tick() - t0;
       }
 
       // increment interators
@@ -419,6 +419,30 @@ uint32_t MJPEGVideoEncoder::NumEncodersAllocated(void)
     return static_cast<Ipp32u>(m_enc.size());
 }
 
+void MJPEGVideoEncoder::GetStageTimes(MJPEGEncoderStageTimes* times)
+{
+    vm_tick total[JES_MAX] = {};
+    vm_tick ticks[JES_MAX];
+    double  freq = (double)vm_time_get_frequency() / 1000.0;
+
+    for(size_t i = 0; i < m_enc.size(); i++)
+    {
+        if(!m_enc[i])
+            continue;
+
+        m_enc[i]->GetStageTicks(ticks);
+
+        for(int j = 0; j < JES_MAX; j++)
+            total[j] += ticks[j];
+    }
+
+    times->colorConvert = total[JES_COLOR_CONVERT] / freq;
+    times->downSampling = total[JES_DOWN_SAMPLING] / freq;
+    times->dct          = total[JES_DCT] / freq;
+    times->fused        = total[JES_FUSED] / freq;
+    times->huffman      = total[JES_HUFFMAN] / freq;
+}
+
 uint32_t MJPEGVideoEncoder::NumPicsCollected(void)
 {
     std::lock_guard<std::mutex> guard(m_guard);
@@ -499,6 +523,12 @@ Status MJPEGVideoEncoder::EncodePiece(const mfxU32 threadNumber, const uint32_t
         jdstColor   = JC_YCBCR;
         jss         = JS_422H;
         planar      = true;
+        if(pDataIn->GetColorFormat() == YUY2)
+        {
+            // pixel order Y0 U Y1 V
+            srcChannels = 2;
+            planar      = false;
+        }
         break;
     case MFX_CHROMAFORMAT_YUV422V:
         srcChannels = 3;
@@ -509,7 +539,7 @@ Status MJPEGVideoEncoder::EncodePiece(const mfxU32 threadNumber, const uint32_t
         break;
     case MFX_CHROMAFORMAT_YUV420:
         srcChannels = 3;
-        jsrcColor   = JC_YCBCR;
+        jsrcColor   = (pDataIn->GetColorFormat() == NV12) ? JC_NV12 : JC_YCBCR;
         jdstColor   = JC_YCBCR;
         jss         = JS_420;
         planar      = true;
@@ -84,7 +84,40 @@ namespace UMC_VP9_DECODER
             return bit;
         }
 
-        uint32_t GetBits(uint32_t nbits);
+        // Reads nbits (up to 32) with a single bounds check
+        uint32_t GetBits(uint32_t nbits)
+        {
+            if (!nbits)
+                return 0;
+
+            uint8_t const* end = m_pbsBase + m_maxBsSize;
+            uint32_t const bitPos = m_bitOffset + nbits;      // relative to MSB of *m_pbs
+            uint32_t const bytes  = (bitPos + 7) >> 3;         // 5 bytes at most
+
+            if (m_pbs + bytes > end)
+                throw vp9_exception(UMC::UMC_ERR_NOT_ENOUGH_DATA);
+
+            uint64_t window = 0;
+            if (end - m_pbs >= 8)
+            {
+                // common case - one 8 byte big-endian window
+                for (int i = 0; i < 8; ++i)
+                    window = (window << 8) | m_pbs[i];
+                window <<= m_bitOffset;
+            }
+            else
+            {
+                for (uint32_t i = 0; i < bytes; ++i)
+                    window |= uint64_t(m_pbs[i]) << (56 - 8 * i);
+                window <<= m_bitOffset;
+            }
+
+            m_pbs      += bitPos >> 3;
+            m_bitOffset = bitPos & 7;
+
+            return static_cast<uint32_t>(window >> (64 - nbits));
+        }
+
         uint32_t GetUe();
         int32_t GetSe();
 
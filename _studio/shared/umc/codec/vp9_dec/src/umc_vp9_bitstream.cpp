@@ -63,18 +63,6 @@ void VP9Bitstream::GetOrg(uint8_t **pbs, uint32_t *size)
     *size      = m_maxBsSize; 
 }
 
-uint32_t VP9Bitstream::GetBits(uint32_t nbits)
-{
-    mfxU32 bits = 0;
-    for (; nbits > 0; --nbits)
-    {
-        bits <<= 1;
-        bits |= GetBit();
-    }
-
-    return bits;
-}
-
 uint32_t VP9Bitstream::GetUe()
 {
     uint32_t zeroes = 0;
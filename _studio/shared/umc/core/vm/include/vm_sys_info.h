@@ -32,6 +32,10 @@ extern "C"
 /* Functions to obtain processor's specific information */
 uint32_t vm_sys_info_get_cpu_num(void);
 
+/* Functions to obtain NUMA topology, a system without NUMA has one node 0 */
+uint32_t vm_sys_info_get_numa_node_num(void);
+uint32_t vm_sys_info_get_numa_node_of_cpu(uint32_t cpu);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -22,6 +22,10 @@
 
 #include "vm_sys_info.h"
 #include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
 
 uint32_t vm_sys_info_get_cpu_num(void)
 {
@@ -32,6 +36,56 @@ uint32_t vm_sys_info_get_cpu_num(void)
 #endif
 }
 
+/* returns the number of "node<N>" entries of the sysfs directory, the last N is saved */
+static uint32_t vm_sys_info_find_nodes(const char *path, uint32_t *pNode)
+{
+    DIR *dir = opendir(path);
+    struct dirent *entry;
+    uint32_t num = 0;
+
+    if (!dir)
+        return 0;
+
+    while ((entry = readdir(dir)))
+    {
+        char *end = NULL;
+        unsigned long node;
+
+        if (strncmp(entry->d_name, "node", 4) || !entry->d_name[4])
+            continue;
+
+        node = strtoul(entry->d_name + 4, &end, 10);
+        if (*end)
+            continue;
+
+        if (pNode)
+            *pNode = (uint32_t)node;
+        num++;
+    }
+
+    closedir(dir);
+    return num;
+}
+
+uint32_t vm_sys_info_get_numa_node_num(void)
+{
+    uint32_t num = vm_sys_info_find_nodes("/sys/devices/system/node", NULL);
+
+    return num ? num : 1;
+}
+
+uint32_t vm_sys_info_get_numa_node_of_cpu(uint32_t cpu)
+{
+    char path[64];
+    uint32_t node = 0;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu);
+
+    /* the cpu directory has a link to its node */
+    vm_sys_info_find_nodes(path, &node);
+    return node;
+}
+
 #else
 # pragma warning( disable: 4206 )
 #endif /* LINUX32 */
@@ -0,0 +1,90 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __UMC_VA_NULL_H__
+#define __UMC_VA_NULL_H__
+
+#include "umc_va_base.h"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace UMC
+{
+
+/* NullVideoAccelerator ------------------------------------------------------*/
+
+// Accelerator of the null device: compressed buffers are taken from the heap
+// and dropped, a frame is reported decoded 'latency' after its EndFrame.
+// Surfaces are left untouched, so decoders output whatever they contain.
+class NullVideoAccelerator : public VideoAccelerator
+{
+    DYNAMIC_CAST_DECL(NullVideoAccelerator, VideoAccelerator);
+public:
+    // constructor
+    NullVideoAccelerator(std::chrono::microseconds latency);
+    // destructor
+    virtual ~NullVideoAccelerator(void);
+
+    // VideoAccelerator methods
+    virtual Status Init         (VideoAcceleratorParams* pInfo);
+    virtual Status Close        (void);
+    virtual Status BeginFrame   (int32_t FrameBufIndex);
+    virtual void* GetCompBuffer(int32_t buffer_type, UMCVACompBuffer **buf, int32_t size, int32_t index);
+    virtual Status Execute      (void);
+    virtual Status EndFrame     (void*);
+
+    virtual Status ReleaseBuffer(int32_t /*type*/)
+    { return UMC_OK; };
+
+    virtual Status ExecuteExtensionBuffer(void* /*x*/) { return UMC_ERR_UNSUPPORTED;}
+    virtual Status ExecuteStatusReportBuffer(void* /*x*/, int32_t /*y*/)  { return UMC_ERR_UNSUPPORTED;}
+    virtual Status SyncTask(int32_t index, void * error = NULL);
+    virtual Status QueryTaskStatus(int32_t index, void * status, void * error);
+    virtual bool IsIntelCustomGUID() const { return false;}
+    virtual void GetVideoDecoder(void** /*handle*/) {};
+
+protected:
+    typedef std::chrono::steady_clock::time_point time_point;
+
+    struct CompBuffer
+    {
+        UMCVACompBuffer     desc;
+        std::vector<uint8_t> data;
+        int32_t             index;
+    };
+
+    void ReleaseCompBuffers(void);
+
+    const std::chrono::microseconds m_latency;
+
+    std::mutex m_guard;
+    // buffers of the current frame
+    std::vector<CompBuffer *> m_compBuffers;
+    // index of the current frame, -1 between EndFrame and BeginFrame
+    int32_t m_frameIndex;
+    // completion time of every frame buffer
+    std::vector<time_point> m_due;
+};
+
+}; // namespace UMC
+
+#endif // #ifndef __UMC_VA_NULL_H__
@@ -0,0 +1,204 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <umc_va_base.h>
+
+#include "umc_defs.h"
+#include "umc_va_null.h"
+#include "mfx_trace.h"
+
+#include <thread>
+
+// size of a buffer requested without the size (picture parameters, matrices and so on)
+#define UMC_VA_NULL_DEFAULT_BUFFER_SIZE  (64*1024)
+
+namespace UMC
+{
+
+NullVideoAccelerator::NullVideoAccelerator(std::chrono::microseconds latency)
+    : m_latency(latency)
+    , m_frameIndex(-1)
+{
+}
+
+NullVideoAccelerator::~NullVideoAccelerator(void)
+{
+    Close();
+}
+
+Status NullVideoAccelerator::Init(VideoAcceleratorParams* pInfo)
+{
+    if (NULL == pInfo)
+        return UMC_ERR_NULL_PTR;
+
+    m_allocator = pInfo->m_allocator;
+
+    std::lock_guard<std::mutex> guard(m_guard);
+    // 0 means use default value
+    m_due.assign(pInfo->m_iNumberSurfaces ? pInfo->m_iNumberSurfaces : 64,
+                 std::chrono::steady_clock::now());
+
+    return UMC_OK;
+}
+
+Status NullVideoAccelerator::Close(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        ReleaseCompBuffers();
+        m_due.clear();
+        m_frameIndex = -1;
+    }
+
+    return VideoAccelerator::Close();
+}
+
+Status NullVideoAccelerator::BeginFrame(int32_t FrameBufIndex)
+{
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    if ((FrameBufIndex < 0) || (FrameBufIndex >= (int32_t) m_due.size()))
+        return UMC_ERR_INVALID_PARAMS;
+
+    m_frameIndex = FrameBufIndex;
+
+    return UMC_OK;
+}
+
+void* NullVideoAccelerator::GetCompBuffer(int32_t buffer_type, UMCVACompBuffer **buf, int32_t size, int32_t index)
+{
+    if (NULL != buf) *buf = NULL;
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    CompBuffer *pCompBuf = NULL;
+    for (auto pBuf : m_compBuffers)
+    {
+        if ((pBuf->desc.type == buffer_type) && (pBuf->index == index))
+        {
+            pCompBuf = pBuf;
+            break;
+        }
+    }
+
+    if (NULL == pCompBuf)
+    {
+        pCompBuf = new CompBuffer();
+        pCompBuf->data.resize((size > 0) ? size : UMC_VA_NULL_DEFAULT_BUFFER_SIZE);
+        pCompBuf->desc.type = buffer_type;
+        pCompBuf->desc.SetBufferPointer(pCompBuf->data.data(), pCompBuf->data.size());
+        pCompBuf->index = index;
+
+        m_compBuffers.push_back(pCompBuf);
+    }
+
+    if (NULL != buf) *buf = &pCompBuf->desc;
+
+    return pCompBuf->desc.GetPtr();
+}
+
+Status NullVideoAccelerator::Execute(void)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "NullVideoAccelerator::Execute");
+
+    return UMC_OK;
+}
+
+Status NullVideoAccelerator::EndFrame(void*)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_INTERNAL, "NullVideoAccelerator::EndFrame");
+
+    std::lock_guard<std::mutex> guard(m_guard);
+
+    if (m_frameIndex < 0)
+        return UMC_ERR_FAILED;
+
+    // the frame is 'decoded' the latency after the submission
+    m_due[m_frameIndex] = std::chrono::steady_clock::now() + m_latency;
+    m_frameIndex = -1;
+
+    ReleaseCompBuffers();
+
+    return UMC_OK;
+}
+
+void NullVideoAccelerator::ReleaseCompBuffers(void)
+{
+    //
+    // THE EXECUTION IS ALREADY IN SECURE SECTION.
+    // Just do what need to do.
+    //
+
+    for (auto pBuf : m_compBuffers)
+    {
+        delete pBuf;
+    }
+    m_compBuffers.clear();
+}
+
+Status NullVideoAccelerator::QueryTaskStatus(int32_t FrameBufIndex, void * status, void * error)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "NullVideoAccelerator::QueryTaskStatus");
+
+    time_point due;
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        if ((FrameBufIndex < 0) || (FrameBufIndex >= (int32_t) m_due.size()))
+            return UMC_ERR_INVALID_PARAMS;
+        due = m_due[FrameBufIndex];
+    }
+
+    if (NULL != status)
+    {
+        *(VASurfaceStatus*)status = (std::chrono::steady_clock::now() < due) ?
+            VASurfaceRendering :
+            VASurfaceReady;
+    }
+    if (NULL != error)
+    {
+        *(uint16_t*)error = 0;
+    }
+
+    return UMC_OK;
+}
+
+Status NullVideoAccelerator::SyncTask(int32_t FrameBufIndex, void *surfCorruption)
+{
+    MFX_AUTO_LTRACE(MFX_TRACE_LEVEL_HOTSPOTS, "NullVideoAccelerator::SyncTask");
+
+    time_point due;
+    {
+        std::lock_guard<std::mutex> guard(m_guard);
+
+        if ((FrameBufIndex < 0) || (FrameBufIndex >= (int32_t) m_due.size()))
+            return UMC_ERR_INVALID_PARAMS;
+        due = m_due[FrameBufIndex];
+    }
+
+    std::this_thread::sleep_until(due);
+
+    if (surfCorruption) *(uint16_t*)surfCorruption = 0;
+
+    return UMC_OK;
+}
+
+}; // namespace UMC
@@ -117,6 +117,14 @@ MFX_PACK_END()
 
 typedef struct _mfxSyncPoint *mfxSyncPoint;
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* SyncMode */
+enum {
+    MFX_SYNC_ALL = 0,
+    MFX_SYNC_ANY = 1
+};
+#endif
+
 /* GPUCopy */
 enum {
     MFX_GPUCOPY_DEFAULT = 0,
@@ -152,7 +160,13 @@ typedef struct {
     mfxU16       NumThread;
     mfxI32       SchedulingType;
     mfxI32       Priority;
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    mfxU32       LatencyBudget;
+    mfxU16       SharedPool;
+    mfxU16       reserved[52];
+#else
     mfxU16       reserved[55];
+#endif
 } mfxExtThreadsParam;
 MFX_PACK_END()
 
@@ -203,6 +217,42 @@ typedef struct {
 } mfxPlatform;
 MFX_PACK_END()
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* SchedulerTaskType */
+enum {
+    MFX_SCHEDULER_TASK_HARDWARE = 0,
+    MFX_SCHEDULER_TASK_SOFTWARE = 1
+};
+
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxU32  NumQueued;
+    mfxU32  NumReady;
+    mfxU32  NumRunning;
+    mfxU32  NumWaiting;
+    mfxU32  NumBlocked;
+    mfxU32  NumCompleted;
+    mfxU32  LatencyP50;
+    mfxU32  LatencyP90;
+    mfxU32  LatencyP99;
+    mfxU32  LatencyMax;
+    mfxU32  reserved[6];
+} mfxSchedulerTaskStat;
+MFX_PACK_END()
+
+MFX_PACK_BEGIN_USUAL_STRUCT()
+typedef struct {
+    mfxU32  reserved[16];
+    mfxU32  Period;
+    mfxU32  Load;
+    mfxU16  NumThread;
+    mfxU16  reserved1;
+    mfxU16  ThreadBusy[64];
+    mfxSchedulerTaskStat Task[2];
+} mfxSchedulerStat;
+MFX_PACK_END()
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
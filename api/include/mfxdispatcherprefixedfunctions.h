@@ -142,4 +142,11 @@
 #define MFXVideoCORE_QueryPlatform       disp_MFXVideoCORE_QueryPlatform
 #define MFXVideoUSER_GetPlugin           disp_MFXVideoUSER_GetPlugin
 
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+#define MFXVideoCORE_SyncOperations      disp_MFXVideoCORE_SyncOperations
+#define MFXVideoCORE_GetSchedulerStat    disp_MFXVideoCORE_GetSchedulerStat
+#define MFXVideoENCODE_EncodeFramesAsync disp_MFXVideoENCODE_EncodeFramesAsync
+#define MFXVideoDECODE_DecodeFramesAsync disp_MFXVideoDECODE_DecodeFramesAsync
+#endif
+
 #endif 
\ No newline at end of file
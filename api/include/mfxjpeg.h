@@ -67,6 +67,11 @@ enum {
     MFX_CHROMAFORMAT_JPEG_SAMPLING = 6
 };
 
+/* RestartInterval */
+enum {
+    MFX_JPEG_RESTART_INTERVAL_AUTO = 0xFFFF  /* encoder selects the interval to balance restart intervals across its threads */
+};
+
 MFX_PACK_BEGIN_USUAL_STRUCT()
 typedef struct {
     mfxExtBuffer    Header;
@@ -56,6 +56,10 @@ public:
     virtual mfxStatus QueryPlatform(mfxPlatform* platform) { return MFXVideoCORE_QueryPlatform(m_session, platform); }
 
     virtual mfxStatus SyncOperation(mfxSyncPoint syncp, mfxU32 wait) { return MFXVideoCORE_SyncOperation(m_session, syncp, wait); }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    virtual mfxStatus SyncOperations(mfxSyncPoint *syncp, mfxU32 num_syncp, mfxU16 mode, mfxU32 wait, mfxU32 *index) { return MFXVideoCORE_SyncOperations(m_session, syncp, num_syncp, mode, wait, index); }
+    virtual mfxStatus GetSchedulerStat(mfxSchedulerStat *stat) { return MFXVideoCORE_GetSchedulerStat(m_session, stat); }
+#endif
 
     virtual mfxStatus DoWork() { return MFXDoWork(m_session); }
 
@@ -86,6 +90,9 @@ public:
     virtual mfxStatus GetEncodeStat(mfxEncodeStat *stat) { return MFXVideoENCODE_GetEncodeStat(m_session, stat); }
 
     virtual mfxStatus EncodeFrameAsync(mfxEncodeCtrl *ctrl, mfxFrameSurface1 *surface, mfxBitstream *bs, mfxSyncPoint *syncp) { return MFXVideoENCODE_EncodeFrameAsync(m_session, ctrl, surface, bs, syncp); }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    virtual mfxStatus EncodeFramesAsync(mfxU32 num_frames, mfxEncodeCtrl **ctrl, mfxFrameSurface1 **surface, mfxBitstream **bs, mfxSyncPoint *syncp, mfxU32 *num_submitted) { return MFXVideoENCODE_EncodeFramesAsync(m_session, num_frames, ctrl, surface, bs, syncp, num_submitted); }
+#endif
 
 protected:
 
@@ -112,6 +119,9 @@ public:
     virtual mfxStatus GetPayload(mfxU64 *ts, mfxPayload *payload) {return MFXVideoDECODE_GetPayload(m_session, ts, payload); }
     virtual mfxStatus SetSkipMode(mfxSkipMode mode) { return MFXVideoDECODE_SetSkipMode(m_session, mode); }
     virtual mfxStatus DecodeFrameAsync(mfxBitstream *bs, mfxFrameSurface1 *surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp) { return MFXVideoDECODE_DecodeFrameAsync(m_session, bs, surface_work, surface_out, syncp); }
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    virtual mfxStatus DecodeFramesAsync(mfxBitstream *bs, mfxU32 num_frames, mfxFrameSurface1 **surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp, mfxU32 *num_output) { return MFXVideoDECODE_DecodeFramesAsync(m_session, bs, num_frames, surface_work, surface_out, syncp, num_output); }
+#endif
 
 protected:
 
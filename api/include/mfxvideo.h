@@ -59,6 +59,10 @@ mfxStatus MFX_CDECL MFXVideoCORE_SetHandle(mfxSession session, mfxHandleType typ
 mfxStatus MFX_CDECL MFXVideoCORE_GetHandle(mfxSession session, mfxHandleType type, mfxHDL *hdl);
 mfxStatus MFX_CDECL MFXVideoCORE_QueryPlatform(mfxSession session, mfxPlatform* platform);
 mfxStatus MFX_CDECL MFXVideoCORE_SyncOperation(mfxSession session, mfxSyncPoint syncp, mfxU32 wait);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+mfxStatus MFX_CDECL MFXVideoCORE_SyncOperations(mfxSession session, mfxSyncPoint *syncp, mfxU32 num_syncp, mfxU16 mode, mfxU32 wait, mfxU32 *index);
+mfxStatus MFX_CDECL MFXVideoCORE_GetSchedulerStat(mfxSession session, mfxSchedulerStat *stat);
+#endif
 
 /* VideoENCODE */
 mfxStatus MFX_CDECL MFXVideoENCODE_Query(mfxSession session, mfxVideoParam *in, mfxVideoParam *out);
@@ -70,6 +74,12 @@ mfxStatus MFX_CDECL MFXVideoENCODE_Close(mfxSession session);
 mfxStatus MFX_CDECL MFXVideoENCODE_GetVideoParam(mfxSession session, mfxVideoParam *par);
 mfxStatus MFX_CDECL MFXVideoENCODE_GetEncodeStat(mfxSession session, mfxEncodeStat *stat);
 mfxStatus MFX_CDECL MFXVideoENCODE_EncodeFrameAsync(mfxSession session, mfxEncodeCtrl *ctrl, mfxFrameSurface1 *surface, mfxBitstream *bs, mfxSyncPoint *syncp);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* The frames are checked and submitted one by one. On return the first *num_submitted frames are in
+   flight, syncp[i] is set for those of them which produce a bitstream. The frame after them is not taken
+   by the encoder, its status is returned; the rest of the frames are not touched. */
+mfxStatus MFX_CDECL MFXVideoENCODE_EncodeFramesAsync(mfxSession session, mfxU32 num_frames, mfxEncodeCtrl **ctrl, mfxFrameSurface1 **surface, mfxBitstream **bs, mfxSyncPoint *syncp, mfxU32 *num_submitted);
+#endif
 
 /* VideoDECODE */
 mfxStatus MFX_CDECL MFXVideoDECODE_Query(mfxSession session, mfxVideoParam *in, mfxVideoParam *out);
@@ -84,6 +94,13 @@ mfxStatus MFX_CDECL MFXVideoDECODE_GetDecodeStat(mfxSession session, mfxDecodeSt
 mfxStatus MFX_CDECL MFXVideoDECODE_SetSkipMode(mfxSession session, mfxSkipMode mode);
 mfxStatus MFX_CDECL MFXVideoDECODE_GetPayload(mfxSession session, mfxU64 *ts, mfxPayload *payload);
 mfxStatus MFX_CDECL MFXVideoDECODE_DecodeFrameAsync(mfxSession session, mfxBitstream *bs, mfxFrameSurface1 *surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp);
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+/* The frames are checked and submitted one by one, every check takes the next surface_work. On return
+   surface_out and syncp hold *num_output decoded frames in flight. Decoding stops at the first frame
+   which is not submitted or returns a warning, its status is returned; the rest of the surfaces are
+   not touched. */
+mfxStatus MFX_CDECL MFXVideoDECODE_DecodeFramesAsync(mfxSession session, mfxBitstream *bs, mfxU32 num_frames, mfxFrameSurface1 **surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp, mfxU32 *num_output);
+#endif
 
 /* VideoVPP */
 mfxStatus MFX_CDECL MFXVideoVPP_Query(mfxSession session, mfxVideoParam *in, mfxVideoParam *out);
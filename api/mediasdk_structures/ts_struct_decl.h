@@ -1083,6 +1083,10 @@ STRUCT(mfxExtThreadsParam,
     FIELD_T(mfxU16      , NumThread     )
     FIELD_T(mfxI32      , SchedulingType)
     FIELD_T(mfxI32      , Priority      )
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+    FIELD_T(mfxU32      , LatencyBudget )
+    FIELD_T(mfxU16      , SharedPool    )
+#endif
 )
 
 STRUCT(mfxExtVPPFieldProcessing,
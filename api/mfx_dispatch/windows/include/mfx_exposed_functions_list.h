@@ -138,4 +138,17 @@ FUNCTION(mfxStatus, MFXVideoPAK_GetVideoParam, (mfxSession session, mfxVideoPara
 FUNCTION(mfxStatus, MFXVideoCORE_QueryPlatform, (mfxSession session, mfxPlatform* platform), (session, platform))
 FUNCTION(mfxStatus, MFXVideoUSER_GetPlugin, (mfxSession session, mfxU32 type, mfxPlugin *par), (session, type, par))
 
-#undef API_VERSION
\ No newline at end of file
+#undef API_VERSION
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+
+#define API_VERSION {{34, 1}}
+
+FUNCTION(mfxStatus, MFXVideoCORE_SyncOperations, (mfxSession session, mfxSyncPoint *syncp, mfxU32 num_syncp, mfxU16 mode, mfxU32 wait, mfxU32 *index), (session, syncp, num_syncp, mode, wait, index))
+FUNCTION(mfxStatus, MFXVideoCORE_GetSchedulerStat, (mfxSession session, mfxSchedulerStat *stat), (session, stat))
+FUNCTION(mfxStatus, MFXVideoENCODE_EncodeFramesAsync, (mfxSession session, mfxU32 num_frames, mfxEncodeCtrl **ctrl, mfxFrameSurface1 **surface, mfxBitstream **bs, mfxSyncPoint *syncp, mfxU32 *num_submitted), (session, num_frames, ctrl, surface, bs, syncp, num_submitted))
+FUNCTION(mfxStatus, MFXVideoDECODE_DecodeFramesAsync, (mfxSession session, mfxBitstream *bs, mfxU32 num_frames, mfxFrameSurface1 **surface_work, mfxFrameSurface1 **surface_out, mfxSyncPoint *syncp, mfxU32 *num_output), (session, bs, num_frames, surface_work, surface_out, syncp, num_output))
+
+#undef API_VERSION
+
+#endif
@@ -1268,6 +1268,41 @@ IPPAPI(IppStatus,mfxiRGBToYCbCr_JPEG_8u_C4P3R,(
         IppiSize roiSize))
 
 
+/* ///////////////////////////////////////////////////////////////////////////
+//  Name:
+//    mfxiBGRToYCbCr_JPEG_8u_C4P3R
+//
+//  Purpose:
+//    BGRA to YCbCr color conversion (ignore alpha channel)
+//
+//  Parameter:
+//    pSrcBGRA  pointer to input data BGRABGRA..BGRABGRA
+//    srcStep   line offset in input data
+//    pDstYCbCr pointer to pointers to the output data.
+//                pDstYCbCr[0] is pointer to YY..YY plane
+//                pDstYCbCr[1] is pointer to CbCb..CbCb plane, and
+//                pDstYCbCr[2] is pointer to CrCr..CrCr plane
+//    dstStep   line offset in output data
+//    roiSize   ROI size
+//
+//  Returns:
+//    IppStatus
+//
+//  Notes:
+//    Y  =  0.29900*R + 0.58700*G + 0.11400*B
+//    Cb = -0.16874*R - 0.33126*G + 0.50000*B + 128
+//    Cr =  0.50000*R - 0.41869*G - 0.08131*B + 128
+//    Intel AVX2 code is used when the CPU supports it
+*/
+
+IPPAPI(IppStatus,mfxiBGRToYCbCr_JPEG_8u_C4P3R,(
+  const Ipp8u*   pBGRA,
+        int      srcStep,
+        Ipp8u*   pYCbCr[3],
+        int      dstStep,
+        IppiSize roiSize))
+
+
 /* ///////////////////////////////////////////////////////////////////////////
 //  Name:
 //    mfxiCMYKToYCCK_JPEG_8u_C4P4R
@@ -71,5 +71,24 @@
     IPP_BAD_SIZE_RET(roiSize.height)
 
 
+/* ---------------------- RGBA/BGRA to YCbCr ------------------------------ */
+
+/*
+    Coefficients of mfxiBGRToYCbCr_JPEG_8u_C4P3R scaled by 32768 to fit 16-bit
+    multipliers of vpmaddwd, the scalar and the AVX2 code round the same way.
+    mfxiRGBToYCbCr_JPEG_8u_C4P3R keeps the coefficients of its SSE code
+*/
+#define kYR   9798
+#define kYG  19235
+#define kYB   3736
+#define kUR  -5529
+#define kUG -10855
+#define kUB  16384
+#define kVR  16384
+#define kVG -13720
+#define kVB  -2664
+
+#define ROUND_Y  (1 << 14)
+#define ROUND_C  ((128 << 15) + (1 << 14))
 
 #endif /* __PJENCCC_H__ */
@@ -0,0 +1,130 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/*M*
+//
+//     Purpose : IPPI Color Space Conversion, Intel AVX2 code
+//
+//     This file is compiled with -mavx2, functions may only be called
+//     after the caller has checked the CPU for AVX2 support.
+//
+*M*/
+
+#include "precomp.h"
+#include <immintrin.h>
+#include "ownj.h"
+#include "pjenccc.h"
+
+#if ( _IPP32E >= _IPP32E_Y8 )
+
+#define CLIP8(x) ((x < 0) ? 0 : ((x > 255) ? 255 : x))
+
+/* 4 x 16-bit coefficients in channel order of one pixel, alpha is multiplied by 0 */
+static __inline __m256i ownCoef( int c0, int c1, int c2 )
+{
+    return _mm256_set1_epi64x( (long long)(
+        ((Ipp64u)(Ipp16u)c2 << 32) | ((Ipp64u)(Ipp16u)c1 << 16) | (Ipp64u)(Ipp16u)c0 ));
+}
+
+/*
+    lo - pixels 0,1 | 4,5, hi - pixels 2,3 | 6,7 of 8 pixels widened to 16 bits,
+    returns 8 results in pixel order, 4 per 128-bit lane
+*/
+static __inline __m256i ownDot( __m256i lo, __m256i hi, __m256i k, __m256i rnd )
+{
+    __m256i s = _mm256_hadd_epi32( _mm256_madd_epi16( lo, k ), _mm256_madd_epi16( hi, k ) );
+    return _mm256_srai_epi32( _mm256_add_epi32( s, rnd ), 15 );
+}
+
+/* packs 4 vectors produced by ownDot (32 pixels) into bytes in pixel order */
+static __inline __m256i ownPack( __m256i v0, __m256i v1, __m256i v2, __m256i v3 )
+{
+    const __m256i perm = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+    __m256i t = _mm256_packus_epi16( _mm256_packs_epi32( v0, v1 ), _mm256_packs_epi32( v2, v3 ) );
+    return _mm256_permutevar8x32_epi32( t, perm );
+}
+
+/*
+    Lib = Y8 with AVX2 dispatch
+    Caller = mfxiBGRToYCbCr_JPEG_8u_C4P3R,
+             bit exact with mfxownBGRToYCbCr_JPEG_8u_C4P3R
+*/
+extern void mfxownBGRToYCbCr_JPEG_8u_C4P3R_l9(
+    const Ipp8u* pSrc, int srcStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize)
+{
+    int h, w;
+    int width   = roiSize.width;
+    int width32 = roiSize.width & ~0x1f;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rndY = _mm256_set1_epi32( ROUND_Y );
+    const __m256i rndC = _mm256_set1_epi32( ROUND_C );
+    const __m256i kY   = ownCoef( kYB, kYG, kYR );
+    const __m256i kU   = ownCoef( kUB, kUG, kUR );
+    const __m256i kV   = ownCoef( kVB, kVG, kVR );
+
+    for( h = 0; h < roiSize.height; h++ )
+    {
+        const Ipp8u* src  = pSrc    + h * srcStep;
+        Ipp8u*       dsty = pYCC[0] + h * yccStep;
+        Ipp8u*       dstu = pYCC[1] + h * yccStep;
+        Ipp8u*       dstv = pYCC[2] + h * yccStep;
+
+        for( w = 0; w < width32; w += 32 )
+        {
+            __m256i lo[4], hi[4], y[4], u[4], v[4];
+            int i;
+
+            for( i = 0; i < 4; i++ )
+            {
+                __m256i t = _mm256_loadu_si256( (const __m256i*)(src + 4 * w + 32 * i) );
+                lo[i] = _mm256_unpacklo_epi8( t, zero );
+                hi[i] = _mm256_unpackhi_epi8( t, zero );
+
+                y[i] = ownDot( lo[i], hi[i], kY, rndY );
+                u[i] = ownDot( lo[i], hi[i], kU, rndC );
+                v[i] = ownDot( lo[i], hi[i], kV, rndC );
+            }
+
+            _mm256_storeu_si256( (__m256i*)(dsty + w), ownPack( y[0], y[1], y[2], y[3] ) );
+            _mm256_storeu_si256( (__m256i*)(dstu + w), ownPack( u[0], u[1], u[2], u[3] ) );
+            _mm256_storeu_si256( (__m256i*)(dstv + w), ownPack( v[0], v[1], v[2], v[3] ) );
+        }
+
+        for( ; w < width; w++ )
+        {
+            int b = src[4 * w + 0];
+            int g = src[4 * w + 1];
+            int r = src[4 * w + 2];
+            int t;
+
+            t = ( kYR * r + kYG * g + kYB * b + ROUND_Y ) >> 15;
+            dsty[w] = (Ipp8u)CLIP8( t );
+            t = ( kUR * r + kUG * g + kUB * b + ROUND_C ) >> 15;
+            dstu[w] = (Ipp8u)CLIP8( t );
+            t = ( kVR * r + kVG * g + kVB * b + ROUND_C ) >> 15;
+            dstv[w] = (Ipp8u)CLIP8( t );
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+#endif
@@ -24,6 +24,8 @@
 //    Color conversions functions, back/forward transform
 //
 //  Contents:
+//    mfxiRGBToYCbCr_JPEG_8u_C4P3R
+//    mfxiBGRToYCbCr_JPEG_8u_C4P3R
 //    mfxiYCbCrToBGR_JPEG_8u_P3C4R
 //
 */
@@ -33,6 +35,9 @@
 #ifndef __OWNJ_H__
 #include "ownj.h"
 #endif
+#ifndef __PJENCCC_H__
+#include "pjenccc.h"
+#endif
 #define CLIP(x) ((x < 0) ? 0 : ((x > 255) ? 255 : x))
 
 #if ( _IPP >= _IPP_V8 )||( _IPP32E >= _IPP32E_U8 )
@@ -41,6 +46,19 @@ const Ipp8u* pBGR, int bgrStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize);
 extern void mfxownYCbCrToBGR_JPEG_8u_P3C4R(
 const Ipp8u* pYCC[3],int yccStep,Ipp8u* pBGR,int bgrStep,IppiSize roiSize, Ipp8u aval,int orger);
 #endif
+#if ( _IPP32E >= _IPP32E_Y8 )
+/* pjencccl9.c, compiled for AVX2 */
+extern void mfxownBGRToYCbCr_JPEG_8u_C4P3R_l9(
+const Ipp8u* pBGRA, int bgraStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize);
+
+static int ownHaveAVX2( void )
+{
+  static int avx2 = -1;
+  if( avx2 < 0 )
+    avx2 = __builtin_cpu_supports("avx2") > 0;
+  return avx2;
+}
+#endif
 #define kRCr 0x000166e8
 #define kGCr 0x0000b6d1
 #define kGCb 0x00005819
@@ -50,6 +68,36 @@ const Ipp8u* pYCC[3],int yccStep,Ipp8u* pBGR,int bgrStep,IppiSize roiSize, Ipp8u
 #define kB   0x00e2d002
 
 
+/*
+    Reference code of mfxiBGRToYCbCr_JPEG_8u_C4P3R,
+    the AVX2 code gives the same result
+*/
+extern void mfxownBGRToYCbCr_JPEG_8u_C4P3R(
+const Ipp8u* pBGRA, int bgraStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize)
+{
+  int h,w;
+  for( h = 0; h < roiSize.height; h ++ )
+  {
+     const Ipp8u* src  = pBGRA   + h * bgraStep;
+     Ipp8u*       dsty = pYCC[0] + h * yccStep;
+     Ipp8u*       dstu = pYCC[1] + h * yccStep;
+     Ipp8u*       dstv = pYCC[2] + h * yccStep;
+     for( w = 0; w < roiSize.width; w ++ )
+     {
+        int r, g, b, t;
+        b = src[0]; g = src[1]; r = src[2];
+        src += 4;
+        t = ( kYR * r + kYG * g + kYB * b + ROUND_Y ) >> 15;
+        *dsty++ = ( Ipp8u )CLIP( t );
+        t = ( kUR * r + kUG * g + kUB * b + ROUND_C ) >> 15;
+        *dstu++ = ( Ipp8u )CLIP( t );
+        t = ( kVR * r + kVG * g + kVB * b + ROUND_C ) >> 15;
+        *dstv++ = ( Ipp8u )CLIP( t );
+     }
+  }
+}
+
+
 /* ---------------------- library functions definitions -------------------- */
 
 IPPFUN(IppStatus, mfxiRGBToYCbCr_JPEG_8u_C4P3R,(
@@ -92,6 +140,24 @@ const Ipp8u* pBGR, int bgrStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize))
   return ippStsNoErr;
 }
 
+IPPFUN(IppStatus, mfxiBGRToYCbCr_JPEG_8u_C4P3R,(
+const Ipp8u* pBGRA, int bgraStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize))
+{
+  IPP_BAD_PTR2_RET( pBGRA, pYCC );
+  IPP_BAD_PTR3_RET( pYCC[0], pYCC[1], pYCC[2]);
+  IPP_BADARG_RET((roiSize.width < 2 || roiSize.height < 1), ippStsSizeErr);
+  IPP_BADARG_RET(( bgraStep == 0 || yccStep == 0), ippStsStepErr);
+#if ( _IPP32E >= _IPP32E_Y8 )
+  if( ownHaveAVX2() )
+  {
+    mfxownBGRToYCbCr_JPEG_8u_C4P3R_l9( pBGRA, bgraStep, pYCC, yccStep, roiSize );
+    return ippStsNoErr;
+  }
+#endif
+  mfxownBGRToYCbCr_JPEG_8u_C4P3R( pBGRA, bgraStep, pYCC, yccStep, roiSize );
+  return ippStsNoErr;
+}
+
 IPPFUN(IppStatus,mfxiYCbCrToBGR_JPEG_8u_P3C4R,(
 const Ipp8u* pYCC[3],int yccStep,Ipp8u* pBGR,int bgrStep,IppiSize roiSize, Ipp8u aval))
 {
@@ -850,6 +850,8 @@ public :
     virtual void      Close();
     virtual mfxStatus Init(const msdk_char *strFileName);
     virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
+    // moves read position to the given byte offset, e.g. StreamIndexEntry::Offset
+    virtual mfxStatus Seek(mfxU64 offset);
 
 protected:
     FILE*     m_fSource;
@@ -866,6 +868,7 @@ public:
     virtual void      Close();
     virtual mfxStatus Init(const msdk_char *strFileName);
     virtual mfxStatus ReadNextFrame(mfxBitstream *pBS);
+    virtual mfxStatus Seek(mfxU64 offset);
 
 private:
     mfxBitstream *m_processedBS;
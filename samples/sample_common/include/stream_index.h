@@ -0,0 +1,109 @@
+/******************************************************************************\
+Copyright (c) 2005-2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#ifndef __STREAM_INDEX_H__
+#define __STREAM_INDEX_H__
+
+#include <vector>
+
+#include "mfxstructures.h"
+#include "vm/strings_defs.h"
+
+// Access unit index produced by tools/stream_indexer.
+//
+// File layout (little endian): StreamIndexHeader followed by NumEntries
+// StreamIndexEntry records in decode order.
+
+enum
+{
+    STREAM_INDEX_VERSION = 1
+};
+
+// StreamIndexEntry::Flags
+enum
+{
+    STREAM_INDEX_RAP   = 0x01, // decoding can start here (IRAP / I-picture after sequence header / key frame)
+    STREAM_INDEX_IDR   = 0x02, // nothing before this entry is referenced (IDR / closed GOP / key frame)
+    STREAM_INDEX_SHOWN = 0x04  // produces an output frame (HEVC pic_output_flag, VP8/VP9/AV1 show flags)
+};
+
+#pragma pack(push, 1)
+struct StreamIndexHeader
+{
+    mfxU32 Magic;       // 'MSIX'
+    mfxU16 Version;
+    mfxU16 EntrySize;   // sizeof(StreamIndexEntry)
+    mfxU32 CodecId;     // MFX_CODEC_*
+    mfxU32 reserved;
+    mfxU64 NumEntries;
+    mfxU64 StreamSize;  // size of the indexed file, used to detect a stale index
+};
+
+struct StreamIndexEntry
+{
+    mfxU64 Offset;      // first byte of the access unit: start code or IVF frame header
+    mfxI32 Order;       // display order: POC, GOP based temporal reference or IVF frame number
+    mfxU8  FrameType;   // MFX_FRAMETYPE_I/P/B
+    mfxU8  Flags;       // STREAM_INDEX_*
+    mfxU8  SeqId;       // active SPS id, 0 where a codec has no such notion
+    mfxU8  reserved;
+};
+#pragma pack(pop)
+
+// Byte range of the stream that can be decoded independently
+struct StreamIndexChunk
+{
+    mfxU64 Begin;
+    mfxU64 End;         // exclusive, 0 - up to the end of the stream
+    mfxU32 FirstEntry;
+    mfxU32 NumEntries;
+};
+
+class CStreamIndex
+{
+public:
+    CStreamIndex();
+
+    void      Reset(mfxU32 codecId, mfxU64 streamSize);
+    void      Add(const StreamIndexEntry& entry) { m_entries.push_back(entry); }
+
+    mfxStatus Load(const msdk_char *strFileName);
+    mfxStatus Save(const msdk_char *strFileName) const;
+
+    mfxU32    GetCodecId() const    { return m_codecId; }
+    mfxU64    GetStreamSize() const { return m_streamSize; }
+    mfxU32    GetCount() const      { return (mfxU32)m_entries.size(); }
+
+    const StreamIndexEntry& operator[](mfxU32 idx) const { return m_entries[idx]; }
+
+    // Returns index of the last entry at or before 'entry' having all of 'flags' set,
+    // -1 if there is no such entry
+    mfxI32    FindRAP(mfxU32 entry, mfxU8 flags = STREAM_INDEX_RAP) const;
+
+    // Splits the stream into at most numChunks ranges starting at IDR entries
+    // (closed GOPs), so every range can be transcoded by a separate session.
+    mfxStatus GetChunks(mfxU32 numChunks, std::vector<StreamIndexChunk>& chunks) const;
+
+protected:
+    mfxU32                        m_codecId;
+    mfxU64                        m_streamSize;
+    std::vector<StreamIndexEntry> m_entries;
+};
+
+#endif //__STREAM_INDEX_H__
@@ -693,6 +693,17 @@ mfxStatus CSmplBitstreamReader::ReadNextFrame(mfxBitstream *pBS)
     return MFX_ERR_NONE;
 }
 
+mfxStatus CSmplBitstreamReader::Seek(mfxU64 offset)
+{
+    if (!m_bInited)
+        return MFX_ERR_NOT_INITIALIZED;
+
+    clearerr(m_fSource);
+    MSDK_CHECK_NOT_EQUAL(MSDK_FSEEK64(m_fSource, offset, SEEK_SET), 0, MFX_ERR_UNSUPPORTED);
+
+    return MFX_ERR_NONE;
+}
+
 
 mfxU32 CJPEGFrameReader::FindMarker(mfxBitstream *pBS,mfxU32 startOffset,CJPEGFrameReader::JPEGMarker marker)
 {
@@ -2490,6 +2501,22 @@ mfxStatus CH264FrameReader::Init(const msdk_char *strFileName)
     return sts;
 }
 
+mfxStatus CH264FrameReader::Seek(mfxU64 offset)
+{
+    mfxStatus sts = CSmplBitstreamReader::Seek(offset);
+    MSDK_CHECK_STATUS(sts, "CSmplBitstreamReader::Seek failed");
+
+    // drop data buffered from the old position
+    m_originalBS.DataOffset = 0;
+    m_originalBS.DataLength = 0;
+    m_isEndOfStream = false;
+    m_processedBS = NULL;
+    m_frame = 0;
+    m_pNALSplitter->Reset();
+
+    return MFX_ERR_NONE;
+}
+
 mfxStatus CH264FrameReader::ReadNextFrame(mfxBitstream *pBS)
 {
     mfxStatus sts = MFX_ERR_NONE;
@@ -0,0 +1,154 @@
+/******************************************************************************\
+Copyright (c) 2005-2020, Intel Corporation
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This sample was distributed or derived from the Intel's Media Samples package.
+The original version of this sample may be obtained from https://software.intel.com/en-us/intel-media-server-studio
+or https://software.intel.com/en-us/media-client-solutions-support.
+\**********************************************************************************/
+
+#include <algorithm>
+
+#include "stream_index.h"
+#include "sample_defs.h"
+#include "vm/file_defs.h"
+
+#define STREAM_INDEX_MAGIC MFX_MAKEFOURCC('M','S','I','X')
+
+CStreamIndex::CStreamIndex()
+    : m_codecId(0)
+    , m_streamSize(0)
+{
+}
+
+void CStreamIndex::Reset(mfxU32 codecId, mfxU64 streamSize)
+{
+    m_codecId    = codecId;
+    m_streamSize = streamSize;
+    m_entries.clear();
+}
+
+mfxStatus CStreamIndex::Load(const msdk_char *strFileName)
+{
+    MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
+
+    FILE *f = NULL;
+    MSDK_FOPEN(f, strFileName, MSDK_STRING("rb"));
+    MSDK_CHECK_POINTER(f, MFX_ERR_NULL_PTR);
+
+    StreamIndexHeader hdr = {};
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1
+        && hdr.Magic == STREAM_INDEX_MAGIC
+        && hdr.Version == STREAM_INDEX_VERSION
+        && hdr.EntrySize == sizeof(StreamIndexEntry);
+
+    if (ok)
+    {
+        Reset(hdr.CodecId, hdr.StreamSize);
+        m_entries.resize((size_t)hdr.NumEntries);
+        ok = m_entries.empty() || fread(m_entries.data(), sizeof(StreamIndexEntry), m_entries.size(), f) == m_entries.size();
+    }
+
+    fclose(f);
+
+    if (!ok)
+    {
+        Reset(0, 0);
+        msdk_printf(MSDK_STRING("ERROR: %s is not a valid stream index\n"), strFileName);
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    return MFX_ERR_NONE;
+}
+
+mfxStatus CStreamIndex::Save(const msdk_char *strFileName) const
+{
+    MSDK_CHECK_POINTER(strFileName, MFX_ERR_NULL_PTR);
+
+    FILE *f = NULL;
+    MSDK_FOPEN(f, strFileName, MSDK_STRING("wb"));
+    MSDK_CHECK_POINTER(f, MFX_ERR_NULL_PTR);
+
+    StreamIndexHeader hdr = {};
+    hdr.Magic      = STREAM_INDEX_MAGIC;
+    hdr.Version    = STREAM_INDEX_VERSION;
+    hdr.EntrySize  = sizeof(StreamIndexEntry);
+    hdr.CodecId    = m_codecId;
+    hdr.NumEntries = m_entries.size();
+    hdr.StreamSize = m_streamSize;
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1
+        && (m_entries.empty() || fwrite(m_entries.data(), sizeof(StreamIndexEntry), m_entries.size(), f) == m_entries.size());
+
+    ok = (fclose(f) == 0) && ok;
+
+    return ok ? MFX_ERR_NONE : MFX_ERR_DEVICE_FAILED;
+}
+
+mfxI32 CStreamIndex::FindRAP(mfxU32 entry, mfxU8 flags) const
+{
+    if (m_entries.empty())
+        return -1;
+
+    mfxI32 i = (mfxI32)std::min<size_t>(entry, m_entries.size() - 1);
+    for (; i >= 0; i--)
+    {
+        if ((m_entries[i].Flags & flags) == flags)
+            break;
+    }
+
+    return i;
+}
+
+mfxStatus CStreamIndex::GetChunks(mfxU32 numChunks, std::vector<StreamIndexChunk>& chunks) const
+{
+    chunks.clear();
+
+    if (!numChunks)
+        return MFX_ERR_INVALID_VIDEO_PARAM;
+
+    const mfxU32 count = GetCount();
+    if (!count)
+        return MFX_ERR_NOT_FOUND;
+
+    // chunk starts: the first IDR entry at or after every 1/numChunks of the stream
+    std::vector<mfxU32> starts(1, 0);
+    for (mfxU32 c = 1; c < numChunks; c++)
+    {
+        mfxU32 i = (mfxU32)((mfxU64)count * c / numChunks);
+        i = std::max(i, starts.back() + 1);
+
+        while (i < count && !(m_entries[i].Flags & STREAM_INDEX_IDR))
+            i++;
+
+        if (i >= count)
+            break;
+
+        starts.push_back(i);
+    }
+
+    for (size_t c = 0; c < starts.size(); c++)
+    {
+        const bool last = (c + 1 == starts.size());
+
+        StreamIndexChunk chunk = {};
+        chunk.FirstEntry = starts[c];
+        chunk.NumEntries = (last ? count : starts[c + 1]) - starts[c];
+        chunk.Begin      = c ? m_entries[starts[c]].Offset : 0;
+        chunk.End        = last ? 0 : m_entries[starts[c + 1]].Offset;
+
+        chunks.push_back(chunk);
+    }
+
+    return MFX_ERR_NONE;
+}
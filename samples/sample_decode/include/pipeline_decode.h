@@ -35,6 +35,7 @@ or https://software.intel.com/en-us/media-client-solutions-support.
 #include <memory>
 
 #include "sample_utils.h"
+#include "stream_index.h"
 #include "base_allocator.h"
 
 #include "mfxmvc.h"
@@ -111,6 +112,7 @@ struct sInputParams
     mfxU32  fourcc;
     mfxU16  chromaType;
     mfxU32  nFrames;
+    mfxU32  nSeekFrame; // decode order number of the frame to start from, see strIndexFile
     mfxU16  eDeinterlace;
     bool    outI420;
 
@@ -137,6 +139,7 @@ struct sInputParams
 
     msdk_char     strSrcFile[MSDK_MAX_FILENAME_LEN];
     msdk_char     strDstFile[MSDK_MAX_FILENAME_LEN];
+    msdk_char     strIndexFile[MSDK_MAX_FILENAME_LEN];
     sPluginParams pluginParams;
 
 };
@@ -216,6 +219,7 @@ protected: // functions
     mfxStatus GetImpl(const sInputParams & params, mfxIMPL & impl);
     virtual mfxStatus CreateRenderingWindow(sInputParams *pParams);
     virtual mfxStatus InitMfxParams(sInputParams *pParams);
+    virtual mfxStatus SeekToFrame(sInputParams *pParams);
 
     virtual mfxStatus AllocateExtMVCBuffers();
 
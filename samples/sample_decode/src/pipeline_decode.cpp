@@ -529,6 +529,12 @@ mfxStatus CDecodingPipeline::Init(sInputParams *pParams)
         MSDK_CHECK_STATUS(sts, "Plugin load failed");
     }
 
+    if (msdk_strlen(pParams->strIndexFile))
+    {
+        sts = SeekToFrame(pParams);
+        MSDK_CHECK_STATUS(sts, "SeekToFrame failed");
+    }
+
     // Populate parameters. Involves DecodeHeader call
     sts = InitMfxParams(pParams);
     MSDK_CHECK_STATUS(sts, "InitMfxParams failed");
@@ -695,6 +701,33 @@ mfxStatus CDecodingPipeline::CreateRenderingWindow(sInputParams *pParams)
     return sts;
 }
 
+mfxStatus CDecodingPipeline::SeekToFrame(sInputParams *pParams)
+{
+    MSDK_CHECK_POINTER(pParams, MFX_ERR_NULL_PTR);
+
+    CStreamIndex index;
+    mfxStatus sts = index.Load(pParams->strIndexFile);
+    MSDK_CHECK_STATUS(sts, "index.Load failed");
+
+    if (index.GetCodecId() != pParams->videoType)
+    {
+        msdk_printf(MSDK_STRING("ERROR: index was built for another codec\n"));
+        return MFX_ERR_UNSUPPORTED;
+    }
+
+    mfxI32 rap = index.FindRAP(pParams->nSeekFrame);
+    if (rap < 0)
+    {
+        msdk_printf(MSDK_STRING("ERROR: no random access point before frame %u\n"), pParams->nSeekFrame);
+        return MFX_ERR_NOT_FOUND;
+    }
+
+    if ((mfxU32)rap != pParams->nSeekFrame)
+        msdk_printf(MSDK_STRING("Frame %u is not a random access point, decoding starts from frame %d\n"), pParams->nSeekFrame, rap);
+
+    return m_FileReader->Seek(index[rap].Offset);
+}
+
 mfxStatus CDecodingPipeline::InitMfxParams(sInputParams *pParams)
 {
     MSDK_CHECK_POINTER(m_pmfxDEC, MFX_ERR_NULL_PTR);
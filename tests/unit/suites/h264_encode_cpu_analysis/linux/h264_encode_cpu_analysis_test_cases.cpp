@@ -0,0 +1,199 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <utility>
+
+#include <poll.h>
+
+#include "mfx_h264_encode_cpu_analysis.h"
+#include "mfx_h264_encode_cpu_pool.h"
+
+using namespace MfxHwH264Encode;
+
+// Expected values follow the HistogramSLMFrame/HistogramSLMFields kernels
+// (genx_histogram.cpp) and from Calc_RaCa_pic_C of ASC for the frames below.
+
+namespace
+{
+    enum
+    {
+        SURF_WIDTH  = 200,
+        SURF_HEIGHT = 72,
+        PITCH       = 224
+    };
+
+    enum Content
+    {
+        LEVELS,     // 16 levels, a few bins of the histogram are used
+        NOISE       // gradient with noise for RaCa
+    };
+
+    std::vector<mfxU8> MakeFrame(Content content)
+    {
+        std::vector<mfxU8> frame(PITCH * SURF_HEIGHT);
+
+        for (mfxU32 y = 0; y < SURF_HEIGHT; y++)
+        {
+            for (mfxU32 x = 0; x < PITCH; x++)
+            {
+                mfxU32 noise = x * 1103515245u + y * 12345u + (x ^ y) * 2654435761u;
+                frame[y * PITCH + x] = content == LEVELS
+                    ? mfxU8(16 * ((x * 3 + y * 5 + (x * y) % 7) % 16))
+                    : mfxU8(((x * 2 + y * 3) & 0xff) ^ ((noise >> 13) & 0x1f));
+            }
+        }
+
+        return frame;
+    }
+
+    typedef std::vector<std::pair<mfxU32, mfxU32>> Bins; // bin, count of the non-zero bins
+
+    void CheckHistogram(mfxU32 const * hist, mfxU32 numBins, Bins const & expected)
+    {
+        std::vector<mfxU32> ref(numBins, 0);
+        for (auto const & bin : expected)
+            ref[bin.first] = bin.second;
+
+        for (mfxU32 i = 0; i < numBins; i++)
+            EXPECT_EQ(ref[i], hist[i]) << "bin " << i;
+    }
+
+    struct HistogramCase
+    {
+        mfxU32 width;
+        mfxU32 height;
+        mfxU32 offsetX;
+        mfxU32 offsetY;
+        bool   fields;
+        Bins   bins;
+    };
+
+    const HistogramCase HISTOGRAM_CASES[] =
+    {
+        // frame, the grid is 6x9 blocks, last 8 columns are not counted
+        { SURF_WIDTH, SURF_HEIGHT, 0, 0, false,
+          { {0, 859}, {16, 869}, {32, 863}, {48, 862}, {64, 871}, {80, 862}, {96, 861}, {112, 867},
+            {128, 862}, {144, 865}, {160, 864}, {176, 863}, {192, 862}, {208, 864}, {224, 868}, {240, 862} } },
+        // fields, even columns to [0...255], odd ones to [256...511]
+        { SURF_WIDTH, SURF_HEIGHT, 0, 0, true,
+          { {0, 433}, {16, 438}, {32, 430}, {48, 421}, {64, 451}, {80, 424}, {96, 427}, {112, 437},
+            {128, 439}, {144, 416}, {160, 442}, {176, 432}, {192, 426}, {208, 430}, {224, 448}, {240, 418},
+            {256, 426}, {272, 431}, {288, 433}, {304, 441}, {320, 420}, {336, 438}, {352, 434}, {368, 430},
+            {384, 423}, {400, 449}, {416, 422}, {432, 431}, {448, 436}, {464, 434}, {480, 420}, {496, 444} } },
+        // crop offset, the grid goes past the surface and reads its last column and row
+        { 160, 62, 40, 10, false,
+          { {0, 823}, {16, 832}, {32, 789}, {48, 769}, {64, 845}, {80, 788}, {96, 769}, {112, 828},
+            {128, 793}, {144, 784}, {160, 843}, {176, 1727}, {192, 771}, {208, 844}, {224, 847}, {240, 772} } },
+    };
+};
+
+TEST(H264EncodeCpuAnalysis, HistogramMatchesKernel)
+{
+    std::vector<mfxU8> frame = MakeFrame(LEVELS);
+
+    for (mfxU32 numThreads : { 1, 3 })
+    {
+        CpuFrameAnalysis analysis;
+        analysis.Setup(numThreads);
+
+        for (HistogramCase const & test : HISTOGRAM_CASES)
+        {
+            mfxU32 hist[2 * CpuFrameAnalysis::HIST_BINS];
+            analysis.Histogram(frame.data(), PITCH, SURF_WIDTH, SURF_HEIGHT,
+                test.width, test.height, test.offsetX, test.offsetY, test.fields, hist);
+
+            CheckHistogram(hist, test.fields ? 2 * CpuFrameAnalysis::HIST_BINS : CpuFrameAnalysis::HIST_BINS, test.bins);
+        }
+    }
+}
+
+TEST(H264EncodeCpuAnalysis, RaCaMatchesAsc)
+{
+    std::vector<mfxU8> frame = MakeFrame(NOISE);
+
+    for (mfxU32 numThreads : { 1, 4 })
+    {
+        CpuFrameAnalysis analysis;
+        analysis.Setup(numThreads);
+
+        EXPECT_NEAR(18.977709181396328, analysis.RaCa(frame.data(), PITCH, SURF_WIDTH, SURF_HEIGHT), 1e-12);
+        EXPECT_NEAR(20.904606951908484, analysis.RaCa(frame.data() + 3 * PITCH + 6, PITCH, 187, 61), 1e-12);
+        EXPECT_EQ(0.0, analysis.RaCa(frame.data(), PITCH, 8, SURF_HEIGHT));
+    }
+}
+
+TEST(H264EncodeCpuAnalysis, RaCaRowAVX2MatchesC)
+{
+    if (!__builtin_cpu_supports("avx2"))
+        GTEST_SKIP();
+
+    std::vector<mfxU8> frame = MakeFrame(NOISE);
+
+    // every number of blocks in a row, with and without the C tail
+    for (mfxI32 numBlocks = 1; numBlocks <= (SURF_WIDTH - 8) / CpuFrameAnalysis::RACA_BLOCK; numBlocks++)
+    {
+        for (mfxU32 y = 0; y + 5 <= SURF_HEIGHT; y += 7)
+        {
+            mfxI32 rsC = 0, csC = 0, rsAVX2 = 0, csAVX2 = 0;
+            mfxU8 const * src = frame.data() + y * PITCH + 3;
+
+            CpuFrameAnalysis::RaCaRow_C(src, PITCH, numBlocks, rsC, csC);
+            CpuFrameAnalysis::RaCaRow_AVX2(src, PITCH, numBlocks, rsAVX2, csAVX2);
+
+            EXPECT_EQ(rsC, rsAVX2) << "blocks " << numBlocks << " row " << y;
+            EXPECT_EQ(csC, csAVX2) << "blocks " << numBlocks << " row " << y;
+        }
+    }
+}
+
+TEST(H264EncodeCpuAnalysis, PoolSubmitSignalsCompletion)
+{
+    // without workers (NumThread = 1) and with them
+    for (mfxU32 numThreads = 1; numThreads <= 3; numThreads++)
+    {
+        CpuThreadPool pool;
+        pool.Start(numThreads);
+
+        int handle = pool.GetCompletionHandle();
+        ASSERT_GE(handle, 0);
+
+        for (mfxU32 round = 0; round < 3; round++)
+        {
+            std::vector<mfxU32> items(37, 0);
+            pool.Submit(mfxU32(items.size()), [&items](mfxU32 i) { items[i]++; });
+
+            pollfd fd = { handle, POLLIN, 0 };
+            ASSERT_EQ(1, poll(&fd, 1, 5000)) << "threads " << numThreads;
+            EXPECT_TRUE(pool.IsDone());
+
+            for (mfxU32 i = 0; i < items.size(); i++)
+                EXPECT_EQ(1u, items[i]) << "threads " << numThreads << " item " << i;
+        }
+
+        // ParallelFor waits for a submitted job
+        pool.Submit(5, [](mfxU32) {});
+        std::vector<mfxU32> items(11, 0);
+        pool.ParallelFor(mfxU32(items.size()), [&items](mfxU32 i) { items[i]++; });
+        for (mfxU32 i = 0; i < items.size(); i++)
+            EXPECT_EQ(1u, items[i]);
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "mfx_h264_encode_hw_utils.h"
+#include "mfx_h264_encode_cpu_la.h"
+
+using namespace MfxHwH264Encode;
+
+// CpuLookahead::Propagate runs bands of MB rows in parallel, the costs it adds
+// to the references must be exactly the ones of the serial PropagateRows.
+
+namespace
+{
+    enum
+    {
+        MAX_MV = 24 * 4 // quarter-pel, the largest vector CpuLookahead::EstimateRow gives
+    };
+
+    mfxU32 Rand(mfxU32 & seed)
+    {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 8;
+    }
+
+    mfxI16 RandMv(mfxU32 & seed)
+    {
+        return mfxI16(mfxI32(Rand(seed) % (2 * MAX_MV + 1)) - MAX_MV);
+    }
+
+    VmeData MakeVmeData(mfxU32 numMb, bool bframe, mfxU32 & seed)
+    {
+        VmeData vme;
+        vme.mb.resize(numMb);
+
+        for (MbData & mb : vme.mb)
+        {
+            mb = MbData();
+            mb.intraCost   = 1000 + Rand(seed) % 5000;
+            mb.interCost   = Rand(seed) % mb.intraCost;
+            mb.propCost    = Rand(seed) % 20000;
+            mb.intraMbFlag = Rand(seed) % 5 == 0;
+            mb.mbType      = MBTYPE_BP_L0_16x16;
+            mb.w0          = 32;
+            mb.w1          = 32;
+
+            if (bframe)
+            {
+                mfxU32 type = Rand(seed) % 3;
+                mb.mbType = type == 0 ? MBTYPE_BP_L0_16x16 : type == 1 ? MBTYPE_B_L1_16x16 : MBTYPE_B_Bi_16x16;
+                mb.w0     = mfxU8(Rand(seed) % 65);
+                mb.w1     = mfxU8(64 - mb.w0);
+            }
+
+            mb.mv[0].x = RandMv(seed);
+            mb.mv[0].y = RandMv(seed);
+            mb.mv[1].x = RandMv(seed);
+            mb.mv[1].y = RandMv(seed);
+        }
+
+        return vme;
+    }
+
+    void CheckPropCost(VmeData const & expected, VmeData const & actual, char const * ref)
+    {
+        ASSERT_EQ(expected.mb.size(), actual.mb.size());
+
+        for (size_t i = 0; i < expected.mb.size(); i++)
+            EXPECT_EQ(expected.mb[i].propCost, actual.mb[i].propCost) << ref << " mb " << i;
+    }
+
+    struct PropagateCase
+    {
+        mfxU32 width;
+        mfxU32 height;
+        mfxU32 scaleFactor;
+        mfxU32 numThreads;
+    };
+
+    const PropagateCase PROPAGATE_CASES[] =
+    {
+        {  640,  480, 1, 4 }, // 30 rows, whole bands
+        {  720,  200, 1, 3 }, // 13 rows, the last band is short
+        { 1920, 1080, 2, 8 }, // 34 rows at LA resolution
+        {  176,   48, 1, 2 }, // a single band
+    };
+};
+
+TEST(H264EncodeCpuLookahead, PropagateMatchesSerial)
+{
+    mfxU32 seed = 7;
+
+    for (PropagateCase const & c : PROPAGATE_CASES)
+    {
+        CpuLookahead la;
+        la.Setup(c.width, c.height, c.scaleFactor, 3, c.numThreads);
+
+        mfxI32 w = mfxI32(la.GetWidthLa() / 16);
+        mfxI32 h = mfxI32(la.GetHeightLa() / 16);
+
+        for (bool bframe : { false, true })
+        {
+            VmeData cur = MakeVmeData(mfxU32(w * h), bframe, seed);
+            VmeData l0  = MakeVmeData(mfxU32(w * h), false, seed);
+            VmeData l1  = MakeVmeData(mfxU32(w * h), false, seed);
+
+            VmeData l0Serial = l0;
+            VmeData l1Serial = l1;
+
+            MfxHwH264EncodeHW::PropagateRows(cur, &l0Serial, bframe ? &l1Serial : 0, w, h, 0, h);
+            la.Propagate(cur, &l0, bframe ? &l1 : 0);
+
+            SCOPED_TRACE(testing::Message() << c.width << "x" << c.height << "/" << c.scaleFactor
+                << (bframe ? " B" : " P") << ", threads " << c.numThreads);
+
+            CheckPropCost(l0Serial, l0, "l0");
+            CheckPropCost(l1Serial, l1, "l1");
+        }
+    }
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "ippj.h"
+
+// The converters of pjencccps.c and their AVX2 versions of pjencccl9.c
+extern "C" void mfxownBGRToYCbCr_JPEG_8u_C4P3R(
+    const Ipp8u* pBGRA, int bgraStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize);
+extern "C" void mfxownBGRToYCbCr_JPEG_8u_C4P3R_l9(
+    const Ipp8u* pBGRA, int bgraStep, Ipp8u* pYCC[3], int yccStep, IppiSize roiSize);
+
+namespace
+{
+    enum
+    {
+        SRC_WIDTH  = 300,
+        SRC_HEIGHT = 24,
+        SRC_PITCH  = 4 * SRC_WIDTH + 12,
+        DST_PITCH  = SRC_WIDTH + 5,
+        GUARD      = 0xa5
+    };
+
+    typedef void (*Converter)(const Ipp8u*, int, Ipp8u* [3], int, IppiSize);
+
+    std::vector<Ipp8u> MakeBGRA()
+    {
+        std::vector<Ipp8u> bgra(SRC_PITCH * SRC_HEIGHT);
+        std::mt19937 random(34);
+
+        for (Ipp8u &value : bgra)
+            value = (Ipp8u) random();
+
+        // the extremes of the coefficients on the first row
+        for (int x = 0; x < SRC_WIDTH; x++)
+        {
+            Ipp8u *pixel = bgra.data() + 4 * x;
+            pixel[0] = (x & 1) ? 255 : 0;
+            pixel[1] = (x & 2) ? 255 : 0;
+            pixel[2] = (x & 4) ? 255 : 0;
+        }
+
+        return bgra;
+    }
+
+    // Converts the ROI at (x, y), the planes are filled with GUARD beyond it
+    std::vector<Ipp8u> Convert(Converter converter, const std::vector<Ipp8u> &bgra,
+                               int x, int y, IppiSize roi)
+    {
+        std::vector<Ipp8u> planes(3 * DST_PITCH * SRC_HEIGHT, GUARD);
+        Ipp8u *pYCC[3] =
+        {
+            planes.data(),
+            planes.data() + DST_PITCH * SRC_HEIGHT,
+            planes.data() + 2 * DST_PITCH * SRC_HEIGHT
+        };
+
+        converter(bgra.data() + y * SRC_PITCH + 4 * x, SRC_PITCH, pYCC, DST_PITCH, roi);
+        return planes;
+    }
+}
+
+TEST(IppJpegColorConvert, BGRToYCbCrAVX2MatchesC)
+{
+    if (!__builtin_cpu_supports("avx2"))
+        GTEST_SKIP();
+
+    std::vector<Ipp8u> bgra = MakeBGRA();
+
+    // widths around the 32 pixel vectors, odd heights and crop offsets
+    for (int width : { 2, 3, 31, 32, 33, 63, 64, 65, 97, 255, (int) SRC_WIDTH })
+    {
+        for (int height : { 1, 7, (int) SRC_HEIGHT })
+        {
+            for (int x : { 0, 1, 5 })
+            {
+                if (x + width > SRC_WIDTH)
+                    continue;
+
+                int y = (height == SRC_HEIGHT) ? 0 : 3;
+                IppiSize roi = { width, height };
+
+                EXPECT_EQ(Convert(mfxownBGRToYCbCr_JPEG_8u_C4P3R, bgra, x, y, roi),
+                          Convert(mfxownBGRToYCbCr_JPEG_8u_C4P3R_l9, bgra, x, y, roi))
+                    << "width " << width << " height " << height << " x " << x;
+            }
+        }
+    }
+}
+
+// The result of the library function doesn't depend on the CPU
+TEST(IppJpegColorConvert, BGRToYCbCrMatchesC)
+{
+    std::vector<Ipp8u> bgra = MakeBGRA();
+    Converter library = [](const Ipp8u* pSrc, int srcStep, Ipp8u* pYCC[3], int yccStep, IppiSize roi)
+    {
+        ASSERT_EQ(ippStsNoErr, mfxiBGRToYCbCr_JPEG_8u_C4P3R(pSrc, srcStep, pYCC, yccStep, roi));
+    };
+
+    for (int width : { 2, 33, 97, (int) SRC_WIDTH })
+    {
+        IppiSize roi = { width, 5 };
+
+        EXPECT_EQ(Convert(mfxownBGRToYCbCr_JPEG_8u_C4P3R, bgra, 0, 1, roi),
+                  Convert(library, bgra, 0, 1, roi))
+            << "width " << width;
+    }
+}
@@ -0,0 +1,172 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "mctf_cpu.h"
+
+// The AVX2 kernels of CPU MCTF must match the C ones bit-exactly,
+// the C kernels are the scalar reference of the filter
+namespace
+{
+    enum
+    {
+        BLOCK_SIZE = CpuMctf::BLOCK_SIZE,
+        PLANE_SIZE = 64,
+        MERGE_LIMIT = 256,
+        NUM_ITERATIONS = 200
+    };
+
+    class MctfCpuKernels : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            if (!__builtin_cpu_supports("avx2"))
+                GTEST_SKIP();
+
+            m_plane.resize(PLANE_SIZE * PLANE_SIZE);
+            m_other.resize(PLANE_SIZE * PLANE_SIZE);
+            Fill(m_plane);
+            Fill(m_other);
+        }
+
+        void Fill(std::vector<mfxU8> &plane)
+        {
+            for (mfxU8 &value : plane)
+                value = (mfxU8) m_random();
+
+            // saturated rows check the ranges of the intermediate sums
+            for (mfxU32 x = 0; x < PLANE_SIZE; x++)
+            {
+                plane[x] = 255;
+                plane[PLANE_SIZE + x] = (x & 1) ? 255 : 0;
+            }
+        }
+
+        // blocks at any offset with odd pitches, as the frames and the windows of ME give them;
+        // 9x9 samples are read by the interpolation
+        mfxU32 RandomOffset(mfxI32 pitch)
+        {
+            return m_random() % (PLANE_SIZE * PLANE_SIZE - (BLOCK_SIZE + 1) * pitch - BLOCK_SIZE);
+        }
+
+        mfxI32 RandomPitch()
+        {
+            static const mfxI32 pitches[] = { BLOCK_SIZE, 12, 17, 33, PLANE_SIZE };
+            return pitches[m_random() % (sizeof(pitches) / sizeof(pitches[0]))];
+        }
+
+        std::mt19937 m_random{ 39 };
+        std::vector<mfxU8> m_plane;
+        std::vector<mfxU8> m_other;
+    };
+}
+
+TEST_F(MctfCpuKernels, SAD8x8AVX2MatchesC)
+{
+    for (mfxU32 i = 0; i < NUM_ITERATIONS; i++)
+    {
+        const mfxI32 srcPitch = RandomPitch();
+        const mfxI32 refPitch = RandomPitch();
+        const mfxU8 *src = m_plane.data() + RandomOffset(srcPitch);
+        const mfxU8 *ref = m_other.data() + RandomOffset(refPitch);
+
+        ASSERT_EQ(CpuMctf::SAD8x8_C(src, srcPitch, ref, refPitch), CpuMctf::SAD8x8_AVX2(src, srcPitch, ref, refPitch))
+            << "iteration " << i;
+    }
+
+    // the extremes: identical and inverted blocks
+    std::vector<mfxU8> inverted(m_plane.size());
+    for (size_t i = 0; i < m_plane.size(); i++)
+        inverted[i] = (mfxU8)(255 - m_plane[i]);
+
+    EXPECT_EQ(0u, CpuMctf::SAD8x8_AVX2(m_plane.data(), PLANE_SIZE, m_plane.data(), PLANE_SIZE));
+    EXPECT_EQ(CpuMctf::SAD8x8_C(m_plane.data(), PLANE_SIZE, inverted.data(), PLANE_SIZE),
+              CpuMctf::SAD8x8_AVX2(m_plane.data(), PLANE_SIZE, inverted.data(), PLANE_SIZE));
+}
+
+TEST_F(MctfCpuKernels, InterpolateBlock8x8AVX2MatchesC)
+{
+    for (mfxU32 fy = 0; fy < 4; fy++)
+    {
+        for (mfxU32 fx = 0; fx < 4; fx++)
+        {
+            for (mfxU32 i = 0; i < NUM_ITERATIONS / 4; i++)
+            {
+                const mfxI32 pitch = RandomPitch();
+                const mfxU8 *ref = (i & 1 ? m_other : m_plane).data() + RandomOffset(pitch);
+
+                mfxU8 expected[BLOCK_SIZE * BLOCK_SIZE];
+                mfxU8 actual[BLOCK_SIZE * BLOCK_SIZE];
+                CpuMctf::InterpolateBlock8x8_C(ref, pitch, fx, fy, expected);
+                CpuMctf::InterpolateBlock8x8_AVX2(ref, pitch, fx, fy, actual);
+
+                ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+                    << "fx " << fx << " fy " << fy << " pitch " << pitch << " iteration " << i;
+            }
+        }
+    }
+}
+
+TEST_F(MctfCpuKernels, MergeBlock8x8AVX2MatchesC)
+{
+    for (mfxU32 num = 1; num <= CpuMctf::MAX_REFS; num++)
+    {
+        for (mfxU32 i = 0; i < NUM_ITERATIONS; i++)
+        {
+            const mfxI32 srcPitch = RandomPitch();
+            const mfxU8 *src = m_plane.data() + RandomOffset(srcPitch);
+
+            const mfxU8 *pred[CpuMctf::MAX_REFS];
+            mfxI32 weight[CpuMctf::MAX_REFS];
+            mfxI32 srcWeight = MERGE_LIMIT;
+
+            // weights are shares of MERGE_LIMIT as the similarities give them,
+            // the first iterations take all of it to the source and to the predictions
+            for (mfxU32 k = 0; k < num; k++)
+            {
+                pred[k] = m_other.data() + RandomOffset(BLOCK_SIZE);
+                weight[k] = i == 0 ? 0 : i == 1 ? srcWeight / (mfxI32)(num - k) : (mfxI32)(m_random() % (srcWeight + 1));
+                srcWeight -= weight[k];
+            }
+
+            mfxU8 expected[BLOCK_SIZE * BLOCK_SIZE];
+            mfxU8 actual[BLOCK_SIZE * BLOCK_SIZE];
+            CpuMctf::MergeBlock8x8_C(src, srcPitch, pred, weight, num, srcWeight, expected);
+            CpuMctf::MergeBlock8x8_AVX2(src, srcPitch, pred, weight, num, srcWeight, actual);
+
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+                << "num " << num << " source weight " << srcWeight << " iteration " << i;
+        }
+    }
+}
+
+// the kernels selected at run time are the AVX2 ones on the CPUs with AVX2
+TEST_F(MctfCpuKernels, DispatchesAVX2)
+{
+    CpuMctf::Kernels const &kernels = CpuMctf::GetKernels();
+
+    EXPECT_EQ(&CpuMctf::SAD8x8_AVX2, kernels.SAD8x8);
+    EXPECT_EQ(&CpuMctf::InterpolateBlock8x8_AVX2, kernels.InterpolateBlock8x8);
+    EXPECT_EQ(&CpuMctf::MergeBlock8x8_AVX2, kernels.MergeBlock8x8);
+}
@@ -0,0 +1,328 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mfxvideo.h"
+#include "mfx_session.h"
+#include "libmfx_core_interface.h"
+
+// Smoke tests of the null device (libmfx_core_null.h). The hardware session
+// runs without a driver, the components use the stub DDI and complete every
+// submission after the simulated latency.
+
+namespace
+{
+    enum
+    {
+        WIDTH      = 352,
+        HEIGHT     = 288,
+        NUM_FRAMES = 30,
+        // microseconds, MFX_NULL_DEVICE_LATENCY
+        LATENCY    = 500,
+        // milliseconds
+        SYNC_TIMEOUT = 60000
+    };
+
+    void SetFrameInfo(mfxFrameInfo &info, mfxU16 width, mfxU16 height)
+    {
+        info.FourCC = MFX_FOURCC_NV12;
+        info.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+        info.PicStruct = MFX_PICSTRUCT_PROGRESSIVE;
+        info.Width = width;
+        info.Height = height;
+        info.CropW = width;
+        info.CropH = height;
+        info.FrameRateExtN = 30;
+        info.FrameRateExtD = 1;
+    }
+
+    // NV12 surfaces in the system memory
+    class Surfaces
+    {
+    public:
+        Surfaces(const mfxFrameInfo &info, mfxU16 count)
+            : m_data(size_t(info.Width) * info.Height * 3 / 2 * count, 0x80)
+            , m_surfaces(count)
+        {
+            for (mfxU16 i = 0; i < count; i += 1)
+            {
+                mfxFrameSurface1 &surface = m_surfaces[i];
+                mfxU8 *pY = m_data.data() + size_t(info.Width) * info.Height * 3 / 2 * i;
+
+                surface = {};
+                surface.Info = info;
+                surface.Data.Pitch = info.Width;
+                surface.Data.Y = pY;
+                surface.Data.UV = pY + size_t(info.Width) * info.Height;
+            }
+        }
+
+        mfxFrameSurface1 *GetFree()
+        {
+            auto it = std::find_if(m_surfaces.begin(), m_surfaces.end(),
+                [](const mfxFrameSurface1 &surface) { return 0 == surface.Data.Locked; });
+
+            return (it != m_surfaces.end()) ? &*it : nullptr;
+        }
+
+    private:
+        std::vector<mfxU8> m_data;
+        std::vector<mfxFrameSurface1> m_surfaces;
+    };
+
+    class NullDevice : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            // the hardware cores of the process are the null ones
+            setenv("MFX_NULL_DEVICE", "1", 1);
+            setenv("MFX_NULL_DEVICE_LATENCY", std::to_string(LATENCY).c_str(), 1);
+
+            mfxVersion version = {};
+            version.Major = MFX_VERSION_MAJOR;
+            version.Minor = MFX_VERSION_MINOR;
+            ASSERT_EQ(MFX_ERR_NONE, MFXInit(MFX_IMPL_HARDWARE, &version, &m_session));
+
+            NullDeviceParam *pNullDevice =
+                QueryCoreInterface<NullDeviceParam>(m_session->m_pCORE.get(), MFXINULLDEVICE_GUID);
+            ASSERT_NE(nullptr, pNullDevice);
+            EXPECT_EQ(mfxU32(LATENCY), pNullDevice->latency);
+        }
+
+        void TearDown() override
+        {
+            if (m_session)
+            {
+                MFXClose(m_session);
+            }
+            unsetenv("MFX_NULL_DEVICE");
+            unsetenv("MFX_NULL_DEVICE_LATENCY");
+        }
+
+        mfxSession m_session = nullptr;
+    };
+}
+
+TEST_F(NullDevice, EncodeAvc)
+{
+    mfxVideoParam par = {};
+    par.mfx.CodecId = MFX_CODEC_AVC;
+    par.mfx.TargetUsage = MFX_TARGETUSAGE_BALANCED;
+    par.mfx.RateControlMethod = MFX_RATECONTROL_CBR;
+    par.mfx.TargetKbps = 1000;
+    par.mfx.GopPicSize = NUM_FRAMES;
+    par.mfx.GopRefDist = 3;
+    SetFrameInfo(par.mfx.FrameInfo, WIDTH, HEIGHT);
+    par.IOPattern = MFX_IOPATTERN_IN_SYSTEM_MEMORY;
+    par.AsyncDepth = 4;
+
+    mfxFrameAllocRequest request = {};
+    ASSERT_LE(MFX_ERR_NONE, MFXVideoENCODE_QueryIOSurf(m_session, &par, &request));
+    ASSERT_LE(MFX_ERR_NONE, MFXVideoENCODE_Init(m_session, &par));
+    ASSERT_EQ(MFX_ERR_NONE, MFXVideoENCODE_GetVideoParam(m_session, &par));
+
+    Surfaces surfaces(par.mfx.FrameInfo, request.NumFrameSuggested);
+    std::vector<mfxU8> data(size_t(par.mfx.BufferSizeInKB) * 1000 * std::max<mfxU16>(1, par.mfx.BRCParamMultiplier));
+    mfxBitstream bs = {};
+    bs.Data = data.data();
+    bs.MaxLength = (mfxU32) data.size();
+
+    mfxU32 numEncoded = 0;
+    mfxU64 numBytes = 0;
+
+    // frames are taken until NUM_FRAMES, then the buffered ones are drained
+    for (mfxU32 i = 0; ; i += 1)
+    {
+        mfxFrameSurface1 *pSurface = nullptr;
+        if (i < NUM_FRAMES)
+        {
+            pSurface = surfaces.GetFree();
+            ASSERT_NE(nullptr, pSurface);
+        }
+
+        mfxSyncPoint syncp = nullptr;
+        mfxStatus sts = MFXVideoENCODE_EncodeFrameAsync(m_session, nullptr, pSurface, &bs, &syncp);
+        if (MFX_ERR_MORE_DATA == sts)
+        {
+            if (pSurface)
+                continue;
+            break;
+        }
+        ASSERT_EQ(MFX_ERR_NONE, sts);
+
+        ASSERT_EQ(MFX_ERR_NONE, MFXVideoCORE_SyncOperation(m_session, syncp, SYNC_TIMEOUT));
+        EXPECT_LT(0u, bs.DataLength);
+
+        numEncoded += 1;
+        numBytes += bs.DataLength;
+        bs.DataOffset = 0;
+        bs.DataLength = 0;
+    }
+
+    EXPECT_EQ(mfxU32(NUM_FRAMES), numEncoded);
+    // the stub outputs the frame sizes the rate control targets
+    EXPECT_LT(0u, numBytes);
+
+    EXPECT_EQ(MFX_ERR_NONE, MFXVideoENCODE_Close(m_session));
+}
+
+TEST_F(NullDevice, ProcessVpp)
+{
+    mfxVideoParam par = {};
+    SetFrameInfo(par.vpp.In, WIDTH, HEIGHT);
+    SetFrameInfo(par.vpp.Out, WIDTH / 2, HEIGHT / 2);
+    par.IOPattern = MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+    par.AsyncDepth = 4;
+
+    mfxFrameAllocRequest request[2] = {};
+    ASSERT_LE(MFX_ERR_NONE, MFXVideoVPP_QueryIOSurf(m_session, &par, request));
+    ASSERT_LE(MFX_ERR_NONE, MFXVideoVPP_Init(m_session, &par));
+
+    Surfaces in(par.vpp.In, request[0].NumFrameSuggested);
+    Surfaces out(par.vpp.Out, request[1].NumFrameSuggested);
+    mfxU32 numProcessed = 0;
+
+    for (mfxU32 i = 0; i < NUM_FRAMES; i += 1)
+    {
+        mfxFrameSurface1 *pIn = in.GetFree();
+        mfxFrameSurface1 *pOut = out.GetFree();
+        ASSERT_NE(nullptr, pIn);
+        ASSERT_NE(nullptr, pOut);
+
+        mfxSyncPoint syncp = nullptr;
+        ASSERT_EQ(MFX_ERR_NONE, MFXVideoVPP_RunFrameVPPAsync(m_session, pIn, pOut, nullptr, &syncp));
+        ASSERT_EQ(MFX_ERR_NONE, MFXVideoCORE_SyncOperation(m_session, syncp, SYNC_TIMEOUT));
+
+        numProcessed += 1;
+    }
+
+    EXPECT_EQ(mfxU32(NUM_FRAMES), numProcessed);
+
+    EXPECT_EQ(MFX_ERR_NONE, MFXVideoVPP_Close(m_session));
+}
+
+// There is no CM device, MCTF runs on CPU after the stub DDI
+TEST_F(NullDevice, ProcessVppMctf)
+{
+    mfxExtVppMctf mctf = {};
+    mctf.Header.BufferId = MFX_EXTBUFF_VPP_MCTF;
+    mctf.Header.BufferSz = sizeof(mctf);
+    mctf.FilterStrength = 10;
+#ifdef MFX_ENABLE_MCTF_EXT
+    // the CPU filter has no delay, it takes the previous frame only
+    // (2 references is the default mode too)
+    mctf.TemporalMode = MFX_MCTF_TEMPORAL_MODE_2REF;
+#endif
+    mfxExtBuffer *extParam[] = { &mctf.Header };
+
+    mfxVideoParam par = {};
+    SetFrameInfo(par.vpp.In, WIDTH, HEIGHT);
+    SetFrameInfo(par.vpp.Out, WIDTH, HEIGHT);
+    par.IOPattern = MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+    par.AsyncDepth = 4;
+    par.ExtParam = extParam;
+    par.NumExtParam = 1;
+
+    mfxFrameAllocRequest request[2] = {};
+    ASSERT_LE(MFX_ERR_NONE, MFXVideoVPP_QueryIOSurf(m_session, &par, request));
+    // the mode is changed to 1 reference
+    ASSERT_EQ(MFX_WRN_INCOMPATIBLE_VIDEO_PARAM, MFXVideoVPP_Init(m_session, &par));
+
+    Surfaces in(par.vpp.In, request[0].NumFrameSuggested);
+    Surfaces out(par.vpp.Out, request[1].NumFrameSuggested);
+
+    for (mfxU32 i = 0; i < NUM_FRAMES; i += 1)
+    {
+        mfxFrameSurface1 *pIn = in.GetFree();
+        mfxFrameSurface1 *pOut = out.GetFree();
+        ASSERT_NE(nullptr, pIn);
+        ASSERT_NE(nullptr, pOut);
+
+        mfxSyncPoint syncp = nullptr;
+        ASSERT_EQ(MFX_ERR_NONE, MFXVideoVPP_RunFrameVPPAsync(m_session, pIn, pOut, nullptr, &syncp));
+        ASSERT_EQ(MFX_ERR_NONE, MFXVideoCORE_SyncOperation(m_session, syncp, SYNC_TIMEOUT));
+    }
+
+    EXPECT_EQ(MFX_ERR_NONE, MFXVideoVPP_Close(m_session));
+}
+
+// Encoders other than AVC have no stub DDI, they are rejected explicitly
+TEST_F(NullDevice, EncodeOtherCodecsUnsupported)
+{
+    const mfxU32 codecIds[] = { MFX_CODEC_HEVC, MFX_CODEC_MPEG2, MFX_CODEC_JPEG, MFX_CODEC_VP9 };
+
+    for (mfxU32 codecId : codecIds)
+    {
+        mfxVideoParam par = {};
+        par.mfx.CodecId = codecId;
+        par.mfx.TargetUsage = MFX_TARGETUSAGE_BALANCED;
+        par.mfx.RateControlMethod = MFX_RATECONTROL_CBR;
+        par.mfx.TargetKbps = 1000;
+        SetFrameInfo(par.mfx.FrameInfo, WIDTH, HEIGHT);
+        par.IOPattern = MFX_IOPATTERN_IN_SYSTEM_MEMORY;
+
+        mfxVideoParam out = par;
+        mfxFrameAllocRequest request = {};
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoENCODE_Query(m_session, &par, &out)) << codecId;
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoENCODE_QueryIOSurf(m_session, &par, &request)) << codecId;
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoENCODE_Init(m_session, &par)) << codecId;
+    }
+}
+
+// Only the AVC decoder runs on the null accelerator
+TEST_F(NullDevice, DecodeOtherCodecsUnsupported)
+{
+    const mfxU32 codecIds[] = { MFX_CODEC_HEVC, MFX_CODEC_MPEG2, MFX_CODEC_VC1, MFX_CODEC_JPEG, MFX_CODEC_VP9 };
+
+    for (mfxU32 codecId : codecIds)
+    {
+        mfxVideoParam par = {};
+        par.mfx.CodecId = codecId;
+        SetFrameInfo(par.mfx.FrameInfo, WIDTH, HEIGHT);
+        par.IOPattern = MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+
+        mfxVideoParam out = par;
+        mfxFrameAllocRequest request = {};
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoDECODE_Query(m_session, &par, &out)) << codecId;
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoDECODE_QueryIOSurf(m_session, &par, &request)) << codecId;
+        EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoDECODE_Init(m_session, &par)) << codecId;
+    }
+}
+
+// LA, PreENC, ENC and PAK have no stubs
+TEST_F(NullDevice, EncPakUnsupported)
+{
+    mfxVideoParam par = {};
+    par.mfx.CodecId = MFX_CODEC_AVC;
+    SetFrameInfo(par.mfx.FrameInfo, WIDTH, HEIGHT);
+    par.IOPattern = MFX_IOPATTERN_IN_VIDEO_MEMORY;
+
+    mfxVideoParam out = par;
+    EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoENC_Query(m_session, &par, &out));
+    EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoENC_Init(m_session, &par));
+    EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoPAK_Query(m_session, &par, &out));
+    EXPECT_EQ(MFX_ERR_UNSUPPORTED, MFXVideoPAK_Init(m_session, &par));
+}
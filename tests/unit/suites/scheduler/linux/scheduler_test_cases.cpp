@@ -0,0 +1,1195 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <mfx_interface.h>
+#include <mfx_interface_scheduler.h>
+#include <mfx_task.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+// Tasks of the tests submit their job to a software fake device and return
+// MFX_TASK_BUSY until the device signals the completion after a random delay.
+// The latency is the time between the signal and the next call of the task.
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    enum
+    {
+        NUM_FRAMES  = 64,
+        ASYNC_DEPTH = 4,
+        // the completion comes after 200..2000 usec
+        MIN_DELAY   = 200,
+        MAX_DELAY   = 2000,
+        // average latency of the wake-up, usec
+        MAX_MEAN_LATENCY = 5000
+    };
+
+    enum Mode
+    {
+        EVENT_FD,   // the task registers an eventfd, the device writes it
+        CALLBACK    // the device calls SignalCompletion
+    };
+
+    struct Frame
+    {
+        int fd;
+        bool submitted;
+        std::atomic<bool> done;
+        Clock::time_point signaled;
+        Clock::time_point resumed;
+        mfxU32 calls;
+        // calls of the continuation
+        mfxU32 resumes;
+    };
+
+    class FakeDevice
+    {
+    public:
+        FakeDevice(MFXIScheduler3 *pScheduler, Mode mode)
+            : m_pScheduler(pScheduler)
+            , m_mode(mode)
+            , m_random(12345)
+            , m_bQuit(false)
+            , m_thread([this]() { Run(); })
+        {
+        }
+
+        ~FakeDevice()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_guard);
+                m_bQuit = true;
+            }
+            m_jobAdded.notify_one();
+            m_thread.join();
+        }
+
+        void Submit(Frame *pFrame)
+        {
+            std::lock_guard<std::mutex> guard(m_guard);
+            std::uniform_int_distribution<int> delay(MIN_DELAY, MAX_DELAY);
+
+            m_jobs.push_back(Job{pFrame, Clock::now() + std::chrono::microseconds(delay(m_random))});
+            m_jobAdded.notify_one();
+        }
+
+    protected:
+        struct Job
+        {
+            Frame *pFrame;
+            Clock::time_point due;
+        };
+
+        void Run()
+        {
+            std::unique_lock<std::mutex> guard(m_guard);
+
+            for (;;)
+            {
+                m_jobAdded.wait(guard, [this]() { return m_bQuit || !m_jobs.empty(); });
+                if (m_bQuit)
+                    break;
+
+                // jobs are done in order, as a device queue does
+                Job job = m_jobs.front();
+                m_jobs.pop_front();
+
+                guard.unlock();
+                std::this_thread::sleep_until(job.due);
+
+                job.pFrame->signaled = Clock::now();
+                job.pFrame->done = true;
+                if (EVENT_FD == m_mode)
+                    eventfd_write(job.pFrame->fd, 1);
+                else
+                    m_pScheduler->SignalCompletion(this, job.pFrame);
+                guard.lock();
+            }
+        }
+
+        MFXIScheduler3 *m_pScheduler;
+        Mode m_mode;
+        std::mt19937 m_random;
+
+        std::mutex m_guard;
+        std::condition_variable m_jobAdded;
+        std::deque<Job> m_jobs;
+        bool m_bQuit;
+        std::thread m_thread;
+    };
+
+    struct Context
+    {
+        MFXIScheduler3 *pScheduler;
+        FakeDevice *pDevice;
+        Mode mode;
+    };
+
+    mfxStatus DeviceRoutine(void *pState, void *pParam, mfxU32, mfxU32)
+    {
+        Context &ctx = *(Context *) pState;
+        Frame &frame = *(Frame *) pParam;
+
+        frame.calls += 1;
+
+        if (!frame.submitted)
+        {
+            mfxStatus sts = ctx.pScheduler->RegisterCompletion(ctx.pDevice, &frame,
+                (EVENT_FD == ctx.mode) ? frame.fd : -1);
+            if (MFX_ERR_NONE != sts)
+                return sts;
+
+            frame.submitted = true;
+            ctx.pDevice->Submit(&frame);
+            return MFX_TASK_BUSY;
+        }
+
+        // the task must not be called before the device is done
+        if (!frame.done)
+            return MFX_TASK_BUSY;
+
+        frame.resumed = Clock::now();
+        return MFX_TASK_DONE;
+    }
+
+    void RunFrames(mfxU32 flags, Mode mode)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        ASSERT_NE(nullptr, pScheduler);
+
+        MFX_SCHEDULER_PARAM2 param = {};
+        param.flags = (mfxSchedulerFlags) flags;
+        param.numberOfThreads = (MFX_SINGLE_THREAD == flags) ? 1 : 4;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+        std::vector<Frame> frames(NUM_FRAMES);
+        std::vector<mfxSyncPoint> syncPoints(NUM_FRAMES);
+
+        {
+            FakeDevice device(pScheduler, mode);
+            Context ctx = { pScheduler, &device, mode };
+
+            for (mfxU32 i = 0; i < NUM_FRAMES; i++)
+            {
+                Frame &frame = frames[i];
+
+                frame.fd = eventfd(0, EFD_CLOEXEC);
+                ASSERT_LE(0, frame.fd);
+                frame.submitted = false;
+                frame.done = false;
+                frame.calls = 0;
+
+                MFX_TASK task = {};
+                task.pOwner = &device;
+                task.threadingPolicy = MFX_TASK_THREADING_DEDICATED;
+                task.priority = MFX_PRIORITY_NORMAL;
+                task.entryPoint.pRoutine = DeviceRoutine;
+                task.entryPoint.pState = &ctx;
+                task.entryPoint.pParam = &frame;
+                // every frame has its own output, frames don't wait each other
+                task.pDst[0] = &frame;
+
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[i]));
+
+                if (i >= ASYNC_DEPTH)
+                {
+                    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i - ASYNC_DEPTH], 10000));
+                }
+            }
+
+            for (mfxU32 i = NUM_FRAMES - ASYNC_DEPTH; i < NUM_FRAMES; i++)
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i], 10000));
+        }
+
+        pScheduler->Release();
+
+        Clock::duration total = Clock::duration::zero();
+        for (auto & frame : frames)
+        {
+            close(frame.fd);
+
+            // the task is called to submit the job and once the job is done
+            EXPECT_EQ(2u, frame.calls);
+            total += frame.resumed - frame.signaled;
+        }
+
+        const long long mean = std::chrono::duration_cast<std::chrono::microseconds>(total).count() / NUM_FRAMES;
+        ::testing::Test::RecordProperty("mean_latency_usec", (int) mean);
+        EXPECT_GT(MAX_MEAN_LATENCY, mean);
+    }
+}
+
+TEST(SchedulerCompletion, EventFd)
+{
+    RunFrames(MFX_SCHEDULER_DEFAULT, EVENT_FD);
+}
+
+TEST(SchedulerCompletion, Callback)
+{
+    RunFrames(MFX_SCHEDULER_DEFAULT, CALLBACK);
+}
+
+TEST(SchedulerCompletion, EventFdSharedPool)
+{
+    RunFrames(MFX_SCHEDULER_SHARED_POOL, EVENT_FD);
+}
+
+TEST(SchedulerCompletion, EventFdSingleThread)
+{
+    RunFrames(MFX_SINGLE_THREAD, EVENT_FD);
+}
+
+namespace
+{
+    enum
+    {
+        BATCH_SIZE = 8
+    };
+
+    void RunBatches(mfxU32 flags)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        ASSERT_NE(nullptr, pScheduler);
+
+        MFX_SCHEDULER_PARAM2 param = {};
+        param.flags = (mfxSchedulerFlags) flags;
+        param.numberOfThreads = (MFX_SINGLE_THREAD == flags) ? 1 : 4;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+        std::vector<Frame> frames(NUM_FRAMES);
+
+        {
+            FakeDevice device(pScheduler, EVENT_FD);
+            Context ctx = { pScheduler, &device, EVENT_FD };
+
+            for (mfxU32 first = 0; first < NUM_FRAMES; first += BATCH_SIZE)
+            {
+                MFX_TASK tasks[BATCH_SIZE] = {};
+                mfxSyncPoint syncPoints[BATCH_SIZE] = {};
+                mfxU32 numAdded = 0, index = BATCH_SIZE;
+
+                for (mfxU32 i = 0; i < BATCH_SIZE; i++)
+                {
+                    Frame &frame = frames[first + i];
+
+                    frame.fd = eventfd(0, EFD_CLOEXEC);
+                    ASSERT_LE(0, frame.fd);
+                    frame.submitted = false;
+                    frame.done = false;
+                    frame.calls = 0;
+
+                    tasks[i].pOwner = &device;
+                    tasks[i].threadingPolicy = MFX_TASK_THREADING_DEDICATED;
+                    tasks[i].priority = MFX_PRIORITY_NORMAL;
+                    tasks[i].entryPoint.pRoutine = DeviceRoutine;
+                    tasks[i].entryPoint.pState = &ctx;
+                    tasks[i].entryPoint.pParam = &frame;
+                    tasks[i].pDst[0] = &frame;
+                }
+
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTasks(tasks, BATCH_SIZE, syncPoints, &numAdded));
+                ASSERT_EQ((mfxU32) BATCH_SIZE, numAdded);
+
+                // frames without output don't have sync points
+                syncPoints[0] = NULL;
+
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->SynchronizeMultiple(syncPoints, BATCH_SIZE, false, 10000, &index));
+                ASSERT_LT(0u, index);
+                ASSERT_GT((mfxU32) BATCH_SIZE, index);
+                EXPECT_TRUE(frames[first + index].done);
+
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->SynchronizeMultiple(syncPoints, BATCH_SIZE, true, 10000, NULL));
+                for (mfxU32 i = 1; i < BATCH_SIZE; i++)
+                {
+                    EXPECT_TRUE(frames[first + i].done);
+                }
+
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->WaitForAllTasksCompletion(&device));
+            }
+        }
+
+        pScheduler->Release();
+
+        for (auto & frame : frames)
+        {
+            close(frame.fd);
+            EXPECT_EQ(2u, frame.calls);
+        }
+    }
+}
+
+TEST(SchedulerBatch, AddAndWaitAnyAll)
+{
+    RunBatches(MFX_SCHEDULER_DEFAULT);
+}
+
+TEST(SchedulerBatch, AddAndWaitAnyAllSharedPool)
+{
+    RunBatches(MFX_SCHEDULER_SHARED_POOL);
+}
+
+TEST(SchedulerBatch, AddAndWaitAnyAllSingleThread)
+{
+    RunBatches(MFX_SINGLE_THREAD);
+}
+
+namespace
+{
+    enum
+    {
+        // two such batches don't fit into the task objects together
+        LARGE_BATCH_SIZE = 768
+    };
+
+    mfxStatus GatedRoutine(void *pState, void *, mfxU32, mfxU32)
+    {
+        const std::atomic<bool> *pOpen = (const std::atomic<bool> *) pState;
+
+        return *pOpen ? MFX_TASK_DONE : MFX_TASK_BUSY;
+    }
+}
+
+// Two batches wait for the task objects at the same time. Each of them has to
+// get all its objects at once, otherwise both get stuck with a part of them.
+TEST(SchedulerBatch, ConcurrentLargeBatches)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SCHEDULER_DEFAULT;
+    param.numberOfThreads = 2;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    std::atomic<bool> open(false);
+    std::vector<MFX_TASK> tasks(LARGE_BATCH_SIZE);
+    for (auto & task : tasks)
+    {
+        task = {};
+        task.pOwner = &open;
+        task.threadingPolicy = MFX_TASK_THREADING_INTER;
+        task.priority = MFX_PRIORITY_NORMAL;
+        task.entryPoint.pRoutine = GatedRoutine;
+        task.entryPoint.pState = &open;
+    }
+
+    // take all task objects until the gate opens
+    std::vector<mfxSyncPoint> gated(LARGE_BATCH_SIZE);
+    mfxU32 numAdded = 0;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTasks(tasks.data(), LARGE_BATCH_SIZE, gated.data(), &numAdded));
+    ASSERT_EQ((mfxU32) LARGE_BATCH_SIZE, numAdded);
+
+    std::mutex guard;
+    std::condition_variable batchDone;
+    mfxU32 numDone = 0;
+    std::atomic<mfxU32> numErrors(0);
+    std::vector<std::thread> callers;
+
+    for (mfxU32 t = 0; t < 2; t++)
+    {
+        callers.emplace_back([&]()
+        {
+            std::vector<mfxSyncPoint> syncPoints(LARGE_BATCH_SIZE);
+            mfxU32 added = 0;
+
+            if (MFX_ERR_NONE != pScheduler->AddTasks(tasks.data(), LARGE_BATCH_SIZE, syncPoints.data(), &added) ||
+                LARGE_BATCH_SIZE != added ||
+                MFX_ERR_NONE != pScheduler->SynchronizeMultiple(syncPoints.data(), LARGE_BATCH_SIZE, true, 10000, NULL))
+                numErrors += 1;
+
+            std::lock_guard<std::mutex> lock(guard);
+            numDone += 1;
+            batchDone.notify_one();
+        });
+    }
+
+    // let both callers block on the task objects, then release them
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    open = true;
+
+    bool finished;
+    {
+        std::unique_lock<std::mutex> lock(guard);
+        finished = batchDone.wait_for(lock, std::chrono::seconds(30), [&]() { return 2 == numDone; });
+    }
+    if (!finished)
+    {
+        // the callers are stuck, don't destroy anything they use
+        for (auto & caller : callers)
+            caller.detach();
+        FAIL() << "concurrent batches are deadlocked";
+    }
+
+    for (auto & caller : callers)
+        caller.join();
+
+    EXPECT_EQ(0u, numErrors);
+    EXPECT_EQ(MFX_ERR_NONE, pScheduler->WaitForAllTasksCompletion(&open));
+
+    pScheduler->Release();
+}
+
+namespace
+{
+    enum
+    {
+        NUM_CALLERS    = 64,
+        NUM_SYNC_CALLS = 20000
+    };
+
+    mfxStatus DoneRoutine(void *, void *, mfxU32, mfxU32)
+    {
+        return MFX_TASK_DONE;
+    }
+}
+
+// Micro-benchmark of the Synchronize throughput: many threads check
+// the sync points of tasks which are done already.
+TEST(SchedulerSync, CompletedTaskThroughput)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SCHEDULER_DEFAULT;
+    param.numberOfThreads = 4;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    std::vector<mfxSyncPoint> syncPoints(ASYNC_DEPTH);
+
+    for (auto & syncPoint : syncPoints)
+    {
+        MFX_TASK task = {};
+        task.pOwner = &syncPoints;
+        task.threadingPolicy = MFX_TASK_THREADING_INTER;
+        task.priority = MFX_PRIORITY_NORMAL;
+        task.entryPoint.pRoutine = DoneRoutine;
+
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoint));
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoint, 10000));
+    }
+
+    std::atomic<mfxU32> numErrors(0);
+    std::vector<std::thread> callers;
+
+    const Clock::time_point start = Clock::now();
+    for (mfxU32 t = 0; t < NUM_CALLERS; t++)
+    {
+        callers.emplace_back([&, t]()
+        {
+            for (mfxU32 i = 0; i < NUM_SYNC_CALLS; i++)
+            {
+                if (MFX_ERR_NONE != pScheduler->Synchronize(syncPoints[(t + i) % ASYNC_DEPTH], 0))
+                    numErrors += 1;
+            }
+        });
+    }
+    for (auto & caller : callers)
+        caller.join();
+    const Clock::duration elapsed = Clock::now() - start;
+
+    pScheduler->Release();
+
+    EXPECT_EQ(0u, numErrors);
+
+    const long long usec = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    const long long callsPerSec = (long long) NUM_CALLERS * NUM_SYNC_CALLS * 1000000 / std::max(usec, 1ll);
+    ::testing::Test::RecordProperty("sync_calls_per_sec", (int) std::min(callsPerSec, (long long) INT_MAX));
+}
+
+namespace
+{
+    enum
+    {
+        NUM_SHORT_TASKS   = 20000,
+        SHORT_TASKS_DEPTH = 16
+    };
+
+    void RunShortTasks(mfxU32 flags)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        ASSERT_NE(nullptr, pScheduler);
+
+        MFX_SCHEDULER_PARAM2 param = {};
+        param.flags = (mfxSchedulerFlags) flags;
+        param.numberOfThreads = (MFX_SINGLE_THREAD == flags) ? 1 : 4;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+        std::vector<mfxSyncPoint> syncPoints(NUM_SHORT_TASKS);
+        mfxU32 owner = 0;
+
+        const Clock::time_point start = Clock::now();
+        for (mfxU32 i = 0; i < NUM_SHORT_TASKS; i++)
+        {
+            MFX_TASK task = {};
+            task.pOwner = &owner;
+            task.threadingPolicy = MFX_TASK_THREADING_INTER;
+            task.priority = MFX_PRIORITY_NORMAL;
+            task.entryPoint.pRoutine = DoneRoutine;
+
+            ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[i]));
+
+            if (i >= SHORT_TASKS_DEPTH)
+            {
+                ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i - SHORT_TASKS_DEPTH], 10000));
+            }
+        }
+        for (mfxU32 i = NUM_SHORT_TASKS - SHORT_TASKS_DEPTH; i < NUM_SHORT_TASKS; i++)
+            ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i], 10000));
+        const Clock::duration elapsed = Clock::now() - start;
+
+        pScheduler->Release();
+
+        const long long usec = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        ::testing::Test::RecordProperty("tasks_per_sec", (int) ((long long) NUM_SHORT_TASKS * 1000000 / std::max(usec, 1ll)));
+    }
+}
+
+// Micro-benchmark of the task throughput: the cost of the scheduler itself
+// for tasks doing nothing. Run it under 'perf stat -e cache-misses' to see
+// the memory behavior of the task storage.
+TEST(SchedulerThroughput, ShortTasks)
+{
+    RunShortTasks(MFX_SCHEDULER_DEFAULT);
+}
+
+TEST(SchedulerThroughput, ShortTasksSingleThread)
+{
+    RunShortTasks(MFX_SINGLE_THREAD);
+}
+
+namespace
+{
+    enum
+    {
+        // the first task is held running for this time, msec
+        GATE_TIME = 20
+    };
+
+    mfxStatus GateRoutine(void *, void *pParam, mfxU32, mfxU32)
+    {
+        std::atomic<bool> &gate = *(std::atomic<bool> *) pParam;
+
+        while (!gate)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        return MFX_TASK_DONE;
+    }
+
+    // Add two software tasks, the second one depends on the first one
+    void AddGatedTasks(MFXIScheduler *pScheduler, std::atomic<bool> &gate, mfxSyncPoint (&syncPoints)[2])
+    {
+        MFX_TASK task = {};
+        task.pOwner = &gate;
+        task.threadingPolicy = MFX_TASK_THREADING_INTER;
+        task.priority = MFX_PRIORITY_NORMAL;
+        task.entryPoint.pRoutine = GateRoutine;
+        task.entryPoint.pParam = &gate;
+        task.pDst[0] = &syncPoints[0];
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[0]));
+
+        task.pSrc[0] = &syncPoints[0];
+        task.pDst[0] = &syncPoints[1];
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[1]));
+    }
+
+    void ExpectLatencies(const MFX_SCHEDULER_TASK_STAT &taskStat, mfxU32 minLatency)
+    {
+        EXPECT_EQ(0u, taskStat.numQueued);
+        EXPECT_EQ(2u, taskStat.numCompleted);
+        EXPECT_LE(minLatency, taskStat.latency50);
+        EXPECT_LE(taskStat.latency50, taskStat.latency90);
+        EXPECT_LE(taskStat.latency90, taskStat.latency99);
+        EXPECT_LE(taskStat.latency99, taskStat.latencyMax);
+        EXPECT_GT(10000000u, taskStat.latencyMax);
+    }
+}
+
+TEST(SchedulerStat, QueueStateAndLatency)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_STAT stat;
+    EXPECT_EQ(MFX_ERR_NOT_INITIALIZED, pScheduler->GetStat(&stat));
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SCHEDULER_DEFAULT;
+    param.numberOfThreads = 4;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+    EXPECT_EQ(MFX_ERR_NULL_PTR, pScheduler->GetStat(NULL));
+
+    // the first call turns on the latency statistic
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+    EXPECT_EQ(0u, stat.task[MFX_TYPE_SOFTWARE].numQueued);
+    EXPECT_EQ(0u, stat.task[MFX_TYPE_SOFTWARE].numCompleted);
+    EXPECT_EQ(0u, stat.load);
+
+    std::atomic<bool> gate(false);
+    mfxSyncPoint syncPoints[2] = {};
+    AddGatedTasks(pScheduler, gate, syncPoints);
+
+    // wait until a thread enters the first task
+    const Clock::time_point timeout = Clock::now() + std::chrono::seconds(5);
+    do
+    {
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+    } while (!stat.task[MFX_TYPE_SOFTWARE].numRunning && Clock::now() < timeout);
+
+    EXPECT_EQ(2u, stat.task[MFX_TYPE_SOFTWARE].numQueued);
+    EXPECT_EQ(1u, stat.task[MFX_TYPE_SOFTWARE].numRunning);
+    EXPECT_EQ(1u, stat.task[MFX_TYPE_SOFTWARE].numBlocked);
+    EXPECT_EQ(0u, stat.task[MFX_TYPE_HARDWARE].numQueued);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(GATE_TIME));
+    gate = true;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[1], 10000));
+
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+    ExpectLatencies(stat.task[MFX_TYPE_SOFTWARE], GATE_TIME * 1000);
+    EXPECT_EQ(0u, stat.task[MFX_TYPE_HARDWARE].numCompleted);
+    EXPECT_EQ(4u, stat.numberOfThreads);
+    EXPECT_LT(0u, stat.load);
+    EXPECT_LT(0u, *std::max_element(stat.threadBusy, stat.threadBusy + stat.numberOfThreads));
+
+    pScheduler->Release();
+}
+
+TEST(SchedulerStat, QueueStateAndLatencySingleThread)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SINGLE_THREAD;
+    param.numberOfThreads = 1;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    // the first call turns on the latency statistic
+    MFX_SCHEDULER_STAT stat;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+
+    // tasks are run by Synchronize only
+    std::atomic<bool> gate(true);
+    mfxSyncPoint syncPoints[2] = {};
+    AddGatedTasks(pScheduler, gate, syncPoints);
+
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+    EXPECT_EQ(2u, stat.task[MFX_TYPE_SOFTWARE].numQueued);
+    EXPECT_EQ(1u, stat.task[MFX_TYPE_SOFTWARE].numReady);
+    EXPECT_EQ(1u, stat.task[MFX_TYPE_SOFTWARE].numBlocked);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(GATE_TIME));
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[1], 10000));
+
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetStat(&stat));
+    ExpectLatencies(stat.task[MFX_TYPE_SOFTWARE], GATE_TIME * 1000);
+    EXPECT_EQ(0u, stat.numberOfThreads);
+
+    pScheduler->Release();
+}
+
+namespace
+{
+    enum
+    {
+        // latency budget of the live sessions, usec
+        LIVE_BUDGET     = 30000,
+        // a task call takes this time, msec
+        WORK_TIME       = 2,
+        NUM_VOD_TASKS   = 32,
+        NUM_LIVE_TASKS  = 8,
+        NUM_BACKLOG     = 200
+    };
+
+    struct Session
+    {
+        std::atomic<mfxU32> numDone;
+        // the number of tasks done by the other session, when this one
+        // is entered the first time and when it is done
+        std::atomic<mfxU32> otherAtFirst;
+        std::atomic<mfxU32> otherAtLast;
+        Session *pOther;
+        mfxU32 numTasks;
+    };
+
+    mfxStatus WorkRoutine(void *pState, void *, mfxU32, mfxU32)
+    {
+        Session &session = *(Session *) pState;
+        const mfxU32 other = session.pOther->numDone;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(WORK_TIME));
+
+        if (0 == session.numDone++)
+            session.otherAtFirst = other;
+        if (session.numTasks == session.numDone)
+            session.otherAtLast = other;
+
+        return MFX_TASK_DONE;
+    }
+
+    mfxStatus RecordRoutine(void *pState, void *pParam, mfxU32, mfxU32)
+    {
+        std::vector<mfxU32> &order = *(std::vector<mfxU32> *) pState;
+
+        order.push_back((mfxU32) (size_t) pParam);
+
+        return MFX_TASK_DONE;
+    }
+
+    MFXIScheduler3 *CreatePoolScheduler(mfxU32 latencyBudget)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        if (pScheduler)
+        {
+            MFX_SCHEDULER_PARAM2 param = {};
+            param.flags = MFX_SCHEDULER_SHARED_POOL;
+            param.numberOfThreads = 4;
+            param.latencyBudget = latencyBudget;
+            if (MFX_ERR_NONE != pScheduler->Initialize2(&param))
+            {
+                pScheduler->Release();
+                pScheduler = nullptr;
+            }
+        }
+
+        return pScheduler;
+    }
+
+    void AddWork(MFXIScheduler *pScheduler, Session &session, mfxU32 numTasks, std::vector<mfxSyncPoint> &syncPoints)
+    {
+        session.numTasks = numTasks;
+        syncPoints.resize(numTasks);
+
+        for (auto & syncPoint : syncPoints)
+        {
+            MFX_TASK task = {};
+            task.pOwner = &session;
+            task.threadingPolicy = MFX_TASK_THREADING_INTER;
+            task.priority = MFX_PRIORITY_NORMAL;
+            task.entryPoint.pRoutine = WorkRoutine;
+            task.entryPoint.pState = &session;
+            task.entryPoint.requiredNumThreads = 1;
+            ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoint));
+        }
+    }
+}
+
+TEST(SchedulerDeadline, EarliestDeadlineFirst)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SINGLE_THREAD;
+    param.numberOfThreads = 1;
+    param.latencyBudget = LIVE_BUDGET;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    // tasks are run by Synchronize only, the earlier task goes first
+    // regardless of the priority
+    std::vector<mfxU32> order;
+    mfxSyncPoint syncPoints[2] = {};
+    const mfxPriority priorities[2] = { MFX_PRIORITY_LOW, MFX_PRIORITY_HIGH };
+    for (mfxU32 i = 0; i < 2; i++)
+    {
+        MFX_TASK task = {};
+        task.pOwner = &order;
+        task.threadingPolicy = MFX_TASK_THREADING_INTER;
+        task.priority = priorities[i];
+        task.entryPoint.pRoutine = RecordRoutine;
+        task.entryPoint.pState = &order;
+        task.entryPoint.pParam = (void *) (size_t) i;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[i]));
+    }
+
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[1], 10000));
+    ASSERT_EQ(2u, order.size());
+    EXPECT_EQ(0u, order[0]);
+    EXPECT_EQ(1u, order[1]);
+
+    pScheduler->Release();
+}
+
+// The live session added after the best effort one is run before
+// the best effort tasks waiting in the queue
+TEST(SchedulerDeadline, SharedPoolLiveFirst)
+{
+    MFXIScheduler3 *pVod = CreatePoolScheduler(0);
+    ASSERT_NE(nullptr, pVod);
+    MFXIScheduler3 *pLive = CreatePoolScheduler(LIVE_BUDGET);
+    ASSERT_NE(nullptr, pLive);
+
+    Session vod = {}, live = {};
+    vod.pOther = &live;
+    live.pOther = &vod;
+    std::vector<mfxSyncPoint> vodSyncPoints, liveSyncPoints;
+
+    AddWork(pVod, vod, NUM_VOD_TASKS, vodSyncPoints);
+    const mfxU32 vodAtAdd = vod.numDone;
+    AddWork(pLive, live, NUM_LIVE_TASKS, liveSyncPoints);
+
+    ASSERT_EQ(MFX_ERR_NONE, pLive->Synchronize(liveSyncPoints.back(), 10000));
+    ASSERT_EQ(MFX_ERR_NONE, pVod->Synchronize(vodSyncPoints.back(), 10000));
+    ASSERT_EQ(MFX_ERR_NONE, pLive->WaitForAllTasksCompletion(&live));
+    ASSERT_EQ(MFX_ERR_NONE, pVod->WaitForAllTasksCompletion(&vod));
+
+    // only the best effort tasks, which were running, are done meanwhile
+    const mfxU32 numPoolThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    EXPECT_GE(vodAtAdd + numPoolThreads, live.otherAtLast);
+    EXPECT_GT((mfxU32) NUM_VOD_TASKS, live.otherAtLast);
+
+    pLive->Release();
+    pVod->Release();
+}
+
+// The best effort session is not starved by the live session with a long backlog
+TEST(SchedulerDeadline, SharedPoolBestEffortNotStarved)
+{
+    MFXIScheduler3 *pLive = CreatePoolScheduler(LIVE_BUDGET);
+    ASSERT_NE(nullptr, pLive);
+    MFXIScheduler3 *pVod = CreatePoolScheduler(0);
+    ASSERT_NE(nullptr, pVod);
+
+    Session vod = {}, live = {};
+    vod.pOther = &live;
+    live.pOther = &vod;
+    std::vector<mfxSyncPoint> vodSyncPoints, liveSyncPoints;
+
+    AddWork(pLive, live, NUM_BACKLOG, liveSyncPoints);
+    AddWork(pVod, vod, 1, vodSyncPoints);
+
+    ASSERT_EQ(MFX_ERR_NONE, pVod->Synchronize(vodSyncPoints.back(), 10000));
+    ASSERT_EQ(MFX_ERR_NONE, pLive->Synchronize(liveSyncPoints.back(), 10000));
+    ASSERT_EQ(MFX_ERR_NONE, pLive->WaitForAllTasksCompletion(&live));
+    ASSERT_EQ(MFX_ERR_NONE, pVod->WaitForAllTasksCompletion(&vod));
+
+    // the best effort task waits for the starvation period only,
+    // not for the whole backlog of 2 * NUM_BACKLOG msec
+    EXPECT_GT((mfxU32) NUM_BACKLOG / 2, vod.otherAtFirst);
+
+    pVod->Release();
+    pLive->Release();
+}
+
+namespace
+{
+    // The task routine re-entered at the beginning re-checks the state and
+    // spins on the device until the job is done.
+    mfxStatus PollingRoutine(void *pState, void *pParam, mfxU32, mfxU32)
+    {
+        Context &ctx = *(Context *) pState;
+        Frame &frame = *(Frame *) pParam;
+
+        frame.calls += 1;
+
+        if (!frame.submitted)
+        {
+            frame.submitted = true;
+            ctx.pDevice->Submit(&frame);
+            return MFX_TASK_BUSY;
+        }
+
+        if (!frame.done)
+            return MFX_TASK_BUSY;
+
+        frame.resumed = Clock::now();
+        return MFX_TASK_DONE;
+    }
+
+    mfxStatus ResumeRoutine(void *, void *pParam, mfxU32, mfxU32)
+    {
+        Frame &frame = *(Frame *) pParam;
+
+        frame.resumes += 1;
+
+        // the continuation must not be called before the device is done
+        if (!frame.done)
+            return MFX_TASK_BUSY;
+
+        frame.resumed = Clock::now();
+        return MFX_TASK_DONE;
+    }
+
+    // The task routine suspends on the device completion and
+    // continues at ResumeRoutine.
+    mfxStatus SuspendingRoutine(void *pState, void *pParam, mfxU32, mfxU32)
+    {
+        Context &ctx = *(Context *) pState;
+        Frame &frame = *(Frame *) pParam;
+
+        frame.calls += 1;
+
+        mfxStatus sts = ctx.pScheduler->SetContinuation(pState, pParam, ResumeRoutine, frame.fd);
+        if (MFX_ERR_NONE != sts)
+            return sts;
+
+        frame.submitted = true;
+        ctx.pDevice->Submit(&frame);
+        return MFX_TASK_BUSY;
+    }
+
+    // Run frames through the fake device, return the CPU time per frame (usec)
+    long long RunSuspendingFrames(mfxTaskRoutine pRoutine, std::vector<Frame> &frames)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        EXPECT_NE(nullptr, pScheduler);
+        if (nullptr == pScheduler)
+            return 0;
+
+        MFX_SCHEDULER_PARAM2 param = {};
+        param.flags = MFX_SCHEDULER_DEFAULT;
+        param.numberOfThreads = 4;
+        EXPECT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+        std::vector<mfxSyncPoint> syncPoints(frames.size());
+        timespec start = {}, stop = {};
+
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+        {
+            FakeDevice device(pScheduler, EVENT_FD);
+            Context ctx = { pScheduler, &device, EVENT_FD };
+
+            for (mfxU32 i = 0; i < frames.size(); i++)
+            {
+                Frame &frame = frames[i];
+
+                frame.fd = eventfd(0, EFD_CLOEXEC);
+                EXPECT_LE(0, frame.fd);
+                frame.submitted = false;
+                frame.done = false;
+                frame.calls = 0;
+                frame.resumes = 0;
+
+                MFX_TASK task = {};
+                task.pOwner = &device;
+                task.threadingPolicy = MFX_TASK_THREADING_DEDICATED;
+                task.priority = MFX_PRIORITY_NORMAL;
+                task.entryPoint.pRoutine = pRoutine;
+                task.entryPoint.pState = &ctx;
+                task.entryPoint.pParam = &frame;
+                task.entryPoint.requiredNumThreads = 1;
+                task.pDst[0] = &frame;
+
+                EXPECT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoints[i]));
+
+                if (i >= ASYNC_DEPTH)
+                {
+                    EXPECT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i - ASYNC_DEPTH], 10000));
+                }
+            }
+
+            for (size_t i = frames.size() - ASYNC_DEPTH; i < frames.size(); i++)
+                EXPECT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoints[i], 10000));
+        }
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &stop);
+
+        pScheduler->Release();
+
+        for (auto & frame : frames)
+            close(frame.fd);
+
+        const long long usec = (stop.tv_sec - start.tv_sec) * 1000000ll + (stop.tv_nsec - start.tv_nsec) / 1000;
+        return usec / (long long) frames.size();
+    }
+}
+
+// The suspended task is called once at the continuation after the device
+// is done, the entry routine is not re-entered. The CPU time per frame is
+// compared with the task re-entered at the beginning until the device is done.
+TEST(SchedulerContinuation, ResumeOnCompletion)
+{
+    std::vector<Frame> polled(NUM_FRAMES), suspended(NUM_FRAMES);
+
+    const long long cpuPolling = RunSuspendingFrames(PollingRoutine, polled);
+    const long long cpuSuspending = RunSuspendingFrames(SuspendingRoutine, suspended);
+
+    for (auto & frame : suspended)
+    {
+        EXPECT_TRUE(frame.done);
+        EXPECT_EQ(1u, frame.calls);
+        EXPECT_EQ(1u, frame.resumes);
+    }
+    for (auto & frame : polled)
+    {
+        EXPECT_TRUE(frame.done);
+        EXPECT_LE(2u, frame.calls);
+    }
+
+    ::testing::Test::RecordProperty("cpu_usec_per_frame_polling", (int) cpuPolling);
+    ::testing::Test::RecordProperty("cpu_usec_per_frame_continuation", (int) cpuSuspending);
+    EXPECT_GT(cpuPolling, cpuSuspending);
+}
+
+namespace
+{
+    struct ContinuedTask
+    {
+        std::atomic<mfxU32> numEntered;
+        // the status of the first SetContinuation call
+        std::atomic<int> sts;
+    };
+
+    mfxStatus ContinuedRoutine(void *pState, void *pParam, mfxU32, mfxU32)
+    {
+        MFXIScheduler3 *pScheduler = (MFXIScheduler3 *) pState;
+        ContinuedTask &ctx = *(ContinuedTask *) pParam;
+
+        // both threads are inside the routine, the task is not done by either
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        ctx.numEntered += 1;
+        while (ctx.numEntered < 2 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        int unset = INT_MIN;
+        ctx.sts.compare_exchange_strong(unset, pScheduler->SetContinuation(pState, pParam, ResumeRoutine, -1));
+        return MFX_TASK_DONE;
+    }
+}
+
+// The routine of the task run by several threads at once can't be replaced
+TEST(SchedulerContinuation, MultipleThreadsUnsupported)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SCHEDULER_DEFAULT;
+    param.numberOfThreads = 4;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    ContinuedTask ctx;
+    ctx.numEntered = 0;
+    ctx.sts = INT_MIN;
+
+    // unknown tasks have no continuation
+    EXPECT_EQ(MFX_ERR_NOT_FOUND, pScheduler->SetContinuation(pScheduler, &ctx, ResumeRoutine, -1));
+
+    MFX_TASK task = {};
+    task.pOwner = &ctx;
+    task.threadingPolicy = MFX_TASK_THREADING_INTER;
+    task.priority = MFX_PRIORITY_NORMAL;
+    task.entryPoint.pRoutine = ContinuedRoutine;
+    task.entryPoint.pState = pScheduler;
+    task.entryPoint.pParam = &ctx;
+    task.entryPoint.requiredNumThreads = 2;
+
+    mfxSyncPoint syncPoint = NULL;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoint));
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoint, 10000));
+    EXPECT_EQ(MFX_ERR_UNSUPPORTED, ctx.sts);
+
+    pScheduler->Release();
+}
+
+namespace
+{
+    void RunOneTask(MFXIScheduler *pScheduler)
+    {
+        std::vector<mfxU32> order;
+
+        MFX_TASK task = {};
+        task.pOwner = &order;
+        task.threadingPolicy = MFX_TASK_THREADING_INTER;
+        task.priority = MFX_PRIORITY_NORMAL;
+        task.entryPoint.pRoutine = RecordRoutine;
+        task.entryPoint.pState = &order;
+        task.entryPoint.pParam = (void *) (size_t) 1;
+        task.entryPoint.requiredNumThreads = 1;
+
+        mfxSyncPoint syncPoint = NULL;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->AddTask(task, &syncPoint));
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Synchronize(syncPoint, 10000));
+        EXPECT_EQ(1u, order.size());
+    }
+}
+
+// A single pool thread could dead lock the session, it gets a private pool
+TEST(SchedulerPool, SingleThreadFallsBackToPrivatePool)
+{
+    MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+    ASSERT_NE(nullptr, pScheduler);
+
+    MFX_SCHEDULER_PARAM2 param = {};
+    param.flags = MFX_SCHEDULER_SHARED_POOL;
+    param.numberOfThreads = 4;
+    param.params.NumThread = 1;
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+    MFX_SCHEDULER_PARAM actual = {};
+    ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetParam(&actual));
+    EXPECT_EQ(MFX_SCHEDULER_DEFAULT, actual.flags);
+    EXPECT_EQ(2u, actual.numberOfThreads);
+
+    RunOneTask(pScheduler);
+
+    pScheduler->Release();
+}
+
+#if (MFX_VERSION >= MFX_VERSION_NEXT)
+// mfxExtThreadsParam::SharedPool selects the pool of the session
+TEST(SchedulerPool, SelectedBySession)
+{
+    const mfxU16 modes[] = { MFX_CODINGOPTION_ON, MFX_CODINGOPTION_OFF };
+
+    // the session's choice overrides the environment variable
+    ASSERT_EQ(0, setenv("MFX_SCHEDULER_SHARED_POOL", "1", 1));
+
+    for (mfxU16 mode : modes)
+    {
+        MFXIScheduler3 *pScheduler = CreateInterfaceInstance<MFXIScheduler3>(MFXIScheduler3_GUID);
+        ASSERT_NE(nullptr, pScheduler);
+
+        MFX_SCHEDULER_PARAM2 param = {};
+        param.flags = MFX_SCHEDULER_DEFAULT;
+        param.numberOfThreads = 4;
+        param.params.SharedPool = mode;
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->Initialize2(&param));
+
+        MFX_SCHEDULER_PARAM actual = {};
+        ASSERT_EQ(MFX_ERR_NONE, pScheduler->GetParam(&actual));
+        EXPECT_EQ((MFX_CODINGOPTION_ON == mode) ? MFX_SCHEDULER_SHARED_POOL : MFX_SCHEDULER_DEFAULT, actual.flags);
+
+        RunOneTask(pScheduler);
+
+        pScheduler->Release();
+    }
+
+    ASSERT_EQ(0, unsetenv("MFX_SCHEDULER_SHARED_POOL"));
+}
+#endif
@@ -0,0 +1,295 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "stream_indexer.h"
+
+// The streams are put together from SPS, PPS and slice headers written here,
+// the indexer doesn't read slice data.
+
+namespace
+{
+    class BitWriter
+    {
+    public:
+        void PutBits(uint32_t value, uint32_t n)
+        {
+            while (n--)
+                PutBit((value >> n) & 1);
+        }
+
+        void PutBit(uint32_t bit)
+        {
+            m_byte = uint8_t((m_byte << 1) | bit);
+            if (++m_bits == 8)
+            {
+                m_data.push_back(m_byte);
+                m_byte = 0;
+                m_bits = 0;
+            }
+        }
+
+        void PutUE(uint32_t value)
+        {
+            uint32_t n = 0;
+            while ((value + 1) >> (n + 1))
+                n++;
+
+            PutBits(0, n);
+            PutBits(value + 1, n + 1);
+        }
+
+        void PutSE(int32_t value)
+        {
+            PutUE(value > 0 ? 2 * value - 1 : -2 * value);
+        }
+
+        // rbsp_trailing_bits(), then emulation prevention
+        std::vector<uint8_t> GetRBSP()
+        {
+            PutBit(1);
+            while (m_bits)
+                PutBit(0);
+
+            std::vector<uint8_t> ebsp;
+            uint32_t zeros = 0;
+
+            for (uint8_t byte : m_data)
+            {
+                if (zeros == 2 && byte <= 3)
+                {
+                    ebsp.push_back(3);
+                    zeros = 0;
+                }
+
+                ebsp.push_back(byte);
+                zeros = byte ? 0 : zeros + 1;
+            }
+
+            return ebsp;
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+        uint8_t              m_byte = 0;
+        uint32_t             m_bits = 0;
+    };
+
+    enum
+    {
+        NAL_SLICE     = 1,
+        NAL_IDR_SLICE = 5,
+        NAL_SPS       = 7,
+        NAL_PPS       = 8,
+        NAL_AUD       = 9,
+
+        SLICE_P = 5,
+        SLICE_B = 6,
+        SLICE_I = 7,
+
+        LOG2_MAX_FRAME_NUM = 4,
+        LOG2_MAX_POC_LSB   = 6
+    };
+
+    enum Structure
+    {
+        FRAME,
+        TOP,
+        BOTTOM
+    };
+
+    struct Picture
+    {
+        uint32_t  nalType;
+        uint32_t  nalRefIdc;
+        uint32_t  sliceType;
+        Structure structure;
+        uint32_t  frameNum;
+        uint32_t  pocLsb;
+    };
+
+    class AVCStream
+    {
+    public:
+        AVCStream()
+        {
+            // Main profile, level 3.0, 176x160 frames, fields allowed, POC type 0
+            BitWriter sps;
+            sps.PutBits(77, 8);
+            sps.PutBits(0, 8);
+            sps.PutBits(30, 8);
+            sps.PutUE(0);                       // seq_parameter_set_id
+            sps.PutUE(LOG2_MAX_FRAME_NUM - 4);
+            sps.PutUE(0);                       // pic_order_cnt_type
+            sps.PutUE(LOG2_MAX_POC_LSB - 4);
+            sps.PutUE(2);                       // max_num_ref_frames
+            sps.PutBit(0);                      // gaps_in_frame_num_value_allowed_flag
+            sps.PutUE(10);                      // pic_width_in_mbs_minus1
+            sps.PutUE(4);                       // pic_height_in_map_units_minus1
+            sps.PutBit(0);                      // frame_mbs_only_flag
+            sps.PutBit(0);                      // mb_adaptive_frame_field_flag
+            sps.PutBit(1);                      // direct_8x8_inference_flag
+            sps.PutBit(0);                      // frame_cropping_flag
+            sps.PutBit(0);                      // vui_parameters_present_flag
+            AddNal(NAL_SPS, 3, sps);
+
+            BitWriter pps;
+            pps.PutUE(0);                       // pic_parameter_set_id
+            pps.PutUE(0);                       // seq_parameter_set_id
+            pps.PutBit(0);                      // entropy_coding_mode_flag
+            pps.PutBit(0);                      // bottom_field_pic_order_in_frame_present_flag
+            pps.PutUE(0);                       // num_slice_groups_minus1
+            pps.PutUE(0);                       // num_ref_idx_l0_default_active_minus1
+            pps.PutUE(0);                       // num_ref_idx_l1_default_active_minus1
+            pps.PutBit(0);                      // weighted_pred_flag
+            pps.PutBits(0, 2);                  // weighted_bipred_idc
+            pps.PutSE(0);                       // pic_init_qp_minus26
+            pps.PutSE(0);                       // pic_init_qs_minus26
+            pps.PutSE(0);                       // chroma_qp_index_offset
+            pps.PutBit(1);                      // deblocking_filter_control_present_flag
+            pps.PutBit(0);                      // constrained_intra_pred_flag
+            pps.PutBit(0);                      // redundant_pic_cnt_present_flag
+            AddNal(NAL_PPS, 3, pps);
+        }
+
+        // Access unit delimiter and one slice, returns the offset of the access unit
+        size_t AddPicture(Picture const & pic)
+        {
+            size_t const offset = m_data.size();
+
+            BitWriter aud;
+            aud.PutBits(7, 3);                  // primary_pic_type, any
+            AddNal(NAL_AUD, 0, aud);
+
+            BitWriter slice;
+            slice.PutUE(0);                     // first_mb_in_slice
+            slice.PutUE(pic.sliceType);
+            slice.PutUE(0);                     // pic_parameter_set_id
+            slice.PutBits(pic.frameNum, LOG2_MAX_FRAME_NUM);
+            slice.PutBit(pic.structure != FRAME);
+            if (pic.structure != FRAME)
+                slice.PutBit(pic.structure == BOTTOM);
+            if (pic.nalType == NAL_IDR_SLICE)
+                slice.PutUE(m_idrPicId++);
+            slice.PutBits(pic.pocLsb, LOG2_MAX_POC_LSB);
+            if (pic.sliceType == SLICE_B)
+                slice.PutBit(1);                // direct_spatial_mv_pred_flag
+            if (pic.sliceType != SLICE_I)
+            {
+                slice.PutBit(0);                // num_ref_idx_active_override_flag
+                slice.PutBit(0);                // ref_pic_list_modification_flag_l0
+            }
+            if (pic.sliceType == SLICE_B)
+                slice.PutBit(0);                // ref_pic_list_modification_flag_l1
+            if (pic.nalRefIdc && pic.nalType == NAL_IDR_SLICE)
+                slice.PutBits(0, 2);            // no_output_of_prior_pics_flag, long_term_reference_flag
+            else if (pic.nalRefIdc)
+                slice.PutBit(0);                // adaptive_ref_pic_marking_mode_flag
+            slice.PutSE(0);                     // slice_qp_delta
+            slice.PutUE(1);                     // disable_deblocking_filter_idc
+            slice.PutBits(0x5a5a, 16);          // stands for macroblock data
+            AddNal(pic.nalType, pic.nalRefIdc, slice);
+
+            return offset;
+        }
+
+        std::vector<uint8_t> & GetData() { return m_data; }
+
+    private:
+        void AddNal(uint32_t type, uint32_t nalRefIdc, BitWriter & payload)
+        {
+            m_data.insert(m_data.end(), { 0, 0, 0, 1, uint8_t((nalRefIdc << 5) | type) });
+
+            std::vector<uint8_t> rbsp = payload.GetRBSP();
+            m_data.insert(m_data.end(), rbsp.begin(), rbsp.end());
+        }
+
+        std::vector<uint8_t> m_data;
+        uint32_t             m_idrPicId = 0;
+    };
+
+    struct Expected
+    {
+        size_t  offset;
+        int32_t order;
+        mfxU8   frameType;
+        mfxU8   flags;
+    };
+
+    void CheckIndex(CStreamIndex const & index, std::vector<Expected> const & expected)
+    {
+        ASSERT_EQ(expected.size(), index.GetCount());
+
+        for (mfxU32 i = 0; i < index.GetCount(); i++)
+        {
+            EXPECT_EQ(expected[i].offset,    index[i].Offset)    << "entry " << i;
+            EXPECT_EQ(expected[i].order,     index[i].Order)     << "entry " << i;
+            EXPECT_EQ(expected[i].frameType, index[i].FrameType) << "entry " << i;
+            EXPECT_EQ(expected[i].flags,     index[i].Flags)     << "entry " << i;
+        }
+    }
+
+    const mfxU8 SHOWN = STREAM_INDEX_SHOWN;
+    const mfxU8 IDR   = STREAM_INDEX_RAP | STREAM_INDEX_IDR | STREAM_INDEX_SHOWN;
+};
+
+TEST(StreamIndexerAVC, FieldPairsGiveOneEntry)
+{
+    std::unique_ptr<StreamIndexer> indexer = CreateAVCIndexer();
+    if (!indexer)
+        GTEST_SKIP();
+
+    AVCStream stream;
+    std::vector<Expected> expected;
+
+    // IDR top field with a non-IDR I bottom field, as encoders code an IDR frame
+    expected.push_back({ stream.AddPicture({ NAL_IDR_SLICE, 3, SLICE_I, TOP, 0, 0 }), 0, MFX_FRAMETYPE_I, IDR });
+    stream.AddPicture({ NAL_SLICE, 3, SLICE_I, BOTTOM, 0, 1 });
+
+    // reference P field pair
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 2, SLICE_P, TOP, 1, 8 }), 8, MFX_FRAMETYPE_P, SHOWN });
+    stream.AddPicture({ NAL_SLICE, 2, SLICE_P, BOTTOM, 1, 9 });
+
+    // non-reference B field pair, bottom field first, the frame is ordered by the top one
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 0, SLICE_B, BOTTOM, 2, 5 }), 4, MFX_FRAMETYPE_B, SHOWN });
+    stream.AddPicture({ NAL_SLICE, 0, SLICE_B, TOP, 2, 4 });
+
+    // frame picture
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 2, SLICE_P, FRAME, 2, 16 }), 16, MFX_FRAMETYPE_P, SHOWN });
+
+    // unpaired fields: same parity, then a non-reference field after a reference one
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 2, SLICE_P, TOP, 3, 24 }), 24, MFX_FRAMETYPE_P, SHOWN });
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 2, SLICE_P, TOP, 4, 32 }), 32, MFX_FRAMETYPE_P, SHOWN });
+    expected.push_back({ stream.AddPicture({ NAL_SLICE, 0, SLICE_B, BOTTOM, 5, 29 }), 29, MFX_FRAMETYPE_B, SHOWN });
+
+    // an IDR field marks the field before it unused, two IDR fields are separate entries
+    expected.push_back({ stream.AddPicture({ NAL_IDR_SLICE, 3, SLICE_I, TOP, 0, 0 }), 0, MFX_FRAMETYPE_I, IDR });
+    expected.push_back({ stream.AddPicture({ NAL_IDR_SLICE, 3, SLICE_I, BOTTOM, 0, 0 }), 0, MFX_FRAMETYPE_I, IDR });
+
+    // the first entry starts at the parameter sets
+    expected[0].offset = 0;
+
+    CStreamIndex index;
+    ASSERT_EQ(MFX_ERR_NONE, indexer->Run(stream.GetData().data(), stream.GetData().size(), index));
+
+    CheckIndex(index, expected);
+}
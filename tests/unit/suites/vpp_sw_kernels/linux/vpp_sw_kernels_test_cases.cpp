@@ -0,0 +1,685 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mfx_vpp_sw_scale.h"
+#include "mfx_vpp_sw_composite.h"
+
+using namespace MfxSwVideoProcessing;
+
+// The AVX2 row kernels of the software VPP must match the C ones bit-exactly.
+// Frame tests run the kernels selected for the CPU against a model of RowScaler
+// built from the C kernels, with odd sizes and crop offsets of the planes.
+namespace
+{
+    enum
+    {
+        PAD         = 32,       // samples after the row, for the vector tails
+        GUARD       = 0x5a5a,   // untouched samples of the outputs
+        GUARD8      = 0x5a
+    };
+
+    const ScaleMethod METHODS[] = { SCALE_NEAREST, SCALE_BILINEAR, SCALE_BICUBIC, SCALE_LANCZOS };
+
+    // source and destination sizes: shorter than a vector, odd, up and down scaling, identity
+    const mfxU32 SIZES[][2] =
+    {
+        { 1, 9 }, { 9, 1 }, { 5, 7 }, { 7, 5 }, { 17, 31 }, { 31, 17 }, { 33, 33 }, { 45, 13 }, { 13, 45 }, { 3, 64 }, { 67, 3 }
+    };
+
+    // first samples of the source rows
+    const mfxU32 OFFSETS[] = { 0, 1, 3 };
+
+    mfxU32 Align(mfxU32 x, mfxU32 align)
+    {
+        return (x + align - 1) & ~(align - 1);
+    }
+
+    class VppSwKernels : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            if (!__builtin_cpu_supports("avx2"))
+                GTEST_SKIP();
+        }
+
+        // Q14 samples, a part of the rows alternates between black and white
+        // to make the filters overshoot and saturate
+        void Fill(std::vector<mfxI16> & row, mfxI32 min = 0, mfxI32 max = SCALE_MAX)
+        {
+            std::uniform_int_distribution<mfxI32> sample(min, max);
+            const bool edges = m_random() & 1;
+
+            for (size_t x = 0; x < row.size(); x++)
+                row[x] = (mfxI16)(edges ? ((x & 1) ? max : min) : sample(m_random));
+        }
+
+        std::mt19937 m_random{ 36 };
+    };
+
+    // One plane of an NV12 frame with random content, pitch isn't a multiple of the vectors
+    struct Frame
+    {
+        Frame(mfxU16 width, mfxU16 height, const mfxU16 crop[4])
+            : buffer((width + 13) * height * 3 / 2, GUARD8)
+        {
+            info = mfxFrameInfo();
+            info.FourCC = MFX_FOURCC_NV12;
+            info.ChromaFormat = MFX_CHROMAFORMAT_YUV420;
+            info.Width  = width;
+            info.Height = height;
+            info.CropX  = crop[0];
+            info.CropY  = crop[1];
+            info.CropW  = crop[2];
+            info.CropH  = crop[3];
+
+            data = mfxFrameData();
+            data.PitchLow = (mfxU16)(width + 13);
+            data.Y  = buffer.data();
+            data.UV = buffer.data() + data.PitchLow * height;
+        }
+
+        void Fill(std::mt19937 & random)
+        {
+            for (mfxU8 & sample : buffer)
+                sample = (mfxU8)random();
+        }
+
+        std::vector<mfxU8> buffer;
+        mfxFrameInfo       info;
+        mfxFrameData       data;
+    };
+
+    void LoadPlaneRow(Plane const & plane, const mfxU8 * base, mfxU32 row, mfxI16 * dst)
+    {
+        for (mfxU32 x = 0; x < plane.width; x++)
+            dst[x] = (mfxI16)(base[row * plane.pitch + x * plane.step] << (SCALE_BITS - 8));
+    }
+
+    // Source row in Q14, rows of the field dropped by deinterlacing are interpolated with the C kernels
+    void LoadRow(Plane const & plane, mfxU32 row, DeinterlaceMethod deinterlace, mfxI16 * dst)
+    {
+        if (plane.field < 0 || (mfxI32)(row & 1) == plane.field || plane.height == 1)
+        {
+            LoadPlaneRow(plane, plane.ptr, row, dst);
+            return;
+        }
+
+        enum { ABOVE, BELOW, CUR, REF, REF_ABOVE, REF_BELOW, NUM_ROWS };
+
+        const mfxU32 width = plane.width;
+        const mfxU32 above = row ? row - 1 : row + 1;
+        const mfxU32 below = (row + 1 < plane.height) ? row + 1 : row - 1;
+        const mfxU32 index[NUM_ROWS] = { above, below, row, row, above, below };
+
+        // samples at -1 and width replicate the edges
+        std::vector<std::vector<mfxI16> > rows(NUM_ROWS, std::vector<mfxI16>(width + 2));
+        const mfxI16 * r[NUM_ROWS];
+
+        for (mfxU32 i = 0; i < NUM_ROWS; i++)
+        {
+            if (i >= REF && !plane.ref)
+                break;
+
+            LoadPlaneRow(plane, i >= REF ? plane.ref : plane.ptr, index[i], &rows[i][1]);
+            rows[i][0] = rows[i][1];
+            rows[i][width + 1] = rows[i][width];
+            r[i] = &rows[i][1];
+        }
+
+        if (DI_BOB == deinterlace)
+        {
+            for (mfxU32 x = 0; x < width; x++)
+                dst[x] = (mfxI16)((r[ABOVE][x] + r[BELOW][x] + 1) >> 1);
+        }
+        else if (!plane.ref)
+        {
+            InterpolateRowELA_C(r[ABOVE], r[BELOW], dst, width);
+        }
+        else
+        {
+            InterpolateRowMA_C(r[ABOVE], r[BELOW], r[CUR], r[REF], r[REF_ABOVE], r[REF_BELOW], dst, width, plane.first);
+        }
+    }
+
+    // RowScaler with the C kernels: every source row is filtered horizontally, then the rows are filtered vertically
+    std::vector<mfxI16> ScaleChannel(Geometry::Channel const & channel, Plane const & src, DeinterlaceMethod deinterlace = DI_NONE)
+    {
+        Filter const & h = channel.h;
+        Filter const & v = channel.v;
+
+        std::vector<std::vector<mfxI16> > rows(v.srcSize);
+        std::vector<mfxI16> load(src.width + h.taps);
+
+        for (mfxU32 y = 0; y < v.srcSize; y++)
+        {
+            LoadRow(src, y, deinterlace, load.data());
+            std::fill(load.begin() + src.width, load.end(), load[src.width - 1]);
+
+            rows[y].resize(h.dstSize);
+
+            if (h.identity)
+                std::copy(load.begin(), load.begin() + h.dstSize, rows[y].begin());
+            else
+                FilterRowH_C(load.data(), rows[y].data(), h.dstSize, h.offset.data(), h.coef.data(), h.taps);
+        }
+
+        std::vector<mfxI16> dst(v.dstSize * h.dstSize);
+        std::vector<const mfxI16 *> taps(v.taps);
+
+        for (mfxU32 y = 0; y < v.dstSize; y++)
+        {
+            if (v.identity)
+            {
+                std::copy(rows[y].begin(), rows[y].end(), dst.begin() + y * h.dstSize);
+                continue;
+            }
+
+            for (mfxU32 k = 0; k < v.taps; k++)
+                taps[k] = rows[std::min(v.offset[y] + k, v.srcSize - 1)].data();
+
+            FilterRowV_C(taps.data(), &dst[y * h.dstSize], h.dstSize, &v.coef[y * v.taps], v.taps);
+        }
+
+        return dst;
+    }
+
+    // Compares 8-bit samples of the plane with the Q14 ones of the model
+    void CheckPlane(Plane const & plane, std::vector<mfxI16> const & expected, const char * name)
+    {
+        std::vector<mfxU8> row(plane.width);
+
+        for (mfxU32 y = 0; y < plane.height; y++)
+        {
+            StoreRow8_C(&expected[y * plane.width], row.data(), plane.width);
+
+            for (mfxU32 x = 0; x < plane.width; x++)
+                ASSERT_EQ(row[x], plane.ptr[y * plane.pitch + x * plane.step]) << name << " at " << x << ", " << y;
+        }
+    }
+
+    // Samples of the output frame outside of the crop keep the guard value
+    void CheckGuard(Frame const & frame)
+    {
+        const mfxU16 crop[4] = { frame.info.CropX, frame.info.CropY, frame.info.CropW, frame.info.CropH };
+        const mfxU32 pitch = frame.data.PitchLow;
+
+        for (mfxU32 c = 0; c < 3; c++)
+        {
+            mfxU32 rect[4];
+            GetComponentRect(MFX_FOURCC_NV12, crop, c, rect);
+
+            const mfxU8 * base = c ? frame.data.UV + (c - 1) : frame.data.Y;
+            const mfxU32 step   = c ? 2 : 1;
+            const mfxU32 width  = c ? frame.info.Width / 2 : frame.info.Width;
+            const mfxU32 height = c ? frame.info.Height / 2 : frame.info.Height;
+
+            for (mfxU32 y = 0; y < height; y++)
+            {
+                for (mfxU32 x = 0; x < width; x++)
+                {
+                    const bool inside = x >= rect[0] && x < rect[0] + rect[2] && y >= rect[1] && y < rect[1] + rect[3];
+
+                    if (!inside)
+                    {
+                        ASSERT_EQ(GUARD8, base[y * pitch + x * step]) << "component " << c << " at " << x << ", " << y;
+                    }
+                }
+            }
+        }
+    }
+};
+
+TEST_F(VppSwKernels, FilterRowHAVX2MatchesC)
+{
+    for (ScaleMethod method : METHODS)
+    {
+        for (auto const & size : SIZES)
+        {
+            for (mfxU32 offset : OFFSETS)
+            {
+                Filter filter;
+                BuildFilter(filter, size[0], size[1], method, true);
+
+                // the last taps of the outputs may go past the source, as the padded rows of RowScaler allow
+                std::vector<mfxI16> src(offset + std::max(size[0], filter.taps) + PAD);
+                Fill(src);
+
+                const mfxU32 aligned = Align(size[1], 8);
+                std::vector<mfxI16> refC(aligned + PAD, (mfxI16)GUARD);
+                std::vector<mfxI16> avx2(aligned + PAD, (mfxI16)GUARD);
+
+                FilterRowH_C(src.data() + offset, refC.data(), size[1], filter.offset.data(), filter.coef.data(), filter.taps);
+                FilterRowH_AVX2(src.data() + offset, avx2.data(), size[1], filter.offset.data(), filter.coef.data(), filter.taps);
+
+                for (mfxU32 x = 0; x < size[1]; x++)
+                    ASSERT_EQ(refC[x], avx2[x]) << "method " << method << ", " << size[0] << " -> " << size[1] << ", offset " << offset << ", x " << x;
+
+                for (mfxU32 x = aligned; x < avx2.size(); x++)
+                    ASSERT_EQ((mfxI16)GUARD, avx2[x]) << "written past the aligned width at " << x;
+            }
+        }
+    }
+}
+
+TEST_F(VppSwKernels, FilterRowVAVX2MatchesC)
+{
+    const mfxU32 widths[] = { 1, 7, 16, 17, 33, 45 };
+
+    for (ScaleMethod method : METHODS)
+    {
+        for (auto const & size : SIZES)
+        {
+            Filter filter;
+            BuildFilter(filter, size[0], size[1], method, false);
+
+            for (mfxU32 width : widths)
+            {
+                for (mfxU32 offset : OFFSETS)
+                {
+                    // horizontally filtered rows overshoot [0, SCALE_MAX]
+                    std::vector<std::vector<mfxI16> > rows(size[0], std::vector<mfxI16>(offset + Align(width, 16) + PAD));
+                    for (auto & row : rows)
+                        Fill(row, -2048, SCALE_MAX + 2048);
+
+                    const mfxU32 aligned = Align(width, 16);
+
+                    for (mfxU32 y = 0; y < size[1]; y++)
+                    {
+                        std::vector<const mfxI16 *> taps(filter.taps);
+                        for (mfxU32 k = 0; k < filter.taps; k++)
+                            taps[k] = rows[std::min(filter.offset[y] + k, size[0] - 1)].data() + offset;
+
+                        std::vector<mfxI16> refC(aligned + PAD, (mfxI16)GUARD);
+                        std::vector<mfxI16> avx2(aligned + PAD, (mfxI16)GUARD);
+
+                        FilterRowV_C(taps.data(), refC.data(), width, &filter.coef[y * filter.taps], filter.taps);
+                        FilterRowV_AVX2(taps.data(), avx2.data(), width, &filter.coef[y * filter.taps], filter.taps);
+
+                        for (mfxU32 x = 0; x < width; x++)
+                            ASSERT_EQ(refC[x], avx2[x]) << "method " << method << ", " << size[0] << " -> " << size[1] << ", width " << width << ", row " << y << ", x " << x;
+
+                        for (mfxU32 x = aligned; x < avx2.size(); x++)
+                            ASSERT_EQ((mfxI16)GUARD, avx2[x]) << "written past the aligned width at " << x;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(VppSwKernels, LoadStoreRow8AVX2MatchesC)
+{
+    for (mfxU32 width = 1; width <= 70; width++)
+    {
+        for (mfxU32 offset : OFFSETS)
+        {
+            std::vector<mfxU8> src(offset + width + PAD);
+            for (mfxU8 & sample : src)
+                sample = (mfxU8)m_random();
+
+            std::vector<mfxI16> loadC(width + PAD, (mfxI16)GUARD);
+            std::vector<mfxI16> loadAVX2(width + PAD, (mfxI16)GUARD);
+
+            LoadRow8_C(src.data() + offset, loadC.data(), width);
+            LoadRow8_AVX2(src.data() + offset, loadAVX2.data(), width);
+
+            ASSERT_EQ(loadC, loadAVX2) << "width " << width << ", offset " << offset;
+
+            // output of the vertical filter is clipped, of the horizontal one is not
+            std::vector<mfxI16> row(offset + width);
+            Fill(row, -32768, 32767);
+
+            std::vector<mfxU8> storeC(width + PAD, GUARD8);
+            std::vector<mfxU8> storeAVX2(width + PAD, GUARD8);
+
+            StoreRow8_C(row.data() + offset, storeC.data(), width);
+            StoreRow8_AVX2(row.data() + offset, storeAVX2.data(), width);
+
+            ASSERT_EQ(storeC, storeAVX2) << "width " << width << ", offset " << offset;
+        }
+    }
+}
+
+TEST_F(VppSwKernels, FrameScalerMatchesModel)
+{
+    struct
+    {
+        mfxU16 inSize[2];
+        mfxU16 inCrop[4];
+        mfxU16 outSize[2];
+        mfxU16 outCrop[4];
+    } const cases[] =
+    {
+        // downscaling, odd crop offsets and sizes, chroma is rounded outwards
+        { { 96, 64 },  { 3, 5, 61, 37 }, { 80, 48 },   { 1, 3, 45, 29 } },
+        // upscaling to several regions of rows
+        { { 64, 48 },  { 1, 1, 33, 17 }, { 128, 160 }, { 5, 7, 99, 141 } },
+        // identity, the crop is moved
+        { { 64, 32 },  { 3, 1, 45, 27 }, { 64, 32 },   { 7, 5, 45, 27 } },
+        // horizontal only, vertical only
+        { { 64, 32 },  { 0, 0, 63, 31 }, { 96, 32 },   { 1, 0, 81, 31 } },
+        { { 64, 32 },  { 0, 0, 63, 31 }, { 64, 80 },   { 0, 1, 63, 77 } },
+    };
+
+    for (ScaleMethod method : METHODS)
+    {
+        for (auto const & test : cases)
+        {
+            Frame in(test.inSize[0], test.inSize[1], test.inCrop);
+            Frame out(test.outSize[0], test.outSize[1], test.outCrop);
+            in.Fill(m_random);
+
+            FrameScaler scaler;
+            scaler.Init(method, false, false);
+
+            std::shared_ptr<const Geometry> geometry = scaler.GetGeometry(in.info, out.info);
+
+            for (mfxU32 region = 0; region < geometry->numRegions; region++)
+                FrameScaler::Run(*geometry, in.data, out.data, region);
+
+            for (mfxU32 c = 0; c < 3; c++)
+            {
+                Plane src = GetPlane(in.data, MFX_FOURCC_NV12, test.inCrop, c);
+                Plane dst = GetPlane(out.data, MFX_FOURCC_NV12, test.outCrop, c);
+
+                SCOPED_TRACE(testing::Message() << "method " << method << ", crop " << test.inCrop[2] << "x" << test.inCrop[3]
+                    << " -> " << test.outCrop[2] << "x" << test.outCrop[3] << ", component " << c);
+
+                CheckPlane(dst, ScaleChannel(geometry->channels[c], src), "sample");
+
+                // identity is lossless
+                if (test.inCrop[2] == test.outCrop[2] && test.inCrop[3] == test.outCrop[3])
+                {
+                    for (mfxU32 y = 0; y < dst.height; y++)
+                    {
+                        for (mfxU32 x = 0; x < dst.width; x++)
+                            ASSERT_EQ(src.ptr[y * src.pitch + x * src.step], dst.ptr[y * dst.pitch + x * dst.step]);
+                    }
+                }
+            }
+
+            CheckGuard(out);
+        }
+    }
+}
+
+TEST_F(VppSwKernels, BlendRowAVX2MatchesC)
+{
+    for (mfxU32 width = 1; width <= 70; width++)
+    {
+        for (mfxU32 offset : OFFSETS)
+        {
+            std::vector<mfxI16> src(offset + width), dst(offset + width), alpha(offset + width);
+
+            // rows of a layer scaled only horizontally aren't clipped to [0, SCALE_MAX]
+            Fill(src, -2048, SCALE_MAX + 2048);
+            Fill(dst, -2048, SCALE_MAX + 2048);
+            Fill(alpha, 0, SCALE_ONE);
+
+            // transparent and opaque samples
+            alpha[offset] = 0;
+            alpha[offset + width - 1] = SCALE_ONE;
+
+            std::vector<mfxI16> refC(dst), avx2(dst);
+            refC.resize(offset + width + PAD, (mfxI16)GUARD);
+            avx2.resize(offset + width + PAD, (mfxI16)GUARD);
+
+            BlendRow_C(src.data() + offset, alpha.data() + offset, refC.data() + offset, width);
+            BlendRow_AVX2(src.data() + offset, alpha.data() + offset, avx2.data() + offset, width);
+
+            ASSERT_EQ(refC, avx2) << "width " << width << ", offset " << offset;
+        }
+    }
+}
+
+TEST_F(VppSwKernels, FrameCompositorMatchesModel)
+{
+    struct Stream
+    {
+        mfxU16 inSize[2];
+        mfxU16 inCrop[4];
+        mfxU16 dst[4];
+        mfxU16 globalAlpha;     // 0 if disabled
+    } const streams[] =
+    {
+        // opaque, covers the crop of the output
+        { { 64, 48 }, { 1, 0, 63, 47 }, { 0, 0, 96, 100 }, 0 },
+        // odd rectangle, scaled vertically only
+        { { 64, 48 }, { 3, 1, 41, 27 }, { 13, 7, 41, 19 }, 100 },
+        // crosses the stripes and the crop of the output, scaled horizontally only
+        { { 48, 32 }, { 1, 3, 31, 21 }, { 50, 61, 45, 21 }, 200 },
+        // starts left of the crop
+        { { 48, 32 }, { 0, 0, 48, 32 }, { 0, 80, 17, 15 }, 255 },
+    };
+
+    const mfxU32 numStreams = sizeof(streams) / sizeof(streams[0]);
+    const mfxU16 outCrop[4] = { 1, 3, 93, 95 };
+
+    std::vector<mfxVPPCompInputStream> inputs(numStreams);
+    std::vector<std::unique_ptr<Frame> > in(numStreams);
+    std::vector<mfxFrameInfo const *> inInfo(numStreams);
+    std::vector<mfxFrameData const *> inData(numStreams);
+
+    for (mfxU32 i = 0; i < numStreams; i++)
+    {
+        inputs[i] = mfxVPPCompInputStream();
+        inputs[i].DstX = streams[i].dst[0];
+        inputs[i].DstY = streams[i].dst[1];
+        inputs[i].DstW = streams[i].dst[2];
+        inputs[i].DstH = streams[i].dst[3];
+        inputs[i].GlobalAlphaEnable = streams[i].globalAlpha ? 1 : 0;
+        inputs[i].GlobalAlpha = streams[i].globalAlpha;
+
+        in[i].reset(new Frame(streams[i].inSize[0], streams[i].inSize[1], streams[i].inCrop));
+        in[i]->Fill(m_random);
+
+        // sharp edges make the layers scaled in one direction overshoot
+        for (mfxU32 x = 0; x < in[i]->data.PitchLow; x += 2)
+            in[i]->data.Y[x] = 255;
+
+        inInfo[i] = &in[i]->info;
+        inData[i] = &in[i]->data;
+    }
+
+    mfxExtVPPComposite composite = {};
+    composite.Y = 16;
+    composite.U = 128;
+    composite.V = 128;
+    composite.NumInputStream = (mfxU16)numStreams;
+    composite.InputStream = inputs.data();
+
+    for (ScaleMethod method : METHODS)
+    {
+        SCOPED_TRACE(testing::Message() << "method " << method);
+
+        Frame out(96, 100, outCrop);
+
+        ASSERT_EQ(MFX_ERR_NONE, FrameCompositor::CheckParams(composite, out.info));
+
+        FrameCompositor compositor;
+        compositor.Init(method, false, false, composite);
+
+        std::shared_ptr<const Composition> composition = compositor.GetComposition(inInfo.data(), out.info);
+        ASSERT_LT(1u, composition->canvas.numRegions);
+
+        for (mfxU32 region = 0; region < composition->canvas.numRegions; region++)
+            FrameCompositor::Run(*composition, inData.data(), out.data, region);
+
+        for (mfxU32 c = 0; c < 3; c++)
+        {
+            SCOPED_TRACE(testing::Message() << "component " << c);
+
+            mfxU32 canvas[4];
+            GetComponentRect(MFX_FOURCC_NV12, outCrop, c, canvas);
+
+            std::vector<mfxI16> expected(canvas[2] * canvas[3], composition->background[c]);
+
+            for (mfxU32 i = 0; i < numStreams; i++)
+            {
+                Layer const & layer = *composition->layers[i];
+                Geometry const & geometry = *layer.geometry;
+
+                mfxU32 rect[4];
+                GetComponentRect(MFX_FOURCC_NV12, layer.dst, c, rect);
+
+                std::vector<mfxI16> scaled = ScaleChannel(geometry.channels[c], GetPlane(in[i]->data, MFX_FOURCC_NV12, geometry.inCrop, c));
+
+                // chroma opacity is the average of the luma one, which is global alpha
+                const mfxI16 alpha = (mfxI16)layer.globalAlpha;
+
+                for (mfxU32 y = std::max(rect[1], canvas[1]); y < std::min(rect[1] + rect[3], canvas[1] + canvas[3]); y++)
+                {
+                    for (mfxU32 x = std::max(rect[0], canvas[0]); x < std::min(rect[0] + rect[2], canvas[0] + canvas[2]); x++)
+                    {
+                        const mfxI16 & sample = scaled[(y - rect[1]) * rect[2] + x - rect[0]];
+                        mfxI16 & dst = expected[(y - canvas[1]) * canvas[2] + x - canvas[0]];
+
+                        if (layer.opaque)
+                            dst = sample;
+                        else
+                            BlendRow_C(&sample, &alpha, &dst, 1);
+                    }
+                }
+            }
+
+            CheckPlane(GetPlane(out.data, MFX_FOURCC_NV12, outCrop, c), expected, "sample");
+        }
+
+        CheckGuard(out);
+    }
+}
+
+TEST_F(VppSwKernels, InterpolateRowAVX2MatchesC)
+{
+    for (mfxU32 width = 1; width <= 70; width++)
+    {
+        for (mfxU32 offset : OFFSETS)
+        {
+            // rows are readable at [-1, width]
+            std::vector<std::vector<mfxI16> > rows(6, std::vector<mfxI16>(offset + width + 2 + PAD));
+            const mfxI16 * r[6];
+
+            for (mfxU32 i = 0; i < 6; i++)
+            {
+                Fill(rows[i]);
+                r[i] = rows[i].data() + offset + 1;
+            }
+
+            // static areas take the temporal prediction
+            for (mfxU32 x = 0; x < width; x += 3)
+            {
+                rows[3][offset + 1 + x] = rows[2][offset + 1 + x];
+                rows[4][offset + 1 + x] = rows[0][offset + 1 + x];
+                rows[5][offset + 1 + x] = rows[1][offset + 1 + x];
+            }
+
+            std::vector<mfxI16> refC(width + PAD, (mfxI16)GUARD);
+            std::vector<mfxI16> avx2(width + PAD, (mfxI16)GUARD);
+
+            InterpolateRowELA_C(r[0], r[1], refC.data(), width);
+            InterpolateRowELA_AVX2(r[0], r[1], avx2.data(), width);
+
+            ASSERT_EQ(refC, avx2) << "ELA, width " << width << ", offset " << offset;
+
+            for (bool first : { true, false })
+            {
+                InterpolateRowMA_C(r[0], r[1], r[2], r[3], r[4], r[5], refC.data(), width, first);
+                InterpolateRowMA_AVX2(r[0], r[1], r[2], r[3], r[4], r[5], avx2.data(), width, first);
+
+                ASSERT_EQ(refC, avx2) << "MA, width " << width << ", offset " << offset << ", first " << first;
+            }
+        }
+    }
+}
+
+TEST_F(VppSwKernels, FrameScalerDeinterlaceMatchesModel)
+{
+    struct
+    {
+        mfxU16 inCrop[4];
+        mfxU16 outCrop[4];
+    } const cases[] =
+    {
+        // odd crop offset flips the parity of the plane rows, widths are odd
+        { { 3, 1, 45, 27 }, { 7, 5, 45, 27 } },
+        { { 0, 2, 61, 45 }, { 1, 0, 61, 45 } },
+        // deinterlaced rows are scaled
+        { { 1, 3, 53, 41 }, { 3, 1, 37, 57 } },
+    };
+
+    for (DeinterlaceMethod deinterlace : { DI_BOB, DI_ADVANCED })
+    {
+        for (auto const & test : cases)
+        {
+            Frame prev(64, 48, test.inCrop);
+            Frame in(64, 48, test.inCrop);
+            prev.Fill(m_random);
+            in.Fill(m_random);
+
+            // a half of the frame is static
+            std::copy(prev.buffer.begin(), prev.buffer.begin() + prev.buffer.size() / 2, in.buffer.begin());
+
+            for (mfxU32 parity = 0; parity < 2; parity++)
+            {
+                for (bool first : { true, false })
+                {
+                    for (mfxFrameData const * ref : { (mfxFrameData const *)0, (mfxFrameData const *)&prev.data })
+                    {
+                        Frame out(64, 64, test.outCrop);
+
+                        FrameScaler scaler;
+                        scaler.Init(SCALE_BICUBIC, false, false, deinterlace);
+
+                        std::shared_ptr<const Geometry> geometry = scaler.GetGeometry(in.info, out.info);
+                        const Field field = { parity, first, ref };
+
+                        for (mfxU32 region = 0; region < geometry->numRegions; region++)
+                            FrameScaler::Run(*geometry, in.data, out.data, region, &field);
+
+                        for (mfxU32 c = 0; c < 3; c++)
+                        {
+                            SCOPED_TRACE(testing::Message() << "method " << deinterlace << ", crop " << test.inCrop[0] << ", " << test.inCrop[1]
+                                << ", parity " << parity << ", first " << first << ", ref " << (ref != 0) << ", component " << c);
+
+                            mfxU32 rect[4];
+                            GetComponentRect(MFX_FOURCC_NV12, test.inCrop, c, rect);
+
+                            // parity is of the frame rows, as SetField gives it
+                            Plane src = GetPlane(in.data, MFX_FOURCC_NV12, test.inCrop, c);
+                            src.field = (mfxI32)((parity ^ rect[1]) & 1);
+                            src.first = first;
+                            src.ref   = ref ? GetPlane(*ref, MFX_FOURCC_NV12, test.inCrop, c).ptr : 0;
+
+                            CheckPlane(GetPlane(out.data, MFX_FOURCC_NV12, test.outCrop, c), ScaleChannel(geometry->channels[c], src, deinterlace), "sample");
+                        }
+
+                        CheckGuard(out);
+                    }
+                }
+            }
+        }
+    }
+}
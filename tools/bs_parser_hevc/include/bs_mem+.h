@@ -23,6 +23,9 @@
 #include <list>
 #include <set>
 #include <mutex>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <memory.h>
 
 //#define BS_MEM_TRACE
@@ -186,6 +189,21 @@ public:
         return p;
     }
 
+    // registers externally owned memory, pMem is deleted when p is freed
+    void attach(void* p, MemBase* pMem, void* base = nullptr)
+    {
+        std::unique_lock<std::recursive_mutex> _lock(m_mtx);
+        BS_MEM_TRACE_F("BS_MEM::attach(%p, %p)\n", p, base);
+
+        if (!p || !pMem || Touch(p))
+            throw std::bad_alloc();
+
+        m_mem[p].mem = pMem;
+
+        if (base)
+            bound(p, base);
+    }
+
     void free(void* p)
     {
         std::unique_lock<std::recursive_mutex> _lock(m_mtx);
@@ -297,4 +315,63 @@ public:
     }
 };
 
+// Bump allocator for objects of one type, memory is kept on reset/rewind.
+// Objects are stored in fixed-size blocks so pointers stay valid until reset.
+template<class T, unsigned int BlockSize> class Pool
+{
+private:
+    std::vector<std::unique_ptr<T[]>> m_blocks;
+    size_t       m_block;
+    unsigned int m_pos;
+
+public:
+    struct Mark
+    {
+        size_t       block;
+        unsigned int pos;
+    };
+
+    Pool()
+        : m_block(0)
+        , m_pos(0)
+    {
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    // returns n value-initialized contiguous objects
+    T* alloc(unsigned int n = 1)
+    {
+        if (n == 0)
+            return nullptr;
+
+        if (n > BlockSize)
+            throw std::bad_alloc();
+
+        if (m_block >= m_blocks.size() || m_pos + n > BlockSize)
+        {
+            if (m_block < m_blocks.size())
+                m_block++;
+
+            m_pos = 0;
+
+            if (m_block == m_blocks.size())
+                m_blocks.emplace_back(new T[BlockSize]);
+        }
+
+        T* p = m_blocks[m_block].get() + m_pos;
+        m_pos += n;
+
+        std::fill_n(p, n, T{});
+
+        return p;
+    }
+
+    inline Mark mark() const { return Mark{ m_block, m_pos }; }
+    inline void rewind(const Mark& m) { m_block = m.block; m_pos = m.pos; }
+    inline void reset() { m_block = 0; m_pos = 0; }
+    inline size_t capacity() const { return m_blocks.size() * BlockSize; }
+};
+
 };
@@ -65,6 +65,9 @@ public:
     BSErr unlock(void* p)                       { return BS_HEVC2_Unlock(hdl, p); };
     BSErr sync(void* p)                         { return BS_HEVC2_Sync(hdl, (BS_HEVC2::NALU*)p); };
     Bs16u async_depth()                         { return BS_HEVC2_GetAsyncDepth(hdl); }
+    Bs64u bin_count()                           { return BS_HEVC2_GetBinCount(hdl); }
+    BSErr set_ctu_callback(BS_HEVC2::CtuCallback cb, void* user_data)
+                                                { return BS_HEVC2_SetCtuCallback(hdl, cb, user_data); }
 
     void set_trace_level(Bs32u level)           { BS_HEVC2_SetTraceLevel(hdl, level); };
     void* get_header() { return hdr; };
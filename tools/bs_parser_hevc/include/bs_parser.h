@@ -36,6 +36,8 @@ extern "C"{
     BSErr __STDCALL BS_HEVC2_GetOffset         (BS_HEVC2::HDL hdl, Bs64u& offset);
     BSErr __STDCALL BS_HEVC2_Sync              (BS_HEVC2::HDL hdl, BS_HEVC2::NALU* slice);
     Bs16u __STDCALL BS_HEVC2_GetAsyncDepth     (BS_HEVC2::HDL hdl);
+    Bs64u __STDCALL BS_HEVC2_GetBinCount       (BS_HEVC2::HDL hdl);
+    BSErr __STDCALL BS_HEVC2_SetCtuCallback    (BS_HEVC2::HDL hdl, BS_HEVC2::CtuCallback cb, void* user_data);
 
 }
 
@@ -384,8 +384,9 @@ private:
     Bs64u m_tla;
     Bs32u m_tln;
 
-    void MoreData(Bs32u keepBytes = 4);
-    bool MoreDataNoThrow(Bs32u keepBytes = 4);
+    // keepBytes covers look-ahead returned by CABAC engine (up to 7 bytes + emulation prevention)
+    void MoreData(Bs32u keepBytes = 16);
+    bool MoreDataNoThrow(Bs32u keepBytes = 16);
 };
 
 class TLAuto
@@ -23,17 +23,67 @@
 #include "bs_reader2.h"
 #include "hevc_cabac.h"
 
-#define BS_AVC2_ADE_MODE 1 //0 - literal standard implementation, 1 - optimized(2-byte buffering affects SE offsets in trace)
+#ifndef BS_AVC2_ADE_MODE
+#define BS_AVC2_ADE_MODE 2 //0 - literal standard implementation, 1 - optimized(2-byte buffering affects SE offsets in trace), 2 - 64-bit buffering
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace COMMON_CABAC
 {
+    inline Bs32u CountLeadingZeros(Bs32u x)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return x ? __builtin_clz(x) : 32;
+#elif defined(_MSC_VER)
+        unsigned long idx;
+        return _BitScanReverse(&idx, x) ? (31 - idx) : 32;
+#else
+        Bs32u n = 0;
+        if (!x) return 32;
+        while (!(x & 0x80000000)) { x <<= 1; n++; }
+        return n;
+#endif
+    }
+
     class ADE
     {
     private:
         BsReader2::Reader& m_bs;
         Bs64u m_bpos  = 0;
         bool  m_pcm   = false;
-#if (BS_AVC2_ADE_MODE == 1)
+#if (BS_AVC2_ADE_MODE == 2)
+        Bs64u m_val   = 0; // 9-bit offset window at m_bits, lower bits are look-ahead
+        Bs32u m_range = 0;
+        Bs32s m_bits  = 0;
+
+        inline Bs32u B(Bs16u n) { m_bpos += n * 8; return m_bs.GetBytes(n, true); }
+        inline Bs64u B64(Bs16u n) { return (n > 4) ? ((Bs64u(B(n - 4)) << 32) | B(4)) : B(n); }
+
+        // fill look-ahead with as many whole bytes as fit into the register
+        inline void Refill()
+        {
+            Bs16u n = Bs16u((55 - m_bits) >> 3);
+            m_val = (m_val << (n * 8)) | B64(n);
+            m_bits += n * 8;
+        }
+
+        // keep look-ahead within 2 bytes when slice data may end, so the reader
+        // is not moved across the next start code
+        inline void TrimLookAhead()
+        {
+            if (m_bits <= 16)
+                return;
+
+            Bs32u n = Bs32u((m_bits - 9) >> 3) << 3;
+            m_bs.ReturnBits(n);
+            m_val >>= n;
+            m_bits -= n;
+            m_bpos -= n;
+        }
+#elif (BS_AVC2_ADE_MODE == 1)
         Bs32u m_val   = 0;
         Bs32u m_range = 0;
         Bs32s m_bits  = 0;
@@ -53,7 +103,14 @@ namespace COMMON_CABAC
 
         inline void Init()
         {
-            #if (BS_AVC2_ADE_MODE == 1)
+            #if (BS_AVC2_ADE_MODE == 2)
+            m_val = B64(7);
+            m_range = 510;
+            m_bits = 47;
+
+            if (!m_pcm)
+                m_bpos = 47;
+            #elif (BS_AVC2_ADE_MODE == 1)
             m_val = B(3);
             m_range = 510;
             m_bits = 15;
@@ -73,8 +130,9 @@ namespace COMMON_CABAC
         Bs8u DecodeDecision(Bs8u& ctxState);
         Bs8u DecodeBypass();
         Bs8u DecodeTerminate();
+        Bs32u DecodeBypassBins(Bs16u n); // n <= 32, first bin in MSB
 
-        #if (BS_AVC2_ADE_MODE == 1)
+        #if (BS_AVC2_ADE_MODE >= 1)
         inline Bs16u GetR() { return Bs16u(m_range); }
         inline Bs16u GetV() { return Bs16u((m_val >> (m_bits))); }
         inline Bs64u BitCount() { return m_bpos - m_bits; }
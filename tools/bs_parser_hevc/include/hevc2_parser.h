@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <memory>
 
 namespace BS_HEVC2
 {
@@ -286,6 +287,12 @@ private:
     inline bool DD(Bs16u se, Bs16s inc = 0) { BinCount++; return !!DecodeDecision(CtxState(se, inc)); }
     inline bool DT() { BinCount++; return !!DecodeTerminate(); }
     inline bool DB() { BinCount++; return !!DecodeBypass(); }
+    inline Bs32u DBN(Bs16u n)
+    {
+        if (n > 32)
+            throw BsReader2::InvalidSyntax();
+        return DecodeBypassBins(n);
+    }
 
 public:
     Bs64u BinCount = 0;
@@ -386,6 +393,7 @@ public:
     inline bool  CoeffAbsLevelGreater2Flag(Bs16u cIdx) { return DD(BS_HEVC::COEFF_ABS_LEVEL_GREATER2_FLAG, ctxSet + 4 * !!cIdx); }
            Bs32u CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu, TU& tu);
     inline bool  CoeffSignFlag()                       { return DB(); }
+    inline Bs32u CoeffSignFlags(Bs16u n)               { BinCount += n; return DBN(n); }
 
     //palette_coding()
     inline Bs8u  PalettePredictorRun()              { return (Bs8u)EGkBypass(0); }
@@ -403,17 +411,94 @@ public:
            Bs16u PaletteEscapeVal(Bs16u cIdx, bool cu_transquant_bypass_flag);
 };
 
+// Per-picture storage for slice data, each node type has its own pool.
+// Arena is reset and reused for next picture instead of freeing node by node.
+struct PicArena
+{
+    BS_MEM::Pool<CTU,   256>       ctu;
+    BS_MEM::Pool<CU,    4096>      cu;
+    BS_MEM::Pool<PU,    4096>      pu;
+    BS_MEM::Pool<TU,    8192>      tu;
+    BS_MEM::Pool<Bs32s, 64 * 1024> tc;
+
+    inline BS_MEM::Pool<CTU,   256>&       pool(CTU*)   { return ctu; }
+    inline BS_MEM::Pool<CU,    4096>&      pool(CU*)    { return cu; }
+    inline BS_MEM::Pool<PU,    4096>&      pool(PU*)    { return pu; }
+    inline BS_MEM::Pool<TU,    8192>&      pool(TU*)    { return tu; }
+    inline BS_MEM::Pool<Bs32s, 64 * 1024>& pool(Bs32s*) { return tc; }
+
+    template<class T> T* Alloc(Bs32u n_elem = 1) { return pool((T*)nullptr).alloc(n_elem); }
+
+    void Reset()
+    {
+        ctu.reset();
+        cu.reset();
+        pu.reset();
+        tu.reset();
+        tc.reset();
+    }
+};
+
+class PicArenaPool
+{
+private:
+    std::mutex m_mtx;
+    std::list<std::unique_ptr<PicArena>> m_free;
+
+public:
+    std::unique_ptr<PicArena> Get()
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+
+        if (m_free.empty())
+            return std::unique_ptr<PicArena>(new PicArena);
+
+        std::unique_ptr<PicArena> pArena = std::move(m_free.front());
+        m_free.pop_front();
+        pArena->Reset();
+
+        return pArena;
+    }
+
+    void Put(std::unique_ptr<PicArena>&& pArena)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_free.push_back(std::move(pArena));
+    }
+};
+
+// Owns arena while it is tracked by BS_MEM::Allocator, returns it to the pool on free
+class PicArenaRef : public BS_MEM::MemBase
+{
+private:
+    std::unique_ptr<PicArena>   m_arena;
+    std::weak_ptr<PicArenaPool> m_pool;
+
+public:
+    PicArenaRef(std::unique_ptr<PicArena>&& pArena, std::shared_ptr<PicArenaPool>& pool)
+        : m_arena(std::move(pArena))
+        , m_pool(pool)
+    {}
+
+    virtual ~PicArenaRef()
+    {
+        auto pool = m_pool.lock();
+
+        if (pool && m_arena)
+            pool->Put(std::move(m_arena));
+    }
+
+    void* Get() { return m_arena.get(); }
+};
+
 class SDParser //Slice data parser
     : public  BsReader2::Reader
     , private CABAC
     , public virtual Info
 {
 private:
-    std::vector<CTU>   m_ctu;
-    std::vector<CU>    m_cu;
-    std::vector<PU>    m_pu;
-    std::vector<TU>    m_tu;
-    std::vector<Bs32s> m_TC_lvl;
+    std::unique_ptr<PicArena>     m_localArena;
+    PicArena*                     m_arena = nullptr;
 
     bool  IntraSplitFlag          = false;
     Bs16u MaxTrafoDepth           = 0;
@@ -428,44 +513,12 @@ private:
 
     template<class T> T* Alloc(Bs16u n_elem = 1)
     {
-        if (std::is_same<CTU, T>::value)
-        {
-            assert(m_ctu.capacity() >= m_ctu.size() + 1);
-            CTU z{};
-            m_ctu.push_back(z);
-            return (T*)&m_ctu.back();
-        }
-        if (std::is_same<CU, T>::value)
-        {
-            assert(m_cu.capacity() >= m_cu.size() + 1);
-            CU z{};
-            m_cu.push_back(z);
-            return (T*)&m_cu.back();
-        }
-        if (std::is_same<PU, T>::value)
-        {
-            assert(m_pu.capacity() >= m_pu.size() + 1);
-            PU z{};
-            m_pu.push_back(z);
-            return (T*)&m_pu.back();
-        }
-        if (std::is_same<TU, T>::value)
-        {
-            assert(m_tu.capacity() >= m_tu.size() + 1);
-            TU z{};
-            m_tu.push_back(z);
-            return (T*)&m_tu.back();
-        }
-        if (std::is_same<Bs32s, T>::value)
-        {
-            assert(m_TC_lvl.capacity() >= m_TC_lvl.size() + n_elem);
-            m_TC_lvl.insert(m_TC_lvl.end(), n_elem, 0);
-            return (T*)&m_TC_lvl[m_TC_lvl.size() - n_elem];
-        }
-        throw std::bad_alloc();
-        return 0;
+        assert(m_arena);
+        return m_arena->Alloc<T>(n_elem);
     }
 
+    PicArena* GetArena(Slice& slice);
+
     void parseSAO(CTU& ctu, Bs16u rx, Bs16u ry);
     CU*  parseCQT(CU& cu, Bs16u log2CbSize, Bs16u cqtDepth);
     void parseCU (CU& cu);
@@ -479,6 +532,9 @@ private:
 
 public:
     BS_MEM::Allocator* m_pAllocator;
+    std::shared_ptr<PicArenaPool> m_pArenaPool;
+    CtuCallback m_ctuCallback = nullptr;
+    void*       m_ctuCallbackData = nullptr;
 
     SDParser(bool report_TC = false);
 
@@ -489,6 +545,7 @@ public:
     inline Bs32s se()        { return GetSE(); };
 
     bool more_rbsp_data();
+    inline Bs64u GetBinCount() { return BinCount; }
 
     CTU* parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb = -1);
 };
@@ -615,8 +672,10 @@ public:
     BSErr Unlock(void* p);
 
     void set_trace_level(Bs32u level);
+    void set_ctu_callback(CtuCallback cb, void* user_data);
     inline Bs64u get_cur_pos() { return GetByteOffset(); }
     inline Bs16u get_async_depth() { return m_asyncAUMax; }
+    Bs64u get_bin_count();
 
 };
 
@@ -980,4 +980,8 @@ struct NALU
     NALU* next;
 };
 
+// Called for every parsed CTU in decoding order (PARSE_SSD mode).
+// Transform tree (ctu.Cu->Tu) is valid only inside the callback.
+typedef void (*CtuCallback)(void* user_data, NALU& slice, CTU& ctu);
+
 };
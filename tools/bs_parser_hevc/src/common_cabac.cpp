@@ -34,7 +34,45 @@ static const Bs8u renormTab[32] =
 
 Bs8u ADE::DecodeDecision(Bs8u& ctxState)
 {
-#if (BS_AVC2_ADE_MODE == 1)
+#if (BS_AVC2_ADE_MODE == 2)
+    Bs32u vMPS = (ctxState & 1);
+    Bs32u bin = vMPS;
+    Bs32u state = (ctxState >> 1);
+    Bs32u rLPS = rangeTabLpsT[(m_range >> 6) & 3][state];
+
+    m_range -= rLPS;
+
+    Bs64u scaledRange = (Bs64u(m_range) << m_bits);
+
+    if (m_val < scaledRange)
+    {
+        ctxState = (transIdxMps[state] << 1) | vMPS;
+
+        if (m_range >= 256)
+            return bin;
+
+        m_range <<= 1;
+        m_bits--;
+    }
+    else
+    {
+        Bs32u renorm = CountLeadingZeros(rLPS) - 23;
+        m_val -= scaledRange;
+        m_range = (rLPS << renorm);
+        m_bits -= renorm;
+
+        bin ^= 1;
+        if (!state)
+            vMPS ^= 1;
+
+        ctxState = (transIdxLps[state] << 1) | vMPS;
+    }
+
+    if (m_bits <= 0)
+        Refill();
+
+    return bin;
+#elif (BS_AVC2_ADE_MODE == 1)
     Bs32u vMPS = (ctxState & 1);
     Bs32u bin = vMPS;
     Bs32u state = (ctxState >> 1);
@@ -112,7 +150,18 @@ Bs8u ADE::DecodeDecision(Bs8u& ctxState)
 }
 Bs8u ADE::DecodeBypass()
 {
-#if (BS_AVC2_ADE_MODE == 1)
+#if (BS_AVC2_ADE_MODE == 2)
+    if (!--m_bits)
+        Refill();
+
+    Bs64u scaledRange = (Bs64u(m_range) << m_bits);
+
+    if (m_val < scaledRange)
+        return 0;
+
+    m_val -= scaledRange;
+    return 1;
+#elif (BS_AVC2_ADE_MODE == 1)
     if (!--m_bits)
     {
         m_val = (m_val << 16) | B(2);
@@ -140,7 +189,32 @@ Bs8u ADE::DecodeBypass()
 }
 Bs8u ADE::DecodeTerminate()
 {
-#if (BS_AVC2_ADE_MODE == 1)
+#if (BS_AVC2_ADE_MODE == 2)
+    Bs32u range = m_range - 2;
+    Bs64u scaledRange = (Bs64u(range) << m_bits);
+
+    if (m_val < scaledRange)
+    {
+        if (range >= 256)
+        {
+            m_range = range;
+            return 0;
+        }
+
+        m_range = (range << 1);
+
+        if (!--m_bits)
+            Refill();
+
+        return 0;
+    }
+
+    m_range = range;
+
+    TrimLookAhead();
+
+    return 1;
+#elif (BS_AVC2_ADE_MODE == 1)
     Bs32u range = m_range - 2;
     Bs32s val = m_val - (range << m_bits);
 
@@ -181,3 +255,30 @@ Bs8u ADE::DecodeTerminate()
     return 0;
 #endif
 }
+
+Bs32u ADE::DecodeBypassBins(Bs16u n)
+{
+    Bs32u bins = 0;
+
+#if (BS_AVC2_ADE_MODE == 2)
+    // one refill for the whole run, then branchless compare-subtract per bin
+    if (m_bits <= n)
+        Refill();
+
+    while (n--)
+    {
+        m_bits--;
+
+        Bs64u scaledRange = (Bs64u(m_range) << m_bits);
+        Bs64u bin = (m_val >= scaledRange);
+
+        m_val -= (scaledRange & (0 - bin));
+        bins = (bins << 1) | Bs32u(bin);
+    }
+#else
+    while (n--)
+        bins = (bins << 1) | DecodeBypass();
+#endif
+
+    return bins;
+}
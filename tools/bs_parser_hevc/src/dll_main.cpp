@@ -104,4 +104,15 @@ Bs16u __STDCALL BS_HEVC2_GetAsyncDepth(BS_HEVC2::HDL hdl){
     return hdl->get_async_depth();
 }
 
+Bs64u __STDCALL BS_HEVC2_GetBinCount(BS_HEVC2::HDL hdl){
+    if (!hdl) return 0;
+    return hdl->get_bin_count();
+}
+
+BSErr __STDCALL BS_HEVC2_SetCtuCallback(BS_HEVC2::HDL hdl, BS_HEVC2::CtuCallback cb, void* user_data){
+    if (!hdl) return BS_ERR_BAD_HANDLE;
+    hdl->set_ctu_callback(cb, user_data);
+    return BS_ERR_NONE;
+}
+
 } // extern "C"
@@ -129,11 +129,7 @@ Bs8u CABAC::SaoBandPosition()
     //bypass bypass bypass bypass bypass bypass
     Bs8u b;
 
-    b  = (DecodeBypass() << 4);
-    b |= (DecodeBypass() << 3);
-    b |= (DecodeBypass() << 2);
-    b |= (DecodeBypass() << 1);
-    b |=  DecodeBypass();
+    b = (Bs8u)DBN(5);
 
     BinCount += 5;
 
@@ -146,8 +142,7 @@ Bs8u CABAC::SaoEoClassLuma()
     //bypass bypass bypass na na na
     Bs8u b;
 
-    b  = (DecodeBypass() << 1);
-    b |=  DecodeBypass();
+    b = (Bs8u)DBN(2);
 
     BinCount += 2;
 
@@ -689,8 +684,7 @@ Bs32u CABAC::CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu
 
     if (b < 4)
     {
-        for (Bs16u c = 0; c < cRiceParam; c++)
-            b = ((b << 1) | DecodeBypass());
+        b = (b << cRiceParam) | DBN(cRiceParam);
 
         BinCount += cRiceParam;
     }
@@ -725,11 +719,7 @@ Bs32u CABAC::CoeffAbsLevelRemaining(Bs16u i, Bs16u baseLevel, Bs16u cIdx, CU& cu
             BinCount += b + k + 1;
         }
 
-        while (k--)
-        {
-            b = DecodeBypass();
-            v1 |= (b << k);
-        }
+        v1 = DBN(k);
 
         b = v0 + v1 + cMax;
     }
@@ -752,7 +742,7 @@ Bs32u CABAC::EGkBypass(Bs32u k)
 {
     //EGk
     //bypass bypass bypass bypass bypass bypass
-    Bs32u v0 = 0, v1 = 0, b;
+    Bs32u v0 = 0, v1 = 0;
 
     while (DecodeBypass())
     {
@@ -763,11 +753,7 @@ Bs32u CABAC::EGkBypass(Bs32u k)
 
     BinCount += k;
 
-    while (k--)
-    {
-        b = DecodeBypass();
-        v1 |= (b << k);
-    }
+    v1 = DBN(k);
 
     return (v0 + v1);
 }
@@ -781,8 +767,7 @@ Bs16u CABAC::NewPaletteEntries(Bs16u cIdx)
 
     BinCount += n;
 
-    while (n--)
-        b = (b << 1) | DecodeBypass();
+    b = (Bs16u)DBN(n);
 
     return b;
 }
@@ -808,8 +793,7 @@ Bs16u CABAC::NumPaletteIndices(Bs16u MaxPaletteIndex)
 
     BinCount += cRiceParam;
 
-    while (cRiceParam--)
-        prefixVal = (prefixVal << 1) | DecodeBypass();
+    prefixVal = (prefixVal << cRiceParam) | DBN(cRiceParam);
 
     return prefixVal + 1;
 }
@@ -825,8 +809,7 @@ Bs32u CABAC::TBBypass(Bs32u cMax)
 
     BinCount += k;
 
-    while (k--)
-        v = (v << 1) | DecodeBypass();
+    v = DBN(k);
 
     if (v < u)
         return v;
@@ -888,8 +871,7 @@ Bs16u CABAC::PaletteEscapeVal(Bs16u cIdx, bool cu_transquant_bypass_flag)
 
         BinCount += bd;
 
-        while (bd--)
-            v = (v << 1) | DecodeBypass();
+        v = (Bs16u)DBN(bd);
 
         return v;
     }
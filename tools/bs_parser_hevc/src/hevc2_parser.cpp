@@ -42,6 +42,7 @@ Parser::Parser(Bs32u mode)
     std::fill_n(m_pps, 64, nullptr);
     memset(&m_prevPOC, 0, sizeof(m_prevPOC));
     m_pAllocator = &(BS_MEM::Allocator&)*this;
+    m_pArenaPool = std::make_shared<PicArenaPool>();
 
     m_asyncAUMax = 0;
     m_asyncAUCnt = 0;
@@ -73,6 +74,7 @@ Parser::Parser(Bs32u mode)
 
             sdt.locked = 0;
             sdt.p.m_pAllocator = &(BS_MEM::Allocator&)*this;
+            sdt.p.m_pArenaPool = m_pArenaPool;
             sdt.p.SetEmulation(false);
             sdt.p.SetTraceLevel(TRACE_DEFAULT);
 
@@ -144,6 +146,28 @@ void Parser::set_trace_level(Bs32u level)
         t.p.SetTraceLevel(level);
 }
 
+Bs64u Parser::get_bin_count()
+{
+    Bs64u cnt = GetBinCount();
+
+    for (auto& sdt : m_sdt)
+        cnt += sdt.p.GetBinCount();
+
+    return cnt;
+}
+
+void Parser::set_ctu_callback(CtuCallback cb, void* user_data)
+{
+    m_ctuCallback = cb;
+    m_ctuCallbackData = user_data;
+
+    for (auto& sdt : m_sdt)
+    {
+        sdt.p.m_ctuCallback = cb;
+        sdt.p.m_ctuCallbackData = user_data;
+    }
+}
+
 inline bool isSuffix(NALU& nalu, bool nextBit){
     return (isSlice(nalu) && !nextBit)
         || (nalu.nal_unit_type == SUFFIX_SEI_NUT)
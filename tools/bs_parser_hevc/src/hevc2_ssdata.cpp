@@ -24,10 +24,12 @@
 using namespace BS_HEVC2;
 using namespace BsReader2;
 
+#ifdef __BS_TRACE__
 #undef BS2_TRO
 #define BS2_TRO\
  if (TraceOffset()) fprintf(GetLog(), "0x%016llX[%i]|%3u|%3u: ",\
      GetByteOffset(), GetBitOffset(), GetR(), GetV());
+#endif
 
 SDParser::SDParser(bool report_TC)
     : Reader()
@@ -39,6 +41,32 @@ SDParser::SDParser(bool report_TC)
     SetEmulation(false);
 }
 
+PicArena* SDParser::GetArena(Slice& slice)
+{
+    if (!m_pAllocator)
+    {
+        if (!m_localArena)
+            m_localArena.reset(new PicArena);
+
+        m_localArena->Reset();
+
+        return m_localArena.get();
+    }
+
+    if (!m_pArenaPool)
+        m_pArenaPool = std::make_shared<PicArenaPool>();
+
+    std::unique_ptr<PicArena> pArena = m_pArenaPool->Get();
+    PicArena* p = pArena.get();
+    std::unique_ptr<PicArenaRef> pRef(new PicArenaRef(std::move(pArena), m_pArenaPool));
+
+    m_pAllocator->attach(p, pRef.get());
+    pRef.release();
+    m_pAllocator->bound(p, &slice);
+
+    return p;
+}
+
 bool SDParser::more_rbsp_data()
 {
     Bs8u b[5];
@@ -65,33 +93,17 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
     auto& pps = *slice.pps;
     std::vector<Slice*> colSLices;
 
-    if (NewPicture)
+    if (NewPicture || !m_arena)
     {
-        Bs32u PicSizeInMinTbY = PicSizeInMinCbsY
-            * (1 << (MinCbLog2SizeY - MinTbLog2SizeY)) * (1 << (MinCbLog2SizeY - MinTbLog2SizeY));
-
-        m_ctu.clear();
-        m_cu.clear();
-        m_pu.clear();
-        m_tu.clear();
-
         TCLevels.reserve(1 << (2*MaxTbLog2SizeY));
-
-        if (report_TCLevels)
-        {
-            m_TC_lvl.clear();
-            m_TC_lvl.reserve(PicSizeInSamplesY);
-        }
-        m_ctu.reserve(PicSizeInCtbsY);
-        m_cu.reserve(PicSizeInMinCbsY);
-        m_pu.reserve(PicSizeInMinCbsY * 4);
-        m_tu.reserve(PicSizeInMinTbY);
+        m_arena = GetArena(slice);
+    }
+    else if (m_pAllocator)
+    {
+        m_pAllocator->bound(m_arena, &slice);
     }
 
-    auto nCTU = m_ctu.size();
-    auto nCU = m_cu.size();
-    auto nPU = m_pu.size();
-    auto nTU = m_tu.size();
+    Bs32u nCTU = 0;
 
     Bs16u CtbAddrInRs = slice.slice_segment_address;
     Bs16u CtbAddrInTs = CtbAddrRsToTs[CtbAddrInRs];
@@ -137,13 +149,32 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
     if (pps.entropy_coding_sync_enabled_flag && PicWidthInCtbsY == 1)
         StoreWPP();
 
-    CTU* pCTU = Alloc<CTU>();
+    CTU* pCTU0 = Alloc<CTU>();
+    CTU* pCTU = pCTU0;
 
     for (;;)
     {
         auto& ctu = *pCTU;
+        auto tuMark = m_arena->tu.mark();
+        auto tcMark = m_arena->tc.mark();
+
+        // transform tree isn't referenced by neighbours, so it is dropped once consumed
+        auto EmitCTU = [&] ()
+        {
+            if (!m_ctuCallback)
+                return;
+
+            m_ctuCallback(m_ctuCallbackData, nalu, ctu);
+
+            for (CU* pCU = ctu.Cu; pCU; pCU = pCU->Next)
+                pCU->Tu = nullptr;
+
+            m_arena->tu.rewind(tuMark);
+            m_arena->tc.rewind(tcMark);
+        };
 
         CtuInRs[CtbAddrInRs] = pCTU;
+        nCTU++;
 
         BS2_SET(CtbAddrInRs, ctu.CtbAddrInRs);
         BS2_SET(CtbAddrInTs, ctu.CtbAddrInTs);
@@ -157,10 +188,15 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
         parseCQT(*ctu.Cu, CtbLog2SizeY, 0);
 
         if (slice.Split && !--NumCtb)
+        {
+            EmitCTU();
             break;
+        }
 
         BS2_SET(EndOfSliceSegmentFlag(), ctu.end_of_slice_segment_flag);
 
+        EmitCTU();
+
         if (pps.entropy_coding_sync_enabled_flag && (CtbAddrInRs % PicWidthInCtbsY) == 1)
             StoreWPP();
 
@@ -217,91 +253,17 @@ CTU* SDParser::parseSSD(NALU& nalu, NALU* pColPic, Bs32u NumCtb)
 
     if (m_pAllocator)
     {
-        nCTU = m_ctu.size() - nCTU;
-        nCU  = m_cu.size()  - nCU;
-        nPU  = m_pu.size()  - nPU;
-        nTU  = m_tu.size()  - nTU;
-
-        pCTU = m_pAllocator->alloc<CTU>(0, (Bs32u)nCTU);
-        auto pCU  = m_pAllocator->alloc<CU>(pCTU, (Bs32u)nCU);
-        auto pPU  = m_pAllocator->alloc<PU>(pCTU, (Bs32u)nPU);
-        auto pTU  = m_pAllocator->alloc<TU>(pCTU, (Bs32u)nTU);
-        CTU* pCTU0 = nCTU ? &m_ctu[m_ctu.size() - nCTU] : 0;
-        CU*  pCU0  = nCU  ? &m_cu[m_cu.size() - nCU]    : 0;
-        PU*  pPU0  = nPU  ? &m_pu[m_pu.size() - nPU]    : 0;
-        TU*  pTU0  = nTU  ? &m_tu[m_tu.size() - nTU]    : 0;
-
-        if (pCTU)memmove(pCTU, pCTU0, sizeof(CTU) * nCTU);
-        if (pCU) memmove(pCU, pCU0, sizeof(CU) * nCU);
-        if (pPU) memmove(pPU, pPU0, sizeof(PU) * nPU);
-        if (pTU) memmove(pTU, pTU0, sizeof(TU) * nTU);
-
-        Bs32s* pTC_levels = nullptr;
-        if (report_TCLevels)
-        {
-            pTC_levels = m_pAllocator->alloc<Bs32s>(pCTU, Bs32u(m_TC_lvl.size()));
-            if (pTC_levels) std::copy(std::begin(m_TC_lvl), std::end(m_TC_lvl), pTC_levels);
-        }
-
-        auto pcCTU = pCTU;
-
-        for (;;)
-        {
-            if (pcCTU->Cu)
-            {
-                auto pcCU = pcCTU->Cu = pCU + (pcCTU->Cu - pCU0);
-
-                for (;;)
-                {
-                    if (pcCU->Pu)
-                    {
-                        auto pcPU = pcCU->Pu = pPU + (pcCU->Pu - pPU0);
-
-                        for (;;)
-                        {
-                            if (!pcPU->Next)
-                                break;
-                            pcPU = pcPU->Next = pPU + (pcPU->Next - pPU0);
-                        }
-                    }
-
-                    if (pcCU->Tu)
-                    {
-                        auto pcTU = pcCU->Tu = pTU + (pcCU->Tu - pTU0);
-
-                        for (;;)
-                        {
-                            if (report_TCLevels && pcTU->tc_levels_luma)
-                            {
-                                pcTU->tc_levels_luma = pTC_levels + std::distance(m_TC_lvl.data(), pcTU->tc_levels_luma);
-                            }
-
-                            if (!pcTU->Next)
-                                break;
-                            pcTU = pcTU->Next = pTU + (pcTU->Next - pTU0);
-                        }
-                    }
-
-                    if (!pcCU->Next)
-                        break;
-                    pcCU = pcCU->Next = pCU + (pcCU->Next - pCU0);
-                }
-            }
-
-            if (!pcCTU->Next)
-                break;
-            pcCTU = pcCTU->Next = pCTU + (pcCTU->Next - pCTU0);
-        }
-
-        BS2_SET((Bs32u)nCTU, slice.NumCTU);
-
-        //printf("NumCTU = %d\n", slice.NumCTU);
+        // CTU list is tracked by the allocator, arena is released with the last one
+        m_pAllocator->attach(pCTU0, new BS_MEM::MemObj<CTU>(pCTU0));
+        m_pAllocator->bound(m_arena, pCTU0);
     }
 
+    BS2_SET(nCTU, slice.NumCTU);
+
     ColPicSlices = 0;
     NumColSlices = 0;
 
-    return pCTU;
+    return pCTU0;
 }
 
 void SDParser::parseSAO(CTU& ctu, Bs16u rx, Bs16u ry)
@@ -1665,16 +1627,42 @@ void SDParser::parseResidual(CU& cu, TU& tu, Bs16u x0, Bs16u y0, Bs16u log2Trafo
                 escapeDataPresent = true;
         }
 
-        for (Bs32s ii = 0; ii < nSC; ii++)
+        if (Trace())
         {
-            auto n = sig_coeff[ii];
+            for (Bs32s ii = 0; ii < nSC; ii++)
+            {
+                auto n = sig_coeff[ii];
 
-            if (   !pps.sign_data_hiding_enabled_flag
-                || !signHidden
-                || (n != firstSigScanPos))
+                if (   !pps.sign_data_hiding_enabled_flag
+                    || !signHidden
+                    || (n != firstSigScanPos))
+                {
+                    BS2_SET(CoeffSignFlag(), coeff_sign_flag[n]);
+                }
+            }
+        }
+        else
+        {
+            // all sign bins of the sub-block are bypass coded back to back
+            Bs16u nSign = 0;
+            Bs8u  signPos[16];
+
+            for (Bs32s ii = 0; ii < nSC; ii++)
             {
-                BS2_SET(CoeffSignFlag(), coeff_sign_flag[n]);
+                auto n = sig_coeff[ii];
+
+                if (   !pps.sign_data_hiding_enabled_flag
+                    || !signHidden
+                    || (n != firstSigScanPos))
+                {
+                    signPos[nSign++] = Bs8u(n);
+                }
             }
+
+            Bs32u signs = CoeffSignFlags(nSign);
+
+            for (Bs16u k = 0; k < nSign; k++)
+                coeff_sign_flag[signPos[k]] = !!((signs >> (nSign - 1 - k)) & 1);
         }
 
         Bs32s numSigCoeff = 0;
@@ -0,0 +1,138 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <bs_parser++.h>
+
+using namespace BS_HEVC2;
+
+inline bool IsHEVCSlice(Bs32u nut) { return (nut <= 21) && ((nut < 10) || (nut > 15)); }
+
+int printUsage(char* argv[])
+{
+    printf("Measures CABAC decoding throughput of HEVC slice data parser.\n");
+    printf("Usage: %s <stream_name> [-n <number of passes>] [-async]\n", argv[0]);
+    return 1;
+}
+
+struct PassStat
+{
+    Bs32u  numAU;
+    Bs64u  numSliceBytes;
+    Bs64u  numBins;
+    double seconds;
+};
+
+BSErr RunPass(const char* name, Bs32u mode, PassStat& stat)
+{
+    BS_HEVC2_parser parser(mode);
+    BS_HEVC2::NALU* pAU = nullptr;
+    BSErr sts = parser.open(name);
+
+    memset(&stat, 0, sizeof(stat));
+
+    if (sts != BS_ERR_NONE)
+        return sts;
+
+    parser.set_trace_level(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (;;)
+    {
+        sts = parser.parse_next_au(pAU);
+
+        if (sts == BS_ERR_MORE_DATA)
+            break;
+
+        if (sts != BS_ERR_NONE)
+            return sts;
+
+        sts = parser.sync(pAU);
+
+        if (sts != BS_ERR_NONE)
+            return sts;
+
+        for (auto pNALU = pAU; pNALU; pNALU = pNALU->next)
+        {
+            if (IsHEVCSlice(pNALU->nal_unit_type))
+                stat.numSliceBytes += pNALU->NumBytesInRbsp;
+        }
+
+        stat.numAU++;
+    }
+
+    stat.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stat.numBins = parser.bin_count();
+
+    return BS_ERR_NONE;
+}
+
+int main(int argc, char* argv[])
+{
+    Bs32u nPasses = 1;
+    Bs32u mode = PARSE_SSD;
+
+    if (argc < 2)
+        return printUsage(argv);
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            nPasses = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-async"))
+            mode |= ASYNC;
+        else
+            return printUsage(argv);
+    }
+
+    PassStat total = {};
+
+    for (Bs32u pass = 0; pass < nPasses; pass++)
+    {
+        PassStat stat = {};
+        BSErr sts = RunPass(argv[1], mode, stat);
+
+        if (sts != BS_ERR_NONE)
+        {
+            printf("FAILED to parse %s: %i\n", argv[1], sts);
+            return 1;
+        }
+
+        printf("pass %2u: %6u AUs %10.3f Mbins/s %8.3f MB/s\n", pass, stat.numAU,
+            stat.numBins / stat.seconds * 1e-6, stat.numSliceBytes / stat.seconds * 1e-6);
+
+        total.numAU         += stat.numAU;
+        total.numSliceBytes += stat.numSliceBytes;
+        total.numBins       += stat.numBins;
+        total.seconds       += stat.seconds;
+    }
+
+    printf("total  : %6u AUs %10llu bins %.3f s\n", total.numAU, (unsigned long long)total.numBins, total.seconds);
+    printf("average: %10.3f Mbins/s %8.3f MB/s %8.1f AU/s\n",
+        total.numBins / total.seconds * 1e-6,
+        total.numSliceBytes / total.seconds * 1e-6,
+        total.numAU / total.seconds);
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures per-frame rate estimation of LookAheadBrc2::PreEnc over recorded VmeData
+// (see LoadFrames) or over synthetic macroblocks, and compares the result with
+// the straightforward per-MB x per-QP loop it replaced.
+//
+// With -yuv, VmeData is produced from a raw 4:2:0 file by CpuLookahead instead
+// (IPPP, previous frame is the reference), so its speed is reported as well.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "mfx_common.h"
+#include "mfx_h264_encode_hw_utils.h"
+#include "mfx_h264_encode_cpu_la.h"
+
+using MfxHwH264Encode::MbData;
+using MfxHwH264EncodeHW::QSTEP;
+using MfxHwH264EncodeHW::INTRA_QSTEP_COEFF;
+
+// LookAheadBrc2::PreEnc before the histogram rewrite
+static void EstimateRatePerQpRef(std::vector<MbData> const & mb, mfxF64 laMultiplier, mfxU32 numMb, mfxF64 estRate[52])
+{
+    memset(estRate, 0, sizeof(mfxF64) * 52);
+
+    for (size_t j = 0; j < mb.size(); j++)
+    {
+        if (mb[j].intraMbFlag)
+        {
+            for (mfxU32 qp = 0; qp < 52; qp++)
+                estRate[qp] += laMultiplier * mb[j].dist / (QSTEP[qp] * INTRA_QSTEP_COEFF);
+        }
+        else
+        {
+            mfxU32 skipQp = MfxHwH264EncodeHW::GetSkippedQp(mb[j]);
+            for (mfxU32 qp = 0; qp < skipQp; qp++)
+                estRate[qp] += laMultiplier * mb[j].dist / (QSTEP[qp]);
+        }
+    }
+    for (mfxU32 qp = 0; qp < 52; qp++)
+        estRate[qp] /= numMb;
+}
+
+// File layout: per frame mfxU32 numMb followed by numMb MbData records
+static bool LoadFrames(const char *name, std::vector<std::vector<MbData> > &frames)
+{
+    FILE *f = fopen(name, "rb");
+    if (!f)
+        return false;
+
+    mfxU32 numMb = 0;
+    bool ok = true;
+
+    while (ok && fread(&numMb, sizeof(numMb), 1, f) == 1)
+    {
+        frames.push_back(std::vector<MbData>(numMb));
+        ok = !numMb || fread(frames.back().data(), sizeof(MbData), numMb, f) == numMb;
+    }
+
+    fclose(f);
+    return ok && !frames.empty();
+}
+
+// Rough mix of intra, static and moving macroblocks, so all GetSkippedQp() branches are taken
+static void GenerateFrames(mfxU32 width, mfxU32 height, mfxU32 count, std::vector<std::vector<MbData> > &frames)
+{
+    mfxU32 numMb = ((width + 15) / 16) * ((height + 15) / 16);
+    srand(1);
+
+    for (mfxU32 i = 0; i < count; i++)
+    {
+        frames.push_back(std::vector<MbData>(numMb));
+
+        for (MbData & mb : frames.back())
+        {
+            memset(&mb, 0, sizeof(mb));
+            mb.dist        = mfxU16(rand() % 4096);
+            mb.intraMbFlag = (rand() % 8) == 0;
+
+            mfxI16 range = (rand() % 4) ? 2 : 32;
+            mb.mv[0].x = mfxI16(rand() % range - range / 2);
+            mb.mv[0].y = mfxI16(rand() % range - range / 2);
+
+            for (mfxU32 k = 0; k < 4; k++)
+            {
+                mb.lumaCoeffCnt[k] = mfxU8(rand() % 3 ? rand() % 16 : 0);
+                mb.lumaCoeffSum[k] = mfxU16(mb.lumaCoeffCnt[k] * (rand() % 256));
+            }
+        }
+    }
+}
+
+// Luma of 'count' frames of I420/NV12 file, returns number of frames read
+static mfxU32 ReadLuma(const char *name, mfxU32 width, mfxU32 height, mfxU32 count, std::vector<mfxU8> &luma)
+{
+    FILE *f = fopen(name, "rb");
+    if (!f)
+        return 0;
+
+    size_t const lumaSize = size_t(width) * height;
+    mfxU32 n = 0;
+
+    luma.resize(lumaSize * count);
+    for (; n < count; n++)
+    {
+        if (fread(&luma[lumaSize * n], 1, lumaSize, f) != lumaSize || fseek(f, long(lumaSize / 2), SEEK_CUR))
+            break;
+    }
+
+    fclose(f);
+    luma.resize(lumaSize * n);
+    return n;
+}
+
+static bool RunCpuLookahead(const char *name, mfxU32 width, mfxU32 height, mfxU32 count, mfxU32 ds, mfxU32 threads,
+    std::vector<std::vector<MbData> > &frames)
+{
+    std::vector<mfxU8> luma;
+    count = ReadLuma(name, width, height, count, luma);
+    if (!count)
+        return false;
+
+    MfxHwH264Encode::CpuLookahead la;
+    la.Setup(width, height, ds, 2, threads);
+
+    std::vector<MfxHwH264Encode::VmeData> vme(2);
+    for (size_t i = 0; i < vme.size(); i++)
+        vme[i].mb.resize(la.GetWidthLa() / 16 * la.GetHeightLa() / 16);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (mfxU32 i = 0; i < count; i++)
+    {
+        mfxU32 slot = i & 1;
+        la.Downscale(slot, &luma[size_t(width) * height * i], width);
+        la.Estimate(slot, i ? MFX_FRAMETYPE_P : MFX_FRAMETYPE_I, i ? mfxI32(slot ^ 1) : -1, -1, 32, vme[slot]);
+        if (i)
+            la.Propagate(vme[slot], &vme[slot ^ 1], 0);
+        frames.push_back(vme[slot].mb);
+    }
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("cpu lookahead:  %u frames %ux%u -> %ux%u, %.3f sec, %.2f ms/frame\n",
+        count, width, height, la.GetWidthLa(), la.GetHeightLa(), sec, sec * 1e3 / count);
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *input = 0;
+    const char *yuv   = 0;
+    mfxU32 ds      = 2;
+    mfxU32 threads = 0;
+    mfxU32 width  = 3840;
+    mfxU32 height = 2160;
+    mfxU32 count  = 16;
+    mfxU32 passes = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            input = argv[++i];
+        else if (!strcmp(argv[i], "-yuv") && i + 1 < argc)
+            yuv = argv[++i];
+        else if (!strcmp(argv[i], "-ds") && i + 1 < argc)
+            ds = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            threads = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            width = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            height = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+            count = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            passes = (mfxU32)atoi(argv[++i]);
+        else
+        {
+            printf("usage: %s [-i vme_data.bin | -w width -h height -f frames [-yuv input.yuv [-ds 1|2|4] [-t threads]]] [-n passes]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<MbData> > frames;
+
+    if (input)
+    {
+        if (!LoadFrames(input, frames))
+        {
+            printf("failed to read %s\n", input);
+            return 1;
+        }
+    }
+    else if (yuv)
+    {
+        if (!RunCpuLookahead(yuv, width, height, count, ds, threads, frames))
+        {
+            printf("failed to read %s\n", yuv);
+            return 1;
+        }
+    }
+    else
+        GenerateFrames(width, height, count, frames);
+
+    if (!passes)
+        passes = 1;
+
+    mfxF64 const laMultiplier = 1.0;
+    std::vector<mfxF64> estRef(frames.size() * 52);
+    std::vector<mfxF64> estNew(frames.size() * 52);
+    size_t totalMb = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (mfxU32 pass = 0; pass < passes; pass++)
+        for (size_t i = 0; i < frames.size(); i++)
+            EstimateRatePerQpRef(frames[i], laMultiplier, mfxU32(frames[i].size()), &estRef[i * 52]);
+
+    double secRef = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+
+    for (mfxU32 pass = 0; pass < passes; pass++)
+        for (size_t i = 0; i < frames.size(); i++)
+            MfxHwH264EncodeHW::EstimateRatePerQp(frames[i], laMultiplier, mfxU32(frames[i].size()), &estNew[i * 52]);
+
+    double secNew = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mfxF64 maxRelDiff = 0;
+    for (size_t i = 0; i < estRef.size(); i++)
+    {
+        mfxF64 diff = fabs(estNew[i] - estRef[i]);
+        if (diff > 0)
+            maxRelDiff = std::max(maxRelDiff, diff / std::max(fabs(estRef[i]), 1e-300));
+    }
+
+    for (size_t i = 0; i < frames.size(); i++)
+        totalMb += frames[i].size();
+
+    double frameCount = double(frames.size()) * passes;
+
+    printf("frames:         %zu (%.0f MBs per frame) x %u passes\n", frames.size(), double(totalMb) / frames.size(), passes);
+    printf("per-MB loop:    %.3f sec, %.1f us/frame\n", secRef, secRef * 1e6 / frameCount);
+    printf("histogram:      %.3f sec, %.1f us/frame\n", secNew, secNew * 1e6 / frameCount);
+    printf("speedup:        %.2fx\n", secNew > 0 ? secRef / secNew : 0.);
+    printf("max rel. diff:  %.3g\n", maxRelDiff);
+
+    return 0;
+}
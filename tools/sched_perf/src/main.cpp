@@ -0,0 +1,450 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Stress test of the scheduler with many sessions in one process.
+//
+// N sessions are opened, each one runs MFXVideoVPP NV12 resize (960x540 -> 640x360
+// by default) on system memory from its own application thread. Aggregate throughput,
+// throughput of sessions by priority, the number of threads of the process and
+// voluntary / involuntary context switches (getrusage) are reported.
+//
+// -shared runs the sessions on the process-wide pool of the scheduler
+// (MFX_SCHEDULER_SHARED_POOL=1) instead of a thread set per session,
+// -high K gives MFX_PRIORITY_HIGH to the first K sessions and MFX_PRIORITY_LOW to the others.
+//
+// -numa auto|N places threads and system memory of sessions on NUMA nodes
+// (MFX_SCHEDULER_NUMA_NODE), 'auto' spreads sessions over nodes. Cross-node traffic
+// is reported as the change of the system-wide numastat counters: pages allocated
+// on a node other than the preferred one (numa_miss) and pages allocated for a
+// process running on another node (other_node).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "mfxvideo++.h"
+
+#define ALIGN16(value) (((value + 15) >> 4) << 4)
+
+static void SetFrameInfo(mfxFrameInfo & info, mfxU16 width, mfxU16 height)
+{
+    info.FourCC        = MFX_FOURCC_NV12;
+    info.ChromaFormat  = MFX_CHROMAFORMAT_YUV420;
+    info.PicStruct     = MFX_PICSTRUCT_PROGRESSIVE;
+    info.FrameRateExtN = 30;
+    info.FrameRateExtD = 1;
+    info.Width         = ALIGN16(width);
+    info.Height        = ALIGN16(height);
+    info.CropW         = width;
+    info.CropH         = height;
+}
+
+// NV12 system memory surfaces of one allocation request
+class SurfacePool
+{
+public:
+    void Alloc(mfxFrameInfo const & info, mfxU16 count)
+    {
+        const mfxU32 pitch = info.Width;
+        const mfxU32 luma  = pitch * info.Height;
+        const mfxU32 size  = luma * 3 / 2;
+
+        m_buffer.assign(size_t(size) * count, 0);
+        m_surfaces.assign(count, mfxFrameSurface1());
+
+        for (mfxU16 i = 0; i < count; i++)
+        {
+            mfxFrameSurface1 & s = m_surfaces[i];
+            mfxU8 * p = &m_buffer[size_t(size) * i];
+
+            s.Info = info;
+            s.Data.PitchLow  = mfxU16(pitch & 0xffff);
+            s.Data.PitchHigh = mfxU16(pitch >> 16);
+            s.Data.Y  = p;
+            s.Data.UV = p + luma;
+            s.Data.V  = s.Data.UV + 1;
+        }
+
+        for (size_t i = 0; i < m_buffer.size(); i++)
+            m_buffer[i] = mfxU8((i * 7) ^ (i >> 11));
+    }
+
+    mfxFrameSurface1 * GetFree()
+    {
+        for (size_t i = 0; i < m_surfaces.size(); i++)
+            if (!m_surfaces[i].Data.Locked)
+                return &m_surfaces[i];
+        return 0;
+    }
+
+protected:
+    std::vector<mfxU8>            m_buffer;
+    std::vector<mfxFrameSurface1> m_surfaces;
+};
+
+struct Options
+{
+    mfxU32 sessions;
+    mfxU32 frames;
+    mfxU16 width;
+    mfxU16 height;
+    mfxU16 outWidth;
+    mfxU16 outHeight;
+    mfxU16 async;
+    mfxU16 threads;
+    mfxU32 high;
+};
+
+// all sessions start processing together, after all of them are initialized
+class StartGate
+{
+public:
+    explicit StartGate(mfxU32 count) : m_count(count) {}
+
+    void Arrive()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_count)
+            m_count--;
+        if (!m_count)
+            m_cond.notify_all();
+    }
+
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return 0 == m_count; });
+    }
+
+protected:
+    mfxU32                  m_count;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+};
+
+struct SessionResult
+{
+    bool     ok;
+    mfxU32   frames;
+    double   sec;
+};
+
+static int GetNumProcessThreads()
+{
+    FILE * f = fopen("/proc/self/status", "r");
+    char line[256];
+    int num = -1;
+
+    if (!f)
+        return num;
+
+    while (fgets(line, sizeof(line), f))
+    {
+        if (!strncmp(line, "Threads:", 8))
+        {
+            num = atoi(line + 8);
+            break;
+        }
+    }
+
+    fclose(f);
+    return num;
+}
+
+struct NumaStat
+{
+    unsigned long long miss;
+    unsigned long long otherNode;
+    unsigned long long local;
+};
+
+// system-wide counters summed over nodes
+static NumaStat GetNumaStat()
+{
+    NumaStat stat = {};
+
+    for (int node = 0; ; node++)
+    {
+        char path[64], name[32];
+        unsigned long long value;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/numastat", node);
+        FILE * f = fopen(path, "r");
+        if (!f)
+            break;
+
+        while (2 == fscanf(f, "%31s %llu", name, &value))
+        {
+            if (!strcmp(name, "numa_miss"))
+                stat.miss += value;
+            else if (!strcmp(name, "other_node"))
+                stat.otherNode += value;
+            else if (!strcmp(name, "local_node"))
+                stat.local += value;
+        }
+
+        fclose(f);
+    }
+
+    return stat;
+}
+
+static void RunSession(Options const & opt, mfxU32 idx, StartGate & initialized, StartGate & started,
+                       std::atomic<int> & numThreads, SessionResult & result)
+{
+    result.ok     = false;
+    result.frames = 0;
+    result.sec    = 0;
+
+    mfxInitParam initPar = {};
+    initPar.Implementation = MFX_IMPL_AUTO_ANY;
+    initPar.Version.Major  = 1;
+    initPar.Version.Minor  = 25;
+
+    mfxExtThreadsParam threadsPar = {};
+    threadsPar.Header.BufferId = MFX_EXTBUFF_THREADS_PARAM;
+    threadsPar.Header.BufferSz = sizeof(threadsPar);
+    threadsPar.NumThread       = opt.threads;
+
+    mfxExtBuffer * initExt[] = { &threadsPar.Header };
+    if (opt.threads)
+    {
+        initPar.ExtParam    = initExt;
+        initPar.NumExtParam = 1;
+    }
+
+    MFXVideoSession session;
+    MFXVideoVPP vpp(session);
+    SurfacePool inPool, outPool;
+
+    mfxVideoParam par = {};
+    SetFrameInfo(par.vpp.In,  opt.width,    opt.height);
+    SetFrameInfo(par.vpp.Out, opt.outWidth, opt.outHeight);
+    par.IOPattern  = MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+    par.AsyncDepth = opt.async;
+
+    mfxStatus sts = session.InitEx(initPar);
+    if (sts >= MFX_ERR_NONE && opt.high)
+        sts = MFXSetPriority(session, (idx < opt.high) ? MFX_PRIORITY_HIGH : MFX_PRIORITY_LOW);
+
+    mfxFrameAllocRequest request[2] = {};
+    if (sts >= MFX_ERR_NONE)
+        sts = vpp.QueryIOSurf(&par, request);
+    if (sts >= MFX_ERR_NONE)
+    {
+        inPool.Alloc(par.vpp.In, request[0].NumFrameSuggested);
+        outPool.Alloc(par.vpp.Out, request[1].NumFrameSuggested);
+        sts = vpp.Init(&par);
+    }
+
+    initialized.Arrive();
+    if (sts < MFX_ERR_NONE)
+    {
+        printf("session %u: initialization failed: %d\n", idx, sts);
+        started.Arrive();
+        return;
+    }
+
+    // the number of threads when all sessions are initialized
+    initialized.Wait();
+    if (0 == idx)
+        numThreads = GetNumProcessThreads();
+    started.Arrive();
+    started.Wait();
+
+    const mfxU32 depth = opt.async ? opt.async : 4;
+    std::vector<mfxSyncPoint> inFlight;
+    mfxU32 submitted = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (submitted < opt.frames || !inFlight.empty())
+    {
+        if (submitted < opt.frames && inFlight.size() < depth)
+        {
+            mfxFrameSurface1 * src = inPool.GetFree();
+            mfxFrameSurface1 * dst = outPool.GetFree();
+            mfxSyncPoint syncp = 0;
+
+            sts = (src && dst) ? vpp.RunFrameVPPAsync(src, dst, 0, &syncp) : MFX_WRN_DEVICE_BUSY;
+
+            if (MFX_ERR_NONE == sts && syncp)
+            {
+                inFlight.push_back(syncp);
+                submitted++;
+                continue;
+            }
+            if (sts < MFX_ERR_NONE)
+            {
+                printf("session %u: RunFrameVPPAsync failed: %d\n", idx, sts);
+                return;
+            }
+        }
+
+        if (!inFlight.empty())
+        {
+            sts = session.SyncOperation(inFlight.front(), 60000);
+            if (sts < MFX_ERR_NONE)
+            {
+                printf("session %u: SyncOperation failed: %d\n", idx, sts);
+                return;
+            }
+            inFlight.erase(inFlight.begin());
+        }
+    }
+
+    result.sec    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.frames = opt.frames;
+    result.ok     = true;
+
+    vpp.Close();
+}
+
+int main(int argc, char *argv[])
+{
+    Options opt = {};
+    opt.sessions  = 16;
+    opt.frames    = 300;
+    opt.width     = 960;
+    opt.height    = 540;
+    opt.outWidth  = 640;
+    opt.outHeight = 360;
+    opt.async     = 4;
+    bool shared   = false;
+    const char * numa = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool ok = true;
+
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            opt.sessions = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            opt.frames = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            opt.width = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            opt.height = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-ow") && i + 1 < argc)
+            opt.outWidth = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-oh") && i + 1 < argc)
+            opt.outHeight = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-async") && i + 1 < argc)
+            opt.async = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            opt.threads = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-high") && i + 1 < argc)
+            opt.high = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-shared"))
+            shared = true;
+        else if (!strcmp(argv[i], "-numa") && i + 1 < argc)
+            numa = argv[++i];
+        else
+            ok = false;
+
+        if (!ok || !opt.sessions || !opt.width || !opt.height || !opt.outWidth || !opt.outHeight)
+        {
+            printf("usage: %s [-s sessions] [-n frames] [-w width -h height -ow width -oh height]\n"
+                   "          [-async depth] [-t threads] [-high sessions] [-shared] [-numa auto|node]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!opt.frames)
+        opt.frames = 1;
+
+    // the scheduler reads it at session initialization
+    if (shared)
+        setenv("MFX_SCHEDULER_SHARED_POOL", "1", 1);
+    if (numa)
+        setenv("MFX_SCHEDULER_NUMA_NODE", numa, 1);
+
+    StartGate initialized(opt.sessions), started(opt.sessions);
+    std::atomic<int> numThreads(-1);
+    std::vector<SessionResult> results(opt.sessions);
+    std::vector<std::thread> threads;
+
+    struct rusage usage0 = {}, usage1 = {};
+    getrusage(RUSAGE_SELF, &usage0);
+    const NumaStat numa0 = GetNumaStat();
+    auto start = std::chrono::steady_clock::now();
+
+    for (mfxU32 i = 0; i < opt.sessions; i++)
+    {
+        threads.emplace_back(RunSession, std::cref(opt), i, std::ref(initialized), std::ref(started),
+                             std::ref(numThreads), std::ref(results[i]));
+    }
+    for (auto & thread : threads)
+        thread.join();
+
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    getrusage(RUSAGE_SELF, &usage1);
+    const NumaStat numa1 = GetNumaStat();
+
+    mfxU32 frames = 0, failed = 0;
+    double fpsHigh = 0, fpsLow = 0;
+
+    for (mfxU32 i = 0; i < opt.sessions; i++)
+    {
+        if (!results[i].ok)
+        {
+            failed++;
+            continue;
+        }
+
+        frames += results[i].frames;
+        const double fps = results[i].frames / results[i].sec;
+        if (i < opt.high)
+            fpsHigh += fps;
+        else
+            fpsLow += fps;
+    }
+
+    const long voluntary   = usage1.ru_nvcsw - usage0.ru_nvcsw;
+    const long involuntary = usage1.ru_nivcsw - usage0.ru_nivcsw;
+
+    printf("%u sessions [%s pool] %ux%u -> %ux%u async %u: %d threads, %u frames, %.3f sec, %.1f fps\n",
+        opt.sessions, shared ? "shared" : "per-session", opt.width, opt.height, opt.outWidth, opt.outHeight,
+        opt.async ? opt.async : 4, (int)numThreads, frames, sec, frames / sec);
+    printf("context switches: %ld voluntary, %ld involuntary, %.1f per frame\n",
+        voluntary, involuntary, frames ? double(voluntary + involuntary) / frames : 0.);
+
+    printf("numa [%s]: %llu local pages, %llu numa_miss, %llu other_node\n", numa ? numa : "any",
+        numa1.local - numa0.local, numa1.miss - numa0.miss, numa1.otherNode - numa0.otherNode);
+
+    if (opt.high && opt.high < opt.sessions)
+    {
+        printf("high priority: %.1f fps per session, low priority: %.1f fps per session\n",
+            fpsHigh / opt.high, fpsLow / (opt.sessions - opt.high));
+    }
+    if (failed)
+        printf("%u sessions failed\n", failed);
+
+    return failed ? 1 : 0;
+}
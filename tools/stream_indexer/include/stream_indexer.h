@@ -0,0 +1,61 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __STREAM_INDEXER_H__
+#define __STREAM_INDEXER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+
+#include "stream_index.h"
+
+// Builds CStreamIndex for a complete stream held in memory.
+// Only parameter sets and the first bytes of picture headers are parsed,
+// slice and tile data are skipped.
+class StreamIndexer
+{
+public:
+    virtual ~StreamIndexer() {}
+
+    // data must stay writable: UMC splitters take non-const buffers
+    virtual mfxStatus Run(uint8_t *data, size_t size, CStreamIndex &index) = 0;
+};
+
+// Elementary streams (Annex B / MPEG-2 video ES)
+std::unique_ptr<StreamIndexer> CreateAVCIndexer();
+std::unique_ptr<StreamIndexer> CreateHEVCIndexer();
+std::unique_ptr<StreamIndexer> CreateMPEG2Indexer();
+
+// IVF container, codec is taken from the file header (VP8, VP9 or AV1)
+std::unique_ptr<StreamIndexer> CreateIVFIndexer();
+
+// Offset of the start code (including zero_byte) in front of NAL unit payload 'nal'
+inline size_t StartCodeOffset(const uint8_t *base, const uint8_t *nal)
+{
+    size_t offset = (size_t)(nal - base);
+    offset = offset >= 3 ? offset - 3 : 0;
+    if (offset && !base[offset - 1])
+        offset--;
+
+    return offset;
+}
+
+#endif // __STREAM_INDEXER_H__
@@ -0,0 +1,425 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "umc_defs.h"
+#include "stream_indexer.h"
+
+#if defined(MFX_ENABLE_H264_VIDEO_DECODE)
+
+#include <algorithm>
+
+#include "umc_h264_nal_spl.h"
+#include "umc_h264_bitstream_headers.h"
+#include "umc_h264_heap.h"
+
+using namespace UMC;
+using namespace UMC_H264_DECODER;
+
+namespace
+{
+    // frame_num, POC syntax and redundant_pic_cnt are at the very beginning
+    // of the slice header, there is no need to unescape the whole slice data
+    const size_t SLICE_HEADER_PREFIX_SIZE = 64;
+
+    const size_t NO_AU_START = size_t(-1);
+
+    const uint32_t SEI_RECOVERY_POINT = 6;
+
+    bool IsVCL(int32_t type)
+    {
+        return type == NAL_UT_SLICE || type == NAL_UT_IDR_SLICE;
+    }
+
+    // NAL units which may start an access unit (7.4.1.2.3)
+    bool IsAUPrefix(int32_t type)
+    {
+        return (type >= NAL_UT_SEI && type <= NAL_UT_AUD)
+            || (type >= NAL_UT_SPS_EX && type <= 18);
+    }
+
+    class AVCIndexer : public StreamIndexer
+    {
+    public:
+
+        AVCIndexer()
+            : m_prevPocMsb(0)
+            , m_prevPocLsb(0)
+            , m_prevFrameNum(0)
+            , m_prevFrameNumOffset(0)
+            , m_recoveryPoint(false)
+            , m_expectSecondField(false)
+            , m_firstFieldBottom(false)
+            , m_firstFieldRef(false)
+            , m_firstFieldFrameNum(0)
+            , m_entry()
+            , m_pending(false)
+        {
+        }
+
+        mfxStatus Run(uint8_t *data, size_t size, CStreamIndex &index) override;
+
+    private:
+
+        void Load(H264HeadersBitstream &bs, uint8_t *nal, size_t size);
+        void ParseSPS(H264HeadersBitstream &bs);
+        void ParsePPS(H264HeadersBitstream &bs);
+        bool ParseSEI(H264HeadersBitstream &bs);
+        bool ParseFirstSlice(H264HeadersBitstream &bs, NAL_Unit_Type type, uint32_t nal_ref_idc, StreamIndexEntry &entry);
+        int32_t GetPOC(H264SliceHeader const &hdr, H264SeqParamSet const &sps);
+
+        NALUnitSplitter      m_splitter;
+        H264MemoryPiece      m_swapped;
+
+        H264SeqParamSet      m_sps[MAX_NUM_SEQ_PARAM_SETS];
+        H264PicParamSet      m_pps[MAX_NUM_PIC_PARAM_SETS];
+
+        // 8.2.1, state carried from the previous (reference) picture
+        int32_t              m_prevPocMsb;
+        int32_t              m_prevPocLsb;
+        int32_t              m_prevFrameNum;
+        int32_t              m_prevFrameNumOffset;
+        bool                 m_recoveryPoint;   // recovery point SEI in the current access unit
+
+        // unpaired field, the next field of opposite parity may complete the frame (7.4.1.2.4)
+        bool                 m_expectSecondField;
+        bool                 m_firstFieldBottom;
+        bool                 m_firstFieldRef;
+        int32_t              m_firstFieldFrameNum;
+
+        // entry of the last picture, added at the next one, so the second field can lower its order
+        StreamIndexEntry     m_entry;
+        bool                 m_pending;
+    };
+
+    // Removes emulation prevention bytes and resets bs to the result
+    void AVCIndexer::Load(H264HeadersBitstream &bs, uint8_t *nal, size_t size)
+    {
+        MediaData piece;
+        piece.SetBufferPointer(nal, size);
+        piece.SetDataSize(size);
+
+        H264MemoryPiece mem;
+        mem.SetData(&piece);
+
+        if (m_swapped.GetSize() < size + DEFAULT_NU_TAIL_SIZE)
+            m_swapped.Allocate(size + DEFAULT_NU_TAIL_SIZE);
+
+        m_splitter.GetSwapper()->SwapMemory(&m_swapped, &mem);
+
+        bs.Reset(m_swapped.GetPointer(), (uint32_t)m_swapped.GetDataSize());
+    }
+
+    void AVCIndexer::ParseSPS(H264HeadersBitstream &bs)
+    {
+        H264SeqParamSet sps;
+
+        if (bs.GetSequenceParamSet(&sps) != UMC_OK)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        m_sps[sps.seq_parameter_set_id] = sps;
+    }
+
+    void AVCIndexer::ParsePPS(H264HeadersBitstream &bs)
+    {
+        H264PicParamSet pps;
+
+        if (bs.GetPictureParamSetPart1(&pps) != UMC_OK)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        H264SeqParamSet const &sps = m_sps[pps.seq_parameter_set_id];
+        if (sps.seq_parameter_set_id == MAX_NUM_SEQ_PARAM_SETS)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        if (bs.GetPictureParamSetPart2(&pps, &sps) != UMC_OK)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        m_pps[pps.pic_parameter_set_id] = pps;
+    }
+
+    // Looks for recovery_point() in the SEI message list
+    bool AVCIndexer::ParseSEI(H264HeadersBitstream &bs)
+    {
+        while (bs.More_RBSP_Data())
+        {
+            uint32_t payloadType = 0, payloadSize = 0, byte;
+
+            do { byte = bs.GetBits(8); payloadType += byte; } while (byte == 0xff);
+            do { byte = bs.GetBits(8); payloadSize += byte; } while (byte == 0xff);
+
+            if (payloadType == SEI_RECOVERY_POINT)
+                return true;
+
+            if (payloadSize > bs.BytesLeft())
+                break;
+
+            bs.SetDecodedBytes(bs.BytesDecoded() + payloadSize);
+        }
+
+        return false;
+    }
+
+    int32_t AVCIndexer::GetPOC(H264SliceHeader const &hdr, H264SeqParamSet const &sps)
+    {
+        int32_t const maxFrameNum = 1 << sps.log2_max_frame_num;
+
+        int32_t frameNumOffset = 0;
+        if (!hdr.IdrPicFlag)
+            frameNumOffset = m_prevFrameNumOffset + (m_prevFrameNum > hdr.frame_num ? maxFrameNum : 0);
+
+        int32_t top = 0, bottom = 0;
+
+        if (sps.pic_order_cnt_type == 0)
+        {
+            // 8.2.1.1, memory_management_control_operation 5 is not tracked
+            int32_t const maxLsb = 1 << sps.log2_max_pic_order_cnt_lsb;
+            int32_t const lsb    = hdr.pic_order_cnt_lsb;
+            int32_t const prevLsb = hdr.IdrPicFlag ? 0 : m_prevPocLsb;
+            int32_t const prevMsb = hdr.IdrPicFlag ? 0 : m_prevPocMsb;
+
+            int32_t msb = prevMsb;
+            if (lsb < prevLsb && (prevLsb - lsb) >= maxLsb / 2)
+                msb = prevMsb + maxLsb;
+            else if (lsb > prevLsb && (lsb - prevLsb) > maxLsb / 2)
+                msb = prevMsb - maxLsb;
+
+            top    = msb + lsb;
+            bottom = hdr.field_pic_flag ? top : top + hdr.delta_pic_order_cnt_bottom;
+
+            if (hdr.nal_ref_idc)
+            {
+                m_prevPocMsb = msb;
+                m_prevPocLsb = lsb;
+            }
+        }
+        else if (sps.pic_order_cnt_type == 1)
+        {
+            // 8.2.1.2
+            uint32_t const cycle = sps.num_ref_frames_in_pic_order_cnt_cycle;
+
+            int32_t absFrameNum = cycle ? frameNumOffset + hdr.frame_num : 0;
+            if (!hdr.nal_ref_idc && absFrameNum > 0)
+                absFrameNum--;
+
+            int32_t expected = 0;
+            if (absFrameNum > 0)
+            {
+                int32_t deltaPerCycle = 0;
+                for (uint32_t i = 0; i < cycle; i++)
+                    deltaPerCycle += sps.poffset_for_ref_frame[i];
+
+                int32_t const cycleCnt     = (absFrameNum - 1) / cycle;
+                int32_t const frameInCycle = (absFrameNum - 1) % cycle;
+
+                expected = cycleCnt * deltaPerCycle;
+                for (int32_t i = 0; i <= frameInCycle; i++)
+                    expected += sps.poffset_for_ref_frame[i];
+            }
+
+            if (!hdr.nal_ref_idc)
+                expected += sps.offset_for_non_ref_pic;
+
+            if (!hdr.field_pic_flag)
+            {
+                top    = expected + hdr.delta_pic_order_cnt[0];
+                bottom = top + sps.offset_for_top_to_bottom_field + hdr.delta_pic_order_cnt[1];
+            }
+            else
+            {
+                top    = expected + hdr.delta_pic_order_cnt[0];
+                bottom = expected + sps.offset_for_top_to_bottom_field + hdr.delta_pic_order_cnt[0];
+            }
+        }
+        else
+        {
+            // 8.2.1.3
+            int32_t poc = 0;
+            if (!hdr.IdrPicFlag)
+                poc = 2 * (frameNumOffset + hdr.frame_num) - (hdr.nal_ref_idc ? 0 : 1);
+
+            top = bottom = poc;
+        }
+
+        m_prevFrameNum       = hdr.frame_num;
+        m_prevFrameNumOffset = frameNumOffset;
+
+        if (!hdr.field_pic_flag)
+            return std::min(top, bottom);
+
+        return hdr.bottom_field_flag ? bottom : top;
+    }
+
+    // Returns false for slices which don't start a new picture and for second fields,
+    // a field pair gets one entry as in the MPEG-2 indexer, ordered by the frame POC
+    bool AVCIndexer::ParseFirstSlice(H264HeadersBitstream &bs, NAL_Unit_Type type, uint32_t nal_ref_idc, StreamIndexEntry &entry)
+    {
+        H264SliceHeader hdr = {};
+        hdr.nal_unit_type = type;
+        hdr.nal_ref_idc   = nal_ref_idc;
+
+        if (bs.GetSliceHeaderPart1(&hdr) != UMC_OK)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        // arbitrary slice order is not supported
+        if (hdr.first_mb_in_slice)
+            return false;
+
+        H264PicParamSet const &pps = m_pps[hdr.pic_parameter_set_id];
+        if (pps.pic_parameter_set_id == MAX_NUM_PIC_PARAM_SETS
+            || m_sps[pps.seq_parameter_set_id].seq_parameter_set_id == MAX_NUM_SEQ_PARAM_SETS)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        H264SeqParamSet const &sps = m_sps[pps.seq_parameter_set_id];
+
+        if (bs.GetSliceHeaderPart2(&hdr, &pps, &sps) != UMC_OK)
+            throw h264_exception(UMC_ERR_INVALID_STREAM);
+
+        // redundant coded pictures are not separate entries
+        if (hdr.redundant_pic_cnt)
+            return false;
+
+        // POC state is updated by both fields
+        int32_t const poc = GetPOC(hdr, sps);
+
+        // the second field of an IDR picture is a non-IDR picture, an IDR field
+        // marks the first one unused and always starts a new frame
+        bool const second = hdr.field_pic_flag && m_expectSecondField
+            && !hdr.IdrPicFlag
+            && !!hdr.bottom_field_flag != m_firstFieldBottom
+            && !!hdr.nal_ref_idc == m_firstFieldRef
+            && hdr.frame_num == m_firstFieldFrameNum;
+
+        m_expectSecondField  = hdr.field_pic_flag && !second;
+        m_firstFieldBottom   = !!hdr.bottom_field_flag;
+        m_firstFieldRef      = !!hdr.nal_ref_idc;
+        m_firstFieldFrameNum = hdr.frame_num;
+
+        if (second)
+        {
+            m_entry.Order = std::min(m_entry.Order, poc);
+            return false;
+        }
+
+        bool const intra = hdr.slice_type == INTRASLICE || hdr.slice_type == S_INTRASLICE;
+        bool const rap   = hdr.IdrPicFlag || (intra && m_recoveryPoint);
+
+        entry.Order     = poc;
+        entry.FrameType = (mfxU8)(intra ? MFX_FRAMETYPE_I : (hdr.slice_type == BPREDSLICE ? MFX_FRAMETYPE_B : MFX_FRAMETYPE_P));
+        entry.SeqId     = (mfxU8)pps.seq_parameter_set_id;
+        entry.Flags     = (mfxU8)((rap ? STREAM_INDEX_RAP : 0) | (hdr.IdrPicFlag ? STREAM_INDEX_IDR : 0) | STREAM_INDEX_SHOWN);
+
+        return true;
+    }
+
+    mfxStatus AVCIndexer::Run(uint8_t *data, size_t size, CStreamIndex &index)
+    {
+        index.Reset(MFX_CODEC_AVC, size);
+        m_splitter.Init();
+
+        m_expectSecondField = false;
+        m_pending           = false;
+
+        MediaData src;
+        src.SetBufferPointer(data, size);
+        src.SetDataSize(size);
+
+        size_t auStart = NO_AU_START;
+        mfxU32 broken = 0;
+
+        for (NalUnit *nal = m_splitter.GetNalUnits(&src); nal; nal = m_splitter.GetNalUnits(&src))
+        {
+            int32_t const type = nal->GetNalUnitType();
+            uint8_t *ptr = (uint8_t*)nal->GetDataPointer();
+            size_t const offset = StartCodeOffset(data, ptr);
+
+            if (IsAUPrefix(type) && auStart == NO_AU_START)
+                auStart = offset;
+
+            bool const vcl = IsVCL(type);
+            if (!vcl && type != NAL_UT_SPS && type != NAL_UT_PPS && type != NAL_UT_SEI)
+                continue;
+
+            size_t const nalSize = vcl ? std::min(nal->GetDataSize(), SLICE_HEADER_PREFIX_SIZE) : nal->GetDataSize();
+
+            try
+            {
+                H264HeadersBitstream bs;
+                Load(bs, ptr, nalSize);
+
+                NAL_Unit_Type nal_unit_type;
+                uint32_t nal_ref_idc;
+                bs.GetNALUnitType(nal_unit_type, nal_ref_idc);
+
+                if (type == NAL_UT_SPS)
+                    ParseSPS(bs);
+                else if (type == NAL_UT_PPS)
+                    ParsePPS(bs);
+                else if (type == NAL_UT_SEI)
+                    m_recoveryPoint = ParseSEI(bs) || m_recoveryPoint;
+                else
+                {
+                    StreamIndexEntry entry = {};
+                    if (ParseFirstSlice(bs, nal_unit_type, nal_ref_idc, entry))
+                    {
+                        if (m_pending)
+                            index.Add(m_entry);
+
+                        entry.Offset = auStart != NO_AU_START ? auStart : offset;
+                        m_entry   = entry;
+                        m_pending = true;
+                    }
+                }
+            }
+            catch (h264_exception const&)
+            {
+                // corrupted headers and references to missing parameter sets are skipped
+                broken++;
+            }
+
+            if (vcl)
+            {
+                auStart = NO_AU_START;
+                m_recoveryPoint = false;
+            }
+        }
+
+        if (m_pending)
+            index.Add(m_entry);
+
+        if (broken)
+            msdk_printf(MSDK_STRING("WARNING: %u NAL units skipped\n"), broken);
+
+        return index.GetCount() ? MFX_ERR_NONE : MFX_ERR_NOT_FOUND;
+    }
+}
+
+std::unique_ptr<StreamIndexer> CreateAVCIndexer()
+{
+    return std::unique_ptr<StreamIndexer>(new AVCIndexer());
+}
+
+#else
+
+std::unique_ptr<StreamIndexer> CreateAVCIndexer()
+{
+    return nullptr;
+}
+
+#endif // MFX_ENABLE_H264_VIDEO_DECODE
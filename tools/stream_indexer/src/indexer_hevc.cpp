@@ -0,0 +1,296 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "umc_defs.h"
+#include "stream_indexer.h"
+
+#if defined(MFX_ENABLE_H265_VIDEO_DECODE)
+
+#include <algorithm>
+
+#include "umc_h265_nal_spl.h"
+#include "umc_h265_bitstream_headers.h"
+#include "umc_h265_heap.h"
+
+using namespace UMC_HEVC_DECODER;
+
+namespace
+{
+    // Fields read from the first slice segment header of a picture are
+    // within a few bytes, there is no need to unescape the whole slice data
+    const size_t SLICE_HEADER_PREFIX_SIZE = 64;
+
+    const size_t NO_AU_START = size_t(-1);
+
+    struct SpsInfo
+    {
+        bool     valid;
+        uint32_t log2_max_pic_order_cnt_lsb;
+        uint32_t separate_colour_plane_flag;
+    };
+
+    struct PpsInfo
+    {
+        bool     valid;
+        uint32_t sps_id;
+        uint32_t output_flag_present_flag;
+        uint32_t num_extra_slice_header_bits;
+    };
+
+    bool IsVCL(int32_t type)
+    {
+        return type <= NAL_UT_CODED_SLICE_RASL_R
+            || (type >= NAL_UT_CODED_SLICE_BLA_W_LP && type <= NAL_UT_CODED_SLICE_CRA);
+    }
+
+    // NAL units which may start an access unit (7.4.2.4.4)
+    bool IsAUPrefix(int32_t type)
+    {
+        return (type >= NAL_UT_VPS && type <= NAL_UT_AU_DELIMITER)
+            || type == NAL_UT_SEI
+            || (type >= 41 && type <= 44)
+            || (type >= 48 && type <= 55);
+    }
+
+    class HEVCIndexer : public StreamIndexer
+    {
+    public:
+
+        HEVCIndexer()
+            : m_prevTid0Lsb(0)
+            , m_prevTid0Msb(0)
+            , m_afterEOS(true)
+        {
+            std::fill(m_sps, m_sps + 16, SpsInfo{});
+            std::fill(m_pps, m_pps + 64, PpsInfo{});
+        }
+
+        mfxStatus Run(uint8_t *data, size_t size, CStreamIndex &index) override;
+
+    private:
+
+        void Load(H265HeadersBitstream &bs, uint8_t *nal, size_t size);
+        void ParseSPS(H265HeadersBitstream &bs);
+        void ParsePPS(H265HeadersBitstream &bs);
+        bool ParseFirstSlice(H265HeadersBitstream &bs, NalUnitType type, uint32_t tid, StreamIndexEntry &entry);
+
+        NALUnitSplitter_H265 m_splitter;
+        MemoryPiece          m_swapped;
+
+        SpsInfo              m_sps[16];
+        PpsInfo              m_pps[64];
+
+        // 8.3.1, POC of the previous TemporalId = 0 picture
+        int32_t              m_prevTid0Lsb;
+        int32_t              m_prevTid0Msb;
+        bool                 m_afterEOS;    // next CRA has NoRaslOutputFlag = 1
+    };
+
+    // Removes emulation prevention bytes and resets bs to the result
+    void HEVCIndexer::Load(H265HeadersBitstream &bs, uint8_t *nal, size_t size)
+    {
+        UMC::MediaData piece;
+        piece.SetBufferPointer(nal, size);
+        piece.SetDataSize(size);
+
+        MemoryPiece mem;
+        mem.SetData(&piece);
+
+        if (m_swapped.GetSize() < size + DEFAULT_NU_TAIL_SIZE)
+            m_swapped.Allocate(size + DEFAULT_NU_TAIL_SIZE);
+
+        m_splitter.GetSwapper()->SwapMemory(&m_swapped, &mem, 0);
+
+        bs.Reset(m_swapped.GetPointer(), (uint32_t)m_swapped.GetDataSize());
+    }
+
+    void HEVCIndexer::ParseSPS(H265HeadersBitstream &bs)
+    {
+        H265SeqParamSet sps;
+        sps.Reset();
+
+        if (bs.GetSequenceParamSet(&sps) != UMC::UMC_OK)
+            throw h265_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+        SpsInfo &info = m_sps[sps.sps_seq_parameter_set_id];
+        info.valid                      = true;
+        info.log2_max_pic_order_cnt_lsb = sps.log2_max_pic_order_cnt_lsb;
+        info.separate_colour_plane_flag = sps.separate_colour_plane_flag;
+    }
+
+    void HEVCIndexer::ParsePPS(H265HeadersBitstream &bs)
+    {
+        H265PicParamSet pps;
+        pps.Reset();
+
+        bs.GetPictureParamSetPart1(&pps);
+
+        PpsInfo &info = m_pps[pps.pps_pic_parameter_set_id];
+        info.valid  = true;
+        info.sps_id = pps.pps_seq_parameter_set_id;
+
+        bs.Get1Bit(); // dependent_slice_segments_enabled_flag
+        info.output_flag_present_flag    = bs.Get1Bit();
+        info.num_extra_slice_header_bits = bs.GetBits(3);
+    }
+
+    // Returns false for slice segments which don't start a new picture
+    bool HEVCIndexer::ParseFirstSlice(H265HeadersBitstream &bs, NalUnitType type, uint32_t tid, StreamIndexEntry &entry)
+    {
+        H265SliceHeader hdr = {};
+        hdr.nal_unit_type = type;
+        bs.GetSliceHeaderPart1(&hdr);
+
+        if (!hdr.first_slice_segment_in_pic_flag)
+            return false;
+
+        PpsInfo const &pps = m_pps[hdr.slice_pic_parameter_set_id];
+        if (!pps.valid || !m_sps[pps.sps_id].valid)
+            throw h265_exception(UMC::UMC_ERR_INVALID_STREAM);
+
+        SpsInfo const &sps = m_sps[pps.sps_id];
+
+        if (pps.num_extra_slice_header_bits)
+            bs.GetBits(pps.num_extra_slice_header_bits);
+
+        uint32_t const slice_type = bs.GetVLCElementU();
+        uint32_t const pic_output_flag = pps.output_flag_present_flag ? bs.Get1Bit() : 1;
+
+        if (sps.separate_colour_plane_flag)
+            bs.GetBits(2); // colour_plane_id
+
+        int32_t const lsb = hdr.IdrPicFlag ? 0 : (int32_t)bs.GetBits(sps.log2_max_pic_order_cnt_lsb);
+        int32_t const maxLsb = 1 << sps.log2_max_pic_order_cnt_lsb;
+
+        bool const irap = type >= NAL_UT_CODED_SLICE_BLA_W_LP && type <= NAL_UT_CODED_SLICE_CRA;
+        bool const noRaslOutput = irap && (type != NAL_UT_CODED_SLICE_CRA || m_afterEOS);
+
+        int32_t msb = 0;
+        if (!noRaslOutput)
+        {
+            if (lsb < m_prevTid0Lsb && (m_prevTid0Lsb - lsb) >= maxLsb / 2)
+                msb = m_prevTid0Msb + maxLsb;
+            else if (lsb > m_prevTid0Lsb && (lsb - m_prevTid0Lsb) > maxLsb / 2)
+                msb = m_prevTid0Msb - maxLsb;
+            else
+                msb = m_prevTid0Msb;
+        }
+
+        bool const leading    = type >= NAL_UT_CODED_SLICE_RADL_N && type <= NAL_UT_CODED_SLICE_RASL_R;
+        bool const subLayerNR = type <= NAL_UT_CODED_SLICE_RASL_R && !(type & 1);
+        if (!tid && !leading && !subLayerNR)
+        {
+            m_prevTid0Lsb = lsb;
+            m_prevTid0Msb = msb;
+        }
+
+        m_afterEOS = false;
+
+        entry.Order     = msb + lsb;
+        entry.FrameType = (mfxU8)(slice_type == I_SLICE ? MFX_FRAMETYPE_I : (slice_type == P_SLICE ? MFX_FRAMETYPE_P : MFX_FRAMETYPE_B));
+        entry.SeqId     = (mfxU8)pps.sps_id;
+        entry.Flags     = (mfxU8)((irap ? STREAM_INDEX_RAP : 0) | (hdr.IdrPicFlag ? STREAM_INDEX_IDR : 0) | (pic_output_flag ? STREAM_INDEX_SHOWN : 0));
+
+        return true;
+    }
+
+    mfxStatus HEVCIndexer::Run(uint8_t *data, size_t size, CStreamIndex &index)
+    {
+        index.Reset(MFX_CODEC_HEVC, size);
+        m_splitter.Init();
+
+        UMC::MediaData src;
+        src.SetBufferPointer(data, size);
+        src.SetDataSize(size);
+
+        size_t auStart = NO_AU_START;
+        mfxU32 broken = 0;
+
+        for (UMC::MediaDataEx *nal = m_splitter.GetNalUnits(&src); nal; nal = m_splitter.GetNalUnits(&src))
+        {
+            int32_t const type = nal->GetExData()->values[0];
+            uint8_t *ptr = (uint8_t*)nal->GetDataPointer();
+            size_t const offset = StartCodeOffset(data, ptr);
+
+            if (IsAUPrefix(type) && auStart == NO_AU_START)
+                auStart = offset;
+
+            if (type == NAL_UT_EOS)
+                m_afterEOS = true;
+
+            bool const vcl = IsVCL(type);
+            if (!vcl && type != NAL_UT_SPS && type != NAL_UT_PPS)
+                continue;
+
+            size_t const nalSize = vcl ? std::min(nal->GetDataSize(), SLICE_HEADER_PREFIX_SIZE) : nal->GetDataSize();
+
+            try
+            {
+                H265HeadersBitstream bs;
+                Load(bs, ptr, nalSize);
+
+                NalUnitType nal_unit_type;
+                uint32_t temporal_id;
+                bs.GetNALUnitType(nal_unit_type, temporal_id);
+
+                if (type == NAL_UT_SPS)
+                    ParseSPS(bs);
+                else if (type == NAL_UT_PPS)
+                    ParsePPS(bs);
+                else
+                {
+                    StreamIndexEntry entry = {};
+                    if (ParseFirstSlice(bs, nal_unit_type, temporal_id, entry))
+                    {
+                        entry.Offset = auStart != NO_AU_START ? auStart : offset;
+                        index.Add(entry);
+                    }
+                }
+            }
+            catch (h265_exception const&)
+            {
+                // nuh_layer_id > 0 units and corrupted headers are skipped
+                broken++;
+            }
+
+            if (vcl)
+                auStart = NO_AU_START;
+        }
+
+        if (broken)
+            msdk_printf(MSDK_STRING("WARNING: %u NAL units skipped\n"), broken);
+
+        return index.GetCount() ? MFX_ERR_NONE : MFX_ERR_NOT_FOUND;
+    }
+}
+
+std::unique_ptr<StreamIndexer> CreateHEVCIndexer()
+{
+    return std::unique_ptr<StreamIndexer>(new HEVCIndexer());
+}
+
+#else
+
+std::unique_ptr<StreamIndexer> CreateHEVCIndexer()
+{
+    return nullptr;
+}
+
+#endif // MFX_ENABLE_H265_VIDEO_DECODE
@@ -0,0 +1,316 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "umc_defs.h"
+#include "stream_indexer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mfxvp8.h"
+#include "sample_defs.h"
+
+#if defined(MFX_ENABLE_VP9_VIDEO_DECODE)
+#include "umc_structures.h"
+#include "umc_vp9_bitstream.h"
+#endif
+
+#if defined(MFX_ENABLE_AV1_VIDEO_DECODE)
+#include "umc_av1_decoder.h"
+#endif
+
+namespace
+{
+    const size_t IVF_FILE_HEADER_SIZE  = 32;
+    const size_t IVF_FRAME_HEADER_SIZE = 12;
+
+    struct IVFFrame
+    {
+        size_t   offset;    // of the 12-byte frame header
+        uint8_t *data;
+        uint32_t size;
+    };
+
+    // Summary of all frames coded in one IVF frame (VP9 superframe, AV1 temporal unit)
+    struct FrameDesc
+    {
+        bool intra;         // first coded frame is a key or intra-only frame
+        bool key;           // first coded frame is a key frame
+        bool shown;         // at least one frame is output
+    };
+
+    uint32_t ReadLE16(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8);
+    }
+
+    uint32_t ReadLE32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // RFC 6386, 9.1: frame tag
+    mfxStatus DescribeVP8(std::vector<IVFFrame> const &frames, std::vector<FrameDesc> &desc)
+    {
+        for (IVFFrame const &f : frames)
+        {
+            if (!f.size)
+                return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+            bool const key = !(f.data[0] & 1);
+            desc.push_back({ key, key, ((f.data[0] >> 4) & 1) != 0 });
+        }
+
+        return MFX_ERR_NONE;
+    }
+
+#if defined(MFX_ENABLE_VP9_VIDEO_DECODE)
+    // Same as MfxVP9Decode::ParseSuperFrameIndex, which is not available outside of mfx_lib
+    mfxU32 ParseSuperFrameIndex(const uint8_t *data, size_t size, mfxU32 sizes[8])
+    {
+        uint8_t const marker = data[size - 1];
+        if ((marker & 0xe0) != 0xc0)
+            return 0;
+
+        mfxU32 const frames = (marker & 0x7) + 1;
+        mfxU32 const mag    = ((marker >> 3) & 0x3) + 1;
+        size_t const indexSize = 2 + mag * frames;
+
+        if (size < indexSize || data[size - indexSize] != marker)
+            return 0;
+
+        const uint8_t *x = &data[size - indexSize + 1];
+        for (mfxU32 i = 0; i < frames; i++)
+        {
+            sizes[i] = 0;
+            for (mfxU32 j = 0; j < mag; j++)
+                sizes[i] |= (*x++) << (j * 8);
+        }
+
+        return frames;
+    }
+
+    // VP9 bitstream spec, 6.2: uncompressed_header() up to intra_only
+    mfxStatus DescribeVP9(std::vector<IVFFrame> const &frames, std::vector<FrameDesc> &desc)
+    {
+        using namespace UMC_VP9_DECODER;
+
+        for (IVFFrame const &f : frames)
+        {
+            if (!f.size)
+                return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+            mfxU32 sizes[8] = { f.size };
+            mfxU32 count = ParseSuperFrameIndex(f.data, f.size, sizes);
+            count = std::max(count, 1u);
+
+            FrameDesc d = {};
+            uint8_t *data = f.data;
+
+            try
+            {
+                for (mfxU32 i = 0; i < count; data += sizes[i], i++)
+                {
+                    if (data + sizes[i] > f.data + f.size)
+                        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+                    VP9Bitstream bs(data, sizes[i]);
+
+                    if (bs.GetBits(2) != VP9_FRAME_MARKER)
+                        return MFX_ERR_UNDEFINED_BEHAVIOR;
+
+                    uint32_t profile = bs.GetBit();
+                    profile |= bs.GetBit() << 1;
+                    if (profile > 2)
+                        bs.GetBit(); // reserved_zero
+
+                    if (bs.GetBit()) // show_existing_frame
+                    {
+                        d.shown = true;
+                        continue;
+                    }
+
+                    bool const key = bs.GetBit() == KEY_FRAME;
+                    bool const show_frame = bs.GetBit() != 0;
+                    bs.GetBit(); // error_resilient_mode
+
+                    bool const intra = key || (!show_frame && bs.GetBit());
+
+                    if (!i)
+                    {
+                        d.key   = key;
+                        d.intra = intra;
+                    }
+
+                    d.shown = d.shown || show_frame;
+                }
+            }
+            catch (vp9_exception const&)
+            {
+                return MFX_ERR_UNDEFINED_BEHAVIOR;
+            }
+
+            desc.push_back(d);
+        }
+
+        return MFX_ERR_NONE;
+    }
+#endif // MFX_ENABLE_VP9_VIDEO_DECODE
+
+#if defined(MFX_ENABLE_AV1_VIDEO_DECODE)
+    // Frame headers of inter frames depend on the reference state left by earlier
+    // temporal units, so all of them are scanned as a single OBU sequence
+    mfxStatus DescribeAV1(std::vector<IVFFrame> const &frames, std::vector<FrameDesc> &desc)
+    {
+        using namespace UMC_AV1_DECODER;
+
+        std::vector<uint8_t> obus;
+        std::vector<size_t>  starts;    // of every temporal unit in obus
+
+        for (IVFFrame const &f : frames)
+        {
+            starts.push_back(obus.size());
+            obus.insert(obus.end(), f.data, f.data + f.size);
+        }
+
+        UMC::MediaData in;
+        in.SetBufferPointer(obus.data(), obus.size());
+        in.SetDataSize(obus.size());
+
+        std::vector<FrameScanInfo> scan;
+        UMC::Status umcRes = AV1Decoder::ScanFrames(&in, scan);
+
+        desc.assign(frames.size(), FrameDesc{});
+        std::vector<bool> first(frames.size(), true);
+
+        for (FrameScanInfo const &info : scan)
+        {
+            size_t const tu = std::upper_bound(starts.begin(), starts.end(), info.offset) - starts.begin() - 1;
+
+            FrameDesc &d = desc[tu];
+            if (first[tu] && !info.show_existing_frame)
+            {
+                d.key   = info.frame_type == KEY_FRAME && info.show_frame;
+                d.intra = info.frame_type == KEY_FRAME || info.frame_type == INTRA_ONLY_FRAME;
+                first[tu] = false;
+            }
+
+            d.shown = d.shown || info.show_frame || info.show_existing_frame;
+        }
+
+        if (umcRes != UMC::UMC_OK)
+        {
+            // keep temporal units which were scanned before the error
+            size_t const last = scan.empty() ? 0 : std::upper_bound(starts.begin(), starts.end(), scan.back().offset) - starts.begin();
+            desc.resize(last);
+            msdk_printf(MSDK_STRING("WARNING: AV1 scan stopped at temporal unit %u\n"), (mfxU32)last);
+        }
+
+        return MFX_ERR_NONE;
+    }
+#endif // MFX_ENABLE_AV1_VIDEO_DECODE
+
+    class IVFIndexer : public StreamIndexer
+    {
+    public:
+        mfxStatus Run(uint8_t *data, size_t size, CStreamIndex &index) override;
+    };
+
+    mfxStatus IVFIndexer::Run(uint8_t *data, size_t size, CStreamIndex &index)
+    {
+        if (size < IVF_FILE_HEADER_SIZE || ReadLE32(data) != MFX_MAKEFOURCC('D','K','I','F'))
+        {
+            msdk_printf(MSDK_STRING("ERROR: not an IVF file\n"));
+            return MFX_ERR_UNSUPPORTED;
+        }
+
+        mfxU32 const fourcc = ReadLE32(data + 8);
+        size_t offset = std::max<size_t>(ReadLE16(data + 6), IVF_FILE_HEADER_SIZE);
+
+        std::vector<IVFFrame> frames;
+        while (offset + IVF_FRAME_HEADER_SIZE <= size)
+        {
+            uint32_t const frameSize = ReadLE32(data + offset);
+            if (offset + IVF_FRAME_HEADER_SIZE + frameSize > size)
+            {
+                msdk_printf(MSDK_STRING("WARNING: truncated IVF frame at %llu\n"), (unsigned long long)offset);
+                break;
+            }
+
+            frames.push_back({ offset, data + offset + IVF_FRAME_HEADER_SIZE, frameSize });
+            offset += IVF_FRAME_HEADER_SIZE + frameSize;
+        }
+
+        std::vector<FrameDesc> desc;
+        mfxStatus sts = MFX_ERR_UNSUPPORTED;
+
+        switch (fourcc)
+        {
+        case MFX_MAKEFOURCC('V','P','8','0'):
+            index.Reset(MFX_CODEC_VP8, size);
+            sts = DescribeVP8(frames, desc);
+            break;
+#if defined(MFX_ENABLE_VP9_VIDEO_DECODE)
+        case MFX_MAKEFOURCC('V','P','9','0'):
+            index.Reset(MFX_CODEC_VP9, size);
+            sts = DescribeVP9(frames, desc);
+            break;
+#endif
+#if defined(MFX_ENABLE_AV1_VIDEO_DECODE)
+        case MFX_MAKEFOURCC('A','V','0','1'):
+            index.Reset(MFX_CODEC_AV1, size);
+            sts = DescribeAV1(frames, desc);
+            break;
+#endif
+        default:
+            msdk_printf(MSDK_STRING("ERROR: unsupported IVF codec\n"));
+            break;
+        }
+
+        if (sts == MFX_ERR_UNDEFINED_BEHAVIOR)
+            msdk_printf(MSDK_STRING("WARNING: corrupted frame %u, the rest of the stream is not indexed\n"), (mfxU32)desc.size());
+        else
+            MSDK_CHECK_STATUS(sts, "IVF frame parsing failed");
+
+        // Order counts output frames, hidden frames share it with the next shown one
+        mfxI32 order = 0;
+        for (size_t i = 0; i < desc.size(); i++)
+        {
+            StreamIndexEntry entry = {};
+            entry.Offset    = frames[i].offset;
+            entry.Order     = order;
+            entry.FrameType = (mfxU8)(desc[i].intra ? MFX_FRAMETYPE_I : MFX_FRAMETYPE_P);
+            entry.Flags     = (mfxU8)((desc[i].key && desc[i].shown ? STREAM_INDEX_RAP | STREAM_INDEX_IDR : 0) | (desc[i].shown ? STREAM_INDEX_SHOWN : 0));
+
+            index.Add(entry);
+
+            if (desc[i].shown)
+                order++;
+        }
+
+        return index.GetCount() ? MFX_ERR_NONE : MFX_ERR_NOT_FOUND;
+    }
+}
+
+std::unique_ptr<StreamIndexer> CreateIVFIndexer()
+{
+    return std::unique_ptr<StreamIndexer>(new IVFIndexer());
+}
@@ -0,0 +1,224 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "umc_defs.h"
+#include "stream_indexer.h"
+
+#if defined(MFX_ENABLE_MPEG2_VIDEO_DECODE)
+
+#include <algorithm>
+
+#include "umc_mpeg2_splitter.h"
+#include "umc_mpeg2_bitstream.h"
+
+using namespace UMC_MPEG2_DECODER;
+
+namespace
+{
+    const size_t NO_AU_START = size_t(-1);
+
+    const uint8_t SLICE_MIN = 0x01;
+    const uint8_t SLICE_MAX = 0xaf;
+
+    bool IsSlice(uint8_t type)
+    {
+        return type >= SLICE_MIN && type <= SLICE_MAX;
+    }
+
+    // Units are scanned in place rather than through Splitter: it copies
+    // paired headers out of the source buffer and drops MPEG-1 picture headers
+    // (no picture coding extension), both break offset bookkeeping
+    class MPEG2Indexer : public StreamIndexer
+    {
+    public:
+
+        MPEG2Indexer()
+            : m_gopBase(0)
+            , m_maxOrder(-1)
+            , m_closedGop(true)
+            , m_expectSecondField(false)
+        {
+        }
+
+        mfxStatus Run(uint8_t *data, size_t size, CStreamIndex &index) override;
+
+    private:
+
+        void ParseGroup(uint8_t *begin, uint8_t *end);
+        void ParsePicture(uint8_t *begin, uint8_t *end, StreamIndexEntry &entry);
+        uint8_t ParsePictureStructure(uint8_t *begin, uint8_t *end);
+
+        // temporal_reference restarts from 0 after every GOP header
+        int32_t m_gopBase;
+        int32_t m_maxOrder;
+        bool    m_closedGop;
+        bool    m_expectSecondField;
+    };
+
+    void MPEG2Indexer::ParseGroup(uint8_t *begin, uint8_t *end)
+    {
+        MPEG2HeadersBitstream bs(begin + prefix_size + 1, (uint32_t)(end - begin - prefix_size - 1));
+
+        MPEG2GroupOfPictures group;
+        bs.GetGroupOfPicturesHeader(group);
+
+        m_gopBase   = m_maxOrder + 1;
+        m_closedGop = group.closed_gop || group.broken_link;
+    }
+
+    void MPEG2Indexer::ParsePicture(uint8_t *begin, uint8_t *end, StreamIndexEntry &entry)
+    {
+        MPEG2HeadersBitstream bs(begin + prefix_size + 1, (uint32_t)(end - begin - prefix_size - 1));
+
+        MPEG2PictureHeader pic;
+        bs.GetPictureHeader(pic);
+
+        entry.Order     = m_gopBase + pic.temporal_reference;
+        entry.FrameType = (mfxU8)(pic.picture_coding_type == MPEG2_I_PICTURE ? MFX_FRAMETYPE_I :
+            (pic.picture_coding_type == MPEG2_P_PICTURE ? MFX_FRAMETYPE_P : MFX_FRAMETYPE_B));
+        entry.Flags     = STREAM_INDEX_SHOWN;
+    }
+
+    uint8_t MPEG2Indexer::ParsePictureStructure(uint8_t *begin, uint8_t *end)
+    {
+        MPEG2HeadersBitstream bs(begin + prefix_size, (uint32_t)(end - begin - prefix_size));
+        bs.Seek(8 + 4); // skip unit and extension types
+
+        MPEG2PictureCodingExtension picExt;
+        bs.GetPictureExtensionHeader(picExt);
+
+        return picExt.picture_structure;
+    }
+
+    mfxStatus MPEG2Indexer::Run(uint8_t *data, size_t size, CStreamIndex &index)
+    {
+        index.Reset(MFX_CODEC_MPEG2, size);
+
+        uint8_t * const end = data + size;
+
+        size_t auStart   = NO_AU_START;
+        bool   seqHeader = false;       // sequence header in the current access unit
+        bool   pending   = false;       // picture header seen, the picture is not added yet
+        bool   skip      = false;       // second field of a frame or a broken picture header
+        bool   picExt    = false;       // picture coding extension seen, not set for MPEG-1
+        mfxU32 broken    = 0;
+
+        StreamIndexEntry entry = {};
+
+        uint8_t *next = nullptr;
+        for (uint8_t *unit = RawHeaderIterator::FindStartCode(data, end); unit; unit = next)
+        {
+            next = RawHeaderIterator::FindStartCode(unit + prefix_size + 1, end);
+
+            uint8_t * const unitEnd = next ? next : end;
+            uint8_t const type = unit[prefix_size];
+            size_t const offset = (size_t)(unit - data);
+
+            try
+            {
+                if (IsSlice(type))
+                {
+                    // MPEG-1 pictures are always frames
+                    if (pending && !picExt)
+                        m_expectSecondField = false;
+
+                    if (pending && !skip)
+                    {
+                        bool const rap = entry.FrameType == MFX_FRAMETYPE_I && seqHeader;
+
+                        if (rap)
+                            entry.Flags |= STREAM_INDEX_RAP;
+                        if (rap && (m_closedGop || !index.GetCount()))
+                            entry.Flags |= STREAM_INDEX_IDR;
+
+                        entry.Offset = auStart != NO_AU_START ? auStart : offset;
+                        index.Add(entry);
+
+                        m_maxOrder = std::max(m_maxOrder, entry.Order);
+                    }
+
+                    pending   = false;
+                    auStart   = NO_AU_START;
+                    seqHeader = false;
+                    continue;
+                }
+
+                switch (type)
+                {
+                case SEQUENCE_HEADER:
+                    seqHeader = true;
+                    break;
+                case GROUP:
+                    ParseGroup(unit, unitEnd);
+                    break;
+                case PICTURE_HEADER:
+                    entry   = StreamIndexEntry{};
+                    pending = true;
+                    skip    = false;
+                    picExt  = false;
+                    ParsePicture(unit, unitEnd, entry);
+                    break;
+                case EXTENSION:
+                    if (pending && unitEnd - unit > (ptrdiff_t)prefix_size + 1 && (unit[prefix_size + 1] >> 4) == PICTURE_CODING_EXTENSION)
+                    {
+                        bool const field = ParsePictureStructure(unit, unitEnd) != FRM_PICTURE;
+                        skip = field && m_expectSecondField;
+                        m_expectSecondField = field && !skip;
+                        picExt = true;
+                    }
+                    break;
+                }
+            }
+            catch (mpeg2_exception const&)
+            {
+                if (type == PICTURE_HEADER)
+                    skip = true;
+
+                broken++;
+            }
+
+            if (type == SEQUENCE_HEADER || type == GROUP || type == PICTURE_HEADER)
+            {
+                if (auStart == NO_AU_START)
+                    auStart = offset;
+            }
+        }
+
+        if (broken)
+            msdk_printf(MSDK_STRING("WARNING: %u headers skipped\n"), broken);
+
+        return index.GetCount() ? MFX_ERR_NONE : MFX_ERR_NOT_FOUND;
+    }
+}
+
+std::unique_ptr<StreamIndexer> CreateMPEG2Indexer()
+{
+    return std::unique_ptr<StreamIndexer>(new MPEG2Indexer());
+}
+
+#else
+
+std::unique_ptr<StreamIndexer> CreateMPEG2Indexer()
+{
+    return nullptr;
+}
+
+#endif // MFX_ENABLE_MPEG2_VIDEO_DECODE
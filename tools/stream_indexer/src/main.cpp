@@ -0,0 +1,212 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Builds an access unit index (see samples/sample_common/include/stream_index.h)
+// for an elementary stream or an IVF file. The index is consumed by
+// sample_decode -index/-seek and by chunked transcoding scripts (-chunks).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stream_indexer.h"
+
+static void PrintUsage(const char *app)
+{
+    printf("usage: %s h264|h265|mpeg2|ivf -i <input> [-o <index>] [-chunks N] [-v]\n", app);
+    printf("   -o <index>   write index to file\n");
+    printf("   -chunks N    print byte ranges of up to N independently decodable chunks\n");
+    printf("   -v           print all entries\n");
+}
+
+// Whole input is mapped: splitters take non-const buffers, private mapping keeps the file intact
+class MappedFile
+{
+public:
+    MappedFile() : m_data(nullptr), m_size(0) {}
+    ~MappedFile()
+    {
+        if (m_data)
+            munmap(m_data, m_size);
+    }
+
+    bool Open(const char *name)
+    {
+        int fd = open(name, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st = {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+                m_data = (uint8_t*)p;
+                m_size = (size_t)st.st_size;
+            }
+        }
+
+        close(fd);
+        return m_data != nullptr;
+    }
+
+    uint8_t *Data() const { return m_data; }
+    size_t   Size() const { return m_size; }
+
+private:
+    uint8_t *m_data;
+    size_t   m_size;
+};
+
+static char FrameTypeChar(mfxU8 type)
+{
+    return type == MFX_FRAMETYPE_I ? 'I' : (type == MFX_FRAMETYPE_P ? 'P' : 'B');
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    const char *input  = nullptr;
+    const char *output = nullptr;
+    mfxU32 numChunks   = 0;
+    bool verbose       = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            input = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            output = argv[++i];
+        else if (!strcmp(argv[i], "-chunks") && i + 1 < argc)
+            numChunks = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<StreamIndexer> indexer;
+    if (!strcmp(argv[1], "h264"))
+        indexer = CreateAVCIndexer();
+    else if (!strcmp(argv[1], "h265"))
+        indexer = CreateHEVCIndexer();
+    else if (!strcmp(argv[1], "mpeg2"))
+        indexer = CreateMPEG2Indexer();
+    else if (!strcmp(argv[1], "ivf"))
+        indexer = CreateIVFIndexer();
+    else
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!indexer)
+    {
+        printf("%s decoder is disabled in this build\n", argv[1]);
+        return 1;
+    }
+
+    if (!input)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(input))
+    {
+        printf("failed to open %s\n", input);
+        return 1;
+    }
+
+    CStreamIndex index;
+
+    auto start = std::chrono::steady_clock::now();
+    mfxStatus sts = indexer->Run(file.Data(), file.Size(), index);
+    auto stop = std::chrono::steady_clock::now();
+
+    if (sts != MFX_ERR_NONE)
+    {
+        printf("no access units found in %s\n", input);
+        return 1;
+    }
+
+    double const seconds = std::chrono::duration<double>(stop - start).count();
+
+    mfxU32 numRAP = 0, numIDR = 0;
+    for (mfxU32 i = 0; i < index.GetCount(); i++)
+    {
+        StreamIndexEntry const &e = index[i];
+        numRAP += !!(e.Flags & STREAM_INDEX_RAP);
+        numIDR += !!(e.Flags & STREAM_INDEX_IDR);
+
+        if (verbose)
+        {
+            printf("%8u  offset %12llu  order %6d  %c  sps %2u  %s%s%s\n", i,
+                (unsigned long long)e.Offset, e.Order, FrameTypeChar(e.FrameType), e.SeqId,
+                (e.Flags & STREAM_INDEX_RAP) ? "RAP " : "",
+                (e.Flags & STREAM_INDEX_IDR) ? "IDR " : "",
+                (e.Flags & STREAM_INDEX_SHOWN) ? "" : "hidden");
+        }
+    }
+
+    printf("%u access units, %u RAP, %u IDR\n", index.GetCount(), numRAP, numIDR);
+    printf("%.1f MB in %.3f s (%.1f MB/s)\n", file.Size() / 1e6, seconds, seconds > 0 ? file.Size() / 1e6 / seconds : 0.);
+
+    if (numChunks)
+    {
+        std::vector<StreamIndexChunk> chunks;
+        index.GetChunks(numChunks, chunks);
+
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            printf("chunk %2u: bytes %llu-%llu, entries %u-%u\n", (mfxU32)c,
+                (unsigned long long)chunks[c].Begin,
+                (unsigned long long)(chunks[c].End ? chunks[c].End : file.Size()),
+                chunks[c].FirstEntry, chunks[c].FirstEntry + chunks[c].NumEntries - 1);
+        }
+    }
+
+    if (output && index.Save(output) != MFX_ERR_NONE)
+    {
+        printf("failed to write %s\n", output);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,461 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures VP8 frame header parsing speed (uncompressed chunk + first partition
+// header syntax, same walk as VideoDECODEVP8_HW::DecodeFrameHeader) over an IVF file.
+// Frames are loaded into memory first, so file I/O is excluded from the numbers.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "sample_utils.h"
+#include "mfx_vp8_dec_decode_bool_decoder.h"
+
+enum
+{
+    NUM_COEFF_PLANES        = 4,
+    NUM_COEFF_BANDS         = 8,
+    NUM_LOCAL_COMPLEXITIES  = 3,
+    NUM_COEFF_NODES         = 11,
+    NUM_MV_PROBS            = 19,
+    MAX_NUM_OF_SEGMENTS     = 4
+};
+
+// RFC 6386, sections 13.4 and 17.2; must match mfx_vp8_dec_decode_tables.cpp
+static const mfxU8 coeff_update_probs[NUM_COEFF_PLANES][NUM_COEFF_BANDS][NUM_LOCAL_COMPLEXITIES][NUM_COEFF_NODES] =
+{
+  {
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 176, 246, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 223, 241, 252, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 249, 253, 253, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 244, 252, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 234, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 253, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 246, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 239, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 254, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 248, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 251, 255, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 251, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 254, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 253, 255, 254, 255, 255, 255, 255, 255, 255},
+      { 250, 255, 254, 255, 254, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    }
+  },
+  {
+    {
+      { 217, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 225, 252, 241, 253, 255, 255, 254, 255, 255, 255, 255},
+      { 234, 250, 241, 250, 253, 255, 253, 254, 255, 255, 255}
+    },
+    {
+      { 255, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 223, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 238, 253, 254, 254, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 248, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 249, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 253, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 247, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 252, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 253, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 250, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    }
+  },
+  {
+    {
+      { 186, 251, 250, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 234, 251, 244, 254, 255, 255, 255, 255, 255, 255, 255},
+      { 251, 251, 243, 253, 254, 255, 254, 255, 255, 255, 255}
+    },
+    {
+      { 255, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 236, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 251, 253, 253, 254, 254, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    }
+  },
+  {
+    {
+      { 248, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 250, 254, 252, 254, 255, 255, 255, 255, 255, 255, 255},
+      { 248, 254, 249, 253, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 253, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 246, 253, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 252, 254, 251, 254, 254, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 254, 252, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 248, 254, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 253, 255, 254, 254, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 251, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 245, 251, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 253, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 251, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 252, 253, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 254, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 252, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 249, 255, 254, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 254, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 253, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 250, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    },
+    {
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 254, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255},
+      { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255}
+    }
+  }
+};
+
+static const mfxU8 mv_update_probs[2][NUM_MV_PROBS] =
+{
+  {
+    237,
+    246,
+    253, 253, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 250, 250, 252, 254, 254
+  },
+  {
+    231,
+    243,
+    245, 253, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 251, 251, 254, 254, 254
+  }
+};
+
+struct HeaderStat
+{
+    mfxU64 frames;
+    mfxU64 keyFrames;
+    mfxU64 headerBits;
+    mfxU64 checksum;
+};
+
+static mfxU32 ReadSigned(MFX_VP8_BoolDecoder &dec, int bits)
+{
+    mfxU32 v = dec.decode(bits);
+    return dec.decode() ? (0 - v) : v;
+}
+
+// returns false if the frame is broken
+static bool ParseFrameHeader(mfxU8 *data, mfxU32 size, HeaderStat &stat)
+{
+    if (size < 3)
+        return false;
+
+    bool   keyFrame  = !(data[0] & 1);
+    mfxU32 firstSize = (data[0] >> 5) | (data[1] << 3) | (data[2] << 11);
+    mfxU32 sum       = 0;
+
+    data += 3;
+    size -= 3;
+
+    if (keyFrame)
+    {
+        if (size < 7 || !(data[0] == 0x9d && data[1] == 0x01 && data[2] == 0x2a))
+            return false;
+
+        sum += ((data[4] << 8) | data[3]) & 0x3FFF;
+        sum += ((data[6] << 8) | data[5]) & 0x3FFF;
+
+        data += 7;
+        size -= 7;
+    }
+
+    if (firstSize > size)
+        return false;
+
+    MFX_VP8_BoolDecoder dec(data, size);
+
+    if (keyFrame)
+        sum += dec.decode(2); // color space, clamping
+
+    if (dec.decode()) // segmentation_enabled
+    {
+        mfxU32 update = dec.decode(2);
+
+        if (update & 1)
+        {
+            sum += dec.decode();
+
+            for (int i = 0; i < 2; i++)
+                for (int j = 0; j < MAX_NUM_OF_SEGMENTS; j++)
+                    if (dec.decode())
+                        sum += ReadSigned(dec, 7 - i);
+        }
+
+        if (update & 2)
+        {
+            for (int i = 0; i < 3; i++)
+                if (dec.decode())
+                    sum += dec.decode(8);
+        }
+    }
+
+    sum += dec.decode(7); // filter type, level
+    mfxU32 bits = dec.decode(4);
+    sum += bits;
+
+    if ((bits & 1) && dec.decode()) // mode_ref_lf_delta_update
+    {
+        for (int i = 0; i < 8; i++)
+            if (dec.decode())
+                sum += ReadSigned(dec, 6);
+    }
+
+    sum += dec.decode(2); // log2_nbr_of_dct_partitions
+
+    sum += dec.decode(7); // y_ac_qi
+    for (int i = 0; i < 5; i++)
+        if (dec.decode())
+            sum += ReadSigned(dec, 4);
+
+    if (!keyFrame)
+    {
+        mfxU32 refresh = dec.decode(2);
+
+        if (!(refresh & 2))
+            sum += dec.decode(2);
+
+        if (!(refresh & 1))
+            sum += dec.decode(2);
+
+        sum += dec.decode(2); // sign bias
+    }
+
+    sum += dec.decode(); // refresh_entropy_probs
+
+    if (!keyFrame)
+        sum += dec.decode(); // refresh_last
+
+    for (int i = 0; i < NUM_COEFF_PLANES; i++)
+        for (int j = 0; j < NUM_COEFF_BANDS; j++)
+            for (int k = 0; k < NUM_LOCAL_COMPLEXITIES; k++)
+                for (int l = 0; l < NUM_COEFF_NODES; l++)
+                    if (dec.decode(1, coeff_update_probs[i][j][k][l]))
+                        sum += dec.decode(8);
+
+    if (dec.decode()) // mb_no_coeff_skip
+        sum += dec.decode(8);
+
+    if (!keyFrame)
+    {
+        sum += dec.decode(8); // prob_intra
+        sum += dec.decode(8); // prob_last
+        sum += dec.decode(8); // prob_gf
+
+        if (dec.decode()) // intra_16x16_prob_update_flag
+            for (int i = 0; i < 4; i++)
+                sum += dec.decode(8);
+
+        if (dec.decode()) // intra_chroma_prob_update_flag
+            for (int i = 0; i < 3; i++)
+                sum += dec.decode(8);
+
+        for (int i = 0; i < 2; i++)
+            for (int j = 0; j < NUM_MV_PROBS; j++)
+                if (dec.decode(1, mv_update_probs[i][j]))
+                    sum += dec.decode(7);
+    }
+
+    stat.frames++;
+    stat.keyFrames  += keyFrame;
+    stat.headerBits += dec.pos() * 8 - 3 * 8 - dec.bitcount();
+    stat.checksum   += sum;
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: %s <input.ivf> [-n passes]\n", argv[0]);
+        return 1;
+    }
+
+    mfxU32 passes = 100;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            passes = (mfxU32)atoi(argv[++i]);
+    }
+
+    CIVFFrameReader reader;
+    mfxStatus sts = reader.Init(argv[1]);
+    if (sts != MFX_ERR_NONE)
+    {
+        printf("failed to open %s\n", argv[1]);
+        return 1;
+    }
+
+    mfxBitstream bs = {};
+    std::vector<mfxU8> buffer(8 * 1024 * 1024);
+    bs.Data      = buffer.data();
+    bs.MaxLength = (mfxU32)buffer.size();
+
+    // frame data is stored back to back, padding keeps the decoder's look-ahead inside the allocation
+    std::vector<mfxU8>  data;
+    std::vector<size_t> offset;
+
+    for (;;)
+    {
+        bs.DataOffset = 0;
+        bs.DataLength = 0;
+
+        sts = reader.ReadNextFrame(&bs);
+        if (sts != MFX_ERR_NONE || !bs.DataLength)
+            break;
+
+        offset.push_back(data.size());
+        data.insert(data.end(), bs.Data, bs.Data + bs.DataLength);
+    }
+    offset.push_back(data.size());
+    data.resize(data.size() + 16);
+
+    if (sts != MFX_ERR_MORE_DATA && sts != MFX_ERR_NONE)
+    {
+        printf("failed to read %s (%d)\n", argv[1], sts);
+        return 1;
+    }
+
+    size_t nFrames = offset.size() - 1;
+    if (!nFrames)
+    {
+        printf("no frames found\n");
+        return 1;
+    }
+
+    HeaderStat stat = {};
+    mfxU64 broken = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (mfxU32 pass = 0; pass < passes; pass++)
+    {
+        for (size_t i = 0; i < nFrames; i++)
+        {
+            if (!ParseFrameHeader(&data[offset[i]], mfxU32(offset[i + 1] - offset[i]), stat))
+                broken++;
+        }
+    }
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("frames:         %zu (%llu key, %llu broken) x %u passes\n",
+        nFrames, (unsigned long long)(stat.keyFrames / passes), (unsigned long long)(broken / passes), passes);
+    printf("header bits:    %.1f per frame\n", stat.frames ? double(stat.headerBits) / stat.frames : 0.);
+    printf("time:           %.3f sec\n", sec);
+    printf("speed:          %.1f frames/s, %.1f ns/frame\n", stat.frames / sec, sec * 1e9 / (stat.frames ? stat.frames : 1));
+    printf("checksum:       %llu\n", (unsigned long long)stat.checksum);
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+// Copyright (c) 2020 Intel Corporation
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures MFXVideoVPP resize/color conversion throughput on system memory surfaces.
+// Without a video processing device the library runs the CPU implementation
+// (Init returns MFX_WRN_PARTIAL_ACCELERATION), so the numbers are for VideoVPP_SW.
+//
+// By default NV12 1920x1080 -> 3840x2160 and 3840x2160 -> 1920x1080 are measured,
+// -w/-h/-ow/-oh/-i/-o select another case.
+//
+// -comp N composes N streams (640x360 by default) into a grid of the output
+// (1920x1080 by default) with mfxExtVPPComposite, every output takes N calls.
+//
+// -di 1|2 deinterlaces TFF input (1920x1080 by default) with MFX_DEINTERLACING_BOB or
+// MFX_DEINTERLACING_ADVANCED, -60p doubles the frame rate (30i -> 60p), so every input
+// gives two outputs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "mfxvideo++.h"
+
+#define ALIGN16(value) (((value + 15) >> 4) << 4)
+
+struct Format
+{
+    const char * name;
+    mfxU32       fourcc;
+    mfxU16       chromaFormat;
+};
+
+static const Format FORMATS[] =
+{
+    { "nv12", MFX_FOURCC_NV12, MFX_CHROMAFORMAT_YUV420 },
+    { "yv12", MFX_FOURCC_YV12, MFX_CHROMAFORMAT_YUV420 },
+    { "yuy2", MFX_FOURCC_YUY2, MFX_CHROMAFORMAT_YUV422 },
+    { "p010", MFX_FOURCC_P010, MFX_CHROMAFORMAT_YUV420 },
+    { "rgb4", MFX_FOURCC_RGB4, MFX_CHROMAFORMAT_YUV444 },
+};
+
+static const Format * FindFormat(const char * name)
+{
+    for (size_t i = 0; i < sizeof(FORMATS) / sizeof(FORMATS[0]); i++)
+        if (!strcmp(FORMATS[i].name, name))
+            return &FORMATS[i];
+    return 0;
+}
+
+static void SetFrameInfo(mfxFrameInfo & info, Format const & format, mfxU16 width, mfxU16 height)
+{
+    info.FourCC        = format.fourcc;
+    info.ChromaFormat  = format.chromaFormat;
+    info.Shift         = (MFX_FOURCC_P010 == format.fourcc) ? 1 : 0;
+    info.BitDepthLuma  = info.BitDepthChroma = (MFX_FOURCC_P010 == format.fourcc) ? 10 : 8;
+    info.PicStruct     = MFX_PICSTRUCT_PROGRESSIVE;
+    info.FrameRateExtN = 30;
+    info.FrameRateExtD = 1;
+    info.Width         = ALIGN16(width);
+    info.Height        = ALIGN16(height);
+    info.CropW         = width;
+    info.CropH         = height;
+}
+
+// system memory surfaces of one allocation request
+class SurfacePool
+{
+public:
+    void Alloc(mfxFrameInfo const & info, mfxU16 count)
+    {
+        const mfxU32 fourcc = info.FourCC;
+        const mfxU32 bpp    = (MFX_FOURCC_RGB4 == fourcc) ? 4 : ((MFX_FOURCC_YUY2 == fourcc || MFX_FOURCC_P010 == fourcc) ? 2 : 1);
+        const mfxU32 pitch  = info.Width * bpp;
+        const mfxU32 luma   = pitch * info.Height;
+        const mfxU32 size   = (MFX_FOURCC_RGB4 == fourcc || MFX_FOURCC_YUY2 == fourcc) ? luma : luma * 3 / 2;
+
+        m_buffer.assign(size_t(size) * count, 0);
+        m_surfaces.assign(count, mfxFrameSurface1());
+
+        for (mfxU16 i = 0; i < count; i++)
+        {
+            mfxFrameSurface1 & s = m_surfaces[i];
+            mfxU8 * p = &m_buffer[size_t(size) * i];
+
+            s.Info = info;
+            s.Data.PitchLow  = mfxU16(pitch & 0xffff);
+            s.Data.PitchHigh = mfxU16(pitch >> 16);
+
+            switch (fourcc)
+            {
+            case MFX_FOURCC_NV12:
+                s.Data.Y = p; s.Data.UV = p + luma; s.Data.V = s.Data.UV + 1;
+                break;
+            case MFX_FOURCC_P010:
+                s.Data.Y = p; s.Data.UV = p + luma; s.Data.V = s.Data.UV + 2;
+                break;
+            case MFX_FOURCC_YV12:
+                s.Data.Y = p; s.Data.V = p + luma; s.Data.U = s.Data.V + luma / 4;
+                break;
+            case MFX_FOURCC_YUY2:
+                s.Data.Y = p; s.Data.U = p + 1; s.Data.V = p + 3;
+                break;
+            case MFX_FOURCC_RGB4:
+                s.Data.B = p; s.Data.G = p + 1; s.Data.R = p + 2; s.Data.A = p + 3;
+                break;
+            }
+        }
+
+        // some texture instead of a flat frame
+        for (size_t i = 0; i < m_buffer.size(); i++)
+            m_buffer[i] = mfxU8((i * 7) ^ (i >> 11));
+    }
+
+    mfxFrameSurface1 * GetFree()
+    {
+        for (size_t i = 0; i < m_surfaces.size(); i++)
+            if (!m_surfaces[i].Data.Locked)
+                return &m_surfaces[i];
+        return 0;
+    }
+
+protected:
+    std::vector<mfxU8>            m_buffer;
+    std::vector<mfxFrameSurface1> m_surfaces;
+};
+
+static const char * StatusName(mfxStatus sts)
+{
+    switch (sts)
+    {
+    case MFX_ERR_NONE:                 return "hw";
+    case MFX_WRN_PARTIAL_ACCELERATION: return "sw";
+    default:                           return "?";
+    }
+}
+
+static bool RunCase(
+    Format const & in, mfxU16 inW, mfxU16 inH,
+    Format const & out, mfxU16 outW, mfxU16 outH,
+    mfxU16 method, mfxU16 asyncDepth, mfxU16 threads, mfxU32 frames, mfxU16 streams,
+    mfxU16 diMode, bool mode60p)
+{
+    mfxInitParam initPar = {};
+    initPar.Implementation = MFX_IMPL_AUTO_ANY;
+    initPar.Version.Major  = 1;
+    initPar.Version.Minor  = 25;
+
+    mfxExtThreadsParam threadsPar = {};
+    threadsPar.Header.BufferId = MFX_EXTBUFF_THREADS_PARAM;
+    threadsPar.Header.BufferSz = sizeof(threadsPar);
+    threadsPar.NumThread       = threads;
+
+    mfxExtBuffer * initExt[] = { &threadsPar.Header };
+    if (threads)
+    {
+        initPar.ExtParam    = initExt;
+        initPar.NumExtParam = 1;
+    }
+
+    MFXVideoSession session;
+    mfxStatus sts = session.InitEx(initPar);
+    if (sts < MFX_ERR_NONE)
+    {
+        printf("MFXInitEx failed: %d\n", sts);
+        return false;
+    }
+
+    mfxVideoParam par = {};
+    SetFrameInfo(par.vpp.In,  in,  inW,  inH);
+    SetFrameInfo(par.vpp.Out, out, outW, outH);
+    par.IOPattern  = MFX_IOPATTERN_IN_SYSTEM_MEMORY | MFX_IOPATTERN_OUT_SYSTEM_MEMORY;
+    par.AsyncDepth = asyncDepth;
+
+    if (diMode)
+    {
+        par.vpp.In.PicStruct = MFX_PICSTRUCT_FIELD_TFF;
+        if (mode60p)
+            par.vpp.Out.FrameRateExtN = 2 * par.vpp.In.FrameRateExtN;
+    }
+
+    mfxExtVPPDeinterlacing deinterlacing = {};
+    deinterlacing.Header.BufferId = MFX_EXTBUFF_VPP_DEINTERLACING;
+    deinterlacing.Header.BufferSz = sizeof(deinterlacing);
+    deinterlacing.Mode            = diMode;
+
+    mfxExtVPPScaling scaling = {};
+    scaling.Header.BufferId = MFX_EXTBUFF_VPP_SCALING;
+    scaling.Header.BufferSz = sizeof(scaling);
+    scaling.ScalingMode     = MFX_SCALING_MODE_DEFAULT;
+#if (MFX_VERSION >= 1033)
+    scaling.InterpolationMethod = method;
+#else
+    (void)method;
+#endif
+
+    // streams are placed in a grid of square-ish cells
+    std::vector<mfxVPPCompInputStream> grid(streams, mfxVPPCompInputStream());
+    const mfxU32 columns = streams ? mfxU32(ceil(sqrt(double(streams)))) : 1;
+    const mfxU32 rows    = (streams + columns - 1) / columns;
+
+    for (mfxU32 i = 0; i < streams; i++)
+    {
+        grid[i].DstX = (i % columns) * (outW / columns) & ~1;
+        grid[i].DstY = (i / columns) * (outH / rows) & ~1;
+        grid[i].DstW = (outW / columns) & ~1;
+        grid[i].DstH = (outH / rows) & ~1;
+    }
+
+    mfxExtVPPComposite composite = {};
+    composite.Header.BufferId = MFX_EXTBUFF_VPP_COMPOSITE;
+    composite.Header.BufferSz = sizeof(composite);
+    composite.Y               = 16;
+    composite.U               = 128;
+    composite.V               = 128;
+    composite.NumInputStream  = streams;
+    composite.InputStream     = streams ? &grid[0] : 0;
+
+    mfxExtBuffer * vppExt[] = { &scaling.Header, streams ? &composite.Header : &deinterlacing.Header };
+    par.ExtParam    = vppExt;
+    par.NumExtParam = (streams || diMode) ? 2 : 1;
+
+    MFXVideoVPP vpp(session);
+
+    mfxFrameAllocRequest request[2] = {};
+    sts = vpp.QueryIOSurf(&par, request);
+    if (sts < MFX_ERR_NONE)
+    {
+        printf("QueryIOSurf failed: %d\n", sts);
+        return false;
+    }
+
+    SurfacePool inPool, outPool;
+    inPool.Alloc(par.vpp.In, request[0].NumFrameSuggested);
+    outPool.Alloc(par.vpp.Out, request[1].NumFrameSuggested);
+
+    sts = vpp.Init(&par);
+    if (sts < MFX_ERR_NONE)
+    {
+        printf("Init failed: %d\n", sts);
+        return false;
+    }
+
+    const mfxStatus initSts = sts;
+    const mfxU32 depth = asyncDepth ? asyncDepth : 4;
+    std::vector<mfxSyncPoint> inFlight;
+    mfxU32 submitted = 0;
+    mfxFrameSurface1 * field = 0; // input to be sent again for its second field
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (submitted < frames || !inFlight.empty())
+    {
+        if (submitted < frames && inFlight.size() < depth)
+        {
+            mfxFrameSurface1 * src = field ? field : inPool.GetFree();
+            mfxFrameSurface1 * dst = outPool.GetFree();
+            mfxSyncPoint syncp = 0;
+
+            sts = (src && dst) ? vpp.RunFrameVPPAsync(src, dst, 0, &syncp) : MFX_WRN_DEVICE_BUSY;
+            field = (MFX_ERR_MORE_SURFACE == sts) ? src : 0;
+
+            if (MFX_ERR_MORE_SURFACE == sts)
+                sts = MFX_ERR_NONE;
+
+            // input of a stream before the last one
+            if (MFX_ERR_MORE_DATA == sts && streams)
+                continue;
+
+            if (MFX_ERR_NONE == sts && syncp)
+            {
+                inFlight.push_back(syncp);
+                submitted++;
+                continue;
+            }
+            if (sts < MFX_ERR_NONE)
+            {
+                printf("RunFrameVPPAsync failed: %d\n", sts);
+                return false;
+            }
+        }
+
+        if (!inFlight.empty())
+        {
+            sts = session.SyncOperation(inFlight.front(), 60000);
+            if (sts < MFX_ERR_NONE)
+            {
+                printf("SyncOperation failed: %d\n", sts);
+                return false;
+            }
+            inFlight.erase(inFlight.begin());
+        }
+    }
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (streams)
+        printf("%u x ", streams);
+    if (diMode)
+        printf("%s%s ", (MFX_DEINTERLACING_BOB == diMode) ? "bob" : "adi", mode60p ? " 60p" : "");
+
+    printf("%s %ux%u -> %s %ux%u [%s] async %u: %u frames, %.3f sec, %.2f ms/frame, %.1f fps\n",
+        in.name, inW, inH, out.name, outW, outH, StatusName(initSts), depth,
+        frames, sec, sec * 1e3 / frames, frames / sec);
+
+    vpp.Close();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const Format * in  = FindFormat("nv12");
+    const Format * out = FindFormat("nv12");
+    mfxU16 inW = 0, inH = 0, outW = 0, outH = 0;
+    mfxU16 method  = 0;
+    mfxU16 async   = 4;
+    mfxU16 threads = 0;
+    mfxU32 frames  = 100;
+    mfxU16 streams = 0;
+    mfxU16 diMode  = 0;
+    bool   mode60p = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+            in = FindFormat(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            out = FindFormat(argv[++i]);
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            inW = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < argc)
+            inH = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-ow") && i + 1 < argc)
+            outW = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-oh") && i + 1 < argc)
+            outH = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            method = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-async") && i + 1 < argc)
+            async = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            threads = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = (mfxU32)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-comp") && i + 1 < argc)
+            streams = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-di") && i + 1 < argc)
+            diMode = (mfxU16)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-60p"))
+            mode60p = true;
+        else
+            in = 0;
+
+        if (!in || !out)
+        {
+            printf("usage: %s [-i nv12|yv12|yuy2|p010|rgb4] [-o format] [-w width -h height -ow width -oh height]\n"
+                   "          [-m 0 default|1 nearest|2 bilinear|3 advanced] [-async depth] [-t threads] [-n frames] [-comp streams]\n"
+                   "          [-di 1 bob|2 advanced [-60p]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!frames)
+        frames = 1;
+
+    if (streams)
+    {
+        return RunCase(*in, inW ? inW : 640, inH ? inH : 360, *out, outW ? outW : 1920, outH ? outH : 1080,
+            method, async, threads, frames, streams, 0, false) ? 0 : 1;
+    }
+
+    if (diMode)
+    {
+        inW = inW ? inW : 1920;
+        inH = inH ? inH : 1080;
+        return RunCase(*in, inW, inH, *out, outW ? outW : inW, outH ? outH : inH,
+            method, async, threads, frames, 0, diMode, mode60p) ? 0 : 1;
+    }
+
+    if (inW && inH && outW && outH)
+        return RunCase(*in, inW, inH, *out, outW, outH, method, async, threads, frames, 0, 0, false) ? 0 : 1;
+
+    bool ok = RunCase(*in, 1920, 1080, *out, 3840, 2160, method, async, threads, frames, 0, 0, false)
+           && RunCase(*in, 3840, 2160, *out, 1920, 1080, method, async, threads, frames, 0, 0, false);
+
+    return ok ? 0 : 1;
+}